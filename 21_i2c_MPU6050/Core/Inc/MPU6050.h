@@ -3,6 +3,53 @@
  *	@brief header file for MPU6050
  *  @author Nakseung Choi
  *  @date 07-28-2022
+ *
+ * Every function takes the device handle (mpu6050_t): the bus it is on,
+ * its address and ranges, and its own sample ring. Two sensors share a bus
+ * with AD0 low (0x68) and high (0x69); imubus.h reads several of them in
+ * one round per tick.
+ *
+ *   static mpu6050_t imu = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+ *   MPU6050_init(&imu);
+ *
+ * The configuration registers (SMPLRT_DIV .. INT_ENABLE, I2C_SLV0_DO ..
+ * PWR_MGMT_2) have a RAM shadow in the handle. MPU6050_set() and
+ * MPU6050_update() change the shadow only and mark what changed;
+ * MPU6050_flush() writes the dirty registers, one burst per run of
+ * neighbours. A burst also runs across up to MPU6050_FLUSH_GAP clean
+ * registers: 9 bits each on the wire, against 20 for the START, address,
+ * register and STOP of another write. A change of a few bits is then no
+ * read-modify-write on the bus, and a value written again costs nothing.
+ * MPU6050_init() loads the shadow from the device, so it always matches
+ * the device. With FAST_BOOT it reads nothing and writes every shadowed
+ * register instead: after an MCU reset the sensor may still hold the wake
+ * on motion or any other configuration, not its power-on values.
+ *
+ * Output rate and bandwidth: the handle asks for rate_hz and bandwidth_hz,
+ * MPU6050_filter_solve() turns them into DLPF_CFG and SMPLRT_DIV and fills
+ * dev->filter with what the sensor really does (rate in mHz, bandwidth and
+ * group delay from the register map, RM-MPU-6000A 4.3). bandwidth_hz 0
+ * takes the widest filter below half the rate (no aliasing); otherwise the
+ * narrowest one that still passes bandwidth_hz. MPU6050_retune() changes
+ * both at run time: one burst (SMPLRT_DIV and CONFIG are neighbours),
+ * no re-init. Host/dlpfcheck covers the solver.
+ *
+ * Auxiliary sensor (magnetometer ...) on the MPU6050's own I2C master
+ * (XDA/XCL): MPU6050_aux_slv0() has slave 0 read len bytes of it every
+ * sample into EXT_SENS_DATA_00 (0x49), which follows GYRO_ZOUT_L. The data
+ * burst then grows to MPU6050_BURST_LEN + len bytes and a 9 axis sample is
+ * one transaction from the STM32 instead of two. MPU6050_aux_write() sets
+ * the sensor up through slave 4. Host/auxcheck runs both on a register
+ * model of the MPU6050 and an HMC5883L.
+ *
+ * Wake on motion: MPU6050_wom_enter() puts the gyros and the temperature
+ * sensor in standby and cycles the accelerometer alone at a low wake rate
+ * (LP_WAKE_CTRL, a few uA at 1.25 Hz against ~3.8 mA streaming). Its high
+ * pass filtered output above threshold_mg raises INT (active high,
+ * push-pull, latched until read; power.h wakes the STM32 on it).
+ * MPU6050_wom_exit() restores streaming and releases INT; the gyros need
+ * ~30 ms to settle after it. Both go through the shadow: 4 and 3 bursts
+ * (Host/womcheck).
  */
 
 
@@ -10,17 +57,39 @@
 #define INC_MPU6050_H_
 
 #include "i2c.h"
+#include "ring.h"
 #include <stdint.h>
 
 #define DEVID_R					0x00
 #define SMPLRT_DIV_R				(0x19)	//Data output rate or sample rate
-#define DEVICE_ADDR				(0xD0) // MPU6050 default i2c address w/ 0xD0 high
+#define MPU6050_ADDR_AD0_LOW		(0xD0)	// 0x68 << 1, AD0 tied low
+#define MPU6050_ADDR_AD0_HIGH		(0xD2)	// 0x69 << 1, AD0 tied high
+#define DEVICE_ADDR				MPU6050_ADDR_AD0_LOW // the sensor of this board
+#define CONFIG_R					(0x1A)	//FSYNC and DLPF
 #define GYRO_CONFIG_R			(0x1B)
 #define ACCEL_CONFIG_R			(0x1C)
+#define MOT_THR_R				(0x1F)
+#define I2C_MST_CTRL_R			(0x24)
+#define I2C_SLV0_ADDR_R			(0x25)
+#define I2C_SLV0_REG_R			(0x26)
+#define I2C_SLV0_CTRL_R			(0x27)
+#define I2C_SLV4_ADDR_R			(0x31)
+#define I2C_SLV4_REG_R			(0x32)
+#define I2C_SLV4_DO_R			(0x33)
+#define I2C_SLV4_CTRL_R			(0x34)
+#define I2C_MST_STATUS_R			(0x36)
+#define INT_PIN_CFG_R			(0x37)
+#define INT_ENABLE_R				(0x38)
+#define INT_STATUS_R				(0x3A)
 #define ACCEL_XOUT_H_REG 		(0x3B)
 #define TEMP_OUT_H_REG 			(0x41)
 #define GYRO_XOUT_H_REG 			(0x43)
+#define EXT_SENS_DATA_00_R		(0x49)
+#define I2C_SLV0_DO_R			(0x63)
+#define MOT_DETECT_CTRL_R		(0x69)
+#define USER_CTRL_R				(0x6A)
 #define PWR_MGMT_1_R				(0x6B)	//this wakes the sensor up by writing 0x00 to the power management 1 register.
+#define PWR_MGMT_2_R				(0x6C)
 
 #define GYRO_XOUT_H				(0x43)
 #define GYRO_XOUT_L				(0x44)
@@ -29,10 +98,54 @@
 #define GYRO_ZOUT_H					(0x47)
 #define GYRO_ZOUT_L					(0x48)
 
-/*Sample Rate = Gyroscope Output Rate / (1 + SMPLRT_DIV) 8MHz / 1+7kHz = 1kHz */
+/*Sample Rate = Gyroscope Output Rate / (1 + SMPLRT_DIV): 8kHz / (1+7) = 1kHz with the DLPF off,
+  the gyroscope output rate is 1kHz with DLPF_CFG 1..6. The accelerometer always runs at 1kHz. */
 /*For example, use SMPLRT_DIV as 7 to get the sample rate of 1khz. */
 #define WHO_AM_I_R				(0x75)
 
+#define MPU6050_WHO_AM_I			(0x68)	// whatever AD0 is
+
+/* ACCEL_XOUT_H .. GYRO_ZOUT_L: accel (6), temperature (2), gyro (6) */
+#define MPU6050_BURST_LEN			(14)
+#define MPU6050_AUX_MAX			(8)		// auxiliary bytes after it, EXT_SENS_DATA_00 ..
+#define MPU6050_BURST_MAX			(MPU6050_BURST_LEN + MPU6050_AUX_MAX)
+#define MPU6050_AUX_READ_US		(380)	// one I2C_MST_STATUS read at 100 kHz: 38 bits
+/* I2C_MST_STATUS reads waiting for a slave 4 write: two sample periods at rate_mhz, slave 4 runs once per sample */
+#define MPU6050_AUX_POLLS(rate_mhz)	(2000000000U / ((rate_mhz) * MPU6050_AUX_READ_US) + 4U)
+
+/* auxiliary master bits */
+#define MPU6050_I2C_MST_EN		(1U << 5)	// USER_CTRL
+#define MPU6050_I2C_BYPASS_EN		(1U << 1)	// INT_PIN_CFG
+#define MPU6050_WAIT_FOR_ES		(1U << 6)	// I2C_MST_CTRL: data ready waits for the external data
+#define MPU6050_I2C_MST_CLK_400K	(13)		// I2C_MST_CTRL: 8 MHz / 20
+#define MPU6050_I2C_SLV_RNW		(1U << 7)	// I2C_SLVx_ADDR
+#define MPU6050_I2C_SLV_EN		(1U << 7)	// I2C_SLVx_CTRL
+#define MPU6050_I2C_SLV_LEN		(0x0F)		// I2C_SLV0_CTRL
+#define MPU6050_I2C_SLV4_DONE		(1U << 6)	// I2C_MST_STATUS, cleared by reading it
+#define MPU6050_I2C_SLV4_NACK		(1U << 4)
+#define MPU6050_INT_LATCH_EN		(1U << 5)	// INT_PIN_CFG: INT held until cleared
+#define MPU6050_INT_RD_CLEAR		(1U << 4)	// INT_PIN_CFG: any read clears it
+#define MPU6050_MOT_EN			(1U << 6)	// INT_ENABLE, INT_STATUS
+#define MPU6050_CYCLE				(1U << 5)	// PWR_MGMT_1
+#define MPU6050_TEMP_DIS			(1U << 3)	// PWR_MGMT_1
+#define MPU6050_STBY_G			(0x07)		// PWR_MGMT_2: STBY_XG, _YG, _ZG
+#define MPU6050_ACCEL_HPF			(0x07)		// ACCEL_CONFIG, 0: off
+#define MPU6050_ACCEL_HPF_5HZ		(1)
+#define MPU6050_MOT_DETECT		(0x15)		// MOT_DETECT_CTRL: accel on delay +1 ms, counters decrement 1
+#define MPU6050_MOT_THR_MG		(2)			// mg per MOT_THR LSB
+#define MPU6050_RING_LEN			(16)	// samples buffered between the driver and the consumer
+
+/* shadowed configuration registers: two blocks, one dirty bit each */
+#define MPU6050_SHADOW_A_FIRST		SMPLRT_DIV_R
+#define MPU6050_SHADOW_A_LEN		(INT_ENABLE_R - SMPLRT_DIV_R + 1)		// 32
+#define MPU6050_SHADOW_B_FIRST		I2C_SLV0_DO_R
+#define MPU6050_SHADOW_B_LEN		(PWR_MGMT_2_R - I2C_SLV0_DO_R + 1)		// 10
+#define MPU6050_SHADOW_LEN		(MPU6050_SHADOW_A_LEN + MPU6050_SHADOW_B_LEN)
+#define MPU6050_FLUSH_GAP			(2)		// clean registers a burst may run across
+
+#define MPU6050_DLPF_CFGS			(7)		// DLPF_CFG 0..6, 7 is reserved
+#define MPU6050_DLPF_CFG_MASK		(0x07)	// CONFIG, EXT_SYNC_SET above it
+
 typedef enum {
   MPU6050_RANGE_2_G = 0b00,  ///< +/- 2g (default value)
   MPU6050_RANGE_4_G = 0b01,  ///< +/- 4g
@@ -40,8 +153,87 @@ typedef enum {
   MPU6050_RANGE_16_G = 0b11, ///< +/- 16g
 } mpu6050_accel_range_t;
 
-void MPU6050_init(void);
-void MPU6050_read_values(uint8_t reg);
+typedef enum {
+  MPU6050_RANGE_250_DEG = 0b00,  ///< +/- 250 deg/s (default value)
+  MPU6050_RANGE_500_DEG = 0b01,  ///< +/- 500 deg/s
+  MPU6050_RANGE_1000_DEG = 0b10, ///< +/- 1000 deg/s
+  MPU6050_RANGE_2000_DEG = 0b11, ///< +/- 2000 deg/s
+} mpu6050_gyro_range_t;
+
+/* counts per g and per deg/s at a range */
+#define MPU6050_ACCEL_LSB(range)	(16384.0f / (1U << (range)))
+#define MPU6050_GYRO_LSB(range)		(131.0f / (1U << (range)))
+
+/* LP_WAKE_CTRL, PWR_MGMT_2 bits 7:6 */
+typedef enum {
+	MPU6050_WAKE_1_25HZ = 0,
+	MPU6050_WAKE_5HZ,
+	MPU6050_WAKE_20HZ,
+	MPU6050_WAKE_40HZ
+} mpu6050_wake_rate_t;
+
+/* one raw burst, big endian as read from ACCEL_XOUT_H, then the auxiliary bytes as the sensor sends them */
+typedef struct {
+	uint32_t stamp;						// DWT cycle count when the read started
+	uint8_t raw[MPU6050_BURST_MAX];
+} mpu6050_raw_t;
+
+RING_DECLARE(mpu6050_ring, mpu6050_raw_t, MPU6050_RING_LEN)
+
+/* what a DLPF_CFG / SMPLRT_DIV pair does (MPU6050_filter_solve) */
+typedef struct {
+	uint8_t dlpf_cfg;
+	uint8_t smplrt_div;
+	uint32_t rate_mhz;					// output data rate, mHz
+	uint16_t accel_bw_hz;
+	uint16_t gyro_bw_hz;
+	uint16_t accel_delay_us;			// group delay of the filter
+	uint16_t gyro_delay_us;
+	uint8_t aliased;					// gyro bandwidth above half the rate
+	uint8_t accel_repeats;				// rate above the 1 kHz accelerometer rate
+} mpu6050_filter_t;
+
+/* one sensor */
+typedef struct {
+	i2c_handle_t *bus;
+	uint8_t addr;							// MPU6050_ADDR_AD0_LOW / _HIGH
+	mpu6050_accel_range_t accel_range;
+	mpu6050_gyro_range_t gyro_range;
+	uint16_t rate_hz;						// output data rate asked for
+	uint16_t bandwidth_hz;					// DLPF bandwidth asked for, 0: below rate_hz / 2
+	mpu6050_filter_t filter;				// what the sensor was set to
+	uint8_t aux_len;						// auxiliary bytes read with every sample (MPU6050_aux_slv0)
+	uint8_t present;						// answered WHO_AM_I in MPU6050_init()
+	volatile uint8_t reading;				// a read into samples is in flight
+	mpu6050_ring_t samples;					// filled by MPU6050_read_all_IT, one consumer
+	uint8_t shadow[MPU6050_SHADOW_LEN];		// configuration registers, block A then B
+	uint64_t dirty;							// shadow bytes not written to the device yet
+} mpu6050_t;
+
+#define MPU6050_DEVICE(b, a)	{ .bus = (b), .addr = (a), \
+								  .accel_range = MPU6050_RANGE_2_G, .gyro_range = MPU6050_RANGE_250_DEG, \
+								  .rate_hz = 1000, .bandwidth_hz = 0 }
+
+int MPU6050_init(mpu6050_t *dev);
+char MPU6050_read_address(mpu6050_t *dev, uint8_t reg);
+void MPU6050_write(mpu6050_t *dev, uint8_t reg, char value);
+void MPU6050_read_values(mpu6050_t *dev, uint8_t reg, uint8_t *data);
+int MPU6050_read_all_IT(mpu6050_t *dev, uint8_t task, uint8_t sig);
+void MPU6050_read_done(mpu6050_t *dev);
+void MPU6050_read_abort(mpu6050_t *dev);
+void MPU6050_shadow_reset(mpu6050_t *dev);
+void MPU6050_shadow_rewrite(mpu6050_t *dev);
+int MPU6050_shadow_load(mpu6050_t *dev);
+uint8_t MPU6050_get(const mpu6050_t *dev, uint8_t reg);
+int MPU6050_set(mpu6050_t *dev, uint8_t reg, uint8_t value);
+int MPU6050_update(mpu6050_t *dev, uint8_t reg, uint8_t mask, uint8_t value);
+int MPU6050_flush(mpu6050_t *dev);
+int MPU6050_filter_solve(uint16_t rate_hz, uint16_t bandwidth_hz, mpu6050_filter_t *f);
+int MPU6050_retune(mpu6050_t *dev, uint16_t rate_hz, uint16_t bandwidth_hz);
+int MPU6050_aux_slv0(mpu6050_t *dev, uint8_t addr7, uint8_t reg, uint8_t len);
+int MPU6050_aux_write(mpu6050_t *dev, uint8_t addr7, uint8_t reg, uint8_t value);
+int MPU6050_wom_enter(mpu6050_t *dev, uint16_t threshold_mg, mpu6050_wake_rate_t rate);
+int MPU6050_wom_exit(mpu6050_t *dev);
 
 
 #endif /* INC_MPU6050_H_ */
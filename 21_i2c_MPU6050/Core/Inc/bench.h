@@ -0,0 +1,87 @@
+/**
+ * bench.h
+ *	@brief header file for the on-target benchmarks
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build with RUN_BENCHMARKS defined to run bench_run() once at start-up,
+ * then read bench_results from the debugger (Live Expressions).
+ * All figures are DWT cycles for BENCH_ITEMS items unless noted.
+ * The compression benchmark records a trace from the MPU6050 before the
+ * interrupts are masked; without a sensor it uses bench_trace (bench_trace.c,
+ * from the logic capture of this project). Only the compressor is timed.
+ * Define BENCH_NEWLIB_PRINTF as well to time newlib snprintf next to fmt.c
+ * (links newlib printf, with -u _printf_float for the float figure).
+ */
+
+#ifndef INC_BENCH_H_
+#define INC_BENCH_H_
+
+#include <stdint.h>
+
+#define BENCH_ITEMS				(1024)
+#define BENCH_CRC_BYTES			(4096)
+#define BENCH_TRACE_SAMPLES		(256)		// IMU samples recorded for the compression benchmark
+#define BENCH_TRACE_CHANNELS	(6)			// accel x,y,z, gyro x,y,z
+
+typedef struct {
+	/* SPSC ring, 32 bit items */
+	uint32_t ring_push_pop;			// push + pop one at a time
+	uint32_t ring_bulk;				// push_bulk + pop_bulk in blocks of BENCH_BLOCK
+	uint32_t ring_zero_copy;		// write_reserve/commit + read_peek/release in blocks
+
+	/* CRC-32 over BENCH_CRC_BYTES (bytes per cycle = BENCH_CRC_BYTES / value) */
+	uint32_t crc_sw;				// table, byte stream
+	uint32_t crc_hw;				// CRC unit, byte stream (REV per word)
+	uint32_t crc_words_hw;			// CRC unit, words written by the CPU
+	uint32_t crc_dma;				// CRC unit, words written by DMA2
+	uint32_t crc_mismatch;			// 0 when every path agreed with the table
+
+	/* delta/zigzag/varint over BENCH_TRACE_SAMPLES MPU6050 samples, 6 channels, batches of 8 */
+	uint32_t comp_cycles;			// whole trace (cycles per sample = comp_cycles / BENCH_TRACE_SAMPLES)
+	uint32_t comp_block_max;		// worst single block
+	uint32_t comp_bytes;			// compressed size, against 12 * BENCH_TRACE_SAMPLES raw
+	uint32_t comp_mismatch;			// blocks that did not decode back exactly
+	uint32_t comp_live;				// 1: trace read from the sensor, 0: bench_trace
+
+	/* one formatted line of IMU values (cycles per call), fmt.c against newlib */
+	uint32_t fmt_int;				// "%6d" x 6 raw counts
+	uint32_t fmt_fixed;				// "%.3k" x 6 milli-g / milli-deg/s
+	uint32_t fmt_float;				// "%.3f" x 6 floats
+	uint32_t newlib_int;			// same lines through newlib snprintf,
+	uint32_t newlib_float;			// 0 unless BENCH_NEWLIB_PRINTF
+
+	/* fixed-block pool, worst single call over every class, spills and exhaustion */
+	uint32_t pool_alloc_max;		// pool_alloc, block found
+	uint32_t pool_fail_max;			// pool_alloc, every fitting class empty
+	uint32_t pool_free_max;			// pool_free
+	uint32_t pool_leaks;			// more blocks handed out afterwards than before (should be 0)
+
+	/* biquad over 6 channels per call, cycles min/max over the trace, flash at 3 wait states (100 MHz setting) */
+	uint32_t ramfunc_flash_min;		// from flash, ART accelerator off
+	uint32_t ramfunc_flash_max;
+	uint32_t ramfunc_art_min;		// from flash, ART on (prefetch, instruction and data cache)
+	uint32_t ramfunc_art_max;
+	uint32_t ramfunc_sram_min;		// same code from SRAM (RAM_FUNC)
+	uint32_t ramfunc_sram_max;
+	uint32_t ramfunc_mismatch;		// samples where flash and SRAM results differ
+
+	/* one bit set then cleared, BENCH_ITEMS times: |= / &= against bit-band stores (bitband.h) */
+	uint32_t bitband_sram_rmw;		// SRAM word
+	uint32_t bitband_sram_bb;
+	uint32_t bitband_periph_rmw;	// CRC->IDR, AHB1
+	uint32_t bitband_periph_bb;
+	uint32_t bitband_mismatch;		// bit-band reads or writes that did not match the word (should be 0)
+
+	/* PB8/PB9 set up for I2C1 (cycles for one configuration), gpio.h */
+	uint32_t gpio_hand;				// the 8 hand-written |= / &= shifts the I2C1 set-up used
+	uint32_t gpio_table;			// gpio_apply(I2C1_PINS), one write per register
+	uint32_t gpio_mismatch;			// registers left different by the two (should be 0)
+} bench_results_t;
+
+extern volatile bench_results_t bench_results;
+extern const int16_t bench_trace[BENCH_TRACE_SAMPLES * BENCH_TRACE_CHANNELS];
+
+void bench_run(void);
+
+#endif /* INC_BENCH_H_ */
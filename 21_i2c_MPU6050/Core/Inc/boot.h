@@ -0,0 +1,72 @@
+/**
+ * boot.h
+ *	@brief header file for the reset-to-first-sample boot timing
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Reset_Handler starts the DWT cycle counter from 0 and stores it in
+ * boot_times[] at the end of each of its stages; main.c adds the C stages.
+ * boot_times[] is in .noinit, so the .bss fill does not wipe the stamps
+ * taken before it. Every entry is the cycle count since reset:
+ *
+ *   BOOT_PAINT			MSP reserve and guard painted (stack.h)
+ *   BOOT_DATA			.data and .ram_func copied from flash
+ *   BOOT_BSS			.bss zeroed
+ *   BOOT_SYSINIT		SystemInit() returned
+ *   BOOT_CTORS			.preinit_array and .init_array called (Reset_Handler
+ *						walks them itself, without __libc_init_array's _init())
+ *   BOOT_MAIN			main() entered
+ *   BOOT_SENSOR		MPU6050 configured
+ *   BOOT_FIRST_SAMPLE	first burst read with a conversion in it completed
+ *						(not only the reset value 0 of the data registers)
+ *
+ * At the first sample boot_report() sends them as one TELEM_TYPE_BOOT frame
+ * (the "boot" command sends it again); Host/telemcat prints the per-stage
+ * breakdown. With RUN_BENCHMARKS, dwt_init() restarts the counter and the
+ * stages after BOOT_MAIN are meaningless.
+ *
+ * FAST_BOOT (default 0) gets the first sample out sooner:
+ *  - MPU6050_init() reads nothing (no WHO_AM_I, no shadow load) and writes
+ *    the whole configuration: 5 I2C transactions instead of 6 (MPU6050.c)
+ *  - main() configures the sensor before anything else and sets up the
+ *    memory pool, CRC unit, USART2 and encoder afterwards
+ *  - the first read is started as soon as the scheduler runs instead of
+ *    on the first timer tick, IMU_PERIOD_MS later. It can see the reset
+ *    value (0) of the data registers if it beats the first conversion,
+ *    one sample period after wake (IMU_RATE_HZ, main.c); such a read does
+ *    not stamp BOOT_FIRST_SAMPLE, the first one with data does.
+ */
+
+#ifndef INC_BOOT_H_
+#define INC_BOOT_H_
+
+#include <stdint.h>
+
+#ifndef FAST_BOOT
+#define FAST_BOOT				(0)
+#endif
+
+/* boot stages, in order; BOOT_PAINT .. BOOT_CTORS are word offsets used by startup_stm32f411retx.s */
+enum {
+	BOOT_PAINT = 0,
+	BOOT_DATA,
+	BOOT_BSS,
+	BOOT_SYSINIT,
+	BOOT_CTORS,
+	BOOT_MAIN,
+	BOOT_SENSOR,
+	BOOT_FIRST_SAMPLE,
+	BOOT_STAGES
+};
+
+#define BOOT_STAGE_NAMES		{ "paint", "data", "bss", "sysinit", "ctors", "main", "sensor", "first sample" }
+
+/* TELEM_TYPE_BOOT payload: core clock in Hz, then boot_times[], uint32 little endian */
+#define BOOT_REPORT_LEN			(4 * (1 + BOOT_STAGES))
+
+extern volatile uint32_t boot_times[BOOT_STAGES];
+
+void boot_stamp(uint32_t stage);
+int boot_report(void);
+
+#endif /* INC_BOOT_H_ */
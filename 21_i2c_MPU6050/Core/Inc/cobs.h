@@ -0,0 +1,38 @@
+/**
+ * cobs.h
+ *	@brief header file for Consistent Overhead Byte Stuffing
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * COBS removes every 0x00 from a block at a cost of one byte per 254
+ * (plus one), so 0x00 can delimit frames on a byte stream and a receiver
+ * resynchronises at the next 0x00 after any corruption.
+ * cobs_encode() stuffs one block; the cobs_enc_* calls do the same for a
+ * frame put together from several pieces, without first copying them into
+ * one buffer.
+ * Builds on the host as well (no hardware access).
+ */
+
+#ifndef INC_COBS_H_
+#define INC_COBS_H_
+
+#include <stdint.h>
+
+#define COBS_DELIMITER			(0x00U)
+#define COBS_MAX_ENCODED(n)		((n) + (n) / 254U + 1U)	// without the delimiter
+
+/* incremental encoder state */
+typedef struct {
+	uint8_t *start;
+	uint8_t *code;			// code byte of the open run
+	uint8_t *out;
+	uint8_t run;			// bytes in the open run + 1
+} cobs_enc_t;
+
+void cobs_enc_begin(cobs_enc_t *e, uint8_t *dst);
+void cobs_enc_put(cobs_enc_t *e, const uint8_t *src, uint32_t len);
+uint32_t cobs_enc_end(cobs_enc_t *e);
+uint32_t cobs_encode(const uint8_t *src, uint32_t len, uint8_t *dst);
+int32_t cobs_decode(const uint8_t *src, uint32_t len, uint8_t *dst);
+
+#endif /* INC_COBS_H_ */
@@ -0,0 +1,68 @@
+/**
+ * compress.h
+ *	@brief header file for the multi-channel int16 block compressor
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Consecutive sensor samples differ by little, so each channel is sent as
+ * the difference to its previous sample, zigzag mapped (0,-1,1,-2.. ->
+ * 0,1,2,3..) and written as a base-128 varint: |delta| < 64 takes one byte,
+ * < 8192 two, anything else three. Differences wrap modulo 2^16, so every
+ * int16 step is exact.
+ *
+ * Block, n samples of ch channels (samples interleaved):
+ *
+ *   offset  size    field
+ *   0       1       bit 7: keyframe, bits 6..0: n (1..COMP_MAX_SAMPLES)
+ *   1       1       ch
+ *   2       1       block seq, +1 per block
+ *   3       2*ch    keyframe only: first sample, int16 little endian
+ *   ..      1..3    one varint per channel for every remaining sample
+ *
+ * A block is a keyframe every keyframe_every blocks (or on request); other
+ * blocks continue from the last sample of the block before. A decoder that
+ * starts late or misses a block (block seq jumps) skips blocks until the
+ * next keyframe.
+ *
+ * Encoding is O(n * ch) with no data dependent loops beyond the 1..3 varint
+ * bytes, and never writes more than COMP_BLOCK_MAX(ch, n) bytes.
+ * Builds on the host as well (no hardware access).
+ */
+
+#ifndef INC_COMPRESS_H_
+#define INC_COMPRESS_H_
+
+#include <stdint.h>
+
+#define COMP_MAX_CHANNELS		(12)		// two MPU6050 rows (main.c)
+#define COMP_MAX_SAMPLES		(127)
+#define COMP_HEADER_LEN			(3)
+#define COMP_KEYFRAME			(0x80U)
+#define COMP_BLOCK_MAX(ch, n)	(COMP_HEADER_LEN + 2 * (ch) + 3 * (ch) * (n))
+
+typedef struct {
+	uint8_t channels;
+	uint8_t keyframe_every;		// blocks between keyframes, 1 = every block
+	uint8_t since_key;
+	uint8_t seq;
+	uint8_t force_key;
+	int16_t prev[COMP_MAX_CHANNELS];
+} comp_encoder_t;
+
+typedef struct {
+	uint8_t synced;
+	uint8_t seq;				// expected block seq
+	uint8_t channels;
+	int16_t prev[COMP_MAX_CHANNELS];
+	uint32_t blocks;			// blocks decoded
+	uint32_t skipped;			// blocks skipped while waiting for a keyframe
+	uint32_t errors;			// malformed blocks
+} comp_decoder_t;
+
+void comp_encoder_init(comp_encoder_t *e, uint8_t channels, uint8_t keyframe_every);
+void comp_encoder_keyframe(comp_encoder_t *e);
+uint32_t comp_encode(comp_encoder_t *e, const int16_t *samples, uint8_t n, uint8_t *out);
+void comp_decoder_init(comp_decoder_t *d);
+int comp_decode(comp_decoder_t *d, const uint8_t *in, uint32_t len, int16_t *samples, uint32_t max_samples);
+
+#endif /* INC_COMPRESS_H_ */
@@ -0,0 +1,52 @@
+/**
+ * crc.h
+ *	@brief header file for CRC-32 checksums
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * CRC-32/MPEG-2: polynomial 0x04C11DB7, init 0xFFFFFFFF, not reflected,
+ * no final XOR (check value for "123456789" is 0x0376E6E7). This is the
+ * algorithm of the STM32 CRC unit, so frames can later be checked in
+ * hardware without changing the wire format.
+ *
+ * Chain calls by passing the previous result as crc; start with CRC32_INIT.
+ *
+ * Two views of the same CRC:
+ *  - crc32_mpeg2(): a byte stream, in order (telemetry frames, packets)
+ *  - crc32_words(): 32 bit words, each fed most significant byte first,
+ *    which is what the CRC unit does with a word written to CRC->DR
+ *    (flash images, calibration blocks); equal to crc32_mpeg2() over the
+ *    words stored big endian
+ *
+ * After crc_init() both use the CRC unit (crc32_words() through DMA2 for
+ * blocks of CRC_DMA_MIN_WORDS or more); before it, on the host, or when the
+ * unit is busy (a call from an ISR that interrupted another user) they fall
+ * back to the table. Every path gives the same result for the same input.
+ * Hardware calls poll until done; do not call them from an ISR that must
+ * not wait ~1 cycle per byte.
+ */
+
+#ifndef INC_CRC_H_
+#define INC_CRC_H_
+
+#include <stdint.h>
+
+#define CRC32_INIT				(0xFFFFFFFFU)
+#define CRC_DMA_MIN_WORDS		(64)		// shorter blocks are not worth the DMA set-up
+
+extern volatile uint32_t crc_dma_errors;	// DMA transfer errors, finished by the table
+
+void crc_init(void);
+uint32_t crc32_mpeg2(uint32_t crc, const uint8_t *data, uint32_t len);
+uint32_t crc32_words(uint32_t crc, const uint32_t *words, uint32_t n);
+
+/* the individual paths, for benchmarks and cross-checks */
+uint32_t crc32_mpeg2_sw(uint32_t crc, const uint8_t *data, uint32_t len);
+uint32_t crc32_words_sw(uint32_t crc, const uint32_t *words, uint32_t n);
+#if defined(__arm__)
+uint32_t crc32_mpeg2_hw(uint32_t crc, const uint8_t *data, uint32_t len);
+uint32_t crc32_words_hw(uint32_t crc, const uint32_t *words, uint32_t n);
+uint32_t crc32_words_dma(uint32_t crc, const uint32_t *words, uint32_t n);
+#endif
+
+#endif /* INC_CRC_H_ */
@@ -0,0 +1,54 @@
+/**
+ * fmt.h
+ *	@brief header file for the allocation-free formatted output
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * printf-style formatting into a caller supplied sink (UART TX ring, LCD
+ * line buffer, memory) without malloc, without the newlib stdio state and
+ * without the soft float conversion code.
+ *
+ * Supported, with printf semantics:
+ *  %d %i %u %x %X %o %c %s %%
+ *  flags - + space # 0, width and precision (also as *), length hh h l ll z
+ *  %f %F   doubles with |x| < 2^64 and precision 0..FMT_FLOAT_PREC_MAX,
+ *          rounded exactly like printf (half to even on the exact binary
+ *          value); larger values print as "ovf", inf and nan as printf does
+ *
+ * Extensions (no printf equivalent, not covered by gcc's format check):
+ *  %.Nk    int32 holding value * 10^N, printed with N decimals: ("%.3k", -1234) -> "-1.234"
+ *  %.Nq    Q format: two int arguments, raw then fractional bits b (0..31),
+ *          printed as raw / 2^b with N decimals, rounded like %f, so
+ *          ("%.4q", 8192, 14) -> "0.5000"
+ *
+ * Not supported: %e %g %a %p %n, wide characters. Host/fmtcheck compares
+ * the output with the C library over a randomized corpus.
+ * Builds on the host as well (no hardware access).
+ *
+ * Cost against newlib: bench_fmt() (bench.h) gives cycles per line for
+ * both when built with BENCH_NEWLIB_PRINTF. For code size compare
+ *  arm-none-eabi-nm --size-sort -S Debug/21_i2c_MPU6050.elf
+ * of a build with and without it: newlib (nano) snprintf brings _vfprintf_r,
+ * _printf_float with dtoa, the reent state and _malloc_r/_sbrk from sysmem.c,
+ * where fmt.c only adds its own fmt_* symbols and the 64 bit helpers
+ * (__aeabi_uldivmod) it shares with the rest of the image.
+ */
+
+#ifndef INC_FMT_H_
+#define INC_FMT_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FMT_FLOAT_PREC_MAX		(9)
+
+/* receives the output in pieces; n is never 0 */
+typedef void (*fmt_sink_t)(void *ctx, const char *s, uint32_t n);
+
+int fmt_vformat(fmt_sink_t sink, void *ctx, const char *format, va_list ap);
+int fmt_format(fmt_sink_t sink, void *ctx, const char *format, ...);
+int fmt_vsnprintf(char *buf, size_t size, const char *format, va_list ap);
+int fmt_snprintf(char *buf, size_t size, const char *format, ...);
+
+#endif /* INC_FMT_H_ */
@@ -0,0 +1,137 @@
+/**
+ * gpio.h
+ *	@brief compile-time GPIO pin configuration
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The pins of one port are listed once, each with its mode, output type,
+ * speed, pull and alternate function:
+ *
+ *   #define I2C1_PINS(PIN) \
+ *   	PIN(8, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_SPEED_LOW, PIN_PULL_UP, 4) \
+ *   	PIN(9, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_SPEED_LOW, PIN_PULL_UP, 4)
+ *
+ *   GPIO_CFG_DEFINE(i2c1_pins, I2C1_PINS);
+ *   ...
+ *   gpio_apply(GPIOB, &i2c1_pins);
+ *
+ * GPIO_CFG() folds the list into a mask and a value per register, all
+ * integer constant expressions, and GPIO_CFG_DEFINE() rejects a pin listed
+ * twice or a field out of range at compile time. gpio_apply() is forced
+ * inline and reads the constants back as immediates, so configuring any
+ * number of pins of a port costs one read-modify-write per register:
+ * OTYPER, OSPEEDR, PUPDR unless every pin gives PIN_KEEP, AFR[0] and
+ * AFR[1] only if a pin there uses AF, then MODER.
+ * The registers are written in that order so a pin only enters its mode
+ * once its output type, pull and alternate function are in place.
+ * For the I2C1 pins (I2C1_PINS, i2c.h) that is 4 read-modify-writes
+ * against the 8 of the hand-written shifts; bench_gpio() (bench.h) times
+ * both, and
+ *   arm-none-eabi-objdump -d --disassemble=bench_gpio Debug/21_i2c_MPU6050.elf
+ * shows the four ldr/bic/orr/str groups. Through a pointer that is not
+ * constant (i2c_init() takes the table from the bus handle) the masks are
+ * loaded instead of being immediates; the writes stay the same.
+ * Host/gpiocheck.c checks the masks against a per-pin, per-field reference.
+ */
+
+#ifndef INC_GPIO_H_
+#define INC_GPIO_H_
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+/* MODER */
+#define PIN_MODE_IN				(0U)
+#define PIN_MODE_OUT			(1U)
+#define PIN_MODE_AF				(2U)
+#define PIN_MODE_ANALOG			(3U)
+
+/* OTYPER */
+#define PIN_PUSH_PULL			(0U)
+#define PIN_OPEN_DRAIN			(1U)
+
+/* OSPEEDR */
+#define PIN_SPEED_LOW			(0U)
+#define PIN_SPEED_MEDIUM		(1U)
+#define PIN_SPEED_FAST			(2U)
+#define PIN_SPEED_HIGH			(3U)
+
+/* PUPDR */
+#define PIN_PULL_NONE			(0U)
+#define PIN_PULL_UP				(1U)
+#define PIN_PULL_DOWN			(2U)
+
+/* output type, speed or pull: leave the field as it is */
+#define PIN_KEEP				(0xFFU)
+
+/* mask and value of every register touched by one configuration */
+typedef struct {
+	uint32_t moder_mask, moder;
+	uint32_t otyper_mask, otyper;
+	uint32_t ospeedr_mask, ospeedr;
+	uint32_t pupdr_mask, pupdr;
+	uint32_t afrl_mask, afrl;			// AFR[0], pins 0..7
+	uint32_t afrh_mask, afrh;			// AFR[1], pins 8..15
+} gpio_cfg_t;
+
+/* per pin terms, each list entry is PIN(pin, mode, otype, speed, pull, af) */
+#define GPIO_MODER_M_(n, m, o, s, p, a)		| (3U << (2U * (n)))
+#define GPIO_MODER_V_(n, m, o, s, p, a)		| ((uint32_t)(m) << (2U * (n)))
+#define GPIO_OTYPER_M_(n, m, o, s, p, a)	| (((o) == PIN_KEEP) ? 0U : (1U << (n)))
+#define GPIO_OTYPER_V_(n, m, o, s, p, a)	| (((o) == PIN_KEEP) ? 0U : ((uint32_t)(o) << (n)))
+#define GPIO_OSPEEDR_M_(n, m, o, s, p, a)	| (((s) == PIN_KEEP) ? 0U : (3U << (2U * (n))))
+#define GPIO_OSPEEDR_V_(n, m, o, s, p, a)	| (((s) == PIN_KEEP) ? 0U : ((uint32_t)(s) << (2U * (n))))
+#define GPIO_PUPDR_M_(n, m, o, s, p, a)		| (((p) == PIN_KEEP) ? 0U : (3U << (2U * (n))))
+#define GPIO_PUPDR_V_(n, m, o, s, p, a)		| (((p) == PIN_KEEP) ? 0U : ((uint32_t)(p) << (2U * (n))))
+#define GPIO_AFRL_M_(n, m, o, s, p, a)		| (((m) == PIN_MODE_AF && (n) < 8U) ? (0xFU << (4U * ((n) & 7U))) : 0U)
+#define GPIO_AFRL_V_(n, m, o, s, p, a)		| (((m) == PIN_MODE_AF && (n) < 8U) ? ((uint32_t)(a) << (4U * ((n) & 7U))) : 0U)
+#define GPIO_AFRH_M_(n, m, o, s, p, a)		| (((m) == PIN_MODE_AF && (n) >= 8U) ? (0xFU << (4U * ((n) & 7U))) : 0U)
+#define GPIO_AFRH_V_(n, m, o, s, p, a)		| (((m) == PIN_MODE_AF && (n) >= 8U) ? ((uint32_t)(a) << (4U * ((n) & 7U))) : 0U)
+#define GPIO_PIN_OR_(n, m, o, s, p, a)		| (1UL << (n))
+#define GPIO_PIN_SUM_(n, m, o, s, p, a)		+ (1UL << (n))
+#define GPIO_PIN_OK_(n, m, o, s, p, a)		&& ((n) < 16U && (m) <= 3U && ((o) <= 1U || (o) == PIN_KEEP) \
+											&& ((s) <= 3U || (s) == PIN_KEEP) && ((p) <= 2U || (p) == PIN_KEEP) && (a) <= 15U)
+
+/* constant initializer of a gpio_cfg_t from a pin list */
+#define GPIO_CFG(list) { \
+	0U list(GPIO_MODER_M_), 0U list(GPIO_MODER_V_), \
+	0U list(GPIO_OTYPER_M_), 0U list(GPIO_OTYPER_V_), \
+	0U list(GPIO_OSPEEDR_M_), 0U list(GPIO_OSPEEDR_V_), \
+	0U list(GPIO_PUPDR_M_), 0U list(GPIO_PUPDR_V_), \
+	0U list(GPIO_AFRL_M_), 0U list(GPIO_AFRL_V_), \
+	0U list(GPIO_AFRH_M_), 0U list(GPIO_AFRH_V_) }
+
+/* 1 if no pin is listed twice (a repeated pin carries into the next bit of the sum) */
+#define GPIO_PINS_UNIQUE(list)	((0UL list(GPIO_PIN_SUM_)) == (0UL list(GPIO_PIN_OR_)))
+/* 1 if every field is in range */
+#define GPIO_PINS_VALID(list)	(1 list(GPIO_PIN_OK_))
+
+#define GPIO_CFG_DEFINE(name, list) \
+	_Static_assert(GPIO_PINS_UNIQUE(list), #list ": pin listed twice"); \
+	_Static_assert(GPIO_PINS_VALID(list), #list ": field out of range"); \
+	static const gpio_cfg_t name = GPIO_CFG(list)
+
+/**
+ * void gpio_apply(GPIO_TypeDef *port, const gpio_cfg_t *cfg)
+ * @brief one read-modify-write per register the configuration touches
+ */
+__STATIC_FORCEINLINE void gpio_apply(GPIO_TypeDef *port, const gpio_cfg_t *cfg){
+	if(cfg->otyper_mask){
+		port->OTYPER = (port->OTYPER & ~cfg->otyper_mask) | cfg->otyper;
+	}
+	if(cfg->ospeedr_mask){
+		port->OSPEEDR = (port->OSPEEDR & ~cfg->ospeedr_mask) | cfg->ospeedr;
+	}
+	if(cfg->pupdr_mask){
+		port->PUPDR = (port->PUPDR & ~cfg->pupdr_mask) | cfg->pupdr;
+	}
+	if(cfg->afrl_mask){
+		port->AFR[0] = (port->AFR[0] & ~cfg->afrl_mask) | cfg->afrl;
+	}
+	if(cfg->afrh_mask){
+		port->AFR[1] = (port->AFR[1] & ~cfg->afrh_mask) | cfg->afrh;
+	}
+	port->MODER = (port->MODER & ~cfg->moder_mask) | cfg->moder;
+}
+
+#endif /* INC_GPIO_H_ */
@@ -3,13 +3,168 @@
  *	@brief header file for i2c
  * 	@author Nakseung Choi
  * 	@date 07-28-2022
+ *
+ * One driver for I2C1, I2C2 and I2C3: every function takes the handle of
+ * the bus (i2c1, i2c2, i2c3), which holds the registers, pins and IRQ of
+ * the instance and the state of its interrupt driven transfer. The calls
+ * are direct, the instance is only a pointer argument, and each bus runs
+ * its own transfer independently of the others, so sensors spread over
+ * the three buses are read in parallel.
+ *
+ * Interrupt driven reads started while the bus is busy wait in a short
+ * queue of the handle; the event handler starts the next one right after
+ * the STOP of the last, so reads of several devices on one bus follow each
+ * other with only the STOP/START gap in between (imubus.h).
+ *
+ * Host/i2cmodel runs i2c.c against a model of the three peripherals and
+ * shows the aggregate throughput with one, two and three buses busy.
+ *
+ * Errors and timeouts: every transfer returns (or, interrupt driven, posts)
+ * a status. Each attempt has a deadline on the DWT counter,
+ * I2C_ATTEMPT_US(n) from its first wait, and every phase waits against it
+ * while watching the error flags (AF, ARLO, BERR, OVR). A failed attempt
+ * sends STOP, recovers the bus and is tried again, at most I2C_RETRIES
+ * times. Recovery: SCL and SDA as GPIO, up to 9 clocks on SCL until a
+ * slave stuck in a byte lets SDA go, a STOP, then SWRST and the register
+ * set-up of i2c_init(). A blocking call therefore returns within
+ * I2C_WORST_US(n) whatever the slave does. Interrupt driven reads get the
+ * same deadline; the error interrupt or i2c_it_poll() (past the deadline)
+ * ends the read with arg 0 in its completion event, sends STOP and starts
+ * the next queued read. Neither bit-bangs a recovery with interrupts
+ * masked: after a NACK or a lost arbitration the bus is free, after a
+ * timeout, bus error or overrun the handle is marked and the recovery runs
+ * in thread context, from the next i2c_it_poll(), i2c_burst_read_it() or
+ * blocking transfer on the bus. Queued reads wait for it.
+ * Host/i2cfault injects NACKs, arbitration and bus errors, clock
+ * stretching and a stuck SDA at every phase and checks the bound.
+ * Host/simcheck runs this file unmodified on the register level
+ * simulator (Host/sim), interrupts included.
+ *
+ * Bus pins (gpio.h), all standard mode 100 kHz, PCLK1 16 MHz:
+ *   I2C1  PB8 SCL, PB9 SDA		AF4
+ *   I2C2  PB10 SCL (AF4), PB3 SDA (AF9)	PB3 is also SWO
+ *   I2C3  PA8 SCL, PC9 SDA		AF4
  */
 
 #ifndef INC_I2C_H_
 #define INC_I2C_H_
 
-void I2C1_byteRead(char saddr, char maddr, char* data);
-void I2C1_burstRead(char saddr, char maddr, int n, char* data);
-void I2C1_burstWrite(char saddr, char maddr, int n, char* data);
+#include <stdint.h>
+#include "stm32f4xx.h"
+#include "sections.h"
+#include "gpio.h"
+
+/* PB8 = SCL, PB9 = SDA: AF4, open drain, pull-up, speed left at reset (gpio.h) */
+#define I2C1_PINS(PIN) \
+	PIN(8, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_KEEP, PIN_PULL_UP, 4) \
+	PIN(9, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_KEEP, PIN_PULL_UP, 4)
+/* PB10 = SCL (AF4), PB3 = SDA (AF9) */
+#define I2C2_PINS(PIN) \
+	PIN(3, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_KEEP, PIN_PULL_UP, 9) \
+	PIN(10, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_KEEP, PIN_PULL_UP, 4)
+/* PA8 = SCL, PC9 = SDA, both AF4 */
+#define I2C3_SCL_PINS(PIN) \
+	PIN(8, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_KEEP, PIN_PULL_UP, 4)
+#define I2C3_SDA_PINS(PIN) \
+	PIN(9, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_KEEP, PIN_PULL_UP, 4)
+
+#define I2C_PIN_PORTS			(2)		// the pins of one bus are on at most 2 ports
+#define I2C_IT_QUEUE_LEN		(4)		// interrupt driven reads waiting behind the one in flight
+
+#ifndef I2C_RETRIES
+#define I2C_RETRIES				(2)		// attempts after the first, each after a bus recovery
+#endif
+#define I2C_BYTE_US				(90)	// 9 bits at 100 kHz
+#define I2C_STRETCH_US			(200)	// clock stretching and CPU latency allowed per attempt
+/* idle bus, START, address, register, re-START and address, n bytes, STOP */
+#define I2C_ATTEMPT_US(n)		(I2C_STRETCH_US + I2C_BYTE_US * (4U + (uint32_t)(n)))
+#define I2C_RECOVER_US			(120)	// 9 SCL clocks, STOP, SWRST and set-up
+#define I2C_WORST_US(n)			((I2C_RETRIES + 1U) * (I2C_ATTEMPT_US(n) + I2C_RECOVER_US))
+#define I2C_RECOVER_CLOCKS		(9)		// a slave in the middle of a byte lets go within 9 clocks
+
+/* result of a transfer */
+typedef enum {
+	I2C_OK = 0,
+	I2C_ERR_TIMEOUT = -1,	// a phase did not end before the deadline
+	I2C_ERR_NACK = -2,		// AF: address or byte not acknowledged
+	I2C_ERR_ARLO = -3,		// arbitration lost
+	I2C_ERR_BERR = -4,		// misplaced START or STOP
+	I2C_ERR_OVR = -5,		// overrun / underrun
+	I2C_ERR_BUSY = -6		// the bus never went idle (SDA or SCL held low)
+} i2c_status_t;
+
+/* states of the interrupt driven burst read */
+typedef enum {
+	I2C_IT_IDLE = 0,
+	I2C_IT_START,		// waiting for SB, then send slave address + W
+	I2C_IT_ADDR_W,		// waiting for ADDR, then send memory address
+	I2C_IT_MADDR,		// waiting for BTF, then re-start
+	I2C_IT_RESTART,		// waiting for SB, then send slave address + R
+	I2C_IT_ADDR_R,		// waiting for ADDR, then set up ACK/STOP
+	I2C_IT_RX			// receiving bytes on RXNE
+} i2c_it_state_t;
+
+typedef struct {
+	volatile i2c_it_state_t state;
+	char saddr;
+	char maddr;
+	int n;
+	int remaining;
+	char *data;
+	uint8_t task;		// scheduler task notified on completion
+	uint8_t sig;
+	uint32_t deadline;	// DWT, set when the START is requested
+} i2c_it_xfer_t;
+
+/* errors of one bus, readable from the debugger (Live Expressions) */
+typedef struct {
+	uint32_t timeouts;
+	uint32_t nacks;
+	uint32_t arlo;
+	uint32_t berr;
+	uint32_t ovr;
+	uint32_t recoveries;
+	uint32_t failures;		// transfers that failed every attempt
+	uint32_t worst;			// longest blocking transfer, DWT cycles
+} i2c_stats_t;
+
+/* pins of one bus on one port */
+typedef struct {
+	GPIO_TypeDef *port;				// 0: unused
+	uint32_t rcc_en;				// RCC_AHB1ENR bit of the port
+	const gpio_cfg_t *cfg;
+} i2c_pins_t;
+
+/* one I2C instance: fixed description, then the transfer in flight */
+typedef struct {
+	I2C_TypeDef *regs;
+	uint32_t rcc_en;				// RCC_APB1ENR bit of the instance
+	IRQn_Type ev_irq;
+	IRQn_Type er_irq;
+	i2c_pins_t pins[I2C_PIN_PORTS];
+	GPIO_TypeDef *scl_port;			// the lines, driven as GPIO by the bus recovery
+	GPIO_TypeDef *sda_port;
+	uint8_t scl_pin;
+	uint8_t sda_pin;
+	i2c_it_xfer_t xfer;
+	i2c_it_xfer_t queue[I2C_IT_QUEUE_LEN];	// started by the event handler, oldest first
+	volatile uint8_t q_head;
+	volatile uint8_t q_count;
+	volatile uint8_t recover;		// a failed interrupt driven read left the bus to be recovered
+	i2c_stats_t stats;
+} i2c_handle_t;
+
+extern i2c_handle_t i2c1, i2c2, i2c3;
+
+void i2c_init(i2c_handle_t *h);
+int i2c_byte_read(i2c_handle_t *h, char saddr, char maddr, char* data);
+int i2c_burst_read(i2c_handle_t *h, char saddr, char maddr, int n, char* data);
+int i2c_burst_write(i2c_handle_t *h, char saddr, char maddr, int n, char* data);
+int i2c_burst_read_it(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint8_t task, uint8_t sig);
+int i2c_busy(const i2c_handle_t *h);
+int i2c_it_poll(i2c_handle_t *h);
+void i2c_recover(i2c_handle_t *h);
+RAM_FUNC void i2c_ev_handler(i2c_handle_t *h);
+void i2c_er_handler(i2c_handle_t *h);
 
 #endif /* INC_I2C_H_ */
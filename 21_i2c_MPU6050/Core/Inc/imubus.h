@@ -0,0 +1,83 @@
+/**
+ * imubus.h
+ *	@brief interleaved burst reads of several MPU6050 on one I2C bus
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * One round per tick: imubus_tick() queues the data burst of every device
+ * of the bus at once (MPU6050_read_all_IT: 14 bytes, more with an
+ * auxiliary sensor), and the I2C event handler starts each read right
+ * after the STOP of the one before (i2c.h).
+ * Between two reads the bus is idle for the STOP/START gap only, not for
+ * a trip through the scheduler.
+ *
+ * The devices are read in the order they were added, always, so device k
+ * is sampled at the same offset from the tick every round: the skew between
+ * the sensors is constant, about k reads (1.6 ms at 100 kHz), and measured
+ * (offset_max). The samples of one round go out as one row: they are
+ * published together when the round closes, and a partial round (a read
+ * that failed on the bus or could not be started) publishes none, so the
+ * sample rings of the devices never get out of step.
+ *
+ * The completion events arrive in the order of the reads; the task owning
+ * the bus calls imubus_done() on each (with the arg of the event, 0 for a
+ * read that failed on the bus) and gets 1 when the round is complete.
+ *
+ * Statistics since imubus_stats_reset(), in DWT cycles:
+ *   load        bus busy (tick to last completion) over elapsed time
+ *   efficiency  wire time of the reads (IMUBUS_READ_BITS) over busy time,
+ *               what is left is the gaps between reads and event latency
+ * The cycle sums wrap after 2^32 cycles (268 s at 16 MHz); reset more often.
+ * imubus_report() sends them as a TELEM_TYPE_BUS frame (Host/telemcat
+ * prints it) and starts a new window.
+ *
+ * Host/imubuscheck runs it against simulated sensors on the I2C model.
+ */
+
+#ifndef INC_IMUBUS_H_
+#define INC_IMUBUS_H_
+
+#include <stdint.h>
+#include "MPU6050.h"
+
+#define IMUBUS_MAX_DEVICES		(1 + I2C_IT_QUEUE_LEN)	// one read in flight, the rest queued
+#define IMUBUS_BIT_RATE			(100000U)				// standard mode, i2c.c
+/* START, address + W, register, re-START, address + R, n bytes: 9 bits per byte with ACK,
+   up to the last byte, where the completion is posted; the STOP after it is gap */
+#define IMUBUS_READ_BITS(n)		(1U + 9U + 9U + 1U + 9U + 9U * (n))
+
+typedef struct {
+	uint32_t rounds;			// complete rounds
+	uint32_t overruns;			// ticks while the previous round was still on the bus
+	uint32_t errors;			// reads that could not be started or failed on the bus
+	uint32_t partial;			// rounds dropped for those errors
+	uint32_t busy;				// tick to last completion, summed over the rounds
+	uint32_t wire;				// wire time of the reads of those rounds
+	uint32_t round_max;			// longest round
+	uint32_t offset_max[IMUBUS_MAX_DEVICES];	// latest completion of device k after the tick
+	uint32_t since;				// DWT at imubus_stats_reset()
+} imubus_stats_t;
+
+typedef struct {
+	mpu6050_t *dev[IMUBUS_MAX_DEVICES];
+	uint8_t n;
+	uint8_t task;				// completion events of the reads
+	uint8_t sig;
+	uint8_t started[IMUBUS_MAX_DEVICES];	// devices read this round, in bus order
+	uint8_t pending;			// reads of the round still running
+	uint8_t done;				// reads of the round completed
+	uint8_t lost;				// reads of the round failed or not started
+	uint32_t stamp;				// DWT at the tick of the round
+	imubus_stats_t stats;
+} imubus_t;
+
+void imubus_init(imubus_t *b, uint8_t task, uint8_t sig);
+int imubus_add(imubus_t *b, mpu6050_t *dev);
+int imubus_tick(imubus_t *b);
+int imubus_done(imubus_t *b, uint16_t arg);
+void imubus_stats_reset(imubus_t *b);
+uint32_t imubus_load_permille(const imubus_t *b);
+uint32_t imubus_efficiency_permille(const imubus_t *b);
+int imubus_report(imubus_t *b);
+
+#endif /* INC_IMUBUS_H_ */
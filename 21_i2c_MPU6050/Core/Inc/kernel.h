@@ -0,0 +1,122 @@
+/**
+ * kernel.h
+ *	@brief header file for the preemptive priority kernel
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Small preemptive kernel:
+ *  - up to 32 priorities (0 = highest), round robin inside a priority
+ *  - O(1) ready queue: one bit per priority, highest found with CLZ
+ *  - PendSV context switch with lazy FPU stacking (kernel_port.c)
+ *  - counting semaphores and fixed item size message queues with timeouts
+ *  - tickless idle: SysTick is stretched over the idle period
+ *
+ * Usage:
+ *  os_init();
+ *  os_task_create(&tcb, "imu", imu_thread, 0, imu_stack, 256, 1);
+ *  os_start();		// never returns
+ *
+ * SysTick_Handler must call os_tick(). Calls that can block (take/send/
+ * receive with a timeout, os_delay) are for tasks only; ISRs may give
+ * semaphores and send/receive with a timeout of 0.
+ * Do not combine with the cooperative scheduler timers (sched.h) since
+ * tickless idle stretches SysTick.
+ */
+
+#ifndef INC_KERNEL_H_
+#define INC_KERNEL_H_
+
+#include <stdint.h>
+
+#define OS_MAX_PRIO				(32)
+#define OS_IDLE_PRIO			(OS_MAX_PRIO - 1)
+#define OS_TICK_HZ				(1000)
+#define OS_IDLE_STACK_WORDS		(128)
+#define OS_TICKLESS_MIN_TICKS	(2)			// only stretch SysTick for idle periods this long
+#define OS_WAIT_FOREVER			(0xFFFFFFFFU)
+
+/* return codes */
+#define OS_OK					(0)
+#define OS_ERR_TIMEOUT			(-1)
+#define OS_ERR_PARAM			(-2)
+
+typedef enum {
+	OS_TASK_READY = 0,
+	OS_TASK_BLOCKED,		// waiting on a semaphore/queue and/or a delay
+	OS_TASK_DORMANT			// returned from its entry function
+} os_task_state_t;
+
+typedef struct os_tcb {
+	uint32_t *sp;					// saved PSP; must stay the first member (PendSV)
+	struct os_tcb *next;			// ready list or wait list link
+	struct os_tcb *dnext;			// delay list link
+	struct os_tcb **wait_list;		// wait list the task is queued on, if any
+	uint32_t wake_tick;				// tick at which a delay/timeout expires
+	int32_t wait_result;			// OS_OK or OS_ERR_TIMEOUT
+	uint8_t prio;
+	uint8_t state;
+	uint8_t delayed;				// on the delay list
+	uint32_t *stack_base;			// lowest stack word
+	uint32_t stack_words;
+	const char *name;
+} os_tcb_t;
+
+typedef struct {
+	volatile uint32_t count;
+	os_tcb_t *waiters;				// priority ordered
+} os_sem_t;
+
+typedef struct {
+	uint8_t *buf;
+	uint32_t item_size;
+	uint32_t len;
+	uint32_t head;
+	uint32_t tail;
+	os_sem_t items;					// filled slots
+	os_sem_t spaces;				// free slots
+} os_queue_t;
+
+/* counters, readable from the debugger (Live Expressions) */
+typedef struct {
+	uint32_t ctxsw_count;
+	uint32_t ctxsw_cycles_last;		// cycles spent in PendSV for the last switch
+	uint32_t ctxsw_cycles_max;		// worst case seen
+	uint32_t idle_ticks_suppressed;	// ticks slept through by tickless idle
+	uint32_t tickless_entries;
+} os_stats_t;
+
+extern volatile os_stats_t os_stats;
+extern os_tcb_t * volatile os_current;
+extern os_tcb_t * volatile os_next;
+
+void os_init(void);
+int os_task_create(os_tcb_t *tcb, const char *name, void (*entry)(void *), void *arg,
+		uint32_t *stack, uint32_t stack_words, uint8_t prio);
+void os_start(void);
+void os_tick(void);
+uint32_t os_time(void);
+void os_delay(uint32_t ticks);
+void os_yield(void);
+
+void os_sem_init(os_sem_t *sem, uint32_t count);
+int os_sem_take(os_sem_t *sem, uint32_t timeout);
+int os_sem_give(os_sem_t *sem);
+
+void os_queue_init(os_queue_t *q, void *buf, uint32_t item_size, uint32_t len);
+int os_queue_send(os_queue_t *q, const void *item, uint32_t timeout);
+int os_queue_receive(os_queue_t *q, void *item, uint32_t timeout);
+
+/* kernel internals shared with the port (kernel_port.c) */
+uint32_t os_idle_ticks(void);
+void os_tick_advance(uint32_t ticks);
+int os_ready_above_idle(void);
+void os_task_exit(void);
+
+/* port layer, implemented in kernel_port.c */
+void os_port_init_stack(os_tcb_t *tcb, void (*entry)(void *), void *arg);
+void os_port_start(void);
+void os_port_request_switch(void);
+uint32_t os_port_tick_step(void);
+void os_port_tickless_idle(uint32_t ticks);
+
+#endif /* INC_KERNEL_H_ */
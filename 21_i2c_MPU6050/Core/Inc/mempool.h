@@ -0,0 +1,71 @@
+/**
+ * mempool.h
+ *	@brief header file for the fixed-block memory pool
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Replaces the newlib heap (_sbrk in sysmem.c growing toward the stack,
+ * first fit malloc with unbounded search time) with fixed-size blocks in a
+ * few size classes:
+ *
+ *   class   block   blocks   bytes
+ *   0       16      32       512
+ *   1       32      32       1024
+ *   2       64      16       1024
+ *   3       128     8        1024
+ *   4       256     4        1024
+ *                            4608 in the .mempool section (NOLOAD)
+ *
+ * A request takes a block of the smallest class that fits; when that class
+ * is empty the next larger one is used (counted as a spill). Allocation and
+ * release pop/push a free list under a short critical section, so both are
+ * O(POOL_CLASSES) at worst and safe from tasks and ISRs alike.
+ * Blocks are POOL_ALIGN aligned. Freed blocks go back to their own class,
+ * so the pool cannot fragment: once everything is freed the full capacity
+ * is available again. Requests above POOL_MAX_BLOCK always fail.
+ *
+ * On the target malloc/free/calloc/realloc and newlib's _malloc_r family are
+ * redirected here, so _sbrk is no longer linked in. Host/poolcheck exercises
+ * the pool on a PC (exhaustion, spills, fragmentation patterns, bad frees).
+ */
+
+#ifndef INC_MEMPOOL_H_
+#define INC_MEMPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define POOL_CLASSES			(5)
+#define POOL_ALIGN				(8)
+#define POOL_MAX_BLOCK			(256)
+#define POOL_CLASS_SIZES		{16, 32, 64, 128, 256}		// multiples of POOL_ALIGN, ascending
+#define POOL_CLASS_BLOCKS		{32, 32, 16, 8, 4}
+#define POOL_TOTAL_BLOCKS		(32 + 32 + 16 + 8 + 4)
+#define POOL_BYTES				(16 * 32 + 32 * 32 + 64 * 16 + 128 * 8 + 256 * 4)
+
+typedef struct {
+	uint16_t size;				// block size, bytes
+	uint16_t blocks;			// blocks in the class
+	uint16_t used;				// blocks handed out now
+	uint16_t high_water;		// most blocks ever handed out at once
+	uint32_t allocs;			// blocks handed out in total
+	uint32_t empty;				// requests that found the class empty
+} pool_class_stats_t;
+
+typedef struct {
+	pool_class_stats_t cls[POOL_CLASSES];
+	uint32_t spills;			// served from a larger class
+	uint32_t failures;			// NULL returned (all fitting classes empty, or too large)
+	uint32_t bad_frees;			// pointer not at the start of a pool block
+	uint32_t double_frees;		// block already free
+} pool_stats_t;
+
+extern volatile pool_stats_t pool_stats;
+
+void pool_init(void);
+void pool_reset(void);
+void *pool_alloc(size_t size);
+void pool_free(void *p);
+size_t pool_block_size(const void *p);
+
+#endif /* INC_MEMPOOL_H_ */
@@ -0,0 +1,67 @@
+/**
+ * power.h
+ *	@brief header file for the Stop mode between motion, woken by the MPU6050 INT line
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The MPU6050 INT pin goes to PA0 (EXTI0, rising edge; the sensor drives it
+ * push-pull, active high, latched until read, MPU6050_wom_enter()).
+ *
+ * The scheduler calls power_idle() instead of WFI (sched_idle_set). It is
+ * WFI (Sleep: the core stops, peripherals and SysTick run) until
+ * power_stop_arm(), called before the sensor enters wake on motion; from
+ * then on, until the EXTI0 wake or power_stop_disarm(), every idle enters
+ * Stop mode: all clocks
+ * off but LSI, low-power regulator, flash powered down. Only an EXTI line
+ * wakes it; the USART2 receiver does not, so commands wait for motion.
+ * Stop is entered only once the USART2 TX ring is drained. The EXTI0
+ * interrupt disarms Stop and posts the wake event. The core runs on HSI,
+ * which is also the clock after Stop: nothing to restore.
+ *
+ * SysTick and the DWT counter stop with the clocks, so the time base across
+ * Stop is the RTC on LSI (~32 kHz, +-50%: use the ticks for ratios). It
+ * counts POWER_RTC_HZ ticks per RTC second, read without the shadow
+ * registers. Statistics (power_stats, also for Live Expressions):
+ *   run / stop ticks   RTC ticks awake (Run and Sleep) and in Stop; the duty
+ *                      cycle is run / (run + stop)
+ *   latency            EXTI0 interrupt to the first complete sample after it,
+ *                      in DWT cycles (power_wake_sampled); the regulator
+ *                      and flash wake-up before the interrupt (datasheet
+ *                      tWUSTOP) is not in it
+ */
+
+#ifndef INC_POWER_H_
+#define INC_POWER_H_
+
+#include <stdint.h>
+
+/* PA0 = MPU6050 INT: input, pull-down */
+#define POWER_INT_PINS(PIN) \
+	PIN(0, PIN_MODE_IN, PIN_KEEP, PIN_KEEP, PIN_PULL_DOWN, 0)
+
+#define POWER_RTC_PREDIV_A		(0)			// ck_apre = LSI
+#define POWER_RTC_PREDIV_S		(0x7FFF)	// 32768 ticks per RTC second
+#define POWER_RTC_HZ			(POWER_RTC_PREDIV_S + 1U)
+#define POWER_RTC_WRAP			(86400U * POWER_RTC_HZ)		// ticks per RTC day
+
+typedef struct {
+	uint32_t stops;				// Stop mode entries
+	uint32_t wakes;				// EXTI0 interrupts
+	uint32_t run_ticks;			// RTC ticks awake
+	uint32_t stop_ticks;		// RTC ticks in Stop
+	uint32_t latency_last;		// wake to first sample, DWT cycles
+	uint32_t latency_max;
+} power_stats_t;
+
+extern volatile power_stats_t power_stats;
+
+void power_init(uint8_t task, uint8_t sig);
+void power_stop_arm(void);
+void power_stop_disarm(void);
+void power_idle(void);
+void power_wake_sampled(void);
+uint32_t power_rtc_now(void);
+uint32_t power_duty_permille(void);
+void power_exti_irq_handler(void);
+
+#endif /* INC_POWER_H_ */
@@ -0,0 +1,168 @@
+/**
+ * ring.h
+ *	@brief lock-free single-producer / single-consumer ring buffers
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * RING_DECLARE(name, type, size) generates a ring type name_t holding
+ * size elements of type (size must be a power of two) and static inline
+ * functions name_push(), name_pop(), ... operating on it.
+ *
+ * One context (ISR, DMA completion or task) produces and exactly one
+ * consumes. head is only written by the producer and tail only by the
+ * consumer. Both are free running, so count = head - tail and no slot
+ * is wasted. Element data is written before head is published and read
+ * before tail is released. A barrier sits between the two in each case,
+ * which also orders the accesses against DMA on the Cortex-M4.
+ *
+ * Zero copy:
+ *  producer: p = name_write_reserve(&r, &n); fill p[0..k-1] (CPU or DMA); name_write_commit(&r, k);
+ *  consumer: p = name_read_peek(&r, &n);     use p[0..k-1];               name_read_release(&r, k);
+ * Both return the longest contiguous run (up to the wrap point).
+ *
+ * head and tail are padded to RING_CACHE_LINE so they do not share a
+ * cache line on a host build. The Cortex-M4 has no data cache, so no
+ * padding is used there.
+ */
+
+#ifndef INC_RING_H_
+#define INC_RING_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "atomic.h"
+
+#if defined(__arm__)
+#define RING_CACHE_LINE				(4)
+#else
+#define RING_CACHE_LINE				(64)
+#endif
+
+#define RING_ALIGNED				__attribute__((aligned(RING_CACHE_LINE)))
+
+#define RING_DECLARE(name, type, size)														\
+																							\
+_Static_assert(((size) & ((size) - 1)) == 0 && (size) > 1, #name " size must be a power of two");	\
+																							\
+typedef struct {																			\
+	volatile uint32_t head RING_ALIGNED;		/* written by the producer only */			\
+	volatile uint32_t tail RING_ALIGNED;		/* written by the consumer only */			\
+	type buf[size] RING_ALIGNED;															\
+} name##_t;																					\
+																							\
+/* void name_init(name_t *r): empty the ring (no producer/consumer may be active) */		\
+static inline void name##_init(name##_t *r){												\
+	r->head = 0;																			\
+	r->tail = 0;																			\
+}																							\
+																							\
+/* uint32_t name_count(const name_t *r): elements ready to pop */							\
+static inline uint32_t name##_count(const name##_t *r){										\
+	return r->head - r->tail;																\
+}																							\
+																							\
+/* uint32_t name_space(const name_t *r): elements that can be pushed */						\
+static inline uint32_t name##_space(const name##_t *r){										\
+	return (size) - (r->head - r->tail);													\
+}																							\
+																							\
+/* int name_push(name_t *r, const type *item): 0 on success, -1 when full */				\
+static inline int name##_push(name##_t *r, const type *item){								\
+	uint32_t head = r->head;																\
+	if(head - r->tail >= (size)){															\
+		return -1;																			\
+	}																						\
+	r->buf[head & ((size) - 1)] = *item;													\
+	ATOMIC_BARRIER();																		\
+	r->head = head + 1U;																	\
+	return 0;																				\
+}																							\
+																							\
+/* int name_pop(name_t *r, type *item): 0 on success, -1 when empty */						\
+static inline int name##_pop(name##_t *r, type *item){										\
+	uint32_t tail = r->tail;																\
+	if(r->head == tail){																	\
+		return -1;																			\
+	}																						\
+	ATOMIC_BARRIER();																		\
+	*item = r->buf[tail & ((size) - 1)];													\
+	ATOMIC_BARRIER();																		\
+	r->tail = tail + 1U;																	\
+	return 0;																				\
+}																							\
+																							\
+/* uint32_t name_push_bulk(name_t *r, const type *items, uint32_t n): number pushed */		\
+static inline uint32_t name##_push_bulk(name##_t *r, const type *items, uint32_t n){		\
+	uint32_t head = r->head;																\
+	uint32_t idx = head & ((size) - 1);														\
+	uint32_t first;																			\
+	uint32_t space = (size) - (head - r->tail);												\
+	if(n > space){																			\
+		n = space;																			\
+	}																						\
+	first = (size) - idx;																	\
+	if(first > n){																			\
+		first = n;																			\
+	}																						\
+	memcpy(&r->buf[idx], items, first * sizeof(type));										\
+	memcpy(&r->buf[0], items + first, (n - first) * sizeof(type));							\
+	ATOMIC_BARRIER();																		\
+	r->head = head + n;																		\
+	return n;																				\
+}																							\
+																							\
+/* uint32_t name_pop_bulk(name_t *r, type *items, uint32_t n): number popped */				\
+static inline uint32_t name##_pop_bulk(name##_t *r, type *items, uint32_t n){				\
+	uint32_t tail = r->tail;																\
+	uint32_t idx = tail & ((size) - 1);														\
+	uint32_t first;																			\
+	uint32_t count = r->head - tail;														\
+	if(n > count){																			\
+		n = count;																			\
+	}																						\
+	first = (size) - idx;																	\
+	if(first > n){																			\
+		first = n;																			\
+	}																						\
+	ATOMIC_BARRIER();																		\
+	memcpy(items, &r->buf[idx], first * sizeof(type));										\
+	memcpy(items + first, &r->buf[0], (n - first) * sizeof(type));							\
+	ATOMIC_BARRIER();																		\
+	r->tail = tail + n;																		\
+	return n;																				\
+}																							\
+																							\
+/* type *name_write_reserve(name_t *r, uint32_t *n): contiguous free slots, *n = how many */	\
+static inline type *name##_write_reserve(name##_t *r, uint32_t *n){							\
+	uint32_t head = r->head;																\
+	uint32_t idx = head & ((size) - 1);														\
+	uint32_t space = (size) - (head - r->tail);												\
+	uint32_t run = (size) - idx;															\
+	*n = (space < run) ? space : run;														\
+	return &r->buf[idx];																	\
+}																							\
+																							\
+/* void name_write_commit(name_t *r, uint32_t n): publish n reserved slots */				\
+static inline void name##_write_commit(name##_t *r, uint32_t n){							\
+	ATOMIC_BARRIER();																		\
+	r->head = r->head + n;																	\
+}																							\
+																							\
+/* type *name_read_peek(name_t *r, uint32_t *n): contiguous filled slots, *n = how many */	\
+static inline type *name##_read_peek(name##_t *r, uint32_t *n){								\
+	uint32_t tail = r->tail;																\
+	uint32_t idx = tail & ((size) - 1);														\
+	uint32_t count = r->head - tail;														\
+	uint32_t run = (size) - idx;															\
+	*n = (count < run) ? count : run;														\
+	ATOMIC_BARRIER();																		\
+	return &r->buf[idx];																	\
+}																							\
+																							\
+/* void name_read_release(name_t *r, uint32_t n): hand n peeked slots back to the producer */	\
+static inline void name##_read_release(name##_t *r, uint32_t n){							\
+	ATOMIC_BARRIER();																		\
+	r->tail = r->tail + n;																	\
+}
+
+#endif /* INC_RING_H_ */
@@ -0,0 +1,61 @@
+/**
+ * sched.h
+ *	@brief header file for the cooperative event scheduler
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Run-to-completion scheduler. Each task is a handler bound to a priority
+ * level; ISRs and tasks post events to a task and the main loop dispatches
+ * them one at a time, highest priority level first (0 = highest).
+ * When no event is pending the core sleeps in WFI, or in the idle hook
+ * installed with sched_idle_set() (called with interrupts masked; it must
+ * return with them still masked, e.g. after WFI, power.c).
+ *
+ * sched_post() is lock-free and may be called from any ISR priority.
+ */
+
+#ifndef INC_SCHED_H_
+#define INC_SCHED_H_
+
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS			(8)
+#define SCHED_PRIO_LEVELS		(4)		// 0 = highest
+#define SCHED_QUEUE_LEN			(16)	// events per priority level, must be a power of two
+#define SCHED_MAX_TIMERS		(4)
+#define SCHED_TICK_HZ			(1000)
+
+typedef struct {
+	uint8_t task;		// destination task id
+	uint8_t sig;		// event signal, defined by the task
+	uint16_t arg;		// optional argument (byte count, status, ...)
+	uint32_t stamp;		// DWT cycle count when the event was posted
+} sched_event_t;
+
+typedef void (*sched_handler_t)(const sched_event_t *e);
+typedef void (*sched_idle_t)(void);
+
+/* counters, readable from the debugger (Live Expressions) */
+typedef struct {
+	uint32_t posted;
+	uint32_t dispatched;
+	uint32_t dropped;						// queue full on post
+	uint32_t idle_entries;					// WFI / idle hook entries
+	uint32_t lat_last[SCHED_PRIO_LEVELS];	// post -> dispatch latency in cycles
+	uint32_t lat_max[SCHED_PRIO_LEVELS];
+	uint32_t queue_hwm[SCHED_PRIO_LEVELS];	// deepest queue seen
+} sched_stats_t;
+
+extern volatile sched_stats_t sched_stats;
+
+void sched_init(void);
+int sched_task_add(uint8_t task, uint8_t prio, sched_handler_t handler);
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg);
+int sched_timer_start(uint8_t task, uint8_t sig, uint32_t period_ms);
+int sched_timer_set_period(uint8_t task, uint8_t sig, uint32_t period_ms);
+void sched_tick(void);
+int sched_dispatch(void);
+void sched_idle_set(sched_idle_t idle);
+void sched_run(void);
+
+#endif /* INC_SCHED_H_ */
@@ -0,0 +1,44 @@
+/**
+ * sections.h
+ *	@brief placement of data and code in the sections set up by the linker scripts
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * NOINIT	.noinit (NOLOAD, after .bss): neither copied nor cleared by
+ *			Reset_Handler, so it costs no boot time. For buffers that are
+ *			always written before they are read: DMA targets, scratch
+ *			buffers. Not for ring indices, or anything else that a call
+ *			before its init function could read (the UART TX ring stays in
+ *			.bss: printf may run before uart2_init).
+ *			Contents survive a reset that does not remove power.
+ *
+ *			static uint8_t rx_buf[256] NOINIT;
+ *
+ * RAM_FUNC	.ram_func: linked at an SRAM address, loaded in flash and copied
+ *			with .data at reset. Runs without flash wait states and keeps
+ *			running while the flash is being programmed. Called through
+ *			long_call (flash and SRAM are too far apart for BL), so put the
+ *			macro on the prototype as well as on the definition.
+ *
+ *			RAM_FUNC void i2c_ev_handler(i2c_handle_t *h);
+ *
+ *			HAL's __RAM_FUNC (.RamFunc) is linked next to it. Currently
+ *			tagged: I2C1/I2C2/I2C3_EV_IRQHandler and i2c_ev_handler.
+ *			bench_ramfunc() (bench.h) compares the same kernel run from
+ *			flash and from SRAM.
+ *
+ * Host builds ignore both.
+ */
+
+#ifndef INC_SECTIONS_H_
+#define INC_SECTIONS_H_
+
+#if defined(__arm__)
+#define NOINIT					__attribute__((section(".noinit")))
+#define RAM_FUNC				__attribute__((section(".ram_func"), noinline, long_call))
+#else
+#define NOINIT
+#define RAM_FUNC
+#endif
+
+#endif /* INC_SECTIONS_H_ */
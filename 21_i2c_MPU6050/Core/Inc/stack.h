@@ -0,0 +1,57 @@
+/**
+ * stack.h
+ *	@brief header file for stack painting and high-water-mark reporting
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Reset_Handler paints the MSP reserve (_Min_Stack_Size below _estack) and
+ * a guard of _Stack_Guard_Size bytes below it with STACK_PAINT before
+ * anything else runs. Kernel task stacks are painted by os_task_create().
+ * The deepest point a stack ever reached is then found by scanning up from
+ * its bottom for the first word that no longer holds the pattern.
+ *
+ *   _estack  ------------------ top, MSP starts here
+ *            |  MSP reserve   |  _Min_Stack_Size
+ *            |----------------|
+ *            |  guard         |  _Stack_Guard_Size, never legitimately used
+ *            ------------------
+ *            |  free RAM      |
+ *
+ * With STACK_GUARD_CHECK (default on) SysTick checks the MSP guard and the
+ * lowest STACK_TASK_GUARD_WORDS of the running kernel task every tick
+ * (a few tens of cycles); a damaged guard is recorded in stack_stats and
+ * stack_overflow() is called.
+ * The figures go out as TELEM_TYPE_STACK frames (see main.c), so the
+ * reserve can be sized from real runs.
+ */
+
+#ifndef INC_STACK_H_
+#define INC_STACK_H_
+
+#include <stdint.h>
+
+#define STACK_PAINT				(0xA5A5A5A5U)	// same value in startup_stm32f411retx.s
+#define STACK_TASK_GUARD_WORDS	(4)
+
+#ifndef STACK_GUARD_CHECK
+#define STACK_GUARD_CHECK		(1)
+#endif
+
+typedef struct {
+	uint32_t guard_breaches;	// ticks on which a guard was found damaged
+	uint32_t breach_sp;			// MSP, or the task's PSP, at the first breach
+	const char *breach_task;	// 0 for the MSP, otherwise the kernel task name
+} stack_stats_t;
+
+extern volatile stack_stats_t stack_stats;
+
+uint32_t stack_msp_size(void);
+uint32_t stack_guard_size(void);
+uint32_t stack_msp_used(void);
+int stack_msp_guard_ok(void);
+void stack_paint(uint32_t *base, uint32_t words);
+uint32_t stack_used(const uint32_t *base, uint32_t words);
+void stack_check(void);
+void stack_overflow(void);
+
+#endif /* INC_STACK_H_ */
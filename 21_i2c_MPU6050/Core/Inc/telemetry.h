@@ -0,0 +1,86 @@
+/**
+ * telemetry.h
+ *	@brief header file for the binary telemetry protocol
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Frame, little endian, before stuffing:
+ *
+ *   offset  size  field
+ *   0       1     type (TELEM_TYPE_*)
+ *   1       2     seq, per link, +1 every frame sent or dropped
+ *   3       4     stamp, microseconds since boot
+ *   7       n     payload: int16 values, or a byte block for packed types
+ *   7+n     4     CRC-32/MPEG-2 over bytes 0 .. 6+n
+ *
+ * The frame is COBS encoded and followed by one 0x00. An IMU sample
+ * (7 values) is 27 bytes on the wire against ~60 as printf text.
+ *
+ * telem_encode()/telem_decode() are plain codecs shared with the host tools
+ * (Host/); telem_send() and telem_send_bytes() (telemetry_tx.c) stamp,
+ * number and queue frames on the USART2 TX ring. They never block: a frame
+ * that does not fit is dropped whole and its seq skipped, so the host sees
+ * the gap.
+ */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+#include "cobs.h"
+
+#define TELEM_HEADER_LEN		(7)
+#define TELEM_CRC_LEN			(4)
+#define TELEM_MAX_PAYLOAD		(192)
+#define TELEM_MAX_VALUES		(16)		// int16 values per telem_send()
+#define TELEM_FRAME_MAX			(TELEM_HEADER_LEN + TELEM_MAX_PAYLOAD + TELEM_CRC_LEN)
+#define TELEM_WIRE_LEN(n)		(COBS_MAX_ENCODED(TELEM_HEADER_LEN + (n) + TELEM_CRC_LEN) + 1)	// with delimiter
+#define TELEM_WIRE_MAX			TELEM_WIRE_LEN(TELEM_MAX_PAYLOAD)
+
+/* message types */
+enum {
+	TELEM_TYPE_IMU_RAW = 1,		// int16: accel x,y,z, temperature, gyro x,y,z (raw MPU6050 counts)
+	TELEM_TYPE_IMU_PACKED,		// bytes: compressed block of accel x,y,z, gyro x,y,z (compress.h)
+	TELEM_TYPE_STACK,			// int16: MSP used, MSP reserve, guard size (bytes), guard breaches (stack.h)
+	TELEM_TYPE_BOOT,			// bytes: core clock, cycles at each boot stage, uint32 (boot.h)
+	TELEM_TYPE_BUS,				// bytes: IMU bus rounds, load, efficiency, offsets, uint32 (imubus.h)
+	TELEM_TYPE_REPLY			// bytes: ASCII reply to a command line, "ok ...", "err" or "busy" (main.c)
+};
+
+/* TELEM_TYPE_BUS payload, uint32 little endian: core clock in Hz, rounds,
+   overruns, errors, load and efficiency in permille, round_max, devices,
+   then offset_max of each device; times in cycles (imubus.h) */
+#define TELEM_BUS_REPORT_HEAD	(8)
+#define TELEM_BUS_REPORT_LEN(n)	(4 * (TELEM_BUS_REPORT_HEAD + (n)))
+
+typedef struct {
+	uint8_t type;
+	uint16_t seq;
+	uint32_t stamp;
+	uint16_t len;				// payload bytes
+	uint8_t payload[TELEM_MAX_PAYLOAD];
+} telem_msg_t;
+
+/* TX counters, readable from the debugger (Live Expressions) */
+typedef struct {
+	uint32_t frames;			// frames queued
+	uint32_t bytes;				// wire bytes queued
+	uint32_t drops;				// frames lost to a full TX ring
+} telem_stats_t;
+
+extern volatile telem_stats_t telem_stats;
+
+/**
+ * int16_t telem_value(const telem_msg_t *msg, uint32_t i)
+ * @brief i-th int16 value of a payload of values
+ */
+static inline int16_t telem_value(const telem_msg_t *msg, uint32_t i){
+	return (int16_t)(msg->payload[2 * i] | msg->payload[2 * i + 1] << 8);
+}
+
+uint32_t telem_encode(uint8_t type, uint16_t seq, uint32_t stamp, const uint8_t *payload, uint32_t len, uint8_t *wire);
+int telem_decode(const uint8_t *wire, uint32_t len, telem_msg_t *msg);
+int telem_send(uint8_t type, uint32_t cycles, const int16_t *values, uint8_t count);
+int telem_send_bytes(uint8_t type, uint32_t cycles, const uint8_t *payload, uint32_t len);
+
+#endif /* INC_TELEMETRY_H_ */
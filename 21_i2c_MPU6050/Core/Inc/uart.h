@@ -0,0 +1,119 @@
+/**
+ * uart.h
+ *	@brief header file for the USART2 driver
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * PA2 -> USART2_TX (AF7, ST-LINK virtual COM port)
+ * PA3 -> USART2_RX (AF7)
+ *
+ * TX is non-blocking: uart2_write() (and _write, so printf) copies into a
+ * ring buffer and returns; DMA1 Stream6 drains the ring in contiguous chunks.
+ * Thread code and ISRs may both write: each write is copied in with
+ * interrupts masked. uart2_tx_reserve/commit (zero copy) is thread mode only.
+ * uart2_printf() formats with fmt.c instead of newlib printf, which keeps
+ * _sbrk/malloc and the newlib float conversion out of the image.
+ *
+ * RX runs DMA1 Stream5 in circular mode into a fixed buffer. The IDLE line
+ * interrupt (one per burst) and the DMA half/full interrupts (long bursts)
+ * cut what arrived into chunks {pointer, length} that point straight into
+ * the DMA buffer; nothing is copied. A message that wraps around the end
+ * of the buffer arrives as two chunks, the last one flagged end.
+ *
+ *  const uint8_t *p;
+ *  while((p = uart2_rx_peek(&len, &end)) != 0){ use p[0..len-1]; uart2_rx_release(); }
+ *
+ * Chunks must be released before the DMA comes round again
+ * (UART_RX_DMA_LEN bytes later), otherwise overruns is counted.
+ *
+ * Line rate, 8N1 = 10 bits per byte, PCLK1 = 16 MHz (HSI, no PLL), computed
+ * from the USARTDIV formula of RM0383, not measured on the line:
+ *
+ *   baud      oversampling  USARTDIV  actual   error   bytes/s  cycles/byte
+ *   115200    16            8.6875    115108   -0.08%  11520    1389
+ *   921600    16            1.0625    941176   +2.12%  92160    174
+ *   1000000   16            1.0       1000000   0.00%  100000   160
+ *   2000000   8             1.0       2000000   0.00%  200000   80
+ *
+ * The rate is PCLK1 / n for an integer n (n >= 16, or >= 8 with OVER8).
+ * At 921600 that is 2.12% off, which uses up most of the ~3.4% the
+ * receiver tolerates (RM0383 USART receiver tolerance) before the host's
+ * own error is added. Use 1000000 or 2000000, which divide 16 MHz exactly,
+ * or run PCLK1 from the PLL.
+ * The HSI itself is trimmed to 1% at 25 C, which the table leaves out.
+ * At 2 Mbaud a byte per interrupt leaves 80 cycles per byte for entry,
+ * exit and the handler, i.e. most of the CPU; with DMA + IDLE it is one
+ * interrupt per burst plus one per UART_RX_DMA_LEN / 2 bytes.
+ * uart2_line reports the rate actually programmed.
+ */
+
+#ifndef INC_UART_H_
+#define INC_UART_H_
+
+#include <stdint.h>
+
+#define UART_TX_RING_LEN		(1024)		// power of two
+#define UART_PRINTF_MAX			(128)		// uart2_printf line buffer, longer output is cut
+#define UART_RX_DMA_LEN			(256)		// circular DMA buffer, bytes
+#define UART_RX_CHUNKS			(16)		// chunk descriptors, power of two
+
+/* what uart2_write does when the TX ring is full */
+typedef enum {
+	UART_TX_BLOCK = 0,		// wait for DMA to free space (drops instead when called from an ISR)
+	UART_TX_DROP,			// keep what is queued, drop the bytes that do not fit
+	UART_TX_OVERWRITE		// discard queued bytes not yet handed to DMA, keep the newest
+} uart_tx_policy_t;
+
+/* counters, readable from the debugger (Live Expressions) */
+typedef struct {
+	uint32_t queued;		// bytes accepted into the ring
+	uint32_t sent;			// bytes completed by DMA
+	uint32_t dropped;		// bytes refused (DROP policy, BLOCK from an ISR, ISR during a reservation)
+							// or lost with a run that hit a DMA transfer error
+	uint32_t overwritten;	// queued bytes discarded (OVERWRITE policy)
+	uint32_t overflows;		// writes that found the ring full
+	uint32_t dma_chunks;	// DMA transfers started
+	uint32_t dma_errors;	// DMA transfers ended by a transfer error
+} uart_tx_stats_t;
+
+typedef struct {
+	uint32_t bytes;			// bytes received
+	uint32_t chunks;		// chunks handed to the application
+	uint32_t frames;		// idle-terminated bursts
+	uint32_t irqs;			// IDLE + DMA half/full interrupts
+	uint32_t burst_max;		// longest burst seen, bytes
+	uint32_t overruns;		// DMA wrapped onto data not yet released
+	uint32_t chunk_drops;	// chunk ring full, data discarded
+	uint32_t line_errors;	// framing, noise or overrun flags on USART2
+} uart_rx_stats_t;
+
+/* baud rate actually programmed */
+typedef struct {
+	uint32_t requested;
+	uint32_t actual;
+	int32_t error_ppm;
+	uint8_t over8;
+} uart_line_t;
+
+extern volatile uart_tx_stats_t uart_tx_stats;
+extern volatile uart_rx_stats_t uart_rx_stats;
+extern uart_line_t uart2_line;
+
+void uart2_init(uint32_t baud);
+void uart2_set_tx_policy(uart_tx_policy_t policy);
+int uart2_write(const char *data, int len);
+int uart2_printf(const char *format, ...);
+uint32_t uart2_tx_space(void);
+uint8_t *uart2_tx_reserve(uint32_t *n);
+void uart2_tx_commit(uint32_t n);
+void uart2_flush(void);
+int uart2_tx_idle(void);
+void uart2_tx_dma_irq_handler(void);
+
+void uart2_rx_notify(uint8_t task, uint8_t sig);
+const uint8_t *uart2_rx_peek(uint32_t *len, int *end);
+void uart2_rx_release(void);
+void uart2_rx_dma_irq_handler(void);
+void uart2_irq_handler(void);
+
+#endif /* INC_UART_H_ */
@@ -7,78 +7,628 @@
 
 #include "stm32f4xx.h"
 #include "MPU6050.h"
+#include "boot.h"
 #define GPIOAEN 			(1U << 0)
 #define PIN5				(1U << 5)
 #define LED_PIN				PIN5
 
-char data;
+/* shadow bytes that may be written: block A has read-only and undocumented holes */
+#define SHADOW_WRITABLE		(0x0000000FULL		/* SMPLRT_DIV .. ACCEL_CONFIG */		\
+							| (1ULL << 6)		/* MOT_THR */							\
+							| (0x3FFFFULL << 10)	/* FIFO_EN .. I2C_SLV4_CTRL */		\
+							| (3ULL << 30)		/* INT_PIN_CFG, INT_ENABLE */			\
+							| (0x3FFULL << 32))	/* I2C_SLV0_DO .. PWR_MGMT_2 */
+
+/* bits the device clears itself once acted on; the shadow clears them after a flush */
+static const struct {
+	uint8_t reg;
+	uint8_t mask;
+} self_clearing[] = {
+	{ I2C_SLV4_CTRL_R, 0x80 },	// I2C_SLV4_EN
+	{ 0x68, 0x07 },				// SIGNAL_PATH_RESET: GYRO, ACCEL, TEMP_RESET
+	{ USER_CTRL_R, 0x07 },		// FIFO_RESET, I2C_MST_RESET, SIG_COND_RESET
+	{ PWR_MGMT_1_R, 0x80 },		// DEVICE_RESET
+};
+
+/* DLPF_CFG 0..6: bandwidth (Hz) and group delay (us), register map 4.3 */
+static const struct {
+	uint16_t accel_bw;
+	uint16_t accel_delay;
+	uint16_t gyro_bw;
+	uint16_t gyro_delay;
+} dlpf[MPU6050_DLPF_CFGS] = {
+	{ 260,     0, 256,   980 },		// gyro output rate 8 kHz
+	{ 184,  2000, 188,  1900 },		// 1 kHz from here on
+	{  94,  3000,  98,  2800 },
+	{  44,  4900,  42,  4800 },
+	{  21,  8500,  20,  8300 },
+	{  10, 13800,  10, 13400 },
+	{   5, 19000,   5, 18600 },
+};
 
-uint8_t data_rec[6];
 /**
- * void MPU6050_read_address (uint8_t reg)
- * @brief read address.
+ * int shadow_index(uint8_t reg)
+ * @brief index of a register in dev->shadow, -1 if it has none
  */
-void MPU6050_read_address (uint8_t reg){
-	//GPIOA->ODR = LED_PIN;
-	I2C1_byteRead(DEVICE_ADDR, reg, &data);
+static int shadow_index(uint8_t reg){
+	if(reg >= MPU6050_SHADOW_A_FIRST && reg < MPU6050_SHADOW_A_FIRST + MPU6050_SHADOW_A_LEN){
+		return reg - MPU6050_SHADOW_A_FIRST;
+	}
+	if(reg >= MPU6050_SHADOW_B_FIRST && reg < MPU6050_SHADOW_B_FIRST + MPU6050_SHADOW_B_LEN){
+		return MPU6050_SHADOW_A_LEN + reg - MPU6050_SHADOW_B_FIRST;
+	}
+	return -1;
+}
 
+/**
+ * char MPU6050_read_address(mpu6050_t *dev, uint8_t reg)
+ * @brief read address.
+ * @return the register value, 0 if the read failed
+ */
+char MPU6050_read_address(mpu6050_t *dev, uint8_t reg){
+	char data = 0;
 
+	i2c_byte_read(dev->bus, dev->addr, reg, &data);
+	return data;
 }
 /**
- * void MPU6050_write(uint8_t reg, char value)
+ * void MPU6050_write(mpu6050_t *dev, uint8_t reg, char value)
  * @brief write value to address.
  */
-void MPU6050_write(uint8_t reg, char value){
+void MPU6050_write(mpu6050_t *dev, uint8_t reg, char value){
 	char data[1];
+	int i = shadow_index(reg);
+	int rc;
+
 	data[0] = value;
+	rc = i2c_burst_write(dev->bus, dev->addr, reg, 1, data);
+
+	/* write-through: the shadow follows, still dirty if the write failed */
+	if(i >= 0){
+		dev->shadow[i] = (uint8_t)value;
+		dev->dirty = (rc == I2C_OK) ? (dev->dirty & ~(1ULL << i)) : (dev->dirty | (1ULL << i));
+	}
+}
+/**
+ * void MPU6050_read_values(mpu6050_t *dev, uint8_t reg, uint8_t *data)
+ * @brief read 6 bytes (one x/y/z triple) starting at the register
+ * @param data caller buffer of 6 bytes
+ */
+void MPU6050_read_values(mpu6050_t *dev, uint8_t reg, uint8_t *data){
+	i2c_burst_read(dev->bus, dev->addr, reg, 6, (char*)data);
+}
+/**
+ * int MPU6050_read_all_IT(mpu6050_t *dev, uint8_t task, uint8_t sig)
+ * @brief start a non-blocking read of accel, temperature, gyro and the
+ *        dev->aux_len auxiliary bytes in one burst (14 bytes without an
+ *        auxiliary sensor), straight into a reserved slot of dev->samples.
+ *        sig is posted to task when the slot is filled; the task then calls
+ *        MPU6050_read_done() to publish it. If the bus is busy with another
+ *        device the read is queued behind it (i2c.h).
+ * @step followed:
+ *
+ * 1. Refuse a second read of the same device
+ * 2. Reserve a slot in the sample ring (zero copy)
+ * 3. Stamp it and start the burst read into it
+ *
+ * @return 0 if the read was started, -1 if the ring is full, a read of the
+ *         device is still running or the bus queue is full.
+ */
+int MPU6050_read_all_IT(mpu6050_t *dev, uint8_t task, uint8_t sig){
+	mpu6050_raw_t *slot;
+	uint32_t n;
+
+	/*1. Refuse a second read of the same device*/
+	if(dev->reading){
+		return -1;
+	}
+
+	/*2. Reserve a slot in the sample ring (zero copy)*/
+	slot = mpu6050_ring_write_reserve(&dev->samples, &n);
+	if(n == 0){
+		return -1;
+	}
+
+	/*3. Stamp it and start the burst read into it*/
+	slot->stamp = DWT->CYCCNT;
+	if(i2c_burst_read_it(dev->bus, dev->addr, ACCEL_XOUT_H_REG, MPU6050_BURST_LEN + dev->aux_len,
+			(char*)slot->raw, task, sig) != 0){
+		return -1;
+	}
+	dev->reading = 1;
+	return 0;
+}
+/**
+ * void MPU6050_read_done(mpu6050_t *dev)
+ * @brief publish the slot filled by the completed MPU6050_read_all_IT
+ */
+void MPU6050_read_done(mpu6050_t *dev){
+	mpu6050_ring_write_commit(&dev->samples, 1);
+	dev->reading = 0;
+}
+/**
+ * void MPU6050_read_abort(mpu6050_t *dev)
+ * @brief the MPU6050_read_all_IT failed on the bus: drop the slot, the device may be read again
+ */
+void MPU6050_read_abort(mpu6050_t *dev){
+	dev->reading = 0;
+}
+/**
+ * uint8_t shadow_power_on(int i)
+ * @brief power-on value of shadow byte i: all 0 but PWR_MGMT_1 = 0x40, sleep
+ */
+static uint8_t shadow_power_on(int i){
+	return (i == shadow_index(PWR_MGMT_1_R)) ? 0x40 : 0;
+}
+/**
+ * void MPU6050_shadow_reset(mpu6050_t *dev)
+ * @brief shadow = power-on values, nothing dirty
+ */
+void MPU6050_shadow_reset(mpu6050_t *dev){
+	for(int i = 0; i < MPU6050_SHADOW_LEN; i++){
+		dev->shadow[i] = shadow_power_on(i);
+	}
+	dev->dirty = 0;
+}
+/**
+ * void MPU6050_shadow_rewrite(mpu6050_t *dev)
+ * @brief shadow = power-on values, every writable register dirty: the next
+ *        flush writes the whole configuration (5 bursts), whatever the
+ *        device kept over an MCU reset
+ */
+void MPU6050_shadow_rewrite(mpu6050_t *dev){
+	MPU6050_shadow_reset(dev);
+	dev->dirty = SHADOW_WRITABLE;
+}
+/**
+ * int MPU6050_shadow_load(mpu6050_t *dev)
+ * @brief read the shadowed registers from the device, 3 bursts: block A is
+ *        read around I2C_MST_STATUS, which clears its flags when read (its
+ *        byte stays 0). Nothing dirty.
+ * @return 0, -1 if a read failed (the shadow is then not to be trusted)
+ */
+int MPU6050_shadow_load(mpu6050_t *dev){
+	int i = shadow_index(I2C_MST_STATUS_R);
 
-	I2C1_burstWrite(DEVICE_ADDR, reg, 1, data);
+	if(i2c_burst_read(dev->bus, dev->addr, MPU6050_SHADOW_A_FIRST, i, (char*)&dev->shadow[0]) != I2C_OK
+			|| i2c_burst_read(dev->bus, dev->addr, I2C_MST_STATUS_R + 1, MPU6050_SHADOW_A_LEN - i - 1,
+					(char*)&dev->shadow[i + 1]) != I2C_OK
+			|| i2c_burst_read(dev->bus, dev->addr, MPU6050_SHADOW_B_FIRST, MPU6050_SHADOW_B_LEN,
+					(char*)&dev->shadow[MPU6050_SHADOW_A_LEN]) != I2C_OK){
+		return -1;
+	}
+	dev->shadow[i] = 0;
+	dev->dirty = 0;
+	return 0;
+}
+/**
+ * uint8_t MPU6050_get(const mpu6050_t *dev, uint8_t reg)
+ * @brief shadowed value of a configuration register, no bus access
+ * @return the value, 0 for a register without a shadow
+ */
+uint8_t MPU6050_get(const mpu6050_t *dev, uint8_t reg){
+	int i = shadow_index(reg);
 
+	return (i >= 0) ? dev->shadow[i] : 0;
 }
 /**
- * void MPU6050_read_values(uint8_t reg)
- * @brief read data from the register
+ * int MPU6050_set(mpu6050_t *dev, uint8_t reg, uint8_t value)
+ * @brief change a configuration register in the shadow; MPU6050_flush() writes it
+ * @return 0, -1 if the register has no shadow or is read-only
  */
-void MPU6050_read_values(uint8_t reg){
-	I2C1_burstRead(DEVICE_ADDR, reg, 6, (char*)data_rec);
+int MPU6050_set(mpu6050_t *dev, uint8_t reg, uint8_t value){
+	return MPU6050_update(dev, reg, 0xFF, value);
+}
+/**
+ * int MPU6050_update(mpu6050_t *dev, uint8_t reg, uint8_t mask, uint8_t value)
+ * @brief change the bits in mask of a configuration register in the shadow.
+ *        Marks it dirty only if its value changes.
+ * @return 0, -1 if the register has no shadow or is read-only
+ */
+int MPU6050_update(mpu6050_t *dev, uint8_t reg, uint8_t mask, uint8_t value){
+	int i = shadow_index(reg);
+	uint8_t v;
+
+	if(i < 0 || !(SHADOW_WRITABLE & (1ULL << i))){
+		return -1;
+	}
+	v = (dev->shadow[i] & ~mask) | (value & mask);
+	if(v != dev->shadow[i]){
+		dev->shadow[i] = v;
+		dev->dirty |= 1ULL << i;
+	}
+	return 0;
+}
+/**
+ * int MPU6050_flush(mpu6050_t *dev)
+ * @brief write the dirty shadow registers with as few bursts as possible
+ * @step followed:
+ *
+ * 1. Leave the bus to a running interrupt driven read: no wait, -1, the
+ *    caller flushes again later
+ * 2. Per block, block B (PWR_MGMT_1) first: a DEVICE_RESET there sets block A
+ *    back to its power-on values, so block A is written after it. A burst
+ *    runs from the first dirty register, extended over the next dirty ones
+ *    and over up to MPU6050_FLUSH_GAP clean writable ones between them
+ *    (never over a read-only register). After a DEVICE_RESET what was not
+ *    written after it is at its power-on value in the shadow too.
+ * 3. Clear the bits the device clears itself, in the registers written
+ *
+ * @return the number of I2C writes, -1 if the bus was busy or a write failed
+ *         (what was not written stays dirty).
+ */
+int MPU6050_flush(mpu6050_t *dev){
+	static const uint8_t first[2] = { MPU6050_SHADOW_A_FIRST, MPU6050_SHADOW_B_FIRST };
+	static const uint8_t start[3] = { 0, MPU6050_SHADOW_A_LEN, MPU6050_SHADOW_LEN };
+	int pwr = shadow_index(PWR_MGMT_1_R);
+	int writes = 0;
+	int rc = 0;
+
+	/*1. Leave the bus to a running interrupt driven read*/
+	if(!dev->dirty){
+		return 0;
+	}
+	if(i2c_busy(dev->bus)){
+		return -1;
+	}
+
+	/*2. Per block, block B first: one burst per run of dirty registers*/
+	for(int b = 1; b >= 0 && rc == 0; b--){
+		int i = start[b];
+
+		while(i < start[b + 1] && rc == 0){
+			int end = i + 1;		// one past the last dirty register of the burst
+			int gap = 0;
+
+			if(!(dev->dirty & (1ULL << i))){
+				i++;
+				continue;
+			}
+			for(int k = end; k < start[b + 1] && (SHADOW_WRITABLE & (1ULL << k)); k++){
+				if(dev->dirty & (1ULL << k)){
+					end = k + 1;
+					gap = 0;
+				}else if(++gap > MPU6050_FLUSH_GAP){
+					break;
+				}
+			}
+			rc = i2c_burst_write(dev->bus, dev->addr, first[b] + (i - start[b]), end - i, (char*)&dev->shadow[i]);
+			if(rc == I2C_OK){
+				dev->dirty &= ~(((1ULL << (end - i)) - 1U) << i);
+				writes++;
+				if(i <= pwr && pwr < end && (dev->shadow[pwr] & 0x80)){		// DEVICE_RESET
+					for(int k = 0; k < MPU6050_SHADOW_LEN; k++){
+						if(!(dev->dirty & (1ULL << k)) && (k <= pwr || k >= end)){
+							dev->shadow[k] = shadow_power_on(k);
+						}
+					}
+				}
+			}
+			i = end;
+		}
+	}
+
+	/*3. Clear the bits the device clears itself, in the registers written*/
+	for(uint32_t k = 0; k < sizeof(self_clearing) / sizeof(self_clearing[0]); k++){
+		int i = shadow_index(self_clearing[k].reg);
+
+		if(!(dev->dirty & (1ULL << i))){
+			dev->shadow[i] &= ~self_clearing[k].mask;
+		}
+	}
+	return (rc == I2C_OK) ? writes : -1;
+}
+/**
+ * int MPU6050_filter_solve(uint16_t rate_hz, uint16_t bandwidth_hz, mpu6050_filter_t *f)
+ * @brief DLPF_CFG and SMPLRT_DIV for an output data rate and a bandwidth
+ * @step followed:
+ *
+ * 1. DLPF_CFG: bandwidth_hz 0 -> the widest gyro bandwidth <= rate_hz / 2
+ *    (the narrowest filter if none is); else the narrowest bandwidth
+ *    >= bandwidth_hz (the widest filter if none is)
+ * 2. SMPLRT_DIV: of the two dividers around gyro rate / rate_hz, the one
+ *    whose rate is nearer (the faster one on a tie), 1..256
+ * 3. Fill in what the pair does
+ *
+ * @return 0, -1 for rate_hz 0 (f untouched)
+ */
+int MPU6050_filter_solve(uint16_t rate_hz, uint16_t bandwidth_hz, mpu6050_filter_t *f){
+	uint32_t gyro_hz, n;
+	int cfg;
+
+	if(rate_hz == 0){
+		return -1;
+	}
+
+	/*1. DLPF_CFG*/
+	if(bandwidth_hz == 0){
+		for(cfg = 0; cfg < MPU6050_DLPF_CFGS - 1 && 2U * dlpf[cfg].gyro_bw > rate_hz; cfg++){}
+	}else{
+		for(cfg = MPU6050_DLPF_CFGS - 1; cfg > 0 && dlpf[cfg].gyro_bw < bandwidth_hz; cfg--){}
+	}
+
+	/*2. SMPLRT_DIV*/
+	gyro_hz = cfg ? 1000U : 8000U;
+	n = gyro_hz / rate_hz;
+	if(n == 0){
+		n = 1;
+	}else if(n >= 256){
+		n = 256;
+	}else if((gyro_hz - rate_hz * n) * (n + 1) > (rate_hz * (n + 1) - gyro_hz) * n){
+		n++;		// |gyro/n - rate| > |gyro/(n+1) - rate|
+	}
+
+	/*3. Fill in what the pair does*/
+	f->dlpf_cfg = (uint8_t)cfg;
+	f->smplrt_div = (uint8_t)(n - 1);
+	f->rate_mhz = (gyro_hz * 1000U + n / 2) / n;
+	f->accel_bw_hz = dlpf[cfg].accel_bw;
+	f->gyro_bw_hz = dlpf[cfg].gyro_bw;
+	f->accel_delay_us = dlpf[cfg].accel_delay;
+	f->gyro_delay_us = dlpf[cfg].gyro_delay;
+	f->aliased = 2000U * dlpf[cfg].gyro_bw > f->rate_mhz;
+	f->accel_repeats = f->rate_mhz > 1000000U;
+	return 0;
+}
+/**
+ * int MPU6050_retune(mpu6050_t *dev, uint16_t rate_hz, uint16_t bandwidth_hz)
+ * @brief new output data rate and bandwidth at run time, no re-init
+ * @step followed:
+ *
+ * 1. Solve, keep the request and the result in the handle
+ * 2. SMPLRT_DIV and DLPF_CFG in the shadow (EXT_SYNC_SET kept)
+ * 3. Flush: one burst, or none if nothing changed. With an interrupt
+ *    driven read on the bus it stays dirty for the next MPU6050_flush().
+ *
+ * @return 0, -1 for rate_hz 0 (nothing changed)
+ */
+int MPU6050_retune(mpu6050_t *dev, uint16_t rate_hz, uint16_t bandwidth_hz){
+	mpu6050_filter_t f;
+
+	/*1. Solve*/
+	if(MPU6050_filter_solve(rate_hz, bandwidth_hz, &f) != 0){
+		return -1;
+	}
+	dev->rate_hz = rate_hz;
+	dev->bandwidth_hz = bandwidth_hz;
+	dev->filter = f;
+
+	/*2. SMPLRT_DIV and DLPF_CFG in the shadow*/
+	MPU6050_set(dev, SMPLRT_DIV_R, f.smplrt_div);
+	MPU6050_update(dev, CONFIG_R, MPU6050_DLPF_CFG_MASK, f.dlpf_cfg);
+
+	/*3. Flush*/
+	MPU6050_flush(dev);
+	return 0;
+}
+/**
+ * void aux_master_on(mpu6050_t *dev)
+ * @brief the auxiliary master drives XDA/XCL at 400 kHz, data ready waits for its data (shadow only)
+ */
+static void aux_master_on(mpu6050_t *dev){
+	MPU6050_update(dev, I2C_MST_CTRL_R, MPU6050_WAIT_FOR_ES | 0x0F, MPU6050_WAIT_FOR_ES | MPU6050_I2C_MST_CLK_400K);
+	MPU6050_update(dev, INT_PIN_CFG_R, MPU6050_I2C_BYPASS_EN, 0);
+	MPU6050_update(dev, USER_CTRL_R, MPU6050_I2C_MST_EN, MPU6050_I2C_MST_EN);
+}
+/**
+ * int MPU6050_aux_slv0(mpu6050_t *dev, uint8_t addr7, uint8_t reg, uint8_t len)
+ * @brief read len bytes from register reg of the auxiliary sensor at the 7 bit
+ *        address addr7 every sample; they come with the data burst from then on.
+ *        len 0 stops slave 0 (the master stays on for MPU6050_aux_write).
+ * @step followed:
+ *
+ * 1. Refuse while a read of the device is in flight (it has the old length)
+ *    or the bus is busy
+ * 2. Master on, slave 0: read, from reg, len bytes (shadow)
+ * 3. Flush: I2C_MST_CTRL .. I2C_SLV0_CTRL in one burst, INT_PIN_CFG, USER_CTRL
+ *
+ * @return 0, -1 if len > MPU6050_AUX_MAX, a read is in flight or the bus is busy.
+ */
+int MPU6050_aux_slv0(mpu6050_t *dev, uint8_t addr7, uint8_t reg, uint8_t len){
+
+	/*1. Refuse while a read of the device is in flight*/
+	if(len > MPU6050_AUX_MAX || dev->reading || i2c_busy(dev->bus)){
+		return -1;
+	}
+
+	/*2. Master on, slave 0*/
+	aux_master_on(dev);
+	if(len){
+		MPU6050_set(dev, I2C_SLV0_ADDR_R, MPU6050_I2C_SLV_RNW | (addr7 & 0x7F));
+		MPU6050_set(dev, I2C_SLV0_REG_R, reg);
+		MPU6050_set(dev, I2C_SLV0_CTRL_R, MPU6050_I2C_SLV_EN | len);
+	}else{
+		MPU6050_update(dev, I2C_SLV0_CTRL_R, MPU6050_I2C_SLV_EN, 0);
+	}
+
+	/*3. Flush*/
+	if(MPU6050_flush(dev) < 0){
+		return -1;
+	}
+	dev->aux_len = len;
+	return 0;
+}
+/**
+ * int MPU6050_aux_write(mpu6050_t *dev, uint8_t addr7, uint8_t reg, uint8_t value)
+ * @brief write one register of the auxiliary sensor through slave 4 (blocking)
+ * @step followed:
+ *
+ * 1. Wait for a free bus; master on, slave 4: write value to reg, enable (shadow)
+ * 2. Flush: I2C_SLV4_ADDR .. I2C_SLV4_CTRL in one burst (plus what step 1 changed)
+ * 3. The master runs slave 4 at the next sample: poll I2C_MST_STATUS for
+ *    SLV4_DONE or SLV4_NACK, for up to two sample periods of the configured
+ *    rate (MPU6050_AUX_POLLS: 4 reads at 8 kHz, about 1350 at 3.9 Hz)
+ *
+ * @return 0, -1 if the sensor did not acknowledge, did not finish, the bus is
+ *         busy or the device was not initialized.
+ */
+int MPU6050_aux_write(mpu6050_t *dev, uint8_t addr7, uint8_t reg, uint8_t value){
+	uint32_t polls;
+	uint8_t status;
+
+	/*1. Master on, slave 4*/
+	if(i2c_busy(dev->bus) || dev->filter.rate_mhz == 0){
+		return -1;
+	}
+	polls = MPU6050_AUX_POLLS(dev->filter.rate_mhz);
+	aux_master_on(dev);
+	MPU6050_set(dev, I2C_SLV4_ADDR_R, addr7 & 0x7F);
+	MPU6050_set(dev, I2C_SLV4_REG_R, reg);
+	MPU6050_set(dev, I2C_SLV4_DO_R, value);
+	MPU6050_update(dev, I2C_SLV4_CTRL_R, MPU6050_I2C_SLV_EN, MPU6050_I2C_SLV_EN);
+
+	/*2. Flush*/
+	if(MPU6050_flush(dev) < 0){
+		return -1;
+	}
+
+	/*3. Poll I2C_MST_STATUS*/
+	for(uint32_t i = 0; i < polls; i++){
+		status = (uint8_t)MPU6050_read_address(dev, I2C_MST_STATUS_R);
+		if(status & MPU6050_I2C_SLV4_NACK){
+			return -1;
+		}
+		if(status & MPU6050_I2C_SLV4_DONE){
+			return 0;
+		}
+	}
+	return -1;
+}
+/**
+ * int MPU6050_wom_enter(mpu6050_t *dev, uint16_t threshold_mg, mpu6050_wake_rate_t rate)
+ * @brief wake on motion: accelerometer alone at the wake rate, INT on motion above threshold_mg
+ * @step followed:
+ *
+ * 1. Wait for a free bus
+ * 2. Motion detection: accel high pass 5 Hz, MOT_THR (1..255, 2 mg each), MOT_DETECT_CTRL
+ * 3. INT: active high, push-pull, latched, cleared by any read; only MOT_EN
+ * 4. Gyros to standby, wake rate; CYCLE with the temperature sensor off
+ * 5. Flush (ACCEL_CONFIG, MOT_THR, INT_PIN_CFG .. INT_ENABLE, MOT_DETECT_CTRL ..
+ *    PWR_MGMT_2), then read INT_STATUS so a stale latch does not wake at once
+ *
+ * @return 0, -1 if the bus is busy.
+ */
+int MPU6050_wom_enter(mpu6050_t *dev, uint16_t threshold_mg, mpu6050_wake_rate_t rate){
+	uint32_t thr = threshold_mg / MPU6050_MOT_THR_MG;
+
+	/*1. Wait for a free bus*/
+	if(i2c_busy(dev->bus)){
+		return -1;
+	}
+
+	/*2. Motion detection*/
+	MPU6050_update(dev, ACCEL_CONFIG_R, MPU6050_ACCEL_HPF, MPU6050_ACCEL_HPF_5HZ);
+	MPU6050_set(dev, MOT_THR_R, (uint8_t)(thr < 1 ? 1 : (thr > 255 ? 255 : thr)));
+	MPU6050_set(dev, MOT_DETECT_CTRL_R, MPU6050_MOT_DETECT);
+
+	/*3. INT: active high, push-pull, latched, cleared by any read*/
+	MPU6050_update(dev, INT_PIN_CFG_R, 0xF0, MPU6050_INT_LATCH_EN | MPU6050_INT_RD_CLEAR);
+	MPU6050_set(dev, INT_ENABLE_R, MPU6050_MOT_EN);
+
+	/*4. Gyros to standby, wake rate, CYCLE*/
+	MPU6050_set(dev, PWR_MGMT_2_R, (uint8_t)((rate << 6) | MPU6050_STBY_G));
+	MPU6050_update(dev, PWR_MGMT_1_R, 0x40 | MPU6050_CYCLE | MPU6050_TEMP_DIS, MPU6050_CYCLE | MPU6050_TEMP_DIS);
+
+	/*5. Flush, clear the latch*/
+	if(MPU6050_flush(dev) < 0){
+		return -1;
+	}
+	MPU6050_read_address(dev, INT_STATUS_R);
+	return 0;
+}
+/**
+ * int MPU6050_wom_exit(mpu6050_t *dev)
+ * @brief back from wake on motion to streaming at dev->filter
+ * @step followed:
+ *
+ * 1. Wait for a free bus
+ * 2. CYCLE and TEMP_DIS off, every axis on, motion interrupt off, high pass off
+ * 3. Flush (ACCEL_CONFIG, INT_ENABLE, PWR_MGMT_1 .. PWR_MGMT_2), read
+ *    INT_STATUS to release INT for the next wake
+ *
+ * @return 0, -1 if the bus is busy.
+ */
+int MPU6050_wom_exit(mpu6050_t *dev){
+
+	/*1. Wait for a free bus*/
+	if(i2c_busy(dev->bus)){
+		return -1;
+	}
+
+	/*2. Streaming again*/
+	MPU6050_update(dev, PWR_MGMT_1_R, MPU6050_CYCLE | MPU6050_TEMP_DIS, 0);
+	MPU6050_set(dev, PWR_MGMT_2_R, 0);
+	MPU6050_update(dev, INT_ENABLE_R, MPU6050_MOT_EN, 0);
+	MPU6050_update(dev, ACCEL_CONFIG_R, MPU6050_ACCEL_HPF, 0);
+
+	/*3. Flush, release INT*/
+	if(MPU6050_flush(dev) < 0){
+		return -1;
+	}
+	MPU6050_read_address(dev, INT_STATUS_R);
+	return 0;
 }
 /*
- * void MPU6050_init(void)
- * @brief MPU6050 init
+ * int MPU6050_init(mpu6050_t *dev)
+ * @brief MPU6050 init, 6 I2C transactions (5 with FAST_BOOT, boot.h), fewer
+ *        if the device kept its configuration over an MCU reset
  * @step followed:
  *
- * 1. Enable I2C
- * 2. Read WHO_AM_I, this should return 0x68 or 104 in decimal
+ * 1. Enable I2C, once per bus
+ * 2. Read WHO_AM_I, this should return 0x68 or 104 in decimal (skipped with FAST_BOOT)
  * 3. if the data returned is equal to 0x68 or 104 in decimal:
+ *    load the shadow (3 bursts; FAST_BOOT: power-on values, all of them
+ *    written by the flush, no reads)
  * 4. Wakes up the device
- * 5. Set DATA RATE of 1KHz by writing SMPLRT_DIV register
- * 6. Set data format range to +-2g
- * 7. Set data format range to +-250
+ * 5. DATA RATE and DLPF from dev->rate_hz and dev->bandwidth_hz (1KHz,
+ *    DLPF off by default), data format range to dev->gyro_range and
+ *    dev->accel_range
+ * 6. Flush: PWR_MGMT_1 in one burst, then what changed of SMPLRT_DIV .. ACCEL_CONFIG in another
+ *    (FAST_BOOT: block B, then the 4 writable runs of block A)
+ *
+ * @return 0 if the device answered, -1 if not, if a transaction failed or
+ *         the bus was busy, or if dev->rate_hz is 0 (dev->present stays 0).
  */
-void MPU6050_init(void){
+int MPU6050_init(mpu6050_t *dev){
+	mpu6050_ring_init(&dev->samples);
+	dev->present = 0;
+	dev->reading = 0;
+	dev->aux_len = 0;
 
-	/*1. Enable I2C*/
-	I2C1_init();
+	/*1. Enable I2C, once per bus*/
+	if(!(dev->bus->regs->CR1 & I2C_CR1_PE)){
+		i2c_init(dev->bus);
+	}
 
+#if !FAST_BOOT
 	/*2. Read WHO_AM_I, this should return 0x68 or 104 in decimal*/
-	MPU6050_read_address(WHO_AM_I_R);
-
 	/*3. if the data returned is equal to 0x68 or 104 in decimal: */
-	if(data == 104){
-
-		/*4. Wakes up the device*/
-		MPU6050_write(PWR_MGMT_1_R, 0);
-
-		/*5. Set DATA RATE of 1KHz by writing SMPLRT_DIV register*/
-		MPU6050_write(SMPLRT_DIV_R, 0x07);
-		//GPIOA->ODR = LED_PIN;
+	if(MPU6050_read_address(dev, WHO_AM_I_R) != MPU6050_WHO_AM_I){
+		return -1;
+	}
+	if(MPU6050_shadow_load(dev) != 0){
+		return -1;
+	}
+#else
+	MPU6050_shadow_rewrite(dev);
+#endif
 
-		/*6. Set data format range to +-2g*/
-		MPU6050_write(ACCEL_CONFIG_R, 0b00);
+	/*4. Wakes up the device*/
+	MPU6050_set(dev, PWR_MGMT_1_R, 0);
 
-		/*7. Set data format range to +-250*/
-		MPU6050_write(GYRO_CONFIG_R, 0b00);
+	/*5. SMPLRT_DIV, CONFIG, GYRO_CONFIG, ACCEL_CONFIG*/
+	if(MPU6050_filter_solve(dev->rate_hz, dev->bandwidth_hz, &dev->filter) != 0){
+		return -1;
 	}
+	MPU6050_set(dev, SMPLRT_DIV_R, dev->filter.smplrt_div);		// default 8 kHz / (1 + 7) = 1 kHz
+	MPU6050_set(dev, CONFIG_R, dev->filter.dlpf_cfg);			// default DLPF off (reset value)
+	MPU6050_set(dev, GYRO_CONFIG_R, dev->gyro_range << 3);		// FS_SEL
+	MPU6050_set(dev, ACCEL_CONFIG_R, dev->accel_range << 3);	// AFS_SEL
 
-
+	/*6. Flush*/
+	if(MPU6050_flush(dev) < 0){
+		return -1;
+	}
+	dev->present = 1;
+	return 0;
 }
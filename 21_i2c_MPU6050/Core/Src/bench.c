@@ -0,0 +1,620 @@
+/**
+ * bench.c
+ *	@brief source file for the on-target benchmarks
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include <string.h>
+#ifdef BENCH_NEWLIB_PRINTF
+#include <stdio.h>
+#endif
+#include "bench.h"
+#include "dwt.h"
+#include "ring.h"
+#include "crc.h"
+#include "compress.h"
+#include "fmt.h"
+#include "mempool.h"
+#include "sections.h"
+#include "bitband.h"
+#include "gpio.h"
+#include "i2c.h"
+#include "MPU6050.h"
+
+#define BENCH_BLOCK				(32)
+#define BENCH_COMP_CHANNELS		BENCH_TRACE_CHANNELS
+#define BENCH_COMP_BATCH		(8)
+#define BENCH_SAMPLE_CYCLES		(64000U)		// 4 ms at 16 MHz, the IMU period
+#define BENCH_FMT_LINES			(64)
+#define BENCH_FLASH_LATENCY		(FLASH_ACR_LATENCY_3WS)	// needed from 90 MHz at 2.7-3.6 V (RM0383 table 5)
+
+/* 2nd order Butterworth low pass, fc = fs / 10, Q14; immediates so both copies read no flash data */
+#define BQ_B0					(1105)
+#define BQ_B1					(2210)
+#define BQ_B2					(1105)
+#define BQ_A1					(-18727)
+#define BQ_A2					(6763)
+
+typedef struct {
+	int32_t x1, x2;
+	int32_t y1, y2;
+} bench_biquad_t;
+
+RING_DECLARE(bench_ring, uint32_t, 256)
+
+volatile bench_results_t bench_results;
+
+static bench_ring_t ring NOINIT;
+static uint32_t crc_buf[BENCH_CRC_BYTES / 4] NOINIT;
+static int16_t trace[BENCH_TRACE_SAMPLES * BENCH_COMP_CHANNELS] NOINIT;
+
+static mpu6050_t bench_imu = MPU6050_DEVICE(&i2c1, DEVICE_ADDR);
+
+GPIO_CFG_DEFINE(bench_i2c1_pins, I2C1_PINS);
+
+/**
+ * void bench_ring_buffer(void)
+ * @brief SPSC ring throughput, producer and consumer on the same core
+ * @step followed:
+ *
+ * 1. push + pop one item at a time
+ * 2. bulk push + bulk pop
+ * 3. zero copy: reserve/commit on the producer side, peek/release on the consumer side
+ */
+static void bench_ring_buffer(void){
+	uint32_t block[BENCH_BLOCK];
+	uint32_t v;
+	uint32_t n;
+	uint32_t *p;
+	uint32_t t0;
+
+	/*1. push + pop one item at a time*/
+	bench_ring_init(&ring);
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_ITEMS; i++){
+		bench_ring_push(&ring, &i);
+		bench_ring_pop(&ring, &v);
+	}
+	bench_results.ring_push_pop = dwt_cycles() - t0;
+
+	/*2. bulk push + bulk pop*/
+	for(uint32_t i = 0; i < BENCH_BLOCK; i++){
+		block[i] = i;
+	}
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_ITEMS; i += BENCH_BLOCK){
+		bench_ring_push_bulk(&ring, block, BENCH_BLOCK);
+		bench_ring_pop_bulk(&ring, block, BENCH_BLOCK);
+	}
+	bench_results.ring_bulk = dwt_cycles() - t0;
+
+	/*3. zero copy*/
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_ITEMS; i += n){
+		p = bench_ring_write_reserve(&ring, &n);
+		if(n > BENCH_BLOCK){
+			n = BENCH_BLOCK;
+		}
+		for(uint32_t k = 0; k < n; k++){
+			p[k] = i + k;
+		}
+		bench_ring_write_commit(&ring, n);
+
+		p = bench_ring_read_peek(&ring, &n);
+		for(uint32_t k = 0; k < n; k++){
+			v += p[k];
+		}
+		bench_ring_read_release(&ring, n);
+	}
+	bench_results.ring_zero_copy = dwt_cycles() - t0;
+	(void)v;
+}
+
+/**
+ * void bench_crc(void)
+ * @brief CRC-32 throughput of the table, CPU fed CRC unit and DMA fed CRC unit
+ * @step followed:
+ *
+ * 1. Fill the buffer with a pseudo random pattern
+ * 2. Time the byte stream paths (table, CRC unit)
+ * 3. Time the word paths (CRC unit from the CPU, from DMA) and check them against the table
+ */
+static void bench_crc(void){
+	uint32_t ref, r;
+	uint32_t t0;
+	uint32_t x = 0x12345678U;
+
+	/*1. Fill the buffer with a pseudo random pattern*/
+	for(uint32_t i = 0; i < BENCH_CRC_BYTES / 4; i++){
+		x = x * 1664525U + 1013904223U;
+		crc_buf[i] = x;
+	}
+	crc_init();
+	bench_results.crc_mismatch = 0;
+
+	/*2. Time the byte stream paths*/
+	t0 = dwt_cycles();
+	ref = crc32_mpeg2_sw(CRC32_INIT, (const uint8_t *)crc_buf, BENCH_CRC_BYTES);
+	bench_results.crc_sw = dwt_cycles() - t0;
+
+	t0 = dwt_cycles();
+	r = crc32_mpeg2_hw(CRC32_INIT, (const uint8_t *)crc_buf, BENCH_CRC_BYTES);
+	bench_results.crc_hw = dwt_cycles() - t0;
+	bench_results.crc_mismatch |= (r != ref);
+
+	/*3. Time the word paths and check them against the table*/
+	ref = crc32_words_sw(CRC32_INIT, crc_buf, BENCH_CRC_BYTES / 4);
+
+	t0 = dwt_cycles();
+	r = crc32_words_hw(CRC32_INIT, crc_buf, BENCH_CRC_BYTES / 4);
+	bench_results.crc_words_hw = dwt_cycles() - t0;
+	bench_results.crc_mismatch |= (r != ref) << 1;
+
+	t0 = dwt_cycles();
+	r = crc32_words_dma(CRC32_INIT, crc_buf, BENCH_CRC_BYTES / 4);
+	bench_results.crc_dma = dwt_cycles() - t0;
+	bench_results.crc_mismatch |= (r != ref) << 2;
+
+	/* chained from a non-reset value through the unit's preload */
+	r = crc32_mpeg2_hw(crc32_mpeg2_sw(CRC32_INIT, (const uint8_t *)crc_buf, 7), (const uint8_t *)crc_buf + 7, BENCH_CRC_BYTES - 7);
+	bench_results.crc_mismatch |= (r != crc32_mpeg2_sw(CRC32_INIT, (const uint8_t *)crc_buf, BENCH_CRC_BYTES)) << 3;
+}
+
+/**
+ * void bench_record(void)
+ * @brief record a live IMU trace for bench_compress(), interrupts still enabled
+ * @step followed:
+ *
+ * 1. Without a sensor, take the recorded trace instead
+ * 2. Record BENCH_TRACE_SAMPLES samples at the IMU period (blocking reads)
+ */
+static void bench_record(void){
+	uint8_t raw[MPU6050_BURST_LEN];
+	int16_t *s;
+	uint32_t t0;
+
+	/*1. Without a sensor, take the recorded trace instead*/
+	bench_results.comp_live = 0;
+	memcpy(trace, bench_trace, sizeof(trace));
+	if(MPU6050_init(&bench_imu) != 0){
+		return;
+	}
+
+	/*2. Record BENCH_TRACE_SAMPLES samples at the IMU period*/
+	for(uint32_t i = 0; i < BENCH_TRACE_SAMPLES; i++){
+		t0 = dwt_cycles();
+		if(i2c_burst_read(bench_imu.bus, bench_imu.addr, ACCEL_XOUT_H_REG, MPU6050_BURST_LEN, (char *)raw) != I2C_OK){
+			memcpy(trace, bench_trace, sizeof(trace));
+			return;
+		}
+		s = &trace[i * BENCH_COMP_CHANNELS];
+		for(uint32_t c = 0, r = 0; c < BENCH_COMP_CHANNELS; c++, r += 2){
+			if(r == 6){
+				r = 8;			// skip the temperature
+			}
+			s[c] = (int16_t)(raw[r] << 8 | raw[r + 1]);
+		}
+		while(dwt_cycles() - t0 < BENCH_SAMPLE_CYCLES){}
+	}
+	bench_results.comp_live = 1;
+}
+
+/**
+ * void bench_compress(void)
+ * @brief time the block compressor on the trace of bench_record()
+ * @step followed:
+ *
+ * 1. Reset the figures
+ * 2. Compress the trace in batches, timing each block
+ * 3. Decode every block and compare with the trace
+ */
+static void bench_compress(void){
+	uint8_t block[COMP_BLOCK_MAX(BENCH_COMP_CHANNELS, BENCH_COMP_BATCH)];
+	int16_t out[BENCH_COMP_BATCH * BENCH_COMP_CHANNELS];
+	comp_encoder_t enc;
+	comp_decoder_t dec;
+	uint32_t t0, dt, len;
+
+	/*1. Reset the figures*/
+	comp_encoder_init(&enc, BENCH_COMP_CHANNELS, 8);
+	comp_decoder_init(&dec);
+	bench_results.comp_cycles = 0;
+	bench_results.comp_block_max = 0;
+	bench_results.comp_bytes = 0;
+	bench_results.comp_mismatch = 0;
+
+	/*2. Compress the trace in batches, timing each block*/
+	for(uint32_t i = 0; i < BENCH_TRACE_SAMPLES; i += BENCH_COMP_BATCH){
+		t0 = dwt_cycles();
+		len = comp_encode(&enc, &trace[i * BENCH_COMP_CHANNELS], BENCH_COMP_BATCH, block);
+		dt = dwt_cycles() - t0;
+		bench_results.comp_cycles += dt;
+		if(dt > bench_results.comp_block_max){
+			bench_results.comp_block_max = dt;
+		}
+		bench_results.comp_bytes += len;
+
+		/*3. Decode every block and compare with the trace*/
+		if(comp_decode(&dec, block, len, out, BENCH_COMP_BATCH) != BENCH_COMP_BATCH
+				|| memcmp(out, &trace[i * BENCH_COMP_CHANNELS], sizeof(out)) != 0){
+			bench_results.comp_mismatch++;
+		}
+	}
+}
+
+/**
+ * void bench_fmt(void)
+ * @brief cycles to format one line of six IMU values, fmt.c against newlib snprintf
+ * @step followed:
+ *
+ * 1. Take values from the trace of bench_record()
+ * 2. Time BENCH_FMT_LINES lines per format with fmt_snprintf
+ * 3. With BENCH_NEWLIB_PRINTF, time the same lines with newlib snprintf
+ */
+static void bench_fmt(void){
+	static const char fmt_int[] = "%6d %6d %6d %6d %6d %6d\n";
+	static const char fmt_fixed[] = "%.3k %.3k %.3k %.3k %.3k %.3k\n";
+	static const char fmt_float[] = "%.3f %.3f %.3f %.3f %.3f %.3f\n";
+	char line[96];
+	int32_t v[BENCH_COMP_CHANNELS];
+	float f[BENCH_COMP_CHANNELS];
+	uint32_t t0;
+
+	/*1. Take values from the recorded trace*/
+	for(uint32_t c = 0; c < BENCH_COMP_CHANNELS; c++){
+		v[c] = trace[c];
+		f[c] = (float)v[c] / 16384.0f;
+	}
+
+	/*2. Time the lines with fmt_snprintf*/
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_FMT_LINES; i++){
+		fmt_snprintf(line, sizeof(line), fmt_int, v[0], v[1], v[2], v[3], v[4], v[5]);
+	}
+	bench_results.fmt_int = (dwt_cycles() - t0) / BENCH_FMT_LINES;
+
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_FMT_LINES; i++){
+		fmt_snprintf(line, sizeof(line), fmt_fixed, v[0], v[1], v[2], v[3], v[4], v[5]);
+	}
+	bench_results.fmt_fixed = (dwt_cycles() - t0) / BENCH_FMT_LINES;
+
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_FMT_LINES; i++){
+		fmt_snprintf(line, sizeof(line), fmt_float, f[0], f[1], f[2], f[3], f[4], f[5]);
+	}
+	bench_results.fmt_float = (dwt_cycles() - t0) / BENCH_FMT_LINES;
+
+	/*3. With BENCH_NEWLIB_PRINTF, time the same lines with newlib snprintf*/
+#ifdef BENCH_NEWLIB_PRINTF
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_FMT_LINES; i++){
+		snprintf(line, sizeof(line), fmt_int, (int)v[0], (int)v[1], (int)v[2], (int)v[3], (int)v[4], (int)v[5]);
+	}
+	bench_results.newlib_int = (dwt_cycles() - t0) / BENCH_FMT_LINES;
+
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_FMT_LINES; i++){
+		snprintf(line, sizeof(line), fmt_float, f[0], f[1], f[2], f[3], f[4], f[5]);
+	}
+	bench_results.newlib_float = (dwt_cycles() - t0) / BENCH_FMT_LINES;
+#endif
+	(void)line;
+}
+
+/**
+ * void bench_pool(void)
+ * @brief worst case cycles of the pool calls
+ * @step followed:
+ *
+ * 1. Drain the pool with requests of every size up to POOL_MAX_BLOCK, which
+ *    also walks the spill path, timing each pool_alloc
+ * 2. Time requests that find everything empty
+ * 3. Free every block, timing each pool_free, and check that no more are
+ *    handed out than before
+ *
+ * Blocks other code holds stay where they are; the drain takes the rest.
+ */
+static void bench_pool(void){
+	static void *blocks[POOL_TOTAL_BLOCKS];
+	uint32_t n = 0;
+	uint32_t t0, dt;
+	uint32_t before = 0, after = 0;
+	void *p;
+
+	pool_init();
+	for(uint32_t c = 0; c < POOL_CLASSES; c++){
+		before += pool_stats.cls[c].used;
+	}
+	bench_results.pool_alloc_max = 0;
+	bench_results.pool_fail_max = 0;
+	bench_results.pool_free_max = 0;
+
+	/*1. Drain the pool with requests of every size*/
+	for(uint32_t size = 1; ; size = size % POOL_MAX_BLOCK + 1){
+		t0 = dwt_cycles();
+		p = pool_alloc(size);
+		dt = dwt_cycles() - t0;
+		if(!p && size == 1){
+			break;			// the smallest request spills to every class: all empty
+		}
+		if(p){
+			blocks[n++] = p;
+			if(dt > bench_results.pool_alloc_max){
+				bench_results.pool_alloc_max = dt;
+			}
+		}
+	}
+
+	/*2. Time requests that find everything empty*/
+	for(uint32_t size = 1; size <= POOL_MAX_BLOCK; size *= 2){
+		t0 = dwt_cycles();
+		p = pool_alloc(size);
+		dt = dwt_cycles() - t0;
+		if(dt > bench_results.pool_fail_max){
+			bench_results.pool_fail_max = dt;
+		}
+	}
+
+	/*3. Free every block and check no more are handed out than before*/
+	for(uint32_t i = 0; i < n; i++){
+		t0 = dwt_cycles();
+		pool_free(blocks[i]);
+		dt = dwt_cycles() - t0;
+		if(dt > bench_results.pool_free_max){
+			bench_results.pool_free_max = dt;
+		}
+	}
+	for(uint32_t c = 0; c < POOL_CLASSES; c++){
+		after += pool_stats.cls[c].used;
+	}
+	bench_results.pool_leaks = after - before;
+}
+
+/**
+ * int16_t bench_biquad_step(bench_biquad_t *f, int16_t x)
+ * @brief one filter update; always inlined so each caller has its own copy
+ */
+static inline __attribute__((always_inline)) int16_t bench_biquad_step(bench_biquad_t *f, int16_t x){
+	int32_t y = (BQ_B0 * x + BQ_B1 * f->x1 + BQ_B2 * f->x2 - BQ_A1 * f->y1 - BQ_A2 * f->y2) >> 14;
+
+	f->x2 = f->x1;
+	f->x1 = x;
+	f->y2 = f->y1;
+	f->y1 = y;
+	return (int16_t)y;
+}
+
+/**
+ * void bench_filter_flash(bench_biquad_t *f, const int16_t *in, int16_t *out)
+ * @brief filter one sample of every channel, code in flash
+ */
+static void __attribute__((noinline)) bench_filter_flash(bench_biquad_t *f, const int16_t *in, int16_t *out){
+	for(uint32_t c = 0; c < BENCH_COMP_CHANNELS; c++){
+		out[c] = bench_biquad_step(&f[c], in[c]);
+	}
+}
+
+/**
+ * void bench_filter_sram(bench_biquad_t *f, const int16_t *in, int16_t *out)
+ * @brief the same, code in SRAM
+ */
+RAM_FUNC static void bench_filter_sram(bench_biquad_t *f, const int16_t *in, int16_t *out){
+	for(uint32_t c = 0; c < BENCH_COMP_CHANNELS; c++){
+		out[c] = bench_biquad_step(&f[c], in[c]);
+	}
+}
+
+/**
+ * void bench_filter_time(void (*filter)(bench_biquad_t *, const int16_t *, int16_t *), int16_t *out, volatile uint32_t *min, volatile uint32_t *max)
+ * @brief run a filter copy over the trace, keeping the fastest and slowest call
+ */
+static void bench_filter_time(void (*filter)(bench_biquad_t *, const int16_t *, int16_t *), int16_t *out,
+		volatile uint32_t *min, volatile uint32_t *max){
+	bench_biquad_t f[BENCH_COMP_CHANNELS];
+	uint32_t t0, dt;
+
+	memset(f, 0, sizeof(f));
+	*min = 0xFFFFFFFFU;
+	*max = 0;
+	for(uint32_t i = 0; i < BENCH_TRACE_SAMPLES; i++){
+		t0 = dwt_cycles();
+		filter(f, &trace[i * BENCH_COMP_CHANNELS], &out[i * BENCH_COMP_CHANNELS]);
+		dt = dwt_cycles() - t0;
+		if(dt < *min){
+			*min = dt;
+		}
+		if(dt > *max){
+			*max = dt;
+		}
+	}
+}
+
+/**
+ * void bench_ramfunc(void)
+ * @brief the same filter kernel from flash (ART off, ART on) and from SRAM
+ * @step followed:
+ *
+ * 1. Save FLASH->ACR and set the wait states a 100 MHz clock would need
+ * 2. Flash, ART off: every fetch pays the wait states
+ * 3. Flash, ART on: hits are free, misses and branches still cost (jitter)
+ * 4. SRAM: no wait states; compare its output with the flash run
+ * 5. Restore FLASH->ACR
+ *
+ * At 16 MHz the core needs no wait states (and the ART is off after reset),
+ * so they are set here only to show what a faster clock would cost.
+ */
+static void bench_ramfunc(void){
+	static int16_t out_flash[BENCH_TRACE_SAMPLES * BENCH_COMP_CHANNELS] NOINIT;
+	static int16_t out_sram[BENCH_TRACE_SAMPLES * BENCH_COMP_CHANNELS] NOINIT;
+	uint32_t acr;
+
+	/*1. Save FLASH->ACR and set the wait states a 100 MHz clock would need*/
+	acr = FLASH->ACR;
+	FLASH->ACR = BENCH_FLASH_LATENCY;
+	while((FLASH->ACR & FLASH_ACR_LATENCY) != BENCH_FLASH_LATENCY){}
+
+	/*2. Flash, ART off*/
+	bench_filter_time(bench_filter_flash, out_flash, &bench_results.ramfunc_flash_min, &bench_results.ramfunc_flash_max);
+
+	/*3. Flash, ART on (caches reset while disabled)*/
+	FLASH->ACR = BENCH_FLASH_LATENCY | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+	FLASH->ACR = BENCH_FLASH_LATENCY | FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+	bench_filter_time(bench_filter_flash, out_flash, &bench_results.ramfunc_art_min, &bench_results.ramfunc_art_max);
+
+	/*4. SRAM, ART off again*/
+	FLASH->ACR = BENCH_FLASH_LATENCY;
+	bench_filter_time(bench_filter_sram, out_sram, &bench_results.ramfunc_sram_min, &bench_results.ramfunc_sram_max);
+	bench_results.ramfunc_mismatch = 0;
+	for(uint32_t i = 0; i < BENCH_TRACE_SAMPLES * BENCH_COMP_CHANNELS; i++){
+		bench_results.ramfunc_mismatch += (out_flash[i] != out_sram[i]);
+	}
+
+	/*5. Restore FLASH->ACR*/
+	FLASH->ACR = acr;
+}
+
+/**
+ * void bench_bitband(void)
+ * @brief set and clear one bit with |= / &= and with bit-band stores
+ * @step followed:
+ *
+ * 1. SRAM word, read-modify-write
+ * 2. SRAM word, bit-band
+ * 3. Peripheral register (CRC->IDR, a free 8 bit register), read-modify-write
+ * 4. Peripheral register, bit-band
+ * 5. Check that alias reads and writes match the word
+ */
+static void bench_bitband(void){
+	static volatile uint32_t word;
+	uint32_t t0;
+
+	RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+	word = 0;
+	CRC->IDR = 0;
+
+	/*1. SRAM word, read-modify-write*/
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_ITEMS; i++){
+		word |= (1U << 5);
+		word &= ~(1U << 5);
+	}
+	bench_results.bitband_sram_rmw = dwt_cycles() - t0;
+
+	/*2. SRAM word, bit-band*/
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_ITEMS; i++){
+		BB_SET(word, 5);
+		BB_CLR(word, 5);
+	}
+	bench_results.bitband_sram_bb = dwt_cycles() - t0;
+
+	/*3. Peripheral register, read-modify-write*/
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_ITEMS; i++){
+		CRC->IDR |= (1U << 5);
+		CRC->IDR &= ~(1U << 5);
+	}
+	bench_results.bitband_periph_rmw = dwt_cycles() - t0;
+
+	/*4. Peripheral register, bit-band*/
+	t0 = dwt_cycles();
+	for(uint32_t i = 0; i < BENCH_ITEMS; i++){
+		BB_SET(CRC->IDR, 5);
+		BB_CLR(CRC->IDR, 5);
+	}
+	bench_results.bitband_periph_bb = dwt_cycles() - t0;
+
+	/*5. Check that alias reads and writes match the word*/
+	bench_results.bitband_mismatch = 0;
+	for(uint32_t bit = 0; bit < 32; bit++){
+		BB_SET(word, bit);
+		bench_results.bitband_mismatch += (word != (1U << bit)) + (BB_READ(word, bit) != 1U);
+		BB_CLR(word, bit);
+		bench_results.bitband_mismatch += (word != 0) + (BB_READ(word, bit) != 0);
+	}
+	CRC->IDR = 0;
+}
+
+/**
+ * void bench_gpio_reset(uint32_t *regs)
+ * @brief put PB8/PB9 back to their reset state (input, push-pull, no pull, AF0);
+ *        with regs, save MODER, OTYPER, OSPEEDR, PUPDR and AFR[1] first
+ */
+static void bench_gpio_reset(uint32_t *regs){
+	if(regs){
+		regs[0] = GPIOB->MODER;
+		regs[1] = GPIOB->OTYPER;
+		regs[2] = GPIOB->OSPEEDR;
+		regs[3] = GPIOB->PUPDR;
+		regs[4] = GPIOB->AFR[1];
+	}
+	GPIOB->MODER &= ~(GPIO_MODER_MODE8 | GPIO_MODER_MODE9);
+	GPIOB->OTYPER &= ~(GPIO_OTYPER_OT8 | GPIO_OTYPER_OT9);
+	GPIOB->PUPDR &= ~(GPIO_PUPDR_PUPD8 | GPIO_PUPDR_PUPD9);
+	GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL8 | GPIO_AFRH_AFSEL9);
+}
+
+/**
+ * void bench_gpio(void)
+ * @brief I2C1 pin set-up, hand-written shifts against the constant table
+ * @step followed:
+ *
+ * 1. The shifts the I2C1 set-up used before gpio.h
+ * 2. gpio_apply() with I2C1_PINS
+ * 3. Compare the registers both left; the pins end up configured for I2C1
+ */
+static void bench_gpio(void){
+	uint32_t hand[5], table[5];
+	uint32_t t0;
+
+	RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN;
+	bench_gpio_reset(0);
+
+	/*1. The shifts the I2C1 set-up used before gpio.h*/
+	t0 = dwt_cycles();
+	GPIOB->MODER |= (1U << 19) | (1U << 17);
+	GPIOB->MODER &= ~(1U << 18);
+	GPIOB->MODER &= ~(1U << 16);
+	GPIOB->OTYPER |= GPIO_OTYPER_OT8 | GPIO_OTYPER_OT9;
+	GPIOB->PUPDR |= GPIO_PUPDR_PUPDR8_0 | GPIO_PUPDR_PUPDR9_0;
+	GPIOB->PUPDR &= ~(1U << 19);
+	GPIOB->PUPDR &= ~(1U << 17);
+	GPIOB->AFR[1] |= (4<<0) | (4<<4);
+	bench_results.gpio_hand = dwt_cycles() - t0;
+	bench_gpio_reset(hand);
+
+	/*2. gpio_apply() with I2C1_PINS*/
+	t0 = dwt_cycles();
+	gpio_apply(GPIOB, &bench_i2c1_pins);
+	bench_results.gpio_table = dwt_cycles() - t0;
+
+	/*3. Compare the registers both left*/
+	bench_gpio_reset(table);
+	gpio_apply(GPIOB, &bench_i2c1_pins);
+	bench_results.gpio_mismatch = 0;
+	for(uint32_t i = 0; i < 5; i++){
+		bench_results.gpio_mismatch += (hand[i] != table[i]);
+	}
+}
+
+/**
+ * void bench_run(void)
+ * @brief record the IMU trace, then run every benchmark once with interrupts masked
+ */
+void bench_run(void){
+	dwt_init();
+	bench_record();
+
+	__disable_irq();
+	bench_ring_buffer();
+	bench_crc();
+	bench_compress();
+	bench_fmt();
+	bench_pool();
+	bench_ramfunc();
+	bench_bitband();
+	bench_gpio();
+	__enable_irq();
+}
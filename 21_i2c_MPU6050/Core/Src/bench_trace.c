@@ -0,0 +1,279 @@
+/**
+ * bench_trace.c
+ *	@brief source file for the recorded IMU trace of the compression benchmark
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The first BENCH_TRACE_SAMPLES accelerometer/gyro read pairs of the
+ * project's logic capture (I2C_MPU6050_Pulseview.sr, board at rest, one
+ * pair every ~1.8 ms): accel x, y, z, gyro x, y, z in raw counts. bench.c
+ * compresses it when no sensor answers at start-up, so the figures can be
+ * compared between boards. Regenerate from Host/:
+ *
+ *  ./i2csr -d ../I2C_MPU6050_Pulseview.sr | awk '
+ *  function hex(h){ return (index("0123456789abcdef", substr(h, 1, 1)) - 1) * 16 + index("0123456789abcdef", substr(h, 2, 1)) - 1 }
+ *  function s16(h, l){ v = hex(h) * 256 + hex(l); return v >= 32768 ? v - 65536 : v }
+ *  $2 == "3b" { a = s16($3, $4) ", " s16($5, $6) ", " s16($7, $8); next }
+ *  $2 == "43" && a != "" && n < 256 { print "\t" a ", " s16($3, $4) ", " s16($5, $6) ", " s16($7, $8) ","; n++; a = "" }'
+ */
+
+#include "bench.h"
+
+const int16_t bench_trace[BENCH_TRACE_SAMPLES * BENCH_TRACE_CHANNELS] = {
+	14276, -128, -8528, -251, 123, 55,
+	14204, -60, -8408, -267, 175, 61,
+	14136, -56, -8528, -244, 172, 63,
+	14176, -52, -8436, -240, 141, 40,
+	14236, -164, -8468, -249, 143, 32,
+	14264, -176, -8608, -253, 167, 47,
+	14220, -80, -8580, -228, 127, 49,
+	14072, 36, -8492, -241, 130, 49,
+	14092, -68, -8472, -253, 134, 32,
+	14248, -172, -8556, -251, 158, 39,
+	14256, -156, -8568, -254, 140, 58,
+	14184, -192, -8404, -249, 106, 59,
+	14096, -116, -8472, -251, 112, 32,
+	14216, -228, -8428, -270, 152, 42,
+	14188, -152, -8588, -240, 127, 46,
+	14128, -132, -8568, -241, 155, 49,
+	14132, -180, -8468, -260, 161, 41,
+	14112, -176, -8636, -261, 163, 38,
+	14084, -128, -8444, -260, 159, 54,
+	14128, -188, -8668, -246, 124, 26,
+	14128, -228, -8472, -262, 136, 51,
+	14208, -168, -8664, -256, 152, 43,
+	14116, -112, -8660, -243, 151, 50,
+	14136, -136, -8640, -257, 142, 37,
+	14124, -236, -8468, -244, 162, 67,
+	14128, -124, -8576, -278, 153, 44,
+	14276, -144, -8544, -257, 179, 46,
+	14124, -268, -8516, -260, 163, 49,
+	14248, -160, -8548, -269, 158, 29,
+	14148, -120, -8604, -260, 174, 74,
+	14156, -172, -8584, -250, 113, 37,
+	14224, -116, -8504, -264, 171, 44,
+	14156, -44, -8500, -258, 115, 54,
+	14224, -100, -8452, -251, 141, 40,
+	14020, -164, -8544, -258, 127, 47,
+	14084, -152, -8640, -261, 155, 44,
+	14168, -172, -8540, -259, 139, 48,
+	14120, -176, -8628, -259, 155, 49,
+	14240, -120, -8516, -252, 160, 43,
+	14040, -68, -8568, -264, 148, 64,
+	14140, -132, -8380, -243, 156, 45,
+	14316, -88, -8452, -250, 166, 58,
+	14328, -44, -8596, -262, 164, 31,
+	14272, -112, -8508, -253, 150, 42,
+	14192, -84, -8532, -254, 148, 59,
+	14192, -60, -8392, -252, 158, 69,
+	14240, -104, -8340, -273, 144, 52,
+	14228, 40, -8412, -256, 169, 39,
+	14196, -112, -8448, -250, 152, 54,
+	14240, -124, -8508, -257, 145, 18,
+	14224, -84, -8540, -249, 143, 45,
+	14156, -20, -8556, -259, 136, 57,
+	14140, -152, -8520, -242, 149, 51,
+	14184, -20, -8444, -263, 155, 58,
+	14200, -44, -8424, -257, 149, 53,
+	14208, -132, -8428, -251, 120, 50,
+	14192, -12, -8360, -246, 168, 33,
+	14296, -116, -8532, -273, 145, 42,
+	14128, -104, -8340, -262, 123, 36,
+	14284, -60, -8328, -253, 134, 57,
+	14140, -144, -8432, -250, 149, 32,
+	14192, -100, -8436, -262, 138, 12,
+	14212, -72, -8532, -280, 135, 52,
+	14264, -116, -8620, -259, 148, 39,
+	14240, -92, -8404, -246, 141, 40,
+	14208, -24, -8464, -265, 118, 45,
+	14284, -72, -8440, -272, 152, 45,
+	14224, -16, -8428, -259, 126, 32,
+	14188, -44, -8344, -248, 172, 43,
+	14256, -24, -8488, -251, 154, 40,
+	14156, -164, -8584, -240, 131, 38,
+	14212, -96, -8544, -252, 138, 42,
+	14148, -16, -8464, -240, 155, 35,
+	14240, -160, -8580, -241, 138, 54,
+	14140, -12, -8480, -267, 139, 46,
+	14168, -188, -8428, -247, 127, 55,
+	14148, -48, -8716, -254, 143, 51,
+	14148, -100, -8584, -262, 134, 42,
+	14124, -40, -8432, -272, 154, 23,
+	14160, -96, -8600, -248, 149, 46,
+	14172, -148, -8840, -269, 143, 59,
+	14096, -228, -8628, -257, 134, 54,
+	14220, -4, -8636, -268, 153, 62,
+	14216, -156, -8528, -260, 125, 33,
+	14184, -160, -8532, -256, 142, 62,
+	14124, -176, -8668, -259, 138, 50,
+	14264, -188, -8620, -258, 142, 48,
+	14092, -144, -8584, -268, 146, 64,
+	14200, -252, -8596, -257, 134, 36,
+	14264, -132, -8540, -252, 142, 41,
+	14132, -192, -8620, -270, 162, 41,
+	14180, -200, -8592, -252, 128, 55,
+	14164, -204, -8504, -257, 116, 58,
+	14152, -92, -8720, -251, 142, 34,
+	14132, -148, -8536, -253, 152, 38,
+	14112, -176, -8432, -254, 163, 52,
+	14112, -120, -8516, -251, 172, 48,
+	14240, -132, -8648, -268, 145, 67,
+	14096, -164, -8660, -253, 166, 44,
+	14144, -244, -8624, -274, 144, 51,
+	14120, -144, -8568, -275, 162, 39,
+	14124, -88, -8552, -246, 149, 41,
+	14128, -100, -8600, -265, 169, 35,
+	14220, -176, -8536, -241, 151, 51,
+	14236, -216, -8344, -247, 146, 39,
+	14140, -272, -8396, -234, 147, 43,
+	14160, -188, -8620, -269, 158, 37,
+	14240, -112, -8328, -240, 154, 36,
+	14140, -112, -8396, -259, 146, 41,
+	14100, -76, -8556, -234, 172, 40,
+	14252, -228, -8396, -288, 143, 58,
+	14260, -156, -8568, -263, 150, 64,
+	14176, -124, -8440, -255, 163, 46,
+	14088, -248, -8492, -260, 157, 52,
+	14220, -120, -8536, -239, 159, 46,
+	14200, -100, -8500, -252, 119, 31,
+	14224, -100, -8532, -241, 147, 54,
+	14240, -124, -8548, -245, 171, 66,
+	14268, -80, -8348, -265, 176, 70,
+	14284, -32, -8516, -247, 143, 37,
+	14284, -172, -8372, -262, 165, 58,
+	14252, -4, -8472, -252, 152, 54,
+	14300, -204, -8412, -276, 157, 68,
+	14180, -132, -8372, -244, 185, 40,
+	14268, -188, -8584, -247, 161, 38,
+	14336, -64, -8596, -248, 138, 52,
+	14180, -148, -8588, -256, 148, 26,
+	14240, -52, -8360, -264, 161, 58,
+	14196, -60, -8592, -252, 127, 51,
+	14336, -48, -8556, -241, 151, 46,
+	14272, -136, -8348, -235, 155, 45,
+	14240, -72, -8368, -244, 169, 59,
+	14180, -92, -8348, -263, 131, 65,
+	14300, -88, -8492, -275, 151, 35,
+	14180, -56, -8488, -239, 137, 53,
+	14128, -48, -8560, -250, 161, 34,
+	14144, -52, -8388, -250, 158, 67,
+	14100, -116, -8440, -260, 144, 59,
+	14236, -44, -8592, -265, 113, 56,
+	14128, -108, -8396, -258, 152, 24,
+	14120, -168, -8364, -259, 138, 69,
+	14208, -76, -8576, -246, 131, 38,
+	14212, -96, -8644, -265, 136, 18,
+	14228, -140, -8472, -260, 149, 73,
+	14172, -60, -8540, -258, 152, 42,
+	14184, -188, -8468, -274, 143, 43,
+	14288, -44, -8524, -251, 156, 46,
+	14208, -112, -8732, -248, 131, 32,
+	14192, -108, -8664, -269, 147, 46,
+	14128, -180, -8536, -247, 157, 51,
+	14080, -84, -8404, -237, 123, 27,
+	14268, -144, -8480, -236, 113, 50,
+	14172, -176, -8380, -263, 117, 41,
+	14136, -156, -8504, -264, 118, 70,
+	14240, -120, -8332, -253, 130, 36,
+	14236, -36, -8488, -247, 143, 49,
+	14136, -140, -8576, -258, 130, 36,
+	14172, -112, -8664, -266, 119, 46,
+	14196, -184, -8560, -268, 107, 41,
+	14256, -124, -8568, -253, 140, 63,
+	14132, -232, -8608, -238, 150, 42,
+	14224, -168, -8624, -253, 150, 56,
+	14220, -172, -8492, -272, 162, 58,
+	14164, -80, -8612, -265, 126, 63,
+	14072, -116, -8536, -256, 136, 45,
+	14208, -140, -8464, -273, 129, 37,
+	14152, -164, -8480, -268, 153, 49,
+	14276, -112, -8528, -254, 106, 52,
+	14152, -176, -8496, -254, 113, 31,
+	14212, -88, -8452, -254, 147, 22,
+	14196, -144, -8460, -241, 146, 43,
+	14164, -176, -8492, -257, 144, 57,
+	14120, -116, -8460, -256, 139, 43,
+	14072, -164, -8468, -280, 136, 34,
+	14176, -140, -8520, -256, 146, 41,
+	14140, -24, -8540, -259, 125, 37,
+	14180, -140, -8416, -249, 134, 34,
+	14132, -84, -8492, -240, 149, 69,
+	14192, -160, -8420, -273, 132, 46,
+	14124, -132, -8556, -247, 150, 37,
+	14240, -48, -8480, -271, 110, 45,
+	14296, -76, -8580, -260, 120, 41,
+	14260, -152, -8504, -259, 160, 68,
+	14216, -76, -8568, -253, 134, 55,
+	14220, -68, -8372, -249, 154, 39,
+	14208, -8, -8524, -252, 150, 70,
+	14244, -160, -8436, -237, 159, 37,
+	14096, -96, -8544, -266, 150, 35,
+	14224, -60, -8444, -264, 145, 48,
+	14232, -108, -8520, -247, 151, 43,
+	14156, -8, -8488, -273, 151, 70,
+	14160, 16, -8560, -247, 169, 69,
+	14148, -108, -8536, -237, 121, 68,
+	14168, -16, -8572, -245, 167, 37,
+	14172, -48, -8620, -260, 114, 27,
+	14092, -152, -8508, -256, 139, 58,
+	14208, -92, -8484, -250, 157, 30,
+	14276, -76, -8472, -262, 142, 27,
+	14192, -64, -8512, -234, 166, 43,
+	14272, 44, -8492, -249, 166, 62,
+	14180, -24, -8536, -247, 150, 37,
+	14176, -4, -8416, -239, 128, 47,
+	14140, -120, -8592, -258, 156, 55,
+	14224, 0, -8576, -267, 167, 52,
+	14132, -120, -8528, -242, 133, 54,
+	14164, -176, -8432, -267, 172, 57,
+	14260, -112, -8432, -249, 153, 56,
+	14272, -48, -8560, -240, 149, 45,
+	14264, -96, -8516, -271, 130, 43,
+	14176, -96, -8568, -266, 156, 59,
+	14172, -228, -8468, -257, 127, 45,
+	14128, 12, -8544, -263, 160, 53,
+	14160, -208, -8468, -246, 153, 49,
+	14216, -124, -8552, -249, 155, 42,
+	14200, -164, -8496, -239, 161, 42,
+	14196, -92, -8536, -256, 163, 64,
+	14164, -132, -8548, -263, 175, 54,
+	14268, -12, -8388, -241, 167, 47,
+	14188, -64, -8568, -236, 144, 74,
+	14120, -152, -8596, -232, 146, 50,
+	14188, -132, -8640, -249, 138, 38,
+	14216, -116, -8612, -240, 141, 43,
+	14088, -112, -8672, -247, 163, 47,
+	14288, -76, -8396, -257, 141, 41,
+	14332, -112, -8496, -231, 146, 38,
+	14136, -44, -8456, -257, 164, 65,
+	14180, -160, -8520, -256, 122, 40,
+	14184, -144, -8464, -268, 160, 31,
+	14144, -180, -8416, -246, 161, 52,
+	14144, -152, -8432, -269, 157, 38,
+	14220, -208, -8528, -258, 164, 31,
+	14220, -128, -8380, -267, 155, 35,
+	14192, -96, -8524, -253, 160, 48,
+	14124, -120, -8532, -232, 154, 48,
+	14276, -76, -8528, -257, 126, 52,
+	14336, -116, -8588, -247, 139, 37,
+	14292, -152, -8488, -249, 142, 36,
+	14208, -112, -8424, -266, 163, 58,
+	14116, -148, -8440, -257, 126, 46,
+	14172, -28, -8480, -238, 137, 61,
+	14304, -152, -8592, -256, 159, 56,
+	14208, -112, -8392, -264, 178, 58,
+	14224, -132, -8664, -259, 134, 52,
+	14232, -140, -8524, -278, 137, 34,
+	14172, -148, -8576, -243, 142, 47,
+	14164, -88, -8568, -262, 155, 37,
+	14224, 12, -8492, -248, 147, 50,
+	14124, -92, -8464, -254, 118, 57,
+	14260, -148, -8436, -252, 138, 56,
+	14076, -116, -8540, -246, 133, 55,
+	14172, 4, -8552, -279, 143, 50,
+	14136, -68, -8420, -261, 123, 38,
+	14248, -44, -8568, -246, 124, 32,
+	14268, -76, -8464, -249, 141, 35,
+	14244, -64, -8544, -263, 148, 43,
+	14228, -164, -8644, -267, 141, 34,
+};
@@ -0,0 +1,54 @@
+/**
+ * boot.c
+ *	@brief source file for the reset-to-first-sample boot timing
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include "stm32f4xx.h"
+#include "boot.h"
+#include "dwt.h"
+#include "sections.h"
+#include "telemetry.h"
+
+_Static_assert(BOOT_REPORT_LEN <= TELEM_MAX_PAYLOAD, "boot report must fit one frame");
+
+/* written by Reset_Handler before .bss is zeroed, so it must not be in .bss */
+volatile uint32_t boot_times[BOOT_STAGES] NOINIT;
+
+/**
+ * void boot_stamp(uint32_t stage)
+ * @brief record the cycle count at the end of a C boot stage
+ */
+void boot_stamp(uint32_t stage){
+	if(stage < BOOT_STAGES){
+		boot_times[stage] = dwt_cycles();
+	}
+}
+
+/**
+ * int boot_report(void)
+ * @brief send the core clock and boot_times[] as a TELEM_TYPE_BOOT frame
+ * @step followed:
+ *
+ * 1. Pack the clock and the stamps little endian
+ * 2. Queue the frame
+ *
+ * @return 0 if queued, -1 if the frame was dropped
+ */
+int boot_report(void){
+	uint8_t payload[BOOT_REPORT_LEN];
+	uint32_t v;
+
+	/*1. Pack the clock and the stamps little endian*/
+	for(uint32_t i = 0; i <= BOOT_STAGES; i++){
+		v = (i == 0) ? SystemCoreClock : boot_times[i - 1];
+		payload[4 * i] = (uint8_t)v;
+		payload[4 * i + 1] = (uint8_t)(v >> 8);
+		payload[4 * i + 2] = (uint8_t)(v >> 16);
+		payload[4 * i + 3] = (uint8_t)(v >> 24);
+	}
+
+	/*2. Queue the frame*/
+	return telem_send_bytes(TELEM_TYPE_BOOT, dwt_cycles(), payload, BOOT_REPORT_LEN);
+}
@@ -0,0 +1,102 @@
+/**
+ * cobs.c
+ *	@brief source file for Consistent Overhead Byte Stuffing
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include "cobs.h"
+
+/**
+ * void cobs_enc_begin(cobs_enc_t *e, uint8_t *dst)
+ * @brief start a frame in dst; leave room for the code byte of the first run
+ */
+void cobs_enc_begin(cobs_enc_t *e, uint8_t *dst){
+	e->start = dst;
+	e->code = dst;
+	e->out = dst + 1;
+	e->run = 1;
+}
+
+/**
+ * void cobs_enc_put(cobs_enc_t *e, const uint8_t *src, uint32_t len)
+ * @brief append len bytes to the frame
+ * @step followed:
+ *
+ * 1. Copy non-zero bytes into the open run
+ * 2. A zero, or a full run of 254, closes the run by writing its length + 1
+ *    into its code byte, and opens the next one
+ */
+void cobs_enc_put(cobs_enc_t *e, const uint8_t *src, uint32_t len){
+	uint8_t *out = e->out;
+	uint8_t run = e->run;
+	uint8_t b;
+
+	while(len--){
+		b = *src++;
+
+		/*1. Copy non-zero bytes into the open run*/
+		if(b){
+			*out++ = b;
+			run++;
+		}
+
+		/*2. A zero or a full run closes the run*/
+		if(b == 0 || run == 0xFF){
+			*e->code = run;
+			e->code = out++;
+			run = 1;
+		}
+	}
+	e->out = out;
+	e->run = run;
+}
+
+/**
+ * uint32_t cobs_enc_end(cobs_enc_t *e)
+ * @brief close the last run
+ * @return encoded length, the delimiter is not written
+ */
+uint32_t cobs_enc_end(cobs_enc_t *e){
+	*e->code = e->run;
+	return (uint32_t)(e->out - e->start);
+}
+
+/**
+ * uint32_t cobs_encode(const uint8_t *src, uint32_t len, uint8_t *dst)
+ * @brief encode len bytes of src into dst (at most COBS_MAX_ENCODED(len) bytes)
+ * @return encoded length, the delimiter is not written
+ */
+uint32_t cobs_encode(const uint8_t *src, uint32_t len, uint8_t *dst){
+	cobs_enc_t e;
+
+	cobs_enc_begin(&e, dst);
+	cobs_enc_put(&e, src, len);
+	return cobs_enc_end(&e);
+}
+
+/**
+ * int32_t cobs_decode(const uint8_t *src, uint32_t len, uint8_t *dst)
+ * @brief decode one frame (delimiter removed) into dst, at most len bytes
+ * @return decoded length, -1 if the frame is malformed
+ */
+int32_t cobs_decode(const uint8_t *src, uint32_t len, uint8_t *dst){
+	const uint8_t *end = src + len;
+	uint8_t *out = dst;
+	uint8_t code;
+
+	while(src < end){
+		code = *src++;
+		if(code == 0 || (uint32_t)(end - src) < (uint32_t)(code - 1)){
+			return -1;
+		}
+		for(uint8_t i = 1; i < code; i++){
+			*out++ = *src++;
+		}
+		/* a run shorter than 254 stood for a zero, except at the very end */
+		if(code != 0xFF && src < end){
+			*out++ = 0;
+		}
+	}
+	return (int32_t)(out - dst);
+}
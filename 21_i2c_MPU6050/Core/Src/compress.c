@@ -0,0 +1,190 @@
+/**
+ * compress.c
+ *	@brief source file for the multi-channel int16 block compressor
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include "compress.h"
+
+/**
+ * uint8_t *comp_put_varint(uint8_t *out, uint16_t delta)
+ * @brief zigzag map the wrapped difference and write it as a 1..3 byte varint
+ */
+static inline uint8_t *comp_put_varint(uint8_t *out, uint16_t delta){
+	uint32_t z = (uint16_t)((delta << 1) ^ (uint16_t)((int16_t)delta >> 15));
+
+	while(z >= 0x80U){
+		*out++ = (uint8_t)(z | 0x80U);
+		z >>= 7;
+	}
+	*out++ = (uint8_t)z;
+	return out;
+}
+
+/**
+ * void comp_encoder_init(comp_encoder_t *e, uint8_t channels, uint8_t keyframe_every)
+ * @brief set up an encoder; the first block is always a keyframe
+ */
+void comp_encoder_init(comp_encoder_t *e, uint8_t channels, uint8_t keyframe_every){
+	e->channels = (channels > COMP_MAX_CHANNELS) ? COMP_MAX_CHANNELS : channels;
+	e->keyframe_every = keyframe_every ? keyframe_every : 1;
+	e->since_key = 0;
+	e->seq = 0;
+	e->force_key = 1;
+}
+
+/**
+ * void comp_encoder_keyframe(comp_encoder_t *e)
+ * @brief make the next block a keyframe (e.g. after the link dropped a block)
+ */
+void comp_encoder_keyframe(comp_encoder_t *e){
+	e->force_key = 1;
+}
+
+/**
+ * uint32_t comp_encode(comp_encoder_t *e, const int16_t *samples, uint8_t n, uint8_t *out)
+ * @brief compress n interleaved samples into one block
+ * @step followed:
+ *
+ * 1. Write the header; a keyframe also carries the first sample as is
+ * 2. Write every other value as the varint of its difference to the previous
+ *    sample of the same channel
+ *
+ * @return block length, at most COMP_BLOCK_MAX(channels, n); 0 if n is out of range
+ */
+uint32_t comp_encode(comp_encoder_t *e, const int16_t *samples, uint8_t n, uint8_t *out){
+	uint8_t *p = out;
+	uint8_t ch = e->channels;
+	uint32_t first = 0;
+	int key;
+
+	if(n == 0 || n > COMP_MAX_SAMPLES){
+		return 0;
+	}
+
+	/*1. Write the header; a keyframe also carries the first sample as is*/
+	key = e->force_key || e->since_key == 0;
+	*p++ = (uint8_t)(n | (key ? COMP_KEYFRAME : 0));
+	*p++ = ch;
+	*p++ = e->seq++;
+	if(key){
+		for(uint8_t c = 0; c < ch; c++){
+			*p++ = (uint8_t)samples[c];
+			*p++ = (uint8_t)((uint16_t)samples[c] >> 8);
+			e->prev[c] = samples[c];
+		}
+		samples += ch;
+		first = 1;
+		e->force_key = 0;
+	}
+	if(++e->since_key >= e->keyframe_every){
+		e->since_key = 0;
+	}
+
+	/*2. Write every other value as the varint of its difference*/
+	for(uint32_t i = first; i < n; i++){
+		for(uint8_t c = 0; c < ch; c++){
+			p = comp_put_varint(p, (uint16_t)(samples[c] - e->prev[c]));
+			e->prev[c] = samples[c];
+		}
+		samples += ch;
+	}
+	return (uint32_t)(p - out);
+}
+
+/**
+ * void comp_decoder_init(comp_decoder_t *d)
+ * @brief reset a decoder; it waits for a keyframe
+ */
+void comp_decoder_init(comp_decoder_t *d){
+	d->synced = 0;
+	d->seq = 0;
+	d->channels = 0;
+	d->blocks = 0;
+	d->skipped = 0;
+	d->errors = 0;
+}
+
+/**
+ * int comp_decode(comp_decoder_t *d, const uint8_t *in, uint32_t len, int16_t *samples, uint32_t max_samples)
+ * @brief decompress one block into interleaved samples
+ * @step followed:
+ *
+ * 1. Check the header; lose sync on a block seq jump
+ * 2. Skip non-keyframes until synced
+ * 3. A keyframe restarts from its first sample
+ * 4. Add up the varint differences, checking every byte against len
+ *
+ * @return samples written, 0 when skipped waiting for a keyframe, -1 malformed
+ */
+int comp_decode(comp_decoder_t *d, const uint8_t *in, uint32_t len, int16_t *samples, uint32_t max_samples){
+	const uint8_t *end = in + len;
+	uint32_t n, ch, first = 0;
+	uint32_t z;
+	uint8_t shift;
+	int key;
+
+	/*1. Check the header; lose sync on a block seq jump*/
+	if(len < COMP_HEADER_LEN){
+		d->errors++;
+		return -1;
+	}
+	key = (in[0] & COMP_KEYFRAME) != 0;
+	n = in[0] & (uint8_t)~COMP_KEYFRAME;
+	ch = in[1];
+	if(n == 0 || ch == 0 || ch > COMP_MAX_CHANNELS || n > max_samples){
+		d->errors++;
+		d->synced = 0;
+		return -1;
+	}
+	if(in[2] != d->seq || ch != d->channels){
+		d->synced = 0;
+	}
+	d->seq = (uint8_t)(in[2] + 1U);
+	in += COMP_HEADER_LEN;
+
+	/*2. Skip non-keyframes until synced*/
+	if(!key && !d->synced){
+		d->skipped++;
+		return 0;
+	}
+
+	/*3. A keyframe restarts from its first sample*/
+	if(key){
+		if((uint32_t)(end - in) < 2U * ch){
+			d->errors++;
+			d->synced = 0;
+			return -1;
+		}
+		for(uint32_t c = 0; c < ch; c++){
+			d->prev[c] = (int16_t)(in[0] | in[1] << 8);
+			samples[c] = d->prev[c];
+			in += 2;
+		}
+		d->channels = (uint8_t)ch;
+		first = 1;
+	}
+
+	/*4. Add up the varint differences, checking every byte against len*/
+	for(uint32_t i = first; i < n; i++){
+		for(uint32_t c = 0; c < ch; c++){
+			z = 0;
+			shift = 0;
+			do{
+				if(in == end || shift > 14){
+					d->errors++;
+					d->synced = 0;
+					return -1;
+				}
+				z |= (uint32_t)(*in & 0x7FU) << shift;
+				shift += 7;
+			}while(*in++ & 0x80U);
+			d->prev[c] = (int16_t)(d->prev[c] + (int16_t)((z >> 1) ^ (0U - (z & 1U))));
+			samples[i * ch + c] = d->prev[c];
+		}
+	}
+	d->synced = 1;
+	d->blocks++;
+	return (int)n;
+}
@@ -0,0 +1,290 @@
+/**
+ * crc.c
+ *	@brief source file for CRC-32 checksums
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Software path: table driven, one byte per step; the table is const so
+ * it stays in flash.
+ *
+ * Hardware path (arm only): the CRC unit has no init register, it can only
+ * be reset to 0xFFFFFFFF. To continue from any other crc the first word
+ * written is chosen so that the unit steps from 0xFFFFFFFF to exactly that
+ * value (crc32_unshift). Bytes are packed big endian into words with REV;
+ * the 0..3 trailing bytes go through the table.
+ * DMA path: DMA2 Stream0 in memory-to-memory mode writes the words to
+ * CRC->DR (only DMA2 can do memory-to-memory). The words go in as stored,
+ * so this path is only used for crc32_words(). A transfer error (a bus
+ * fault on the source, e.g. an address past the end of flash) leaves the
+ * unit part way through a block; the rest is done by the table from the
+ * CRC of the blocks before it, and counted in crc_dma_errors.
+ */
+
+#include "crc.h"
+#include "atomic.h"
+#include "bitband.h"
+#if defined(__arm__)
+#include "stm32f4xx.h"
+#endif
+
+#define CRC32_POLY				(0x04C11DB7U)
+#define CRC_DMA_MAX_WORDS		(0xFFFFU)	// NDTR is 16 bits
+
+volatile uint32_t crc_dma_errors;
+
+/* crc32_table[i] = CRC of the byte i followed by 24 zero bits */
+static const uint32_t crc32_table[256] = {
+	0x00000000U, 0x04C11DB7U, 0x09823B6EU, 0x0D4326D9U, 0x130476DCU, 0x17C56B6BU,
+	0x1A864DB2U, 0x1E475005U, 0x2608EDB8U, 0x22C9F00FU, 0x2F8AD6D6U, 0x2B4BCB61U,
+	0x350C9B64U, 0x31CD86D3U, 0x3C8EA00AU, 0x384FBDBDU, 0x4C11DB70U, 0x48D0C6C7U,
+	0x4593E01EU, 0x4152FDA9U, 0x5F15ADACU, 0x5BD4B01BU, 0x569796C2U, 0x52568B75U,
+	0x6A1936C8U, 0x6ED82B7FU, 0x639B0DA6U, 0x675A1011U, 0x791D4014U, 0x7DDC5DA3U,
+	0x709F7B7AU, 0x745E66CDU, 0x9823B6E0U, 0x9CE2AB57U, 0x91A18D8EU, 0x95609039U,
+	0x8B27C03CU, 0x8FE6DD8BU, 0x82A5FB52U, 0x8664E6E5U, 0xBE2B5B58U, 0xBAEA46EFU,
+	0xB7A96036U, 0xB3687D81U, 0xAD2F2D84U, 0xA9EE3033U, 0xA4AD16EAU, 0xA06C0B5DU,
+	0xD4326D90U, 0xD0F37027U, 0xDDB056FEU, 0xD9714B49U, 0xC7361B4CU, 0xC3F706FBU,
+	0xCEB42022U, 0xCA753D95U, 0xF23A8028U, 0xF6FB9D9FU, 0xFBB8BB46U, 0xFF79A6F1U,
+	0xE13EF6F4U, 0xE5FFEB43U, 0xE8BCCD9AU, 0xEC7DD02DU, 0x34867077U, 0x30476DC0U,
+	0x3D044B19U, 0x39C556AEU, 0x278206ABU, 0x23431B1CU, 0x2E003DC5U, 0x2AC12072U,
+	0x128E9DCFU, 0x164F8078U, 0x1B0CA6A1U, 0x1FCDBB16U, 0x018AEB13U, 0x054BF6A4U,
+	0x0808D07DU, 0x0CC9CDCAU, 0x7897AB07U, 0x7C56B6B0U, 0x71159069U, 0x75D48DDEU,
+	0x6B93DDDBU, 0x6F52C06CU, 0x6211E6B5U, 0x66D0FB02U, 0x5E9F46BFU, 0x5A5E5B08U,
+	0x571D7DD1U, 0x53DC6066U, 0x4D9B3063U, 0x495A2DD4U, 0x44190B0DU, 0x40D816BAU,
+	0xACA5C697U, 0xA864DB20U, 0xA527FDF9U, 0xA1E6E04EU, 0xBFA1B04BU, 0xBB60ADFCU,
+	0xB6238B25U, 0xB2E29692U, 0x8AAD2B2FU, 0x8E6C3698U, 0x832F1041U, 0x87EE0DF6U,
+	0x99A95DF3U, 0x9D684044U, 0x902B669DU, 0x94EA7B2AU, 0xE0B41DE7U, 0xE4750050U,
+	0xE9362689U, 0xEDF73B3EU, 0xF3B06B3BU, 0xF771768CU, 0xFA325055U, 0xFEF34DE2U,
+	0xC6BCF05FU, 0xC27DEDE8U, 0xCF3ECB31U, 0xCBFFD686U, 0xD5B88683U, 0xD1799B34U,
+	0xDC3ABDEDU, 0xD8FBA05AU, 0x690CE0EEU, 0x6DCDFD59U, 0x608EDB80U, 0x644FC637U,
+	0x7A089632U, 0x7EC98B85U, 0x738AAD5CU, 0x774BB0EBU, 0x4F040D56U, 0x4BC510E1U,
+	0x46863638U, 0x42472B8FU, 0x5C007B8AU, 0x58C1663DU, 0x558240E4U, 0x51435D53U,
+	0x251D3B9EU, 0x21DC2629U, 0x2C9F00F0U, 0x285E1D47U, 0x36194D42U, 0x32D850F5U,
+	0x3F9B762CU, 0x3B5A6B9BU, 0x0315D626U, 0x07D4CB91U, 0x0A97ED48U, 0x0E56F0FFU,
+	0x1011A0FAU, 0x14D0BD4DU, 0x19939B94U, 0x1D528623U, 0xF12F560EU, 0xF5EE4BB9U,
+	0xF8AD6D60U, 0xFC6C70D7U, 0xE22B20D2U, 0xE6EA3D65U, 0xEBA91BBCU, 0xEF68060BU,
+	0xD727BBB6U, 0xD3E6A601U, 0xDEA580D8U, 0xDA649D6FU, 0xC423CD6AU, 0xC0E2D0DDU,
+	0xCDA1F604U, 0xC960EBB3U, 0xBD3E8D7EU, 0xB9FF90C9U, 0xB4BCB610U, 0xB07DABA7U,
+	0xAE3AFBA2U, 0xAAFBE615U, 0xA7B8C0CCU, 0xA379DD7BU, 0x9B3660C6U, 0x9FF77D71U,
+	0x92B45BA8U, 0x9675461FU, 0x8832161AU, 0x8CF30BADU, 0x81B02D74U, 0x857130C3U,
+	0x5D8A9099U, 0x594B8D2EU, 0x5408ABF7U, 0x50C9B640U, 0x4E8EE645U, 0x4A4FFBF2U,
+	0x470CDD2BU, 0x43CDC09CU, 0x7B827D21U, 0x7F436096U, 0x7200464FU, 0x76C15BF8U,
+	0x68860BFDU, 0x6C47164AU, 0x61043093U, 0x65C52D24U, 0x119B4BE9U, 0x155A565EU,
+	0x18197087U, 0x1CD86D30U, 0x029F3D35U, 0x065E2082U, 0x0B1D065BU, 0x0FDC1BECU,
+	0x3793A651U, 0x3352BBE6U, 0x3E119D3FU, 0x3AD08088U, 0x2497D08DU, 0x2056CD3AU,
+	0x2D15EBE3U, 0x29D4F654U, 0xC5A92679U, 0xC1683BCEU, 0xCC2B1D17U, 0xC8EA00A0U,
+	0xD6AD50A5U, 0xD26C4D12U, 0xDF2F6BCBU, 0xDBEE767CU, 0xE3A1CBC1U, 0xE760D676U,
+	0xEA23F0AFU, 0xEEE2ED18U, 0xF0A5BD1DU, 0xF464A0AAU, 0xF9278673U, 0xFDE69BC4U,
+	0x89B8FD09U, 0x8D79E0BEU, 0x803AC667U, 0x84FBDBD0U, 0x9ABC8BD5U, 0x9E7D9662U,
+	0x933EB0BBU, 0x97FFAD0CU, 0xAFB010B1U, 0xAB710D06U, 0xA6322BDFU, 0xA2F33668U,
+	0xBCB4666DU, 0xB8757BDAU, 0xB5365D03U, 0xB1F740B4U
+};
+
+#if defined(__arm__)
+static volatile uint32_t crc_hw_ready;
+static volatile uint32_t crc_hw_busy;
+#endif
+
+/**
+ * uint32_t crc32_mpeg2_sw(uint32_t crc, const uint8_t *data, uint32_t len)
+ * @brief update crc with len bytes of data, table driven
+ * @return the new CRC
+ */
+uint32_t crc32_mpeg2_sw(uint32_t crc, const uint8_t *data, uint32_t len){
+	while(len--){
+		crc = (crc << 8) ^ crc32_table[(crc >> 24) ^ *data++];
+	}
+	return crc;
+}
+
+/**
+ * uint32_t crc32_words_sw(uint32_t crc, const uint32_t *words, uint32_t n)
+ * @brief update crc with n words, each most significant byte first, table driven
+ */
+uint32_t crc32_words_sw(uint32_t crc, const uint32_t *words, uint32_t n){
+	uint32_t w;
+
+	while(n--){
+		w = *words++;
+		crc = (crc << 8) ^ crc32_table[(crc >> 24) ^ (w >> 24)];
+		crc = (crc << 8) ^ crc32_table[(crc >> 24) ^ ((w >> 16) & 0xFFU)];
+		crc = (crc << 8) ^ crc32_table[(crc >> 24) ^ ((w >> 8) & 0xFFU)];
+		crc = (crc << 8) ^ crc32_table[(crc >> 24) ^ (w & 0xFFU)];
+	}
+	return crc;
+}
+
+#if defined(__arm__)
+
+/**
+ * void crc_init(void)
+ * @brief enable the CRC unit and DMA2 and switch the dispatchers to hardware
+ */
+void crc_init(void){
+	RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN | RCC_AHB1ENR_DMA2EN;
+	(void)RCC->AHB1ENR;
+	crc_hw_ready = 1;
+}
+
+/**
+ * uint32_t crc32_unshift(uint32_t crc)
+ * @brief undo 32 steps of the CRC shift register: the value x for which
+ *        32 steps from x (with zero input) end in crc.
+ */
+static uint32_t crc32_unshift(uint32_t crc){
+	for(uint32_t i = 0; i < 32; i++){
+		/* a forward step that shifted out a 1 also XORed the polynomial, whose bit 0 is set */
+		crc = (crc & 1U) ? ((crc ^ CRC32_POLY) >> 1) | 0x80000000U : crc >> 1;
+	}
+	return crc;
+}
+
+/**
+ * void crc32_hw_start(uint32_t crc)
+ * @brief reset the unit and, unless crc is the reset value, step it to crc
+ */
+static void crc32_hw_start(uint32_t crc){
+	CRC->CR = CRC_CR_RESET;
+	if(crc != CRC32_INIT){
+		CRC->DR = crc32_unshift(crc) ^ CRC32_INIT;
+	}
+}
+
+/**
+ * int crc32_hw_claim(void)
+ * @brief take the unit; fails if it is not set up or another caller holds it
+ */
+static int crc32_hw_claim(void){
+	return crc_hw_ready && atomic_cas_u32(&crc_hw_busy, 0, 1);
+}
+
+/**
+ * uint32_t crc32_mpeg2_hw(uint32_t crc, const uint8_t *data, uint32_t len)
+ * @brief byte stream CRC on the CRC unit (caller has claimed it)
+ * @step followed:
+ *
+ * 1. Load crc into the unit
+ * 2. Feed four bytes at a time, packed big endian (REV of an unaligned load)
+ * 3. Read the result and finish the trailing bytes with the table
+ */
+uint32_t crc32_mpeg2_hw(uint32_t crc, const uint8_t *data, uint32_t len){
+
+	/*1. Load crc into the unit*/
+	crc32_hw_start(crc);
+
+	/*2. Feed four bytes at a time, packed big endian*/
+	for(; len >= 4U; len -= 4U, data += 4){
+		CRC->DR = __REV(__UNALIGNED_UINT32_READ(data));
+	}
+
+	/*3. Read the result and finish the trailing bytes with the table*/
+	return crc32_mpeg2_sw(CRC->DR, data, len);
+}
+
+/**
+ * uint32_t crc32_words_hw(uint32_t crc, const uint32_t *words, uint32_t n)
+ * @brief word CRC on the CRC unit, written by the CPU (caller has claimed it)
+ */
+uint32_t crc32_words_hw(uint32_t crc, const uint32_t *words, uint32_t n){
+	crc32_hw_start(crc);
+	while(n--){
+		CRC->DR = *words++;
+	}
+	return CRC->DR;
+}
+
+/**
+ * uint32_t crc32_words_dma(uint32_t crc, const uint32_t *words, uint32_t n)
+ * @brief word CRC on the CRC unit, written by DMA2 Stream0 (caller has claimed it)
+ * @step followed:
+ *
+ * 1. Load crc into the unit
+ * 2. Per block of up to 65535 words: source = words (incrementing),
+ *    destination = CRC->DR (fixed), 32 bit both sides, memory-to-memory
+ * 3. Start and wait for transfer complete or transfer error
+ * 4. On a transfer error the unit has taken an unknown part of the block:
+ *    finish from the CRC of the blocks before it with the table
+ * 5. Read the result
+ */
+uint32_t crc32_words_dma(uint32_t crc, const uint32_t *words, uint32_t n){
+	uint32_t block;
+	uint32_t isr;
+
+	/*1. Load crc into the unit*/
+	crc32_hw_start(crc);
+
+	while(n){
+		block = (n > CRC_DMA_MAX_WORDS) ? CRC_DMA_MAX_WORDS : n;
+		crc = CRC->DR;		// the CRC of everything before this block
+
+		/*2. Source = words, destination = CRC->DR, 32 bit, memory-to-memory*/
+		DMA2_Stream0->CR = 0;
+		while(DMA2_Stream0->CR & DMA_SxCR_EN){}
+		DMA2->LIFCR = DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0;
+		DMA2_Stream0->PAR = (uint32_t)words;
+		DMA2_Stream0->M0AR = (uint32_t)&CRC->DR;
+		DMA2_Stream0->NDTR = block;
+		DMA2_Stream0->FCR = DMA_SxFCR_DMDIS;
+		DMA2_Stream0->CR = DMA_SxCR_DIR_1 | DMA_SxCR_PINC | DMA_SxCR_PSIZE_1 | DMA_SxCR_MSIZE_1;
+
+		/*3. Start and wait for transfer complete or transfer error*/
+		BB_SET(DMA2_Stream0->CR, DMA_SxCR_EN_Pos);
+		while(!((isr = DMA2->LISR) & (DMA_LISR_TCIF0 | DMA_LISR_TEIF0))){}
+
+		/*4. On a transfer error finish with the table*/
+		if(isr & DMA_LISR_TEIF0){
+			DMA2_Stream0->CR = 0;		// the hardware has disabled it already
+			DMA2->LIFCR = DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0;
+			crc_dma_errors++;
+			return crc32_words_sw(crc, words, n);
+		}
+
+		words += block;
+		n -= block;
+	}
+
+	/*5. Read the result*/
+	return CRC->DR;
+}
+
+/**
+ * uint32_t crc32_mpeg2(uint32_t crc, const uint8_t *data, uint32_t len)
+ * @brief byte stream CRC: CRC unit when available, table otherwise
+ */
+uint32_t crc32_mpeg2(uint32_t crc, const uint8_t *data, uint32_t len){
+	if(len >= 4U && crc32_hw_claim()){
+		crc = crc32_mpeg2_hw(crc, data, len);
+		crc_hw_busy = 0;
+		return crc;
+	}
+	return crc32_mpeg2_sw(crc, data, len);
+}
+
+/**
+ * uint32_t crc32_words(uint32_t crc, const uint32_t *words, uint32_t n)
+ * @brief word CRC: DMA for long blocks, CRC unit written by the CPU for
+ *        short ones, table when the unit is not available
+ */
+uint32_t crc32_words(uint32_t crc, const uint32_t *words, uint32_t n){
+	if(crc32_hw_claim()){
+		crc = (n >= CRC_DMA_MIN_WORDS) ? crc32_words_dma(crc, words, n) : crc32_words_hw(crc, words, n);
+		crc_hw_busy = 0;
+		return crc;
+	}
+	return crc32_words_sw(crc, words, n);
+}
+
+#else
+
+/* host build: table only */
+void crc_init(void){
+}
+
+uint32_t crc32_mpeg2(uint32_t crc, const uint8_t *data, uint32_t len){
+	return crc32_mpeg2_sw(crc, data, len);
+}
+
+uint32_t crc32_words(uint32_t crc, const uint32_t *words, uint32_t n){
+	return crc32_words_sw(crc, words, n);
+}
+
+#endif
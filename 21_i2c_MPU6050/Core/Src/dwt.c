@@ -0,0 +1,29 @@
+/**
+ * dwt.c
+ *	@brief source file for the DWT cycle counter
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include "dwt.h"
+
+/**
+ * void dwt_init(void)
+ * @brief enable the DWT cycle counter
+ * @step followed:
+ *
+ * 1. Enable the trace and debug blocks (TRCENA)
+ * 2. Reset the cycle counter
+ * 3. Enable the cycle counter
+ */
+void dwt_init(void){
+
+	/*1. Enable the trace and debug blocks (TRCENA)*/
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+	/*2. Reset the cycle counter*/
+	DWT->CYCCNT = 0;
+
+	/*3. Enable the cycle counter*/
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
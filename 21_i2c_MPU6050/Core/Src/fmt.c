@@ -0,0 +1,623 @@
+/**
+ * fmt.c
+ *	@brief source file for the allocation-free formatted output
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Output is gathered in a small buffer on the stack and handed to the sink
+ * when it fills up and at the end, so a sink is called a few times per
+ * call rather than once per character.
+ *
+ * %f without floating point arithmetic: the double is split into its
+ * integer part and a fraction k / 2^s (both exact), the fraction is scaled
+ * by 10^precision in 128 bit integer arithmetic and the remainder decides
+ * the rounding, which gives the correctly rounded result printf prints.
+ */
+
+#include <string.h>
+#include "fmt.h"
+
+#define FMT_BUF_LEN				(32)
+
+/* flags */
+#define FMT_LEFT				(1U << 0)
+#define FMT_PLUS				(1U << 1)
+#define FMT_SPACE				(1U << 2)
+#define FMT_ALT					(1U << 3)
+#define FMT_ZERO				(1U << 4)
+#define FMT_UPPER				(1U << 5)
+
+/* length modifiers */
+enum {
+	FMT_LEN_INT = 0,
+	FMT_LEN_CHAR,
+	FMT_LEN_SHORT,
+	FMT_LEN_LONG,
+	FMT_LEN_LLONG,
+	FMT_LEN_SIZE
+};
+
+typedef struct {
+	fmt_sink_t sink;
+	void *ctx;
+	uint32_t used;
+	int count;
+	char buf[FMT_BUF_LEN];
+} fmt_out_t;
+
+typedef struct {
+	uint32_t flags;
+	int width;
+	int prec;				// -1 when not given
+	uint8_t len;
+} fmt_spec_t;
+
+static const uint32_t pow10_u32[FMT_FLOAT_PREC_MAX + 1] = {
+	1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U
+};
+
+/**
+ * void fmt_flush(fmt_out_t *o)
+ * @brief hand the buffered characters to the sink
+ */
+static void fmt_flush(fmt_out_t *o){
+	if(o->used){
+		o->sink(o->ctx, o->buf, o->used);
+		o->used = 0;
+	}
+}
+
+/**
+ * void fmt_put(fmt_out_t *o, const char *s, uint32_t n)
+ * @brief append n characters
+ */
+static void fmt_put(fmt_out_t *o, const char *s, uint32_t n){
+	o->count += (int)n;
+	while(n){
+		uint32_t k = FMT_BUF_LEN - o->used;
+
+		if(k > n){
+			k = n;
+		}
+		memcpy(&o->buf[o->used], s, k);
+		o->used += k;
+		s += k;
+		n -= k;
+		if(o->used == FMT_BUF_LEN){
+			fmt_flush(o);
+		}
+	}
+}
+
+/**
+ * void fmt_rep(fmt_out_t *o, char c, int n)
+ * @brief append c n times (nothing if n <= 0)
+ */
+static void fmt_rep(fmt_out_t *o, char c, int n){
+	while(n-- > 0){
+		if(o->used == FMT_BUF_LEN){
+			fmt_flush(o);
+		}
+		o->buf[o->used++] = c;
+		o->count++;
+	}
+}
+
+/**
+ * uint32_t fmt_utoa(uint64_t v, uint32_t base, int upper, char *end)
+ * @brief digits of v written backwards ending at end
+ * @return number of digits (0 for v == 0)
+ */
+static uint32_t fmt_utoa(uint64_t v, uint32_t base, int upper, char *end){
+	const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	uint32_t v32;
+	char *p = end;
+
+	/* 64 bit division is a library call on the M4, stay in 32 bits when possible */
+	while(v > 0xFFFFFFFFU){
+		*--p = digits[v % base];
+		v /= base;
+	}
+	v32 = (uint32_t)v;
+	while(v32){
+		*--p = digits[v32 % base];
+		v32 /= base;
+	}
+	return (uint32_t)(end - p);
+}
+
+/**
+ * void fmt_field(fmt_out_t *o, const fmt_spec_t *sp, const char *head, uint32_t nhead,
+ *                int zeros, const char *body, uint32_t nbody, const char *tail, uint32_t ntail, int zero_pad)
+ * @brief write one converted field padded to the width:
+ *        [spaces] head [zero padding] [zeros] body tail [spaces]
+ *        head is the sign and/or 0x prefix, zeros the precision padding.
+ */
+static void fmt_field(fmt_out_t *o, const fmt_spec_t *sp, const char *head, uint32_t nhead,
+		int zeros, const char *body, uint32_t nbody, const char *tail, uint32_t ntail, int zero_pad){
+	int pad = sp->width - (int)(nhead + nbody + ntail) - zeros;
+
+	if(!(sp->flags & FMT_LEFT) && !zero_pad){
+		fmt_rep(o, ' ', pad);
+	}
+	fmt_put(o, head, nhead);
+	if(!(sp->flags & FMT_LEFT) && zero_pad){
+		fmt_rep(o, '0', pad);
+	}
+	fmt_rep(o, '0', zeros);
+	fmt_put(o, body, nbody);
+	fmt_put(o, tail, ntail);
+	if(sp->flags & FMT_LEFT){
+		fmt_rep(o, ' ', pad);
+	}
+}
+
+/**
+ * uint32_t fmt_sign(const fmt_spec_t *sp, int negative, char *head)
+ * @brief sign character for a signed conversion
+ */
+static uint32_t fmt_sign(const fmt_spec_t *sp, int negative, char *head){
+	if(negative){
+		*head = '-';
+	}else if(sp->flags & FMT_PLUS){
+		*head = '+';
+	}else if(sp->flags & FMT_SPACE){
+		*head = ' ';
+	}else{
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * void fmt_integer(fmt_out_t *o, const fmt_spec_t *sp, uint64_t mag, int negative, char conv)
+ * @brief %d %i %u %x %X %o
+ */
+static void fmt_integer(fmt_out_t *o, const fmt_spec_t *sp, uint64_t mag, int negative, char conv){
+	char digits[24];
+	char head[3];
+	uint32_t nhead = 0;
+	uint32_t base = (conv == 'o') ? 8U : (conv == 'x' || conv == 'X') ? 16U : 10U;
+	uint32_t n = fmt_utoa(mag, base, conv == 'X', &digits[sizeof(digits)]);
+	int zeros;
+
+	/* precision 0 prints nothing for 0, without precision 0 is one digit */
+	if(n == 0 && sp->prec != 0){
+		digits[sizeof(digits) - 1] = '0';
+		n = 1;
+	}
+	zeros = (sp->prec > (int)n) ? sp->prec - (int)n : 0;
+
+	if(conv == 'd' || conv == 'i'){
+		nhead = fmt_sign(sp, negative, head);
+	}else if((sp->flags & FMT_ALT) && conv == 'o'){
+		if(zeros == 0 && (n == 0 || digits[sizeof(digits) - n] != '0')){
+			zeros = 1;
+		}
+	}else if((sp->flags & FMT_ALT) && base == 16U && mag != 0){
+		head[0] = '0';
+		head[1] = conv;
+		nhead = 2;
+	}
+	fmt_field(o, sp, head, nhead, zeros, &digits[sizeof(digits) - n], n, 0, 0,
+			(sp->flags & FMT_ZERO) && sp->prec < 0);
+}
+
+/**
+ * void fmt_decimals(fmt_out_t *o, const fmt_spec_t *sp, int negative, uint64_t ipart, uint32_t frac, int prec)
+ * @brief write ipart '.' frac (frac zero padded to prec digits) as one field
+ */
+static void fmt_decimals(fmt_out_t *o, const fmt_spec_t *sp, int negative, uint64_t ipart, uint32_t frac, int prec){
+	char digits[24];
+	char tail[FMT_FLOAT_PREC_MAX + 1];
+	char head[1];
+	uint32_t nhead = fmt_sign(sp, negative, head);
+	uint32_t n = fmt_utoa(ipart, 10U, 0, &digits[sizeof(digits)]);
+	uint32_t ntail = 0;
+
+	if(n == 0){
+		digits[sizeof(digits) - 1] = '0';
+		n = 1;
+	}
+	if(prec > 0 || (sp->flags & FMT_ALT)){
+		tail[0] = '.';
+		for(int i = prec; i > 0; i--){
+			tail[i] = (char)('0' + frac % 10U);
+			frac /= 10U;
+		}
+		ntail = (uint32_t)prec + 1U;
+	}
+	fmt_field(o, sp, head, nhead, 0, &digits[sizeof(digits) - n], n, tail, ntail,
+			(sp->flags & FMT_ZERO) != 0);
+}
+
+/**
+ * void fmt_round(uint64_t *ipart, uint64_t k, uint32_t s, int prec, uint32_t *frac)
+ * @brief round ipart + k / 2^s (k < 2^53) to prec decimals, half to even
+ * @step followed:
+ *
+ * 1. p = k * 10^prec as a 128 bit number hi:lo
+ * 2. frac = p >> s, remainder = p mod 2^s, compared with half = 2^(s-1)
+ * 3. Round up above half, and at exactly half when the last digit is odd;
+ *    carry into the integer part when the fraction overflows
+ */
+static void fmt_round(uint64_t *ipart, uint64_t k, uint32_t s, int prec, uint32_t *frac){
+	uint64_t p10 = pow10_u32[prec];
+	uint64_t a, b, lo, hi;
+	uint64_t rem_hi, rem_lo, half_hi, half_lo;
+	uint64_t q;
+	int cmp;
+	uint32_t last;
+
+	*frac = 0;
+	if(k == 0 || s == 0){
+		return;
+	}
+
+	/*1. p = k * 10^prec as a 128 bit number hi:lo*/
+	a = (k & 0xFFFFFFFFU) * p10;
+	b = (k >> 32) * p10;
+	lo = a + (b << 32);
+	hi = (b >> 32) + (lo < a);
+
+	/*2. frac = p >> s, remainder = p mod 2^s, compared with half = 2^(s-1)*/
+	if(s >= 128U){
+		q = 0;
+		cmp = -1;		// p < 2^83 <= half
+	}else{
+		if(s >= 64U){
+			q = hi >> (s - 64U);
+			rem_hi = (s == 64U) ? 0 : hi & ((1ULL << (s - 64U)) - 1U);
+			rem_lo = lo;
+		}else{
+			q = (lo >> s) | (hi << (64U - s));
+			rem_hi = 0;
+			rem_lo = lo & ((1ULL << s) - 1U);
+		}
+		if(s - 1U >= 64U){
+			half_hi = 1ULL << (s - 65U);
+			half_lo = 0;
+		}else{
+			half_hi = 0;
+			half_lo = 1ULL << (s - 1U);
+		}
+		cmp = (rem_hi != half_hi) ? ((rem_hi > half_hi) ? 1 : -1)
+				: (rem_lo != half_lo) ? ((rem_lo > half_lo) ? 1 : -1) : 0;
+	}
+
+	/*3. Round up above half, and at exactly half when the last digit is odd*/
+	last = (prec > 0) ? (uint32_t)(q & 1U) : (uint32_t)(*ipart & 1U);
+	if(cmp > 0 || (cmp == 0 && last)){
+		q++;
+	}
+	if(q >= p10){
+		q -= p10;
+		(*ipart)++;
+	}
+	*frac = (uint32_t)q;
+}
+
+/**
+ * void fmt_double(fmt_out_t *o, const fmt_spec_t *sp, double x)
+ * @brief %f and %F
+ * @step followed:
+ *
+ * 1. Split the IEEE 754 bits into sign, exponent and mantissa
+ * 2. inf and nan
+ * 3. Integer part and fraction k / 2^s, "ovf" from 2^64 up
+ * 4. Round to the precision and write the field
+ */
+static void fmt_double(fmt_out_t *o, const fmt_spec_t *sp, double x){
+	uint64_t bits, m, ipart, k;
+	int32_t e;
+	uint32_t s, frac;
+	int prec = (sp->prec < 0) ? 6 : (sp->prec > FMT_FLOAT_PREC_MAX) ? FMT_FLOAT_PREC_MAX : sp->prec;
+	int upper = (sp->flags & FMT_UPPER) != 0;
+	fmt_spec_t sp_text = *sp;
+	char head[1];
+	uint32_t nhead;
+	int negative;
+
+	/*1. Split the IEEE 754 bits into sign, exponent and mantissa*/
+	memcpy(&bits, &x, sizeof(bits));
+	negative = (int)(bits >> 63);
+	e = (int32_t)((bits >> 52) & 0x7FFU);
+	m = bits & ((1ULL << 52) - 1U);
+
+	/*2. inf and nan*/
+	if(e == 0x7FF){
+		nhead = fmt_sign(sp, negative, head);
+		fmt_field(o, &sp_text, head, nhead, 0, m ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf"), 3, 0, 0, 0);
+		return;
+	}
+
+	/*3. Integer part and fraction k / 2^s*/
+	if(e){
+		m |= 1ULL << 52;
+	}else{
+		e = 1;			// subnormal
+	}
+	e -= 1075;			// x = m * 2^e
+	if(e >= 0){
+		if(e > 11){
+			nhead = fmt_sign(sp, negative, head);
+			fmt_field(o, &sp_text, head, nhead, 0, "ovf", 3, 0, 0, 0);
+			return;
+		}
+		ipart = m << e;
+		k = 0;
+		s = 0;
+	}else{
+		s = (uint32_t)-e;
+		ipart = (s >= 64U) ? 0 : m >> s;
+		k = (s >= 64U) ? m : m & ((1ULL << s) - 1U);
+	}
+
+	/*4. Round to the precision and write the field*/
+	fmt_round(&ipart, k, s, prec, &frac);
+	fmt_decimals(o, sp, negative, ipart, frac, prec);
+}
+
+/**
+ * void fmt_qformat(fmt_out_t *o, const fmt_spec_t *sp, int32_t raw, int32_t b)
+ * @brief %q: raw / 2^b, rounded like %f
+ */
+static void fmt_qformat(fmt_out_t *o, const fmt_spec_t *sp, int32_t raw, int32_t b){
+	int prec = (sp->prec < 0) ? 6 : (sp->prec > FMT_FLOAT_PREC_MAX) ? FMT_FLOAT_PREC_MAX : sp->prec;
+	uint32_t mag = (raw < 0) ? 0U - (uint32_t)raw : (uint32_t)raw;
+	uint64_t ipart;
+	uint32_t frac;
+
+	if(b < 0){
+		b = 0;
+	}else if(b > 31){
+		b = 31;
+	}
+	ipart = mag >> b;
+	fmt_round(&ipart, mag & ((1U << b) - 1U), (uint32_t)b, prec, &frac);
+	fmt_decimals(o, sp, raw < 0, ipart, frac, prec);
+}
+
+/**
+ * void fmt_fixed10(fmt_out_t *o, const fmt_spec_t *sp, int32_t v)
+ * @brief %k: v / 10^precision, exact
+ */
+static void fmt_fixed10(fmt_out_t *o, const fmt_spec_t *sp, int32_t v){
+	int prec = (sp->prec < 0) ? 0 : (sp->prec > FMT_FLOAT_PREC_MAX) ? FMT_FLOAT_PREC_MAX : sp->prec;
+	uint32_t mag = (v < 0) ? 0U - (uint32_t)v : (uint32_t)v;		// 32 bit division on the M4
+
+	fmt_decimals(o, sp, v < 0, mag / pow10_u32[prec], (uint32_t)(mag % pow10_u32[prec]), prec);
+}
+
+/**
+ * int fmt_vformat(fmt_sink_t sink, void *ctx, const char *format, va_list ap)
+ * @brief format into sink
+ * @step followed:
+ *
+ * 1. Copy literal text up to the next %
+ * 2. Parse flags, width, precision and length
+ * 3. Fetch the argument and convert it
+ * 4. Flush what is left in the buffer
+ *
+ * @return number of characters produced
+ */
+int fmt_vformat(fmt_sink_t sink, void *ctx, const char *format, va_list ap){
+	fmt_out_t o;
+	fmt_spec_t sp;
+	const char *p = format;
+	const char *s;
+	uint64_t u;
+	int64_t v;
+	char c;
+	uint32_t n;
+
+	o.sink = sink;
+	o.ctx = ctx;
+	o.used = 0;
+	o.count = 0;
+
+	while(*p){
+
+		/*1. Copy literal text up to the next %*/
+		s = p;
+		while(*p && *p != '%'){
+			p++;
+		}
+		fmt_put(&o, s, (uint32_t)(p - s));
+		if(!*p){
+			break;
+		}
+		p++;
+
+		/*2. Parse flags, width, precision and length*/
+		sp.flags = 0;
+		sp.width = 0;
+		sp.prec = -1;
+		sp.len = FMT_LEN_INT;
+		for(;; p++){
+			if(*p == '-') sp.flags |= FMT_LEFT;
+			else if(*p == '+') sp.flags |= FMT_PLUS;
+			else if(*p == ' ') sp.flags |= FMT_SPACE;
+			else if(*p == '#') sp.flags |= FMT_ALT;
+			else if(*p == '0') sp.flags |= FMT_ZERO;
+			else break;
+		}
+		if(*p == '*'){
+			sp.width = va_arg(ap, int);
+			if(sp.width < 0){
+				sp.flags |= FMT_LEFT;
+				sp.width = -sp.width;
+			}
+			p++;
+		}else{
+			while(*p >= '0' && *p <= '9'){
+				sp.width = sp.width * 10 + (*p++ - '0');
+			}
+		}
+		if(*p == '.'){
+			p++;
+			sp.prec = 0;
+			if(*p == '*'){
+				sp.prec = va_arg(ap, int);
+				if(sp.prec < 0){
+					sp.prec = -1;
+				}
+				p++;
+			}else{
+				while(*p >= '0' && *p <= '9'){
+					sp.prec = sp.prec * 10 + (*p++ - '0');
+				}
+			}
+		}
+		if(*p == 'h'){
+			sp.len = (*++p == 'h') ? (p++, FMT_LEN_CHAR) : FMT_LEN_SHORT;
+		}else if(*p == 'l'){
+			sp.len = (*++p == 'l') ? (p++, FMT_LEN_LLONG) : FMT_LEN_LONG;
+		}else if(*p == 'z'){
+			sp.len = FMT_LEN_SIZE;
+			p++;
+		}
+
+		/*3. Fetch the argument and convert it*/
+		switch(c = *p++){
+
+		case 'd':
+		case 'i':
+			switch(sp.len){
+			case FMT_LEN_CHAR:	v = (signed char)va_arg(ap, int); break;
+			case FMT_LEN_SHORT:	v = (short)va_arg(ap, int); break;
+			case FMT_LEN_LONG:	v = va_arg(ap, long); break;
+			case FMT_LEN_LLONG:	v = va_arg(ap, long long); break;
+			case FMT_LEN_SIZE:	v = (int64_t)va_arg(ap, size_t); break;
+			default:			v = va_arg(ap, int); break;
+			}
+			fmt_integer(&o, &sp, (v < 0) ? 0U - (uint64_t)v : (uint64_t)v, v < 0, c);
+			break;
+
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			switch(sp.len){
+			case FMT_LEN_CHAR:	u = (unsigned char)va_arg(ap, unsigned); break;
+			case FMT_LEN_SHORT:	u = (unsigned short)va_arg(ap, unsigned); break;
+			case FMT_LEN_LONG:	u = va_arg(ap, unsigned long); break;
+			case FMT_LEN_LLONG:	u = va_arg(ap, unsigned long long); break;
+			case FMT_LEN_SIZE:	u = va_arg(ap, size_t); break;
+			default:			u = va_arg(ap, unsigned); break;
+			}
+			fmt_integer(&o, &sp, u, 0, c);
+			break;
+
+		case 'c':
+			c = (char)va_arg(ap, int);
+			fmt_field(&o, &sp, 0, 0, 0, &c, 1, 0, 0, 0);
+			break;
+
+		case 's':
+			s = va_arg(ap, const char *);
+			if(!s){
+				s = "(null)";
+			}
+			for(n = 0; s[n] && (sp.prec < 0 || n < (uint32_t)sp.prec); n++){}
+			fmt_field(&o, &sp, 0, 0, 0, s, n, 0, 0, 0);
+			break;
+
+		case 'F':
+			sp.flags |= FMT_UPPER;
+			/* fall through */
+		case 'f':
+			fmt_double(&o, &sp, va_arg(ap, double));
+			break;
+
+		case 'k':
+			fmt_fixed10(&o, &sp, (int32_t)((sp.len == FMT_LEN_LONG) ? va_arg(ap, long) : va_arg(ap, int)));
+			break;
+
+		case 'q':
+			v = va_arg(ap, int);
+			fmt_qformat(&o, &sp, (int32_t)v, va_arg(ap, int));
+			break;
+
+		case '%':
+			fmt_put(&o, "%", 1);
+			break;
+
+		default:
+			/* unknown conversion: print it as is */
+			fmt_put(&o, p - 1, c ? 1 : 0);
+			if(!c){
+				p--;
+			}
+			break;
+		}
+	}
+
+	/*4. Flush what is left in the buffer*/
+	fmt_flush(&o);
+	return o.count;
+}
+
+/**
+ * int fmt_format(fmt_sink_t sink, void *ctx, const char *format, ...)
+ * @brief format into sink
+ */
+int fmt_format(fmt_sink_t sink, void *ctx, const char *format, ...){
+	va_list ap;
+	int n;
+
+	va_start(ap, format);
+	n = fmt_vformat(sink, ctx, format, ap);
+	va_end(ap);
+	return n;
+}
+
+typedef struct {
+	char *buf;
+	size_t size;
+	size_t used;
+} fmt_mem_t;
+
+/**
+ * void fmt_mem_sink(void *ctx, const char *s, uint32_t n)
+ * @brief sink for fmt_vsnprintf: copy what fits, keep room for the terminator
+ */
+static void fmt_mem_sink(void *ctx, const char *s, uint32_t n){
+	fmt_mem_t *m = ctx;
+	size_t room = (m->used + 1U < m->size) ? m->size - 1U - m->used : 0;
+
+	if(n > room){
+		n = (uint32_t)room;
+	}
+	memcpy(&m->buf[m->used], s, n);
+	m->used += n;
+}
+
+/**
+ * int fmt_vsnprintf(char *buf, size_t size, const char *format, va_list ap)
+ * @brief format into buf like vsnprintf: always terminated when size > 0
+ * @return the length the full output would have
+ */
+int fmt_vsnprintf(char *buf, size_t size, const char *format, va_list ap){
+	fmt_mem_t m = {buf, size, 0};
+	int n = fmt_vformat(fmt_mem_sink, &m, format, ap);
+
+	if(size){
+		buf[m.used] = '\0';
+	}
+	return n;
+}
+
+/**
+ * int fmt_snprintf(char *buf, size_t size, const char *format, ...)
+ * @brief format into buf like snprintf
+ */
+int fmt_snprintf(char *buf, size_t size, const char *format, ...){
+	va_list ap;
+	int n;
+
+	va_start(ap, format);
+	n = fmt_vsnprintf(buf, size, format, ap);
+	va_end(ap);
+	return n;
+}
@@ -8,81 +8,310 @@
 
 #include "stm32f4xx.h"
 #include "i2c.h"
+#include "sched.h"
+#include "bitband.h"
+#include "gpio.h"
+#include "atomic.h"
+#include "dwt.h"
 #include <stdio.h>
 
-#define I2C_100KHZ 						80; // I2C to standard mode; refer to the reference manual for calculation.
-#define SD_MODE_MAX_RISE_TIME				17; // same as above.
-#define GPIOAEN 			(1U << 0)
-#define PIN5				(1U << 5)
-#define LED_PIN				PIN5
+#define I2C_100KHZ 						(80) // I2C to standard mode; refer to the reference manual for calculation.
+#define SD_MODE_MAX_RISE_TIME				(17) // same as above.
+#define I2C_SR1_ERRORS					(I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR)
+#define I2C_US(us)						((SystemCoreClock / 1000000U) * (uint32_t)(us))	// DWT cycles
+#define I2C_HALF_BIT_US					(5)		// bus recovery clock, 100 kHz
+
+/* one attempt of a blocking transfer, against a DWT deadline */
+typedef int (*i2c_once_t)(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint32_t deadline);
+
+static void i2c_it_recover(i2c_handle_t *h);
+
+GPIO_CFG_DEFINE(i2c1_pins, I2C1_PINS);
+GPIO_CFG_DEFINE(i2c2_pins, I2C2_PINS);
+GPIO_CFG_DEFINE(i2c3_scl_pins, I2C3_SCL_PINS);
+GPIO_CFG_DEFINE(i2c3_sda_pins, I2C3_SDA_PINS);
+
+i2c_handle_t i2c1 = {
+	.regs = I2C1, .rcc_en = RCC_APB1ENR_I2C1EN, .ev_irq = I2C1_EV_IRQn, .er_irq = I2C1_ER_IRQn,
+	.pins = { { GPIOB, RCC_AHB1ENR_GPIOBEN, &i2c1_pins } },
+	.scl_port = GPIOB, .scl_pin = 8, .sda_port = GPIOB, .sda_pin = 9,
+};
+i2c_handle_t i2c2 = {
+	.regs = I2C2, .rcc_en = RCC_APB1ENR_I2C2EN, .ev_irq = I2C2_EV_IRQn, .er_irq = I2C2_ER_IRQn,
+	.pins = { { GPIOB, RCC_AHB1ENR_GPIOBEN, &i2c2_pins } },
+	.scl_port = GPIOB, .scl_pin = 10, .sda_port = GPIOB, .sda_pin = 3,
+};
+i2c_handle_t i2c3 = {
+	.regs = I2C3, .rcc_en = RCC_APB1ENR_I2C3EN, .ev_irq = I2C3_EV_IRQn, .er_irq = I2C3_ER_IRQn,
+	.pins = { { GPIOA, RCC_AHB1ENR_GPIOAEN, &i2c3_scl_pins },
+			  { GPIOC, RCC_AHB1ENR_GPIOCEN, &i2c3_sda_pins } },
+	.scl_port = GPIOA, .scl_pin = 8, .sda_port = GPIOC, .sda_pin = 9,
+};
 
 /**
- * void I2C1_init(void)
- * @brief Initialize I2C1
+ * void i2c_setup(i2c_handle_t *h)
+ * @brief reset the instance and program it: 100 kHz standard mode, enabled
  * @step followed:
  *
- * 1. Enable clock access to GPIOB
- * 2. Set PB8 and PB9 mode to alternate function
- * 3. Set PB8 and PB9 output type to open drain
- * 4. Enable pull-up register for PB8 and PB9
- * 5. Enable clock access to I2C1
- * 6. Enter the reset mode
- * 7. Come out of the reset mode
- * 8. Set the peripheral clock frequency
- * 9. Set I2C to standard mode, 100kHz clock. refer to the reference manual for calculation.
- * 10. Set rise time
- * 11. Enable I2C1 module.
- * ***************
- * Pin-out       *
- * PB8 ----- SCL *
- * PB9 ----- SDA *
- * ***************
+ * 1. Enter the reset mode
+ * 2. Come out of the reset mode
+ * 3. Set the peripheral clock frequency
+ * 4. Set I2C to standard mode, 100kHz clock. refer to the reference manual for calculation.
+ * 5. Set rise time
+ * 6. Enable the I2C module.
  */
-void I2C1_init(void){
-	/*1. Enable clock access to GPIOB */
-	RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN;
+static void i2c_setup(i2c_handle_t *h){
+	I2C_TypeDef *i2c = h->regs;
 
-	/*2. Set PB8 and PB9 mode to alternate function */
-	GPIOB->MODER |= (1U << 19) | (1U << 17);
-	GPIOB->MODER &= ~(1U << 18);
-	GPIOB->MODER &= ~(1U << 16);
+	/*1. Enter the reset mode */
+	BB_SET(i2c->CR1, I2C_CR1_SWRST_Pos);
 
-	/*3. Set PB8 and PB9 output type to open drain */
-	GPIOB->OTYPER |= GPIO_OTYPER_OT8 | GPIO_OTYPER_OT9;
+	/*2. Come out of the reset mode*/
+	BB_CLR(i2c->CR1, I2C_CR1_SWRST_Pos);
 
-	/*4. Enable pull-up register for PB8 and PB9 */
-	GPIOB->PUPDR |= GPIO_PUPDR_PUPDR8_0 | GPIO_PUPDR_PUPDR9_0;
-	GPIOB->PUPDR &= ~(1U << 19); // try ~GPIO_PUPDR_PUPDR8_1
-	GPIOB->PUPDR &= ~(1U << 17);
+	/*3. Set the peripheral clock frequency */
+	i2c->CR2 |= I2C_CR2_FREQ_4;
 
-	/*5. Enable clock access to I2C1 */
-	RCC->APB1ENR |= RCC_APB1ENR_I2C1EN;
+	/*4. Set I2C to standard mode, 100kHz clock. refer to the reference manual for calculation. */
+	i2c->CCR = I2C_100KHZ; // 100kHz
 
-	/*Bits (3:2:1:0) = 0:1:0:0 --> AF4 for pin PB8;  Bits (7:6:5:4) = 0:1:0:0 --> AF4 for pin PB9*/
-	GPIOB->AFR[1] |= (4<<0) | (4<<4);
+	/*5. Set rise time*/
+	i2c->TRISE = SD_MODE_MAX_RISE_TIME;
 
-	/*6. Enter the reset mode */
-	I2C1->CR1 |= I2C_CR1_SWRST;
+	/*6. Enable the I2C module. */
+	BB_SET(i2c->CR1, I2C_CR1_PE_Pos);
+}
+/**
+ * void i2c_init(i2c_handle_t *h)
+ * @brief Initialize one I2C instance (i2c1, i2c2 or i2c3)
+ * @step followed:
+ *
+ * 1. Enable clock access to the GPIO ports of the pins
+ * 2. Pins: alternate function, open drain, pull-up (I2Cx_PINS, i2c.h)
+ * 3. Enable clock access to the I2C instance
+ * 4. Reset and program the instance (i2c_setup, also the last step of a bus recovery)
+ * 5. Enable the event and error interrupts of the instance in NVIC
+ *
+ * The pin table is reached through the handle, so gpio_apply() reads its
+ * masks from flash here instead of folding them to immediates: a few loads
+ * more, once per bus at start-up.
+ */
+void i2c_init(i2c_handle_t *h){
 
-	/*7. Come out of the reset mode*/
-	I2C1->CR1 &= ~I2C_CR1_SWRST;
+	for(int i = 0; i < I2C_PIN_PORTS && h->pins[i].port; i++){
+		/*1. Enable clock access to the GPIO port */
+		RCC->AHB1ENR |= h->pins[i].rcc_en;
 
-	/*8. Set the peripheral clock frequency */
-	I2C1->CR2 |= I2C_CR2_FREQ_4;
+		/*2. Alternate function, open drain, pull-up, one write per register */
+		gpio_apply(h->pins[i].port, h->pins[i].cfg);
+	}
 
-	/*9. Set I2C to standard mode, 100kHz clock. refer to the reference manual for calculation. */
-	I2C1->CCR = I2C_100KHZ; // 100kHz
+	/*3. Enable clock access to the I2C instance */
+	RCC->APB1ENR |= h->rcc_en;
 
-	/*10. Set rise time*/
-	I2C1->TRISE = SD_MODE_MAX_RISE_TIME;
+	/*4. Reset and program the instance */
+	i2c_setup(h);
 
-	/*11. Enable I2C1 module. */
-	I2C1->CR1 |= I2C_CR1_PE;
+	/*5. Enable the event and error interrupts in NVIC (used by i2c_burst_read_it) */
+	NVIC_EnableIRQ(h->ev_irq);
+	NVIC_EnableIRQ(h->er_irq);
 
 }
 /**
- * void I2C1_byteRead(char saddr, char maddr, char* data)
- * @brief initialize I2C read function
+ * int i2c_status(uint32_t sr1)
+ * @brief the status of the error flags of SR1, I2C_OK if none is set
+ */
+static int i2c_status(uint32_t sr1){
+	if(sr1 & I2C_SR1_BERR){
+		return I2C_ERR_BERR;
+	}
+	if(sr1 & I2C_SR1_ARLO){
+		return I2C_ERR_ARLO;
+	}
+	if(sr1 & I2C_SR1_AF){
+		return I2C_ERR_NACK;
+	}
+	if(sr1 & I2C_SR1_OVR){
+		return I2C_ERR_OVR;
+	}
+	return I2C_OK;
+}
+/**
+ * void i2c_count(i2c_handle_t *h, int rc)
+ * @brief count a failed attempt in the statistics of the bus
+ */
+static void i2c_count(i2c_handle_t *h, int rc){
+	switch(rc){
+	case I2C_ERR_TIMEOUT:
+	case I2C_ERR_BUSY:
+		h->stats.timeouts++;
+		break;
+	case I2C_ERR_NACK:
+		h->stats.nacks++;
+		break;
+	case I2C_ERR_ARLO:
+		h->stats.arlo++;
+		break;
+	case I2C_ERR_BERR:
+		h->stats.berr++;
+		break;
+	default:
+		h->stats.ovr++;
+		break;
+	}
+}
+/**
+ * int i2c_wait(i2c_handle_t *h, uint32_t flag, uint32_t deadline)
+ * @brief wait for a flag of SR1, an error flag or the deadline, whichever comes first
+ * @return I2C_OK, the status of the error flag or I2C_ERR_TIMEOUT
+ */
+static int i2c_wait(i2c_handle_t *h, uint32_t flag, uint32_t deadline){
+	uint32_t sr1;
+
+	for(;;){
+		sr1 = h->regs->SR1;
+		if(sr1 & flag){
+			return I2C_OK;
+		}
+		if(sr1 & I2C_SR1_ERRORS){
+			return i2c_status(sr1);
+		}
+		if((int32_t)(dwt_cycles() - deadline) > 0){
+			return I2C_ERR_TIMEOUT;
+		}
+	}
+}
+/**
+ * int i2c_wait_idle(i2c_handle_t *h, uint32_t deadline)
+ * @brief wait until the bus is not busy, or the deadline
+ * @return I2C_OK or I2C_ERR_BUSY
+ */
+static int i2c_wait_idle(i2c_handle_t *h, uint32_t deadline){
+	while(h->regs->SR2 & I2C_SR2_BUSY){
+		if((int32_t)(dwt_cycles() - deadline) > 0){
+			return I2C_ERR_BUSY;
+		}
+	}
+	return I2C_OK;
+}
+/**
+ * void i2c_delay(uint32_t us)
+ * @brief busy wait on the DWT counter
+ */
+static void i2c_delay(uint32_t us){
+	uint32_t t0 = dwt_cycles();
+
+	while(dwt_cycles() - t0 < I2C_US(us)){}
+}
+/**
+ * void i2c_abort(i2c_handle_t *h)
+ * @brief end a failed attempt: no ACK, a STOP if we still own the bus, error flags cleared
+ */
+static void i2c_abort(i2c_handle_t *h){
+	I2C_TypeDef *i2c = h->regs;
+
+	BB_CLR(i2c->CR1, I2C_CR1_ACK_Pos);
+	if(i2c->SR2 & I2C_SR2_MSL){
+		BB_SET(i2c->CR1, I2C_CR1_STOP_Pos);
+	}
+	i2c->SR1 &= ~I2C_SR1_ERRORS;
+}
+/**
+ * void i2c_recover(i2c_handle_t *h)
+ * @brief free a bus held by a slave, then reset the instance; I2C_RECOVER_US at most
+ * @step followed:
+ *
+ * 1. Instance off, SCL and SDA released, as open-drain GPIO outputs
+ * 2. Clock SCL until SDA is high (the slave finished its byte), 9 times at most
+ * 3. STOP: SDA low, SCL high, SDA high
+ * 4. Pins back to the I2C alternate function
+ * 5. SWRST and the set-up of i2c_init()
+ */
+void i2c_recover(i2c_handle_t *h){
+	GPIO_TypeDef *scl = h->scl_port;
+	GPIO_TypeDef *sda = h->sda_port;
+	uint32_t scl_bit = 1U << h->scl_pin;
+	uint32_t sda_bit = 1U << h->sda_pin;
+
+	/*1. Instance off, SCL and SDA released, as GPIO outputs*/
+	BB_CLR(h->regs->CR1, I2C_CR1_PE_Pos);
+	scl->BSRR = scl_bit;
+	sda->BSRR = sda_bit;
+	scl->MODER = (scl->MODER & ~(3U << (2U * h->scl_pin))) | (PIN_MODE_OUT << (2U * h->scl_pin));
+	sda->MODER = (sda->MODER & ~(3U << (2U * h->sda_pin))) | (PIN_MODE_OUT << (2U * h->sda_pin));
+	i2c_delay(I2C_HALF_BIT_US);
+
+	/*2. Clock SCL until SDA is high, 9 times at most*/
+	for(int i = 0; i < I2C_RECOVER_CLOCKS && !(sda->IDR & sda_bit); i++){
+		scl->BSRR = scl_bit << 16;
+		i2c_delay(I2C_HALF_BIT_US);
+		scl->BSRR = scl_bit;
+		i2c_delay(I2C_HALF_BIT_US);
+	}
+
+	/*3. STOP: SDA low, SCL high, SDA high*/
+	scl->BSRR = scl_bit << 16;
+	sda->BSRR = sda_bit << 16;
+	i2c_delay(I2C_HALF_BIT_US);
+	scl->BSRR = scl_bit;
+	i2c_delay(I2C_HALF_BIT_US);
+	sda->BSRR = sda_bit;
+	i2c_delay(I2C_HALF_BIT_US);
+
+	/*4. Pins back to the I2C alternate function*/
+	for(int i = 0; i < I2C_PIN_PORTS && h->pins[i].port; i++){
+		gpio_apply(h->pins[i].port, h->pins[i].cfg);
+	}
+
+	/*5. SWRST and the set-up of i2c_init()*/
+	i2c_setup(h);
+	h->stats.recoveries++;
+}
+/**
+ * int i2c_transfer(i2c_handle_t *h, i2c_once_t once, char saddr, char maddr, int n, char* data)
+ * @brief run a blocking transfer, retried after a bus recovery while attempts are left
+ * @step followed:
+ *
+ * 1. One attempt with the deadline I2C_ATTEMPT_US(n) from now, after the
+ *    recovery a failed interrupt driven read left to thread context
+ * 2. On failure: count it, STOP, recover the bus (also after the last attempt,
+ *    so the bus is left usable)
+ * 3. Keep the longest transfer time
+ *
+ * @return I2C_OK, or the status of the last attempt after I2C_RETRIES retries.
+ */
+static int i2c_transfer(i2c_handle_t *h, i2c_once_t once, char saddr, char maddr, int n, char* data){
+	uint32_t t0 = dwt_cycles();
+	uint32_t took;
+	int rc = I2C_OK;
+
+	i2c_it_recover(h);
+	for(int a = 0; a <= I2C_RETRIES; a++){
+		/*1. One attempt*/
+		rc = once(h, saddr, maddr, n, data, dwt_cycles() + I2C_US(I2C_ATTEMPT_US(n)));
+		if(rc == I2C_OK){
+			break;
+		}
+
+		/*2. On failure: count it, STOP, recover the bus*/
+		i2c_count(h, rc);
+		i2c_abort(h);
+		i2c_recover(h);
+	}
+	if(rc != I2C_OK){
+		h->stats.failures++;
+	}
+
+	/*3. Keep the longest transfer time*/
+	took = dwt_cycles() - t0;
+	if(took > h->stats.worst){
+		h->stats.worst = took;
+	}
+	return rc;
+}
+/**
+ * int i2c_burst_read_once(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint32_t deadline)
+ * @brief one attempt of i2c_burst_read; every wait ends at the deadline or on an error flag
  * @step followed:
  *
  * 1. Wait until bus is not busy
@@ -91,253 +320,536 @@ void I2C1_init(void){
  * 4. Transmit the slave address + Write 0 at bit 0
  * 5. wait until address flag is set
  * 6. Clear status registers by reading them
- * 7. send memory address
- * 8. wait until transmitter gets empty
- * 9. Enable re-start bit
- * 10. wait until start flag is set
- * 11. transmit slave address + Read 1 at bit 0
- * 12. wait until address flag is set
- * 13. Disable Acknowledge
- * 14. Clear address flag
- * 15. generate stop condition
- * 16. wait until stop bit is set
- * 17 Read data from DR
+ * 7. wait until transmitter gets empty
+ * 8. send memory address
+ * 9. wait until transmitter gets empty
+ * 10. Enable re-start bit
+ * 11. wait until start flag is set
+ * 12. transmit slave address + Read 1 at bit 0
+ * 13. wait until address flag is set
+ * 14. Acknowledge bit: off for a single byte (before ADDR is cleared), on otherwise;
+ *     clear address flag
+ * 15. For every byte:
  *
+ *     1. if it is the last one, disable Acknowledge bit and enable stop bit
+ *     2. wait for RXNE flag to be set
+ *     3. read data from DR
+ *
+ * @return I2C_OK or the status of the phase that failed.
  */
+static int i2c_burst_read_once(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint32_t deadline){
+	I2C_TypeDef *i2c = h->regs;
+	volatile int temp;
+	int rc;
 
-void I2C1_byteRead(char saddr, char maddr, char* data){
-
-	volatile int temp; // This is going to be used to clear status registers by reading them.
-
-	/*1. Wait until bus is not busy (while it is busy, get stuck in the while loop.)*/
-	while(I2C1->SR2 & I2C_SR2_BUSY){}
+	/*1. Wait until bus is not busy*/
+	if((rc = i2c_wait_idle(h, deadline)) != I2C_OK){
+		return rc;
+	}
 
 	/*2. Enable Start bit*/
-	I2C1->CR1 |= I2C_CR1_START;
+	BB_SET(i2c->CR1, I2C_CR1_START_Pos);
 
 	/*3. Wait until start flag is set. */
-	while(!(I2C1->SR1 & I2C_SR1_SB)){}
+	if((rc = i2c_wait(h, I2C_SR1_SB, deadline)) != I2C_OK){
+		return rc;
+	}
 
 	/*4. Transmit the slave address + Write 0 at bit 0 */
-	I2C1->DR = saddr;
+	i2c->DR = saddr;
 
 	/*5. wait until address flag is set */
-	while(!(I2C1->SR1 & (I2C_SR1_ADDR))){}
+	if((rc = i2c_wait(h, I2C_SR1_ADDR, deadline)) != I2C_OK){
+		return rc;
+	}
 
 	/*6. Clear status registers by reading them*/
-	temp = I2C1->SR2;
-
-	/*7. send memory address */
-	I2C1->DR = maddr;
+	temp = i2c->SR1;
+	temp = i2c->SR2;
 
-	/*8. wait until transmitter gets empty*/
-	while(!(I2C1->SR1 & I2C_SR1_TXE)){}
-
-	/*9. Enable re-start bit */
-	I2C1->CR1 |= I2C_CR1_START;
+	/*7. wait until transmitter gets empty*/
+	if((rc = i2c_wait(h, I2C_SR1_TXE, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*10. wait until start flag is set */
-	while(!(I2C1->SR1 & I2C_SR1_SB)){}
+	/*8. send memory address */
+	i2c->DR = maddr;
 
-	/*11. transmit slave address + Read 1 at bit 0 */
-	I2C1->DR = saddr + 0x01;
+	/*9. wait until transmitter gets empty*/
+	if((rc = i2c_wait(h, I2C_SR1_TXE, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*12. wait until address flag is set */
-	while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+	/*10. Enable re-start bit */
+	BB_SET(i2c->CR1, I2C_CR1_START_Pos);
 
-	/*13. Disable Acknowledge */
-	I2C1->CR1 &= ~I2C_CR1_ACK;
+	/*11. wait until start flag is set */
+	if((rc = i2c_wait(h, I2C_SR1_SB, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*14. Clear address flag*/
-	temp = I2C1->SR2 | I2C1->SR1;
+	/*12. transmit slave address + Read 1 at bit 0 */
+	i2c->DR = saddr + 0x01;
 
-	/*15. generate stop condition */
-	I2C1->CR1 |= I2C_CR1_STOP;
+	/*13. wait until address flag is set */
+	if((rc = i2c_wait(h, I2C_SR1_ADDR, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*16. wait until stop bit is set*/
-	while(!(I2C1->SR1 & I2C_SR1_RXNE)){}
+	/*14. Acknowledge bit, clear address flag*/
+	if(n == 1){
+		BB_CLR(i2c->CR1, I2C_CR1_ACK_Pos);
+	}else{
+		BB_SET(i2c->CR1, I2C_CR1_ACK_Pos);
+	}
+	temp = i2c->SR1;
+	temp = i2c->SR2;
+
+	for(; n > 0; n--){
+		/*15.1 the last byte: NACK and STOP after it*/
+		if(n == 1){
+			BB_CLR(i2c->CR1, I2C_CR1_ACK_Pos);
+			BB_SET(i2c->CR1, I2C_CR1_STOP_Pos);
+		}
 
-	/*17 Read data from DR*/
-	*data++ = I2C1->DR;
+		/*15.2 wait for RXNE flag to be set*/
+		if((rc = i2c_wait(h, I2C_SR1_RXNE, deadline)) != I2C_OK){
+			return rc;
+		}
 
+		/*15.3 read data from DR*/
+		*data++ = i2c->DR;
+	}
+	(void)temp;
+	return I2C_OK;
+}
+/**
+ * int i2c_byte_read(i2c_handle_t *h, char saddr, char maddr, char* data)
+ * @brief read one register: i2c_burst_read of 1 byte
+ * @param h bus: &i2c1, &i2c2 or &i2c3
+ * @return I2C_OK or an i2c_status_t error, within I2C_WORST_US(1).
+ */
+int i2c_byte_read(i2c_handle_t *h, char saddr, char maddr, char* data){
+	return i2c_burst_read(h, saddr, maddr, 1, data);
 }
 /**
- * void I2C1_burstRead(char saddr, char maddr, int n, char* data)
- * @brief intializes burst read
+ * int i2c_burst_read(i2c_handle_t *h, char saddr, char maddr, int n, char* data)
+ * @brief intializes burst read, blocking, retried after a bus recovery on failure
+ * @param h bus: &i2c1, &i2c2 or &i2c3
  * @param saddr slave address
  * @param maddr memory address
- * @param n number of byte
+ * @param n number of byte (>= 1)
  * @param data pointer to store to data that you want to read.
+ * @return I2C_OK or an i2c_status_t error, within I2C_WORST_US(n); on an
+ *         error data may hold part of the bytes.
+ */
+int i2c_burst_read(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	if(n < 1){
+		return I2C_OK;
+	}
+	return i2c_transfer(h, i2c_burst_read_once, saddr, maddr, n, data);
+}
+/**
+ * int i2c_burst_write_once(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint32_t deadline)
+ * @brief one attempt of i2c_burst_write; every wait ends at the deadline or on an error flag
  * @step followed:
  *
- * 1. Enable Start bit
- * 2. Wait until start flag is set.
- * 3. Transmit the slave address + Write 0 at bit 0
- * 4. wait until address flag is set
- * 5. Clear status registers by reading them
- * 6. wait until transmitter gets empty
- * 7. send memory address
- * 8. wait until transmitter gets empty
- * 9. Enable re-start bit
- * 10. wait until start flag is set
- * 11. transmit slave address + Read 1 at bit 0
- * 12. wait until address flag is set
- * 13. Clear address flag
- * 14. Enable Acknowledge bit
- * 15. If one byte is left,
- *
- *     1. disable Acknowledge bit
- *     2. Enable stop bit
- *     3. wait for RXNE flag to be set
- *     4. read data from DR
- *     5. break when n = 1
- *
- * 16. if data is more than one byte, keep reading.
+ * 1. Wait until bus is not busy
+ * 2. Enable Start bit
+ * 3. Wait until start flag is set.
+ * 4. Transmit the slave address + Write 0 at bit 0
+ * 5. wait until address flag is set
+ * 6. Clear address flag
+ * 7. wait until transmitter gets empty
+ * 8. send memory address
+ * 9. Wait until BTF (byte transfer finished) is set
+ * 10. For every byte: wait until data register is empty, transmit it,
+ *     wait until BTF is set
+ * 11. generate stop condition
  *
- * 	   1. wait for RXNE flag to be set
- * 	   2. Read data from DR
- * 	   3. decrement until n = 1 such that codes in (n = 1U) runs and breaks out of the loop.
+ * @return I2C_OK or the status of the phase that failed.
  */
-void I2C1_burstRead(char saddr, char maddr, int n, char* data){
+static int i2c_burst_write_once(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint32_t deadline){
+	I2C_TypeDef *i2c = h->regs;
 	volatile int temp;
+	int rc;
 
-	/*1. Wait until bus is not busy (while it is busy, get stuck in the while loop.)*/
-	//while(I2C1->SR2 & I2C_SR2_BUSY){}
-
-	/*1. Enable Start bit*/
-	I2C1->CR1 |= I2C_CR1_START;
-
-	/*2. Wait until start flag is set. */
-	while(!(I2C1->SR1 & I2C_SR1_SB)){}
-
-	/*3. Transmit the slave address + Write 0 at bit 0 */
-	I2C1->DR = saddr;
-
-	/*4. wait until address flag is set */
-	while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
-
-	/*5. Clear status registers by reading them*/
-	temp = I2C1->SR2 | I2C1->SR1;
-
-	/*6. wait until transmitter gets empty*/
-	while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+	/*1. Wait until bus is not busy*/
+	if((rc = i2c_wait_idle(h, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*7. send memory address */
-	I2C1->DR = maddr;
+	/*2. Enable Start bit*/
+	BB_SET(i2c->CR1, I2C_CR1_START_Pos);
 
-	/*8. wait until transmitter gets empty*/
-	while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+	/*3. Wait until start flag is set. */
+	if((rc = i2c_wait(h, I2C_SR1_SB, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*9. Enable re-start bit */
-	I2C1->CR1 |= I2C_CR1_START;
+	/*4. Transmit the slave address + Write 0 at bit 0 */
+	i2c->DR = saddr;
 
-	/*10. wait until start flag is set */
-	while(!(I2C1->SR1 & I2C_SR1_SB)){}
+	/*5. wait until address flag is set */
+	if((rc = i2c_wait(h, I2C_SR1_ADDR, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*11. transmit slave address + Read 1 at bit 0 */
-	I2C1->DR = saddr + 0x01;
+	/*6. Clear address flag*/
+	temp = i2c->SR1;
+	temp = i2c->SR2;
 
-	/*12. wait until address flag is set */
-	while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+	/*7. wait until transmitter gets empty*/
+	if((rc = i2c_wait(h, I2C_SR1_TXE, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	/*13. Clear address flag*/
-	temp = I2C1->SR2 | I2C1->SR1;
+	/*8. send memory address */
+	i2c->DR = maddr;
 
-	/*14. Enable Acknowledge bit*/
-	I2C1->CR1 |= I2C_CR1_ACK;
+	/*9. Wait until BTF (byte transfer finished) is set */
+	if((rc = i2c_wait(h, I2C_SR1_BTF, deadline)) != I2C_OK){
+		return rc;
+	}
 
-	while(n > 0U){
+	for(int i = 0; i < n; i++){
 
-		/*15. check if one byte is left*/
-		if(n == 1U){
+		/*10. wait until data register is empty, transmit the byte, wait until BTF is set*/
+		if((rc = i2c_wait(h, I2C_SR1_TXE, deadline)) != I2C_OK){
+			return rc;
+		}
+		i2c->DR = *data++;
+		if((rc = i2c_wait(h, I2C_SR1_BTF, deadline)) != I2C_OK){
+			return rc;
+		}
+	}
 
-			/*1. disable Acknowledge bit*/
-			I2C1->CR1 &= ~I2C_CR1_ACK;
+	/*11. generate stop condition*/
+	BB_SET(i2c->CR1, I2C_CR1_STOP_Pos);
+	(void)temp;
+	return I2C_OK;
+}
+/**
+ * int i2c_burst_write(i2c_handle_t *h, char saddr, char maddr, int n, char* data)
+ * @brief intializes I2C burst write, blocking, retried after a bus recovery on failure
+ * @param h bus: &i2c1, &i2c2 or &i2c3
+ * @param saddr slave address
+ * @param maddr memory address
+ * @param n number of byte
+ * @param data pointer to hold the data you want to write to the slave.
+ * @return I2C_OK or an i2c_status_t error, within I2C_WORST_US(n).
+ */
+int i2c_burst_write(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	return i2c_transfer(h, i2c_burst_write_once, saddr, maddr, n, data);
+}
+/**
+ * void i2c_it_start(i2c_handle_t *h)
+ * @brief START of the interrupt driven read in h->xfer: wait for the STOP of
+ *        the last one to go out (CR1 must not be written while STOP is
+ *        pending, RM0383 18.6.1; one bit time, a byte time at most, then the
+ *        deadline of the read takes over), set the deadline, START
+ */
+RAM_FUNC static void i2c_it_start(i2c_handle_t *h){
+	uint32_t t0 = dwt_cycles();
 
-			/*2. Enable stop bit*/
-			I2C1->CR1 |= I2C_CR1_STOP;
+	h->xfer.deadline = t0 + I2C_US(I2C_ATTEMPT_US(h->xfer.n));
+	while((h->regs->CR1 & I2C_CR1_STOP) && dwt_cycles() - t0 < I2C_US(I2C_BYTE_US)){}
+	BB_SET(h->regs->CR1, I2C_CR1_START_Pos);
+}
+/**
+ * void i2c_it_next(i2c_handle_t *h)
+ * @brief the read in flight is over: start the next queued one, or turn the
+ *        interrupts of the bus off if none is left
+ */
+RAM_FUNC static void i2c_it_next(i2c_handle_t *h){
+	I2C_TypeDef *i2c = h->regs;
 
-			/*3. wait for RXNE flag to be set*/
-			while(!(I2C1->SR1 & I2C_SR1_RXNE)){}
+	if(h->q_count == 0){
+		BB_CLR(i2c->CR2, I2C_CR2_ITEVTEN_Pos);
+		BB_CLR(i2c->CR2, I2C_CR2_ITERREN_Pos);
+		return;
+	}
+	h->xfer = h->queue[h->q_head];
+	h->q_head = (h->q_head + 1U) % I2C_IT_QUEUE_LEN;
+	h->q_count--;
+	BB_SET(i2c->CR2, I2C_CR2_ITEVTEN_Pos);
+	BB_SET(i2c->CR2, I2C_CR2_ITERREN_Pos);
+	i2c_it_start(h);
+}
+/**
+ * void i2c_it_fail(i2c_handle_t *h, int rc)
+ * @brief end the interrupt driven read in flight with an error (interrupts
+ *        masked); no bit-banged recovery here
+ * @step followed:
+ *
+ * 1. Interrupts of the bus off, count the error
+ * 2. STOP, error flags cleared. A NACK or a lost arbitration leaves the bus
+ *    free. A timeout, a bus error or an overrun may leave a slave holding
+ *    SDA: the recovery (I2C_RECOVER_US) is left to thread context,
+ *    i2c_it_recover()
+ * 3. Post the completion with arg 0
+ * 4. Start the next queued read, unless it waits for the recovery
+ */
+static void i2c_it_fail(i2c_handle_t *h, int rc){
+	i2c_it_xfer_t *x = &h->xfer;
 
-			/*4. read data from DR*/
-			*data++ = I2C1->DR;
+	/*1. Interrupts of the bus off, count the error*/
+	h->regs->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_ITBUFEN);
+	i2c_count(h, rc);
 
-			/*5. break when n = 1*/
-			break;
+	/*2. STOP, the recovery for later if the bus may be held*/
+	i2c_abort(h);
+	if(rc != I2C_ERR_NACK && rc != I2C_ERR_ARLO){
+		h->recover = 1;
+	}
 
-		/*16. if data is more than one byte, keep reading. */
-		}else{
-			/*1. wait for RXNE flag to be set*/
-			while(!(I2C1->SR1 & I2C_SR1_RXNE)){}
+	/*3. Post the completion with arg 0*/
+	x->state = I2C_IT_IDLE;
+	sched_post(x->task, x->sig, 0);
 
-			/*2. Read data from DR*/
-			(*data++) = I2C1->DR;
+	/*4. Start the next queued read*/
+	if(!h->recover){
+		i2c_it_next(h);
+	}
+}
+/**
+ * void i2c_it_recover(i2c_handle_t *h)
+ * @brief thread context: the bus recovery a failed interrupt driven read
+ *        left (i2c_it_fail), with interrupts enabled; then the queued reads
+ *        that waited for it
+ */
+static void i2c_it_recover(i2c_handle_t *h){
+	uint32_t primask;
 
-			/*3. decrement until n = 1 such that codes in (n = 1U) runs and breaks out of the loop.  */
-			n--;
-		}
+	if(!h->recover){
+		return;
 	}
+	i2c_recover(h);
+	primask = critical_enter();
+	h->recover = 0;
+	if(h->xfer.state == I2C_IT_IDLE){
+		i2c_it_next(h);
+	}
+	critical_exit(primask);
 }
 /**
- * void I2C1_burstWrite(char saddr, char maddr, int n, char* data)
- * @brief intializes I2C burst write
+ * int i2c_burst_read_it(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint8_t task, uint8_t sig)
+ * @brief start an interrupt driven burst read. Returns immediately; when the
+ *        last byte is stored, sig is posted to task with arg = n. While the
+ *        bus is busy the read is queued and started by the event handler
+ *        after the current one; completions come in the order of the calls.
+ * @param h bus: &i2c1, &i2c2 or &i2c3
  * @param saddr slave address
  * @param maddr memory address
- * @param n number of byte
- * @param data pointer to hold the data you want to write to the slave.
+ * @param n number of byte (>= 1)
+ * @param data buffer, must stay valid until the completion event
+ * @param task scheduler task to notify
+ * @param sig signal posted to the task
  * @step followed:
  *
- * 1. Enable Start bit
- * 2. Wait until start flag is set.
- * 3. Transmit the slave address + Write 0 at bit 0
- * 4. wait until address flag is set
- * 5. Clear address flag
- * 6. wait until transmitter gets empty
- * 7. send memory address
- * 8. wait until data register is empty
- * 9. Transmit memory address
- * 10. Wait until BTF (byte transfer finished) is set
+ * 1. Run a recovery left by a failed read (i2c_it_recover); refuse if the queue is full
+ * 2. Save the transfer, in the queue if one is running
+ * 3. Enable event and error interrupts
+ * 4. Enable Start bit once the STOP of the last read is out, with the deadline
+ *    of the read (i2c_it_start); the rest runs in i2c_ev_handler
+ *
+ * The event handler also takes from the queue, so steps 1. and 2. run with
+ * interrupts masked (a few dozen cycles).
+ *
+ * @return 0 if the transfer was started or queued, -1 if the queue is full.
  */
-void I2C1_burstWrite(char saddr, char maddr, int n, char* data){
-	volatile int temp;
-	static int count = 0;
-
-	/*1. Enable Start bit*/
-	I2C1->CR1 |= I2C_CR1_START;
-
-	/*2. Wait until start flag is set. */
-	while(!(I2C1->SR1 & I2C_SR1_SB)){}
-
-	/*3. Transmit the slave address + Write 0 at bit 0 */
-	I2C1->DR = saddr;
-
-	/*4. wait until address flag is set */
-	while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+int i2c_burst_read_it(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint8_t task, uint8_t sig){
+	i2c_it_xfer_t *x = &h->xfer;
+	uint32_t primask;
+	int queued;
+
+	/*1. Run a recovery left by a failed read; refuse if the queue is full*/
+	if(n < 1){
+		return -1;
+	}
+	i2c_it_recover(h);
+	primask = critical_enter();
+	queued = (x->state != I2C_IT_IDLE);
+	if(queued){
+		if(h->q_count == I2C_IT_QUEUE_LEN){
+			critical_exit(primask);
+			return -1;
+		}
+		x = &h->queue[(h->q_head + h->q_count) % I2C_IT_QUEUE_LEN];
+	}
 
-	/*5. Clear address flag*/
-	temp = I2C1->SR2 | I2C1->SR1;
+	/*2. Save the transfer, in the queue if one is running*/
+	x->saddr = saddr;
+	x->maddr = maddr;
+	x->n = n;
+	x->remaining = n;
+	x->data = data;
+	x->task = task;
+	x->sig = sig;
+	x->state = I2C_IT_START;
+	if(queued){
+		h->q_count++;
+		critical_exit(primask);
+		return 0;
+	}
+	critical_exit(primask);
 
-	/*6. wait until transmitter gets empty*/
-	while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+	/*3. Enable event and error interrupts*/
+	BB_SET(h->regs->CR2, I2C_CR2_ITEVTEN_Pos);
+	BB_SET(h->regs->CR2, I2C_CR2_ITERREN_Pos);
 
-	/*7. send memory address */
-	I2C1->DR = maddr;
+	/*4. Enable Start bit once the STOP of the last read is out*/
+	i2c_it_start(h);
 
-	/*8. Wait until BTF (byte transfer finished) is set */
-	while(!(I2C1->SR1 & I2C_SR1_BTF)){}
+	return 0;
+}
+/**
+ * int i2c_busy(const i2c_handle_t *h)
+ * @brief 1 while an interrupt driven transfer is running or queued on the bus
+ */
+int i2c_busy(const i2c_handle_t *h){
+	return h->xfer.state != I2C_IT_IDLE || h->q_count != 0;
+}
+/**
+ * int i2c_it_poll(i2c_handle_t *h)
+ * @brief end the interrupt driven read in flight if it is past its deadline
+ *        (a slave stretching SCL or holding SDA raises no interrupt), then
+ *        run the bus recovery a failed read left, with interrupts enabled.
+ *        Call it from thread mode when a read is overdue, e.g. on the next tick.
+ * @return 1 if a read was ended (its completion posted with arg 0), 0 if not.
+ */
+int i2c_it_poll(i2c_handle_t *h){
+	uint32_t primask = critical_enter();
+	int late = h->xfer.state != I2C_IT_IDLE && (int32_t)(dwt_cycles() - h->xfer.deadline) > 0;
 
-	for(int i = 0; i < n; i++){
+	if(late){
+		i2c_it_fail(h, I2C_ERR_TIMEOUT);
+	}
+	critical_exit(primask);
+	i2c_it_recover(h);
+	return late;
+}
+/**
+ * void i2c_er_handler(i2c_handle_t *h)
+ * @brief error interrupt of one instance, called from the I2Cx_ER_IRQHandler
+ *        of that instance: the read in flight ends with arg 0 in its
+ *        completion and the next queued read starts (after a bus error or
+ *        an overrun, once thread context has recovered the bus)
+ */
+void i2c_er_handler(i2c_handle_t *h){
+	uint32_t sr1 = h->regs->SR1;
 
-		/*9. wait until data register is empty*/
-		while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+	if(!(sr1 & I2C_SR1_ERRORS)){
+		return;
+	}
+	if(h->xfer.state == I2C_IT_IDLE){
+		h->regs->SR1 &= ~I2C_SR1_ERRORS;
+		BB_CLR(h->regs->CR2, I2C_CR2_ITERREN_Pos);
+		return;
+	}
+	i2c_it_fail(h, i2c_status(sr1));
+}
+/**
+ * void i2c_ev_handler(i2c_handle_t *h)
+ * @brief event interrupt state machine of one instance, called from the
+ *        I2Cx_EV_IRQHandler of that instance. Each handle keeps its own
+ *        transfer, so the three buses run their reads at the same time.
+ *        Follows the same sequence as i2c_burst_read, one step per event.
+ *        Runs from SRAM (RAM_FUNC): no flash wait states, no jitter from
+ *        ART misses.
+ * @step followed:
+ *
+ * 1. SB: transmit the slave address + Write 0 at bit 0
+ * 2. ADDR: clear address flag and send memory address
+ * 3. BTF: enable re-start bit
+ * 4. SB: transmit slave address + Read 1 at bit 0
+ * 5. ADDR: set ACK (or NACK + STOP for one byte), clear address flag, enable RXNE interrupt
+ * 6. RXNE: read data from DR. NACK + STOP when one byte is left,
+ *    post the completion event when none is left.
+ * 7. Start the next queued read (i2c_it_next), as in i2c_burst_read_it.
+ */
+RAM_FUNC void i2c_ev_handler(i2c_handle_t *h){
+	I2C_TypeDef *i2c = h->regs;
+	i2c_it_xfer_t *x = &h->xfer;
+	volatile int temp = 0;
+	uint32_t sr1 = i2c->SR1;
+
+	switch(x->state){
+
+	/*1. SB: transmit the slave address + Write 0 at bit 0*/
+	case I2C_IT_START:
+		if(sr1 & I2C_SR1_SB){
+			i2c->DR = x->saddr;
+			x->state = I2C_IT_ADDR_W;
+		}
+		break;
+
+	/*2. ADDR: clear address flag and send memory address*/
+	case I2C_IT_ADDR_W:
+		if(sr1 & I2C_SR1_ADDR){
+			temp = i2c->SR2;
+			i2c->DR = x->maddr;
+			x->state = I2C_IT_MADDR;
+		}
+		break;
 
-		/*10. Transmit memory address */
-		I2C1->DR = *data++;
+	/*3. BTF: enable re-start bit*/
+	case I2C_IT_MADDR:
+		if(sr1 & I2C_SR1_BTF){
+			BB_SET(i2c->CR1, I2C_CR1_START_Pos);
+			x->state = I2C_IT_RESTART;
+		}
+		break;
 
-		/*11. Wait until BTF (byte transfer finished) is set */
-		while(!(I2C1->SR1 & I2C_SR1_BTF)){}
+	/*4. SB: transmit slave address + Read 1 at bit 0*/
+	case I2C_IT_RESTART:
+		if(sr1 & I2C_SR1_SB){
+			i2c->DR = x->saddr + 0x01;
+			x->state = I2C_IT_ADDR_R;
+		}
+		break;
+
+	/*5. ADDR: set ACK (or NACK + STOP for one byte), clear address flag, enable RXNE interrupt*/
+	case I2C_IT_ADDR_R:
+		if(sr1 & I2C_SR1_ADDR){
+			if(x->n == 1){
+				BB_CLR(i2c->CR1, I2C_CR1_ACK_Pos);
+				temp = i2c->SR2;
+				BB_SET(i2c->CR1, I2C_CR1_STOP_Pos);
+			}else{
+				BB_SET(i2c->CR1, I2C_CR1_ACK_Pos);
+				temp = i2c->SR2;
+			}
+			BB_SET(i2c->CR2, I2C_CR2_ITBUFEN_Pos);
+			x->state = I2C_IT_RX;
+		}
+		break;
+
+	/*6. RXNE: read data from DR*/
+	case I2C_IT_RX:
+		if(sr1 & I2C_SR1_RXNE){
+			*x->data++ = i2c->DR;
+			x->remaining--;
+
+			if(x->remaining == 1){
+				BB_CLR(i2c->CR1, I2C_CR1_ACK_Pos);
+				BB_SET(i2c->CR1, I2C_CR1_STOP_Pos);
+			}else if(x->remaining == 0){
+				BB_CLR(i2c->CR2, I2C_CR2_ITBUFEN_Pos);
+				x->state = I2C_IT_IDLE;
+				sched_post(x->task, x->sig, (uint16_t)x->n);
+
+				/*7. Start the next queued read*/
+				i2c_it_next(h);
+			}
+		}
+		break;
 
+	default:
+		/* spurious event, nothing in flight */
+		BB_CLR(i2c->CR2, I2C_CR2_ITEVTEN_Pos);
+		BB_CLR(i2c->CR2, I2C_CR2_ITBUFEN_Pos);
+		break;
 	}
-	//count++;
+	(void)temp;
 }
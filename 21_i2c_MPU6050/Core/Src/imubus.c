@@ -0,0 +1,213 @@
+/**
+ * imubus.c
+ *	@brief interleaved burst reads of several MPU6050 on one I2C bus
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include "stm32f4xx.h"
+#include "imubus.h"
+#include "telemetry.h"
+
+_Static_assert(TELEM_BUS_REPORT_LEN(IMUBUS_MAX_DEVICES) <= TELEM_MAX_PAYLOAD, "bus report must fit one frame");
+
+/**
+ * void imubus_init(imubus_t *b, uint8_t task, uint8_t sig)
+ * @brief empty bus; the completion of every read posts sig to task
+ */
+void imubus_init(imubus_t *b, uint8_t task, uint8_t sig){
+	b->n = 0;
+	b->task = task;
+	b->sig = sig;
+	b->pending = 0;
+	b->done = 0;
+	b->lost = 0;
+	imubus_stats_reset(b);
+}
+/**
+ * int imubus_add(imubus_t *b, mpu6050_t *dev)
+ * @brief add an initialized device; all devices must be on the same bus
+ * @return its index in the round, -1 if the bus is full or the device
+ *         did not answer MPU6050_init().
+ */
+int imubus_add(imubus_t *b, mpu6050_t *dev){
+	if(b->n == IMUBUS_MAX_DEVICES || !dev->present || (b->n && dev->bus != b->dev[0]->bus)){
+		return -1;
+	}
+	b->dev[b->n] = dev;
+	return b->n++;
+}
+/**
+ * int imubus_tick(imubus_t *b)
+ * @brief start one round: queue the burst read of every device
+ * @step followed:
+ *
+ * 1. Skip the tick if the last round is still on the bus; a read past its
+ *    deadline is ended there (i2c_it_poll), its completion follows
+ * 2. Stamp the round
+ * 3. Queue the reads back to back, in device order; a device that could
+ *    not be read makes the round partial
+ *
+ * @return 0 if the round was started, -1 on an overrun or if no read could be started.
+ */
+int imubus_tick(imubus_t *b){
+
+	/*1. Skip the tick if the last round is still on the bus*/
+	if(b->pending){
+		b->stats.overruns++;
+		i2c_it_poll(b->dev[0]->bus);
+		return -1;
+	}
+
+	/*2. Stamp the round*/
+	b->stamp = DWT->CYCCNT;
+	b->done = 0;
+	b->lost = 0;
+
+	/*3. Queue the reads back to back, in device order*/
+	for(uint8_t i = 0; i < b->n; i++){
+		if(MPU6050_read_all_IT(b->dev[i], b->task, b->sig) != 0){
+			b->stats.errors++;
+			b->lost++;
+			continue;
+		}
+		b->started[b->pending++] = i;
+	}
+	return b->pending ? 0 : -1;
+}
+/**
+ * int imubus_done(imubus_t *b, uint16_t arg)
+ * @brief one read of the round completed (its event was received, arg of the event)
+ * @step followed:
+ *
+ * 1. Note whose read it was; arg 0: the read failed on the bus, the round is partial
+ * 2. Record its offset from the tick
+ * 3. Close the round after the last read: publish the sample of every device,
+ *    or of none if the round is partial, so that the rings stay in step
+ *
+ * @return 1 when the round is complete, 0 while reads are left, -1 if no round is running.
+ */
+int imubus_done(imubus_t *b, uint16_t arg){
+	uint32_t offset;
+	uint8_t k;
+
+	if(!b->pending){
+		return -1;
+	}
+
+	/*1. Note whose read it was; arg 0: the read failed on the bus*/
+	k = b->done++;
+	if(arg == 0){
+		b->stats.errors++;
+		b->lost++;
+	}
+
+	/*2. Record its offset from the tick*/
+	offset = DWT->CYCCNT - b->stamp;
+	if(offset > b->stats.offset_max[k]){
+		b->stats.offset_max[k] = offset;
+	}
+
+	/*3. Close the round after the last read*/
+	if(--b->pending){
+		return 0;
+	}
+	b->stats.rounds++;
+	b->stats.busy += offset;
+	if(b->lost){
+		b->stats.partial++;
+	}
+	for(k = 0; k < b->done; k++){
+		mpu6050_t *dev = b->dev[b->started[k]];
+		uint32_t len = MPU6050_BURST_LEN + dev->aux_len;
+
+		if(b->lost){
+			MPU6050_read_abort(dev);
+		}else{
+			MPU6050_read_done(dev);
+		}
+		b->stats.wire += IMUBUS_READ_BITS(len) * (SystemCoreClock / IMUBUS_BIT_RATE);
+	}
+	if(offset > b->stats.round_max){
+		b->stats.round_max = offset;
+	}
+	return 1;
+}
+/**
+ * void imubus_stats_reset(imubus_t *b)
+ * @brief start a new statistics window
+ */
+void imubus_stats_reset(imubus_t *b){
+	imubus_stats_t *s = &b->stats;
+
+	s->rounds = 0;
+	s->overruns = 0;
+	s->errors = 0;
+	s->partial = 0;
+	s->busy = 0;
+	s->wire = 0;
+	s->round_max = 0;
+	for(uint8_t i = 0; i < IMUBUS_MAX_DEVICES; i++){
+		s->offset_max[i] = 0;
+	}
+	s->since = DWT->CYCCNT;
+}
+/**
+ * uint32_t imubus_load_permille(const imubus_t *b)
+ * @brief bus busy time over the time since the last reset, 0..1000
+ */
+uint32_t imubus_load_permille(const imubus_t *b){
+	uint32_t elapsed = DWT->CYCCNT - b->stats.since;
+
+	return elapsed ? (uint32_t)((uint64_t)b->stats.busy * 1000U / elapsed) : 0;
+}
+/**
+ * uint32_t imubus_efficiency_permille(const imubus_t *b)
+ * @brief wire time of the reads over bus busy time, 0..1000
+ */
+uint32_t imubus_efficiency_permille(const imubus_t *b){
+	return b->stats.busy ? (uint32_t)((uint64_t)b->stats.wire * 1000U / b->stats.busy) : 0;
+}
+/**
+ * int imubus_report(imubus_t *b)
+ * @brief send the statistics as a TELEM_TYPE_BUS frame and reset them
+ * @step followed:
+ *
+ * 1. Collect the words of the report
+ * 2. Pack them little endian
+ * 3. Queue the frame and start a new window
+ *
+ * @return 0 if queued, -1 if the frame was dropped
+ */
+int imubus_report(imubus_t *b){
+	uint32_t w[TELEM_BUS_REPORT_HEAD + IMUBUS_MAX_DEVICES];
+	uint8_t payload[TELEM_BUS_REPORT_LEN(IMUBUS_MAX_DEVICES)];
+	uint32_t words = TELEM_BUS_REPORT_HEAD + b->n;
+	int rc;
+
+	/*1. Collect the words of the report*/
+	w[0] = SystemCoreClock;
+	w[1] = b->stats.rounds;
+	w[2] = b->stats.overruns;
+	w[3] = b->stats.errors;
+	w[4] = imubus_load_permille(b);
+	w[5] = imubus_efficiency_permille(b);
+	w[6] = b->stats.round_max;
+	w[7] = b->n;
+	for(uint8_t i = 0; i < b->n; i++){
+		w[TELEM_BUS_REPORT_HEAD + i] = b->stats.offset_max[i];
+	}
+
+	/*2. Pack them little endian*/
+	for(uint32_t i = 0; i < words; i++){
+		payload[4 * i] = (uint8_t)w[i];
+		payload[4 * i + 1] = (uint8_t)(w[i] >> 8);
+		payload[4 * i + 2] = (uint8_t)(w[i] >> 16);
+		payload[4 * i + 3] = (uint8_t)(w[i] >> 24);
+	}
+
+	/*3. Queue the frame and start a new window*/
+	rc = telem_send_bytes(TELEM_TYPE_BUS, DWT->CYCCNT, payload, 4 * words);
+	imubus_stats_reset(b);
+	return rc;
+}
@@ -0,0 +1,496 @@
+/**
+ * kernel.c
+ *	@brief source file for the preemptive priority kernel
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Hardware independent part of the kernel: ready queue, delay list,
+ * semaphores and queues. The running task is always the head of its
+ * priority's ready list; a context switch is requested (PendSV) whenever
+ * the head of the highest ready priority is not the running task.
+ * Everything here only needs critical_enter/exit (PRIMASK) and the port
+ * functions, so the data structures can be exercised on a host build.
+ */
+
+#include "kernel.h"
+#include "atomic.h"
+#include "stack.h"
+#include <string.h>
+
+volatile os_stats_t os_stats;
+os_tcb_t * volatile os_current;
+os_tcb_t * volatile os_next;
+
+static volatile uint32_t ready_bitmap;			// bit n set: priority n has a ready task
+static os_tcb_t *ready_head[OS_MAX_PRIO];
+static os_tcb_t *ready_tail[OS_MAX_PRIO];
+static os_tcb_t *delay_head;					// sorted by wake_tick
+static volatile uint32_t os_ticks;
+static uint8_t os_running;
+
+static os_tcb_t idle_tcb;
+static uint32_t idle_stack[OS_IDLE_STACK_WORDS] __attribute__((aligned(8)));
+
+/**
+ * int os_tick_before(uint32_t a, uint32_t b)
+ * @brief wrap-around safe a < b on the tick counter
+ */
+static inline int os_tick_before(uint32_t a, uint32_t b){
+	return (int32_t)(a - b) < 0;
+}
+
+/**
+ * void ready_insert(os_tcb_t *t)
+ * @brief append a task to the tail of its priority's ready list
+ */
+static void ready_insert(os_tcb_t *t){
+	t->next = 0;
+	t->state = OS_TASK_READY;
+	if(ready_head[t->prio] == 0){
+		ready_head[t->prio] = t;
+	}else{
+		ready_tail[t->prio]->next = t;
+	}
+	ready_tail[t->prio] = t;
+	ready_bitmap |= (1U << t->prio);
+}
+
+/**
+ * void ready_remove(os_tcb_t *t)
+ * @brief unlink a task from its ready list
+ */
+static void ready_remove(os_tcb_t *t){
+	os_tcb_t **pp = &ready_head[t->prio];
+	os_tcb_t *prev = 0;
+
+	while(*pp && *pp != t){
+		prev = *pp;
+		pp = &(*pp)->next;
+	}
+	if(*pp == 0){
+		return;
+	}
+	*pp = t->next;
+	if(ready_tail[t->prio] == t){
+		ready_tail[t->prio] = prev;
+	}
+	if(ready_head[t->prio] == 0){
+		ready_bitmap &= ~(1U << t->prio);
+	}
+	t->next = 0;
+}
+
+/**
+ * void ready_rotate(uint8_t prio)
+ * @brief move the head of a ready list to its tail (round robin)
+ */
+static void ready_rotate(uint8_t prio){
+	os_tcb_t *t = ready_head[prio];
+
+	if(t == 0 || t->next == 0){
+		return;
+	}
+	ready_head[prio] = t->next;
+	t->next = 0;
+	ready_tail[prio]->next = t;
+	ready_tail[prio] = t;
+}
+
+/**
+ * void delay_insert(os_tcb_t *t)
+ * @brief insert a task in the delay list, ordered by wake_tick
+ */
+static void delay_insert(os_tcb_t *t){
+	os_tcb_t **pp = &delay_head;
+
+	while(*pp && !os_tick_before(t->wake_tick, (*pp)->wake_tick)){
+		pp = &(*pp)->dnext;
+	}
+	t->dnext = *pp;
+	*pp = t;
+	t->delayed = 1;
+}
+
+/**
+ * void list_remove(os_tcb_t **head, os_tcb_t *t, int delay)
+ * @brief unlink a task from a wait list (next link) or the delay list (dnext link)
+ */
+static void list_remove(os_tcb_t **pp, os_tcb_t *t, int delay){
+	while(*pp && *pp != t){
+		pp = delay ? &(*pp)->dnext : &(*pp)->next;
+	}
+	if(*pp){
+		*pp = delay ? t->dnext : t->next;
+	}
+}
+
+/**
+ * void wait_insert(os_tcb_t **list, os_tcb_t *t)
+ * @brief queue a task on a wait list, highest priority first, FIFO within a priority
+ */
+static void wait_insert(os_tcb_t **pp, os_tcb_t *t){
+	os_tcb_t **list = pp;
+
+	while(*pp && (*pp)->prio <= t->prio){
+		pp = &(*pp)->next;
+	}
+	t->next = *pp;
+	*pp = t;
+	t->wait_list = list;
+}
+
+/**
+ * void os_wake(os_tcb_t *t, int32_t result)
+ * @brief take a blocked task off its wait and delay lists and make it ready
+ */
+static void os_wake(os_tcb_t *t, int32_t result){
+	if(t->wait_list){
+		list_remove(t->wait_list, t, 0);
+		t->wait_list = 0;
+	}
+	if(t->delayed){
+		list_remove(&delay_head, t, 1);
+		t->delayed = 0;
+	}
+	t->wait_result = result;
+	ready_insert(t);
+}
+
+/**
+ * void os_schedule(void)
+ * @brief request a context switch if the running task is no longer the
+ *        head of the highest ready priority. O(1): one count-trailing-zeros.
+ */
+static void os_schedule(void){
+	os_tcb_t *top;
+
+	if(!os_running){
+		return;
+	}
+	top = ready_head[__builtin_ctz(ready_bitmap)];
+	if(top != os_current){
+		os_next = top;
+		os_port_request_switch();
+	}
+}
+
+/**
+ * int os_block(os_tcb_t **wait_list, uint32_t timeout, uint32_t primask)
+ * @brief block the running task on a wait list and/or for timeout ticks.
+ *        Called inside a critical section which it closes; the switch
+ *        happens as soon as interrupts are unmasked.
+ * @return OS_OK when woken by a give, OS_ERR_TIMEOUT when the delay expired
+ */
+static int os_block(os_tcb_t **wait_list, uint32_t timeout, uint32_t primask){
+	os_tcb_t *self = os_current;
+
+	ready_remove(self);
+	self->state = OS_TASK_BLOCKED;
+	self->wait_result = OS_ERR_TIMEOUT;
+	if(wait_list){
+		wait_insert(wait_list, self);
+	}
+	if(timeout != OS_WAIT_FOREVER){
+		self->wake_tick = os_ticks + timeout;
+		delay_insert(self);
+	}
+	os_schedule();
+	critical_exit(primask);
+
+	return self->wait_result;
+}
+
+/**
+ * void os_task_exit(void)
+ * @brief a task returned from its entry function: retire it
+ */
+void os_task_exit(void){
+	uint32_t pm = critical_enter();
+
+	ready_remove(os_current);
+	os_current->state = OS_TASK_DORMANT;
+	os_schedule();
+	critical_exit(pm);
+	while(1){}
+}
+
+/**
+ * void os_idle_task(void *arg)
+ * @brief lowest priority task: sleep, with SysTick stretched over the idle period
+ */
+static void os_idle_task(void *arg){
+	uint32_t pm;
+
+	(void)arg;
+	while(1){
+		pm = critical_enter();
+		if(!os_ready_above_idle()){
+			os_port_tickless_idle(os_idle_ticks());
+		}
+		critical_exit(pm);
+	}
+}
+
+/**
+ * void os_init(void)
+ * @brief reset the kernel state and create the idle task
+ */
+void os_init(void){
+	memset(ready_head, 0, sizeof(ready_head));
+	memset(ready_tail, 0, sizeof(ready_tail));
+	ready_bitmap = 0;
+	delay_head = 0;
+	os_ticks = 0;
+	os_running = 0;
+	os_current = 0;
+	os_next = 0;
+
+	os_task_create(&idle_tcb, "idle", os_idle_task, 0, idle_stack, OS_IDLE_STACK_WORDS, OS_IDLE_PRIO);
+}
+
+/**
+ * int os_task_create(os_tcb_t *tcb, const char *name, void (*entry)(void *), void *arg,
+ *		uint32_t *stack, uint32_t stack_words, uint8_t prio)
+ * @brief create a task, ready to run
+ * @param tcb task control block, owned by the caller
+ * @param name for the debugger
+ * @param entry task function; returning from it retires the task
+ * @param arg passed to entry
+ * @param stack stack memory, 8 byte aligned
+ * @param stack_words stack size in 32 bit words
+ * @param prio 0 (highest) .. OS_IDLE_PRIO - 1 for application tasks
+ * @return OS_OK or OS_ERR_PARAM
+ */
+int os_task_create(os_tcb_t *tcb, const char *name, void (*entry)(void *), void *arg,
+		uint32_t *stack, uint32_t stack_words, uint8_t prio){
+	uint32_t pm;
+
+	if(tcb == 0 || entry == 0 || stack == 0 || stack_words < 32 || prio >= OS_MAX_PRIO){
+		return OS_ERR_PARAM;
+	}
+	memset(tcb, 0, sizeof(*tcb));
+	tcb->name = name;
+	tcb->prio = prio;
+	tcb->stack_base = stack;
+	tcb->stack_words = stack_words;
+	stack_paint(stack, stack_words);		// for stack_used() and the SysTick guard check
+	os_port_init_stack(tcb, entry, arg);
+
+	pm = critical_enter();
+	ready_insert(tcb);
+	os_schedule();
+	critical_exit(pm);
+
+	return OS_OK;
+}
+
+/**
+ * void os_start(void)
+ * @brief start the highest priority task. Never returns.
+ */
+void os_start(void){
+	os_current = ready_head[__builtin_ctz(ready_bitmap)];
+	os_next = os_current;
+	os_running = 1;
+	os_port_start();
+}
+
+/**
+ * void os_tick(void)
+ * @brief tick interrupt hook, called from SysTick_Handler
+ */
+void os_tick(void){
+	if(!os_running){
+		return;
+	}
+	os_tick_advance(os_port_tick_step());
+}
+
+/**
+ * void os_tick_advance(uint32_t ticks)
+ * @brief advance time by one or more ticks (more after tickless idle)
+ * @step followed:
+ *
+ * 1. Advance the tick counter
+ * 2. Wake every task whose delay or timeout expired
+ * 3. Round robin the running task's priority
+ * 4. Switch if a higher priority task is ready
+ */
+void os_tick_advance(uint32_t ticks){
+	uint32_t pm = critical_enter();
+	os_tcb_t *t;
+
+	/*1. Advance the tick counter*/
+	os_ticks += ticks;
+
+	/*2. Wake every task whose delay or timeout expired*/
+	while((t = delay_head) != 0 && !os_tick_before(os_ticks, t->wake_tick)){
+		os_wake(t, t->wait_list ? OS_ERR_TIMEOUT : OS_OK);
+	}
+
+	/*3. Round robin the running task's priority*/
+	if(os_current && os_current->state == OS_TASK_READY){
+		ready_rotate(os_current->prio);
+	}
+
+	/*4. Switch if a higher priority task is ready*/
+	os_schedule();
+	critical_exit(pm);
+}
+
+/**
+ * uint32_t os_time(void)
+ * @brief ticks since os_start
+ */
+uint32_t os_time(void){
+	return os_ticks;
+}
+
+/**
+ * uint32_t os_idle_ticks(void)
+ * @brief ticks until the next delay expires, OS_WAIT_FOREVER if none.
+ *        Called with interrupts masked.
+ */
+uint32_t os_idle_ticks(void){
+	if(delay_head == 0){
+		return OS_WAIT_FOREVER;
+	}
+	if(os_tick_before(delay_head->wake_tick, os_ticks + 1U)){
+		return 0;
+	}
+	return delay_head->wake_tick - os_ticks;
+}
+
+/**
+ * int os_ready_above_idle(void)
+ * @brief 1 when a task other than idle is ready to run
+ */
+int os_ready_above_idle(void){
+	return (ready_bitmap & ~(1U << OS_IDLE_PRIO)) != 0;
+}
+
+/**
+ * void os_delay(uint32_t ticks)
+ * @brief block the running task for ticks (0 = yield)
+ */
+void os_delay(uint32_t ticks){
+	uint32_t pm;
+
+	if(ticks == 0){
+		os_yield();
+		return;
+	}
+	pm = critical_enter();
+	os_block(0, ticks, pm);
+}
+
+/**
+ * void os_yield(void)
+ * @brief let the other ready tasks of the same priority run
+ */
+void os_yield(void){
+	uint32_t pm = critical_enter();
+
+	ready_rotate(os_current->prio);
+	os_schedule();
+	critical_exit(pm);
+}
+
+/**
+ * void os_sem_init(os_sem_t *sem, uint32_t count)
+ * @brief initialize a counting semaphore
+ */
+void os_sem_init(os_sem_t *sem, uint32_t count){
+	sem->count = count;
+	sem->waiters = 0;
+}
+
+/**
+ * int os_sem_take(os_sem_t *sem, uint32_t timeout)
+ * @brief take the semaphore, blocking up to timeout ticks
+ * @param timeout 0 to poll (ISR safe), OS_WAIT_FOREVER to wait without limit
+ * @return OS_OK or OS_ERR_TIMEOUT
+ */
+int os_sem_take(os_sem_t *sem, uint32_t timeout){
+	uint32_t pm = critical_enter();
+
+	if(sem->count > 0){
+		sem->count--;
+		critical_exit(pm);
+		return OS_OK;
+	}
+	if(timeout == 0){
+		critical_exit(pm);
+		return OS_ERR_TIMEOUT;
+	}
+	return os_block(&sem->waiters, timeout, pm);
+}
+
+/**
+ * int os_sem_give(os_sem_t *sem)
+ * @brief give the semaphore: wake the highest priority waiter or count up. ISR safe.
+ */
+int os_sem_give(os_sem_t *sem){
+	uint32_t pm = critical_enter();
+
+	if(sem->waiters){
+		os_wake(sem->waiters, OS_OK);
+		os_schedule();
+	}else{
+		sem->count++;
+	}
+	critical_exit(pm);
+	return OS_OK;
+}
+
+/**
+ * void os_queue_init(os_queue_t *q, void *buf, uint32_t item_size, uint32_t len)
+ * @brief initialize a message queue over buf (item_size * len bytes)
+ */
+void os_queue_init(os_queue_t *q, void *buf, uint32_t item_size, uint32_t len){
+	q->buf = buf;
+	q->item_size = item_size;
+	q->len = len;
+	q->head = 0;
+	q->tail = 0;
+	os_sem_init(&q->items, 0);
+	os_sem_init(&q->spaces, len);
+}
+
+/**
+ * int os_queue_send(os_queue_t *q, const void *item, uint32_t timeout)
+ * @brief copy an item into the queue, blocking up to timeout ticks while it is full
+ * @return OS_OK or OS_ERR_TIMEOUT
+ */
+int os_queue_send(os_queue_t *q, const void *item, uint32_t timeout){
+	uint32_t pm;
+
+	if(os_sem_take(&q->spaces, timeout) != OS_OK){
+		return OS_ERR_TIMEOUT;
+	}
+	pm = critical_enter();
+	memcpy(&q->buf[q->head * q->item_size], item, q->item_size);
+	q->head = (q->head + 1U == q->len) ? 0 : q->head + 1U;
+	critical_exit(pm);
+
+	return os_sem_give(&q->items);
+}
+
+/**
+ * int os_queue_receive(os_queue_t *q, void *item, uint32_t timeout)
+ * @brief copy the oldest item out of the queue, blocking up to timeout ticks while it is empty
+ * @return OS_OK or OS_ERR_TIMEOUT
+ */
+int os_queue_receive(os_queue_t *q, void *item, uint32_t timeout){
+	uint32_t pm;
+
+	if(os_sem_take(&q->items, timeout) != OS_OK){
+		return OS_ERR_TIMEOUT;
+	}
+	pm = critical_enter();
+	memcpy(item, &q->buf[q->tail * q->item_size], q->item_size);
+	q->tail = (q->tail + 1U == q->len) ? 0 : q->tail + 1U;
+	critical_exit(pm);
+
+	return os_sem_give(&q->spaces);
+}
@@ -0,0 +1,275 @@
+/**
+ * kernel_port.c
+ *	@brief Cortex-M4 port of the kernel: context switch, start and tick
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Task stack layout (top -> bottom), as saved by PendSV:
+ *
+ *  hardware frame:  xPSR, PC, LR, R12, R3, R2, R1, R0  (+ S0-S15, FPSCR if FP used)
+ *  software frame:  S16-S31 (only if the task used the FPU), EXC_RETURN, R11-R4
+ *
+ * Lazy FPU stacking (FPCCR.LSPEN) leaves S0-S15 to the hardware and PendSV
+ * only saves S16-S31 when EXC_RETURN bit 4 says the task has an FP context,
+ * so tasks that never touch the FPU switch with the short frame.
+ *
+ * PendSV_Handler and SVC_Handler live here instead of stm32f4xx_it.c.
+ */
+
+#include "stm32f4xx.h"
+#include "kernel.h"
+#include "dwt.h"
+
+#define INITIAL_XPSR				(0x01000000U)	// Thumb bit
+
+static uint32_t cycles_per_tick;
+static uint32_t max_idle_ticks;
+static volatile uint32_t tick_step = 1;				// ticks covered by the running SysTick period
+
+/**
+ * void os_port_init_stack(os_tcb_t *tcb, void (*entry)(void *), void *arg)
+ * @brief build the initial stack frame so that the first switch "returns" into entry(arg)
+ * @step followed:
+ *
+ * 1. Align the top of stack to 8 bytes (AAPCS)
+ * 2. Hardware frame: xPSR, PC = entry, LR = os_task_exit, R0 = arg
+ * 3. Software frame: EXC_RETURN and R4-R11
+ */
+void os_port_init_stack(os_tcb_t *tcb, void (*entry)(void *), void *arg){
+	uint32_t *sp;
+
+	/*1. Align the top of stack to 8 bytes (AAPCS)*/
+	sp = (uint32_t *)((uint32_t)(tcb->stack_base + tcb->stack_words) & ~7U);
+
+	/*2. Hardware frame: xPSR, PC = entry, LR = os_task_exit, R0 = arg*/
+	*--sp = INITIAL_XPSR;
+	*--sp = (uint32_t)entry & ~1U;
+	*--sp = (uint32_t)os_task_exit;
+	*--sp = 0;							// R12
+	*--sp = 0;							// R3
+	*--sp = 0;							// R2
+	*--sp = 0;							// R1
+	*--sp = (uint32_t)arg;				// R0
+
+	/*3. Software frame: EXC_RETURN and R4-R11*/
+	*--sp = EXC_RETURN_THREAD_PSP;
+	for(int i = 0; i < 8; i++){
+		*--sp = 0;						// R11 .. R4
+	}
+	tcb->sp = sp;
+}
+
+/**
+ * void os_port_start(void)
+ * @brief start the first task. Never returns.
+ * @step followed:
+ *
+ * 1. PendSV at the lowest priority, SysTick just above it
+ * 2. Enable the cycle counter used to time context switches
+ * 3. Start SysTick at OS_TICK_HZ
+ * 4. Enable automatic and lazy FP state preservation
+ * 5. Switch to the first task through SVC
+ */
+void os_port_start(void){
+
+	/*1. PendSV at the lowest priority, SysTick just above it*/
+	NVIC_SetPriority(PendSV_IRQn, (1U << __NVIC_PRIO_BITS) - 1U);
+	NVIC_SetPriority(SysTick_IRQn, (1U << __NVIC_PRIO_BITS) - 2U);
+
+	/*2. Enable the cycle counter used to time context switches*/
+	dwt_init();
+
+	/*3. Start SysTick at OS_TICK_HZ*/
+	cycles_per_tick = SystemCoreClock / OS_TICK_HZ;
+	max_idle_ticks = SysTick_LOAD_RELOAD_Msk / cycles_per_tick;
+	SysTick->LOAD = cycles_per_tick - 1U;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+	/*4. Enable automatic and lazy FP state preservation*/
+	FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+
+	/*5. Switch to the first task through SVC*/
+	__enable_irq();
+	__ASM volatile ("svc 0");
+
+	while(1){}
+}
+
+/**
+ * void os_port_request_switch(void)
+ * @brief pend PendSV; the switch runs once no other interrupt is active
+ */
+void os_port_request_switch(void){
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/**
+ * uint32_t os_port_tick_step(void)
+ * @brief called from the tick interrupt: number of ticks the SysTick period
+ *        that just ended stood for, and back to one tick per period.
+ */
+uint32_t os_port_tick_step(void){
+	uint32_t step = tick_step;
+
+	if(SysTick->LOAD != cycles_per_tick - 1U){
+		SysTick->LOAD = cycles_per_tick - 1U;
+		SysTick->VAL = 0;
+	}
+	tick_step = 1;
+	return step;
+}
+
+/**
+ * void os_port_tickless_idle(uint32_t ticks)
+ * @brief sleep until the next delay expires or an interrupt arrives.
+ *        Called from the idle task with interrupts masked.
+ * @step followed:
+ *
+ * 1. Short idle periods just sleep until the next tick
+ * 2. Stop SysTick and see how far into the current tick we are
+ * 3. Program one SysTick period ending at the wake-up tick
+ * 4. Sleep
+ * 5. If another interrupt woke us first, account for the whole ticks
+ *    that passed and finish the current tick with a short period
+ */
+void os_port_tickless_idle(uint32_t ticks){
+	uint32_t elapsed;
+	uint32_t reload;
+	uint32_t full;
+
+	/*1. Short idle periods just sleep until the next tick*/
+	if(ticks < OS_TICKLESS_MIN_TICKS){
+		__DSB();
+		__WFI();
+		__ISB();
+		return;
+	}
+	if(ticks > max_idle_ticks){
+		ticks = max_idle_ticks;
+	}
+
+	/*2. Stop SysTick and see how far into the current tick we are*/
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk){
+		/* the tick is already due, let the handler run first */
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+		return;
+	}
+	elapsed = cycles_per_tick - 1U - SysTick->VAL;
+
+	/*3. Program one SysTick period ending at the wake-up tick*/
+	reload = ticks * cycles_per_tick - elapsed - 1U;
+	SysTick->LOAD = reload;
+	SysTick->VAL = 0;
+	tick_step = ticks;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	os_stats.tickless_entries++;
+
+	/*4. Sleep*/
+	__DSB();
+	__WFI();
+	__ISB();
+
+	/*5. If another interrupt woke us first, account for the whole ticks that passed*/
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk){
+		/* slept the whole period: the tick handler adds tick_step */
+		os_stats.idle_ticks_suppressed += ticks - 1U;
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+		return;
+	}
+	elapsed += reload - SysTick->VAL;
+	full = elapsed / cycles_per_tick;
+	SysTick->LOAD = (full + 1U) * cycles_per_tick - elapsed - 1U;
+	SysTick->VAL = 0;
+	tick_step = 1;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+	if(full){
+		os_stats.idle_ticks_suppressed += full;
+		os_tick_advance(full);
+	}
+}
+
+/**
+ * void SVC_Handler(void)
+ * @brief start the first task: restore its software frame and return to
+ *        thread mode on the process stack.
+ */
+__attribute__((naked)) void SVC_Handler(void){
+	__ASM volatile (
+		"	ldr   r3, =os_current		\n"
+		"	ldr   r1, [r3]				\n"
+		"	ldr   r0, [r1]				\n"	/* os_current->sp */
+		"	ldmia r0!, {r4-r11, lr}		\n"
+		"	msr   psp, r0				\n"
+		"	isb							\n"
+		"	bx    lr					\n"
+		"	.ltorg						\n"
+	);
+}
+
+/**
+ * void PendSV_Handler(void)
+ * @brief context switch from os_current to os_next
+ * @step followed:
+ *
+ * 1. Stamp the cycle counter
+ * 2. Push S16-S31 (only if the task has an FP context), EXC_RETURN and R4-R11 on the PSP
+ * 3. Save the PSP in os_current and make os_next current
+ * 4. Pop the new task's software frame and set the PSP
+ * 5. Record the cycles spent (last, worst case, count) in os_stats
+ *
+ * @note the measured time excludes the hardware exception entry and exit
+ *       (12 cycles each with zero wait state memory).
+ */
+__attribute__((naked)) void PendSV_Handler(void){
+	__ASM volatile (
+		/*1. Stamp the cycle counter*/
+		"	ldr   r3, =0xE0001004		\n"	/* DWT->CYCCNT */
+		"	ldr   r12, [r3]				\n"
+
+		/*2. Push S16-S31, EXC_RETURN and R4-R11 on the PSP*/
+		"	mrs   r0, psp				\n"
+		"	isb							\n"
+		"	tst   lr, #0x10				\n"
+		"	it    eq					\n"
+		"	vstmdbeq r0!, {s16-s31}		\n"
+		"	stmdb r0!, {r4-r11, lr}		\n"
+
+		/*3. Save the PSP in os_current and make os_next current*/
+		"	cpsid i						\n"
+		"	ldr   r2, =os_current		\n"
+		"	ldr   r1, [r2]				\n"
+		"	str   r0, [r1]				\n"
+		"	ldr   r1, =os_next			\n"
+		"	ldr   r1, [r1]				\n"
+		"	str   r1, [r2]				\n"
+		"	cpsie i						\n"
+
+		/*4. Pop the new task's software frame and set the PSP*/
+		"	ldr   r0, [r1]				\n"
+		"	ldmia r0!, {r4-r11, lr}		\n"
+		"	tst   lr, #0x10				\n"
+		"	it    eq					\n"
+		"	vldmiaeq r0!, {s16-s31}		\n"
+		"	msr   psp, r0				\n"
+		"	isb							\n"
+
+		/*5. Record the cycles spent in os_stats*/
+		"	ldr   r0, [r3]				\n"
+		"	subs  r0, r0, r12			\n"
+		"	ldr   r2, =os_stats			\n"
+		"	str   r0, [r2, #4]			\n"	/* ctxsw_cycles_last */
+		"	ldr   r1, [r2, #8]			\n"
+		"	cmp   r0, r1				\n"
+		"	it    hi					\n"
+		"	strhi r0, [r2, #8]			\n"	/* ctxsw_cycles_max */
+		"	ldr   r1, [r2]				\n"
+		"	adds  r1, r1, #1			\n"
+		"	str   r1, [r2]				\n"	/* ctxsw_count */
+		"	bx    lr					\n"
+		"	.ltorg						\n"
+	);
+}
@@ -3,47 +3,551 @@
  *	@brief running MPU6050 i2c bare-metal
  *  @author Nakseung Choi
  *  @date 07-28-2022
+ *
+ * The IMU is sampled from the event scheduler: a 4 ms software timer starts
+ * a non-blocking burst read and the I2C interrupt posts the completion event,
+ * so the core sleeps (WFI) while the bus is busy instead of polling it.
+ * The sensor outputs at the read rate with its low-pass filter below half
+ * of it (MPU6050.h), so no sample is read twice or aliased; "period" and
+ * "bw" retune both at run time.
+ * With IMU_DEVICES 2 a second MPU6050 (AD0 high) on the same bus is read in
+ * the same round (imubus.h) and both go out as one row of the stream.
+ *
+ * Samples are streamed on USART2 as COBS/CRC telemetry frames (telemetry.h,
+ * decoded by Host/telemcat), by default delta compressed in batches of 8
+ * (compress.h).
+ * Commands arrive on USART2 (one line per burst, e.g. "period 10\n") and
+ * are handled by a lower priority task, so they never delay a sample. The
+ * replies ("ok ...", "err") go out as TELEM_TYPE_REPLY frames, so they
+ * cannot break the framing of the stream around them.
+ * Once a second the same task sends the MSP high-water mark (stack.h) and
+ * the IMU bus statistics (imubus.h).
+ * The boot stage timing goes out once, with the first sample (boot.h).
+ *
+ * Wake on motion ("wom <ms>", off by default): once the first sensor's
+ * acceleration has stayed within WOM_THRESHOLD_MG for that long, every
+ * sensor drops to accelerometer cycling (MPU6050_wom_enter) and the STM32
+ * to Stop mode (power.h). Motion raises INT on PA0, the EXTI0 interrupt
+ * wakes the core, the sensors go back to full rate streaming and a round
+ * starts at once. Commands are not received in Stop: move the board first.
+ * "power" reports the Stop entries, the duty cycle and the wake to first
+ * sample latency.
  */
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "stm32f4xx.h"
 #include "MPU6050.h"
+#include "imubus.h"
 #include "i2c.h"
+#include "sched.h"
+#include "bench.h"
+#include "uart.h"
+#include "telemetry.h"
+#include "crc.h"
+#include "compress.h"
+#include "mempool.h"
+#include "stack.h"
+#include "dwt.h"
+#include "boot.h"
+#include "fmt.h"
+#include "power.h"
+
+#define TASK_IMU				(0)
+#define IMU_PRIO				(1)
+#define IMU_PERIOD_MS			(4)		// one 14 byte burst takes ~1.6 ms at 100 kHz
+#define IMU_RATE_HZ				(1000 / IMU_PERIOD_MS)	// sensor output rate = read rate, DLPF below half of it
+#define IMU_DEVICES				(1)		// MPU6050 on I2C1: 1, or 2 with the second at AD0 high
+#define IMU_VALUES				(MPU6050_BURST_LEN / 2)			// per device: accel x,y,z, temperature, gyro x,y,z
+#define IMU_CHANNELS			(6 * IMU_DEVICES)				// packed: accel x,y,z, gyro x,y,z of each device
+#define IMU_BATCH				(8 / IMU_DEVICES)				// rows per packed frame, 32 ms at 4 ms with one device
+#define IMU_KEYFRAME_EVERY		(8)		// packed frames between keyframes
+#define TASK_CMD				(1)
+#define CMD_PRIO				(2)
+#define CMD_LINE_LEN			(32)
+#define STACK_REPORT_MS			(1000)	// TELEM_TYPE_STACK and TELEM_TYPE_BUS frame period
+#define WOM_QUIET_MS			(0)		// quiet time before wake on motion, 0: never ("wom <ms>")
+#define WOM_QUIET_MAX_MS		(60000)	// DWT wraps after 268 s at 16 MHz
+#define WOM_THRESHOLD_MG		(40)	// motion: in software while streaming, MOT_THR while asleep
+#define WOM_WAKE_RATE			MPU6050_WAKE_5HZ
+
+/* IMU task signals */
+enum {
+	SIG_IMU_TICK = 1,
+	SIG_IMU_DONE,
+	SIG_IMU_WAKE		// EXTI0, motion while in wake on motion
+};
+
+/* command task signals */
+enum {
+	SIG_CMD_RX = 1,
+	SIG_CMD_STACK
+};
 
 int16_t Accel_X_RAW, Accel_Y_RAW, Accel_Z_RAW, Gyro_X_RAW, Gyro_Y_RAW, Gyro_Z_RAW;
 float Ax, Ay, Az, Gx, Gy, Gz;
+uint32_t imu_overruns; // ticks skipped because the previous read was still running or the ring was full
 
-extern uint8_t data_rec[6]; //buffer to store data
+_Static_assert(COMP_BLOCK_MAX(IMU_CHANNELS, IMU_BATCH) <= TELEM_MAX_PAYLOAD, "packed IMU batch must fit one frame");
+_Static_assert(IMU_CHANNELS <= COMP_MAX_CHANNELS && IMU_VALUES * IMU_DEVICES <= TELEM_MAX_VALUES, "IMU row too wide");
+_Static_assert(IMU_DEVICES <= IMUBUS_MAX_DEVICES, "too many devices for one bus");
 
-int main(void){
-	/*1. initializes MPU6050*/
- 	MPU6050_init();
+static mpu6050_t imu_dev[IMU_DEVICES] = {
+	MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW),
+#if IMU_DEVICES > 1
+	MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_HIGH),
+#endif
+};
+static imubus_t imu_bus;
 
-	while(1){
-		/*2. read accel values.*/
-		MPU6050_read_values(ACCEL_XOUT_H_REG);
+static uint8_t imu_stream_packed = 1;	// "stream raw" / "stream packed"
+static comp_encoder_t imu_enc;
+static int16_t imu_batch[IMU_BATCH * IMU_CHANNELS];
+static uint32_t imu_batch_stamp;
+static uint8_t imu_batch_len;
+static uint8_t imu_sampled;				// BOOT_FIRST_SAMPLE stamped
+static uint8_t imu_booted;				// boot report sent
+static uint32_t wom_quiet_ms = WOM_QUIET_MS;
+static uint8_t imu_sleeping;			// sensors in wake on motion, ticks ignored
+static uint8_t imu_woken;				// the next complete round is the first after a wake
+static uint8_t imu_still_valid;			// imu_still holds a sample
+static int16_t imu_still[3];			// accel where the first sensor last moved
+static uint32_t imu_moved;				// DWT at the last motion
 
-		Accel_X_RAW = (int16_t)(data_rec[0] << 8 | data_rec[1]);
-		Accel_Y_RAW = (int16_t)(data_rec[2] << 8 | data_rec[3]);
-		Accel_Z_RAW = (int16_t)(data_rec[4] << 8 | data_rec[5]);
+/**
+ * void imu_convert(const mpu6050_t *dev, const uint8_t *data_rec)
+ * @brief convert one raw burst to g and deg/s at the ranges of the device.
+ */
+static void imu_convert(const mpu6050_t *dev, const uint8_t *data_rec){
+	/*1. accel values.*/
+	Accel_X_RAW = (int16_t)(data_rec[0] << 8 | data_rec[1]);
+	Accel_Y_RAW = (int16_t)(data_rec[2] << 8 | data_rec[3]);
+	Accel_Z_RAW = (int16_t)(data_rec[4] << 8 | data_rec[5]);
 
-		Ax = (Accel_X_RAW/16384.0);
-		Ay = (Accel_Y_RAW/16384.0);
-		Az = (Accel_Z_RAW/16384.0);
+	Ax = (Accel_X_RAW/MPU6050_ACCEL_LSB(dev->accel_range));
+	Ay = (Accel_Y_RAW/MPU6050_ACCEL_LSB(dev->accel_range));
+	Az = (Accel_Z_RAW/MPU6050_ACCEL_LSB(dev->accel_range));
 
-		/*3. read gyro values.*/
-		MPU6050_read_values(GYRO_XOUT_H_REG);
+	/*2. gyro values (data_rec[6..7] is the temperature).*/
+	Gyro_X_RAW = (int16_t)(data_rec[8] << 8 | data_rec[9]);
+	Gyro_Y_RAW = (int16_t)(data_rec[10] << 8 | data_rec[11]);
+	Gyro_Z_RAW = (int16_t)(data_rec[12] << 8 | data_rec[13]);
 
-		Gyro_X_RAW = (int16_t)(data_rec[0] << 8 | data_rec[1]);
-		Gyro_Y_RAW = (int16_t)(data_rec[2] << 8 | data_rec[3]);
-		Gyro_Z_RAW = (int16_t)(data_rec[4] << 8 | data_rec[5]);
+	Gx = (Gyro_X_RAW/MPU6050_GYRO_LSB(dev->gyro_range));
+	Gy = (Gyro_Y_RAW/MPU6050_GYRO_LSB(dev->gyro_range));
+	Gz = (Gyro_Z_RAW/MPU6050_GYRO_LSB(dev->gyro_range));
+}
+/**
+ * void imu_send(const mpu6050_raw_t *row)
+ * @brief stream one row (a sample of each device on the bus, one round),
+ *        either as its own frame (7 values per device) or batched and
+ *        compressed (6 values per device, temperature left out). The row has
+ *        the stamp of the first device.
+ */
+static void imu_send(const mpu6050_raw_t *row){
+	uint8_t block[COMP_BLOCK_MAX(IMU_CHANNELS, IMU_BATCH)];
+	int16_t v[IMU_VALUES * IMU_DEVICES];
+	int16_t *dst;
+	uint32_t len;
+
+	for(uint8_t d = 0; d < imu_bus.n; d++){
+		for(uint8_t i = 0; i < IMU_VALUES; i++){
+			v[d * IMU_VALUES + i] = (int16_t)(row[d].raw[2 * i] << 8 | row[d].raw[2 * i + 1]);
+		}
+	}
+	if(!imu_stream_packed){
+		telem_send(TELEM_TYPE_IMU_RAW, row[0].stamp, v, IMU_VALUES * imu_bus.n);
+		return;
+	}
 
-		Gx = (Gyro_X_RAW/131.0);
-		Gy = (Gyro_Y_RAW/131.0);
-		Gz = (Gyro_Z_RAW/131.0);
+	/*1. collect the batch, the block carries the stamp of its first row.*/
+	if(imu_batch_len == 0){
+		imu_batch_stamp = row[0].stamp;
+	}
+	dst = &imu_batch[imu_batch_len * imu_enc.channels];
+	for(uint8_t d = 0; d < imu_bus.n; d++, dst += 6){
+		dst[0] = v[d * IMU_VALUES + 0];
+		dst[1] = v[d * IMU_VALUES + 1];
+		dst[2] = v[d * IMU_VALUES + 2];
+		dst[3] = v[d * IMU_VALUES + 4];
+		dst[4] = v[d * IMU_VALUES + 5];
+		dst[5] = v[d * IMU_VALUES + 6];
+	}
+	if(++imu_batch_len < IMU_BATCH){
+		return;
 	}
 
+	/*2. compress and send; after a dropped frame resync the host with a keyframe.*/
+	len = comp_encode(&imu_enc, imu_batch, IMU_BATCH, block);
+	if(telem_send_bytes(TELEM_TYPE_IMU_PACKED, imu_batch_stamp, block, len) != 0){
+		comp_encoder_keyframe(&imu_enc);
+	}
+	imu_batch_len = 0;
+}
 
+/**
+ * int imu_pop_row(mpu6050_raw_t *row)
+ * @brief take the oldest sample of every device on the bus
+ * @return 0, or -1 once the rings are empty (imubus publishes whole rounds only)
+ */
+static int imu_pop_row(mpu6050_raw_t *row){
+	for(uint8_t d = 0; d < imu_bus.n; d++){
+		if(mpu6050_ring_count(&imu_bus.dev[d]->samples) == 0){
+			return -1;
+		}
+	}
+	for(uint8_t d = 0; d < imu_bus.n; d++){
+		mpu6050_ring_pop(&imu_bus.dev[d]->samples, &row[d]);
+	}
+	return 0;
 }
 
+/**
+ * int imu_row_converted(const mpu6050_raw_t *row)
+ * @brief every device of the row has a conversion: data registers not all at
+ *        their reset value 0, which the first read after wake can still see
+ *        (FAST_BOOT reads before the first sample period is over)
+ * @return 1, or 0 if a device returned reset values only
+ */
+static int imu_row_converted(const mpu6050_raw_t *row){
+	for(uint8_t d = 0; d < imu_bus.n; d++){
+		uint8_t any = 0;
+
+		for(int i = 0; i < MPU6050_BURST_LEN; i++){
+			any |= row[d].raw[i];
+		}
+		if(!any){
+			return 0;
+		}
+	}
+	return 1;
+}
 
+/**
+ * void imu_quiet_check(const mpu6050_raw_t *row)
+ * @brief motion of the first sensor against where it last moved; after
+ *        wom_quiet_ms without any, every sensor to wake on motion and Stop armed
+ * @step followed:
+ *
+ * 1. An axis more than WOM_THRESHOLD_MG away: motion, new reference
+ * 2. Quiet for long enough (and the mode on): Stop armed, then wake on motion.
+ *    Armed first, so that motion during the set-up (EXTI0) disarms it for
+ *    good. The first sensor's INT is the wake-up: if it could not enter wake
+ *    on motion Stop is disarmed and the next quiet check tries again.
+ */
+static void imu_quiet_check(const mpu6050_raw_t *row){
+	int32_t thr = (int32_t)WOM_THRESHOLD_MG * (16384 >> imu_bus.dev[0]->accel_range) / 1000;
+	uint32_t now = dwt_cycles();
+	int moved = !imu_still_valid;
+
+	/*1. An axis more than WOM_THRESHOLD_MG away: motion*/
+	for(int i = 0; i < 3; i++){
+		int16_t a = (int16_t)(row->raw[2 * i] << 8 | row->raw[2 * i + 1]);
+
+		if(a - imu_still[i] > thr || imu_still[i] - a > thr){
+			moved = 1;
+		}
+	}
+	if(moved){
+		for(int i = 0; i < 3; i++){
+			imu_still[i] = (int16_t)(row->raw[2 * i] << 8 | row->raw[2 * i + 1]);
+		}
+		imu_still_valid = 1;
+		imu_moved = now;
+		return;
+	}
+
+	/*2. Quiet for long enough: Stop armed, then wake on motion*/
+	if(wom_quiet_ms == 0 || now - imu_moved < wom_quiet_ms * (SystemCoreClock / 1000U)){
+		return;
+	}
+	power_stop_arm();
+	if(MPU6050_wom_enter(imu_bus.dev[0], WOM_THRESHOLD_MG, WOM_WAKE_RATE) != 0){
+		power_stop_disarm();
+		return;		// bus busy: stay in Run, again at the next row
+	}
+	for(uint8_t d = 1; d < imu_bus.n; d++){
+		MPU6050_wom_enter(imu_bus.dev[d], WOM_THRESHOLD_MG, WOM_WAKE_RATE);
+	}
+	imu_sleeping = 1;
+}
+
+/**
+ * void imu_init(void)
+ * @brief configure the sensors and put those that answer on the bus
+ */
+static void imu_init(void){
+	imubus_init(&imu_bus, TASK_IMU, SIG_IMU_DONE);
+	for(uint8_t d = 0; d < IMU_DEVICES; d++){
+		imu_dev[d].rate_hz = IMU_RATE_HZ;
+		if(MPU6050_init(&imu_dev[d]) == 0){
+			imubus_add(&imu_bus, &imu_dev[d]);
+		}
+	}
+}
+
+/**
+ * void imu_task(const sched_event_t *e)
+ * @brief start a round of reads on every tick, convert the samples when it completes.
+ */
+static void imu_task(const sched_event_t *e){
+	mpu6050_raw_t row[IMU_DEVICES];
+
+	switch(e->sig){
+
+	case SIG_IMU_TICK:
+		/*1. start reading accel, temperature and gyro values of every device (none in wake on motion).*/
+		if(imu_sleeping){
+			break;
+		}
+		if(imubus_tick(&imu_bus) != 0){
+			imu_overruns++;
+		}
+		break;
+
+	case SIG_IMU_DONE:
+		/*2. publish the sample; once the round is complete drain the rings, the first real conversion ends the boot.*/
+		if(imubus_done(&imu_bus, e->arg) != 1){
+			break;
+		}
+		if(imu_woken){
+			power_wake_sampled();
+			imu_woken = 0;
+		}
+		while(imu_pop_row(row) == 0){
+			if(!imu_sampled && imu_row_converted(row)){
+				boot_stamp(BOOT_FIRST_SAMPLE);
+				imu_sampled = 1;
+			}
+			imu_convert(imu_bus.dev[0], row[0].raw);
+			imu_send(row);
+			imu_quiet_check(&row[0]);
+		}
+		if(imu_sampled && !imu_booted){
+			imu_booted = (boot_report() == 0);
+		}
+		/*3. the bus is idle until the next tick: write a retune the command task could not*/
+		for(uint8_t d = 0; d < imu_bus.n; d++){
+			MPU6050_flush(imu_bus.dev[d]);
+		}
+		break;
+
+	case SIG_IMU_WAKE:
+		/*4. motion: full rate again, the first round now instead of at the next tick.*/
+		power_stop_disarm();
+		if(!imu_sleeping){
+			break;
+		}
+		for(uint8_t d = 0; d < imu_bus.n; d++){
+			MPU6050_wom_exit(imu_bus.dev[d]);
+		}
+		imu_sleeping = 0;
+		imu_woken = 1;
+		imu_still_valid = 0;
+		sched_post(TASK_IMU, SIG_IMU_TICK, 0);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * void cmd_reply(const char *text, uint32_t len)
+ * @brief reply to a command line with a TELEM_TYPE_REPLY frame (text, no newline)
+ */
+static void cmd_reply(const char *text, uint32_t len){
+	telem_send_bytes(TELEM_TYPE_REPLY, dwt_cycles(), (const uint8_t *)text, len);
+}
+
+/**
+ * void imu_retune(uint32_t rate_hz, uint32_t bandwidth_hz)
+ * @brief new output rate and DLPF bandwidth on every sensor, reply with what the first one got
+ */
+static void imu_retune(uint32_t rate_hz, uint32_t bandwidth_hz){
+	const mpu6050_filter_t *f;
+	char reply[48];
+	int n;
+
+	if(imu_bus.n == 0 || rate_hz == 0 || rate_hz > UINT16_MAX || bandwidth_hz > UINT16_MAX){
+		cmd_reply("err", 3);
+		return;
+	}
+	for(uint8_t d = 0; d < imu_bus.n; d++){
+		MPU6050_retune(imu_bus.dev[d], (uint16_t)rate_hz, (uint16_t)bandwidth_hz);
+	}
+	f = &imu_bus.dev[0]->filter;
+	n = fmt_snprintf(reply, sizeof(reply), "ok %.3k Hz, bw %u Hz, delay %u us",
+			(int32_t)f->rate_mhz, f->gyro_bw_hz, f->gyro_delay_us);
+	cmd_reply(reply, (uint32_t)n);
+}
+
+/**
+ * void power_report(void)
+ * @brief reply with the Stop entries, the duty cycle and the wake latency
+ */
+static void power_report(void){
+	uint32_t per_us = SystemCoreClock / 1000000U;
+	char reply[64];
+	int n;
+
+	n = fmt_snprintf(reply, sizeof(reply), "stops %u, duty %u, wake %u us (max %u)",
+			power_stats.stops, power_duty_permille(),
+			power_stats.latency_last / per_us, power_stats.latency_max / per_us);
+	cmd_reply(reply, (uint32_t)n);
+}
+
+/**
+ * void cmd_execute(char *line)
+ * @brief run one command line:
+ *        "period <ms>"           changes the IMU sampling period, the sensor
+ *                                output rate follows (bandwidth kept)
+ *        "bw <hz>"               DLPF bandwidth, 0: the widest below half the rate
+ *        "stream raw|packed"     one frame per sample, or compressed batches
+ *        "boot"                  send the boot stage timing again; "busy" when
+ *                                the TX ring had no room for it
+ *        "wom <ms>"              wake on motion after ms quiet, 0: off
+ *        "power"                 Stop entries, duty cycle in permille, wake to
+ *                                first sample latency (last, max) in us
+ */
+static void cmd_execute(char *line){
+	uint32_t ms;
+
+	if(strcmp(line, "boot") == 0){
+		/* a full TX ring drops the frame: not a bad command, try again */
+		if(boot_report() == 0){
+			cmd_reply("ok", 2);
+		}else{
+			cmd_reply("busy", 4);
+		}
+		return;
+	}
+
+	if(strcmp(line, "stream raw") == 0 || strcmp(line, "stream packed") == 0){
+		imu_stream_packed = (line[7] == 'p');
+		imu_batch_len = 0;
+		comp_encoder_keyframe(&imu_enc);
+		cmd_reply("ok", 2);
+		return;
+	}
+	if(strncmp(line, "period ", 7) == 0){
+		ms = strtoul(line + 7, 0, 10);
+		if(sched_timer_set_period(TASK_IMU, SIG_IMU_TICK, ms) == 0){
+			imu_retune((ms < 1000) ? 1000 / ms : 1, imu_dev[0].bandwidth_hz);
+			return;
+		}
+	}
+	if(strncmp(line, "bw ", 3) == 0){
+		imu_retune(imu_dev[0].rate_hz, strtoul(line + 3, 0, 10));
+		return;
+	}
+	if(strncmp(line, "wom ", 4) == 0){
+		ms = strtoul(line + 4, 0, 10);
+		if(ms <= WOM_QUIET_MAX_MS){
+			wom_quiet_ms = ms;
+			imu_moved = dwt_cycles();
+			cmd_reply("ok", 2);
+			return;
+		}
+	}
+	if(strcmp(line, "power") == 0){
+		power_report();
+		return;
+	}
+	cmd_reply("err", 3);
+}
+
+/**
+ * void stack_report(void)
+ * @brief send the MSP high-water mark as a TELEM_TYPE_STACK frame
+ */
+static void stack_report(void){
+	int16_t v[4];
+
+	v[0] = (int16_t)stack_msp_used();
+	v[1] = (int16_t)stack_msp_size();
+	v[2] = (int16_t)stack_guard_size();
+	v[3] = (int16_t)((stack_stats.guard_breaches > INT16_MAX) ? INT16_MAX : stack_stats.guard_breaches);
+	telem_send(TELEM_TYPE_STACK, dwt_cycles(), v, 4);
+}
+
+/**
+ * void cmd_task(const sched_event_t *e)
+ * @brief gather the received chunks into a line and execute it at the end of each burst;
+ *        report the stack use and the IMU bus statistics on its timer.
+ */
+static void cmd_task(const sched_event_t *e){
+	static char line[CMD_LINE_LEN];
+	static uint32_t used;
+	const uint8_t *p;
+	uint32_t len;
+	int end;
+
+	if(e->sig == SIG_CMD_STACK){
+		stack_report();
+		imubus_report(&imu_bus);
+		return;
+	}
+	while((p = uart2_rx_peek(&len, &end)) != 0){
+		/*1. append the chunk, the tail of an over-long line is ignored*/
+		if(len > CMD_LINE_LEN - 1U - used){
+			len = CMD_LINE_LEN - 1U - used;
+		}
+		memcpy(&line[used], p, len);
+		used += len;
+		uart2_rx_release();
+
+		/*2. a complete burst is one command*/
+		if(end){
+			while(used && (line[used - 1] == '\n' || line[used - 1] == '\r')){
+				used--;
+			}
+			line[used] = '\0';
+			cmd_execute(line);
+			used = 0;
+		}
+	}
+}
+
+int main(void){
+	boot_stamp(BOOT_MAIN);
+
+#ifdef RUN_BENCHMARKS
+	bench_run();
+#endif
+
+#if FAST_BOOT
+	/*0. sensor first: configure it before anything that is not needed for the first sample*/
+	imu_init();
+	boot_stamp(BOOT_SENSOR);
+#endif
+
+	/*1. initializes the memory pool, the CRC unit, USART2 (ST-LINK virtual COM port) and the MPU6050s*/
+	pool_init();
+	crc_init();
+	uart2_init(115200);
+#if !FAST_BOOT
+ 	imu_init();
+	boot_stamp(BOOT_SENSOR);
+#endif
+	comp_encoder_init(&imu_enc, 6 * imu_bus.n, IMU_KEYFRAME_EVERY);
+
+	/*2. initializes the scheduler, the IMU task and the command task*/
+	sched_init();
+	sched_task_add(TASK_IMU, IMU_PRIO, imu_task);
+	sched_timer_start(TASK_IMU, SIG_IMU_TICK, IMU_PERIOD_MS);
+#if FAST_BOOT
+	sched_post(TASK_IMU, SIG_IMU_TICK, 0);	// first read now, not one period later
+#endif
+	sched_task_add(TASK_CMD, CMD_PRIO, cmd_task);
+	uart2_rx_notify(TASK_CMD, SIG_CMD_RX);
+	sched_timer_start(TASK_CMD, SIG_CMD_STACK, STACK_REPORT_MS);
+
+	/*3. MPU6050 INT wakes the IMU task, idle in Stop while the sensors watch for motion*/
+	power_init(TASK_IMU, SIG_IMU_WAKE);
+	sched_idle_set(power_idle);
+
+	/*4. dispatch events forever*/
+	sched_run();
+}
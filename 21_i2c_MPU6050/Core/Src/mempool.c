@@ -0,0 +1,335 @@
+/**
+ * mempool.c
+ *	@brief source file for the fixed-block memory pool
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * pool_mem is carved into the classes back to back at pool_init(), class 0
+ * first. A free block holds the link to the next free block of its class in
+ * its first word, so the free lists cost no extra memory. busy has one bit
+ * per block (numbered across all classes) to catch double frees.
+ *
+ * pool_mem sits in .mempool, a NOLOAD section after .bss: the startup code
+ * neither copies nor clears it. The pool initialises itself on the first
+ * allocation, so malloc works even before main() calls pool_init().
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mempool.h"
+#include "atomic.h"
+
+#if defined(__arm__)
+#define POOL_SECTION			__attribute__((section(".mempool")))
+#else
+#define POOL_SECTION
+#endif
+
+typedef struct pool_block {
+	struct pool_block *next;
+} pool_block_t;
+
+typedef struct {
+	uint8_t *start;				// first block
+	uint8_t *end;				// one past the last block
+	pool_block_t *free;			// free list head
+	uint16_t first;				// number of the first block in busy
+} pool_class_t;
+
+static const uint16_t class_size[POOL_CLASSES] = POOL_CLASS_SIZES;
+static const uint16_t class_blocks[POOL_CLASSES] = POOL_CLASS_BLOCKS;
+
+static uint8_t pool_mem[POOL_BYTES] POOL_SECTION __attribute__((aligned(POOL_ALIGN)));
+static pool_class_t classes[POOL_CLASSES];
+static uint32_t busy[(POOL_TOTAL_BLOCKS + 31) / 32];
+static uint8_t pool_ready;
+
+volatile pool_stats_t pool_stats;
+
+/**
+ * void pool_setup(void)
+ * @brief carve pool_mem into the size classes and chain every block onto its free list
+ * @step followed:
+ *
+ * 1. Give each class its run of pool_mem
+ * 2. Link the blocks in address order
+ * 3. Clear busy and the statistics
+ *
+ * Called with interrupts masked.
+ */
+static void pool_setup(void){
+	uint8_t *p = pool_mem;
+	uint16_t first = 0;
+
+	for(uint32_t c = 0; c < POOL_CLASSES; c++){
+
+		/*1. Give each class its run of pool_mem*/
+		classes[c].start = p;
+		classes[c].end = p + (uint32_t)class_size[c] * class_blocks[c];
+		classes[c].first = first;
+		classes[c].free = 0;
+
+		/*2. Link the blocks in address order*/
+		for(uint32_t i = class_blocks[c]; i > 0; i--){
+			pool_block_t *b = (pool_block_t *)(p + (i - 1) * class_size[c]);
+			b->next = classes[c].free;
+			classes[c].free = b;
+		}
+		p = classes[c].end;
+		first += class_blocks[c];
+	}
+
+	/*3. Clear busy and the statistics*/
+	memset(busy, 0, sizeof(busy));
+	memset((void *)&pool_stats, 0, sizeof(pool_stats));
+	for(uint32_t c = 0; c < POOL_CLASSES; c++){
+		pool_stats.cls[c].size = class_size[c];
+		pool_stats.cls[c].blocks = class_blocks[c];
+	}
+	pool_ready = 1;
+}
+
+/**
+ * void pool_init(void)
+ * @brief set the pool up once; a pool already set up (by an earlier call, or
+ *        by pool_alloc before main()) keeps its blocks
+ */
+void pool_init(void){
+	uint32_t primask = critical_enter();
+
+	if(!pool_ready){
+		pool_setup();
+	}
+	critical_exit(primask);
+}
+
+/**
+ * void pool_reset(void)
+ * @brief discard every block and the statistics; only for a caller that owns
+ *        the whole pool (Host/poolcheck), never while blocks are handed out
+ */
+void pool_reset(void){
+	uint32_t primask = critical_enter();
+
+	pool_setup();
+	critical_exit(primask);
+}
+
+/**
+ * int pool_class_of(const void *p, uint32_t *index)
+ * @brief which class and block p belongs to
+ * @return class number, -1 when p is not the start of a pool block
+ */
+static int pool_class_of(const void *p, uint32_t *index){
+	const uint8_t *b = (const uint8_t *)p;
+	uint32_t offset;
+
+	for(int c = 0; c < POOL_CLASSES; c++){
+		if(b >= classes[c].start && b < classes[c].end){
+			offset = (uint32_t)(b - classes[c].start);
+			if(offset % class_size[c] != 0){
+				return -1;
+			}
+			*index = classes[c].first + offset / class_size[c];
+			return c;
+		}
+	}
+	return -1;
+}
+
+/**
+ * void *pool_alloc(size_t size)
+ * @brief take a block of at least size bytes
+ * @step followed:
+ *
+ * 1. Find the smallest class that fits
+ * 2. Pop the first non-empty free list from there up
+ * 3. Mark the block busy and update the statistics
+ *
+ * @return the block, or NULL (errno = ENOMEM) when nothing fits
+ */
+void *pool_alloc(size_t size){
+	pool_block_t *b = 0;
+	uint32_t index;
+	uint32_t primask;
+	uint32_t c = 0;
+	uint32_t want;
+	volatile pool_class_stats_t *s;
+
+	/*1. Find the smallest class that fits*/
+	while(c < POOL_CLASSES && size > class_size[c]){
+		c++;
+	}
+	want = c;
+
+	primask = critical_enter();
+	if(!pool_ready){
+		pool_setup();		// first use, possibly before main()
+	}
+
+	/*2. Pop the first non-empty free list from there up*/
+	for(; c < POOL_CLASSES; c++){
+		b = classes[c].free;
+		if(b){
+			classes[c].free = b->next;
+			break;
+		}
+		pool_stats.cls[c].empty++;
+	}
+	if(!b){
+		pool_stats.failures++;
+		critical_exit(primask);
+		errno = ENOMEM;
+		return 0;
+	}
+
+	/*3. Mark the block busy and update the statistics*/
+	index = classes[c].first + (uint32_t)((uint8_t *)b - classes[c].start) / class_size[c];
+	busy[index / 32] |= 1U << (index % 32);
+	s = &pool_stats.cls[c];
+	s->allocs++;
+	if(++s->used > s->high_water){
+		s->high_water = s->used;
+	}
+	if(c != want){
+		pool_stats.spills++;
+	}
+	critical_exit(primask);
+	return b;
+}
+
+/**
+ * void pool_free(void *p)
+ * @brief return a block to its class; NULL is ignored
+ * @step followed:
+ *
+ * 1. Find the class and block number from the address
+ * 2. Refuse pointers that are not a busy block (counted, nothing freed)
+ * 3. Push the block on its free list
+ */
+void pool_free(void *p){
+	pool_block_t *b = (pool_block_t *)p;
+	uint32_t index;
+	uint32_t primask;
+	int c;
+
+	if(!p){
+		return;
+	}
+
+	/*1. Find the class and block number from the address*/
+	c = pool_class_of(p, &index);
+
+	primask = critical_enter();
+
+	/*2. Refuse pointers that are not a busy block*/
+	if(c < 0){
+		pool_stats.bad_frees++;
+		critical_exit(primask);
+		return;
+	}
+	if(!(busy[index / 32] & (1U << (index % 32)))){
+		pool_stats.double_frees++;
+		critical_exit(primask);
+		return;
+	}
+
+	/*3. Push the block on its free list*/
+	busy[index / 32] &= ~(1U << (index % 32));
+	b->next = classes[c].free;
+	classes[c].free = b;
+	pool_stats.cls[c].used--;
+	critical_exit(primask);
+}
+
+/**
+ * size_t pool_block_size(const void *p)
+ * @brief usable size of the block at p, 0 if p is not a pool block
+ */
+size_t pool_block_size(const void *p){
+	uint32_t index;
+	int c = pool_class_of(p, &index);
+
+	return (c < 0) ? 0 : class_size[c];
+}
+
+#if defined(__arm__)
+
+struct _reent;
+
+/*
+ * The C library allocation entry points, all served by the pool. newlib's
+ * own code (stdio buffers, strdup, ...) calls the _r variants.
+ */
+
+void *malloc(size_t size){
+	return pool_alloc(size);
+}
+
+void free(void *p){
+	pool_free(p);
+}
+
+void *calloc(size_t n, size_t size){
+	void *p;
+
+	if(size && n > POOL_MAX_BLOCK / size){
+		errno = ENOMEM;
+		return 0;
+	}
+	p = pool_alloc(n * size);
+	if(p){
+		memset(p, 0, n * size);
+	}
+	return p;
+}
+
+void *realloc(void *p, size_t size){
+	size_t old = pool_block_size(p);
+	void *q;
+
+	if(!p){
+		return pool_alloc(size);
+	}
+	if(size == 0){
+		pool_free(p);
+		return 0;
+	}
+	if(old == 0){
+		pool_free(p);	// counted as a bad free
+		errno = EINVAL;
+		return 0;
+	}
+	if(size <= old){
+		return p;		// keeps the block even when a smaller class would do
+	}
+	q = pool_alloc(size);
+	if(q){
+		memcpy(q, p, old);
+		pool_free(p);
+	}
+	return q;
+}
+
+void *_malloc_r(struct _reent *r, size_t size){
+	(void)r;
+	return malloc(size);
+}
+
+void _free_r(struct _reent *r, void *p){
+	(void)r;
+	free(p);
+}
+
+void *_calloc_r(struct _reent *r, size_t n, size_t size){
+	(void)r;
+	return calloc(n, size);
+}
+
+void *_realloc_r(struct _reent *r, void *p, size_t size){
+	(void)r;
+	return realloc(p, size);
+}
+
+#endif
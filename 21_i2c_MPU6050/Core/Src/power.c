@@ -0,0 +1,235 @@
+/**
+ * power.c
+ *	@brief source file for the Stop mode between motion (see power.h)
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include "stm32f4xx.h"
+#include "power.h"
+#include "gpio.h"
+#include "sched.h"
+#include "uart.h"
+#include "dwt.h"
+#include "atomic.h"
+
+#define RTC_WPR_KEY1			(0xCAU)
+#define RTC_WPR_KEY2			(0x53U)
+#define RTC_WPR_LOCK			(0xFFU)
+
+GPIO_CFG_DEFINE(power_int_pins, POWER_INT_PINS);
+
+volatile power_stats_t power_stats;
+
+static uint8_t wake_task, wake_sig;
+static volatile uint8_t stop_armed;
+static volatile uint8_t wake_pending;		// woken, first sample not seen yet
+static volatile uint32_t wake_stamp;		// DWT at the EXTI0 interrupt
+static uint32_t run_since;					// RTC at the last wake
+
+/**
+ * uint32_t rtc_diff(uint32_t later, uint32_t earlier)
+ * @brief RTC ticks between two power_rtc_now() readings, across midnight
+ */
+static uint32_t rtc_diff(uint32_t later, uint32_t earlier){
+	return (later >= earlier) ? later - earlier : later + (POWER_RTC_WRAP - earlier);
+}
+
+/**
+ * void rtc_init(void)
+ * @brief RTC on LSI, free running from 00:00:00, shadow registers bypassed
+ * @step followed:
+ *
+ * 1. Enable the PWR clock and the write access to the backup domain
+ * 2. Start LSI and wait for it
+ * 3. RTC clock = LSI (a backup domain reset if another source was set), enable it
+ * 4. Unlock the RTC, enter init mode
+ * 5. Prescalers: the synchronous one first, then the asynchronous one
+ * 6. Read the counters directly (BYPSHAD), leave init mode, lock
+ */
+static void rtc_init(void){
+
+	/*1. Enable the PWR clock and the write access to the backup domain*/
+	RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+	PWR->CR |= PWR_CR_DBP;
+
+	/*2. Start LSI and wait for it*/
+	RCC->CSR |= RCC_CSR_LSION;
+	while(!(RCC->CSR & RCC_CSR_LSIRDY)){}
+
+	/*3. RTC clock = LSI, enable it*/
+	if((RCC->BDCR & RCC_BDCR_RTCSEL) != RCC_BDCR_RTCSEL_1){
+		RCC->BDCR |= RCC_BDCR_BDRST;
+		RCC->BDCR &= ~RCC_BDCR_BDRST;
+		RCC->BDCR |= RCC_BDCR_RTCSEL_1;
+	}
+	RCC->BDCR |= RCC_BDCR_RTCEN;
+
+	/*4. Unlock the RTC, enter init mode*/
+	RTC->WPR = RTC_WPR_KEY1;
+	RTC->WPR = RTC_WPR_KEY2;
+	RTC->ISR |= RTC_ISR_INIT;
+	while(!(RTC->ISR & RTC_ISR_INITF)){}
+
+	/*5. Prescalers: the synchronous one first*/
+	RTC->PRER = POWER_RTC_PREDIV_S;
+	RTC->PRER |= (uint32_t)POWER_RTC_PREDIV_A << RTC_PRER_PREDIV_A_Pos;
+	RTC->TR = 0;
+
+	/*6. Read the counters directly, leave init mode, lock*/
+	RTC->CR |= RTC_CR_BYPSHAD;
+	RTC->ISR &= ~RTC_ISR_INIT;
+	RTC->WPR = RTC_WPR_LOCK;
+}
+
+/**
+ * void power_init(uint8_t task, uint8_t sig)
+ * @brief MPU6050 INT on PA0 / EXTI0, the RTC time base; a wake posts sig to task
+ * @step followed:
+ *
+ * 1. PA0 input with pull-down (POWER_INT_PINS)
+ * 2. EXTI0 from port A on the rising edge, unmasked, enabled in NVIC
+ * 3. RTC on LSI; the first run stretch starts now
+ */
+void power_init(uint8_t task, uint8_t sig){
+	wake_task = task;
+	wake_sig = sig;
+
+	/*1. PA0 input with pull-down*/
+	RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+	gpio_apply(GPIOA, &power_int_pins);
+
+	/*2. EXTI0 from port A on the rising edge*/
+	RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+	SYSCFG->EXTICR[0] &= ~SYSCFG_EXTICR1_EXTI0;		// PA0
+	EXTI->RTSR |= EXTI_RTSR_TR0;
+	EXTI->FTSR &= ~EXTI_FTSR_TR0;
+	EXTI->PR = EXTI_PR_PR0;
+	EXTI->IMR |= EXTI_IMR_MR0;
+	NVIC_EnableIRQ(EXTI0_IRQn);
+
+	/*3. RTC on LSI*/
+	rtc_init();
+	run_since = power_rtc_now();
+}
+
+/**
+ * uint32_t power_rtc_now(void)
+ * @brief RTC ticks since midnight (of the RTC), 0 .. POWER_RTC_WRAP - 1
+ * @note the counters are read directly (BYPSHAD): SSR, TR, SSR again until
+ *       both SSR reads agree, so TR belongs to that SSR.
+ */
+uint32_t power_rtc_now(void){
+	uint32_t ss, tr, secs;
+
+	do{
+		ss = RTC->SSR;
+		tr = RTC->TR;
+	}while(ss != RTC->SSR);
+
+	secs = (((tr & RTC_TR_HT) >> RTC_TR_HT_Pos) * 10U + ((tr & RTC_TR_HU) >> RTC_TR_HU_Pos)) * 3600U
+		+ (((tr & RTC_TR_MNT) >> RTC_TR_MNT_Pos) * 10U + ((tr & RTC_TR_MNU) >> RTC_TR_MNU_Pos)) * 60U
+		+ ((tr & RTC_TR_ST) >> RTC_TR_ST_Pos) * 10U + ((tr & RTC_TR_SU) >> RTC_TR_SU_Pos);
+	return secs * POWER_RTC_HZ + (POWER_RTC_PREDIV_S - (ss & RTC_SSR_SS));
+}
+
+/**
+ * void power_stop_arm(void)
+ * @brief enter Stop at every idle until the next EXTI0 wake. Arm before the
+ *        sensor is set up for wake on motion: a wake during the set-up then
+ *        disarms it again, and none is lost between the two.
+ */
+void power_stop_arm(void){
+	uint32_t primask = critical_enter();
+
+	stop_armed = 1;
+	critical_exit(primask);
+}
+
+/**
+ * void power_stop_disarm(void)
+ * @brief back to WFI at every idle: wake on motion failed to start or has ended
+ */
+void power_stop_disarm(void){
+	stop_armed = 0;
+}
+
+/**
+ * void power_idle(void)
+ * @brief the scheduler's idle, interrupts masked: Stop when armed, WFI otherwise
+ * @step followed:
+ *
+ * 1. Not armed, or USART2 still sending: WFI (Sleep)
+ * 2. Close the run stretch
+ * 3. Stop: low-power regulator, flash powered down, SLEEPDEEP around WFI.
+ *    A pending EXTI0 (motion since the sensor was set up) returns at once.
+ * 4. Add the time in Stop, the next run stretch starts
+ */
+void power_idle(void){
+	uint32_t t;
+
+	/*1. Not armed, or USART2 still sending: WFI*/
+	if(!stop_armed || !uart2_tx_idle()){
+		__WFI();
+		return;
+	}
+
+	/*2. Close the run stretch*/
+	t = power_rtc_now();
+	power_stats.run_ticks += rtc_diff(t, run_since);
+
+	/*3. Stop*/
+	PWR->CR = (PWR->CR & ~PWR_CR_PDDS) | PWR_CR_LPDS | PWR_CR_FPDS;
+	SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+	__WFI();
+	SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+	/*4. Add the time in Stop*/
+	run_since = power_rtc_now();
+	power_stats.stop_ticks += rtc_diff(run_since, t);
+	power_stats.stops++;
+}
+
+/**
+ * void power_wake_sampled(void)
+ * @brief a sample completed: the first one after a wake ends the latency
+ */
+void power_wake_sampled(void){
+	uint32_t lat;
+
+	if(!wake_pending){
+		return;
+	}
+	wake_pending = 0;
+	lat = dwt_cycles() - wake_stamp;
+	power_stats.latency_last = lat;
+	if(lat > power_stats.latency_max){
+		power_stats.latency_max = lat;
+	}
+}
+
+/**
+ * uint32_t power_duty_permille(void)
+ * @brief time awake over all time since power_init(), 0..1000
+ */
+uint32_t power_duty_permille(void){
+	uint64_t run = power_stats.run_ticks + rtc_diff(power_rtc_now(), run_since);
+	uint64_t all = run + power_stats.stop_ticks;
+
+	return all ? (uint32_t)(run * 1000U / all) : 1000U;
+}
+
+/**
+ * void power_exti_irq_handler(void)
+ * @brief EXTI0 (MPU6050 INT): disarm Stop, stamp and post the wake
+ */
+void power_exti_irq_handler(void){
+	if(EXTI->PR & EXTI_PR_PR0){
+		EXTI->PR = EXTI_PR_PR0;
+		stop_armed = 0;
+		wake_stamp = dwt_cycles();
+		wake_pending = 1;
+		power_stats.wakes++;
+		sched_post(wake_task, wake_sig, 0);
+	}
+}
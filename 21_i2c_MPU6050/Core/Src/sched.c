@@ -0,0 +1,300 @@
+/**
+ * sched.c
+ *	@brief source file for the cooperative event scheduler
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Every priority level owns a multi-producer / single-consumer event queue.
+ * Producers reserve a slot by advancing head with LDREX/STREX, fill it and
+ * then mark it committed; the main loop is the only consumer and it only
+ * advances tail. A producer interrupted between reserve and commit is always
+ * resumed before the main loop runs again, so the consumer never waits on it.
+ *
+ * The queue logic has no hardware dependency besides dwt_cycles() and the
+ * idle WFI, both of which are compiled out on host builds.
+ */
+
+#include "sched.h"
+#include "atomic.h"
+
+#if defined(__arm__)
+#include "stm32f4xx.h"
+#include "dwt.h"
+#define SCHED_NOW()				dwt_cycles()
+#else
+#define SCHED_NOW()				(0U)
+#endif
+
+#define SCHED_QUEUE_MASK		(SCHED_QUEUE_LEN - 1U)
+
+typedef struct {
+	volatile uint32_t head;						// next slot to reserve (producers)
+	volatile uint32_t tail;						// next slot to dispatch (consumer)
+	volatile uint8_t committed[SCHED_QUEUE_LEN];
+	sched_event_t slot[SCHED_QUEUE_LEN];
+} sched_queue_t;
+
+typedef struct {
+	uint8_t task;
+	uint8_t sig;
+	uint32_t period;
+	uint32_t remaining;
+} sched_timer_t;
+
+volatile sched_stats_t sched_stats;
+
+static sched_queue_t queues[SCHED_PRIO_LEVELS];
+static sched_handler_t handlers[SCHED_MAX_TASKS];
+static uint8_t task_prio[SCHED_MAX_TASKS];
+static sched_timer_t timers[SCHED_MAX_TIMERS];
+static uint8_t timer_count;
+static sched_idle_t idle_hook;				// 0: WFI
+
+/**
+ * void sched_init(void)
+ * @brief initialize the scheduler
+ * @step followed:
+ *
+ * 1. Clear the queues, tasks and timers
+ * 2. Start the cycle counter used for the latency stamps
+ * 3. Start SysTick at SCHED_TICK_HZ for the software timers
+ */
+void sched_init(void){
+	uint8_t *p = (uint8_t *)queues;
+
+	/*1. Clear the queues, tasks and timers*/
+	for(uint32_t i = 0; i < sizeof(queues); i++){
+		p[i] = 0;
+	}
+	for(uint32_t i = 0; i < SCHED_MAX_TASKS; i++){
+		handlers[i] = 0;
+	}
+	timer_count = 0;
+	idle_hook = 0;
+
+#if defined(__arm__)
+	/*2. Start the cycle counter used for the latency stamps*/
+	dwt_init();
+
+	/*3. Start SysTick at SCHED_TICK_HZ for the software timers*/
+	SysTick_Config(SystemCoreClock / SCHED_TICK_HZ);
+#endif
+}
+
+/**
+ * int sched_task_add(uint8_t task, uint8_t prio, sched_handler_t handler)
+ * @brief register a task handler
+ * @param task task id, 0 .. SCHED_MAX_TASKS - 1
+ * @param prio priority level, 0 (highest) .. SCHED_PRIO_LEVELS - 1
+ * @param handler function called for every event posted to the task
+ * @return 0 on success, -1 on bad arguments
+ */
+int sched_task_add(uint8_t task, uint8_t prio, sched_handler_t handler){
+	if(task >= SCHED_MAX_TASKS || prio >= SCHED_PRIO_LEVELS || handler == 0){
+		return -1;
+	}
+	task_prio[task] = prio;
+	handlers[task] = handler;
+	return 0;
+}
+
+/**
+ * int sched_post(uint8_t task, uint8_t sig, uint16_t arg)
+ * @brief post an event to a task. Safe from thread mode and any ISR.
+ * @step followed:
+ *
+ * 1. Reserve a slot by advancing head (LDREX/STREX), unless the queue is full
+ * 2. Fill the slot and stamp it with the cycle counter
+ * 3. Make the slot visible to the consumer
+ *
+ * @return 0 on success, -1 if the task is unknown or its queue is full
+ */
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	sched_queue_t *q;
+	sched_event_t *e;
+	uint32_t head;
+	uint32_t depth;
+
+	if(task >= SCHED_MAX_TASKS || handlers[task] == 0){
+		return -1;
+	}
+	q = &queues[task_prio[task]];
+
+	/*1. Reserve a slot by advancing head (LDREX/STREX), unless the queue is full*/
+	do{
+		head = q->head;
+		depth = head - q->tail;
+		if(depth >= SCHED_QUEUE_LEN){
+			atomic_add_u32(&sched_stats.dropped, 1);
+			return -1;
+		}
+	}while(!atomic_cas_u32(&q->head, head, head + 1U));
+
+	/*2. Fill the slot and stamp it with the cycle counter*/
+	e = &q->slot[head & SCHED_QUEUE_MASK];
+	e->task = task;
+	e->sig = sig;
+	e->arg = arg;
+	e->stamp = SCHED_NOW();
+
+	/*3. Make the slot visible to the consumer*/
+	ATOMIC_BARRIER();
+	q->committed[head & SCHED_QUEUE_MASK] = 1;
+
+	atomic_add_u32(&sched_stats.posted, 1);
+	if(depth + 1U > sched_stats.queue_hwm[task_prio[task]]){
+		sched_stats.queue_hwm[task_prio[task]] = depth + 1U;
+	}
+	return 0;
+}
+
+/**
+ * int sched_timer_start(uint8_t task, uint8_t sig, uint32_t period_ms)
+ * @brief post sig to task every period_ms milliseconds
+ * @return 0 on success, -1 when all timers are in use
+ */
+int sched_timer_start(uint8_t task, uint8_t sig, uint32_t period_ms){
+	sched_timer_t *t;
+
+	if(timer_count >= SCHED_MAX_TIMERS || period_ms == 0){
+		return -1;
+	}
+	t = &timers[timer_count];
+	t->task = task;
+	t->sig = sig;
+	t->period = period_ms * SCHED_TICK_HZ / 1000U;
+	t->remaining = t->period;
+	timer_count++;
+	return 0;
+}
+
+/**
+ * int sched_timer_set_period(uint8_t task, uint8_t sig, uint32_t period_ms)
+ * @brief change the period of the timer posting sig to task; takes effect
+ *        from the next expiry.
+ * @return 0 on success, -1 when no such timer is running
+ */
+int sched_timer_set_period(uint8_t task, uint8_t sig, uint32_t period_ms){
+	if(period_ms == 0){
+		return -1;
+	}
+	for(uint8_t i = 0; i < timer_count; i++){
+		if(timers[i].task == task && timers[i].sig == sig){
+			timers[i].period = period_ms * SCHED_TICK_HZ / 1000U;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/**
+ * void sched_tick(void)
+ * @brief advance the software timers, called from SysTick_Handler
+ */
+void sched_tick(void){
+	for(uint8_t i = 0; i < timer_count; i++){
+		if(--timers[i].remaining == 0){
+			timers[i].remaining = timers[i].period;
+			sched_post(timers[i].task, timers[i].sig, 0);
+		}
+	}
+}
+
+/**
+ * int sched_dispatch(void)
+ * @brief run the oldest event of the highest non-empty priority level
+ * @step followed:
+ *
+ * 1. Find the highest priority level with a committed event at tail
+ * 2. Copy the event out and release the slot
+ * 3. Record the post -> dispatch latency
+ * 4. Run the handler to completion
+ *
+ * @return 1 if an event was dispatched, 0 if all queues were empty
+ */
+int sched_dispatch(void){
+	sched_queue_t *q;
+	sched_event_t e;
+	uint32_t idx;
+	uint32_t latency;
+
+	/*1. Find the highest priority level with a committed event at tail*/
+	for(uint32_t prio = 0; prio < SCHED_PRIO_LEVELS; prio++){
+		q = &queues[prio];
+		idx = q->tail & SCHED_QUEUE_MASK;
+		if(!q->committed[idx]){
+			continue;
+		}
+
+		/*2. Copy the event out and release the slot*/
+		ATOMIC_BARRIER();
+		e = q->slot[idx];
+		q->committed[idx] = 0;
+		ATOMIC_BARRIER();
+		q->tail++;
+
+		/*3. Record the post -> dispatch latency*/
+		latency = SCHED_NOW() - e.stamp;
+		sched_stats.lat_last[prio] = latency;
+		if(latency > sched_stats.lat_max[prio]){
+			sched_stats.lat_max[prio] = latency;
+		}
+		sched_stats.dispatched++;
+
+		/*4. Run the handler to completion*/
+		handlers[e.task](&e);
+		return 1;
+	}
+	return 0;
+}
+
+#if defined(__arm__)
+/**
+ * int sched_pending(void)
+ * @brief check whether any priority level has an event ready to dispatch
+ */
+static int sched_pending(void){
+	for(uint32_t prio = 0; prio < SCHED_PRIO_LEVELS; prio++){
+		if(queues[prio].committed[queues[prio].tail & SCHED_QUEUE_MASK]){
+			return 1;
+		}
+	}
+	return 0;
+}
+#endif
+
+/**
+ * void sched_idle_set(sched_idle_t idle)
+ * @brief replace the idle WFI by idle (0: back to WFI)
+ */
+void sched_idle_set(sched_idle_t idle){
+	idle_hook = idle;
+}
+
+/**
+ * void sched_run(void)
+ * @brief dispatch events forever, sleeping in WFI (or the idle hook) while idle
+ * @note interrupts are masked around the empty check so that an event
+ *       posted between the check and WFI still wakes the core.
+ */
+void sched_run(void){
+	while(1){
+		if(sched_dispatch()){
+			continue;
+		}
+#if defined(__arm__)
+		__disable_irq();
+		if(!sched_pending()){
+			sched_stats.idle_entries++;
+			if(idle_hook){
+				idle_hook();
+			}else{
+				__WFI();
+			}
+		}
+		__enable_irq();
+#else
+		return;
+#endif
+	}
+}
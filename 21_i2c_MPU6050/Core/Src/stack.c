@@ -0,0 +1,140 @@
+/**
+ * stack.c
+ *	@brief source file for stack painting and high-water-mark reporting
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The MSP region is only known from linker symbols: _estack (top),
+ * _Min_Stack_Size and _Stack_Guard_Size (absolute symbols, their address
+ * is the value).
+ * A scan can under-report by the words that happened to be written with
+ * STACK_PAINT itself; it never over-reports.
+ */
+
+#include "stm32f4xx.h"
+#include "stack.h"
+#include "kernel.h"
+
+extern uint32_t _estack;
+extern uint32_t _Min_Stack_Size;
+extern uint32_t _Stack_Guard_Size;
+
+volatile stack_stats_t stack_stats;
+
+/**
+ * uint32_t stack_msp_size(void)
+ * @brief bytes reserved for the MSP (_Min_Stack_Size)
+ */
+uint32_t stack_msp_size(void){
+	return (uint32_t)&_Min_Stack_Size;
+}
+
+/**
+ * uint32_t stack_guard_size(void)
+ * @brief bytes of guard below the MSP reserve (_Stack_Guard_Size)
+ */
+uint32_t stack_guard_size(void){
+	return (uint32_t)&_Stack_Guard_Size;
+}
+
+/**
+ * uint32_t stack_msp_used(void)
+ * @brief deepest MSP use since reset, bytes; more than stack_msp_size() means the guard was hit
+ */
+uint32_t stack_msp_used(void){
+	uint32_t *bottom = (uint32_t *)((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size - (uint32_t)&_Stack_Guard_Size);
+	uint32_t words = ((uint32_t)&_Min_Stack_Size + (uint32_t)&_Stack_Guard_Size) / 4U;
+
+	return stack_used(bottom, words);
+}
+
+/**
+ * int stack_msp_guard_ok(void)
+ * @brief 1 while the guard below the MSP reserve still holds the pattern
+ */
+int stack_msp_guard_ok(void){
+	uint32_t *guard = (uint32_t *)((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size - (uint32_t)&_Stack_Guard_Size);
+
+	for(uint32_t i = 0; i < (uint32_t)&_Stack_Guard_Size / 4U; i++){
+		if(guard[i] != STACK_PAINT){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * void stack_paint(uint32_t *base, uint32_t words)
+ * @brief fill a stack that is not in use yet with the pattern
+ */
+void stack_paint(uint32_t *base, uint32_t words){
+	for(uint32_t i = 0; i < words; i++){
+		base[i] = STACK_PAINT;
+	}
+}
+
+/**
+ * uint32_t stack_used(const uint32_t *base, uint32_t words)
+ * @brief deepest use of a painted stack, bytes from the top
+ */
+uint32_t stack_used(const uint32_t *base, uint32_t words){
+	uint32_t i = 0;
+
+	while(i < words && base[i] == STACK_PAINT){
+		i++;
+	}
+	return (words - i) * 4U;
+}
+
+/**
+ * void stack_check(void)
+ * @brief SysTick: check the MSP guard and the guard words of the running kernel task
+ * @step followed:
+ *
+ * 1. Check the MSP guard
+ * 2. Check the lowest words of the current task's stack
+ * 3. Record the first breach and call stack_overflow()
+ */
+void stack_check(void){
+	os_tcb_t *task = os_current;
+	const char *who = 0;
+	uint32_t sp = 0;
+	int ok;
+
+	/*1. Check the MSP guard*/
+	ok = stack_msp_guard_ok();
+	if(!ok){
+		sp = __get_MSP();
+	}
+
+	/*2. Check the lowest words of the current task's stack*/
+	if(ok && task){
+		for(uint32_t i = 0; i < STACK_TASK_GUARD_WORDS; i++){
+			if(task->stack_base[i] != STACK_PAINT){
+				ok = 0;
+				who = task->name;
+				sp = __get_PSP();
+				break;
+			}
+		}
+	}
+
+	/*3. Record the first breach and call stack_overflow()*/
+	if(!ok){
+		if(stack_stats.guard_breaches++ == 0){
+			stack_stats.breach_sp = sp;
+			stack_stats.breach_task = who;
+		}
+		stack_overflow();
+	}
+}
+
+/**
+ * void stack_overflow(void)
+ * @brief called on a damaged guard; stops here with interrupts off so the
+ *        state can be examined with the debugger. Override to reset instead.
+ */
+__attribute__((weak)) void stack_overflow(void){
+	__disable_irq();
+	while(1){}
+}
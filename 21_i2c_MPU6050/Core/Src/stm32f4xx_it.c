@@ -22,6 +22,13 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "i2c.h"
+#include "sched.h"
+#include "kernel.h"
+#include "uart.h"
+#include "stack.h"
+#include "sections.h"
+#include "power.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -138,19 +145,6 @@ void UsageFault_Handler(void)
   }
 }
 
-/**
-  * @brief This function handles System service call via SWI instruction.
-  */
-void SVC_Handler(void)
-{
-  /* USER CODE BEGIN SVCall_IRQn 0 */
-
-  /* USER CODE END SVCall_IRQn 0 */
-  /* USER CODE BEGIN SVCall_IRQn 1 */
-
-  /* USER CODE END SVCall_IRQn 1 */
-}
-
 /**
   * @brief This function handles Debug monitor.
   */
@@ -164,19 +158,6 @@ void DebugMon_Handler(void)
   /* USER CODE END DebugMonitor_IRQn 1 */
 }
 
-/**
-  * @brief This function handles Pendable request for system service.
-  */
-void PendSV_Handler(void)
-{
-  /* USER CODE BEGIN PendSV_IRQn 0 */
-
-  /* USER CODE END PendSV_IRQn 0 */
-  /* USER CODE BEGIN PendSV_IRQn 1 */
-
-  /* USER CODE END PendSV_IRQn 1 */
-}
-
 /**
   * @brief This function handles System tick timer.
   */
@@ -187,6 +168,11 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+  sched_tick();
+  os_tick();
+#if STACK_GUARD_CHECK
+  stack_check();
+#endif
 
   /* USER CODE END SysTick_IRQn 1 */
 }
@@ -199,5 +185,84 @@ void SysTick_Handler(void)
 /******************************************************************************/
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles I2C1 event interrupt (runs from SRAM).
+  */
+RAM_FUNC void I2C1_EV_IRQHandler(void)
+{
+  i2c_ev_handler(&i2c1);
+}
+
+/**
+  * @brief This function handles I2C2 event interrupt (runs from SRAM).
+  */
+RAM_FUNC void I2C2_EV_IRQHandler(void)
+{
+  i2c_ev_handler(&i2c2);
+}
+
+/**
+  * @brief This function handles I2C3 event interrupt (runs from SRAM).
+  */
+RAM_FUNC void I2C3_EV_IRQHandler(void)
+{
+  i2c_ev_handler(&i2c3);
+}
+
+/**
+  * @brief This function handles I2C1 error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  i2c_er_handler(&i2c1);
+}
+
+/**
+  * @brief This function handles I2C2 error interrupt.
+  */
+void I2C2_ER_IRQHandler(void)
+{
+  i2c_er_handler(&i2c2);
+}
+
+/**
+  * @brief This function handles I2C3 error interrupt.
+  */
+void I2C3_ER_IRQHandler(void)
+{
+  i2c_er_handler(&i2c3);
+}
+
+/**
+  * @brief This function handles DMA1 stream6 global interrupt (USART2 TX).
+  */
+void DMA1_Stream6_IRQHandler(void)
+{
+  uart2_tx_dma_irq_handler();
+}
+
+/**
+  * @brief This function handles DMA1 stream5 global interrupt (USART2 RX).
+  */
+void DMA1_Stream5_IRQHandler(void)
+{
+  uart2_rx_dma_irq_handler();
+}
+
+/**
+  * @brief This function handles EXTI line0 interrupt (MPU6050 INT, wake from Stop).
+  */
+void EXTI0_IRQHandler(void)
+{
+  power_exti_irq_handler();
+}
+
+/**
+  * @brief This function handles USART2 global interrupt.
+  */
+void USART2_IRQHandler(void)
+{
+  uart2_irq_handler();
+}
 
 /* USER CODE END 1 */
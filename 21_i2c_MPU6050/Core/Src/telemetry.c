@@ -0,0 +1,92 @@
+/**
+ * telemetry.c
+ *	@brief source file for the binary telemetry codec
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * No hardware access: the same file builds into the host decoder (Host/).
+ */
+
+#include <string.h>
+#include "telemetry.h"
+#include "cobs.h"
+#include "crc.h"
+
+/**
+ * uint32_t telem_encode(uint8_t type, uint16_t seq, uint32_t stamp, const uint8_t *payload, uint32_t len, uint8_t *wire)
+ * @brief stuff one frame into wire (TELEM_WIRE_LEN(len) bytes); the pieces
+ *        go through the COBS encoder as they are, nothing is staged.
+ * @step followed:
+ *
+ * 1. Serialise the header little endian
+ * 2. CRC header and payload and stuff them
+ * 3. Stuff the CRC and terminate with the delimiter
+ *
+ * @return bytes written to wire, delimiter included
+ */
+uint32_t telem_encode(uint8_t type, uint16_t seq, uint32_t stamp, const uint8_t *payload, uint32_t len, uint8_t *wire){
+	uint8_t header[TELEM_HEADER_LEN];
+	uint8_t tail[TELEM_CRC_LEN];
+	cobs_enc_t e;
+	uint32_t crc;
+	uint32_t n;
+
+	/*1. Serialise the header little endian*/
+	header[0] = type;
+	header[1] = (uint8_t)seq;
+	header[2] = (uint8_t)(seq >> 8);
+	header[3] = (uint8_t)stamp;
+	header[4] = (uint8_t)(stamp >> 8);
+	header[5] = (uint8_t)(stamp >> 16);
+	header[6] = (uint8_t)(stamp >> 24);
+
+	/*2. CRC header and payload and stuff them*/
+	crc = crc32_mpeg2(CRC32_INIT, header, TELEM_HEADER_LEN);
+	crc = crc32_mpeg2(crc, payload, len);
+	cobs_enc_begin(&e, wire);
+	cobs_enc_put(&e, header, TELEM_HEADER_LEN);
+	cobs_enc_put(&e, payload, len);
+
+	/*3. Stuff the CRC and terminate with the delimiter*/
+	tail[0] = (uint8_t)crc;
+	tail[1] = (uint8_t)(crc >> 8);
+	tail[2] = (uint8_t)(crc >> 16);
+	tail[3] = (uint8_t)(crc >> 24);
+	cobs_enc_put(&e, tail, TELEM_CRC_LEN);
+	n = cobs_enc_end(&e);
+	wire[n++] = COBS_DELIMITER;
+	return n;
+}
+
+/**
+ * int telem_decode(const uint8_t *wire, uint32_t len, telem_msg_t *msg)
+ * @brief unstuff one frame (delimiter removed), check it and fill msg
+ * @return 0 on success, -1 malformed (bad stuffing or length), -2 CRC mismatch
+ */
+int telem_decode(const uint8_t *wire, uint32_t len, telem_msg_t *msg){
+	uint8_t frame[TELEM_FRAME_MAX];
+	int32_t n;
+	uint32_t crc;
+	uint32_t body;
+
+	if(len > COBS_MAX_ENCODED(TELEM_FRAME_MAX)){
+		return -1;
+	}
+	n = cobs_decode(wire, len, frame);
+	if(n < TELEM_HEADER_LEN + TELEM_CRC_LEN || n > (int32_t)TELEM_FRAME_MAX){
+		return -1;
+	}
+	body = (uint32_t)n - TELEM_CRC_LEN;
+	crc = (uint32_t)frame[body] | (uint32_t)frame[body + 1] << 8
+			| (uint32_t)frame[body + 2] << 16 | (uint32_t)frame[body + 3] << 24;
+	if(crc != crc32_mpeg2(CRC32_INIT, frame, body)){
+		return -2;
+	}
+
+	msg->type = frame[0];
+	msg->seq = (uint16_t)(frame[1] | frame[2] << 8);
+	msg->stamp = (uint32_t)frame[3] | (uint32_t)frame[4] << 8 | (uint32_t)frame[5] << 16 | (uint32_t)frame[6] << 24;
+	msg->len = (uint16_t)(body - TELEM_HEADER_LEN);
+	memcpy(msg->payload, &frame[TELEM_HEADER_LEN], msg->len);
+	return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * telemetry_tx.c
+ *	@brief sends telemetry frames on USART2
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Frames are encoded straight into the UART TX ring when the ring has a
+ * contiguous run long enough, otherwise through a stack buffer.
+ */
+
+#include "stm32f4xx.h"
+#include "telemetry.h"
+#include "uart.h"
+#include "sections.h"
+
+volatile telem_stats_t telem_stats;
+
+static uint16_t telem_seq;
+static uint32_t last_cycles;
+static uint32_t cycles_hi;			// DWT wraps, counted here
+
+/**
+ * uint32_t telem_stamp_us(uint32_t cycles)
+ * @brief microseconds since boot for a DWT cycle stamp. The 32 bit counter
+ *        wraps every 2^32 / SystemCoreClock s (268 s at 16 MHz); the wraps
+ *        are tracked here, so a frame must be sent at least every 2^31 cycles.
+ * @step followed:
+ *
+ * 1. A stamp up to 2^31 cycles after the newest: the newest, a wrap if it
+ *    is numerically lower
+ * 2. A stamp before the newest (a batch stamp, row[0] of a round): older
+ *    data, in the wrap of the newest or the one before it
+ */
+static uint32_t telem_stamp_us(uint32_t cycles){
+	uint32_t hi = cycles_hi;
+
+	if((int32_t)(cycles - last_cycles) >= 0){
+		/*1. The newest stamp*/
+		if(cycles < last_cycles){
+			hi = ++cycles_hi;
+		}
+		last_cycles = cycles;
+	}else if(cycles > last_cycles && hi > 0U){
+		/*2. Older, from before the last wrap*/
+		hi--;
+	}
+	return (uint32_t)((((uint64_t)hi << 32) | cycles) / (SystemCoreClock / 1000000U));
+}
+
+/**
+ * int telem_send_bytes(uint8_t type, uint32_t cycles, const uint8_t *payload, uint32_t len)
+ * @brief queue one frame; cycles is the DWT stamp of the data
+ * @step followed:
+ *
+ * 1. Take the next sequence number
+ * 2. Drop the whole frame if the TX ring cannot take it
+ * 3. Encode in place when the free run is long enough, else via the wrap buffer
+ *
+ * @return 0 when queued, -1 when dropped
+ */
+int telem_send_bytes(uint8_t type, uint32_t cycles, const uint8_t *payload, uint32_t len){
+	static uint8_t wrap[TELEM_WIRE_MAX] NOINIT;	// thread mode only, like uart2_tx_reserve
+	uint32_t need;
+	uint32_t seq;
+	uint8_t *wire;
+	uint32_t run;
+	uint32_t n;
+
+	/*1. Take the next sequence number*/
+	if(len > TELEM_MAX_PAYLOAD){
+		return -1;
+	}
+	seq = telem_seq++;
+	need = TELEM_WIRE_LEN(len);
+
+	/*2. Drop the whole frame if the TX ring cannot take it*/
+	if(uart2_tx_space() < need){
+		telem_stats.drops++;
+		return -1;
+	}
+
+	/*3. Encode in place when the free run is long enough, else via the wrap buffer*/
+	wire = uart2_tx_reserve(&run);
+	if(run >= need){
+		n = telem_encode(type, (uint16_t)seq, telem_stamp_us(cycles), payload, len, wire);
+		uart2_tx_commit(n);
+	}else{
+		n = telem_encode(type, (uint16_t)seq, telem_stamp_us(cycles), payload, len, wrap);
+		uart2_write((const char *)wrap, (int)n);
+	}
+	telem_stats.frames++;
+	telem_stats.bytes += n;
+	return 0;
+}
+
+/**
+ * int telem_send(uint8_t type, uint32_t cycles, const int16_t *values, uint8_t count)
+ * @brief queue one frame of int16 values (little endian on the wire)
+ * @return 0 when queued, -1 when dropped
+ */
+int telem_send(uint8_t type, uint32_t cycles, const int16_t *values, uint8_t count){
+	uint8_t payload[2 * TELEM_MAX_VALUES];
+
+	if(count > TELEM_MAX_VALUES){
+		count = TELEM_MAX_VALUES;
+	}
+	for(uint8_t i = 0; i < count; i++){
+		payload[2 * i] = (uint8_t)values[i];
+		payload[2 * i + 1] = (uint8_t)((uint16_t)values[i] >> 8);
+	}
+	return telem_send_bytes(type, cycles, payload, 2U * count);
+}
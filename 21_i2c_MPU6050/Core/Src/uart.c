@@ -0,0 +1,570 @@
+/**
+ * uart.c
+ *	@brief source file for the USART2 driver
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * PA2 -> USART2_TX (AF7)
+ * PA3 -> USART2_RX (AF7)
+ *
+ * TX path: writers copy into tx_ring (producer side). The consumer side is
+ * the DMA: uart2_tx_kick() peeks the longest contiguous run, hands it to
+ * DMA1 Stream6 (channel 4) and releases it on transfer complete, then
+ * starts the next run. A wrap therefore costs one extra DMA transfer.
+ * A transfer error disables the stream: the rest of the run is dropped and
+ * the next one started, so TX never stays owned by a dead stream.
+ * The ring is single producer, but thread code and ISRs both write: the
+ * copy into the ring runs with interrupts masked, so a write from an ISR
+ * lands whole before or after the one it preempted. The zero copy pair
+ * uart2_tx_reserve/commit is for thread mode; while a reservation is open
+ * ISR writes are dropped rather than copied into the reserved run.
+ *
+ * RX path: DMA1 Stream5 (channel 4) writes rx_buf circularly. The USART2
+ * IDLE interrupt and the stream's HT/TC interrupts call uart2_rx_collect(),
+ * which turns the bytes between the last position and NDTR into chunk
+ * descriptors on rx_chunks (producer: those ISRs, which run at the same
+ * priority; consumer: the application).
+ */
+
+#include "stm32f4xx.h"
+#include "uart.h"
+#include "ring.h"
+#include "atomic.h"
+#include "bitband.h"
+#include "sched.h"
+#include "fmt.h"
+#include "sections.h"
+
+#define USART2_AF				(7U)
+#define DMA_CHANNEL_USART2		(4U)
+#define NO_TASK					(0xFFU)
+
+typedef struct {
+	uint16_t offset;		// into rx_buf
+	uint16_t len;
+	uint8_t end;			// last chunk of an idle-terminated burst
+} uart_rx_chunk_t;
+
+RING_DECLARE(uart_tx_ring, uint8_t, UART_TX_RING_LEN)
+RING_DECLARE(uart_rx_chunks, uart_rx_chunk_t, UART_RX_CHUNKS)
+
+volatile uart_tx_stats_t uart_tx_stats;
+volatile uart_rx_stats_t uart_rx_stats;
+uart_line_t uart2_line;
+
+static uart_tx_ring_t tx_ring;			// .bss: empty even for a write before uart2_init()
+static volatile uint32_t tx_in_flight;		// bytes currently owned by DMA (at tail)
+static volatile uint8_t tx_reserved;		// thread mode holds a uart2_tx_reserve run
+static uart_tx_policy_t tx_policy = UART_TX_DROP;
+
+static uint8_t rx_buf[UART_RX_DMA_LEN] NOINIT;
+static uart_rx_chunks_t rx_chunks;
+static uint32_t rx_pos;						// next rx_buf byte not yet cut into a chunk
+static uint32_t rx_burst;					// bytes in the burst so far
+static volatile uint32_t rx_outstanding;	// bytes in chunks not yet released
+static uint8_t rx_task = NO_TASK;
+static uint8_t rx_sig;
+
+/**
+ * void uart2_set_baud(uint32_t pclk, uint32_t baud)
+ * @brief program BRR for the closest rate PCLK1 / n; oversample by 8 only
+ *        when n < 16, and record what was set in uart2_line.
+ */
+static void uart2_set_baud(uint32_t pclk, uint32_t baud){
+	uint32_t n = (pclk + baud / 2U) / baud;
+
+	if(n < 8U){
+		n = 8U;
+	}
+	uart2_line.requested = baud;
+	uart2_line.actual = pclk / n;
+	uart2_line.error_ppm = (int32_t)(((int64_t)uart2_line.actual - baud) * 1000000 / baud);
+	uart2_line.over8 = (n < 16U);
+
+	if(uart2_line.over8){
+		/* DIV_Fraction is 3 bits, bit 3 must stay clear */
+		BB_SET(USART2->CR1, USART_CR1_OVER8_Pos);
+		USART2->BRR = ((n & ~7U) << 1) | (n & 7U);
+	}else{
+		BB_CLR(USART2->CR1, USART_CR1_OVER8_Pos);
+		USART2->BRR = n;
+	}
+}
+
+/**
+ * void uart2_init(uint32_t baud)
+ * @brief initialize USART2 for 8N1 at baud, TX through DMA1 Stream6
+ * @step followed:
+ *
+ * 1. Enable clock access to GPIOA, USART2 and DMA1
+ * 2. Set PA2 and PA3 mode to alternate function AF7
+ * 3. Enable transmitter, receiver, IDLE interrupt and DMA requests, and set the baud rate
+ * 4. Configure DMA1 Stream6: channel 4, memory to peripheral, memory increment, TC and TE interrupts
+ * 5. Configure DMA1 Stream5: channel 4, peripheral to memory, circular, HT and TC interrupts
+ * 6. Enable USART2 module and the interrupts in NVIC
+ */
+void uart2_init(uint32_t baud){
+	uint32_t pclk1;
+
+	/*1. Enable clock access to GPIOA, USART2 and DMA1*/
+	RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_DMA1EN;
+	RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
+
+	/*2. Set PA2 and PA3 mode to alternate function AF7*/
+	GPIOA->MODER = (GPIOA->MODER & ~(GPIO_MODER_MODE2 | GPIO_MODER_MODE3)) | GPIO_MODER_MODE2_1 | GPIO_MODER_MODE3_1;
+	GPIOA->AFR[0] = (GPIOA->AFR[0] & ~(GPIO_AFRL_AFSEL2 | GPIO_AFRL_AFSEL3))
+			| (USART2_AF << GPIO_AFRL_AFSEL2_Pos) | (USART2_AF << GPIO_AFRL_AFSEL3_Pos);
+
+	/*3. Enable transmitter, receiver, IDLE interrupt and DMA requests, and set the baud rate*/
+	USART2->CR1 = USART_CR1_TE | USART_CR1_RE | USART_CR1_IDLEIE;
+	USART2->CR3 |= USART_CR3_DMAT | USART_CR3_DMAR;
+	pclk1 = SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+	uart2_set_baud(pclk1, baud);
+
+	/*4. Configure DMA1 Stream6: channel 4, memory to peripheral, memory increment, TC and TE interrupts*/
+	BB_CLR(DMA1_Stream6->CR, DMA_SxCR_EN_Pos);
+	while(DMA1_Stream6->CR & DMA_SxCR_EN){}
+	DMA1_Stream6->PAR = (uint32_t)&USART2->DR;
+	DMA1_Stream6->CR = (DMA_CHANNEL_USART2 << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MINC | DMA_SxCR_DIR_0
+			| DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+
+	uart_tx_ring_init(&tx_ring);
+	tx_in_flight = 0;
+	tx_reserved = 0;
+
+	/*5. Configure DMA1 Stream5: channel 4, peripheral to memory, circular, HT and TC interrupts*/
+	BB_CLR(DMA1_Stream5->CR, DMA_SxCR_EN_Pos);
+	while(DMA1_Stream5->CR & DMA_SxCR_EN){}
+	DMA1->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5;
+	DMA1_Stream5->PAR = (uint32_t)&USART2->DR;
+	DMA1_Stream5->M0AR = (uint32_t)rx_buf;
+	DMA1_Stream5->NDTR = UART_RX_DMA_LEN;
+	DMA1_Stream5->CR = (DMA_CHANNEL_USART2 << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MINC | DMA_SxCR_CIRC
+			| DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+	uart_rx_chunks_init(&rx_chunks);
+	rx_pos = 0;
+	rx_burst = 0;
+	rx_outstanding = 0;
+	BB_SET(DMA1_Stream5->CR, DMA_SxCR_EN_Pos);
+
+	/*6. Enable USART2 module and the interrupts in NVIC*/
+	BB_SET(USART2->CR1, USART_CR1_UE_Pos);
+	NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+	NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+	NVIC_EnableIRQ(USART2_IRQn);
+}
+
+/**
+ * void uart2_set_tx_policy(uart_tx_policy_t policy)
+ * @brief choose what uart2_write does when the TX ring is full
+ */
+void uart2_set_tx_policy(uart_tx_policy_t policy){
+	tx_policy = policy;
+}
+
+/**
+ * void uart2_tx_kick(void)
+ * @brief start DMA on the next contiguous run of queued bytes, if DMA is idle
+ * @step followed:
+ *
+ * 1. Leave if DMA already owns a run or nothing is queued
+ * 2. Clear stream 6 flags and USART TC
+ * 3. Point DMA at the run and enable the stream
+ */
+static void uart2_tx_kick(void){
+	uint32_t pm = critical_enter();
+	uint8_t *p;
+	uint32_t n;
+
+	/*1. Leave if DMA already owns a run or nothing is queued*/
+	p = uart_tx_ring_read_peek(&tx_ring, &n);
+	if(tx_in_flight != 0 || n == 0){
+		critical_exit(pm);
+		return;
+	}
+
+	/*2. Clear stream 6 flags and USART TC*/
+	DMA1->HIFCR = DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6;
+	USART2->SR = ~(uint32_t)USART_SR_TC;	// rc_w0: a single write leaves the other flags alone
+
+	/*3. Point DMA at the run and enable the stream*/
+	tx_in_flight = n;
+	DMA1_Stream6->M0AR = (uint32_t)p;
+	DMA1_Stream6->NDTR = n;
+	BB_SET(DMA1_Stream6->CR, DMA_SxCR_EN_Pos);
+	uart_tx_stats.dma_chunks++;
+
+	critical_exit(pm);
+}
+
+/**
+ * uint32_t uart2_tx_make_room(uint32_t len)
+ * @brief OVERWRITE policy: discard queued bytes that DMA does not own yet,
+ *        so the newest len bytes fit. Runs with interrupts masked because it
+ *        moves head back, which the consumer (kick) could be peeking.
+ * @return free space after discarding
+ */
+static uint32_t uart2_tx_make_room(uint32_t len){
+	uint32_t pm = critical_enter();
+	uint32_t keep = tx_ring.tail + tx_in_flight;
+	uint32_t discard = tx_ring.head - keep;
+
+	if(uart_tx_ring_space(&tx_ring) < len && discard){
+		tx_ring.head = keep;
+		uart_tx_stats.overwritten += discard;
+	}
+	critical_exit(pm);
+	return uart_tx_ring_space(&tx_ring);
+}
+
+/**
+ * int uart2_write(const char *data, int len)
+ * @brief queue bytes for transmission and return without waiting for the line.
+ *        Thread mode and ISRs; an ISR write is never split by another writer.
+ * @step followed:
+ *
+ * 1. Mask interrupts: the ring has one producer at a time
+ * 2. From an ISR, drop while thread mode holds a zero copy reservation
+ * 3. Count an overflow if the ring cannot take everything
+ * 4. Apply the policy: block until DMA frees space, drop, or overwrite
+ * 5. Copy into the ring and start DMA; a blocking write waits unmasked,
+ *    so ISR output can fall between its parts
+ *
+ * @return number of bytes queued
+ */
+int uart2_write(const char *data, int len){
+	uint32_t done = 0;
+	uint32_t n;
+	uint32_t pm;
+	int can_block;
+
+	if(len <= 0){
+		return 0;
+	}
+
+	/* blocking is only possible in thread mode with interrupts enabled */
+	can_block = (tx_policy == UART_TX_BLOCK) && (__get_IPSR() == 0) && (__get_PRIMASK() == 0);
+
+	/*1. Mask interrupts: the ring has one producer at a time*/
+	pm = critical_enter();
+
+	/*2. From an ISR, drop while thread mode holds a zero copy reservation*/
+	if(__get_IPSR() != 0){
+		if(tx_reserved){
+			uart_tx_stats.dropped += (uint32_t)len;
+			critical_exit(pm);
+			return 0;
+		}
+	}else{
+		/* a thread writer gives up its reservation */
+		tx_reserved = 0;
+	}
+
+	/*3. Count an overflow if the ring cannot take everything*/
+	if(uart_tx_ring_space(&tx_ring) < (uint32_t)len){
+		uart_tx_stats.overflows++;
+
+		/*4. Apply the policy*/
+		if(tx_policy == UART_TX_OVERWRITE){
+			if(uart2_tx_make_room((uint32_t)len) < (uint32_t)len){
+				/* longer than the whole ring: keep its tail end */
+				uart_tx_stats.overwritten += (uint32_t)len - uart_tx_ring_space(&tx_ring);
+				data += (uint32_t)len - uart_tx_ring_space(&tx_ring);
+				len = (int)uart_tx_ring_space(&tx_ring);
+			}
+		}
+	}
+
+	/*5. Copy into the ring and start DMA*/
+	while(1){
+		n = uart_tx_ring_push_bulk(&tx_ring, (const uint8_t *)data + done, (uint32_t)len - done);
+		done += n;
+		uart_tx_stats.queued += n;
+		if(done < (uint32_t)len && !can_block){
+			uart_tx_stats.dropped += (uint32_t)len - done;
+		}
+		critical_exit(pm);
+		uart2_tx_kick();
+		if(done == (uint32_t)len || !can_block){
+			break;
+		}
+		__WFI();	// DMA transfer complete frees space
+		pm = critical_enter();
+	}
+	return (int)done;
+}
+
+/**
+ * uint32_t uart2_tx_space(void)
+ * @brief bytes that can be queued right now
+ */
+uint32_t uart2_tx_space(void){
+	return uart_tx_ring_space(&tx_ring);
+}
+
+/**
+ * uint8_t *uart2_tx_reserve(uint32_t *n)
+ * @brief zero copy write: contiguous free run of the TX ring, *n = its length.
+ *        Thread mode only. Fill it and call uart2_tx_commit(), or give it up
+ *        with a uart2_write(); until then ISR writes are dropped.
+ */
+uint8_t *uart2_tx_reserve(uint32_t *n){
+	tx_reserved = 1;
+	return uart_tx_ring_write_reserve(&tx_ring, n);
+}
+
+/**
+ * void uart2_tx_commit(uint32_t n)
+ * @brief publish n bytes written through uart2_tx_reserve and start DMA
+ */
+void uart2_tx_commit(uint32_t n){
+	uint32_t pm = critical_enter();
+
+	uart_tx_ring_write_commit(&tx_ring, n);
+	uart_tx_stats.queued += n;
+	tx_reserved = 0;
+	critical_exit(pm);
+	uart2_tx_kick();
+}
+
+/**
+ * void uart2_flush(void)
+ * @brief wait until every queued byte has left the shift register
+ */
+void uart2_flush(void){
+	while(uart_tx_ring_count(&tx_ring) != 0){}
+	while(!(USART2->SR & USART_SR_TC)){}
+}
+
+/**
+ * int uart2_tx_idle(void)
+ * @brief 1 when every queued byte has left the shift register, without waiting
+ */
+int uart2_tx_idle(void){
+	return uart_tx_ring_count(&tx_ring) == 0 && (USART2->SR & USART_SR_TC);
+}
+
+/**
+ * void uart2_tx_dma_irq_handler(void)
+ * @brief DMA1 Stream6 interrupt, called from DMA1_Stream6_IRQHandler
+ * @step followed:
+ *
+ * 1. On transfer error (the stream has disabled itself), clear the flags,
+ *    count it and release the run: what NDTR says was not sent is dropped
+ * 2. On transfer complete, clear the flag and release the run to the producer
+ * 3. Start the next run
+ */
+void uart2_tx_dma_irq_handler(void){
+	uint32_t isr = DMA1->HISR;
+
+	/*1. On transfer error, drop the rest of the run*/
+	if(isr & DMA_HISR_TEIF6){
+		uint32_t left = DMA1_Stream6->NDTR;
+
+		DMA1->HIFCR = DMA_HIFCR_CTEIF6 | DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6;
+		uart_tx_stats.dma_errors++;
+		uart_tx_stats.sent += tx_in_flight - left;
+		uart_tx_stats.dropped += left;
+		uart_tx_ring_read_release(&tx_ring, tx_in_flight);
+		tx_in_flight = 0;
+
+	/*2. On transfer complete, clear the flag and release the run to the producer*/
+	}else if(isr & DMA_HISR_TCIF6){
+		DMA1->HIFCR = DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6;
+		uart_tx_stats.sent += tx_in_flight;
+		uart_tx_ring_read_release(&tx_ring, tx_in_flight);
+		tx_in_flight = 0;
+	}
+
+	/*3. Start the next run*/
+	uart2_tx_kick();
+}
+
+/**
+ * void uart2_rx_notify(uint8_t task, uint8_t sig)
+ * @brief post sig to task (arg = burst length) at the end of every burst
+ */
+void uart2_rx_notify(uint8_t task, uint8_t sig){
+	rx_sig = sig;
+	rx_task = task;
+}
+
+/**
+ * void uart2_rx_chunk(uint32_t offset, uint32_t len, uint8_t end)
+ * @brief queue one contiguous piece of rx_buf for the application
+ */
+static void uart2_rx_chunk(uint32_t offset, uint32_t len, uint8_t end){
+	uart_rx_chunk_t c = {(uint16_t)offset, (uint16_t)len, end};
+
+	if(uart_rx_chunks_push(&rx_chunks, &c) != 0){
+		uart_rx_stats.chunk_drops++;
+		return;
+	}
+	rx_outstanding += len;
+	uart_rx_stats.chunks++;
+}
+
+/**
+ * void uart2_rx_collect(uint8_t end)
+ * @brief cut the bytes DMA wrote since the last call into chunks
+ * @step followed:
+ *
+ * 1. Find the DMA write position from NDTR
+ * 2. Detect the DMA lapping data the application still holds
+ * 3. Queue the new bytes, as two chunks when they wrap
+ * 4. At the end of a burst mark the last chunk and notify the task
+ */
+static void uart2_rx_collect(uint8_t end){
+	uint32_t pos;
+	uint32_t n;
+
+	/*1. Find the DMA write position from NDTR*/
+	pos = UART_RX_DMA_LEN - DMA1_Stream5->NDTR;
+	if(pos == UART_RX_DMA_LEN){
+		pos = 0;
+	}
+	n = (pos - rx_pos) & (UART_RX_DMA_LEN - 1U);
+
+	/*2. Detect the DMA lapping data the application still holds*/
+	if(rx_outstanding + n > UART_RX_DMA_LEN){
+		uart_rx_stats.overruns++;
+	}
+	uart_rx_stats.bytes += n;
+	rx_burst += n;
+
+	/*3. Queue the new bytes, as two chunks when they wrap*/
+	if(rx_pos + n > UART_RX_DMA_LEN){
+		uart2_rx_chunk(rx_pos, UART_RX_DMA_LEN - rx_pos, 0);
+		uart2_rx_chunk(0, pos, end);
+	}else if(n || (end && rx_burst)){
+		/* an empty chunk still carries the end of a burst that stopped on HT/TC */
+		uart2_rx_chunk(rx_pos, n, end);
+	}
+	rx_pos = pos;
+
+	/*4. At the end of a burst mark the last chunk and notify the task*/
+	if(end && rx_burst){
+		uart_rx_stats.frames++;
+		if(rx_burst > uart_rx_stats.burst_max){
+			uart_rx_stats.burst_max = rx_burst;
+		}
+		if(rx_task != NO_TASK){
+			sched_post(rx_task, rx_sig, (uint16_t)rx_burst);
+		}
+		rx_burst = 0;
+	}
+}
+
+/**
+ * const uint8_t *uart2_rx_peek(uint32_t *len, int *end)
+ * @brief oldest received chunk, in place in the DMA buffer
+ * @return pointer to the chunk, 0 when nothing is pending
+ */
+const uint8_t *uart2_rx_peek(uint32_t *len, int *end){
+	uint32_t n;
+	uart_rx_chunk_t *c = uart_rx_chunks_read_peek(&rx_chunks, &n);
+
+	if(n == 0){
+		return 0;
+	}
+	*len = c->len;
+	*end = c->end;
+	return &rx_buf[c->offset];
+}
+
+/**
+ * void uart2_rx_release(void)
+ * @brief hand the chunk returned by uart2_rx_peek back to the DMA
+ */
+void uart2_rx_release(void){
+	uint32_t n;
+	uart_rx_chunk_t *c = uart_rx_chunks_read_peek(&rx_chunks, &n);
+
+	if(n == 0){
+		return;
+	}
+	atomic_add_u32(&rx_outstanding, 0U - c->len);
+	uart_rx_chunks_read_release(&rx_chunks, 1);
+}
+
+/**
+ * void uart2_rx_dma_irq_handler(void)
+ * @brief DMA1 Stream5 half/full transfer interrupt, called from DMA1_Stream5_IRQHandler
+ */
+void uart2_rx_dma_irq_handler(void){
+	uint32_t isr = DMA1->HISR;
+
+	DMA1->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5;
+	if(isr & (DMA_HISR_HTIF5 | DMA_HISR_TCIF5)){
+		uart_rx_stats.irqs++;
+		uart2_rx_collect(0);
+	}
+}
+
+/**
+ * void uart2_irq_handler(void)
+ * @brief USART2 interrupt, called from USART2_IRQHandler
+ * @step followed:
+ *
+ * 1. Read SR; only when IDLE or an error flag is set, read DR as well, which
+ *    clears them (RM0383 USART_SR). A DR read with neither set could take a
+ *    byte that RXNE has just raised for the DMA.
+ * 2. Count line errors
+ * 3. On IDLE, collect the end of the burst
+ */
+void uart2_irq_handler(void){
+	uint32_t sr;
+
+	/*1. Read SR, and DR only to clear IDLE and the error flags*/
+	sr = USART2->SR;
+	if(sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE)){
+		(void)USART2->DR;
+	}
+
+	/*2. Count line errors*/
+	if(sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE)){
+		uart_rx_stats.line_errors++;
+	}
+
+	/*3. On IDLE, collect the end of the burst*/
+	if(sr & USART_SR_IDLE){
+		uart_rx_stats.irqs++;
+		uart2_rx_collect(1);
+	}
+}
+
+/**
+ * int uart2_printf(const char *format, ...)
+ * @brief formatted output through fmt.c (no heap, no newlib printf)
+ * @step followed:
+ *
+ * 1. Format into a line buffer on the stack, truncated at UART_PRINTF_MAX
+ * 2. Queue it with one uart2_write so the TX policy drops or overwrites whole lines
+ *
+ * @return bytes queued
+ */
+int uart2_printf(const char *format, ...){
+	char line[UART_PRINTF_MAX];
+	va_list ap;
+	int n;
+
+	/*1. Format into a line buffer on the stack*/
+	va_start(ap, format);
+	n = fmt_vsnprintf(line, sizeof(line), format, ap);
+	va_end(ap);
+	if(n > (int)sizeof(line) - 1){
+		n = (int)sizeof(line) - 1;
+	}
+
+	/*2. Queue it with one uart2_write*/
+	return uart2_write(line, n);
+}
+
+/**
+ * int _write(int file, char *ptr, int len)
+ * @brief newlib output hook (printf, puts, ...), replaces the weak one in syscalls.c
+ */
+int _write(int file, char *ptr, int len){
+	(void)file;
+	return uart2_write(ptr, len);
+}
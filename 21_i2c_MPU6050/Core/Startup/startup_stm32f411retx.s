@@ -45,6 +45,21 @@ defined in linker script */
 .word  _ebss
 /* stack used for SystemInit_ExtMemCtl; always internal RAM used */
 
+/* Boot stage indexes of boot_times[], same values as in boot.h */
+.equ BOOT_PAINT,   0
+.equ BOOT_DATA,    1
+.equ BOOT_BSS,     2
+.equ BOOT_SYSINIT, 3
+.equ BOOT_CTORS,   4
+
+/* Store DWT->CYCCNT in boot_times[stage] (.noinit); uses r0 and r1 */
+.macro BOOT_STAMP stage
+  ldr r0, =0xE0001004            /* DWT->CYCCNT */
+  ldr r0, [r0]
+  ldr r1, =boot_times
+  str r0, [r1, #(\stage * 4)]
+.endm
+
 /**
  * @brief  This is the code that gets called when the processor first
  *          starts execution following a reset event. Only the absolutely
@@ -60,6 +75,38 @@ defined in linker script */
 Reset_Handler:  
   ldr   sp, =_estack    		 /* set stack pointer */
 
+/* Start the DWT cycle counter from 0, the boot stages are timed with it (boot.h) */
+  ldr r0, =0xE000EDFC            /* CoreDebug->DEMCR */
+  ldr r1, [r0]
+  orr r1, r1, #0x01000000        /* TRCENA */
+  str r1, [r0]
+  ldr r0, =0xE0001000            /* DWT->CTRL */
+  movs r1, #0
+  str r1, [r0, #4]               /* DWT->CYCCNT */
+  ldr r1, [r0]
+  orr r1, r1, #1                 /* CYCCNTENA */
+  str r1, [r0]
+
+/* Paint the stack reserve and the guard below it (STACK_PAINT, stack.h) */
+  ldr r0, =_estack
+  ldr r1, =_Min_Stack_Size
+  ldr r2, =_Stack_Guard_Size
+  subs r1, r0, r1
+  subs r1, r1, r2
+  ldr r2, =0xA5A5A5A5
+  b LoopPaintStack
+
+PaintStack:
+  str r2, [r1], #4
+
+LoopPaintStack:
+  cmp r1, r0
+  bcc PaintStack
+  BOOT_STAMP BOOT_PAINT
+
+.ifdef BOOT_WORD_LOOPS
+/* Original one word per iteration loops, kept to compare boot_times[]
+   (assemble with -Wa,--defsym,BOOT_WORD_LOOPS=1) */
 /* Copy the data segment initializers from flash to SRAM */  
   ldr r0, =_sdata
   ldr r1, =_edata
@@ -76,6 +123,7 @@ LoopCopyDataInit:
   adds r4, r0, r3
   cmp r4, r1
   bcc CopyDataInit
+  BOOT_STAMP BOOT_DATA
   
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
@@ -90,11 +138,94 @@ FillZerobss:
 LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
+  BOOT_STAMP BOOT_BSS
+
+.else
+/* Copy the data segment initializers from flash to SRAM, 16 bytes per LDM/STM */
+  ldr r0, =_sdata
+  ldr r1, =_edata
+  ldr r2, =_sidata
+  b LoopCopyDataBlock
+
+CopyDataBlock:
+  ldmia r2!, {r3, r4, r5, r6}
+  stmia r0!, {r3, r4, r5, r6}
+
+LoopCopyDataBlock:
+  adds r3, r0, #16
+  cmp r3, r1
+  bls CopyDataBlock
+  b LoopCopyDataWord
+
+/* 0..3 words left */
+CopyDataWord:
+  ldr r3, [r2], #4
+  str r3, [r0], #4
+
+LoopCopyDataWord:
+  cmp r0, r1
+  bcc CopyDataWord
+  BOOT_STAMP BOOT_DATA
+
+/* Zero fill the bss segment, 16 bytes per STM (.noinit is left alone) */
+  ldr r2, =_sbss
+  ldr r1, =_ebss
+  movs r3, #0
+  movs r4, #0
+  movs r5, #0
+  movs r6, #0
+  b LoopFillZeroBlock
+
+FillZeroBlock:
+  stmia r2!, {r3, r4, r5, r6}
+
+LoopFillZeroBlock:
+  adds r0, r2, #16
+  cmp r0, r1
+  bls FillZeroBlock
+  b LoopFillZerobss
+
+/* 0..3 words left */
+FillZerobss:
+  str r3, [r2], #4
+
+LoopFillZerobss:
+  cmp r2, r1
+  bcc FillZerobss
+  BOOT_STAMP BOOT_BSS
+.endif
 
 /* Call the clock system initialization function.*/
   bl  SystemInit   
-/* Call static constructors */
-    bl __libc_init_array
+  BOOT_STAMP BOOT_SYSINIT
+/* Call static constructors: every .preinit_array, then .init_array entry,
+   as __libc_init_array does, without its call to the empty _init(). The
+   arrays are never empty (crtbegin.o puts frame_dummy in .init_array), so
+   this is a walk of a few words, not a skip. r4, r5 survive the calls. */
+  ldr r4, =__preinit_array_start
+  ldr r5, =__preinit_array_end
+  b LoopPreinitArray
+
+CallPreinitArray:
+  ldr r3, [r4], #4
+  blx r3
+
+LoopPreinitArray:
+  cmp r4, r5
+  bcc CallPreinitArray
+
+  ldr r4, =__init_array_start
+  ldr r5, =__init_array_end
+  b LoopInitArray
+
+CallInitArray:
+  ldr r3, [r4], #4
+  blx r3
+
+LoopInitArray:
+  cmp r4, r5
+  bcc CallInitArray
+  BOOT_STAMP BOOT_CTORS
 /* Call the application's entry point.*/
   bl  main
   bx  lr    
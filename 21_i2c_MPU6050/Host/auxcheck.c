@@ -0,0 +1,268 @@
+/**
+ * auxcheck.c
+ *	@brief Linux CLI: MPU6050 auxiliary I2C master, 9 axis samples in one burst
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -o auxcheck auxcheck.c ../Core/Src/MPU6050.c
+ *
+ * Usage:
+ *  auxcheck [samples]		default 10000
+ *
+ * MPU6050.c runs on a stub of i2c.c backed by a register model of the
+ * MPU6050 and of an HMC5883L magnetometer on its auxiliary bus (XDA/XCL,
+ * 7 bit address 0x1E). At every sample the model updates the data
+ * registers and, with the master on, runs what slave 0 is set to: len
+ * bytes from the magnetometer into EXT_SENS_DATA_00. A slave 4 write goes
+ * out slv4_delay reads after I2C_SLV4_EN is written (0: at the next poll)
+ * and sets SLV4_DONE or SLV4_NACK in I2C_MST_STATUS (cleared when read). Interrupt driven reads complete at
+ * once. Every transaction from the STM32 is counted.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  aux write      magnetometer set to continuous mode through slave 4;
+ *                 a sensor that is not there NACKs
+ *  slow rate      at 4 Hz slave 4 goes out a whole sample period after the
+ *                 write, hundreds of polls later: still done, not a timeout
+ *  slave 0        master on at 400 kHz, bypass off, slave 0 reading 6 bytes
+ *                 from DATA_X_H; 1 write (the master is on since the aux write)
+ *  9 axis         every sample one burst of 20 bytes: accel, temp, gyro and
+ *                 the magnetometer of the same sample; half the
+ *                 transactions of reading the magnetometer separately
+ *  limits         len > MPU6050_AUX_MAX and a read in flight are refused
+ *  slave 0 off    len 0: slave 0 disabled, back to the 14 byte burst
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "stm32f4xx.h"
+#include "MPU6050.h"
+
+#define MAG_ADDR				(0x1E)		// HMC5883L, 7 bit
+#define MAG_MODE_R				(0x02)		// 0: continuous, 1: single, reset 1
+#define MAG_DATA_R				(0x03)		// X, Z, Y, big endian
+#define MAG_DATA_LEN			(6)
+#define MAG_ID_R				(0x0A)		// "H43"
+
+/* the register models */
+static uint8_t mpu[128];
+static uint8_t mag[16];
+static uint32_t transactions, sample_no;
+static uint32_t slv4_delay, slv4_wait;		// reads from I2C_SLV4_EN to the slave 4 write
+static int posted;
+static I2C_TypeDef i2c_regs = { .CR1 = I2C_CR1_PE };
+i2c_handle_t i2c1 = { .regs = &i2c_regs };
+
+static mpu6050_t dev = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+static int failed;
+
+/**
+ * void slv4(void)
+ * @brief the auxiliary master runs slave 4 (single byte write or read)
+ */
+static void slv4(void){
+	uint8_t addr = mpu[I2C_SLV4_ADDR_R];
+
+	mpu[I2C_SLV4_CTRL_R] &= ~MPU6050_I2C_SLV_EN;
+	if(!(mpu[USER_CTRL_R] & MPU6050_I2C_MST_EN) || (addr & 0x7F) != MAG_ADDR){
+		mpu[I2C_MST_STATUS_R] |= MPU6050_I2C_SLV4_NACK;
+		return;
+	}
+	if(addr & MPU6050_I2C_SLV_RNW){
+		mpu[0x35] = mag[mpu[I2C_SLV4_REG_R] & 0x0F];		// I2C_SLV4_DI
+	}else if(mpu[I2C_SLV4_REG_R] <= MAG_MODE_R){
+		mag[mpu[I2C_SLV4_REG_R]] = mpu[I2C_SLV4_DO_R];
+	}
+	mpu[I2C_MST_STATUS_R] |= MPU6050_I2C_SLV4_DONE;
+}
+
+/**
+ * void sample(void)
+ * @brief one sample period: new accel, temp, gyro and magnetometer data, then slave 0
+ */
+static void sample(void){
+	uint8_t ctrl = mpu[I2C_SLV0_CTRL_R];
+
+	sample_no++;
+	for(int k = 0; k < MPU6050_BURST_LEN; k++){
+		mpu[ACCEL_XOUT_H_REG + k] = (uint8_t)(sample_no * 3 + k);
+	}
+	if(mag[MAG_MODE_R] == 0){
+		for(int k = 0; k < MAG_DATA_LEN; k++){
+			mag[MAG_DATA_R + k] = (uint8_t)(sample_no * 5 + 0x80 + k);
+		}
+	}
+	if((mpu[USER_CTRL_R] & MPU6050_I2C_MST_EN) && !(mpu[INT_PIN_CFG_R] & MPU6050_I2C_BYPASS_EN)
+			&& (ctrl & MPU6050_I2C_SLV_EN) && (mpu[I2C_SLV0_ADDR_R] & MPU6050_I2C_SLV_RNW)
+			&& (mpu[I2C_SLV0_ADDR_R] & 0x7F) == MAG_ADDR){
+		for(int k = 0; k < (ctrl & MPU6050_I2C_SLV_LEN); k++){
+			mpu[EXT_SENS_DATA_00_R + k] = mag[(mpu[I2C_SLV0_REG_R] + k) & 0x0F];
+		}
+	}
+}
+
+void i2c_init(i2c_handle_t *h){
+}
+
+int i2c_busy(const i2c_handle_t *h){
+	return 0;
+}
+
+int i2c_burst_read(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	transactions++;
+	for(int i = 0; i < n; i++){
+		uint8_t reg = ((uint8_t)maddr + i) & 0x7F;
+
+		data[i] = (char)mpu[reg];
+		if(reg == I2C_MST_STATUS_R){
+			mpu[reg] = 0;
+		}
+	}
+	/* slave 4 goes out at the next sample, slv4_delay polls later */
+	if(mpu[I2C_SLV4_CTRL_R] & MPU6050_I2C_SLV_EN){
+		if(slv4_wait){
+			slv4_wait--;
+		}else{
+			slv4();
+		}
+	}
+	return 0;
+}
+
+int i2c_byte_read(i2c_handle_t *h, char saddr, char maddr, char* data){
+	return i2c_burst_read(h, saddr, maddr, 1, data);
+}
+
+int i2c_burst_write(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	transactions++;
+	for(int i = 0; i < n; i++){
+		uint8_t reg = ((uint8_t)maddr + i) & 0x7F;
+
+		mpu[reg] = (uint8_t)data[i];
+		if(reg == I2C_SLV4_CTRL_R && (data[i] & MPU6050_I2C_SLV_EN)){
+			slv4_wait = slv4_delay;
+		}
+	}
+	return 0;
+}
+
+int i2c_burst_read_it(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint8_t task, uint8_t sig){
+	i2c_burst_read(h, saddr, maddr, n, data);
+	posted = n;
+	return 0;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * void sensors_reset(void)
+ * @brief power-on values of both models
+ */
+static void sensors_reset(void){
+	memset(mpu, 0, sizeof(mpu));
+	mpu[PWR_MGMT_1_R] = 0x40;
+	mpu[WHO_AM_I_R] = MPU6050_WHO_AM_I;
+	memset(mag, 0, sizeof(mag));
+	mag[0] = 0x10;
+	mag[1] = 0x20;
+	mag[MAG_MODE_R] = 0x01;
+	memcpy(&mag[MAG_ID_R], "H43", 3);
+}
+
+/**
+ * int read_sample(mpu6050_raw_t *s)
+ * @brief one data burst as the IMU task does it
+ */
+static int read_sample(mpu6050_raw_t *s){
+	posted = 0;
+	if(MPU6050_read_all_IT(&dev, 0, 0) != 0 || posted != MPU6050_BURST_LEN + dev.aux_len){
+		return -1;
+	}
+	MPU6050_read_done(&dev);
+	return mpu6050_ring_pop(&dev.samples, s);
+}
+
+int main(int argc, char **argv){
+	uint32_t samples = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : 10000U;
+	mpu6050_raw_t s;
+	uint32_t bad = 0;
+	int ok;
+
+	/* DWT->CYCCNT stamps the samples */
+	if(mmap((void *)0xE0000000UL, 0x10000, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void *)0xE0000000UL){
+		fprintf(stderr, "auxcheck: cannot map the core peripherals\n");
+		return 2;
+	}
+	sensors_reset();
+	if(MPU6050_init(&dev) != 0){
+		check("init", 0);
+		return failed;
+	}
+
+	/*aux write*/
+	ok = MPU6050_aux_write(&dev, MAG_ADDR, MAG_MODE_R, 0x00) == 0 && mag[MAG_MODE_R] == 0;
+	ok &= MPU6050_aux_write(&dev, 0x2A, 0x00, 0x55) == -1;
+	check("aux write", ok);
+
+	/*slow rate*/
+	ok = MPU6050_retune(&dev, 4, 0) == 0;
+	slv4_delay = 1000000U / 4U / MPU6050_AUX_READ_US;		// one sample period of polls
+	ok &= MPU6050_aux_write(&dev, MAG_ADDR, MAG_MODE_R, 0x01) == 0 && mag[MAG_MODE_R] == 1;
+	printf("  slow rate: %u polls for one sample period, %u allowed\n", slv4_delay,
+			MPU6050_AUX_POLLS(dev.filter.rate_mhz));
+	slv4_delay = 0;
+	ok &= MPU6050_retune(&dev, 1000, 0) == 0 && MPU6050_aux_write(&dev, MAG_ADDR, MAG_MODE_R, 0x00) == 0;
+	check("slow rate", ok && mag[MAG_MODE_R] == 0);
+
+	/*slave 0*/
+	transactions = 0;
+	ok = MPU6050_aux_slv0(&dev, MAG_ADDR, MAG_DATA_R, MAG_DATA_LEN) == 0 && dev.aux_len == MAG_DATA_LEN;
+	printf("  slave 0 setup: %u transactions\n", transactions);
+	check("slave 0", ok && transactions == 1 && mpu[I2C_SLV0_ADDR_R] == (0x80 | MAG_ADDR)
+			&& mpu[I2C_SLV0_REG_R] == MAG_DATA_R && mpu[I2C_SLV0_CTRL_R] == (0x80 | MAG_DATA_LEN)
+			&& mpu[I2C_MST_CTRL_R] == (MPU6050_WAIT_FOR_ES | MPU6050_I2C_MST_CLK_400K)
+			&& (mpu[USER_CTRL_R] & MPU6050_I2C_MST_EN) && !(mpu[INT_PIN_CFG_R] & MPU6050_I2C_BYPASS_EN));
+
+	/*9 axis*/
+	transactions = 0;
+	for(uint32_t i = 0; i < samples; i++){
+		sample();
+		if(read_sample(&s) != 0){
+			bad++;
+			continue;
+		}
+		for(int k = 0; k < MPU6050_BURST_LEN; k++){
+			bad += s.raw[k] != (uint8_t)(sample_no * 3 + k);
+		}
+		for(int k = 0; k < MAG_DATA_LEN; k++){
+			bad += s.raw[MPU6050_BURST_LEN + k] != (uint8_t)(sample_no * 5 + 0x80 + k);
+		}
+	}
+	printf("  %u samples: %u transactions from the STM32, %u reading the magnetometer separately\n",
+			samples, transactions, 2 * samples);
+	check("9 axis", bad == 0 && transactions == samples);
+
+	/*limits*/
+	ok = MPU6050_aux_slv0(&dev, MAG_ADDR, MAG_DATA_R, MPU6050_AUX_MAX + 1) == -1 && dev.aux_len == MAG_DATA_LEN;
+	dev.reading = 1;
+	ok &= MPU6050_aux_slv0(&dev, MAG_ADDR, MAG_DATA_R, 2) == -1;
+	dev.reading = 0;
+	check("limits", ok);
+
+	/*slave 0 off*/
+	ok = MPU6050_aux_slv0(&dev, 0, 0, 0) == 0 && dev.aux_len == 0 && !(mpu[I2C_SLV0_CTRL_R] & MPU6050_I2C_SLV_EN);
+	sample();
+	ok &= read_sample(&s) == 0;
+	check("slave 0 off", ok);
+	return failed;
+}
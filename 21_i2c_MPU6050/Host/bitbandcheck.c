@@ -0,0 +1,127 @@
+/**
+ * bitbandcheck.c
+ *	@brief Linux CLI: check the bit-band alias computation of bitband.h
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -I../Core/Inc -o bitbandcheck bitbandcheck.c
+ *
+ * Usage:
+ *  bitbandcheck
+ *
+ * Checks, each printed as ok/FAIL:
+ *  manual         the mapping examples of PM0214 2.2.5
+ *  registers      the register bits the drivers set and clear, against
+ *                 aliases worked out by hand from the RM0383 memory map
+ *  formula        every byte of both regions and every bit against
+ *                 alias base + offset * 32 + bit * 4, and back
+ *  word bits      bit n of a word is bit n % 8 of byte n / 8 (little endian),
+ *                 so a word address with bits 0..31 reaches the same aliases
+ *  regions        BB_IN_REGION at the edges of both regions
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "bitband.h"
+
+static int failed;
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * int manual(void)
+ * @brief PM0214: 0x23FFFFE0 is bit 0 of 0x200FFFFF, 0x2200001C bit 7 of 0x20000000 ...
+ */
+static int manual(void){
+	return BB_ALIAS(0x200FFFFFU, 0) == 0x23FFFFE0U
+		&& BB_ALIAS(0x200FFFFFU, 7) == 0x23FFFFFCU
+		&& BB_ALIAS(0x20000000U, 0) == 0x22000000U
+		&& BB_ALIAS(0x20000000U, 7) == 0x2200001CU;
+}
+
+/**
+ * int registers(void)
+ * @brief bits used by i2c.c, uart.c, crc.c and spi.c
+ */
+static int registers(void){
+	return BB_ALIAS(0x40005400U, 8) == 0x420A8020U		// I2C1->CR1 START
+		&& BB_ALIAS(0x40005400U, 9) == 0x420A8024U		// I2C1->CR1 STOP
+		&& BB_ALIAS(0x40005404U, 10) == 0x420A80A8U		// I2C1->CR2 ITBUFEN
+		&& BB_ALIAS(0x4000440CU, 13) == 0x420881B4U		// USART2->CR1 UE
+		&& BB_ALIAS(0x400260A0U, 0) == 0x424C1400U		// DMA1_Stream6->CR EN
+		&& BB_ALIAS(0x40026410U, 0) == 0x424C8200U		// DMA2_Stream0->CR EN
+		&& BB_ALIAS(0x40020014U, 9) == 0x424002A4U;		// GPIOA->ODR OD9
+}
+
+/**
+ * int formula(void)
+ * @brief every byte and bit of both regions, forward and back
+ */
+static int formula(void){
+	static const uint32_t base[2] = { BB_SRAM_BASE, BB_PERIPH_BASE };
+	static const uint32_t alias[2] = { BB_SRAM_ALIAS, BB_PERIPH_ALIAS };
+	uint32_t a;
+
+	for(int r = 0; r < 2; r++){
+		for(uint32_t off = 0; off < BB_REGION_SIZE; off++){
+			for(uint32_t bit = 0; bit < 8; bit++){
+				a = BB_ALIAS(base[r] + off, bit);
+				if(a != alias[r] + off * 32U + bit * 4U){
+					return 0;
+				}
+				if((a - alias[r]) / 32U != off || ((a - alias[r]) % 32U) / 4U != bit){
+					return 0;
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+/**
+ * int word_bits(void)
+ * @brief a word address plus bit n is the byte address + n / 8 plus bit n % 8
+ */
+static int word_bits(void){
+	uint32_t words[] = { BB_SRAM_BASE, BB_SRAM_BASE + 0x1FFFCU, BB_PERIPH_BASE + 0x5400U, BB_PERIPH_BASE + BB_REGION_SIZE - 4U };
+
+	for(uint32_t i = 0; i < sizeof(words) / sizeof(words[0]); i++){
+		for(uint32_t bit = 0; bit < 32; bit++){
+			if(BB_ALIAS(words[i], bit) != BB_ALIAS(words[i] + bit / 8U, bit % 8U)){
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/**
+ * int regions(void)
+ * @brief inside and just outside both regions; the core registers are outside
+ */
+static int regions(void){
+	return !BB_IN_REGION(0x1FFFFFFFU)
+		&& BB_IN_REGION(0x20000000U)
+		&& BB_IN_REGION(0x200FFFFFU)
+		&& !BB_IN_REGION(0x20100000U)
+		&& !BB_IN_REGION(0x3FFFFFFFU)
+		&& BB_IN_REGION(0x40000000U)
+		&& BB_IN_REGION(0x400FFFFFU)
+		&& !BB_IN_REGION(0x40100000U)
+		&& !BB_IN_REGION(0x50000000U)		// USB OTG FS, AHB2
+		&& !BB_IN_REGION(0xE000E010U)		// SysTick
+		&& !BB_IN_REGION(0xE0001004U);		// DWT->CYCCNT
+}
+
+int main(void){
+	check("manual", manual());
+	check("registers", registers());
+	check("formula", formula());
+	check("word bits", word_bits());
+	check("regions", regions());
+	return failed;
+}
@@ -0,0 +1,148 @@
+/**
+ * compbench.c
+ *	@brief Linux CLI: compression ratio and speed of compress.c on a recorded IMU trace
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -I../Core/Inc -o compbench compbench.c ../Core/Src/compress.c
+ *
+ * Record a trace from the board streaming raw frames ("stream raw" command),
+ * then run the compressor over it for several batch sizes and keyframe
+ * intervals:
+ *  ./telemcat -v /dev/ttyACM0 > trace.txt
+ *  ./compbench trace.txt
+ *
+ * Input lines are "type seq stamp v0 .. v6" as printed by telemcat -v; type 1
+ * lines (accel x,y,z, temperature, gyro x,y,z) are used without the
+ * temperature. Lines of six plain integers are accepted too.
+ *
+ * For each setting it prints payload bytes per sample against the 12 raw
+ * bytes, wire bytes per sample with telemetry framing, host ns per sample,
+ * and checks that decoding gives back the trace exactly. Cycles per sample
+ * on the M4 come from bench_compress() (bench.c). The firmware sends
+ * batches of IMU_BATCH (8); larger batches no longer fit one telemetry
+ * frame (TELEM_MAX_PAYLOAD) and are listed for comparison only.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "compress.h"
+#include "telemetry.h"
+
+#define CHANNELS				(6)
+#define RAW_BYTES				(2 * CHANNELS)
+
+/**
+ * int16_t *load_trace(const char *path, size_t *count)
+ * @brief read samples from a telemcat -v dump or plain six column text
+ */
+static int16_t *load_trace(const char *path, size_t *count){
+	FILE *f = strcmp(path, "-") ? fopen(path, "r") : stdin;
+	char line[512];
+	int16_t *trace = 0;
+	size_t n = 0, cap = 0;
+	long v[10];
+	int k;
+
+	if(!f){
+		perror(path);
+		return 0;
+	}
+	while(fgets(line, sizeof(line), f)){
+		char *p = line, *q;
+
+		for(k = 0; k < 10; k++){
+			v[k] = strtol(p, &q, 10);
+			if(q == p){
+				break;
+			}
+			p = q;
+		}
+		if(n == cap){
+			cap = cap ? 2 * cap : 4096;
+			trace = realloc(trace, cap * CHANNELS * sizeof(int16_t));
+		}
+		if(k == 10 && v[0] == TELEM_TYPE_IMU_RAW){
+			int16_t s[CHANNELS] = {v[3], v[4], v[5], v[7], v[8], v[9]};
+			memcpy(&trace[n++ * CHANNELS], s, sizeof(s));
+		}else if(k == CHANNELS){
+			for(int c = 0; c < CHANNELS; c++){
+				trace[n * CHANNELS + c] = (int16_t)v[c];
+			}
+			n++;
+		}
+	}
+	if(f != stdin){
+		fclose(f);
+	}
+	*count = n;
+	return trace;
+}
+
+/**
+ * void run(const int16_t *trace, size_t count, uint8_t batch, uint8_t keyframe_every)
+ * @brief compress and decompress the whole trace with one setting and print the figures
+ */
+static void run(const int16_t *trace, size_t count, uint8_t batch, uint8_t keyframe_every){
+	static uint8_t block[COMP_BLOCK_MAX(CHANNELS, COMP_MAX_SAMPLES)];
+	static int16_t out[COMP_MAX_SAMPLES * CHANNELS];
+	comp_encoder_t enc;
+	comp_decoder_t dec;
+	struct timespec t0, t1;
+	size_t payload = 0, wire = 0, mismatches = 0;
+	double ns = 0;
+	uint32_t len;
+	uint8_t n;
+	int got;
+
+	comp_encoder_init(&enc, CHANNELS, keyframe_every);
+	comp_decoder_init(&dec);
+	for(size_t i = 0; i + batch <= count; i += batch){
+		n = batch;
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		len = comp_encode(&enc, &trace[i * CHANNELS], n, block);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		ns += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+		payload += len;
+		wire += TELEM_WIRE_LEN(len);
+
+		got = comp_decode(&dec, block, len, out, COMP_MAX_SAMPLES);
+		if(got != n || memcmp(out, &trace[i * CHANNELS], n * CHANNELS * sizeof(int16_t))){
+			mismatches++;
+		}
+	}
+	count -= count % batch;
+	printf("%5u %5u   %6.2f   %5.2fx   %6.2f   %6.1f   %zu\n", batch, keyframe_every,
+			(double)payload / count, (double)RAW_BYTES * count / payload,
+			(double)wire / count, ns / count, mismatches);
+}
+
+int main(int argc, char **argv){
+	static const uint8_t batches[] = {1, 4, 8, 16, 32};
+	static const uint8_t keys[] = {1, 8, 32};
+	int16_t *trace;
+	size_t count;
+
+	if(argc < 2){
+		fprintf(stderr, "usage: %s <trace.txt|->\n", argv[0]);
+		return 2;
+	}
+	trace = load_trace(argv[1], &count);
+	if(!trace || count < 32){
+		fprintf(stderr, "need at least 32 samples\n");
+		return 1;
+	}
+
+	printf("%zu samples, %d raw bytes each\n", count, RAW_BYTES);
+	printf("batch   key  B/smp    ratio   wire B/smp  ns/smp  mismatches\n");
+	for(size_t b = 0; b < sizeof(batches); b++){
+		for(size_t k = 0; k < sizeof(keys); k++){
+			run(trace, count, batches[b], keys[k]);
+		}
+	}
+	free(trace);
+	return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * dlpfcheck.c
+ *	@brief Linux CLI: MPU6050 DLPF_CFG / SMPLRT_DIV solver and run time retuning
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -o dlpfcheck dlpfcheck.c ../Core/Src/MPU6050.c
+ *
+ * Usage:
+ *  dlpfcheck [max rate]		default every rate 1..9000 Hz
+ *
+ * MPU6050_filter_solve() is compared with a brute force search over all 7
+ * filters and 256 dividers, written from the register map table. Retuning
+ * runs MPU6050.c on a stub of the blocking i2c.c calls that logs every
+ * transaction.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  default        1 kHz, no bandwidth asked: DLPF off, SMPLRT_DIV 7 as before
+ *  examples       250 Hz -> 98 Hz filter, SMPLRT_DIV 3; 333 Hz -> 333.333 Hz;
+ *                 the limits 3.906 Hz and 8 kHz; rate 0 refused
+ *  brute force    every rate with bandwidth 0, the table bandwidths and their
+ *                 neighbours: same filter and divider as the search, nearest
+ *                 rate, aliasing and accelerometer flags consistent
+ *  retune         one burst, no read, EXT_SYNC_SET kept; same values again:
+ *                 no transaction; with the bus busy it waits for the flush
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "MPU6050.h"
+
+/* register map 4.3 */
+static const uint16_t gyro_bw[MPU6050_DLPF_CFGS] = { 256, 188, 98, 42, 20, 10, 5 };
+static const uint16_t gyro_delay[MPU6050_DLPF_CFGS] = { 980, 1900, 2800, 4800, 8300, 13400, 18600 };
+static const uint16_t accel_bw[MPU6050_DLPF_CFGS] = { 260, 184, 94, 44, 21, 10, 5 };
+
+/* the stub sensor and its transaction log */
+static uint8_t regs[128];
+static uint32_t reads, writes, last_reg, last_len;
+static int busy;
+static I2C_TypeDef i2c_regs = { .CR1 = I2C_CR1_PE };
+i2c_handle_t i2c1 = { .regs = &i2c_regs };
+
+static int failed;
+
+void i2c_init(i2c_handle_t *h){
+}
+
+int i2c_busy(const i2c_handle_t *h){
+	return busy;
+}
+
+int i2c_burst_read_it(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint8_t task, uint8_t sig){
+	return -1;
+}
+
+int i2c_burst_read(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	reads++;
+	for(int i = 0; i < n; i++){
+		data[i] = (char)regs[((uint8_t)maddr + i) & 0x7F];
+	}
+	return 0;
+}
+
+int i2c_byte_read(i2c_handle_t *h, char saddr, char maddr, char* data){
+	return i2c_burst_read(h, saddr, maddr, 1, data);
+}
+
+int i2c_burst_write(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	writes++;
+	last_reg = (uint8_t)maddr;
+	last_len = n;
+	for(int i = 0; i < n; i++){
+		regs[((uint8_t)maddr + i) & 0x7F] = (uint8_t)data[i];
+	}
+	return 0;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * void reference(uint32_t rate, uint32_t bw, int *cfg, int *div)
+ * @brief the filter by its definition, the divider by trying all 256
+ */
+static void reference(uint32_t rate, uint32_t bw, int *cfg, int *div){
+	double best = 1e30;
+
+	*cfg = -1;
+	*div = 0;
+	for(int c = 0; c < MPU6050_DLPF_CFGS; c++){
+		if(bw == 0 && 2U * gyro_bw[c] <= rate && (*cfg < 0 || gyro_bw[c] > gyro_bw[*cfg])){
+			*cfg = c;
+		}
+		if(bw != 0 && gyro_bw[c] >= bw && (*cfg < 0 || gyro_bw[c] < gyro_bw[*cfg])){
+			*cfg = c;
+		}
+	}
+	if(*cfg < 0){
+		*cfg = (bw == 0) ? MPU6050_DLPF_CFGS - 1 : 0;
+	}
+	for(int d = 0; d < 256; d++){
+		double err = (*cfg ? 1000.0 : 8000.0) / (1 + d) - rate;
+
+		if(err < 0){
+			err = -err;
+		}
+		if(err < best - 1e-9){
+			best = err;
+			*div = d;
+		}
+	}
+}
+
+static int solves_to(uint16_t rate, uint16_t bw, int cfg, int div, uint32_t rate_mhz){
+	mpu6050_filter_t f;
+
+	return MPU6050_filter_solve(rate, bw, &f) == 0 && f.dlpf_cfg == cfg && f.smplrt_div == div
+		&& f.rate_mhz == rate_mhz;
+}
+
+int main(int argc, char **argv){
+	uint32_t max_rate = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : 9000U;
+	mpu6050_filter_t f;
+	mpu6050_t dev = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+	int ok;
+
+	/*default*/
+	ok = MPU6050_filter_solve(dev.rate_hz, dev.bandwidth_hz, &f) == 0;
+	check("default", ok && f.dlpf_cfg == 0 && f.smplrt_div == 7 && f.rate_mhz == 1000000 && !f.aliased);
+
+	/*examples*/
+	ok = MPU6050_filter_solve(250, 0, &f) == 0 && f.dlpf_cfg == 2 && f.smplrt_div == 3
+		&& f.gyro_bw_hz == 98 && f.accel_bw_hz == 94 && f.gyro_delay_us == 2800 && f.accel_delay_us == 3000;
+	printf("  250 Hz: DLPF_CFG %u, SMPLRT_DIV %u, %u.%03u Hz, bw %u Hz, delay %u us\n", f.dlpf_cfg,
+			f.smplrt_div, f.rate_mhz / 1000, f.rate_mhz % 1000, f.gyro_bw_hz, f.gyro_delay_us);
+	ok &= solves_to(333, 0, 2, 2, 333333);
+	ok &= solves_to(1, 0, 6, 255, 3906) && MPU6050_filter_solve(1, 0, &f) == 0 && f.aliased;
+	ok &= solves_to(20000, 0, 0, 0, 8000000) && MPU6050_filter_solve(20000, 0, &f) == 0 && f.accel_repeats;
+	ok &= solves_to(100, 300, 0, 79, 100000) && MPU6050_filter_solve(100, 300, &f) == 0 && f.aliased;
+	ok &= solves_to(100, 21, 3, 9, 100000);
+	ok &= MPU6050_filter_solve(0, 0, &f) == -1;
+	check("examples", ok);
+
+	/*brute force*/
+	uint32_t bad = 0, solves = 0;
+	uint32_t bws[3 * MPU6050_DLPF_CFGS + 2];
+	int nbw = 0;
+
+	bws[nbw++] = 0;
+	bws[nbw++] = 300;
+	for(int c = 0; c < MPU6050_DLPF_CFGS; c++){
+		bws[nbw++] = gyro_bw[c] - 1;
+		bws[nbw++] = gyro_bw[c];
+		bws[nbw++] = gyro_bw[c] + 1;
+	}
+	for(uint32_t rate = 1; rate <= max_rate && rate <= UINT16_MAX; rate++){
+		for(int b = 0; b < nbw; b++){
+			int cfg, div;
+			uint32_t gyro, want;
+
+			reference(rate, bws[b], &cfg, &div);
+			gyro = cfg ? 1000U : 8000U;
+			want = (gyro * 1000U + (div + 1) / 2) / (div + 1);
+			solves++;
+			if(MPU6050_filter_solve((uint16_t)rate, (uint16_t)bws[b], &f) != 0 || f.dlpf_cfg != cfg
+					|| f.smplrt_div != div || f.rate_mhz != want || f.gyro_bw_hz != gyro_bw[cfg]
+					|| f.accel_bw_hz != accel_bw[cfg] || f.gyro_delay_us != gyro_delay[cfg]
+					|| f.aliased != (2000U * gyro_bw[cfg] > want) || f.accel_repeats != (want > 1000000U)){
+				if(bad++ < 5){
+					printf("  rate %u bw %u: got %u/%u, want %u/%u\n", rate, bws[b], f.dlpf_cfg, f.smplrt_div, cfg, div);
+				}
+			}
+		}
+	}
+	printf("  %u solves, %u differ\n", solves, bad);
+	check("brute force", bad == 0);
+
+	/*retune*/
+	memset(regs, 0, sizeof(regs));
+	regs[PWR_MGMT_1_R] = 0x40;
+	regs[WHO_AM_I_R] = MPU6050_WHO_AM_I;
+	ok = MPU6050_init(&dev) == 0;
+	MPU6050_update(&dev, CONFIG_R, 0x38, 1 << 3);		// EXT_SYNC_SET: TEMP_OUT_L
+	MPU6050_flush(&dev);
+	reads = writes = 0;
+	ok &= MPU6050_retune(&dev, 250, 0) == 0 && reads == 0 && writes == 1 && last_reg == SMPLRT_DIV_R && last_len == 2
+		&& regs[SMPLRT_DIV_R] == 3 && regs[CONFIG_R] == ((1 << 3) | 2) && dev.filter.rate_mhz == 250000;
+	writes = 0;
+	ok &= MPU6050_retune(&dev, 250, 0) == 0 && writes == 0;
+	busy = 1;
+	ok &= MPU6050_retune(&dev, 50, 10) == 0 && writes == 0 && dev.filter.dlpf_cfg == 5;
+	busy = 0;
+	ok &= MPU6050_flush(&dev) == 1 && regs[SMPLRT_DIV_R] == 19 && regs[CONFIG_R] == ((1 << 3) | 5);
+	ok &= MPU6050_retune(&dev, 0, 0) == -1 && dev.rate_hz == 50;
+	dev.rate_hz = 0;
+	ok &= MPU6050_init(&dev) == -1 && !dev.present;
+	check("retune", ok);
+	return failed;
+}
@@ -0,0 +1,273 @@
+/**
+ * fmtcheck.c
+ *	@brief Linux CLI: compare fmt.c with the C library printf over a randomized corpus
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -I../Core/Inc -o fmtcheck fmtcheck.c ../Core/Src/fmt.c -lm
+ *
+ * Usage:
+ *  fmtcheck [cases] [seed]		default 1000000 cases, seed 1
+ *
+ * Every case builds a random conversion (flags, width and precision, also
+ * through *, length modifier) with a random argument, formats it with
+ * fmt_snprintf and snprintf into a buffer of random size and compares the
+ * text and the return value. %q is compared with %f of the exact double
+ * raw * 2^-b, %k with the same digits put together by hand. Float arguments
+ * mix sensor-like float values, doubles across the supported range, exact
+ * halves (rounding ties), zero, -0, inf and nan. The first mismatches are
+ * printed; the exit status is 1 if there was any.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fmt.h"
+
+#define OUT_LEN					(256)
+#define SHOW_MAX				(20)
+#define STAR_NONE				(-1000)
+
+/* same arguments through both formatters */
+#define FMT_BOTH(...)			do{ rg = fmt_snprintf(got, size, spec, __VA_ARGS__); \
+									rw = snprintf(want, size, spec, __VA_ARGS__); }while(0)
+
+static uint64_t rng_state;
+
+/**
+ * uint64_t rnd(void)
+ * @brief xorshift64*
+ */
+static uint64_t rnd(void){
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t rnd_below(uint32_t n){
+	return (uint32_t)(rnd() % n);
+}
+
+/**
+ * double rnd_double(void)
+ * @brief a float argument from one of several families
+ */
+static double rnd_double(void){
+	double x;
+
+	switch(rnd_below(8)){
+	case 0:		return (float)((int16_t)rnd() / 16384.0);		// accel in g, as the firmware computes it
+	case 1:		return (float)((int16_t)rnd() / 131.0);		// gyro in deg/s
+	case 2:		return ldexp((double)(int64_t)(rnd() >> 11), (int)rnd_below(60) - 70);
+	case 3:		return ldexp((double)(int64_t)(rnd() >> 11), -(int)rnd_below(53));
+	case 4:		return (double)((int32_t)rnd_below(2000) - 1000) / 8.0 + ((rnd() & 1) ? 0.5 / pow(10, rnd_below(6)) : 0);
+	case 5:		return ldexp((double)(rnd() >> 11), (int)rnd_below(12));	// up to 2^64
+	case 6:
+		x = ldexp(1.0, -(int)rnd_below(1070));
+		return (rnd() & 1) ? -x : x;
+	default:
+		switch(rnd_below(5)){
+		case 0:		return 0.0;
+		case 1:		return -0.0;
+		case 2:		return (rnd() & 1) ? INFINITY : -INFINITY;
+		case 3:		return NAN;
+		default:	return 0.5;
+		}
+	}
+}
+
+/**
+ * void build_spec(char *spec, const char *flags_allowed, const char *len, char conv, int prec_max, int *star_w, int *star_p)
+ * @brief random "%<flags><width><.prec><len><conv>"; * values are returned through star_w/star_p (STAR_NONE when unused)
+ */
+static void build_spec(char *spec, const char *flags_allowed, const char *len, char conv, int prec_max, int *star_w, int *star_p){
+	char *p = spec;
+
+	*p++ = '%';
+	for(const char *f = flags_allowed; *f; f++){
+		if(rnd_below(4) == 0){
+			*p++ = *f;
+		}
+	}
+	*star_w = STAR_NONE;
+	*star_p = STAR_NONE;
+	switch(rnd_below(4)){
+	case 0:		break;
+	case 1:		*star_w = (int)rnd_below(41) - 20; *p++ = '*'; break;
+	default:	p += sprintf(p, "%u", 1 + rnd_below(20)); break;
+	}
+	if(prec_max >= 0){
+		switch(rnd_below(4)){
+		case 0:		break;
+		case 1:		*star_p = (int)rnd_below((unsigned)prec_max + 1); p += sprintf(p, ".*"); break;
+		default:	p += sprintf(p, ".%u", rnd_below((unsigned)prec_max + 1)); break;
+		}
+	}
+	p += sprintf(p, "%s%c", len, conv);
+	*p = '\0';
+}
+
+/**
+ * int expect_k(char *out, size_t size, const char *flags, int width, long v, int prec)
+ * @brief what %k should print, put together from integer conversions
+ */
+static int expect_k(char *out, size_t size, const char *flags, int width, long v, int prec){
+	char body[64];
+	char head[2] = "";
+	unsigned long long mag = (v < 0) ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+	unsigned long long p10 = 1;
+	int left = strchr(flags, '-') != 0;
+	int zero = strchr(flags, '0') != 0 && !left;
+	int alt = strchr(flags, '#') != 0;
+	int n, pad;
+
+	for(int i = 0; i < prec; i++){
+		p10 *= 10;
+	}
+	if(v < 0) head[0] = '-';
+	else if(strchr(flags, '+')) head[0] = '+';
+	else if(strchr(flags, ' ')) head[0] = ' ';
+	if(prec > 0){
+		snprintf(body, sizeof(body), "%llu.%0*llu", mag / p10, prec, mag % p10);
+	}else{
+		snprintf(body, sizeof(body), "%llu%s", mag, alt ? "." : "");
+	}
+	n = (int)(strlen(head) + strlen(body));
+	pad = (width > n) ? width - n : 0;
+	if(left){
+		return snprintf(out, size, "%s%s%*s", head, body, pad, "");
+	}
+	if(zero){
+		return snprintf(out, size, "%s%.*s%s", head, pad, "00000000000000000000", body);
+	}
+	return snprintf(out, size, "%*s%s%s", pad, "", head, body);
+}
+
+int main(int argc, char **argv){
+	static const char *ilens[] = {"", "hh", "h", "l", "ll", "z"};
+	static const char iconvs[] = "diuxXo";
+	char spec[64];
+	char got[OUT_LEN], want[OUT_LEN];
+	long cases = (argc > 1) ? strtol(argv[1], 0, 10) : 1000000;
+	long bad = 0;
+	int star_w, star_p, rg, rw;
+	size_t size;
+	double x;
+
+	rng_state = (argc > 2) ? strtoull(argv[2], 0, 10) : 1;
+	if(rng_state == 0){
+		rng_state = 1;
+	}
+
+	for(long i = 0; i < cases; i++){
+		size = (rnd_below(8) == 0) ? rnd_below(16) : OUT_LEN;
+		memset(got, 'G', sizeof(got));
+		memset(want, 'W', sizeof(want));
+
+		switch(rnd_below(6)){
+
+		case 0:
+		case 1: {
+			/* integers */
+			const char *len = ilens[rnd_below(6)];
+			char conv = iconvs[rnd_below(6)];
+			long long v = (long long)rnd() >> rnd_below(64);
+			int is_signed = (conv == 'd' || conv == 'i');
+
+			build_spec(spec, is_signed ? "-+ 0" : "-#0", len, conv, 25, &star_w, &star_p);
+			if(star_w != STAR_NONE && star_p != STAR_NONE){
+				if(!strcmp(len, "ll")) FMT_BOTH(star_w, star_p, v);
+				else if(!strcmp(len, "l")) FMT_BOTH(star_w, star_p, (long)v);
+				else if(!strcmp(len, "z")) FMT_BOTH(star_w, star_p, (size_t)v);
+				else FMT_BOTH(star_w, star_p, (int)v);
+			}else if(star_w != STAR_NONE){
+				if(!strcmp(len, "ll")) FMT_BOTH(star_w, v);
+				else if(!strcmp(len, "l")) FMT_BOTH(star_w, (long)v);
+				else if(!strcmp(len, "z")) FMT_BOTH(star_w, (size_t)v);
+				else FMT_BOTH(star_w, (int)v);
+			}else if(star_p != STAR_NONE){
+				if(!strcmp(len, "ll")) FMT_BOTH(star_p, v);
+				else if(!strcmp(len, "l")) FMT_BOTH(star_p, (long)v);
+				else if(!strcmp(len, "z")) FMT_BOTH(star_p, (size_t)v);
+				else FMT_BOTH(star_p, (int)v);
+			}else{
+				if(!strcmp(len, "ll")) FMT_BOTH(v);
+				else if(!strcmp(len, "l")) FMT_BOTH((long)v);
+				else if(!strcmp(len, "z")) FMT_BOTH((size_t)v);
+				else FMT_BOTH((int)v);
+			}
+			break;
+		}
+
+		case 2: {
+			/* strings and characters */
+			static const char *strs[] = {"", "a", "imu", "hello world", "0123456789abcdef"};
+			const char *s = strs[rnd_below(5)];
+			char conv = (rnd() & 1) ? 's' : 'c';
+
+			build_spec(spec, "-", "", conv, (conv == 's') ? 20 : -1, &star_w, &star_p);
+			if(conv == 'c'){
+				int c = 32 + (int)rnd_below(95);
+				if(star_w != STAR_NONE) FMT_BOTH(star_w, c); else FMT_BOTH(c);
+			}else{
+				if(star_w != STAR_NONE && star_p != STAR_NONE) FMT_BOTH(star_w, star_p, s);
+				else if(star_w != STAR_NONE) FMT_BOTH(star_w, s);
+				else if(star_p != STAR_NONE) FMT_BOTH(star_p, s);
+				else FMT_BOTH(s);
+			}
+			break;
+		}
+
+		case 3:
+		case 4:
+			/* doubles */
+			x = rnd_double();
+			build_spec(spec, "-+ #0", "", (rnd_below(4) == 0) ? 'F' : 'f', FMT_FLOAT_PREC_MAX, &star_w, &star_p);
+			if(fabs(x) >= 18446744073709551616.0 && isfinite(x)){
+				x = 1.0;
+			}
+			if(star_w != STAR_NONE && star_p != STAR_NONE) FMT_BOTH(star_w, star_p, x);
+			else if(star_w != STAR_NONE) FMT_BOTH(star_w, x);
+			else if(star_p != STAR_NONE) FMT_BOTH(star_p, x);
+			else FMT_BOTH(x);
+			break;
+
+		default: {
+			/* %q against %f of the exact value, %k against integer conversions */
+			int32_t raw = (int32_t)rnd();
+			int b = (int)rnd_below(32);
+			int prec = (int)rnd_below(FMT_FLOAT_PREC_MAX + 1);
+			int width = (int)rnd_below(20);
+			const char *flags = (const char *[]){"", "-", "+", " ", "0", "#", "-+", "0+"}[rnd_below(8)];
+
+			if(rnd() & 1){
+				snprintf(spec, sizeof(spec), "%%%s%d.%dq", flags, width, prec);
+				rg = fmt_snprintf(got, size, spec, raw, b);
+				snprintf(spec, sizeof(spec), "%%%s%d.%df", flags, width, prec);
+				rw = snprintf(want, size, spec, ldexp(raw, -b));
+				snprintf(spec, sizeof(spec), "%%%s%d.%dq (%d, %d)", flags, width, prec, raw, b);
+			}else{
+				raw >>= rnd_below(31);
+				snprintf(spec, sizeof(spec), "%%%s%d.%dk", flags, width, prec);
+				rg = fmt_snprintf(got, size, spec, raw);
+				rw = expect_k(want, size, flags, width, raw, prec);
+				snprintf(spec, sizeof(spec), "%%%s%d.%dk (%d)", flags, width, prec, raw);
+			}
+			break;
+		}
+		}
+
+		if(rg != rw || (size && strcmp(got, want) != 0)){
+			if(bad++ < SHOW_MAX){
+				printf("mismatch: %-24s size %zu  fmt \"%s\" (%d)  libc \"%s\" (%d)\n",
+						spec, size, size ? got : "", rg, size ? want : "", rw);
+			}
+		}
+	}
+	printf("%ld cases, %ld mismatches\n", cases, bad);
+	return bad != 0;
+}
@@ -0,0 +1,247 @@
+/**
+ * gpiocheck.c
+ *	@brief Linux CLI: check the pin list folding of gpio.h
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -o gpiocheck gpiocheck.c
+ *
+ * Usage:
+ *  gpiocheck [rounds] [seed]		default 100000 random start states, seed 1
+ *
+ * Checks, each printed as ok/FAIL:
+ *  i2c1           I2C1_PINS (i2c.h) gives the same GPIOB registers as the
+ *                 hand-written shifts it replaced, from the reset state
+ *  lcd            the LCD pins (23_LCD) give the same registers as its
+ *                 MODER |= lines, from the reset state
+ *  reference      every test list, applied to random register contents,
+ *                 against a per-pin, per-field read-modify-write reference;
+ *                 bits of unlisted pins and PIN_KEEP fields must not change
+ *  unique/valid   GPIO_PINS_UNIQUE and GPIO_PINS_VALID reject a repeated
+ *                 pin and fields out of range (GPIO_CFG_DEFINE turns them
+ *                 into compile errors on the target)
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "gpio.h"
+#include "i2c.h"
+
+/* GPIOB after reset (RM0383 8.4): PB3/PB4 are JTAG */
+#define GPIOB_MODER_RESET		(0x00000280U)
+#define GPIOB_OSPEEDR_RESET		(0x000000C0U)
+#define GPIOB_PUPDR_RESET		(0x00000100U)
+
+/* 23_LCD/main.c: PC0..PC7 data, PB5..PB7 RS, R/W, EN, outputs */
+#define LCD_DATA_PINS(PIN) \
+	PIN(0, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(1, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(2, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(3, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(4, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(5, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(6, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(7, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0)
+#define LCD_CTRL_PINS(PIN) \
+	PIN(5, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(6, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(7, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0)
+
+/* lists for the reference check: every mode, AFRL/AFRH edge, pins 0 and 15 */
+#define MIXED_PINS(PIN) \
+	PIN(0, PIN_MODE_AF, PIN_PUSH_PULL, PIN_SPEED_HIGH, PIN_PULL_NONE, 15) \
+	PIN(3, PIN_MODE_ANALOG, PIN_KEEP, PIN_KEEP, PIN_PULL_NONE, 0) \
+	PIN(7, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_SPEED_FAST, PIN_PULL_DOWN, 7) \
+	PIN(8, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_SPEED_MEDIUM, PIN_PULL_UP, 8) \
+	PIN(12, PIN_MODE_IN, PIN_KEEP, PIN_KEEP, PIN_PULL_UP, 0) \
+	PIN(15, PIN_MODE_OUT, PIN_PUSH_PULL, PIN_SPEED_LOW, PIN_KEEP, 0)
+#define ALL_PINS(PIN) \
+	PIN(0, PIN_MODE_OUT, PIN_OPEN_DRAIN, PIN_SPEED_HIGH, PIN_PULL_UP, 0) \
+	PIN(1, PIN_MODE_AF, PIN_PUSH_PULL, PIN_SPEED_LOW, PIN_PULL_DOWN, 1) \
+	PIN(2, PIN_MODE_IN, PIN_KEEP, PIN_KEEP, PIN_PULL_NONE, 0) \
+	PIN(3, PIN_MODE_ANALOG, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(4, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_SPEED_FAST, PIN_PULL_UP, 4) \
+	PIN(5, PIN_MODE_AF, PIN_PUSH_PULL, PIN_SPEED_MEDIUM, PIN_KEEP, 5) \
+	PIN(6, PIN_MODE_OUT, PIN_KEEP, PIN_SPEED_HIGH, PIN_PULL_NONE, 0) \
+	PIN(7, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_KEEP, PIN_PULL_UP, 7) \
+	PIN(8, PIN_MODE_AF, PIN_PUSH_PULL, PIN_SPEED_HIGH, PIN_PULL_DOWN, 8) \
+	PIN(9, PIN_MODE_IN, PIN_KEEP, PIN_KEEP, PIN_PULL_DOWN, 0) \
+	PIN(10, PIN_MODE_AF, PIN_OPEN_DRAIN, PIN_SPEED_LOW, PIN_PULL_NONE, 10) \
+	PIN(11, PIN_MODE_OUT, PIN_PUSH_PULL, PIN_SPEED_FAST, PIN_PULL_UP, 0) \
+	PIN(12, PIN_MODE_ANALOG, PIN_KEEP, PIN_KEEP, PIN_PULL_NONE, 0) \
+	PIN(13, PIN_MODE_AF, PIN_KEEP, PIN_KEEP, PIN_KEEP, 13) \
+	PIN(14, PIN_MODE_OUT, PIN_OPEN_DRAIN, PIN_SPEED_MEDIUM, PIN_PULL_DOWN, 0) \
+	PIN(15, PIN_MODE_AF, PIN_PUSH_PULL, PIN_SPEED_HIGH, PIN_PULL_UP, 15)
+
+#define REPEATED_PINS(PIN) \
+	PIN(4, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(4, PIN_MODE_IN, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0)
+#define BAD_AF_PINS(PIN) \
+	PIN(4, PIN_MODE_AF, PIN_KEEP, PIN_KEEP, PIN_KEEP, 16)
+#define BAD_PULL_PINS(PIN) \
+	PIN(4, PIN_MODE_IN, PIN_KEEP, PIN_KEEP, 3, 0)
+#define BAD_PIN_PINS(PIN) \
+	PIN(16, PIN_MODE_IN, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0)
+
+GPIO_CFG_DEFINE(i2c1_pins, I2C1_PINS);
+GPIO_CFG_DEFINE(lcd_data_pins, LCD_DATA_PINS);
+GPIO_CFG_DEFINE(lcd_ctrl_pins, LCD_CTRL_PINS);
+GPIO_CFG_DEFINE(mixed_pins, MIXED_PINS);
+GPIO_CFG_DEFINE(all_pins, ALL_PINS);
+
+/* the same lists as rows for the reference */
+typedef struct {
+	uint32_t pin, mode, otype, speed, pull, af;
+} pin_row_t;
+
+#define AS_ROW(n, m, o, s, p, a)	{ n, m, o, s, p, a },
+
+static const pin_row_t mixed_rows[] = { MIXED_PINS(AS_ROW) };
+static const pin_row_t all_rows[] = { ALL_PINS(AS_ROW) };
+static const pin_row_t i2c1_rows[] = { I2C1_PINS(AS_ROW) };
+
+static uint64_t rng_state;
+static int failed;
+
+static uint64_t rnd(void){
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+static int same(const GPIO_TypeDef *a, const GPIO_TypeDef *b){
+	return a->MODER == b->MODER && a->OTYPER == b->OTYPER && a->OSPEEDR == b->OSPEEDR
+		&& a->PUPDR == b->PUPDR && a->AFR[0] == b->AFR[0] && a->AFR[1] == b->AFR[1];
+}
+
+/**
+ * void field(volatile uint32_t *reg, uint32_t pos, uint32_t width, uint32_t v)
+ * @brief reference: one field, one read-modify-write
+ */
+static void field(volatile uint32_t *reg, uint32_t pos, uint32_t width, uint32_t v){
+	uint32_t mask = ((1U << width) - 1U) << pos;
+
+	*reg = (*reg & ~mask) | (v << pos);
+}
+
+/**
+ * void reference(GPIO_TypeDef *port, const pin_row_t *rows, uint32_t n)
+ * @brief configure pin by pin, field by field, the way HAL_GPIO_Init does
+ */
+static void reference(GPIO_TypeDef *port, const pin_row_t *rows, uint32_t n){
+	for(uint32_t i = 0; i < n; i++){
+		const pin_row_t *r = &rows[i];
+
+		if(r->otype != PIN_KEEP){
+			field(&port->OTYPER, r->pin, 1, r->otype);
+		}
+		if(r->speed != PIN_KEEP){
+			field(&port->OSPEEDR, 2 * r->pin, 2, r->speed);
+		}
+		if(r->pull != PIN_KEEP){
+			field(&port->PUPDR, 2 * r->pin, 2, r->pull);
+		}
+		if(r->mode == PIN_MODE_AF){
+			field(&port->AFR[r->pin / 8], 4 * (r->pin % 8), 4, r->af);
+		}
+		field(&port->MODER, 2 * r->pin, 2, r->mode);
+	}
+}
+
+/**
+ * int i2c1_list(void)
+ * @brief I2C1_PINS against the shifts I2C1_init used to do
+ */
+static int i2c1_list(void){
+	GPIO_TypeDef hand = { .MODER = GPIOB_MODER_RESET, .OSPEEDR = GPIOB_OSPEEDR_RESET, .PUPDR = GPIOB_PUPDR_RESET };
+	GPIO_TypeDef table = hand;
+	GPIO_TypeDef ref = hand;
+
+	hand.MODER |= (1U << 19) | (1U << 17);
+	hand.MODER &= ~(1U << 18);
+	hand.MODER &= ~(1U << 16);
+	hand.OTYPER |= (1U << 8) | (1U << 9);
+	hand.PUPDR |= (1U << 16) | (1U << 18);
+	hand.PUPDR &= ~(1U << 19);
+	hand.PUPDR &= ~(1U << 17);
+	hand.AFR[1] |= (4<<0) | (4<<4);
+
+	gpio_apply(&table, &i2c1_pins);
+	reference(&ref, i2c1_rows, sizeof(i2c1_rows) / sizeof(i2c1_rows[0]));
+	return same(&hand, &table) && same(&ref, &table);
+}
+
+/**
+ * int lcd(void)
+ * @brief the LCD lists against 23_LCD's MODER |= lines
+ */
+static int lcd(void){
+	GPIO_TypeDef hand_c = { 0 }, table_c = { 0 };
+	GPIO_TypeDef hand_b = { .MODER = GPIOB_MODER_RESET, .OSPEEDR = GPIOB_OSPEEDR_RESET, .PUPDR = GPIOB_PUPDR_RESET };
+	GPIO_TypeDef table_b = hand_b;
+
+	hand_c.MODER |= (1U << 0) | (1U << 2) | (1U << 4) | (1U << 6);
+	hand_c.MODER |= (1U << 8) | (1U << 10) | (1U << 12) | (1U << 14);
+	hand_b.MODER |= (1U << 10) | (1U << 12) | (1U << 14);
+
+	gpio_apply(&table_c, &lcd_data_pins);
+	gpio_apply(&table_b, &lcd_ctrl_pins);
+	return same(&hand_c, &table_c) && same(&hand_b, &table_b)
+		&& lcd_data_pins.otyper_mask == 0 && lcd_data_pins.pupdr_mask == 0 && lcd_data_pins.ospeedr_mask == 0;
+}
+
+/**
+ * int against_reference(const gpio_cfg_t *cfg, const pin_row_t *rows, uint32_t n, long rounds)
+ * @brief random start states, gpio_apply against the reference
+ */
+static int against_reference(const gpio_cfg_t *cfg, const pin_row_t *rows, uint32_t n, long rounds){
+	GPIO_TypeDef a, b;
+
+	for(long i = 0; i < rounds; i++){
+		a.MODER = (uint32_t)rnd();
+		a.OTYPER = (uint32_t)rnd();
+		a.OSPEEDR = (uint32_t)rnd();
+		a.PUPDR = (uint32_t)rnd();
+		a.AFR[0] = (uint32_t)rnd();
+		a.AFR[1] = (uint32_t)rnd();
+		b = a;
+		gpio_apply(&a, cfg);
+		reference(&b, rows, n);
+		if(!same(&a, &b)){
+			printf("  start %08x %08x %08x %08x %08x %08x\n", (unsigned)b.MODER, (unsigned)b.OTYPER,
+					(unsigned)b.OSPEEDR, (unsigned)b.PUPDR, (unsigned)b.AFR[0], (unsigned)b.AFR[1]);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int main(int argc, char **argv){
+	long rounds = (argc > 1) ? strtol(argv[1], 0, 10) : 100000;
+
+	rng_state = (argc > 2) ? strtoull(argv[2], 0, 10) : 1;
+	if(rng_state == 0){
+		rng_state = 1;
+	}
+	check("i2c1", i2c1_list());
+	check("lcd", lcd());
+	check("reference", against_reference(&mixed_pins, mixed_rows, sizeof(mixed_rows) / sizeof(mixed_rows[0]), rounds)
+			&& against_reference(&all_pins, all_rows, sizeof(all_rows) / sizeof(all_rows[0]), rounds)
+			&& against_reference(&i2c1_pins, i2c1_rows, sizeof(i2c1_rows) / sizeof(i2c1_rows[0]), rounds));
+	check("unique/valid", GPIO_PINS_UNIQUE(ALL_PINS) && GPIO_PINS_VALID(ALL_PINS)
+			&& !GPIO_PINS_UNIQUE(REPEATED_PINS) && !GPIO_PINS_VALID(BAD_AF_PINS)
+			&& !GPIO_PINS_VALID(BAD_PULL_PINS) && !GPIO_PINS_VALID(BAD_PIN_PINS));
+	return failed;
+}
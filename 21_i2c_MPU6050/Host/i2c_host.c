@@ -0,0 +1,671 @@
+/**
+ * i2c_host.c
+ *	@brief host model of the I2C1..I2C3 peripherals (see i2c_host.h)
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * x86-64 Linux only: the trap of the register accesses works as in
+ * Host/sim/sim.c (write bit of the page fault error code, trap flag).
+ */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "i2c_host.h"
+#include "gpio.h"
+
+#define DR_IDLE					(0xA5A50000U)	// DR holds this until the driver writes a byte
+#define BYTE_BITS				(9U)			// 8 data bits + ACK
+#define HANDLER_LOOP_MAX		(8)
+#define HOST_PAGE				(4096U)
+#define HOST_DEPTH				(8)				// accesses in flight: handlers run from the trap
+#define HOST_TF					(0x100)			// EFLAGS trap flag
+#define HOST_PF_WRITE			(0x2)			// page fault error code: write access
+#define PERIPH_LEN				(0x30000U)		// APB1, APB2, AHB1 (GPIO)
+#define CORE_BASE				(0xE0000000UL)	// ITM, DWT, SCS (NVIC, SysTick, SCB)
+#define CORE_LEN				(0x10000U)
+#define NVIC_WORDS				(8)
+#define OBSERVE_ANY				(0xFFFFFFFFU)	// observe() without an access: what the registers say
+
+/* the model's view of a register block, no trap */
+#define VIEW(p)					((__typeof__(p))view((const volatile void *)(p)))
+
+/* phase in progress on the wire, or the flag waiting for the driver */
+enum {
+	PH_IDLE = 0,
+	PH_START,			// START or repeated START on the wire
+	PH_SB,				// SB set, waiting for the address in DR
+	PH_ADDR,			// address byte on the wire
+	PH_ADDR_SET,		// ADDR set, waiting for the driver to clear it
+	PH_TX,				// data byte to the slave on the wire
+	PH_TX_DONE,			// TXE and BTF set, waiting for a byte or a START
+	PH_RX,				// data byte from the slave on the wire
+	PH_RX_SET,			// RXNE set, waiting for the driver to read DR
+	PH_STOP,			// STOP on the wire
+	PH_AF,				// not acknowledged (AF), waiting for STOP or START
+	PH_HUNG				// a slave holds SCL or SDA low: the phase does not end
+};
+
+/* one access in flight: the page is open until the instruction is over */
+typedef struct {
+	uintptr_t addr;
+	uintptr_t page;
+	int write;
+} host_access_t;
+
+i2c_host_bus_t i2c_host_bus[I2C_HOST_BUSES];
+uint64_t i2c_host_now;
+
+/* the core clock of the model; system_stm32f4xx.c is not linked */
+uint32_t SystemCoreClock = 16000000U;
+
+static uint8_t *periph_view, *core_view;
+static host_access_t access_stack[HOST_DEPTH];
+static int depth;
+static uintptr_t spin_pc;					// instruction of the last CYCCNT read, 0 after a store
+static uint32_t nvic_enabled[NVIC_WORDS];	// ISER sets, ICER clears, both read this
+
+static int step(uint64_t end);
+static void lines(i2c_host_bus_t *b);
+static void observe(i2c_host_bus_t *b, uint32_t off, int write);
+
+/**
+ * void *view(const volatile void *p)
+ * @brief the model's view of a register, without the trap; other memory as it is
+ */
+static void *view(const volatile void *p){
+	uintptr_t a = (uintptr_t)p;
+
+	if(a - PERIPH_BASE < PERIPH_LEN){
+		return periph_view + (a - PERIPH_BASE);
+	}
+	if(a - CORE_BASE < CORE_LEN){
+		return core_view + (a - CORE_BASE);
+	}
+	return (void *)a;
+}
+
+/**
+ * uint8_t *map_twice(uintptr_t addr, size_t len)
+ * @brief a memory file at a target address with no access, and read/write elsewhere
+ * @return the read/write view
+ */
+static uint8_t *map_twice(uintptr_t addr, size_t len){
+	int fd = memfd_create("i2c_host", 0);
+	uint8_t *v;
+
+	if(fd < 0 || ftruncate(fd, len) != 0){
+		perror("i2c_host: memfd");
+		exit(2);
+	}
+	v = mmap(0, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(v == MAP_FAILED || mmap((void *)addr, len, PROT_NONE, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0) != (void *)addr){
+		fprintf(stderr, "i2c_host: cannot map 0x%08lx\n", (unsigned long)addr);
+		exit(2);
+	}
+	close(fd);
+	return v;
+}
+
+/**
+ * void accessed(const host_access_t *x)
+ * @brief the model follows one register access of the program
+ * @step followed:
+ *
+ * 1. NVIC: ISER sets enable bits, ICER clears them, both read the result
+ * 2. GPIO: the pins of the buses follow
+ * 3. I2C: the instance sees the access
+ * 4. A store ends a wait loop (see on_segv())
+ */
+static void accessed(const host_access_t *x){
+	uintptr_t iser = (uintptr_t)&NVIC->ISER[0];
+	uintptr_t icer = (uintptr_t)&NVIC->ICER[0];
+
+	/*1. NVIC: ISER sets, ICER clears*/
+	if(x->write && (x->addr - iser < 4U * NVIC_WORDS || x->addr - icer < 4U * NVIC_WORDS)){
+		int set = x->addr - iser < 4U * NVIC_WORDS;
+		uint32_t i = (uint32_t)(x->addr - (set ? iser : icer)) / 4U;
+		uint32_t v = set ? VIEW(NVIC)->ISER[i] : VIEW(NVIC)->ICER[i];
+
+		nvic_enabled[i] = set ? (nvic_enabled[i] | v) : (nvic_enabled[i] & ~v);
+		VIEW(NVIC)->ISER[i] = VIEW(NVIC)->ICER[i] = nvic_enabled[i];
+	}
+
+	/*2. GPIO: the pins of the buses follow*/
+	if(x->addr - GPIOA_BASE < GPIOH_BASE + 0x400U - GPIOA_BASE){
+		for(int i = 0; i < I2C_HOST_BUSES; i++){
+			lines(&i2c_host_bus[i]);
+		}
+	}
+
+	/*3. I2C: the instance sees the access*/
+	for(int i = 0; i < I2C_HOST_BUSES; i++){
+		uintptr_t base = (uintptr_t)i2c_host_bus[i].h->regs;
+
+		if(x->addr - base < sizeof(I2C_TypeDef)){
+			observe(&i2c_host_bus[i], (uint32_t)(x->addr - base), x->write);
+		}
+	}
+
+	/*4. A store ends a wait loop*/
+	if(x->write){
+		spin_pc = 0;
+	}
+}
+
+/**
+ * void on_segv(int sig, siginfo_t *si, void *p)
+ * @brief the program touched a register
+ * @step followed:
+ *
+ * 1. Not a register: a real fault, let it kill the program
+ * 2. CYCCNT read again by the instruction that read it last, with no store
+ *    in between: the program spins on the clock, time moves on before the
+ *    read (and before the access is stacked: interrupt handlers may run)
+ * 3. Before a read of the pins, bring IDR up to date
+ * 4. Open the page, step over the instruction
+ */
+static void on_segv(int sig, siginfo_t *si, void *p){
+	ucontext_t *uc = p;
+	uintptr_t a = (uintptr_t)si->si_addr;
+	uintptr_t pc = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+	int write = (uc->uc_mcontext.gregs[REG_ERR] & HOST_PF_WRITE) != 0;
+	host_access_t *x;
+
+	/*1. Not a register: a real fault*/
+	if(view((void *)a) == (void *)a || depth == HOST_DEPTH){
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+
+	/*2. CYCCNT read again by the same instruction: time moves on*/
+	if(!write && (a & ~(uintptr_t)3) == (uintptr_t)&DWT->CYCCNT){
+		if(pc == spin_pc){
+			step(i2c_host_now + I2C_HOST_SPIN_NS);
+		}
+		spin_pc = pc;
+	}
+	x = &access_stack[depth++];
+	x->addr = a & ~(uintptr_t)3;
+	x->page = a & ~(uintptr_t)(HOST_PAGE - 1U);
+	x->write = write;
+
+	/*3. Before a read of the pins, bring IDR up to date*/
+	if(!x->write && x->addr - GPIOA_BASE < GPIOH_BASE + 0x400U - GPIOA_BASE){
+		for(int i = 0; i < I2C_HOST_BUSES; i++){
+			lines(&i2c_host_bus[i]);
+		}
+	}
+
+	/*4. Open the page, step over the instruction*/
+	mprotect((void *)x->page, HOST_PAGE, PROT_READ | PROT_WRITE);
+	uc->uc_mcontext.gregs[REG_EFL] |= HOST_TF;
+}
+
+/**
+ * void on_trap(int sig, siginfo_t *si, void *p)
+ * @brief the instruction is over: close the page, the model follows the access
+ */
+static void on_trap(int sig, siginfo_t *si, void *p){
+	ucontext_t *uc = p;
+
+	uc->uc_mcontext.gregs[REG_EFL] &= ~HOST_TF;
+	while(depth > 0){
+		host_access_t x = access_stack[--depth];
+
+		mprotect((void *)x.page, HOST_PAGE, PROT_NONE);
+		accessed(&x);
+	}
+}
+
+/**
+ * void i2c_host_map(void)
+ * @brief map the peripherals and the core peripherals, install the trap, attach the handles
+ * @step followed:
+ *
+ * 1. Each region: a memory file, mapped twice
+ * 2. SIGSEGV and SIGTRAP handlers, reentrant (the interrupt handlers run
+ *    from the trap and touch registers too)
+ */
+void i2c_host_map(void){
+	struct sigaction sa;
+
+	/*1. Each region: a memory file, mapped twice*/
+	periph_view = map_twice(PERIPH_BASE, PERIPH_LEN);
+	core_view = map_twice(CORE_BASE, CORE_LEN);
+	i2c_host_bus[0].h = &i2c1;
+	i2c_host_bus[1].h = &i2c2;
+	i2c_host_bus[2].h = &i2c3;
+
+	/*2. SIGSEGV and SIGTRAP handlers, reentrant*/
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = on_segv;
+	sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGSEGV, &sa, 0);
+	sa.sa_sigaction = on_trap;
+	sigaction(SIGTRAP, &sa, 0);
+}
+
+/**
+ * void lines(i2c_host_bus_t *b)
+ * @brief the SCL and SDA pins while they are GPIO: BSRR into ODR, rising
+ *        edges of SCL, a slave holding SDA lets go after its clocks; IDR
+ *        shows the line levels
+ */
+static void lines(i2c_host_bus_t *b){
+	i2c_handle_t *h = b->h;
+	GPIO_TypeDef *scl = VIEW(h->scl_port);
+	GPIO_TypeDef *sda = VIEW(h->sda_port);
+	uint32_t scl_bit = 1U << h->scl_pin;
+	uint32_t sda_bit = 1U << h->sda_pin;
+	int scl_out = ((scl->MODER >> (2U * h->scl_pin)) & 3U) == PIN_MODE_OUT;
+	int sda_out = ((sda->MODER >> (2U * h->sda_pin)) & 3U) == PIN_MODE_OUT;
+	int level;
+
+	/* BSRR is write-only: the model applies it after every store and clears it */
+	for(int k = 0; k < 2; k++){
+		GPIO_TypeDef *g = k ? sda : scl;
+
+		g->ODR = (g->ODR | (g->BSRR & 0xFFFFU)) & ~(g->BSRR >> 16);
+		g->BSRR = 0;
+	}
+	level = !b->scl_low && (!scl_out || (scl->ODR & scl_bit));		// released high as AF
+	if(level && !b->scl_level){
+		b->scl_clocks++;
+		if(b->sda_low && b->sda_release && b->scl_clocks >= b->sda_release){
+			b->sda_low = 0;
+		}
+	}
+	b->scl_level = level;
+
+	scl->IDR = (scl->IDR & ~scl_bit) | ((b->scl_low || (scl_out && !(scl->ODR & scl_bit))) ? 0U : scl_bit);
+	sda->IDR = (sda->IDR & ~sda_bit) | ((b->sda_low || (sda_out && !(sda->ODR & sda_bit))) ? 0U : sda_bit);
+}
+
+/**
+ * void i2c_host_reset(void)
+ * @brief I2C registers as i2c_init() leaves them, buses idle, slaves detached, time 0
+ */
+void i2c_host_reset(void){
+	i2c_host_now = 0;
+	VIEW(DWT)->CYCCNT = 0;
+	spin_pc = 0;
+	for(int i = 0; i < I2C_HOST_BUSES; i++){
+		i2c_host_bus_t *b = &i2c_host_bus[i];
+		I2C_TypeDef *r = VIEW(b->h->regs);
+
+		r->CR1 = I2C_CR1_PE;
+		r->CR2 = I2C_CR2_FREQ_4;
+		r->SR1 = 0;
+		r->SR2 = 0;
+		r->DR = DR_IDLE;
+		memset(&b->h->xfer, 0, sizeof(b->h->xfer));
+		b->h->q_head = 0;
+		b->h->q_count = 0;
+		b->phase = PH_IDLE;
+		b->sel = 0;
+		b->irqs = b->nacks = 0;
+		b->busy_ns = 0;
+		memset(b->slave, 0, sizeof(b->slave));
+		memset(&b->h->stats, 0, sizeof(b->h->stats));
+		i2c_host_fault(i, I2C_HOST_FAULT_NONE, 0, 0);
+		b->scl_clocks = b->swrst = 0;
+		lines(b);
+	}
+}
+
+/**
+ * void i2c_host_fault(int bus, i2c_host_fault_t fault, uint32_t at, uint64_t arg)
+ * @brief arm a fault at the end of phase at (1 = the next one to end), or
+ *        with I2C_HOST_FAULT_NONE disarm and release the lines (see i2c_host.h)
+ */
+void i2c_host_fault(int bus, i2c_host_fault_t fault, uint32_t at, uint64_t arg){
+	i2c_host_bus_t *b = &i2c_host_bus[bus];
+
+	b->fault = fault;
+	b->fault_at = at;
+	b->fault_arg = arg;
+	b->phases = 0;
+	if(fault == I2C_HOST_FAULT_NONE){
+		b->scl_low = b->sda_low = 0;
+		if(b->phase == PH_HUNG){
+			b->phase = PH_IDLE;
+		}
+		if(b->phase == PH_IDLE){
+			VIEW(b->h->regs)->SR2 &= ~I2C_SR2_BUSY;
+		}
+	}
+}
+
+/**
+ * int i2c_host_attach(int bus, i2c_host_slave_t *s, uint8_t addr)
+ * @brief put a slave on a bus (0 = I2C1) at an 8 bit address
+ * @return 0, -1 if the bus has no room
+ */
+int i2c_host_attach(int bus, i2c_host_slave_t *s, uint8_t addr){
+	i2c_host_bus_t *b = &i2c_host_bus[bus];
+
+	for(int i = 0; i < I2C_HOST_SLAVES; i++){
+		if(!b->slave[i]){
+			s->addr = addr;
+			b->slave[i] = s;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/* 1 if the phase ends by itself at b->t (not waiting for the driver) */
+static int on_wire(int phase){
+	return phase == PH_START || phase == PH_ADDR || phase == PH_TX || phase == PH_RX
+		|| phase == PH_STOP || phase == PH_HUNG;
+}
+
+static void wire(i2c_host_bus_t *b, int phase, uint32_t bits){
+	b->phase = phase;
+	b->t = i2c_host_now + bits * I2C_HOST_BIT_NS;
+}
+
+static i2c_host_slave_t *select_slave(i2c_host_bus_t *b, uint8_t addr){
+	for(int i = 0; i < I2C_HOST_SLAVES; i++){
+		if(b->slave[i] && b->slave[i]->addr == (addr & 0xFEU)){
+			return b->slave[i];
+		}
+	}
+	b->nacks++;
+	return 0;
+}
+
+/**
+ * void observe(i2c_host_bus_t *b, uint32_t off, int write)
+ * @brief react to an access of the driver at register offset off (OBSERVE_ANY:
+ *        to what the control bits say): SWRST, START, STOP, DR written; ADDR
+ *        cleared by the read of SR2, RXNE by the read of DR
+ */
+static void observe(i2c_host_bus_t *b, uint32_t off, int write){
+	I2C_TypeDef *r = VIEW(b->h->regs);
+	int written = (r->DR != DR_IDLE);
+	uint8_t byte = (uint8_t)r->DR;
+
+	/* SWRST: the instance is back to its reset state; a line still held makes it busy */
+	if(r->CR1 & I2C_CR1_SWRST){
+		if(b->phase != PH_IDLE){
+			b->busy_ns += i2c_host_now - b->busy_from;
+		}
+		r->CR1 = I2C_CR1_SWRST;
+		r->CR2 = 0;
+		r->SR1 = 0;
+		r->SR2 = (b->scl_low || b->sda_low) ? I2C_SR2_BUSY : 0U;
+		r->DR = DR_IDLE;
+		b->phase = PH_IDLE;
+		b->swrst++;
+		return;
+	}
+
+	switch(b->phase){
+	case PH_IDLE:
+		/* a START waits while a slave holds a line */
+		if((r->CR1 & I2C_CR1_START) && !b->scl_low && !b->sda_low){
+			r->CR1 &= ~I2C_CR1_START;
+			r->SR2 |= I2C_SR2_BUSY | I2C_SR2_MSL;
+			b->busy_from = i2c_host_now;
+			wire(b, PH_START, 1);
+		}
+		break;
+
+	case PH_SB:
+		if(written){
+			r->DR = DR_IDLE;
+			r->SR1 &= ~I2C_SR1_SB;
+			b->rd = byte & 1U;
+			b->first_tx = 1;
+			b->sel = select_slave(b, byte);
+			wire(b, PH_ADDR, BYTE_BITS);
+		}
+		break;
+
+	case PH_ADDR_SET:
+		/* the driver read SR1 then SR2: ADDR is cleared */
+		if(off != offsetof(I2C_TypeDef, SR2) || write){
+			break;
+		}
+		r->SR1 &= ~I2C_SR1_ADDR;
+		if(b->rd){
+			wire(b, PH_RX, BYTE_BITS);
+			break;
+		}
+		r->SR1 |= I2C_SR1_TXE;
+		b->phase = PH_TX_DONE;
+		/* fall through: the driver may have written the first byte already */
+
+	case PH_TX_DONE:
+		if(r->CR1 & I2C_CR1_START){
+			r->CR1 &= ~I2C_CR1_START;
+			r->SR1 &= ~(I2C_SR1_TXE | I2C_SR1_BTF);
+			wire(b, PH_START, 1);
+		}else if(written){
+			r->DR = DR_IDLE;
+			r->SR1 &= ~(I2C_SR1_TXE | I2C_SR1_BTF);
+			if(b->sel && b->first_tx){
+				b->sel->ptr = byte;
+			}else if(b->sel){
+				b->sel->regs[b->sel->ptr++ % I2C_HOST_REGS] = byte;
+			}
+			b->first_tx = 0;
+			wire(b, PH_TX, BYTE_BITS);
+		}else if(r->CR1 & I2C_CR1_STOP){
+			r->CR1 &= ~I2C_CR1_STOP;
+			wire(b, PH_STOP, 1);
+		}
+		break;
+
+	case PH_AF:
+		/* the master ends the transfer it lost */
+		if(r->CR1 & I2C_CR1_START){
+			r->CR1 &= ~I2C_CR1_START;
+			wire(b, PH_START, 1);
+		}else if(r->CR1 & I2C_CR1_STOP){
+			r->CR1 &= ~I2C_CR1_STOP;
+			wire(b, PH_STOP, 1);
+		}
+		break;
+
+	case PH_RX_SET:
+		/* the driver read DR */
+		if(off != offsetof(I2C_TypeDef, DR) || write){
+			break;
+		}
+		r->SR1 &= ~I2C_SR1_RXNE;
+		r->DR = DR_IDLE;
+		wire(b, b->stop_after ? PH_STOP : PH_RX, b->stop_after ? 1 : BYTE_BITS);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * int inject(i2c_host_bus_t *b)
+ * @brief the armed fault, if this is its phase
+ * @return 1 if the fault replaced the end of the phase
+ */
+static int inject(i2c_host_bus_t *b){
+	I2C_TypeDef *r = VIEW(b->h->regs);
+	i2c_host_fault_t f = b->fault;
+
+	if(f == I2C_HOST_FAULT_NONE || b->phases != b->fault_at){
+		return 0;
+	}
+	b->fault = I2C_HOST_FAULT_NONE;
+	switch(f){
+	case I2C_HOST_FAULT_NACK:
+		if(b->phase != PH_ADDR && b->phase != PH_TX){
+			return 0;
+		}
+		b->nacks++;
+		r->SR1 |= I2C_SR1_AF;
+		b->phase = PH_AF;
+		return 1;
+	case I2C_HOST_FAULT_ARLO:
+	case I2C_HOST_FAULT_BERR:
+		/* the master is off the bus, slave mode */
+		r->SR1 |= (f == I2C_HOST_FAULT_ARLO) ? I2C_SR1_ARLO : I2C_SR1_BERR;
+		r->SR2 = 0;
+		r->CR1 &= ~(I2C_CR1_START | I2C_CR1_STOP);
+		b->busy_ns += i2c_host_now - b->busy_from;
+		b->phase = PH_IDLE;
+		return 1;
+	case I2C_HOST_FAULT_STRETCH:
+		if(b->fault_arg){
+			b->t = i2c_host_now + b->fault_arg;
+			return 1;
+		}
+		b->scl_low = 1;
+		break;
+	default:
+		b->sda_low = 1;
+		b->sda_release = (uint32_t)b->fault_arg;
+		break;
+	}
+	b->phase = PH_HUNG;
+	b->t = UINT64_MAX;
+	return 1;
+}
+
+/**
+ * void finish(i2c_host_bus_t *b)
+ * @brief the phase on the wire ends: the armed fault, or raise its flag
+ */
+static void finish(i2c_host_bus_t *b){
+	I2C_TypeDef *r = VIEW(b->h->regs);
+
+	if(!on_wire(b->phase) || b->phase == PH_HUNG){
+		return;
+	}
+	b->phases++;
+	if(inject(b)){
+		return;
+	}
+	switch(b->phase){
+	case PH_START:
+		r->SR1 |= I2C_SR1_SB;
+		b->phase = PH_SB;
+		break;
+	case PH_ADDR:
+		if(!b->sel){
+			r->SR1 |= I2C_SR1_AF;
+			b->phase = PH_AF;
+			break;
+		}
+		r->SR1 |= I2C_SR1_ADDR;
+		b->phase = PH_ADDR_SET;
+		break;
+	case PH_TX:
+		r->SR1 |= I2C_SR1_TXE | I2C_SR1_BTF;
+		b->phase = PH_TX_DONE;
+		break;
+	case PH_RX:
+		r->DR = b->sel->regs[b->sel->ptr++ % I2C_HOST_REGS];
+		r->SR1 |= I2C_SR1_RXNE;
+		b->stop_after = (r->CR1 & I2C_CR1_STOP) != 0;
+		if(b->stop_after){
+			r->CR1 &= ~I2C_CR1_STOP;		// the STOP goes out after this byte
+		}
+		b->phase = PH_RX_SET;
+		break;
+	case PH_STOP:
+		r->SR2 = 0;
+		b->busy_ns += i2c_host_now - b->busy_from;
+		b->phase = PH_IDLE;
+		break;
+	default:
+		break;
+	}
+}
+
+/* 1: event interrupt, 2: error interrupt, 0: none */
+static int irq_pending(const i2c_host_bus_t *b){
+	const I2C_TypeDef *r = VIEW(b->h->regs);
+	uint32_t ev = I2C_SR1_SB | I2C_SR1_ADDR | I2C_SR1_BTF;
+	uint32_t er = I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR;
+
+	if((r->CR2 & I2C_CR2_ITERREN) && (r->SR1 & er)){
+		return 2;
+	}
+	if(r->CR2 & I2C_CR2_ITBUFEN){
+		ev |= I2C_SR1_RXNE | I2C_SR1_TXE;
+	}
+	return ((r->CR2 & I2C_CR2_ITEVTEN) && (r->SR1 & ev)) ? 1 : 0;
+}
+
+/**
+ * int step(uint64_t end)
+ * @brief end the earliest phase on any bus and run the interrupts it raises
+ * @step followed:
+ *
+ * 1. Find the next phase to end; none before end: time moves to end
+ * 2. End it, advance the time and DWT->CYCCNT
+ * 3. Event or error interrupt of that bus while a flag is up; the model
+ *    follows the accesses of the handler through the trap
+ * 4. A START queued behind a STOP goes out once the bus is idle
+ *
+ * @return the bus that was stepped, -1 if nothing happened before end.
+ */
+static int step(uint64_t end){
+	i2c_host_bus_t *b = 0;
+	int i = -1;
+
+	/*1. Find the next phase to end*/
+	for(int k = 0; k < I2C_HOST_BUSES; k++){
+		i2c_host_bus_t *c = &i2c_host_bus[k];
+
+		if(on_wire(c->phase) && (!b || c->t < b->t)){
+			b = c;
+			i = k;
+		}
+	}
+	if(!b || b->t > end){
+		i2c_host_now = end;
+		VIEW(DWT)->CYCCNT = (uint32_t)(end * (SystemCoreClock / 1000000U) / 1000U);
+		return -1;
+	}
+
+	/*2. End it, advance the time and DWT->CYCCNT*/
+	i2c_host_now = b->t;
+	VIEW(DWT)->CYCCNT = (uint32_t)(i2c_host_now * (SystemCoreClock / 1000000U) / 1000U);
+	finish(b);
+
+	/*3. Event or error interrupt of that bus while a flag is up*/
+	for(int n = 0, irq; (irq = irq_pending(b)) != 0 && n < HANDLER_LOOP_MAX; n++){
+		if(irq == 2){
+			i2c_er_handler(b->h);
+		}else{
+			i2c_ev_handler(b->h);
+		}
+		b->irqs++;
+	}
+
+	/*4. A START queued behind a STOP goes out once the bus is idle*/
+	if(b->phase == PH_IDLE){
+		observe(b, OBSERVE_ANY, 0);
+	}
+	return i;
+}
+
+/**
+ * int i2c_host_step(uint64_t end)
+ * @brief the program lets time pass up to end: the earliest phase on any bus ends (step)
+ * @return the bus that was stepped, -1 if nothing happened before end.
+ */
+int i2c_host_step(uint64_t end){
+	spin_pc = 0;
+	return step(end);
+}
@@ -0,0 +1,116 @@
+/**
+ * i2c_host.h
+ *	@brief header file for the host model of the I2C1..I2C3 peripherals
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The peripheral block (0x40000000) and the core peripherals (0xE0000000:
+ * DWT, NVIC) are mapped at their target addresses with no access, as in
+ * Host/sim (sim.h): every load or store of the program traps, the model
+ * follows it and steps over the instruction. i2c.c and the code on top of
+ * it run unchanged on the CMSIS register definitions, with no hook for
+ * the host.
+ *
+ * Each I2C instance is modelled at the level its event interrupt sees: the
+ * START, address, data and STOP phases take their bit times at 100 kHz,
+ * then set SB, ADDR, TXE/BTF or RXNE in SR1 and call i2c_ev_handler() for
+ * that bus. i2c_host_step() ends the earliest phase on any bus, so the
+ * transfers of the three buses overlap the way they do on the target.
+ * DWT->CYCCNT follows the simulated time at SystemCoreClock.
+ *
+ * Slaves are MPU6050-like register files: a write sets the register
+ * pointer and stores the bytes after it, a read returns from the pointer
+ * on, both auto-incrementing. An address no slave answers to is counted
+ * as a NACK and sets AF; the master holds the bus until STOP or START.
+ * The error interrupt (i2c_er_handler) runs when an error flag is up and
+ * ITERREN is set.
+ *
+ * What the model takes from the accesses: START, STOP and SWRST written
+ * to CR1, a byte written to DR, ADDR cleared by the read of SR2 and RXNE
+ * by the read of DR; the SCL and SDA pins while the bus recovery drives
+ * them as GPIO (BSRR into ODR, rising edges of SCL counted, IDR of SDA low
+ * while a slave holds it); NVIC ISER sets enable bits and ICER clears
+ * them, both read back the enabled set.
+ *
+ * Time moves on in i2c_host_step() and while the program waits: every
+ * wait of i2c.c reads DWT->CYCCNT once a turn, so a CYCCNT read by the
+ * same instruction as the last one, with no store to a register between
+ * them, is a turn of a wait loop and lets I2C_HOST_SPIN_NS pass (or the
+ * next phase end, with its interrupts). Straight-line code takes no time.
+ *
+ * Fault injection (i2c_host_fault): at the end of the k-th phase on the
+ * wire of a bus (START, address, data byte, STOP; counted since the
+ * fault was armed) the phase
+ *   NACK      is not acknowledged (address or byte to the slave, AF)
+ *   ARLO      loses arbitration, BERR sees a misplaced START/STOP: the
+ *             flag is set and the master is off the bus
+ *   STRETCH   does not end for arg ns more (SCL held low by the slave);
+ *             arg 0: SCL stays low, the bus stays busy
+ *   SDA_LOW   does not end: the slave holds SDA low until arg SCL clocks
+ *             of a recovery; arg 0: for good, the bus stays busy
+ * i2c_host_fault(bus, I2C_HOST_FAULT_NONE, 0, 0) releases the lines.
+ */
+
+#ifndef HOST_I2C_HOST_H_
+#define HOST_I2C_HOST_H_
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+#include "i2c.h"
+
+#define I2C_HOST_BUSES			(3)			// I2C1, I2C2, I2C3
+#define I2C_HOST_SLAVES			(8)			// per bus
+#define I2C_HOST_BIT_NS			(10000ULL)	// 100 kHz
+#define I2C_HOST_REGS			(128)
+#define I2C_HOST_SPIN_NS		(1000ULL)	// time per turn of a wait loop while nothing ends
+
+typedef enum {
+	I2C_HOST_FAULT_NONE = 0,
+	I2C_HOST_FAULT_NACK,
+	I2C_HOST_FAULT_ARLO,
+	I2C_HOST_FAULT_BERR,
+	I2C_HOST_FAULT_STRETCH,
+	I2C_HOST_FAULT_SDA_LOW
+} i2c_host_fault_t;
+
+typedef struct {
+	uint8_t addr;				// 8 bit write address
+	uint8_t ptr;				// register pointer
+	uint8_t regs[I2C_HOST_REGS];
+} i2c_host_slave_t;
+
+typedef struct {
+	i2c_handle_t *h;
+	int phase;
+	uint64_t t;					// end of the phase on the wire (ns)
+	int rd;						// direction of the last address
+	int first_tx;				// next byte written is the register pointer
+	int stop_after;				// STOP follows the byte being received
+	i2c_host_slave_t *slave[I2C_HOST_SLAVES];
+	i2c_host_slave_t *sel;		// slave addressed last, 0 for a NACK
+	uint32_t irqs;				// i2c_ev_handler() calls
+	uint32_t nacks;
+	uint64_t busy_ns;			// START to end of STOP, summed
+	uint64_t busy_from;
+	i2c_host_fault_t fault;		// armed, fires at the end of phase fault_at
+	uint32_t fault_at;
+	uint64_t fault_arg;
+	uint32_t phases;			// phases ended since the fault was armed
+	int scl_low;				// a slave holds SCL low
+	int sda_low;				// a slave holds SDA low ...
+	uint32_t sda_release;		// ... until this many SCL clocks, 0: for good
+	int scl_level;				// SCL as driven by GPIO
+	uint32_t scl_clocks;		// SCL rising edges driven by GPIO
+	uint32_t swrst;				// peripheral resets seen
+} i2c_host_bus_t;
+
+extern i2c_host_bus_t i2c_host_bus[I2C_HOST_BUSES];
+extern uint64_t i2c_host_now;	// simulated time, ns
+
+void i2c_host_map(void);
+void i2c_host_reset(void);
+int i2c_host_attach(int bus, i2c_host_slave_t *s, uint8_t addr);
+int i2c_host_step(uint64_t end);
+void i2c_host_fault(int bus, i2c_host_fault_t fault, uint32_t at, uint64_t arg);
+
+#endif /* HOST_I2C_HOST_H_ */
@@ -0,0 +1,283 @@
+/**
+ * i2cfault.c
+ *	@brief Linux CLI: i2c.c timeouts, error handling and bus recovery under injected faults
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -I. -o i2cfault i2cfault.c i2c_host.c ../Core/Src/i2c.c
+ *
+ * i2c.c runs against the model of i2c_host.h with one MPU6050-like slave
+ * on I2C1. Faults are injected at the end of a phase on the wire (see
+ * i2c_host_fault); the blocking transfers run the model while they wait.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  clean          a 14 byte read and a 3 byte write, no retry
+ *  absent         an address nobody answers: I2C_ERR_NACK after
+ *                 I2C_RETRIES retries, the bus recovered after each
+ *  recovery       SDA held in a byte: the recovery clocks SCL until it is
+ *                 free (5 clocks, then 1 for the STOP), then the retry
+ *                 reads the right bytes
+ *  read sweep, write sweep
+ *                 every fault at every phase of the transfer: a fault that
+ *                 goes away ends in I2C_OK and the right bytes, a line held
+ *                 for good in an error; each within I2C_WORST_US(n) of
+ *                 simulated time, and the next clean transfer succeeds
+ *  it error       interrupt driven read not acknowledged: the error
+ *                 interrupt posts arg 0 and sends STOP only, no bus
+ *                 recovery; the queued read behind it completes
+ *  it berr        a bus error: the error interrupt posts arg 0 but leaves
+ *                 the recovery to thread context; the queued read waits
+ *                 for it, i2c_it_poll() on the next tick recovers the bus
+ *                 and the read completes
+ *  it timeout     interrupt driven read with SDA held: no interrupt comes,
+ *                 i2c_it_poll() on the next tick posts arg 0 within the
+ *                 deadline and a tick; the next read completes
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "i2c.h"
+#include "sched.h"
+#include "i2c_host.h"
+
+#define SLAVE_ADDR				(0xD0)			// DEVICE_ADDR, MPU6050.h
+#define ABSENT_ADDR				(0xD2)
+#define DATA_REG				(0x3B)			// ACCEL_XOUT_H
+#define DATA_LEN				(14)			// accel, temp, gyro
+#define CFG_REG					(0x19)			// SMPLRT_DIV, CONFIG, GYRO_CONFIG
+#define CFG_LEN					(3)
+#define READ_PHASES				(6 + DATA_LEN)	// START, address, register, START, address, bytes, STOP
+#define CFG_PHASES				(4 + CFG_LEN)	// START, address, register, bytes, STOP
+#define TICK_NS					(1000000ULL)	// the IMU task's tick
+
+typedef struct {
+	const char *name;
+	i2c_host_fault_t fault;
+	uint64_t arg;
+	int hangs;				// the line stays held: the transfer fails
+} fault_case_t;
+
+static const fault_case_t cases[] = {
+	{ "nack",			I2C_HOST_FAULT_NACK,	0,			0 },
+	{ "arlo",			I2C_HOST_FAULT_ARLO,	0,			0 },
+	{ "berr",			I2C_HOST_FAULT_BERR,	0,			0 },
+	{ "stretch 100us",	I2C_HOST_FAULT_STRETCH,	100000,		0 },
+	{ "stretch 2ms",	I2C_HOST_FAULT_STRETCH,	2000000,	0 },
+	{ "scl low",		I2C_HOST_FAULT_STRETCH,	0,			1 },
+	{ "sda low 5",		I2C_HOST_FAULT_SDA_LOW,	5,			0 },
+	{ "sda low",		I2C_HOST_FAULT_SDA_LOW,	0,			1 },
+};
+#define CASES					(sizeof(cases) / sizeof(cases[0]))
+
+static i2c_host_slave_t slave;
+static char buf[DATA_LEN];
+static uint8_t seq;
+static int posted, posted_arg;
+static int failed;
+
+/**
+ * int sched_post(uint8_t task, uint8_t sig, uint16_t arg)
+ * @brief the completion of an interrupt driven read
+ */
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	posted++;
+	posted_arg = arg;
+	return 0;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * int transfer(int write, uint8_t saddr, int *good, uint64_t *ns)
+ * @brief one blocking read of the data burst or write of CFG_LEN registers,
+ *        new register contents every time
+ * @return the status of the call; *good: the bytes arrived, *ns: simulated time
+ */
+static int transfer(int write, uint8_t saddr, int *good, uint64_t *ns){
+	uint64_t t0 = i2c_host_now;
+	int rc;
+
+	seq++;
+	if(write){
+		char data[CFG_LEN];
+
+		for(int k = 0; k < CFG_LEN; k++){
+			data[k] = (char)(seq * 5 + k);
+		}
+		rc = i2c_burst_write(&i2c1, saddr, CFG_REG, CFG_LEN, data);
+		*good = memcmp(&slave.regs[CFG_REG], data, CFG_LEN) == 0;
+	}else{
+		for(int k = 0; k < DATA_LEN; k++){
+			slave.regs[DATA_REG + k] = (uint8_t)(seq * 3 + k);
+		}
+		memset(buf, 0, sizeof(buf));
+		rc = i2c_burst_read(&i2c1, saddr, DATA_REG, DATA_LEN, buf);
+		*good = memcmp(&slave.regs[DATA_REG], buf, DATA_LEN) == 0;
+	}
+	*ns = i2c_host_now - t0;
+
+	/* the STOP goes out after the call returns */
+	for(int k = 0; k < 100 && (I2C1->SR2 & I2C_SR2_BUSY); k++){
+		i2c_host_step(i2c_host_now + I2C_HOST_SPIN_NS);
+	}
+	return rc;
+}
+
+/**
+ * int sweep(int write)
+ * @brief every fault of cases[] at every phase of a read or a write
+ */
+static int sweep(int write){
+	int phases = write ? CFG_PHASES : READ_PHASES;
+	uint64_t bound = (uint64_t)I2C_WORST_US(write ? CFG_LEN : DATA_LEN) * 1000U;
+	uint64_t worst = 0, ns;
+	uint32_t runs = 0, errors = 0, bad = 0;
+	int good, rc;
+
+	for(uint32_t c = 0; c < CASES; c++){
+		for(int at = 1; at <= phases; at++){
+			i2c_host_fault(0, cases[c].fault, (uint32_t)at, cases[c].arg);
+			rc = transfer(write, SLAVE_ADDR, &good, &ns);
+			runs++;
+			errors += rc != I2C_OK;
+			if(ns > worst){
+				worst = ns;
+			}
+			if(ns > bound || (rc == I2C_OK && !good) || (rc != I2C_OK && !cases[c].hangs)
+					|| (rc == I2C_OK && cases[c].hangs && at < phases)){
+				if(bad++ < 5){
+					printf("  %s at phase %d: status %d, %s, %llu us\n", cases[c].name, at, rc,
+							good ? "bytes ok" : "bytes wrong", (unsigned long long)(ns / 1000U));
+				}
+			}
+
+			/* the lines let go: the bus works again */
+			i2c_host_fault(0, I2C_HOST_FAULT_NONE, 0, 0);
+			if(transfer(write, SLAVE_ADDR, &good, &ns) != I2C_OK || !good){
+				if(bad++ < 5){
+					printf("  %s at phase %d: the next transfer failed\n", cases[c].name, at);
+				}
+			}
+		}
+	}
+	printf("  %s: %u faults, %u failed, worst %llu us of %llu us\n", write ? "write" : "read", runs, errors,
+			(unsigned long long)(worst / 1000U), (unsigned long long)(bound / 1000U));
+	return bad == 0 && errors > 0;
+}
+
+/**
+ * int run_it(uint64_t limit)
+ * @brief run the model until a completion is posted or limit ns have passed,
+ *        calling i2c_it_poll() every tick as the IMU task does on an overrun
+ */
+static int run_it(uint64_t limit){
+	uint64_t end = i2c_host_now + limit;
+
+	while(!posted && i2c_host_now < end){
+		uint64_t tick = i2c_host_now + TICK_NS;
+
+		while(!posted && i2c_host_step(tick) >= 0){}
+		if(!posted){
+			i2c_it_poll(&i2c1);
+		}
+	}
+	return posted;
+}
+
+int main(void){
+	uint64_t ns, t0;
+	int good, ok;
+	char buf2[DATA_LEN];
+
+	i2c_host_map();
+	i2c_init(&i2c1);
+	i2c_host_reset();
+	for(int k = 0; k < I2C_HOST_REGS; k++){
+		slave.regs[k] = (uint8_t)(k * 7 + 0x40);
+	}
+	i2c_host_attach(0, &slave, SLAVE_ADDR);
+
+	/*clean*/
+	i2c_host_fault(0, I2C_HOST_FAULT_NONE, 0, 0);
+	ok = transfer(0, SLAVE_ADDR, &good, &ns) == I2C_OK && good;
+	ok &= i2c_host_bus[0].phases == READ_PHASES;
+	printf("  read %d bytes: %llu us, attempt deadline %u us\n", DATA_LEN, (unsigned long long)(ns / 1000U),
+			I2C_ATTEMPT_US(DATA_LEN));
+	ok &= ns <= I2C_ATTEMPT_US(DATA_LEN) * 1000ULL;
+	ok &= transfer(1, SLAVE_ADDR, &good, &ns) == I2C_OK && good;
+	check("clean", ok && i2c1.stats.recoveries == 0 && i2c1.stats.failures == 0);
+
+	/*absent*/
+	memset(&i2c1.stats, 0, sizeof(i2c1.stats));
+	ok = transfer(0, ABSENT_ADDR, &good, &ns) == I2C_ERR_NACK;
+	printf("  absent: %u nacks, %u recoveries, %llu us\n", i2c1.stats.nacks, i2c1.stats.recoveries,
+			(unsigned long long)(ns / 1000U));
+	check("absent", ok && i2c1.stats.nacks == I2C_RETRIES + 1 && i2c1.stats.recoveries == I2C_RETRIES + 1
+			&& i2c1.stats.failures == 1 && ns <= I2C_WORST_US(DATA_LEN) * 1000ULL);
+
+	/*recovery*/
+	memset(&i2c1.stats, 0, sizeof(i2c1.stats));
+	i2c_host_bus[0].scl_clocks = 0;
+	i2c_host_fault(0, I2C_HOST_FAULT_SDA_LOW, 8, 5);		// in the third data byte
+	ok = transfer(0, SLAVE_ADDR, &good, &ns) == I2C_OK && good;
+	printf("  sda held: %u clocks, %u timeouts, %llu us\n", i2c_host_bus[0].scl_clocks, i2c1.stats.timeouts,
+			(unsigned long long)(ns / 1000U));
+	check("recovery", ok && i2c_host_bus[0].scl_clocks == 5 + 1 && i2c1.stats.timeouts == 1
+			&& i2c1.stats.recoveries == 1 && i2c1.stats.failures == 0);
+
+	check("read sweep", sweep(0));
+	check("write sweep", sweep(1));
+
+	/*it error*/
+	memset(&i2c1.stats, 0, sizeof(i2c1.stats));
+	posted = 0;
+	i2c_host_fault(0, I2C_HOST_FAULT_NACK, 2, 0);		// the address
+	memset(buf2, 0, sizeof(buf2));
+	ok = i2c_burst_read_it(&i2c1, SLAVE_ADDR, DATA_REG, DATA_LEN, buf, 0, 1) == 0
+		&& i2c_burst_read_it(&i2c1, SLAVE_ADDR, DATA_REG, DATA_LEN, buf2, 0, 1) == 0;
+	ok &= run_it(10 * TICK_NS) && posted_arg == 0;
+	posted = 0;
+	ok &= run_it(10 * TICK_NS) && posted_arg == DATA_LEN && !i2c_busy(&i2c1)
+		&& memcmp(buf2, &slave.regs[DATA_REG], DATA_LEN) == 0;
+	check("it error", ok && i2c1.stats.nacks == 1 && i2c1.stats.recoveries == 0);
+
+	/*it berr*/
+	memset(&i2c1.stats, 0, sizeof(i2c1.stats));
+	posted = 0;
+	i2c_host_fault(0, I2C_HOST_FAULT_BERR, 3, 0);		// the register
+	memset(buf2, 0, sizeof(buf2));
+	ok = i2c_burst_read_it(&i2c1, SLAVE_ADDR, DATA_REG, DATA_LEN, buf, 0, 1) == 0
+		&& i2c_burst_read_it(&i2c1, SLAVE_ADDR, DATA_REG, DATA_LEN, buf2, 0, 1) == 0;
+	while(!posted && i2c_host_step(i2c_host_now + TICK_NS) >= 0){}
+	ok &= posted && posted_arg == 0 && i2c1.stats.berr == 1 && i2c1.stats.recoveries == 0 && i2c_busy(&i2c1);
+	posted = 0;
+	ok &= run_it(10 * TICK_NS) && posted_arg == DATA_LEN && i2c1.stats.recoveries == 1 && !i2c_busy(&i2c1)
+		&& memcmp(buf2, &slave.regs[DATA_REG], DATA_LEN) == 0;
+	check("it berr", ok);
+
+	/*it timeout*/
+	memset(&i2c1.stats, 0, sizeof(i2c1.stats));
+	posted = 0;
+	i2c_host_fault(0, I2C_HOST_FAULT_SDA_LOW, 7, 0);		// the first data byte
+	t0 = i2c_host_now;
+	ok = i2c_burst_read_it(&i2c1, SLAVE_ADDR, DATA_REG, DATA_LEN, buf, 0, 1) == 0;
+	ok &= run_it(20 * TICK_NS) && posted_arg == 0 && !i2c_busy(&i2c1);
+	ns = i2c_host_now - t0;
+	printf("  it timeout: posted after %llu us\n", (unsigned long long)(ns / 1000U));
+	ok &= ns <= (I2C_ATTEMPT_US(DATA_LEN) + I2C_RECOVER_US) * 1000ULL + TICK_NS;
+	i2c_host_fault(0, I2C_HOST_FAULT_NONE, 0, 0);
+	posted = 0;
+	memset(buf, 0, sizeof(buf));
+	ok &= i2c_burst_read_it(&i2c1, SLAVE_ADDR, DATA_REG, DATA_LEN, buf, 0, 1) == 0;
+	ok &= run_it(10 * TICK_NS) && posted_arg == DATA_LEN && memcmp(buf, &slave.regs[DATA_REG], DATA_LEN) == 0;
+	check("it timeout", ok && i2c1.stats.timeouts == 1 && i2c1.stats.recoveries == 1);
+	return failed;
+}
@@ -0,0 +1,172 @@
+/**
+ * i2cmodel.c
+ *	@brief Linux CLI: run i2c.c against a model of I2C1, I2C2 and I2C3
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -I. -o i2cmodel i2cmodel.c i2c_host.c ../Core/Src/i2c.c
+ *
+ * Usage:
+ *  i2cmodel [seconds]		default 1 simulated second per run
+ *
+ * i2c.c runs against the bit-timed model of the three peripherals of
+ * i2c_host.h, stepped in simulated time. Each bus has its own MPU6050-like
+ * slave at DEVICE_ADDR with different register contents.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  init           i2c_init() of the three buses: clocks, pins, NVIC enables
+ *  1 bus .. 3 buses
+ *                 back to back i2c_burst_read_it() of the 14 MPU6050 data
+ *                 bytes on the first 1, 2, 3 buses at once; every read
+ *                 returns the registers of its own slave, and each bus keeps
+ *                 its single bus rate whatever the others do
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "i2c.h"
+#include "sched.h"
+#include "i2c_host.h"
+
+#define SLAVE_ADDR				(0xD0)			// DEVICE_ADDR, MPU6050.h
+#define DATA_REG				(0x3B)			// ACCEL_XOUT_H
+#define DATA_LEN				(14)			// accel, temp, gyro
+
+typedef struct {
+	i2c_host_slave_t slave;
+	char buf[DATA_LEN];
+	int done;				// completion posted by the driver
+	uint32_t reads, bad;
+} bus_t;
+
+static bus_t bus[I2C_HOST_BUSES];
+static int failed;
+
+/**
+ * int sched_post(uint8_t task, uint8_t sig, uint16_t arg)
+ * @brief the driver's completion event; task is the bus index
+ */
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	if(task < I2C_HOST_BUSES && arg == DATA_LEN){
+		bus[task].done = 1;
+	}
+	return 0;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * void start_read(int i)
+ * @brief the data burst of the slave, as MPU6050_read_all_IT() starts it
+ */
+static void start_read(int i){
+	bus_t *b = &bus[i];
+
+	memset(b->buf, 0, sizeof(b->buf));
+	b->done = 0;
+	if(i2c_burst_read_it(i2c_host_bus[i].h, SLAVE_ADDR, DATA_REG, DATA_LEN, b->buf, (uint8_t)i, 1) != 0){
+		b->bad++;
+	}
+}
+
+/**
+ * int run(int active, uint64_t end)
+ * @brief back to back reads on the first `active` buses until `end`
+ */
+static int run(int active, uint64_t end){
+	int i;
+
+	i2c_host_reset();
+	for(i = 0; i < I2C_HOST_BUSES; i++){
+		for(int k = 0; k < I2C_HOST_REGS; k++){
+			bus[i].slave.regs[k] = (uint8_t)(k * 7 + 0x40 * (i + 1));
+		}
+		bus[i].reads = bus[i].bad = 0;
+		i2c_host_attach(i, &bus[i].slave, SLAVE_ADDR);
+	}
+	for(i = 0; i < active; i++){
+		start_read(i);
+	}
+
+	/* on each completion check the data and start the next read */
+	while((i = i2c_host_step(end)) >= 0){
+		bus_t *b = &bus[i];
+
+		if(!b->done){
+			continue;
+		}
+		if(memcmp(b->buf, &b->slave.regs[DATA_REG], DATA_LEN) == 0){
+			b->reads++;
+		}else{
+			b->bad++;
+		}
+		start_read(i);
+	}
+
+	int ok = 1;
+	uint32_t total = 0;
+	double secs = end / 1e9;
+
+	for(i = 0; i < active; i++){
+		printf("  I2C%d  %6.0f reads/s  %7.0f bytes/s  %6.0f irq/s  %u bad  bus %.1f%% busy\n", i + 1,
+				bus[i].reads / secs, bus[i].reads * DATA_LEN / secs, i2c_host_bus[i].irqs / secs, bus[i].bad,
+				100.0 * i2c_host_bus[i].busy_ns / end);
+		ok &= (bus[i].bad == 0) && (bus[i].reads + 1 >= bus[0].reads) && (bus[i].reads <= bus[0].reads + 1);
+		total += bus[i].reads;
+	}
+	printf("  total %6.0f reads/s\n", total / secs);
+	return ok;
+}
+
+static int irq_enabled(IRQn_Type irq){
+	return (NVIC->ISER[irq >> 5] >> (irq & 31)) & 1U;
+}
+/**
+ * int init(void)
+ * @brief i2c_init() of the three buses on reset registers
+ */
+static int init(void){
+	i2c_init(&i2c1);
+	i2c_init(&i2c2);
+	i2c_init(&i2c3);
+
+	uint32_t apb1 = RCC_APB1ENR_I2C1EN | RCC_APB1ENR_I2C2EN | RCC_APB1ENR_I2C3EN;
+	uint32_t ahb1 = RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_GPIOBEN | RCC_AHB1ENR_GPIOCEN;
+
+	return (RCC->APB1ENR & apb1) == apb1
+		&& (RCC->AHB1ENR & ahb1) == ahb1
+		&& irq_enabled(I2C1_EV_IRQn) && irq_enabled(I2C2_EV_IRQn) && irq_enabled(I2C3_EV_IRQn)
+		&& irq_enabled(I2C1_ER_IRQn) && irq_enabled(I2C2_ER_IRQn) && irq_enabled(I2C3_ER_IRQn)
+		&& GPIOB->MODER == ((2U << 16) | (2U << 18) | (2U << 6) | (2U << 20))
+		&& GPIOB->AFR[0] == (9U << 12)
+		&& GPIOB->AFR[1] == ((4U << 0) | (4U << 4) | (4U << 8))
+		&& GPIOA->MODER == (2U << 16) && GPIOA->AFR[1] == (4U << 0)
+		&& GPIOC->MODER == (2U << 18) && GPIOC->AFR[1] == (4U << 4)
+		&& (I2C1->CR1 & I2C_CR1_PE) && (I2C2->CR1 & I2C_CR1_PE) && (I2C3->CR1 & I2C_CR1_PE)
+		&& I2C3->CCR == 80 && I2C3->TRISE == 17;
+}
+
+int main(int argc, char **argv){
+	double seconds = (argc > 1) ? atof(argv[1]) : 1.0;
+	uint64_t end = (uint64_t)(seconds * 1e9);
+	static const char *names[I2C_HOST_BUSES] = { "1 bus", "2 buses", "3 buses" };
+
+	i2c_host_map();
+
+	check("init", init());
+	for(int n = 1; n <= I2C_HOST_BUSES; n++){
+		int ok = run(n, end);
+
+		check(names[n - 1], ok);
+	}
+	return failed;
+}
@@ -0,0 +1,883 @@
+/**
+ * i2csr.c
+ *	@brief Linux CLI: decode I2C from a sigrok capture (.sr) and report bus timing and utilisation
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -o i2csr i2csr.c -lz
+ *
+ * Usage:
+ *  i2csr [-v] [-d] [-c scl,sda] [-p period_us] [-w baseline] [-b baseline [-t pct]] capture.sr
+ *
+ *  -v            one line per transaction
+ *  -d            only print the bytes of every read: address, register and
+ *                the data read, hex, one line per transaction
+ *  -c scl,sda    probe numbers (1..) of the lines, default the probes named SCL and SDA
+ *  -p period_us  sample period of the driver, default the median interval
+ *                between reads of the same register of the same device
+ *  -w file       write the summary metrics as a baseline
+ *  -b file       compare with a baseline: exit 1 if a metric got worse by
+ *                more than -t percent (default 5)
+ *
+ * Example, the capture of this project (PulseView, 500 kHz):
+ *  ./i2csr ../I2C_MPU6050_Pulseview.sr
+ *  ./i2csr -b pulseview.baseline ../I2C_MPU6050_Pulseview.sr
+ *
+ * A .sr file is a zip archive (sigrok file format 2): "metadata" gives the
+ * sample rate, the probe names and the bytes per sample (unitsize), the
+ * samples are in logic-1-1, logic-1-2, ... (or one logic-1), one unit per
+ * sample, probe n in bit n-1. The archive is read with zlib, stored or
+ * deflated members.
+ *
+ * Decoding: START is SDA falling while SCL stays high, STOP SDA rising
+ * while SCL stays high, a bit is SDA at the rising edge of SCL, every 9th
+ * bit the ACK. The first byte after START or repeated START is the
+ * address. A transaction runs from START to STOP. Clock stretching is SCL
+ * held low longer than the nominal low time (mean of the SCL low phases
+ * up to twice the median) by more than one sample; a logic trace cannot
+ * tell whether the slave or the master (a polled driver late to write DR
+ * or to set ACK/STOP) held it, so both count. The ideal wire time of a
+ * transaction is its bytes, 9 bits each, at the median SCL period plus
+ * half a period for every START, repeated START and STOP (the SCL rise
+ * that sets up a repeated START or a STOP is not a bit).
+ *
+ * Report: every transaction's duration, the gap since the previous STOP,
+ * stretching; totals; utilisation of the bus over the capture; per period
+ * of the driver the busy, stretched and idle share; the metrics written
+ * with -w, per second where that makes two captures comparable.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define ZIP_EOCD_SIG			(0x06054b50U)
+#define ZIP_CDIR_SIG			(0x02014b50U)
+#define ZIP_LOCAL_SIG			(0x04034b50U)
+#define ZIP_EOCD_LEN			(22U)
+#define ZIP_STORED				(0)
+#define ZIP_DEFLATED			(8)
+#define SR_PROBES_MAX			(64)
+#define SR_CHUNKS_MAX			(100000)
+#define LOW_HIST_LEN			(4096)		// SCL low phases longer than this are counted as the last bin
+#define KEYS_MAX				(64)		// device/register pairs tracked for the period
+#define TOLERANCE_PCT			(5.0)
+#define XFER_DATA_MAX			(32)		// bytes read that a transaction keeps
+
+/* the capture: metadata and all samples */
+typedef struct {
+	double rate;					// samples per second
+	uint32_t unitsize;
+	char probe[SR_PROBES_MAX][32];
+	uint32_t probes;
+	uint8_t *data;
+	uint64_t samples;
+} sr_capture_t;
+
+/* one START .. STOP */
+typedef struct {
+	uint64_t start, stop;			// samples
+	uint8_t addr;					// first address byte (7 bit address << 1 | R/W)
+	int reg;						// first byte written after the address, -1 if none
+	uint32_t wr, rd;				// data bytes written and read
+	uint8_t data[XFER_DATA_MAX];	// the first bytes read
+	uint32_t restarts;
+	uint32_t bits;					// 9 per complete byte (ACK included)
+	int nack;
+	double stretch;					// samples of SCL held low beyond nominal
+	uint32_t stretches;
+} i2c_xfer_t;
+
+typedef struct {
+	uint64_t n;
+	double sum, min, max;
+} stat_t;
+
+/* the summary of a capture, also the baseline */
+typedef struct {
+	const char *name;
+	double value;
+	int worse;						// +1: higher is worse, -1: lower is worse, 0: any change
+} metric_t;
+
+static int verbose;
+
+/* ---------------------------------------------------------------- zip */
+
+static uint32_t le16(const uint8_t *p){
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t le32(const uint8_t *p){
+	return le16(p) | (le16(p + 2) << 16);
+}
+
+/**
+ * uint8_t *zip_member(const uint8_t *zip, size_t len, const char *name, size_t *out_len)
+ * @brief extract one member of a zip archive held in memory
+ * @step followed:
+ *
+ * 1. Find the end of central directory record, scanning back over a comment
+ * 2. Walk the central directory for the name
+ * 3. Skip the local header, copy (stored) or inflate (deflated) the data
+ *
+ * @return the data (malloc), 0 if there is no such member or it is damaged
+ */
+static uint8_t *zip_member(const uint8_t *zip, size_t len, const char *name, size_t *out_len){
+	const uint8_t *eocd = 0;
+	const uint8_t *p;
+	uint32_t entries, cdir;
+	size_t name_len = strlen(name);
+
+	/*1. Find the end of central directory record*/
+	if(len < ZIP_EOCD_LEN){
+		return 0;
+	}
+	for(p = zip + len - ZIP_EOCD_LEN; p >= zip && p + 0x10000U + ZIP_EOCD_LEN >= zip + len; p--){
+		if(le32(p) == ZIP_EOCD_SIG){
+			eocd = p;
+			break;
+		}
+	}
+	if(eocd == 0){
+		return 0;
+	}
+	entries = le16(eocd + 10);
+	cdir = le32(eocd + 16);
+
+	/*2. Walk the central directory for the name*/
+	p = zip + cdir;
+	for(uint32_t i = 0; i < entries; i++){
+		uint32_t method, csize, usize, nlen, xlen, clen, local;
+		const uint8_t *l, *src;
+		uint8_t *out;
+
+		if(p + 46 > zip + len || le32(p) != ZIP_CDIR_SIG){
+			return 0;
+		}
+		method = le16(p + 10);
+		csize = le32(p + 20);
+		usize = le32(p + 24);
+		nlen = le16(p + 28);
+		xlen = le16(p + 30);
+		clen = le16(p + 32);
+		local = le32(p + 42);
+		if(nlen != name_len || memcmp(p + 46, name, nlen) != 0){
+			p += 46 + nlen + xlen + clen;
+			continue;
+		}
+
+		/*3. Skip the local header, copy or inflate*/
+		l = zip + local;
+		if(l + 30 > zip + len || le32(l) != ZIP_LOCAL_SIG){
+			return 0;
+		}
+		src = l + 30 + le16(l + 26) + le16(l + 28);
+		if(src + csize > zip + len || (out = malloc(usize ? usize : 1U)) == 0){
+			return 0;
+		}
+		if(method == ZIP_STORED && csize == usize){
+			memcpy(out, src, usize);
+		}else if(method == ZIP_DEFLATED){
+			z_stream z;
+			int rc;
+
+			memset(&z, 0, sizeof(z));
+			if(inflateInit2(&z, -MAX_WBITS) != Z_OK){
+				free(out);
+				return 0;
+			}
+			z.next_in = (Bytef *)src;
+			z.avail_in = csize;
+			z.next_out = out;
+			z.avail_out = usize;
+			rc = inflate(&z, Z_FINISH);
+			inflateEnd(&z);
+			if(rc != Z_STREAM_END || z.total_out != usize){
+				free(out);
+				return 0;
+			}
+		}else{
+			free(out);
+			return 0;
+		}
+		*out_len = usize;
+		return out;
+	}
+	return 0;
+}
+
+/* ---------------------------------------------------------------- capture */
+
+/**
+ * double parse_rate(const char *s)
+ * @brief "500 kHz", "24 MHz", "1 GHz", "100 Hz" to samples per second
+ */
+static double parse_rate(const char *s){
+	char *end;
+	double v = strtod(s, &end);
+
+	while(*end == ' '){
+		end++;
+	}
+	if(*end == 'k'){
+		v *= 1e3;
+	}else if(*end == 'M'){
+		v *= 1e6;
+	}else if(*end == 'G'){
+		v *= 1e9;
+	}
+	return v;
+}
+
+/**
+ * int sr_load(const char *path, sr_capture_t *c)
+ * @brief read a sigrok session file: metadata and the logic chunks in order
+ * @step followed:
+ *
+ * 1. The whole archive into memory
+ * 2. metadata: sample rate, unitsize, probe names, the name of the capture file
+ * 3. Samples: <capturefile>-1, -2, ... in order, or <capturefile> alone
+ *
+ * @return 0, -1 with a message on stderr
+ */
+static int sr_load(const char *path, sr_capture_t *c){
+	FILE *f = fopen(path, "rb");
+	uint8_t *zip, *meta, *grown;
+	size_t zlen, mlen, clen;
+	long size;
+	char capfile[64] = "logic-1";
+	char *line, *save;
+
+	memset(c, 0, sizeof(*c));
+	c->unitsize = 1;
+
+	/*1. The whole archive into memory*/
+	if(f == 0){
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	zip = malloc((size_t)size);
+	if(zip == 0 || fread(zip, 1, (size_t)size, f) != (size_t)size){
+		fprintf(stderr, "%s: read error\n", path);
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+	zlen = (size_t)size;
+
+	/*2. metadata*/
+	meta = zip_member(zip, zlen, "metadata", &mlen);
+	if(meta == 0){
+		fprintf(stderr, "%s: not a sigrok session (no metadata)\n", path);
+		return -1;
+	}
+	grown = realloc(meta, mlen + 1U);
+	if(grown == 0){
+		fprintf(stderr, "%s: out of memory\n", path);
+		free(meta);
+		free(zip);
+		return -1;
+	}
+	meta = grown;
+	meta[mlen] = 0;
+	for(line = strtok_r((char *)meta, "\r\n", &save); line; line = strtok_r(0, "\r\n", &save)){
+		unsigned n;
+		char name[32];
+
+		if(strncmp(line, "samplerate=", 11) == 0){
+			c->rate = parse_rate(line + 11);
+		}else if(strncmp(line, "unitsize=", 9) == 0){
+			c->unitsize = (uint32_t)atoi(line + 9);
+		}else if(strncmp(line, "capturefile=", 12) == 0){
+			snprintf(capfile, sizeof(capfile), "%s", line + 12);
+		}else if(sscanf(line, "probe%u=%31s", &n, name) == 2 && n >= 1U && n <= SR_PROBES_MAX){
+			snprintf(c->probe[n - 1U], sizeof(c->probe[0]), "%s", name);
+			if(n > c->probes){
+				c->probes = n;
+			}
+		}
+	}
+	free(meta);
+	if(c->rate <= 0.0 || c->unitsize == 0U || c->unitsize > 8U){
+		fprintf(stderr, "%s: no sample rate or unsupported unitsize\n", path);
+		return -1;
+	}
+
+	/*3. Samples, chunk by chunk*/
+	for(int i = 1; i <= SR_CHUNKS_MAX; i++){
+		char name[80];
+		uint8_t *chunk;
+
+		snprintf(name, sizeof(name), "%s-%d", capfile, i);
+		chunk = zip_member(zip, zlen, name, &clen);
+		if(chunk == 0 && i == 1){
+			chunk = zip_member(zip, zlen, capfile, &clen);
+		}
+		if(chunk == 0){
+			break;
+		}
+		grown = realloc(c->data, c->samples * c->unitsize + clen);
+		if(grown == 0){
+			fprintf(stderr, "%s: out of memory\n", path);
+			free(chunk);
+			free(zip);
+			return -1;
+		}
+		c->data = grown;
+		memcpy(c->data + c->samples * c->unitsize, chunk, clen);
+		c->samples += clen / c->unitsize;
+		free(chunk);
+	}
+	free(zip);
+	if(c->samples == 0U){
+		fprintf(stderr, "%s: no logic samples\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+static uint64_t sample_bits(const sr_capture_t *c, uint64_t i){
+	uint64_t v = 0;
+
+	for(uint32_t b = 0; b < c->unitsize; b++){
+		v |= (uint64_t)c->data[i * c->unitsize + b] << (8U * b);
+	}
+	return v;
+}
+
+static int probe_of(const sr_capture_t *c, const char *name){
+	for(uint32_t i = 0; i < c->probes; i++){
+		if(strcasecmp(c->probe[i], name) == 0){
+			return (int)i + 1;
+		}
+	}
+	return 0;
+}
+
+/* ---------------------------------------------------------------- decoder */
+
+static void stat_add(stat_t *s, double v){
+	if(s->n == 0U || v < s->min){
+		s->min = v;
+	}
+	if(s->n == 0U || v > s->max){
+		s->max = v;
+	}
+	s->sum += v;
+	s->n++;
+}
+
+static double stat_mean(const stat_t *s){
+	return s->n ? s->sum / (double)s->n : 0.0;
+}
+
+/**
+ * double scl_nominal(const sr_capture_t *c, int scl, double *period)
+ * @brief nominal SCL low time and the median SCL period, samples
+ * @step followed:
+ *
+ * 1. Histograms of the low phases and of the periods (falling to falling)
+ * 2. The medians
+ * 3. Nominal low: mean of the low phases up to twice the median
+ */
+static double scl_nominal(const sr_capture_t *c, int scl, double *period){
+	static uint64_t lows[LOW_HIST_LEN], periods[LOW_HIST_LEN];
+	uint64_t fall = 0, prev_fall = 0, n_low = 0, n_per = 0, acc, sum = 0, cnt = 0;
+	uint32_t med_low = 0, med_per = 0;
+	int level = (int)((sample_bits(c, 0) >> (scl - 1)) & 1U);
+
+	/*1. Histograms*/
+	for(uint64_t i = 1; i < c->samples; i++){
+		int now = (int)((sample_bits(c, i) >> (scl - 1)) & 1U);
+
+		if(level && !now){
+			if(prev_fall){
+				periods[(i - prev_fall < LOW_HIST_LEN) ? i - prev_fall : LOW_HIST_LEN - 1]++;
+				n_per++;
+			}
+			prev_fall = i;
+			fall = i;
+		}else if(!level && now && fall){
+			lows[(i - fall < LOW_HIST_LEN) ? i - fall : LOW_HIST_LEN - 1]++;
+			n_low++;
+		}
+		level = now;
+	}
+
+	/*2. The medians*/
+	for(acc = 0; med_low < LOW_HIST_LEN - 1U && (acc += lows[med_low]) <= n_low / 2U; med_low++){
+	}
+	for(acc = 0; med_per < LOW_HIST_LEN - 1U && (acc += periods[med_per]) <= n_per / 2U; med_per++){
+	}
+	*period = med_per;
+
+	/*3. Nominal low*/
+	for(uint32_t d = 1; d <= 2U * med_low && d < LOW_HIST_LEN; d++){
+		sum += lows[d] * d;
+		cnt += lows[d];
+	}
+	return cnt ? (double)sum / (double)cnt : (double)med_low;
+}
+
+/**
+ * uint32_t i2c_decode(...)
+ * @brief every transaction of the capture, in order
+ * @step followed:
+ *
+ * 1. Follow SCL and SDA sample by sample
+ * 2. SDA changing while SCL stays high: START / repeated START or STOP
+ * 3. SCL rising: a bit; 8 make a byte, the 9th is its ACK and counts the
+ *    byte's 9 bits (a rise before a repeated START or STOP is no bit)
+ * 4. SCL low phases inside a transaction longer than nominal + 1 sample: stretching
+ *
+ * @return the number of transactions (*out: malloc)
+ */
+static uint32_t i2c_decode(const sr_capture_t *c, int scl, int sda, double low_nom, i2c_xfer_t **out){
+	i2c_xfer_t *x = 0, *cur = 0;
+	uint32_t n = 0, cap = 0;
+	uint64_t v = sample_bits(c, 0);
+	int s_scl = (int)((v >> (scl - 1)) & 1U), s_sda = (int)((v >> (sda - 1)) & 1U);
+	int bit = 0, first = 0, rd = 0;
+	uint8_t byte = 0;
+	uint64_t fall = 0;
+
+	/*1. Follow SCL and SDA*/
+	for(uint64_t i = 1; i < c->samples; i++){
+		int n_scl, n_sda;
+
+		v = sample_bits(c, i);
+		n_scl = (int)((v >> (scl - 1)) & 1U);
+		n_sda = (int)((v >> (sda - 1)) & 1U);
+		if(n_scl == s_scl && n_sda == s_sda){
+			continue;
+		}
+
+		/*2. SDA changing while SCL stays high*/
+		if(s_scl && n_scl && n_sda != s_sda){
+			if(!n_sda){
+				if(cur){
+					cur->restarts++;
+				}else{
+					if(n == cap){
+						i2c_xfer_t *grown;
+
+						cap = cap ? 2U * cap : 1024U;
+						grown = realloc(x, cap * sizeof(*x));
+						if(grown == 0){
+							fprintf(stderr, "i2csr: out of memory at %u transactions\n", (unsigned)n);
+							free(x);
+							exit(2);
+						}
+						x = grown;
+					}
+					cur = &x[n++];
+					memset(cur, 0, sizeof(*cur));
+					cur->start = i;
+					cur->reg = -1;
+				}
+				bit = 0;
+				first = 1;
+			}else if(cur){
+				cur->stop = i;
+				cur = 0;
+			}
+		}
+
+		/*3. SCL rising: a bit*/
+		if(!s_scl && n_scl && cur){
+			/*4. Stretching*/
+			if(fall && (double)(i - fall) > low_nom + 1.0){
+				cur->stretch += (double)(i - fall) - low_nom;
+				cur->stretches++;
+			}
+			if(bit < 8){
+				byte = (uint8_t)((byte << 1) | (uint8_t)n_sda);
+				bit++;
+			}else{
+				/* the ACK of byte; the master NACKs the last byte it reads, that is no error */
+				cur->bits += 9U;
+				if(first){
+					if(cur->restarts == 0U){
+						cur->addr = byte;
+					}
+					rd = byte & 1U;
+					cur->nack |= n_sda;
+					first = 0;
+				}else if(!rd){
+					if(cur->wr == 0U){
+						cur->reg = byte;
+					}
+					cur->wr++;
+					cur->nack |= n_sda;
+				}else{
+					if(cur->rd < XFER_DATA_MAX){
+						cur->data[cur->rd] = byte;
+					}
+					cur->rd++;
+				}
+				bit = 0;
+			}
+		}
+		if(s_scl && !n_scl){
+			fall = i;
+		}
+		s_scl = n_scl;
+		s_sda = n_sda;
+	}
+	if(cur){
+		/* cut by the end of the capture */
+		n--;
+	}
+	*out = x;
+	return n;
+}
+
+/* ---------------------------------------------------------------- report */
+
+/**
+ * void data_dump(const i2c_xfer_t *x, uint32_t n)
+ * @brief -d: address, register and bytes read of every read transaction
+ */
+static void data_dump(const i2c_xfer_t *x, uint32_t n){
+	for(uint32_t i = 0; i < n; i++){
+		if(x[i].rd == 0U){
+			continue;
+		}
+		printf("%02x %02x", x[i].addr >> 1, x[i].reg & 0xFF);
+		for(uint32_t b = 0; b < x[i].rd && b < XFER_DATA_MAX; b++){
+			printf(" %02x", x[i].data[b]);
+		}
+		printf("\n");
+	}
+}
+
+static int cmp_u64(const void *a, const void *b){
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * double driver_period(const i2c_xfer_t *x, uint32_t n)
+ * @brief the median interval between transactions to the most read device/register, samples
+ * @step followed:
+ *
+ * 1. Count the (address, register) pairs, take the most frequent
+ * 2. Median of the intervals between its transactions
+ */
+static double driver_period(const i2c_xfer_t *x, uint32_t n){
+	int key[KEYS_MAX];
+	uint32_t count[KEYS_MAX], keys = 0, best = 0, m = 0;
+	uint64_t *iv, last = 0;
+	double med;
+
+	/*1. The most frequent pair*/
+	for(uint32_t i = 0; i < n; i++){
+		int k = (x[i].addr << 8) | (x[i].reg & 0xFF), j;
+
+		for(j = 0; j < (int)keys && key[j] != k; j++){
+		}
+		if(j == (int)keys){
+			if(keys == KEYS_MAX){
+				continue;
+			}
+			key[keys] = k;
+			count[keys++] = 0;
+		}
+		if(++count[j] > count[best]){
+			best = (uint32_t)j;
+		}
+	}
+	if(keys == 0U || count[best] < 2U){
+		return 0.0;
+	}
+
+	/*2. Median of its intervals*/
+	iv = malloc(count[best] * sizeof(*iv));
+	for(uint32_t i = 0; i < n; i++){
+		if(((x[i].addr << 8) | (x[i].reg & 0xFF)) != key[best]){
+			continue;
+		}
+		if(last){
+			iv[m++] = x[i].start - last;
+		}
+		last = x[i].start;
+	}
+	qsort(iv, m, sizeof(*iv), cmp_u64);
+	med = (double)iv[m / 2U];
+	free(iv);
+	return med;
+}
+
+/**
+ * uint32_t i2c_report(...)
+ * @brief print the transactions (-v) and the summary, fill the metrics
+ * @step followed:
+ *
+ * 1. Per transaction: duration, gap since the previous STOP, stretching, ideal wire time
+ * 2. Per driver period: busy, stretched, idle share
+ * 3. Summary and metrics
+ *
+ * @return the number of metrics
+ */
+static uint32_t i2c_report(const sr_capture_t *c, const i2c_xfer_t *x, uint32_t n, double low_nom, double scl_per,
+		double period, metric_t *m){
+	double us = 1e6 / c->rate;
+	double secs = (double)c->samples / c->rate;
+	stat_t dur = { 0 }, gap = { 0 }, win = { 0 }, win_st = { 0 };
+	uint64_t busy = 0, stretches = 0, nacks = 0, wr = 0, rd = 0;
+	double stretch = 0.0, ideal = 0.0;
+	uint32_t k = 0;
+
+	/*1. Per transaction*/
+	if(verbose){
+		printf("%12s %9s %5s %-5s %3s %3s %3s %9s %9s\n", "start_us", "dur_us", "addr", "reg", "wr", "rd", "ack",
+				"gap_us", "strch_us");
+	}
+	for(uint32_t i = 0; i < n; i++){
+		uint64_t d = x[i].stop - x[i].start;
+
+		stat_add(&dur, (double)d * us);
+		if(i > 0U){
+			stat_add(&gap, (double)(x[i].start - x[i - 1].stop) * us);
+		}
+		busy += d;
+		stretch += x[i].stretch;
+		stretches += x[i].stretches;
+		ideal += (x[i].bits + 0.5 * (2U + x[i].restarts)) * scl_per;
+		nacks += (uint64_t)x[i].nack;
+		wr += x[i].wr;
+		rd += x[i].rd;
+		if(verbose){
+			char reg[8] = "-";
+
+			if(x[i].reg >= 0){
+				snprintf(reg, sizeof(reg), "0x%02X", (unsigned)(x[i].reg & 0xFF));
+			}
+			printf("%12.1f %9.1f 0x%02X %-5s %3u %3u %3s %9.1f %9.1f\n", (double)x[i].start * us, (double)d * us,
+					x[i].addr >> 1, reg, (unsigned)x[i].wr, (unsigned)x[i].rd, x[i].nack ? "NAK" : "ACK",
+					i ? (double)(x[i].start - x[i - 1].stop) * us : 0.0, x[i].stretch * us);
+		}
+	}
+
+	/*2. Per driver period, from the first START*/
+	if(period > 0.0){
+		uint32_t j = 0;
+
+		for(double w0 = (double)x[0].start; w0 + period <= (double)x[n - 1].stop; w0 += period){
+			double w1 = w0 + period, b = 0.0, s = 0.0;
+
+			while(j < n && (double)x[j].stop <= w0){
+				j++;
+			}
+			for(uint32_t i = j; i < n && (double)x[i].start < w1; i++){
+				double a = (double)x[i].start > w0 ? (double)x[i].start : w0;
+				double e = (double)x[i].stop < w1 ? (double)x[i].stop : w1;
+
+				b += e - a;
+				if((double)x[i].start >= w0){
+					s += x[i].stretch;
+				}
+			}
+			stat_add(&win, 100.0 * b / period);
+			stat_add(&win_st, 100.0 * s / period);
+		}
+	}
+
+	/*3. Summary*/
+	printf("capture       %.3f s, %.0f kHz, %llu samples (resolution %.2f us)\n", secs, c->rate / 1e3,
+			(unsigned long long)c->samples, us);
+	printf("scl           %.1f kHz (median period %.2f us), nominal low %.2f us\n", scl_per > 0 ? c->rate / scl_per / 1e3
+			: 0.0, scl_per * us, low_nom * us);
+	printf("transactions  %u (%.1f/s), %llu bytes written, %llu read, %llu NACK\n", (unsigned)n, n / secs,
+			(unsigned long long)wr, (unsigned long long)rd, (unsigned long long)nacks);
+	printf("duration      min %.1f  mean %.1f  max %.1f us\n", dur.min, stat_mean(&dur), dur.max);
+	printf("gap           min %.1f  mean %.1f  max %.1f us (STOP to next START)\n", gap.min, stat_mean(&gap), gap.max);
+	printf("stretching    %llu times, %.1f us in all, %.1f us/s\n", (unsigned long long)stretches, stretch * us,
+			stretch * us / secs);
+	printf("utilisation   busy %.2f %% of the capture, ideal wire time %.1f %% of busy\n",
+			100.0 * (double)busy / (double)c->samples, busy ? 100.0 * ideal / (double)busy : 0.0);
+	if(win.n){
+		printf("per period    %.1f us (%u periods): busy min %.1f  mean %.1f  max %.1f %%, stretched %.2f %%, idle %.1f %%\n",
+				period * us, (unsigned)win.n, win.min, stat_mean(&win), win.max, stat_mean(&win_st),
+				100.0 - stat_mean(&win));
+	}
+
+	m[k++] = (metric_t){ "scl_khz", scl_per > 0 ? c->rate / scl_per / 1e3 : 0.0, 0 };
+	m[k++] = (metric_t){ "xfers_per_s", n / secs, 0 };
+	m[k++] = (metric_t){ "nacks_per_s", nacks / secs, 1 };
+	m[k++] = (metric_t){ "xfer_mean_us", stat_mean(&dur), 1 };
+	m[k++] = (metric_t){ "stretch_us_per_s", stretch * us / secs, 1 };
+	m[k++] = (metric_t){ "busy_pct", 100.0 * (double)busy / (double)c->samples, 1 };
+	m[k++] = (metric_t){ "wire_eff_pct", busy ? 100.0 * ideal / (double)busy : 0.0, -1 };
+	m[k++] = (metric_t){ "period_us", period * us, 0 };
+	return k;
+}
+
+/* ---------------------------------------------------------------- baseline */
+
+static int baseline_write(const char *path, const metric_t *m, uint32_t k, const char *capture){
+	FILE *f = fopen(path, "w");
+
+	if(f == 0){
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	fprintf(f, "# i2csr baseline of %s\n", capture);
+	for(uint32_t i = 0; i < k; i++){
+		fprintf(f, "%s %.6g\n", m[i].name, m[i].value);
+	}
+	fclose(f);
+	return 0;
+}
+
+/**
+ * int baseline_compare(const char *path, const metric_t *m, uint32_t k, double tol)
+ * @brief every metric of the baseline against this capture
+ * @step followed:
+ *
+ * 1. Read "name value" lines, '#' comments
+ * 2. Relative change; worse in the bad direction (any direction for the
+ *    rate and the period) by more than tol percent fails
+ *
+ * @return 0 all within, 1 a regression, -1 no baseline
+ */
+static int baseline_compare(const char *path, const metric_t *m, uint32_t k, double tol){
+	FILE *f = fopen(path, "r");
+	char line[128], name[64];
+	double old;
+	int failed = 0;
+
+	if(f == 0){
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	printf("baseline %s, tolerance %.1f %%\n", path, tol);
+
+	/*1. Read the lines*/
+	while(fgets(line, sizeof(line), f)){
+		uint32_t i;
+		double rel;
+		int bad;
+
+		if(line[0] == '#' || sscanf(line, "%63s %lf", name, &old) != 2){
+			continue;
+		}
+		for(i = 0; i < k && strcmp(m[i].name, name) != 0; i++){
+		}
+		if(i == k){
+			printf("  %-16s not measured\n", name);
+			continue;
+		}
+
+		/*2. Relative change*/
+		if(old != 0.0){
+			rel = 100.0 * (m[i].value - old) / (old < 0 ? -old : old);
+		}else{
+			rel = m[i].value == 0.0 ? 0.0 : (m[i].value > 0 ? 1e9 : -1e9);
+		}
+		bad = (m[i].worse > 0 && rel > tol) || (m[i].worse < 0 && rel < -tol)
+				|| (m[i].worse == 0 && (rel > tol || rel < -tol));
+		printf("%-16s %-4s %.6g -> %.6g (%+.1f %%)\n", name, bad ? "FAIL" : "ok", old, m[i].value,
+				rel > 1e8 || rel < -1e8 ? 0.0 : rel);
+		failed |= bad;
+	}
+	fclose(f);
+	return failed;
+}
+
+int main(int argc, char **argv){
+	sr_capture_t cap;
+	i2c_xfer_t *x;
+	metric_t m[16];
+	const char *wpath = 0, *bpath = 0;
+	double tol = TOLERANCE_PCT, period_us = 0.0, period, low_nom, scl_per;
+	int scl = 0, sda = 0, dump = 0, opt, rc = 0;
+	uint32_t n, k;
+
+	while((opt = getopt(argc, argv, "vdc:p:w:b:t:")) != -1){
+		switch(opt){
+		case 'v':
+			verbose = 1;
+			break;
+		case 'd':
+			dump = 1;
+			break;
+		case 'c':
+			if(sscanf(optarg, "%d,%d", &scl, &sda) != 2){
+				fprintf(stderr, "-c scl,sda\n");
+				return 2;
+			}
+			break;
+		case 'p':
+			period_us = atof(optarg);
+			break;
+		case 'w':
+			wpath = optarg;
+			break;
+		case 'b':
+			bpath = optarg;
+			break;
+		case 't':
+			tol = atof(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-v] [-d] [-c scl,sda] [-p period_us] [-w baseline] [-b baseline [-t pct]] capture.sr\n",
+					argv[0]);
+			return 2;
+		}
+	}
+	if(optind != argc - 1){
+		fprintf(stderr, "usage: %s [-v] [-d] [-c scl,sda] [-p period_us] [-w baseline] [-b baseline [-t pct]] capture.sr\n",
+				argv[0]);
+		return 2;
+	}
+	if(sr_load(argv[optind], &cap) != 0){
+		return 2;
+	}
+	if(scl == 0){
+		scl = probe_of(&cap, "SCL");
+		sda = probe_of(&cap, "SDA");
+	}
+	if(scl < 1 || sda < 1 || (uint32_t)scl > 8U * cap.unitsize || (uint32_t)sda > 8U * cap.unitsize || scl == sda){
+		fprintf(stderr, "%s: no probes named SCL and SDA, give them with -c\n", argv[optind]);
+		return 2;
+	}
+
+	low_nom = scl_nominal(&cap, scl, &scl_per);
+	n = i2c_decode(&cap, scl, sda, low_nom, &x);
+	if(n == 0U){
+		fprintf(stderr, "%s: no I2C transaction on probes %d (SCL), %d (SDA)\n", argv[optind], scl, sda);
+		return 2;
+	}
+	if(dump){
+		data_dump(x, n);
+		free(x);
+		free(cap.data);
+		return 0;
+	}
+	period = period_us > 0.0 ? period_us * cap.rate / 1e6 : driver_period(x, n);
+	k = i2c_report(&cap, x, n, low_nom, scl_per, period, m);
+
+	if(wpath && baseline_write(wpath, m, k, argv[optind]) != 0){
+		rc = 2;
+	}
+	if(bpath){
+		int r = baseline_compare(bpath, m, k, tol);
+
+		rc = r < 0 ? 2 : r;
+	}
+	free(x);
+	free(cap.data);
+	return rc;
+}
@@ -0,0 +1,231 @@
+/**
+ * imubuscheck.c
+ *	@brief Linux CLI: run imubus.c with simulated MPU6050s on the I2C model
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -I. -o imubuscheck imubuscheck.c i2c_host.c ../Core/Src/imubus.c \
+ *     ../Core/Src/MPU6050.c ../Core/Src/i2c.c
+ *
+ * Usage:
+ *  imubuscheck [seconds]		default 1 simulated second per run
+ *
+ * The firmware's imubus.c, MPU6050.c and i2c.c run on the peripheral model
+ * of i2c_host.h, with one simulated MPU6050 per device on I2C1. The tick
+ * comes every period of simulated time and the completion events are
+ * handed to imubus_done() as the IMU task would. After every round each
+ * sensor gets a new round number in its data registers, so a row whose
+ * samples come from different rounds is caught.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  1 device       every tick a round, load = one read per period
+ *  2 devices      AD0 low and high: both samples of every row from the same
+ *                 round, the second read completes exactly one read plus
+ *                 the STOP after the first (no idle bus in between)
+ *  5 devices      IMUBUS_MAX_DEVICES, one in flight and a full I2C queue
+ *  failed read    2 devices, the address of one read NACKed: that round is
+ *                 dropped whole, every later row still from one round
+ *  overrun        3 devices at 4 ms (4.7 ms of reads): every other tick is
+ *                 an overrun, nothing is lost or mixed up
+ *  report         the TELEM_TYPE_BUS payload matches the statistics
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "imubus.h"
+#include "sched.h"
+#include "telemetry.h"
+#include "i2c_host.h"
+
+#define TASK_IMU				(0)
+#define SIG_IMU_DONE			(2)
+#define EVENTS_MAX				(16)
+#define ROUND_REG				(ACCEL_XOUT_H_REG)	// round number, in every sample
+#define BIT_CYCLES				(16000000U / 100000U)
+
+static mpu6050_t dev[IMUBUS_MAX_DEVICES];
+static i2c_host_slave_t sensor[IMUBUS_MAX_DEVICES];
+static imubus_t bus;
+static int failed;
+
+/* events posted by the driver, dispatched by the test loop */
+static sched_event_t events[EVENTS_MAX];
+static uint32_t events_len;
+
+/* last TELEM_TYPE_BUS frame */
+static uint8_t report[TELEM_MAX_PAYLOAD];
+static uint32_t report_len;
+
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	if(events_len == EVENTS_MAX){
+		return -1;
+	}
+	events[events_len].task = task;
+	events[events_len].sig = sig;
+	events[events_len].arg = arg;
+	events_len++;
+	return 0;
+}
+
+int telem_send_bytes(uint8_t type, uint32_t cycles, const uint8_t *payload, uint32_t len){
+	if(type == TELEM_TYPE_BUS && len <= sizeof(report)){
+		memcpy(report, payload, len);
+		report_len = len;
+	}
+	return 0;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+static uint32_t u32_at(const uint8_t *p){
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * void set_round(uint32_t round)
+ * @brief new data in every sensor: the round number, then a per-sensor pattern
+ */
+static void set_round(uint32_t round){
+	for(int d = 0; d < IMUBUS_MAX_DEVICES; d++){
+		sensor[d].regs[ROUND_REG] = (uint8_t)round;
+		for(int k = 1; k < MPU6050_BURST_LEN; k++){
+			sensor[d].regs[ROUND_REG + k] = (uint8_t)(d * 31 + k + round);
+		}
+	}
+}
+
+/**
+ * int run(int n, uint32_t period_us, uint64_t end, uint32_t fault_round, uint32_t *rows, uint32_t *bad)
+ * @brief n devices on I2C1, a tick every period_us, until end (ns); the
+ *        address of the first read after round fault_round is NACKed (0: none)
+ * @return rounds completed
+ */
+static uint32_t run(int n, uint32_t period_us, uint64_t end, uint32_t fault_round, uint32_t *rows, uint32_t *bad){
+	static const uint8_t addr[IMUBUS_MAX_DEVICES] = {
+		MPU6050_ADDR_AD0_LOW, MPU6050_ADDR_AD0_HIGH, 0xD4, 0xD6, 0xD8
+	};
+	mpu6050_raw_t row[IMUBUS_MAX_DEVICES];
+	uint64_t tick = 0;
+	uint32_t round = 0;
+
+	i2c_host_reset();
+	events_len = 0;
+	imubus_init(&bus, TASK_IMU, SIG_IMU_DONE);
+	for(int d = 0; d < n; d++){
+		/* as MPU6050_init() leaves the device (it reads WHO_AM_I with the blocking calls) */
+		mpu6050_t m = MPU6050_DEVICE(&i2c1, addr[d]);
+
+		dev[d] = m;
+		mpu6050_ring_init(&dev[d].samples);
+		dev[d].present = 1;
+		i2c_host_attach(0, &sensor[d], addr[d]);
+		imubus_add(&bus, &dev[d]);
+	}
+	set_round(round);
+	*rows = *bad = 0;
+
+	while(i2c_host_now < end){
+		/*1. the timer tick*/
+		if(i2c_host_now >= tick){
+			imubus_tick(&bus);
+			tick += period_us * 1000ULL;
+		}
+		i2c_host_step(tick < end ? tick : end);
+
+		/*2. the IMU task: completions, rows*/
+		for(uint32_t e = 0; e < events_len; e++){
+			if(events[e].sig != SIG_IMU_DONE || imubus_done(&bus, events[e].arg) != 1){
+				continue;
+			}
+			set_round(++round);
+			if(round == fault_round){
+				i2c_host_fault(0, I2C_HOST_FAULT_NACK, 3, 0);		// the STOP of this round, START, address
+			}
+			while(1){
+				int d;
+
+				for(d = 0; d < n && mpu6050_ring_count(&dev[d].samples); d++){}
+				if(d < n){
+					break;
+				}
+				for(d = 0; d < n; d++){
+					mpu6050_ring_pop(&dev[d].samples, &row[d]);
+					*bad += (row[d].raw[0] != row[0].raw[0]) || (row[d].raw[1] != (uint8_t)(d * 31 + 1 + row[0].raw[0]));
+				}
+				(*rows)++;
+			}
+		}
+		events_len = 0;
+	}
+	printf("  %d x 14 bytes every %u us: %u rounds, %u overruns, %u errors, %u partial, load %.1f%%, efficiency %.1f%%, offsets",
+			n, period_us, bus.stats.rounds, bus.stats.overruns, bus.stats.errors, bus.stats.partial,
+			imubus_load_permille(&bus) / 10.0, imubus_efficiency_permille(&bus) / 10.0);
+	for(int d = 0; d < n; d++){
+		printf(" %u", bus.stats.offset_max[d] / (SystemCoreClock / 1000000U));
+	}
+	printf(" us, %u nacks\n", i2c_host_bus[0].nacks);
+	return bus.stats.rounds;
+}
+
+int main(int argc, char **argv){
+	double seconds = (argc > 1) ? atof(argv[1]) : 1.0;
+	uint64_t end = (uint64_t)(seconds * 1e9);
+	uint32_t ticks = (uint32_t)(end / 4000000U);
+	uint32_t read_cycles = IMUBUS_READ_BITS(MPU6050_BURST_LEN) * BIT_CYCLES;
+	uint32_t rounds, rows, bad;
+
+	i2c_host_map();
+
+	/*1 device*/
+	rounds = run(1, 4000, end, 0, &rows, &bad);
+	check("1 device", rounds + 1 >= ticks && rows == rounds && bad == 0 && bus.stats.overruns == 0
+			&& bus.stats.offset_max[0] == read_cycles
+			&& imubus_load_permille(&bus) >= 385 && imubus_load_permille(&bus) <= 390);
+
+	/*2 devices*/
+	rounds = run(2, 4000, end, 0, &rows, &bad);
+	check("2 devices", rounds + 1 >= ticks && rows == rounds && bad == 0 && bus.stats.overruns == 0
+			&& bus.stats.offset_max[1] - bus.stats.offset_max[0] == read_cycles + BIT_CYCLES
+			&& imubus_efficiency_permille(&bus) >= 995);
+
+	/*5 devices*/
+	rounds = run(IMUBUS_MAX_DEVICES, 10000, end, 0, &rows, &bad);
+	check("5 devices", rounds + 1 >= end / 10000000U && rows == rounds && bad == 0
+			&& bus.stats.overruns == 0 && bus.stats.errors == 0
+			&& bus.stats.offset_max[IMUBUS_MAX_DEVICES - 1] == IMUBUS_MAX_DEVICES * read_cycles + (IMUBUS_MAX_DEVICES - 1) * BIT_CYCLES);
+
+	/*failed read*/
+	rounds = run(2, 4000, end, 10, &rows, &bad);
+	check("failed read", rounds + 1 >= ticks && rows + 1 == rounds && bad == 0 && bus.stats.errors == 1
+			&& bus.stats.partial == 1 && i2c_host_bus[0].nacks == 1);
+
+	/*overrun*/
+	rounds = run(3, 4000, end, 0, &rows, &bad);
+	check("overrun", rounds + 1 >= ticks / 2 && rows == rounds && bad == 0 && bus.stats.errors == 0
+			&& bus.stats.overruns + 1 >= ticks / 2);
+
+	/*report*/
+	{
+		imubus_stats_t s = bus.stats;
+		uint32_t load = imubus_load_permille(&bus);
+		uint32_t eff = imubus_efficiency_permille(&bus);
+
+		imubus_report(&bus);
+		check("report", report_len == TELEM_BUS_REPORT_LEN(3)
+				&& u32_at(&report[0]) == SystemCoreClock && u32_at(&report[4]) == s.rounds
+				&& u32_at(&report[8]) == s.overruns && u32_at(&report[12]) == s.errors
+				&& u32_at(&report[16]) == load && u32_at(&report[20]) == eff
+				&& u32_at(&report[24]) == s.round_max && u32_at(&report[28]) == 3
+				&& u32_at(&report[40]) == s.offset_max[2] && bus.stats.rounds == 0);
+	}
+	return failed;
+}
@@ -0,0 +1,412 @@
+/**
+ * kernelcheck.c
+ *	@brief Linux CLI: run kernel.c on a ucontext port (switch order, priorities, blocking)
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -I../Core/Inc -o kernelcheck kernelcheck.c ../Core/Src/kernel.c
+ *
+ * Usage:
+ *  kernelcheck
+ *
+ * The port layer (kernel_port.c on the target) is replaced here: every
+ * task is a ucontext on its own host stack, os_port_request_switch()
+ * swaps to os_next at once, as PendSV does as soon as the critical section
+ * that requested it ends; interrupts are masked for the whole run, so that
+ * is the same point. Time only moves in the idle task: its tickless sleep
+ * advances os_time() to the next wake-up (one tick for short periods), or
+ * to an interrupt raised with host_irq_at(). A task calling os_tick() is
+ * SysTick arriving while it runs. When every task is blocked with nothing
+ * to wake it the run ends as a deadlock.
+ *
+ * Checks, each printed as ok/FAIL, with the order the tasks ran in:
+ *  switch order   yield round robins a priority, delays wake in tick
+ *                 order, the idle task sleeps tickless over long delays;
+ *                 context switches and suppressed ticks counted
+ *  priorities     a give from a low priority task switches to the woken
+ *                 higher one at once; waiters are woken highest priority
+ *                 first, not in the order they started waiting
+ *  round robin    SysTick rotates busy tasks of one priority
+ *  timeouts       take with a timeout fails after exactly that many
+ *                 ticks; a give from an interrupt wakes a task waiting
+ *                 forever; take(0) polls
+ *  queue          a producer blocks while the queue is full, items come
+ *                 out in order, receive(0) on an empty queue fails
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include "kernel.h"
+#include "stack.h"
+
+#define HOST_TASKS				(8)
+#define HOST_STACK_BYTES		(64 * 1024)
+#define TASK_STACK_WORDS		(64)		// what the kernel is given; the host stack is separate
+#define TRACE_LEN				(256)
+
+typedef struct {
+	os_tcb_t *tcb;
+	ucontext_t uc;
+	void *stack;
+	void (*entry)(void *);
+	void *arg;
+} host_ctx_t;
+
+static host_ctx_t ctx[HOST_TASKS];
+static uint32_t ctx_len;
+static ucontext_t main_uc;
+static int deadlock;
+static uint32_t irq_tick;
+static void (*irq_fn)(void);
+
+static os_tcb_t tcb[HOST_TASKS];
+static uint32_t stacks[HOST_TASKS][TASK_STACK_WORDS] __attribute__((aligned(8)));
+static char trace_buf[TRACE_LEN];
+static int failed;
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+static void trace(const char *s){
+	if(trace_buf[0]){
+		strncat(trace_buf, " ", TRACE_LEN - strlen(trace_buf) - 1U);
+	}
+	strncat(trace_buf, s, TRACE_LEN - strlen(trace_buf) - 1U);
+}
+
+/* ---------------------------------------------------------------- port */
+
+/* stack.c reads linker symbols; only the painting is needed here */
+void stack_paint(uint32_t *base, uint32_t words){
+	for(uint32_t i = 0; i < words; i++){
+		base[i] = STACK_PAINT;
+	}
+}
+
+static host_ctx_t *ctx_of(os_tcb_t *t){
+	for(uint32_t i = 0; i < ctx_len; i++){
+		if(ctx[i].tcb == t){
+			return &ctx[i];
+		}
+	}
+	fprintf(stderr, "no context for task %s\n", t ? t->name : "?");
+	exit(2);
+}
+
+static void task_start(int i){
+	ctx[i].entry(ctx[i].arg);
+	os_task_exit();
+}
+
+void os_port_init_stack(os_tcb_t *t, void (*entry)(void *), void *arg){
+	host_ctx_t *c = &ctx[ctx_len];
+
+	c->tcb = t;
+	c->entry = entry;
+	c->arg = arg;
+	c->stack = malloc(HOST_STACK_BYTES);
+	getcontext(&c->uc);
+	c->uc.uc_stack.ss_sp = c->stack;
+	c->uc.uc_stack.ss_size = HOST_STACK_BYTES;
+	c->uc.uc_link = 0;
+	makecontext(&c->uc, (void (*)(void))task_start, 1, (int)ctx_len);
+	ctx_len++;
+}
+
+/* returns here, not never, once a check ends the run with host_stop() */
+void os_port_start(void){
+	swapcontext(&main_uc, &ctx_of(os_current)->uc);
+}
+
+void os_port_request_switch(void){
+	os_tcb_t *prev = os_current;
+
+	if(os_next == prev){
+		return;
+	}
+	os_current = os_next;
+	os_stats.ctxsw_count++;
+	swapcontext(&ctx_of(prev)->uc, &ctx_of(os_current)->uc);
+}
+
+uint32_t os_port_tick_step(void){
+	return 1;
+}
+
+static void host_stop(void){
+	setcontext(&main_uc);
+}
+
+/**
+ * void os_port_tickless_idle(uint32_t ticks)
+ * @brief sleep: to the interrupt, to the wake-up tick, or one tick for short periods
+ */
+void os_port_tickless_idle(uint32_t ticks){
+	void (*fn)(void) = irq_fn;
+
+	if(fn && (ticks == OS_WAIT_FOREVER || irq_tick - os_time() < ticks)){
+		/* woken early by the interrupt: the whole ticks that passed */
+		irq_fn = 0;
+		if(irq_tick != os_time()){
+			os_stats.idle_ticks_suppressed += irq_tick - os_time();
+			os_tick_advance(irq_tick - os_time());
+		}
+		fn();
+		return;
+	}
+	if(ticks == OS_WAIT_FOREVER){
+		deadlock = 1;
+		host_stop();
+	}
+	if(ticks < OS_TICKLESS_MIN_TICKS){
+		os_tick_advance(1);
+		return;
+	}
+	os_stats.tickless_entries++;
+	os_stats.idle_ticks_suppressed += ticks - 1U;
+	os_tick_advance(ticks);
+}
+
+static void host_irq_at(uint32_t tick, void (*fn)(void)){
+	irq_tick = tick;
+	irq_fn = fn;
+}
+
+/**
+ * void host_reset(void)
+ * @brief forget the contexts of the previous run, clear trace and counters
+ */
+static void host_reset(void){
+	for(uint32_t i = 0; i < ctx_len; i++){
+		free(ctx[i].stack);
+	}
+	ctx_len = 0;
+	deadlock = 0;
+	irq_fn = 0;
+	trace_buf[0] = 0;
+	memset((void *)&os_stats, 0, sizeof(os_stats));
+	os_init();
+}
+
+static void task(int n, const char *name, void (*entry)(void *), uint8_t prio){
+	os_task_create(&tcb[n], name, entry, 0, stacks[n], TASK_STACK_WORDS, prio);
+}
+
+/* ---------------------------------------------------------------- switch order */
+
+static void order_a(void *arg){
+	trace("A1");
+	os_yield();
+	trace("A2");
+	os_delay(2);
+	trace("A3");
+}
+
+static void order_c(void *arg){
+	trace("C1");
+	os_yield();
+	trace("C2");
+	os_delay(1);
+	trace("C3");
+}
+
+static void order_b(void *arg){
+	trace("B1");
+	os_delay(5);
+	trace("B2");
+	host_stop();
+}
+
+/**
+ * int switch_order(void)
+ * @brief A and C share priority 1, B has 2
+ */
+static int switch_order(void){
+	host_reset();
+	task(0, "A", order_a, 1);
+	task(1, "B", order_b, 2);
+	task(2, "C", order_c, 1);
+	os_start();
+	printf("  %s, %u switches, %u tickless, %u ticks suppressed\n", trace_buf, (unsigned)os_stats.ctxsw_count,
+			(unsigned)os_stats.tickless_entries, (unsigned)os_stats.idle_ticks_suppressed);
+
+	/* A C A C B, idle, C, idle, A, idle (3 ticks tickless), B */
+	return !deadlock && strcmp(trace_buf, "A1 C1 A2 C2 B1 C3 A3 B2") == 0 && os_time() == 5
+			&& os_stats.ctxsw_count == 10 && os_stats.tickless_entries == 1 && os_stats.idle_ticks_suppressed == 2;
+}
+
+/* ---------------------------------------------------------------- priorities */
+
+static os_sem_t sem;
+
+static void prio_h(void *arg){
+	trace("H1");
+	os_delay(1);
+	trace("H2");
+	os_sem_take(&sem, OS_WAIT_FOREVER);
+	trace("H3");
+}
+
+static void prio_m(void *arg){
+	trace("M1");
+	os_sem_take(&sem, OS_WAIT_FOREVER);
+	trace("M2");
+}
+
+static void prio_l(void *arg){
+	trace("L1");
+	os_delay(2);
+	trace("L2");
+	os_sem_give(&sem);
+	trace("L3");
+	os_sem_give(&sem);
+	trace("L4");
+	host_stop();
+}
+
+/**
+ * int priorities(void)
+ * @brief M waits on the semaphore before H; L gives twice
+ */
+static int priorities(void){
+	host_reset();
+	os_sem_init(&sem, 0);
+	task(0, "H", prio_h, 1);
+	task(1, "M", prio_m, 3);
+	task(2, "L", prio_l, 5);
+	os_start();
+	printf("  %s\n", trace_buf);
+	return !deadlock && strcmp(trace_buf, "H1 M1 L1 H2 L2 H3 L3 M2 L4") == 0 && sem.count == 0 && sem.waiters == 0;
+}
+
+/* ---------------------------------------------------------------- round robin */
+
+static void rr_1(void *arg){
+	trace("R1");
+	os_tick();
+	trace("R1b");
+	os_tick();
+	trace("R1c");
+	host_stop();
+}
+
+static void rr_2(void *arg){
+	trace("R2");
+	os_tick();
+	trace("R2b");
+	os_tick();
+	trace("R2c");
+}
+
+static int round_robin(void){
+	host_reset();
+	task(0, "R1", rr_1, 4);
+	task(1, "R2", rr_2, 4);
+	os_start();
+	printf("  %s\n", trace_buf);
+	return !deadlock && strcmp(trace_buf, "R1 R2 R1b R2b R1c") == 0 && os_time() == 4;
+}
+
+/* ---------------------------------------------------------------- timeouts */
+
+static int to_result[4];
+static uint32_t to_time[4];
+
+static void give_from_isr(void){
+	os_sem_give(&sem);
+}
+
+static void timeout_task(void *arg){
+	to_result[0] = os_sem_take(&sem, 3);
+	to_time[0] = os_time();
+	host_irq_at(10, give_from_isr);
+	to_result[1] = os_sem_take(&sem, OS_WAIT_FOREVER);
+	to_time[1] = os_time();
+	to_result[2] = os_sem_take(&sem, 0);
+	os_sem_give(&sem);
+	to_result[3] = os_sem_take(&sem, 0);
+	host_stop();
+}
+
+static int timeouts(void){
+	host_reset();
+	os_sem_init(&sem, 0);
+	task(0, "T", timeout_task, 2);
+	os_start();
+	printf("  timeout after %u ticks, interrupt give at %u\n", (unsigned)to_time[0], (unsigned)to_time[1]);
+	return !deadlock && to_result[0] == OS_ERR_TIMEOUT && to_time[0] == 3 && to_result[1] == OS_OK
+			&& to_time[1] == 10 && to_result[2] == OS_ERR_TIMEOUT && to_result[3] == OS_OK;
+}
+
+/* ---------------------------------------------------------------- queue */
+
+#define QUEUE_ITEMS				(6)
+
+static os_queue_t queue;
+static uint32_t queue_buf[2];
+static uint32_t got[QUEUE_ITEMS];
+static uint32_t got_len;
+static int empty_result;
+
+static void queue_producer(void *arg){
+	char s[8];
+
+	for(uint32_t i = 1; i <= QUEUE_ITEMS; i++){
+		os_queue_send(&queue, &i, OS_WAIT_FOREVER);
+		snprintf(s, sizeof(s), "P%u", (unsigned)i);
+		trace(s);
+	}
+}
+
+static void queue_consumer(void *arg){
+	uint32_t v;
+	char s[8];
+
+	while(got_len < QUEUE_ITEMS){
+		os_queue_receive(&queue, &v, OS_WAIT_FOREVER);
+		got[got_len++] = v;
+		snprintf(s, sizeof(s), "C%u", (unsigned)v);
+		trace(s);
+	}
+	empty_result = os_queue_receive(&queue, &v, 0);
+	host_stop();
+}
+
+/**
+ * int queue_order(void)
+ * @brief the producer has the higher priority, the queue holds two items
+ */
+static int queue_order(void){
+	int ok;
+
+	host_reset();
+	os_queue_init(&queue, queue_buf, sizeof(queue_buf[0]), 2);
+	got_len = 0;
+	task(0, "P", queue_producer, 2);
+	task(1, "C", queue_consumer, 3);
+	os_start();
+	printf("  %s\n", trace_buf);
+
+	ok = !deadlock && got_len == QUEUE_ITEMS && empty_result == OS_ERR_TIMEOUT;
+	for(uint32_t i = 0; ok && i < QUEUE_ITEMS; i++){
+		ok &= got[i] == i + 1U;
+	}
+	/* P fills the queue and blocks on the third item; every receive switches to P at
+	   once, which completes that send and blocks on the next before C goes on */
+	return ok && strcmp(trace_buf, "P1 P2 P3 C1 P4 C2 P5 C3 P6 C4 C5 C6") == 0;
+}
+
+int main(void){
+	check("switch order", switch_order());
+	check("priorities", priorities());
+	check("round robin", round_robin());
+	check("timeouts", timeouts());
+	check("queue", queue_order());
+	return failed;
+}
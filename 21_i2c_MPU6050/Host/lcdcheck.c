@@ -0,0 +1,244 @@
+/**
+ * lcdcheck.c
+ *	@brief Linux CLI: run 23_LCD/main.c on the simulator (sim/) with an HD44780 on its pins
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory, x86-64 Linux):
+ *  cc -O0 -Wall -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -no-pie \
+ *     -DSTM32F411xE -include sim/sim_cmsis.h -Isim \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -Dmain=lcd_main -o lcdcheck lcdcheck.c sim/sim*.c ../../23_LCD/main.c
+ * (-O0: delay_ms() is an empty loop, which the optimizer removes)
+ *
+ * Usage:
+ *  lcdcheck
+ *
+ * The HD44780 latches RS (PB5) and D0..D7 (PC0..PC7) on the falling edge
+ * of EN (PB7), as in its write timing (datasheet figure 25). The program's
+ * main() never returns: it runs under sim_call() and the display stops it
+ * at the clear that follows the text. delay_ms() is a loop on the CPU that
+ * touches no register: sim_spin() turns its CPU time into simulated time,
+ * at the rate that makes one delay_ms(1) of this build take 1 ms, measured
+ * before the run. The spacing of the writes is then checked against the
+ * execution times of the HD44780 (datasheet table 6 and figure 23); the
+ * program's delays are far longer, so the measured rate may be off by a
+ * factor of a few.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  init           0x30 three times, 0x38, 0x06, 0x01, 0x0F, in that order
+ *  text           "Hello" on the display before the clear of the loop
+ *  enable         EN high at least tPW (230 ns), RS and data steady at
+ *                 the falling edge
+ *  timing         first write 15 ms after power on, 4.1 ms after the first
+ *                 0x30 and 100 us after the second, 1.52 ms after a clear,
+ *                 37 us after any other write
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "stm32f4xx.h"
+#include "sim.h"
+
+#undef main
+
+#define LCD_RS					(5)			// PB5
+#define LCD_EN					(7)			// PB7
+#define LCD_LOG					(32)
+#define LCD_TPW_NS				(230U)		// EN pulse width
+#define LCD_EXEC_NS				(37000U)	// most instructions
+#define LCD_CLEAR_NS			(1520000U)	// clear display, return home
+#define LCD_POWER_NS			(15000000U)	// power on to the first write
+#define LCD_WAKE1_NS			(4100000U)	// after the first 0x30
+#define LCD_WAKE2_NS			(100000U)	// after the second 0x30
+#define LCD_CAL_MS				(20)		// delay_ms() timed for the spin rate
+#define LCD_CAL_RUNS			(7)			// the median run counts
+#define LCD_RUN_NS				(5000000000ULL)
+
+typedef struct {
+	uint8_t rs;
+	uint8_t data;
+	uint64_t at;
+} lcd_write_t;
+
+typedef struct {
+	lcd_write_t log[LCD_LOG];
+	uint32_t len;
+	char text[LCD_LOG];
+	uint32_t text_len;
+	uint64_t en_rise;
+	uint64_t pw_min;				// shortest EN pulse
+	uint64_t bus_change;			// last change of RS or data
+	uint64_t hold_min;				// shortest RS/data steady time before EN falls
+	int stopped;
+} hd44780_t;
+
+void lcd_main(void);
+void delay_ms(int delay);
+
+static hd44780_t lcd;
+static int failed;
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * void lcd_latch(hd44780_t *l)
+ * @brief EN fell: one write of RS and D0..D7
+ */
+static void lcd_latch(hd44780_t *l){
+	lcd_write_t *w;
+	uint8_t data = 0;
+
+	for(int pin = 0; pin < 8; pin++){
+		data |= (uint8_t)(sim_gpio_level(GPIOC, pin) << pin);
+	}
+	if(l->len == LCD_LOG){
+		sim_stop();
+		return;
+	}
+	w = &l->log[l->len++];
+	w->rs = (uint8_t)sim_gpio_level(GPIOB, LCD_RS);
+	w->data = data;
+	w->at = sim_now;
+	if(w->rs){
+		l->text[l->text_len++] = (char)data;
+	}else if(data == 0x01U && l->text_len > 0U){
+		/* the clear of the loop, after the text */
+		l->stopped = 1;
+		sim_stop();
+	}
+}
+
+static void lcd_portb(void *ctx, GPIO_TypeDef *port, uint16_t levels, uint16_t changed){
+	hd44780_t *l = ctx;
+
+	if(changed & (1U << LCD_RS)){
+		l->bus_change = sim_now;
+	}
+	if(!(changed & (1U << LCD_EN))){
+		return;
+	}
+	if(levels & (1U << LCD_EN)){
+		l->en_rise = sim_now;
+		return;
+	}
+	if(sim_now - l->en_rise < l->pw_min){
+		l->pw_min = sim_now - l->en_rise;
+	}
+	if(sim_now - l->bus_change < l->hold_min){
+		l->hold_min = sim_now - l->bus_change;
+	}
+	lcd_latch(l);
+}
+
+/**
+ * uint32_t spin_rate(void)
+ * @brief the sim_spin() rate at which one delay_ms(1) takes 1 ms
+ * @return ns of simulated time per SIM_SPIN_PERIOD_US of CPU time
+ */
+static uint32_t spin_rate(void){
+	uint64_t runs[LCD_CAL_RUNS], mid;
+
+	for(int run = 0; run < LCD_CAL_RUNS; run++){
+		struct timespec t0, t1;
+		uint64_t ns;
+		int k;
+
+		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t0);
+		delay_ms(LCD_CAL_MS);
+		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t1);
+		ns = (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ULL + (uint64_t)t1.tv_nsec - (uint64_t)t0.tv_nsec;
+
+		/* sorted as they come: a single run can read far off */
+		for(k = run; k > 0 && runs[k - 1] > ns; k--){
+			runs[k] = runs[k - 1];
+		}
+		runs[k] = ns;
+	}
+	mid = runs[LCD_CAL_RUNS / 2] ? runs[LCD_CAL_RUNS / 2] : 1U;
+	printf("  delay_ms(1): %.2f us of CPU\n", mid / 1e3 / LCD_CAL_MS);
+	return (uint32_t)(1000000ULL * LCD_CAL_MS * SIM_SPIN_PERIOD_US * 1000U / mid);
+}
+
+/**
+ * uint64_t need_ns(uint32_t i)
+ * @brief the time the HD44780 needs between write i - 1 and write i
+ */
+static uint64_t need_ns(uint32_t i){
+	const lcd_write_t *w = &lcd.log[i - 1];
+
+	if(i == 1U){
+		return LCD_WAKE1_NS;
+	}
+	if(i == 2U){
+		return LCD_WAKE2_NS;
+	}
+	if(!w->rs && w->data == 0x01U){
+		return LCD_CLEAR_NS;
+	}
+	return LCD_EXEC_NS;
+}
+
+static void lcd_portc(void *ctx, GPIO_TypeDef *port, uint16_t levels, uint16_t changed){
+	hd44780_t *l = ctx;
+
+	if(changed & 0xFFU){
+		l->bus_change = sim_now;
+	}
+}
+
+int main(void){
+	static const uint8_t init[] = { 0x30, 0x30, 0x30, 0x38, 0x06, 0x01, 0x0F };
+	uint64_t slack_min = UINT64_MAX;
+	int ok;
+
+	sim_init();
+	memset(&lcd, 0, sizeof(lcd));
+	lcd.pw_min = UINT64_MAX;
+	lcd.hold_min = UINT64_MAX;
+	sim_gpio_watch(GPIOB, lcd_portb, &lcd);
+	sim_gpio_watch(GPIOC, lcd_portc, &lcd);
+
+	sim_spin(spin_rate());
+	sim_call(lcd_main, LCD_RUN_NS);
+	sim_spin(0);
+	printf("  %u writes in %.1f us\n", (unsigned)lcd.len, sim_now / 1e3);
+
+	/*init*/
+	ok = lcd.len >= sizeof(init);
+	for(uint32_t i = 0; ok && i < sizeof(init); i++){
+		ok &= lcd.log[i].rs == 0 && lcd.log[i].data == init[i];
+	}
+	check("init", ok);
+
+	/*text*/
+	check("text", lcd.stopped && lcd.text_len == 5 && memcmp(lcd.text, "Hello", 5) == 0);
+
+	/*enable*/
+	printf("  EN pulse %llu ns, RS/data steady %llu ns before EN falls\n", (unsigned long long)lcd.pw_min,
+			(unsigned long long)lcd.hold_min);
+	check("enable", lcd.pw_min >= LCD_TPW_NS && lcd.hold_min > 0U);
+
+	/*timing*/
+	ok = lcd.len > 1U && lcd.log[0].at >= LCD_POWER_NS;
+	for(uint32_t i = 1; i < lcd.len; i++){
+		uint64_t gap = lcd.log[i].at - lcd.log[i - 1].at;
+
+		if(gap < need_ns(i)){
+			printf("  write %u: %.1f us after the last, needs %.1f us\n", (unsigned)i, gap / 1e3,
+					need_ns(i) / 1e3);
+			ok = 0;
+		}else if(gap - need_ns(i) < slack_min){
+			slack_min = gap - need_ns(i);
+		}
+	}
+	printf("  first write at %.2f ms, %.2f ms to spare at the closest\n", lcd.len ? lcd.log[0].at / 1e6 : 0.0,
+			slack_min / 1e6);
+	check("timing", ok);
+	return failed;
+}
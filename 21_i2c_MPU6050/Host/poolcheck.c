@@ -0,0 +1,307 @@
+/**
+ * poolcheck.c
+ *	@brief Linux CLI: exercise mempool.c (exhaustion, spills, fragmentation, bad frees)
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -I../Core/Inc -o poolcheck poolcheck.c ../Core/Src/mempool.c
+ *
+ * Usage:
+ *  poolcheck [rounds] [seed]		default 1000000 random operations, seed 1
+ *
+ * Checks, each printed as ok/FAIL:
+ *  exhaustion     every class hands out exactly its blocks, then spills
+ *                 upward, then fails; POOL_MAX_BLOCK + 1 always fails
+ *  alignment      every block is POOL_ALIGN aligned and inside its class size
+ *  fragmentation  free every other small block, then ask for large ones:
+ *                 they come from their own classes, never from the holes;
+ *                 after freeing everything the full capacity is back
+ *  bad frees      interior pointers, foreign pointers and double frees are
+ *                 counted and leave the pool intact
+ *  init once      pool_init on a pool in use (set up by pool_alloc, as
+ *                 before main()) keeps the blocks handed out
+ *  random         random sizes and alloc/free order, each block filled with
+ *                 a pattern that is checked before it is freed (overlap),
+ *                 used / high_water compared with a shadow count
+ * On the host the malloc redirection is not built; critical sections are
+ * no-ops, so this is a single-threaded check of the bookkeeping.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mempool.h"
+
+#define LIVE_MAX				(POOL_TOTAL_BLOCKS)
+
+static const uint16_t sizes[POOL_CLASSES] = POOL_CLASS_SIZES;
+static const uint16_t counts[POOL_CLASSES] = POOL_CLASS_BLOCKS;
+static uint64_t rng_state;
+static int failed;
+
+static uint64_t rnd(void){
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+static uint32_t used_total(void){
+	uint32_t n = 0;
+
+	for(int c = 0; c < POOL_CLASSES; c++){
+		n += pool_stats.cls[c].used;
+	}
+	return n;
+}
+
+/**
+ * int class_exhaustion(void)
+ * @brief take blocks of the smallest size until NULL and follow where they come from
+ */
+static int class_exhaustion(void){
+	void *p[POOL_TOTAL_BLOCKS + 1];
+	uint32_t n = 0;
+	int ok = 1;
+
+	pool_reset();
+	while(n <= POOL_TOTAL_BLOCKS && (p[n] = pool_alloc(1)) != 0){
+		/* the first counts[0] from class 0, then class 1, ... */
+		uint32_t expect = 0;
+		for(uint32_t c = 0, k = 0; c < POOL_CLASSES; k += counts[c], c++){
+			if(n >= k && n < k + counts[c]){
+				expect = sizes[c];
+			}
+		}
+		ok &= pool_block_size(p[n]) == expect;
+		n++;
+	}
+	ok &= n == POOL_TOTAL_BLOCKS;
+	ok &= pool_stats.spills == POOL_TOTAL_BLOCKS - counts[0];
+	ok &= pool_stats.failures == 1;
+	ok &= pool_alloc(POOL_MAX_BLOCK + 1) == 0;
+	for(uint32_t i = 0; i < n; i++){
+		pool_free(p[i]);
+	}
+	ok &= used_total() == 0;
+
+	/* too large fails even on an empty pool */
+	ok &= pool_alloc(POOL_MAX_BLOCK + 1) == 0;
+	ok &= pool_stats.failures == 3;
+	for(int c = 0; c < POOL_CLASSES; c++){
+		ok &= pool_stats.cls[c].high_water == counts[c];
+	}
+	return ok;
+}
+
+/**
+ * int alignment(void)
+ * @brief every size from 0 to POOL_MAX_BLOCK gets an aligned block of the smallest fitting class
+ */
+static int alignment(void){
+	int ok = 1;
+	void *p;
+
+	pool_reset();
+	for(size_t size = 0; size <= POOL_MAX_BLOCK; size++){
+		size_t want = 0;
+		for(int c = POOL_CLASSES - 1; c >= 0; c--){
+			if(size <= sizes[c]){
+				want = sizes[c];
+			}
+		}
+		p = pool_alloc(size);
+		ok &= p != 0 && ((uintptr_t)p % POOL_ALIGN) == 0 && pool_block_size(p) == want;
+		memset(p, 0xA5, size);
+		pool_free(p);
+	}
+	ok &= used_total() == 0 && pool_stats.spills == 0;
+	return ok;
+}
+
+/**
+ * int fragmentation(void)
+ * @brief holes left by small blocks never serve or block large requests
+ */
+static int fragmentation(void){
+	void *small[POOL_TOTAL_BLOCKS];
+	void *large[POOL_TOTAL_BLOCKS];
+	uint32_t ns = 0, nl = 0;
+	int ok = 1;
+
+	pool_reset();
+
+	/* fill class 0 and 1 with small requests, free every other one */
+	while(ns < (uint32_t)counts[0] + counts[1]){
+		small[ns++] = pool_alloc(sizes[0]);
+	}
+	for(uint32_t i = 0; i < ns; i += 2){
+		pool_free(small[i]);
+	}
+
+	/* every 256 byte block is still available, from class 4 */
+	while((large[nl] = pool_alloc(POOL_MAX_BLOCK)) != 0){
+		ok &= pool_block_size(large[nl]) == POOL_MAX_BLOCK;
+		nl++;
+	}
+	ok &= nl == counts[POOL_CLASSES - 1];
+
+	/* the holes still serve small requests */
+	for(uint32_t i = 0; i < ns; i += 2){
+		small[i] = pool_alloc(sizes[0]);
+		ok &= small[i] != 0;
+	}
+
+	/* release everything: the whole capacity is back */
+	for(uint32_t i = 0; i < ns; i++){
+		pool_free(small[i]);
+	}
+	for(uint32_t i = 0; i < nl; i++){
+		pool_free(large[i]);
+	}
+	ok &= used_total() == 0;
+	nl = 0;
+	while(pool_alloc(1) != 0){
+		nl++;
+	}
+	ok &= nl == POOL_TOTAL_BLOCKS;
+	return ok;
+}
+
+/**
+ * int bad_frees(void)
+ * @brief wrong pointers are refused and counted
+ */
+static int bad_frees(void){
+	static uint8_t foreign[64];
+	uint8_t *p, *q;
+	int ok = 1;
+
+	pool_reset();
+	p = pool_alloc(40);
+	q = pool_alloc(40);
+	pool_free(p + 8);				// interior
+	pool_free(foreign);				// not in the pool
+	pool_free(0);					// ignored, not counted
+	ok &= pool_stats.bad_frees == 2;
+	pool_free(p);
+	pool_free(p);					// double
+	ok &= pool_stats.double_frees == 1;
+	ok &= pool_stats.cls[2].used == 1;
+
+	/* the pool is intact: p comes back, q is untouched */
+	memset(q, 0x5A, 64);
+	ok &= pool_alloc(40) == p;
+	ok &= q[0] == 0x5A && q[63] == 0x5A;
+	return ok;
+}
+
+/**
+ * int init_once(void)
+ * @brief a block taken before pool_init stays taken
+ */
+static int init_once(void){
+	uint8_t *p, *q;
+	int ok;
+
+	pool_reset();
+	p = pool_alloc(8);
+	pool_init();
+	pool_init();
+	q = pool_alloc(8);
+	ok = p != 0 && q != 0 && q != p && used_total() == 2;
+	pool_free(p);
+	pool_free(q);
+	return ok && used_total() == 0 && pool_stats.double_frees == 0;
+}
+
+/**
+ * int random_ops(long rounds)
+ * @brief random alloc/free with pattern checks and a shadow count of used blocks
+ */
+static int random_ops(long rounds){
+	struct { uint8_t *p; size_t size; uint8_t tag; } live[LIVE_MAX];
+	uint32_t shadow_used[POOL_CLASSES] = {0};
+	uint32_t shadow_high[POOL_CLASSES] = {0};
+	uint32_t n = 0;
+	long corrupt = 0, mismatched = 0;
+	int ok = 1;
+
+	pool_reset();
+	for(long r = 0; r < rounds; r++){
+		if(n < LIVE_MAX && (n == 0 || (rnd() % 100) < 55)){
+			size_t size = (rnd() & 1) ? rnd() % 33 : rnd() % (POOL_MAX_BLOCK + 1);
+			uint8_t *p = pool_alloc(size);
+			if(!p){
+				continue;
+			}
+			int c = 0;
+			while(sizes[c] != pool_block_size(p)){
+				c++;
+			}
+			if(++shadow_used[c] > shadow_high[c]){
+				shadow_high[c] = shadow_used[c];
+			}
+			live[n].p = p;
+			live[n].size = size;
+			live[n].tag = (uint8_t)rnd();
+			memset(p, live[n].tag, size);
+			n++;
+		}else{
+			uint32_t i = (uint32_t)(rnd() % n);
+			for(size_t k = 0; k < live[i].size; k++){
+				if(live[i].p[k] != live[i].tag){
+					corrupt++;
+					break;
+				}
+			}
+			int c = 0;
+			while(sizes[c] != pool_block_size(live[i].p)){
+				c++;
+			}
+			shadow_used[c]--;
+			pool_free(live[i].p);
+			live[i] = live[--n];
+		}
+		for(int c = 0; c < POOL_CLASSES; c++){
+			if(pool_stats.cls[c].used != shadow_used[c]){
+				mismatched++;
+			}
+		}
+	}
+	while(n){
+		pool_free(live[--n].p);
+	}
+	for(int c = 0; c < POOL_CLASSES; c++){
+		ok &= pool_stats.cls[c].high_water == shadow_high[c];
+	}
+	printf("  %ld ops, spills %u, failures %u, high water", rounds, pool_stats.spills, pool_stats.failures);
+	for(int c = 0; c < POOL_CLASSES; c++){
+		printf(" %u/%u", pool_stats.cls[c].high_water, counts[c]);
+	}
+	printf("\n");
+	return ok && corrupt == 0 && mismatched == 0 && used_total() == 0;
+}
+
+int main(int argc, char **argv){
+	long rounds = (argc > 1) ? strtol(argv[1], 0, 10) : 1000000;
+
+	rng_state = (argc > 2) ? strtoull(argv[2], 0, 10) : 1;
+	if(rng_state == 0){
+		rng_state = 1;
+	}
+	check("exhaustion", class_exhaustion());
+	check("alignment", alignment());
+	check("fragmentation", fragmentation());
+	check("bad frees", bad_frees());
+	check("init once", init_once());
+	check("random", random_ops(rounds));
+	return failed;
+}
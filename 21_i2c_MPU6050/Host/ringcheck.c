@@ -0,0 +1,256 @@
+/**
+ * ringcheck.c
+ *	@brief Linux CLI: ring.h under a producer and a consumer thread, ordering, loss and throughput
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -pthread -iquote ../Core/Inc -o ringcheck ringcheck.c
+ * (-iquote: Core/Inc/sched.h must not hide the C library's <sched.h>)
+ *
+ * Usage:
+ *  ringcheck [items]		default 10000000 items per threaded run
+ *
+ * Checks, each printed as ok/FAIL:
+ *  full/empty     push to size then -1, pop to empty then -1, count and
+ *                 space follow, across the wrap of the free running indices
+ *  bulk wrap      push_bulk/pop_bulk split at the end of the buffer
+ *  zero copy      reserve/commit and peek/release return the contiguous
+ *                 run up to the wrap point and no further
+ *  threads single one thread pushes the sequence 0, 1, 2, ... item by item,
+ *                 another pops it: every item arrives once and in order
+ *  threads bulk   the same with bulk transfers of varying length
+ *  threads zcopy  the same with reserve/commit against peek/release
+ * Each threaded run prints its throughput. A full or empty ring yields the
+ * CPU, so the runs also complete on a single core.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ring.h"
+
+#define RING_LEN				(1024)
+#define SMALL_LEN				(8)
+#define BULK_MAX				(61)		// odd, so that the bulk runs straddle the wrap point
+
+RING_DECLARE(seq_ring, uint32_t, RING_LEN)
+RING_DECLARE(small_ring, uint32_t, SMALL_LEN)
+
+typedef enum {
+	MODE_SINGLE = 0,
+	MODE_BULK,
+	MODE_ZCOPY
+} xfer_mode_t;
+
+static seq_ring_t ring;
+static long items = 10000000;
+static xfer_mode_t mode;
+static int failed;
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * int full_empty(void)
+ * @brief fill and drain a small ring many times, so the indices run far past its size
+ */
+static int full_empty(void){
+	small_ring_t r;
+	uint32_t v, next = 0, expect = 0;
+	int ok = 1;
+
+	small_ring_init(&r);
+	/* start near the 32 bit wrap of head and tail */
+	r.head = r.tail = 0xFFFFFFF0U;
+	for(int round = 0; round < 10; round++){
+		for(uint32_t i = 0; i < SMALL_LEN; i++){
+			ok &= small_ring_push(&r, &next) == 0;
+			next++;
+		}
+		ok &= small_ring_push(&r, &next) == -1 && small_ring_count(&r) == SMALL_LEN && small_ring_space(&r) == 0;
+		for(uint32_t i = 0; i < SMALL_LEN; i++){
+			ok &= small_ring_pop(&r, &v) == 0 && v == expect++;
+		}
+		ok &= small_ring_pop(&r, &v) == -1 && small_ring_count(&r) == 0 && small_ring_space(&r) == SMALL_LEN;
+	}
+	return ok;
+}
+
+/**
+ * int bulk_wrap(void)
+ * @brief 5 in, 5 out, then 6 in across the end of the buffer
+ */
+static int bulk_wrap(void){
+	small_ring_t r;
+	uint32_t in[SMALL_LEN + 2], out[SMALL_LEN + 2];
+	int ok = 1;
+
+	for(uint32_t i = 0; i < SMALL_LEN + 2; i++){
+		in[i] = 100U + i;
+	}
+	small_ring_init(&r);
+	ok &= small_ring_push_bulk(&r, in, 5) == 5 && small_ring_pop_bulk(&r, out, 5) == 5;
+	ok &= small_ring_push_bulk(&r, in, 6) == 6 && r.head % SMALL_LEN == 3U;
+	ok &= small_ring_push_bulk(&r, in + 6, 4) == 2;		// only two free
+	ok &= small_ring_pop_bulk(&r, out, SMALL_LEN + 2) == SMALL_LEN;
+	for(uint32_t i = 0; i < SMALL_LEN; i++){
+		ok &= out[i] == 100U + i;
+	}
+	return ok && small_ring_pop_bulk(&r, out, 1) == 0;
+}
+
+/**
+ * int zero_copy(void)
+ * @brief the runs stop at the wrap point, the rest follows from the start
+ */
+static int zero_copy(void){
+	small_ring_t r;
+	uint32_t n, *p;
+	int ok = 1;
+
+	small_ring_init(&r);
+	r.head = r.tail = 6;
+	p = small_ring_write_reserve(&r, &n);
+	ok &= n == 2 && p == &r.buf[6];
+	p[0] = 1;
+	p[1] = 2;
+	small_ring_write_commit(&r, 2);
+	p = small_ring_write_reserve(&r, &n);
+	ok &= n == SMALL_LEN - 2 && p == &r.buf[0];
+	p[0] = 3;
+	small_ring_write_commit(&r, 1);
+
+	p = small_ring_read_peek(&r, &n);
+	ok &= n == 2 && p[0] == 1 && p[1] == 2;
+	small_ring_read_release(&r, 2);
+	p = small_ring_read_peek(&r, &n);
+	ok &= n == 1 && p[0] == 3;
+	small_ring_read_release(&r, 1);
+	small_ring_read_peek(&r, &n);
+	return ok && n == 0;
+}
+
+/* ---------------------------------------------------------------- threads */
+
+static void *producer(void *arg){
+	uint32_t next = 0, buf[BULK_MAX], k = 1;
+
+	while(next < (uint32_t)items){
+		uint32_t n = 0, *p;
+
+		switch(mode){
+		case MODE_SINGLE:
+			n = seq_ring_push(&ring, &next) == 0;
+			break;
+		case MODE_BULK:
+			k = k % BULK_MAX + 1U;
+			if(k > (uint32_t)items - next){
+				k = (uint32_t)items - next;
+			}
+			for(uint32_t i = 0; i < k; i++){
+				buf[i] = next + i;
+			}
+			n = seq_ring_push_bulk(&ring, buf, k);
+			break;
+		case MODE_ZCOPY:
+			p = seq_ring_write_reserve(&ring, &n);
+			if(n > (uint32_t)items - next){
+				n = (uint32_t)items - next;
+			}
+			for(uint32_t i = 0; i < n; i++){
+				p[i] = next + i;
+			}
+			seq_ring_write_commit(&ring, n);
+			break;
+		}
+		next += n;
+		if(n == 0){
+			sched_yield();
+		}
+	}
+	return 0;
+}
+
+/**
+ * uint64_t consume(void)
+ * @brief take items until all arrived
+ * @return items out of sequence
+ */
+static uint64_t consume(void){
+	uint32_t expect = 0, buf[BULK_MAX], k = 1;
+	uint64_t bad = 0;
+
+	while(expect < (uint32_t)items){
+		uint32_t n = 0, v, *p;
+
+		switch(mode){
+		case MODE_SINGLE:
+			if(seq_ring_pop(&ring, &v) == 0){
+				bad += v != expect;
+				n = 1;
+			}
+			break;
+		case MODE_BULK:
+			k = (k * 7U) % BULK_MAX + 1U;
+			n = seq_ring_pop_bulk(&ring, buf, k);
+			for(uint32_t i = 0; i < n; i++){
+				bad += buf[i] != expect + i;
+			}
+			break;
+		case MODE_ZCOPY:
+			p = seq_ring_read_peek(&ring, &n);
+			for(uint32_t i = 0; i < n; i++){
+				bad += p[i] != expect + i;
+			}
+			seq_ring_read_release(&ring, n);
+			break;
+		}
+		expect += n;
+		if(n == 0){
+			sched_yield();
+		}
+	}
+	return bad;
+}
+
+/**
+ * int threaded(xfer_mode_t m)
+ * @brief one producer thread, this thread consumes
+ */
+static int threaded(xfer_mode_t m){
+	pthread_t t;
+	struct timespec t0, t1;
+	uint64_t bad;
+	double secs;
+
+	mode = m;
+	seq_ring_init(&ring);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	pthread_create(&t, 0, producer, 0);
+	bad = consume();
+	pthread_join(t, 0);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+	printf("  %ld items in %.3f s, %.1f M items/s, %llu out of order\n", items, secs, (double)items / secs / 1e6,
+			(unsigned long long)bad);
+	return bad == 0 && seq_ring_count(&ring) == 0;
+}
+
+int main(int argc, char **argv){
+	if(argc > 1){
+		items = strtol(argv[1], 0, 10);
+	}
+	check("full/empty", full_empty());
+	check("bulk wrap", bulk_wrap());
+	check("zero copy", zero_copy());
+	check("threads single", threaded(MODE_SINGLE));
+	check("threads bulk", threaded(MODE_BULK));
+	check("threads zcopy", threaded(MODE_ZCOPY));
+	return failed;
+}
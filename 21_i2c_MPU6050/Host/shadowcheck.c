@@ -0,0 +1,348 @@
+/**
+ * shadowcheck.c
+ *	@brief Linux CLI: MPU6050 register shadow, dirty tracking and flush bursts
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -o shadowcheck shadowcheck.c ../Core/Src/MPU6050.c
+ *
+ * Usage:
+ *  shadowcheck [rounds] [seed]		default 100000 random flushes, seed 1
+ *
+ * MPU6050.c runs on a stub of the blocking i2c.c calls: a register file
+ * with the power-on values of the MPU6050 that logs every transaction.
+ * Writes to read-only registers are counted, the self-clearing bits clear
+ * after the write as on the device, a DEVICE_RESET sets every register back
+ * to its power-on value and a read of I2C_MST_STATUS is counted (it clears
+ * the flags on the device).
+ *
+ * Checks, each printed as ok/FAIL:
+ *  cold init      WHO_AM_I, 3 shadow loads around I2C_MST_STATUS, then
+ *                 2 writes: PWR_MGMT_1, SMPLRT_DIV .. ACCEL_CONFIG in one burst
+ *  warm init      the device kept its configuration: reads only
+ *  rewrite        the FAST_BOOT init of a device left in wake on motion by
+ *                 the last run: no read, the whole configuration in
+ *                 5 bursts, the stale values gone
+ *  coalescing     INT_PIN_CFG + INT_ENABLE, USER_CTRL + PWR_MGMT_2: 2 writes,
+ *                 the second one across the clean PWR_MGMT_1
+ *  unchanged      values set again: no transaction
+ *  update         a field of GYRO_CONFIG: one write, no read, the other bits kept
+ *  read-only      data, undocumented and unshadowed registers are refused
+ *  busy bus       flush returns -1 while an interrupt driven read owns the
+ *                 bus and leaves the change dirty for the next one;
+ *                 MPU6050_init() fails on it (not present)
+ *  self-clearing  FIFO_RESET goes out once, a later burst across
+ *                 USER_CTRL does not repeat it
+ *  device reset   DEVICE_RESET with block A changes: PWR_MGMT_1 goes out
+ *                 first, the block A values survive, the shadow follows
+ *  random         random changes: device = shadow after every flush, never
+ *                 a read-only register written, as many writes as the runs
+ *                 of dirty registers joined across gaps of <= MPU6050_FLUSH_GAP
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "MPU6050.h"
+
+#define SLV4_CTRL_R				(0x34)
+#define SLV4_DI_R				(0x35)
+#define SIGNAL_PATH_RESET_R		(0x68)
+#define MOT_DETECT_CTRL_R		(0x69)
+#define FIFO_RESET				(1U << 2)		// USER_CTRL
+#define WRITE_BITS(n)			(20U + 9U * (n))	// START, address, register, n bytes, STOP
+
+/* the stub sensor and its transaction log */
+static uint8_t regs[128];
+static uint32_t reads, writes, ro_writes, fifo_resets, wire_bits, mst_status_reads;
+static int busy;
+static I2C_TypeDef i2c_regs = { .CR1 = I2C_CR1_PE };
+i2c_handle_t i2c1 = { .regs = &i2c_regs };
+
+static mpu6050_t dev = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+static uint64_t rng_state;
+static int failed;
+
+/* writable registers of the shadowed blocks, from the register map */
+static int writable(uint8_t reg){
+	return (reg >= 0x19 && reg <= 0x1C) || reg == 0x1F || (reg >= 0x23 && reg <= 0x34)
+		|| reg == 0x37 || reg == 0x38 || (reg >= 0x63 && reg <= 0x6C);
+}
+
+static void sensor_reset(void){
+	memset(regs, 0, sizeof(regs));
+	regs[PWR_MGMT_1_R] = 0x40;
+	regs[WHO_AM_I_R] = MPU6050_WHO_AM_I;
+}
+
+static void log_reset(void){
+	reads = writes = ro_writes = fifo_resets = wire_bits = mst_status_reads = 0;
+}
+
+void i2c_init(i2c_handle_t *h){
+}
+
+int i2c_busy(const i2c_handle_t *h){
+	return busy;
+}
+
+int i2c_burst_read_it(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint8_t task, uint8_t sig){
+	return -1;
+}
+
+int i2c_burst_read(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	reads++;
+	for(int i = 0; i < n; i++){
+		uint8_t reg = ((uint8_t)maddr + i) & 0x7F;
+
+		mst_status_reads += reg == I2C_MST_STATUS_R;
+		data[i] = (char)regs[reg];
+	}
+	return 0;
+}
+
+int i2c_byte_read(i2c_handle_t *h, char saddr, char maddr, char* data){
+	return i2c_burst_read(h, saddr, maddr, 1, data);
+}
+
+int i2c_burst_write(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	writes++;
+	wire_bits += WRITE_BITS(n);
+	for(int i = 0; i < n; i++){
+		uint8_t reg = ((uint8_t)maddr + i) & 0x7F;
+
+		if(!writable(reg)){
+			ro_writes++;
+			continue;
+		}
+		regs[reg] = (uint8_t)data[i];
+		/* what the device clears itself */
+		if(reg == USER_CTRL_R){
+			fifo_resets += (regs[reg] & FIFO_RESET) != 0;
+			regs[reg] &= ~0x07;
+		}else if(reg == SIGNAL_PATH_RESET_R){
+			regs[reg] = 0;
+		}else if(reg == PWR_MGMT_1_R && (regs[reg] & 0x80)){
+			sensor_reset();
+		}else if(reg == SLV4_CTRL_R){
+			regs[reg] &= ~0x80;
+		}
+	}
+	return 0;
+}
+
+static uint64_t rnd(void){
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * int matches(void)
+ * @brief every shadowed register equals the device
+ */
+static int matches(void){
+	for(int reg = 0; reg < 128; reg++){
+		if(writable(reg) && MPU6050_get(&dev, reg) != regs[reg]){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * uint32_t expected_writes(const uint8_t *dirty)
+ * @brief bursts for a set of dirty registers: per block, dirty registers
+ *        join when at most MPU6050_FLUSH_GAP writable ones lie between them
+ */
+static uint32_t expected_writes(const uint8_t *dirty){
+	static const uint8_t block[2][2] = { { 0x19, 0x38 }, { 0x63, 0x6C } };
+	uint32_t n = 0;
+
+	for(int b = 0; b < 2; b++){
+		int last = -1;		// last dirty register of the open burst
+
+		for(int reg = block[b][0]; reg <= block[b][1]; reg++){
+			if(!writable(reg)){
+				last = -1;
+			}else if(dirty[reg]){
+				n += (last < 0 || reg - last - 1 > MPU6050_FLUSH_GAP);
+				last = reg;
+			}
+		}
+	}
+	return n;
+}
+
+int main(int argc, char **argv){
+	uint32_t rounds = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : 100000U;
+	int ok;
+
+	rng_state = (argc > 2) ? strtoull(argv[2], 0, 0) : 1;
+	if(rng_state == 0){
+		rng_state = 1;
+	}
+
+	/*cold init*/
+	sensor_reset();
+	log_reset();
+	dev.gyro_range = MPU6050_RANGE_2000_DEG;
+	dev.accel_range = MPU6050_RANGE_8_G;
+	ok = MPU6050_init(&dev) == 0 && dev.present;
+	printf("  cold init: %u reads, %u writes\n", reads, writes);
+	check("cold init", ok && reads == 4 && writes == 2 && ro_writes == 0 && mst_status_reads == 0 && matches()
+			&& regs[SMPLRT_DIV_R] == 7 && regs[GYRO_CONFIG_R] == (3 << 3)
+			&& regs[ACCEL_CONFIG_R] == (2 << 3) && regs[PWR_MGMT_1_R] == 0);
+
+	/*warm init*/
+	log_reset();
+	ok = MPU6050_init(&dev) == 0;
+	check("warm init", ok && reads == 4 && writes == 0 && mst_status_reads == 0 && matches());
+
+	/*rewrite*/
+	{
+		mpu6050_t fast = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+		uint8_t all[128] = { 0 };
+		mpu6050_t saved = dev;
+
+		for(int reg = 0; reg < 128; reg++){
+			all[reg] = writable(reg);
+		}
+		regs[PWR_MGMT_1_R] = 0x20;			// CYCLE
+		regs[PWR_MGMT_2_R] = 0x07;			// gyro standby
+		regs[ACCEL_CONFIG_R] |= 0x07;		// high pass
+		regs[INT_ENABLE_R] = 0x40;			// MOT_EN
+		regs[INT_PIN_CFG_R] = 0x20;			// LATCH_INT_EN
+		regs[MOT_THR_R] = 10;
+		log_reset();
+		dev = fast;
+		dev.gyro_range = MPU6050_RANGE_2000_DEG;
+		dev.accel_range = MPU6050_RANGE_8_G;
+		MPU6050_filter_solve(dev.rate_hz, dev.bandwidth_hz, &dev.filter);
+		MPU6050_shadow_rewrite(&dev);			// MPU6050_init() with FAST_BOOT
+		MPU6050_set(&dev, PWR_MGMT_1_R, 0);
+		MPU6050_set(&dev, SMPLRT_DIV_R, dev.filter.smplrt_div);
+		MPU6050_set(&dev, CONFIG_R, dev.filter.dlpf_cfg);
+		MPU6050_set(&dev, GYRO_CONFIG_R, dev.gyro_range << 3);
+		MPU6050_set(&dev, ACCEL_CONFIG_R, dev.accel_range << 3);
+		ok = MPU6050_flush(&dev) == (int)expected_writes(all);
+		printf("  rewrite: %u writes, %u bits on the wire\n", writes, wire_bits);
+		check("rewrite", ok && reads == 0 && ro_writes == 0 && writes == 5 && dev.dirty == 0 && matches()
+				&& regs[PWR_MGMT_1_R] == 0 && regs[PWR_MGMT_2_R] == 0 && regs[ACCEL_CONFIG_R] == (2 << 3)
+				&& regs[INT_ENABLE_R] == 0 && regs[INT_PIN_CFG_R] == 0 && regs[MOT_THR_R] == 0);
+		dev = saved;
+	}
+
+	/*coalescing*/
+	log_reset();
+	MPU6050_set(&dev, INT_PIN_CFG_R, 0x02);
+	MPU6050_set(&dev, INT_ENABLE_R, 0x01);
+	MPU6050_set(&dev, USER_CTRL_R, 0x20);
+	MPU6050_set(&dev, PWR_MGMT_2_R, 0x07);
+	ok = MPU6050_flush(&dev) == 2;
+	printf("  coalescing: %u bits on the wire, %u one register at a time\n", wire_bits, 4 * WRITE_BITS(1));
+	check("coalescing", ok && writes == 2 && reads == 0 && ro_writes == 0 && matches() && dev.dirty == 0);
+
+	/*unchanged*/
+	log_reset();
+	MPU6050_set(&dev, INT_PIN_CFG_R, 0x02);
+	MPU6050_set(&dev, SMPLRT_DIV_R, 7);
+	MPU6050_update(&dev, GYRO_CONFIG_R, 0x18, 3 << 3);
+	check("unchanged", MPU6050_flush(&dev) == 0 && writes == 0 && reads == 0);
+
+	/*update*/
+	MPU6050_set(&dev, GYRO_CONFIG_R, 0xE0 | (3 << 3));
+	MPU6050_flush(&dev);
+	log_reset();
+	MPU6050_update(&dev, GYRO_CONFIG_R, 0x18, MPU6050_RANGE_500_DEG << 3);
+	ok = MPU6050_flush(&dev) == 1;
+	check("update", ok && reads == 0 && writes == 1 && regs[GYRO_CONFIG_R] == (0xE0 | (1 << 3)));
+
+	/*read-only*/
+	ok = MPU6050_set(&dev, 0x1D, 1) == -1 && MPU6050_set(&dev, ACCEL_XOUT_H_REG, 1) == -1
+		&& MPU6050_set(&dev, SLV4_DI_R, 1) == -1 && MPU6050_set(&dev, WHO_AM_I_R, 1) == -1
+		&& MPU6050_update(&dev, 0x3A, 0xFF, 1) == -1;
+	check("read-only", ok && dev.dirty == 0 && matches());
+
+	/*busy bus*/
+	log_reset();
+	busy = 1;
+	MPU6050_set(&dev, MOT_THR_R, 20);
+	ok = MPU6050_flush(&dev) == -1 && writes == 0 && dev.dirty != 0;
+	busy = 0;
+	ok &= MPU6050_flush(&dev) == 1 && regs[MOT_THR_R] == 20 && matches();
+	{
+		mpu6050_t cold = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+
+		cold.rate_hz = 50;
+		busy = 1;
+		ok &= MPU6050_init(&cold) == -1 && !cold.present;
+		busy = 0;
+	}
+	check("busy bus", ok);
+
+	/*self-clearing*/
+	log_reset();
+	MPU6050_update(&dev, USER_CTRL_R, FIFO_RESET, FIFO_RESET);
+	MPU6050_flush(&dev);
+	MPU6050_set(&dev, MOT_DETECT_CTRL_R, 0x15);
+	MPU6050_set(&dev, PWR_MGMT_2_R, 0x00);
+	MPU6050_flush(&dev);
+	check("self-clearing", fifo_resets == 1 && writes == 2 && MPU6050_get(&dev, USER_CTRL_R) == 0x20 && matches());
+
+	/*device reset*/
+	log_reset();
+	MPU6050_set(&dev, SMPLRT_DIV_R, 19);
+	MPU6050_set(&dev, PWR_MGMT_1_R, 0x80);
+	ok = MPU6050_flush(&dev) == 2 && regs[SMPLRT_DIV_R] == 19 && regs[PWR_MGMT_1_R] == 0x40;
+	ok &= MPU6050_get(&dev, MOT_THR_R) == 0 && MPU6050_get(&dev, PWR_MGMT_1_R) == 0x40;
+	check("device reset", ok && dev.dirty == 0 && matches());
+	MPU6050_set(&dev, PWR_MGMT_1_R, 0);
+	MPU6050_flush(&dev);
+
+	/*random*/
+	uint32_t bad = 0, bursts = 0, changed = 0;
+
+	log_reset();
+	for(uint32_t r = 0; r < rounds; r++){
+		uint8_t dirty[128] = { 0 };
+		uint32_t w = writes;
+		int k = 1 + rnd() % 6;
+
+		for(int i = 0; i < k; i++){
+			uint8_t reg;
+
+			do{
+				reg = (uint8_t)(0x19 + rnd() % (0x6D - 0x19));
+			}while(!writable(reg) || reg == PWR_MGMT_1_R || reg == SIGNAL_PATH_RESET_R
+					|| reg == USER_CTRL_R || reg == SLV4_CTRL_R);
+			uint8_t v = (uint8_t)rnd();
+
+			if(v != MPU6050_get(&dev, reg)){
+				dirty[reg] = 1;
+			}
+			MPU6050_set(&dev, reg, v);
+		}
+		for(int reg = 0; reg < 128; reg++){
+			changed += dirty[reg];
+		}
+		MPU6050_flush(&dev);
+		bursts += writes - w;
+		bad += !matches() || (writes - w) != expected_writes(dirty);
+	}
+	printf("  random: %u registers changed, %u bursts, %u bits (%u one register at a time)\n",
+			changed, bursts, wire_bits, changed * WRITE_BITS(1));
+	check("random", bad == 0 && ro_writes == 0 && reads == 0);
+	return failed;
+}
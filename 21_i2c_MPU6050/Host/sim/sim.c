@@ -0,0 +1,1069 @@
+/**
+ * sim.c
+ *	@brief simulator core: trapped register accesses, time line, NVIC, SysTick, DWT, RCC
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * x86-64 Linux only: the trap uses the write bit of the page fault error
+ * code (REG_ERR) and the trap flag of EFLAGS (REG_EFL) to step over the
+ * instruction that touched a register.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <setjmp.h>
+#include <stddef.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "sim.h"
+
+#define SIM_PAGE				(4096U)
+#define SIM_SLOT				(1024U)		// hook granularity
+#define SIM_HOOKS				(64)
+#define SIM_DEPTH				(8)			// pages one instruction touches
+#define SIM_TF					(0x100)		// EFLAGS trap flag
+#define SIM_PF_WRITE			(0x2)		// page fault error code: write access
+#define SIM_EXC_PENDSV			(14)
+#define SIM_EXC_SYSTICK			(15)
+#define SIM_EXC_IRQ0			(16)
+#define SIM_THREAD_PRIO			(0x100)		// running priority of thread mode
+#define SCS_BASE_ADDR			(0xE000E000U)
+#define DWT_BASE_ADDR			(0xE0001000U)
+#define AIRCR_VECTKEY			(0x05FAU)
+#define AIRCR_VECTKEYSTAT		(0xFA05U)
+
+/* system_stm32f4xx.c on the target */
+uint32_t SystemCoreClock = 16000000U;
+const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+const uint8_t APBPrescTable[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+uint64_t sim_now;
+sim_stats_t sim_stats;
+
+typedef struct {
+	uintptr_t base;
+	uint32_t len;
+	uint32_t slot0;			// first hook slot
+	uint8_t *view;
+} sim_region_t;
+
+typedef struct {
+	uintptr_t base;
+	sim_read_t rd;
+	sim_write_t wr;
+	void *ctx;
+} sim_hook_t;
+
+/* one access in flight: the page is open until the instruction is over */
+typedef struct {
+	uintptr_t addr;
+	uintptr_t page;
+	int write;
+	uint32_t old;
+} sim_access_t;
+
+static sim_region_t regions[] = {
+	{ PERIPH_BASE, 0x00080000U, 0 },			// APB1, APB2, AHB1
+	{ 0xE0000000U, 0x00010000U, 0x200 },		// ITM, DWT, FPB, SCS
+};
+#define SIM_REGIONS				(sizeof(regions) / sizeof(regions[0]))
+#define SIM_SLOTS				(0x200 + 0x40)
+
+static sim_hook_t hooks[SIM_HOOKS];
+static int hooks_len;
+static sim_hook_t *slots[SIM_SLOTS];
+static sim_access_t access_stack[SIM_DEPTH];
+static int depth;
+static volatile int engine;			// in the simulator's own bookkeeping: no sim_spin() step
+static int ready;
+
+/* time line */
+static sim_event_t *events;
+
+/* interrupts */
+static struct {
+	uint32_t en[3], pend[3], act[3];
+	uint32_t line[SIM_IRQS];			// sources holding the line high
+	void (*fn[SIM_IRQS])(void);
+} nvic;
+static int sys_pend[SIM_EXC_IRQ0], sys_act[SIM_EXC_IRQ0];
+static uint32_t primask, basepri;
+static uint32_t exc_now;					// IPSR
+static uint32_t prio_now = SIM_THREAD_PRIO;
+static uint32_t nest;
+
+/* SysTick, DWT, clocks */
+static sim_event_t systick_ev;
+static uint64_t systick_t0;
+static uint64_t cyc_base, cyc_t0;			// CYCCNT at cyc_t0
+static uint32_t hclk_hz = 16000000U;
+
+/* sim_call() */
+static sigjmp_buf call_env;
+static int calling, stop_req;
+static uint64_t call_end;
+static uint32_t spin_ns;
+static uint64_t spin_cpu;				// CPU time of the process at the last step
+
+/* the handlers of the program, weak: 0 when it does not define them */
+#define SIM_VECTORS(V) \
+	V(WWDG) V(PVD) V(TAMP_STAMP) V(RTC_WKUP) V(FLASH) V(RCC) V(EXTI0) V(EXTI1) V(EXTI2) V(EXTI3) \
+	V(EXTI4) V(DMA1_Stream0) V(DMA1_Stream1) V(DMA1_Stream2) V(DMA1_Stream3) V(DMA1_Stream4) \
+	V(DMA1_Stream5) V(DMA1_Stream6) V(ADC) V(EXTI9_5) V(TIM1_BRK_TIM9) V(TIM1_UP_TIM10) \
+	V(TIM1_TRG_COM_TIM11) V(TIM1_CC) V(TIM2) V(TIM3) V(TIM4) V(I2C1_EV) V(I2C1_ER) V(I2C2_EV) \
+	V(I2C2_ER) V(SPI1) V(SPI2) V(USART1) V(USART2) V(EXTI15_10) V(RTC_Alarm) V(OTG_FS_WKUP) \
+	V(DMA1_Stream7) V(SDIO) V(TIM5) V(SPI3) V(DMA2_Stream0) V(DMA2_Stream1) V(DMA2_Stream2) \
+	V(DMA2_Stream3) V(DMA2_Stream4) V(OTG_FS) V(DMA2_Stream5) V(DMA2_Stream6) V(DMA2_Stream7) \
+	V(USART6) V(I2C3_EV) V(I2C3_ER) V(FPU) V(SPI4) V(SPI5)
+#define SIM_VECTOR_DECL(n)		extern void n##_IRQHandler(void) __attribute__((weak));
+#define SIM_VECTOR_ENTRY(n)		{ n##_IRQn, n##_IRQHandler },
+SIM_VECTORS(SIM_VECTOR_DECL)
+extern void SysTick_Handler(void) __attribute__((weak));
+extern void PendSV_Handler(void) __attribute__((weak));
+
+static const struct {
+	IRQn_Type irq;
+	void (*fn)(void);
+} vectors[] = { SIM_VECTORS(SIM_VECTOR_ENTRY) };
+
+static void sim_stop_check(void);
+
+/**
+ * sim_region_t *region_of(uintptr_t addr)
+ * @brief the mapped region holding addr, 0 for ordinary memory
+ */
+static sim_region_t *region_of(uintptr_t addr){
+	for(uint32_t i = 0; i < SIM_REGIONS; i++){
+		if(addr - regions[i].base < regions[i].len){
+			return &regions[i];
+		}
+	}
+	return 0;
+}
+
+/**
+ * sim_hook_t *hook_of(uintptr_t addr)
+ * @brief the hook of the register at addr, 0 for plain memory
+ */
+static sim_hook_t *hook_of(uintptr_t addr){
+	sim_region_t *r = region_of(addr);
+
+	if(r == 0){
+		return 0;
+	}
+	return slots[r->slot0 + (addr - r->base) / SIM_SLOT];
+}
+
+/**
+ * void *sim_view(const volatile void *p)
+ * @brief the model's view of a register, without the trap; other memory as it is
+ */
+void *sim_view(const volatile void *p){
+	uintptr_t a = (uintptr_t)p;
+	sim_region_t *r = region_of(a);
+
+	return r ? (void *)(r->view + (a - r->base)) : (void *)a;
+}
+
+/**
+ * void sim_hook(uintptr_t base, uint32_t len, sim_read_t rd, sim_write_t wr, void *ctx)
+ * @brief give the registers [base, base + len) to a model; offsets are from base.
+ *        The block is rounded to 1 KB slots, one hook per slot.
+ */
+void sim_hook(uintptr_t base, uint32_t len, sim_read_t rd, sim_write_t wr, void *ctx){
+	sim_hook_t *h;
+
+	if(hooks_len == SIM_HOOKS){
+		fprintf(stderr, "sim: out of hooks\n");
+		abort();
+	}
+	h = &hooks[hooks_len++];
+	h->base = base;
+	h->rd = rd;
+	h->wr = wr;
+	h->ctx = ctx;
+	for(uintptr_t a = base; a < base + len; a += SIM_SLOT){
+		sim_region_t *r = region_of(a);
+
+		if(r){
+			slots[r->slot0 + (a - r->base) / SIM_SLOT] = h;
+		}
+	}
+}
+
+/* ---------------------------------------------------------------- trap */
+
+/**
+ * uint64_t cpu_ns(void)
+ * @brief CPU time of the process
+ */
+static uint64_t cpu_ns(void){
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * void on_segv(int sig, siginfo_t *si, void *p)
+ * @brief a driver touched a register
+ * @step followed:
+ *
+ * 1. Not a register: a real fault, let it kill the program
+ * 2. Before a read, let the model compute the value
+ * 3. Keep the old value, open the page, step over the instruction
+ */
+static void on_segv(int sig, siginfo_t *si, void *p){
+	ucontext_t *uc = p;
+	uintptr_t a = (uintptr_t)si->si_addr;
+	sim_hook_t *h;
+	sim_access_t *x;
+
+	/*1. Not a register: a real fault*/
+	if(region_of(a) == 0 || depth == SIM_DEPTH){
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+	engine++;
+	x = &access_stack[depth++];
+	x->addr = a & ~(uintptr_t)3;
+	x->page = a & ~(uintptr_t)(SIM_PAGE - 1U);
+	x->write = (uc->uc_mcontext.gregs[REG_ERR] & SIM_PF_WRITE) != 0;
+
+	/*2. Before a read, let the model compute the value (a write refreshes too: x86 may read-modify-write in one instruction)*/
+	h = hook_of(x->addr);
+	if(h && h->rd){
+		h->rd(h->ctx, (uint32_t)(x->addr - h->base), 0);
+	}
+
+	/*3. Keep the old value, open the page, step over the instruction*/
+	x->old = *(volatile uint32_t *)sim_view((void *)x->addr);
+	mprotect((void *)x->page, SIM_PAGE, PROT_READ | PROT_WRITE);
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_TF;
+	engine--;
+}
+
+/**
+ * void on_trap(int sig, siginfo_t *si, void *p)
+ * @brief the instruction is over
+ * @step followed:
+ *
+ * 1. Close the pages, tell the models what was written or read
+ * 2. The access takes its time, events fall due
+ * 3. Take the interrupts that are pending now
+ */
+static void on_trap(int sig, siginfo_t *si, void *p){
+	ucontext_t *uc = p;
+
+	uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_TF;
+	if(depth == 0){
+		return;
+	}
+
+	/*1. Close the pages, tell the models*/
+	engine++;
+	while(depth > 0){
+		sim_access_t *x = &access_stack[--depth];
+		sim_hook_t *h = hook_of(x->addr);
+
+		mprotect((void *)x->page, SIM_PAGE, PROT_NONE);
+		if(h == 0){
+			continue;
+		}
+		if(x->write && h->wr){
+			h->wr(h->ctx, (uint32_t)(x->addr - h->base), x->old, *(volatile uint32_t *)sim_view((void *)x->addr));
+		}else if(!x->write && h->rd){
+			h->rd(h->ctx, (uint32_t)(x->addr - h->base), 1);
+		}
+	}
+
+	/*2. The access takes its time*/
+	sim_stats.accesses++;
+	sim_advance(sim_cycles_ns(SIM_ACCESS_CYCLES, hclk_hz));
+	if(spin_ns){
+		spin_cpu = cpu_ns();		// the trap is not CPU time of the program
+	}
+	engine--;
+
+	/*3. Take the interrupts that are pending now*/
+	sim_irq_take();
+	sim_stop_check();
+}
+
+/**
+ * void on_spin(int sig)
+ * @brief sim_spin(): CPU time of the program moves simulated time on
+ * @step followed:
+ *
+ * 1. The CPU time since the last step; in the simulator's own bookkeeping
+ *    it is not the program's and is dropped
+ * 2. spin_ns per SIM_SPIN_PERIOD_US of it (the timer is on the wall clock:
+ *    the profiling timer only fires at the kernel tick)
+ */
+static void on_spin(int sig){
+	uint64_t now = cpu_ns();
+	uint64_t used = now - spin_cpu;
+
+	/*1. The CPU time since the last step*/
+	spin_cpu = now;
+	if(engine || depth){
+		return;
+	}
+
+	/*2. spin_ns per SIM_SPIN_PERIOD_US of it*/
+	sim_advance(used * spin_ns / (SIM_SPIN_PERIOD_US * 1000ULL));
+	sim_irq_take();
+	sim_stop_check();
+}
+
+/**
+ * uint32_t sim_bus_read(uint32_t addr, uint32_t size)
+ * @brief a load by a bus master other than the CPU (DMA), with the read hooks
+ */
+uint32_t sim_bus_read(uint32_t addr, uint32_t size){
+	sim_hook_t *h = hook_of(addr);
+	uint32_t word = addr & ~3U;
+	uint32_t v;
+
+	if(region_of(addr) == 0){
+		v = (size == 4U) ? *(uint32_t *)(uintptr_t)addr
+			: (size == 2U) ? *(uint16_t *)(uintptr_t)addr : *(uint8_t *)(uintptr_t)addr;
+		return v;
+	}
+	if(h && h->rd){
+		h->rd(h->ctx, word - (uint32_t)h->base, 0);
+	}
+	v = *(volatile uint32_t *)sim_view((void *)(uintptr_t)word) >> (8U * (addr & 3U));
+	if(h && h->rd){
+		h->rd(h->ctx, word - (uint32_t)h->base, 1);
+	}
+	return (size == 4U) ? v : v & ((1U << (8U * size)) - 1U);
+}
+
+/**
+ * void sim_bus_write(uint32_t addr, uint32_t val, uint32_t size)
+ * @brief a store by a bus master other than the CPU (DMA), with the write hook
+ */
+void sim_bus_write(uint32_t addr, uint32_t val, uint32_t size){
+	sim_hook_t *h = hook_of(addr);
+	uint32_t word = addr & ~3U;
+	volatile uint32_t *p;
+	uint32_t old, mask;
+
+	if(region_of(addr) == 0){
+		if(size == 4U){
+			*(uint32_t *)(uintptr_t)addr = val;
+		}else if(size == 2U){
+			*(uint16_t *)(uintptr_t)addr = (uint16_t)val;
+		}else{
+			*(uint8_t *)(uintptr_t)addr = (uint8_t)val;
+		}
+		return;
+	}
+	p = sim_view((void *)(uintptr_t)word);
+	old = *p;
+	mask = ((size == 4U) ? 0xFFFFFFFFU : ((1U << (8U * size)) - 1U)) << (8U * (addr & 3U));
+	*p = (old & ~mask) | ((val << (8U * (addr & 3U))) & mask);
+	if(h && h->wr){
+		h->wr(h->ctx, word - (uint32_t)h->base, old, *p);
+	}
+}
+
+/* ---------------------------------------------------------------- time */
+
+/**
+ * uint64_t sim_cycles_ns(uint64_t cycles, uint32_t hz)
+ * @brief duration of cycles of a clock, ns, rounded up
+ */
+uint64_t sim_cycles_ns(uint64_t cycles, uint32_t hz){
+	return (cycles * 1000000000ULL + hz - 1U) / hz;
+}
+
+void sim_event_init(sim_event_t *e, sim_event_fn_t fn, void *ctx){
+	memset(e, 0, sizeof(*e));
+	e->fn = fn;
+	e->ctx = ctx;
+}
+
+/**
+ * void sim_event_cancel(sim_event_t *e)
+ * @brief take an event off the time line
+ */
+void sim_event_cancel(sim_event_t *e){
+	sim_event_t **pp;
+
+	if(!e->armed){
+		return;
+	}
+	for(pp = &events; *pp; pp = &(*pp)->next){
+		if(*pp == e){
+			*pp = e->next;
+			break;
+		}
+	}
+	e->armed = 0;
+}
+
+/**
+ * void sim_event_at(sim_event_t *e, uint64_t at)
+ * @brief (re)schedule an event; events at the same time run in the order they were set
+ */
+void sim_event_at(sim_event_t *e, uint64_t at){
+	sim_event_t **pp;
+
+	engine++;
+	sim_event_cancel(e);
+	e->at = (at < sim_now) ? sim_now : at;
+	for(pp = &events; *pp && (*pp)->at <= e->at; pp = &(*pp)->next){
+	}
+	e->next = *pp;
+	*pp = e;
+	e->armed = 1;
+	engine--;
+}
+
+/**
+ * void sim_advance(uint64_t ns)
+ * @brief move time on by ns, running the events that fall due (no interrupts taken)
+ */
+void sim_advance(uint64_t ns){
+	uint64_t end = sim_now + ns;
+	sim_event_t *e;
+
+	engine++;
+	while((e = events) != 0 && e->at <= end){
+		events = e->next;
+		e->armed = 0;
+		if(e->at > sim_now){
+			sim_now = e->at;
+		}
+		sim_stats.events++;
+		e->fn(e->ctx);
+	}
+	sim_now = end;
+	engine--;
+}
+
+/**
+ * void sim_run(uint64_t ns)
+ * @brief let ns of time pass in thread mode: events run, interrupts are taken
+ *        when they become pending
+ */
+void sim_run(uint64_t ns){
+	uint64_t end = sim_now + ns;
+
+	sim_irq_take();
+	while(sim_now < end){
+		uint64_t next = (events && events->at < end) ? events->at : end;
+
+		sim_advance(next - sim_now);
+		sim_irq_take();
+		sim_stop_check();
+	}
+}
+
+/**
+ * void sim_wfi(void)
+ * @brief __WFI(): sleep until the next event (SIM_WFI_IDLE_NS if none), then take interrupts
+ */
+void sim_wfi(void){
+	uint64_t next = events ? events->at : sim_now + SIM_WFI_IDLE_NS;
+
+	sim_advance((next > sim_now) ? next - sim_now : 0);
+	sim_irq_take();
+	sim_stop_check();
+}
+
+/**
+ * void sim_spin(uint32_t ns)
+ * @brief move time on by ns per SIM_SPIN_PERIOD_US of CPU time of the
+ *        program, so loops on RAM or delay loops end; 0 turns it off
+ */
+void sim_spin(uint32_t ns){
+	struct itimerval it = { { 0, SIM_SPIN_PERIOD_US }, { 0, SIM_SPIN_PERIOD_US } };
+
+	spin_ns = ns;
+	spin_cpu = cpu_ns();
+	if(ns == 0){
+		memset(&it, 0, sizeof(it));
+	}
+	setitimer(ITIMER_REAL, &it, 0);
+}
+
+/**
+ * int sim_call(void (*fn)(void), uint64_t ns)
+ * @brief run fn (a main loop that never returns) until sim_stop() or ns of
+ *        simulated time
+ * @return 0 if fn returned, 1 if it was stopped
+ */
+int sim_call(void (*fn)(void), uint64_t ns){
+	call_end = sim_now + ns;
+	stop_req = 0;
+	calling = 1;
+	if(sigsetjmp(call_env, 1) == 0){
+		fn();
+		calling = 0;
+		return 0;
+	}
+
+	/* left from inside a handler or a trap: back in thread mode */
+	calling = 0;
+	depth = 0;
+	engine = 0;
+	nest = 0;
+	exc_now = 0;
+	prio_now = SIM_THREAD_PRIO;
+	memset(nvic.act, 0, sizeof(nvic.act));
+	memset(sys_act, 0, sizeof(sys_act));
+	return 1;
+}
+
+/**
+ * void sim_stop(void)
+ * @brief end the sim_call() in progress at the end of the current access
+ */
+void sim_stop(void){
+	stop_req = 1;
+}
+
+static void sim_stop_check(void){
+	if(calling && !engine && (stop_req || sim_now >= call_end)){
+		siglongjmp(call_env, 1);
+	}
+}
+
+/* ---------------------------------------------------------------- NVIC */
+
+/**
+ * void nvic_mirror(void)
+ * @brief the NVIC registers as the program reads them
+ */
+static void nvic_mirror(void){
+	NVIC_Type *v = SIM_VIEW(NVIC);
+
+	for(int i = 0; i < 3; i++){
+		v->ISER[i] = nvic.en[i];
+		v->ICER[i] = nvic.en[i];
+		v->ISPR[i] = nvic.pend[i];
+		v->ICPR[i] = nvic.pend[i];
+		v->IABR[i] = nvic.act[i];
+	}
+}
+
+#define BIT_SET(a, n)			((a)[(n) >> 5] & (1U << ((n) & 31)))
+
+/**
+ * uint32_t exc_prio(uint32_t exc)
+ * @brief the group (preemption) priority of an exception, from IP/SHP and AIRCR PRIGROUP
+ */
+static uint32_t exc_prio(uint32_t exc){
+	uint32_t prigroup = (SIM_VIEW(SCB)->AIRCR & SCB_AIRCR_PRIGROUP_Msk) >> SCB_AIRCR_PRIGROUP_Pos;
+	uint32_t p;
+
+	if(exc >= SIM_EXC_IRQ0){
+		p = SIM_VIEW(NVIC)->IP[exc - SIM_EXC_IRQ0];
+	}else{
+		p = SIM_VIEW(SCB)->SHP[exc - 4U];
+	}
+	p &= 0xFFU << (8U - __NVIC_PRIO_BITS);
+	return p & ~((2U << prigroup) - 1U);
+}
+
+/**
+ * int exc_next(void)
+ * @brief the pending exception that would be taken now, -1 if none
+ */
+static int exc_next(void){
+	uint32_t limit = prio_now;
+	uint32_t best_prio = SIM_THREAD_PRIO;
+	int best = -1;
+
+	if(primask){
+		return -1;
+	}
+	if(basepri != 0U && basepri < limit){
+		limit = basepri;
+	}
+	for(uint32_t exc = SIM_EXC_PENDSV; exc < SIM_EXC_IRQ0; exc++){
+		if(sys_pend[exc] && exc_prio(exc) < best_prio){
+			best_prio = exc_prio(exc);
+			best = (int)exc;
+		}
+	}
+	for(uint32_t n = 0; n < SIM_IRQS; n++){
+		if(BIT_SET(nvic.pend, n) && BIT_SET(nvic.en, n) && exc_prio(n + SIM_EXC_IRQ0) < best_prio){
+			best_prio = exc_prio(n + SIM_EXC_IRQ0);
+			best = (int)(n + SIM_EXC_IRQ0);
+		}
+	}
+	return (best_prio < limit) ? best : -1;
+}
+
+/**
+ * void (*exc_handler(uint32_t exc))(void)
+ * @brief the handler of an exception: attached, else the program's weak one
+ */
+static void (*exc_handler(uint32_t exc))(void){
+	if(exc == SIM_EXC_SYSTICK){
+		return SysTick_Handler;
+	}
+	if(exc == SIM_EXC_PENDSV){
+		return PendSV_Handler;
+	}
+	return nvic.fn[exc - SIM_EXC_IRQ0];
+}
+
+/**
+ * void sim_irq_take(void)
+ * @brief take every pending interrupt that may preempt what runs now, highest priority first
+ * @step followed:
+ *
+ * 1. Pending -> active, the running priority and IPSR of the handler
+ * 2. Run the handler (it may be preempted in turn from its register accesses)
+ * 3. Back: inactive, a level source still high pends it again
+ */
+void sim_irq_take(void){
+	int exc;
+
+	if(engine){
+		return;
+	}
+	while((exc = exc_next()) >= 0){
+		uint32_t prev_exc = exc_now, prev_prio = prio_now;
+		void (*fn)(void) = exc_handler((uint32_t)exc);
+		uint32_t n = (uint32_t)exc - SIM_EXC_IRQ0;
+
+		/*1. Pending -> active*/
+		if(exc < SIM_EXC_IRQ0){
+			sys_pend[exc] = 0;
+			sys_act[exc] = 1;
+		}else{
+			nvic.pend[n >> 5] &= ~(1U << (n & 31));
+			nvic.act[n >> 5] |= 1U << (n & 31);
+			nvic_mirror();
+		}
+		if(fn == 0){
+			fprintf(stderr, "sim: exception %d taken, no handler\n", exc);
+			abort();
+		}
+		exc_now = (uint32_t)exc;
+		prio_now = exc_prio((uint32_t)exc);
+		if(++nest > sim_stats.nest_max){
+			sim_stats.nest_max = nest;
+		}
+		sim_stats.irqs++;
+
+		/*2. Run the handler*/
+		fn();
+
+		/*3. Back: inactive, a level source still high pends it again*/
+		nest--;
+		exc_now = prev_exc;
+		prio_now = prev_prio;
+		if(exc < SIM_EXC_IRQ0){
+			sys_act[exc] = 0;
+		}else{
+			nvic.act[n >> 5] &= ~(1U << (n & 31));
+			if(nvic.line[n]){
+				nvic.pend[n >> 5] |= 1U << (n & 31);
+			}
+			nvic_mirror();
+		}
+	}
+}
+
+/**
+ * void sim_irq_line(IRQn_Type irq, uint32_t source, int level)
+ * @brief a level sensitive interrupt line, the OR of up to 32 sources (bit
+ *        numbers): pending when it goes high while the interrupt is not active
+ */
+void sim_irq_line(IRQn_Type irq, uint32_t source, int level){
+	uint32_t n = (uint32_t)irq;
+	uint32_t was = nvic.line[n];
+
+	if(level){
+		nvic.line[n] |= 1U << source;
+	}else{
+		nvic.line[n] &= ~(1U << source);
+	}
+	if(!was && nvic.line[n] && !BIT_SET(nvic.act, n)){
+		nvic.pend[n >> 5] |= 1U << (n & 31);
+		nvic_mirror();
+	}
+}
+
+/**
+ * void sim_irq_pend(IRQn_Type irq)
+ * @brief a pulse on an interrupt line (or SysTick / PendSV)
+ */
+void sim_irq_pend(IRQn_Type irq){
+	if((int)irq < 0){
+		sys_pend[SIM_EXC_IRQ0 + (int)irq] = 1;
+		return;
+	}
+	nvic.pend[(uint32_t)irq >> 5] |= 1U << ((uint32_t)irq & 31);
+	nvic_mirror();
+}
+
+/**
+ * void sim_irq_attach(IRQn_Type irq, void (*handler)(void))
+ * @brief handler for an interrupt the program has no IRQHandler for
+ */
+void sim_irq_attach(IRQn_Type irq, void (*handler)(void)){
+	nvic.fn[irq] = handler;
+}
+
+uint32_t sim_get_primask(void){
+	return primask;
+}
+
+void sim_set_primask(uint32_t pm){
+	primask = pm & 1U;
+	if(!primask){
+		sim_irq_take();
+		sim_stop_check();
+	}
+}
+
+uint32_t sim_get_basepri(void){
+	return basepri;
+}
+
+void sim_set_basepri(uint32_t bp){
+	basepri = bp & 0xFFU;
+	sim_irq_take();
+}
+
+uint32_t sim_get_ipsr(void){
+	return exc_now;
+}
+
+/* ---------------------------------------------------------------- SysTick, SCB, DWT */
+
+/* core clock cycles per SysTick count: HCLK or the HCLK / 8 reference */
+static uint32_t systick_div(void){
+	return (SIM_VIEW(SysTick)->CTRL & SysTick_CTRL_CLKSOURCE_Msk) ? 1U : 8U;
+}
+
+static uint64_t systick_period_ns(void){
+	return sim_cycles_ns(((SIM_VIEW(SysTick)->LOAD & SysTick_LOAD_RELOAD_Msk) + 1ULL) * systick_div(), hclk_hz);
+}
+
+/**
+ * void systick_wrap(void *ctx)
+ * @brief the counter reached 0: COUNTFLAG, the exception with TICKINT, reload
+ */
+static void systick_wrap(void *ctx){
+	SysTick_Type *st = SIM_VIEW(SysTick);
+
+	st->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+	if(st->CTRL & SysTick_CTRL_TICKINT_Msk){
+		sys_pend[SIM_EXC_SYSTICK] = 1;
+	}
+	systick_t0 = sim_now;
+	sim_event_at(&systick_ev, sim_now + systick_period_ns());
+}
+
+/**
+ * void scs_read(void *ctx, uint32_t off, int after)
+ * @brief SysTick VAL and ICSR on demand, COUNTFLAG cleared by reading CTRL
+ */
+static void scs_read(void *ctx, uint32_t off, int after){
+	SysTick_Type *st = SIM_VIEW(SysTick);
+	uint32_t base = SCS_BASE_ADDR;
+
+	if(off == (uint32_t)((uintptr_t)&SysTick->CTRL - base) && after){
+		st->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+	}else if(off == (uint32_t)((uintptr_t)&SysTick->VAL - base) && !after){
+		if(st->CTRL & SysTick_CTRL_ENABLE_Msk){
+			uint64_t reload = (st->LOAD & SysTick_LOAD_RELOAD_Msk) + 1ULL;
+			uint64_t ticks = (sim_now - systick_t0) * hclk_hz / (1000000000ULL * systick_div());
+
+			st->VAL = (uint32_t)((reload - 1U - ticks % reload) & SysTick_VAL_CURRENT_Msk);
+		}
+	}else if(off == (uint32_t)((uintptr_t)&SCB->ICSR - base) && !after){
+		uint32_t icsr = exc_now & SCB_ICSR_VECTACTIVE_Msk;
+
+		icsr |= sys_pend[SIM_EXC_SYSTICK] ? SCB_ICSR_PENDSTSET_Msk : 0U;
+		icsr |= sys_pend[SIM_EXC_PENDSV] ? SCB_ICSR_PENDSVSET_Msk : 0U;
+		SIM_VIEW(SCB)->ICSR = icsr;
+	}
+}
+
+/**
+ * void scs_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief SysTick, NVIC set/clear registers, ICSR, AIRCR, STIR
+ */
+static void scs_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	uint32_t base = SCS_BASE_ADDR;
+	uint32_t iser = (uint32_t)((uintptr_t)&NVIC->ISER[0] - base);
+	uint32_t icer = (uint32_t)((uintptr_t)&NVIC->ICER[0] - base);
+	uint32_t ispr = (uint32_t)((uintptr_t)&NVIC->ISPR[0] - base);
+	uint32_t icpr = (uint32_t)((uintptr_t)&NVIC->ICPR[0] - base);
+	SysTick_Type *st = SIM_VIEW(SysTick);
+
+	if(off == (uint32_t)((uintptr_t)&SysTick->CTRL - base)){
+		st->CTRL = (val & ~SysTick_CTRL_COUNTFLAG_Msk) | (old & SysTick_CTRL_COUNTFLAG_Msk);
+		if((val & SysTick_CTRL_ENABLE_Msk) && !(old & SysTick_CTRL_ENABLE_Msk)){
+			systick_t0 = sim_now;
+			sim_event_at(&systick_ev, sim_now + systick_period_ns());
+		}else if(!(val & SysTick_CTRL_ENABLE_Msk)){
+			sim_event_cancel(&systick_ev);
+		}
+	}else if(off == (uint32_t)((uintptr_t)&SysTick->VAL - base)){
+		/* any write clears the counter and COUNTFLAG: the next tick reloads */
+		st->VAL = 0;
+		st->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+		if(st->CTRL & SysTick_CTRL_ENABLE_Msk){
+			systick_t0 = sim_now;
+			sim_event_at(&systick_ev, sim_now + systick_period_ns());
+		}
+	}else if(off >= iser && off < iser + 12U){
+		nvic.en[(off - iser) / 4U] |= val;
+	}else if(off >= icer && off < icer + 12U){
+		nvic.en[(off - icer) / 4U] &= ~val;
+	}else if(off >= ispr && off < ispr + 12U){
+		nvic.pend[(off - ispr) / 4U] |= val;
+	}else if(off >= icpr && off < icpr + 12U){
+		uint32_t i = (off - icpr) / 4U;
+
+		nvic.pend[i] &= ~val;
+		/* a line still high pends again */
+		for(uint32_t b = 0; b < 32U && i * 32U + b < SIM_IRQS; b++){
+			if((val & (1U << b)) && nvic.line[i * 32U + b] && !(nvic.act[i] & (1U << b))){
+				nvic.pend[i] |= 1U << b;
+			}
+		}
+	}else if(off == (uint32_t)((uintptr_t)&SCB->ICSR - base)){
+		if(val & SCB_ICSR_PENDSTSET_Msk){
+			sys_pend[SIM_EXC_SYSTICK] = 1;
+		}
+		if(val & SCB_ICSR_PENDSTCLR_Msk){
+			sys_pend[SIM_EXC_SYSTICK] = 0;
+		}
+		if(val & SCB_ICSR_PENDSVSET_Msk){
+			sys_pend[SIM_EXC_PENDSV] = 1;
+		}
+		if(val & SCB_ICSR_PENDSVCLR_Msk){
+			sys_pend[SIM_EXC_PENDSV] = 0;
+		}
+	}else if(off == (uint32_t)((uintptr_t)&SCB->AIRCR - base)){
+		uint32_t keep = ((val >> SCB_AIRCR_VECTKEY_Pos) == AIRCR_VECTKEY) ? val : old;
+
+		SIM_VIEW(SCB)->AIRCR = (AIRCR_VECTKEYSTAT << SCB_AIRCR_VECTKEY_Pos) | (keep & SCB_AIRCR_PRIGROUP_Msk);
+	}else if(off == (uint32_t)((uintptr_t)&NVIC->STIR - base)){
+		sim_irq_pend((IRQn_Type)(val & 0x1FFU));
+	}
+	nvic_mirror();
+}
+
+/**
+ * uint64_t dwt_now(void)
+ * @brief the cycle counter at sim_now (the counter runs at HCLK)
+ */
+static uint64_t dwt_now(void){
+	return cyc_base + (sim_now - cyc_t0) * hclk_hz / 1000000000ULL;
+}
+
+/**
+ * void dwt_read(void *ctx, uint32_t off, int after)
+ * @brief CYCCNT from the simulated time while CYCCNTENA is set
+ */
+static void dwt_read(void *ctx, uint32_t off, int after){
+	DWT_Type *d = SIM_VIEW(DWT);
+
+	if(off == offsetof(DWT_Type, CYCCNT) && !after && (d->CTRL & DWT_CTRL_CYCCNTENA_Msk)){
+		d->CYCCNT = (uint32_t)dwt_now();
+	}
+}
+
+static void dwt_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	DWT_Type *d = SIM_VIEW(DWT);
+
+	if(off == offsetof(DWT_Type, CYCCNT)){
+		cyc_base = val;
+		cyc_t0 = sim_now;
+	}else if(off == offsetof(DWT_Type, CTRL) && ((old ^ val) & DWT_CTRL_CYCCNTENA_Msk)){
+		/* counting starts or stops here */
+		cyc_base = (val & DWT_CTRL_CYCCNTENA_Msk) ? d->CYCCNT : dwt_now();
+		cyc_t0 = sim_now;
+		d->CYCCNT = (uint32_t)cyc_base;
+	}
+}
+
+/* ---------------------------------------------------------------- RCC */
+
+/**
+ * uint32_t sim_hclk(void)
+ * @brief HCLK from the clock tree: HSI 16 MHz, HSE SIM_HSE_HZ or the PLL, AHB prescaler
+ */
+uint32_t sim_hclk(void){
+	RCC_TypeDef *rcc = SIM_VIEW(RCC);
+	uint32_t pll = rcc->PLLCFGR;
+	uint32_t sysclk;
+
+	switch((rcc->CFGR & RCC_CFGR_SWS) >> RCC_CFGR_SWS_Pos){
+	case 1:
+		sysclk = SIM_HSE_HZ;
+		break;
+	case 2: {
+		uint32_t src = (pll & RCC_PLLCFGR_PLLSRC) ? SIM_HSE_HZ : 16000000U;
+		uint32_t m = pll & RCC_PLLCFGR_PLLM;
+		uint32_t n = (pll & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos;
+		uint32_t p = ((((pll & RCC_PLLCFGR_PLLP) >> RCC_PLLCFGR_PLLP_Pos) + 1U) * 2U);
+
+		sysclk = (m != 0U) ? (uint32_t)((uint64_t)src / m * n / p) : 16000000U;
+		break;
+	}
+	default:
+		sysclk = 16000000U;
+		break;
+	}
+	return sysclk >> AHBPrescTable[(rcc->CFGR & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+}
+
+/**
+ * uint32_t sim_pclk(int apb)
+ * @brief PCLK1 (apb 1) or PCLK2 (apb 2)
+ */
+uint32_t sim_pclk(int apb){
+	uint32_t cfgr = SIM_VIEW(RCC)->CFGR;
+	uint32_t ppre = (apb == 1) ? (cfgr & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos
+			: (cfgr & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos;
+
+	return sim_hclk() >> APBPrescTable[ppre];
+}
+
+/**
+ * uint32_t sim_timclk(int apb)
+ * @brief the timer clock of an APB: PCLK, twice PCLK when the APB is divided
+ */
+uint32_t sim_timclk(int apb){
+	uint32_t cfgr = SIM_VIEW(RCC)->CFGR;
+	uint32_t ppre = (apb == 1) ? (cfgr & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos
+			: (cfgr & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos;
+
+	return (APBPrescTable[ppre] == 0U) ? sim_pclk(apb) : 2U * sim_pclk(apb);
+}
+
+/**
+ * void rcc_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief oscillators and the PLL are ready as soon as they are on, SWS follows SW
+ */
+static void rcc_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	RCC_TypeDef *rcc = SIM_VIEW(RCC);
+
+	switch(off){
+	case offsetof(RCC_TypeDef, CR): {
+		uint32_t rdy = 0;
+
+		rdy |= (val & RCC_CR_HSION) ? RCC_CR_HSIRDY : 0U;
+		rdy |= (val & RCC_CR_HSEON) ? RCC_CR_HSERDY : 0U;
+		rdy |= (val & RCC_CR_PLLON) ? RCC_CR_PLLRDY : 0U;
+		rdy |= (val & RCC_CR_PLLI2SON) ? RCC_CR_PLLI2SRDY : 0U;
+		rcc->CR = (val & ~(RCC_CR_HSIRDY | RCC_CR_HSERDY | RCC_CR_PLLRDY | RCC_CR_PLLI2SRDY)) | rdy;
+		break;
+	}
+	case offsetof(RCC_TypeDef, CFGR):
+		rcc->CFGR = (val & ~RCC_CFGR_SWS) | ((val & RCC_CFGR_SW) << RCC_CFGR_SWS_Pos);
+		break;
+	case offsetof(RCC_TypeDef, BDCR):
+		rcc->BDCR = (val & ~RCC_BDCR_LSERDY) | ((val & RCC_BDCR_LSEON) ? RCC_BDCR_LSERDY : 0U);
+		break;
+	case offsetof(RCC_TypeDef, CSR):
+		rcc->CSR = (val & ~RCC_CSR_LSIRDY) | ((val & RCC_CSR_LSION) ? RCC_CSR_LSIRDY : 0U);
+		break;
+	default:
+		return;
+	}
+
+	/* the cycle counter keeps its count over a change of HCLK */
+	if(sim_hclk() != hclk_hz){
+		cyc_base = dwt_now();
+		cyc_t0 = sim_now;
+		hclk_hz = sim_hclk();
+	}
+}
+
+/* ---------------------------------------------------------------- init */
+
+/**
+ * void sim_init(void)
+ * @brief map the peripherals, install the trap, reset every model
+ * @step followed:
+ *
+ * 1. Each region: a memory file, mapped read/write for the models and with
+ *    no access at the target address
+ * 2. SIGSEGV and SIGTRAP handlers, reentrant (handlers touch registers too)
+ * 3. Reset values of the core registers and RCC, the handlers of the program
+ * 4. The peripheral models
+ */
+void sim_init(void){
+	struct sigaction sa;
+
+	if(ready){
+		return;
+	}
+	ready = 1;
+
+	/*1. Each region: a memory file, mapped twice*/
+	for(uint32_t i = 0; i < SIM_REGIONS; i++){
+		int fd = memfd_create("sim", 0);
+
+		if(fd < 0 || ftruncate(fd, regions[i].len) != 0){
+			perror("sim: memfd");
+			exit(2);
+		}
+		regions[i].view = mmap(0, regions[i].len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if(regions[i].view == MAP_FAILED || mmap((void *)regions[i].base, regions[i].len, PROT_NONE,
+				MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0) != (void *)regions[i].base){
+			fprintf(stderr, "sim: cannot map 0x%08lx\n", (unsigned long)regions[i].base);
+			exit(2);
+		}
+		close(fd);
+	}
+
+	/*2. SIGSEGV and SIGTRAP handlers, reentrant*/
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = on_segv;
+	sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+	sigemptyset(&sa.sa_mask);
+	sigaddset(&sa.sa_mask, SIGALRM);
+	sigaction(SIGSEGV, &sa, 0);
+	sa.sa_sigaction = on_trap;
+	sigaction(SIGTRAP, &sa, 0);
+	sa.sa_handler = on_spin;
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGALRM, &sa, 0);
+
+	/*3. Reset values of the core registers and RCC, the handlers of the program*/
+	*(volatile uint32_t *)&SIM_VIEW(SCB)->CPUID = 0x410FC241U;
+	SIM_VIEW(SCB)->AIRCR = AIRCR_VECTKEYSTAT << SCB_AIRCR_VECTKEY_Pos;
+	*(volatile uint32_t *)&SIM_VIEW(SysTick)->CALIB = 0x40000000U | 2000U;		// no reference clock, 1 ms at HCLK / 8
+	SIM_VIEW(RCC)->CR = RCC_CR_HSION | RCC_CR_HSIRDY | (16U << RCC_CR_HSITRIM_Pos);
+	SIM_VIEW(RCC)->PLLCFGR = 0x24003010U;
+	SIM_VIEW(RCC)->CSR = 0x0E000000U;
+	sim_hook(SCS_BASE_ADDR, 0x1000, scs_read, scs_write, 0);
+	sim_hook(DWT_BASE_ADDR, 0x1000, dwt_read, dwt_write, 0);
+	sim_hook(RCC_BASE, 0x400, 0, rcc_write, 0);
+	sim_event_init(&systick_ev, systick_wrap, 0);
+	for(uint32_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++){
+		nvic.fn[vectors[i].irq] = vectors[i].fn;
+	}
+
+	/*4. The peripheral models*/
+	sim_gpio_init();
+	sim_dma_init();
+	sim_i2c_init();
+	sim_spi_init();
+	sim_usart_init();
+	sim_tim_init();
+}
@@ -0,0 +1,199 @@
+/**
+ * sim.h
+ *	@brief header file for the register level simulator of the STM32F411 peripherals
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The drivers run on Linux (x86-64) from their own sources: the peripheral
+ * block (0x40000000, APB1..AHB1) and the private peripheral bus
+ * (0xE0000000: DWT, SysTick, NVIC, SCB) are mapped at their target
+ * addresses, so the CMSIS pointers (I2C1, GPIOB, DMA1_Stream5, NVIC, ...)
+ * are the real ones. The one switch for the simulator is SIM_HOST
+ * (sim_cmsis.h) in atomic.h: critical_enter() masks the simulated PRIMASK,
+ * where the plain host build of atomic.h has no interrupts to mask.
+ *
+ * Both regions are one shared memory file mapped twice: at the target
+ * address with no access, and elsewhere read/write for the models
+ * (SIM_VIEW). A driver load or store faults (SIGSEGV); the simulator calls
+ * the read hook of the register (values computed on demand: CNT, IDR,
+ * CYCCNT), opens the page and single-steps the instruction (TF), then in
+ * SIGTRAP closes the page again and calls the write hook with the old and
+ * the new value, or the read hook once more after the read (flags cleared
+ * by reading: ADDR after SR1/SR2, RXNE after DR, ...). Every access costs
+ * SIM_ACCESS_CYCLES of simulated time, events that fall due run, and
+ * pending interrupts are taken: the handler (the weak I2C1_EV_IRQHandler,
+ * ... of the program, or one given to sim_irq_attach) is called from the
+ * trap, so it preempts the driver between two register accesses as on the
+ * target. Priorities (NVIC->IP, SCB->SHP), preemption, PRIMASK and
+ * __get_IPSR() follow the Cortex-M4.
+ *
+ * Time only moves on register accesses, __WFI(), sim_run() and, with
+ * sim_spin(), the CPU time of the program: a delay loop that touches no
+ * register takes no simulated time without it.
+ *
+ * Models (sim_*.c), each a set of hooks over its registers:
+ *  GPIO      MODER/ODR/BSRR/IDR, external inputs, observers of the outputs,
+ *            EXTI lines 0..15 (SYSCFG EXTICR, edges, PR, the EXTI IRQs)
+ *  I2C1..3   master mode flag sequencing at the CCR bit rate: SB, ADDR,
+ *            TXE, BTF, RXNE, AF, BUSY/MSL/TRA, the SR1-SR2 and DR clearing
+ *            sequences, ACK/STOP timing, SWRST, EV and ER interrupts;
+ *            slaves are callbacks (sim_i2c_dev_t), sim_i2c_regs_t a
+ *            register file with an auto-incrementing pointer
+ *  SPI1..5   master, 8 bit frames at PCLK / 2^(BR+1), TXE/RXNE/BSY/OVR,
+ *            interrupts and DMA requests; the slave is a byte exchange
+ *  USART1/2/6  8N1 or 9 bit frames at the BRR rate (OVER8 too): TX to a
+ *            sink, RX from sim_usart_inject(), TXE/TC/RXNE/IDLE/ORE,
+ *            interrupts, DMAT/DMAR requests
+ *  DMA1/2    8 streams each: channel selection, direction, sizes,
+ *            increments, NDTR, circular mode, HT/TC flags, LISR/HISR,
+ *            LIFCR/HIFCR and the stream interrupts
+ *  TIM1..5, 9..11  up counting from PSC/ARR, UG/UIF, the update interrupt
+ *  RCC       ready bits follow the enables, SWS follows SW; the bus clocks
+ *            the models use come from CFGR/PLLCFGR
+ *
+ * Build the program non position independent (-no-pie): the DMA takes
+ * 32 bit memory addresses, and weak handlers the program does not define
+ * resolve to 0. Pre-include sim_cmsis.h, which replaces the asm
+ * intrinsics of cmsis_gcc.h. sim.c provides SystemCoreClock and the
+ * prescaler tables of system_stm32f4xx.c.
+ */
+
+#ifndef HOST_SIM_SIM_H_
+#define HOST_SIM_SIM_H_
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+#define SIM_ACCESS_CYCLES		(4U)		// core cycles per peripheral register access
+#define SIM_WFI_IDLE_NS			(1000000ULL)	// __WFI() with nothing scheduled: time moves on by this
+#define SIM_IRQS				(86)		// STM32F411 IRQn 0..85
+#define SIM_HSE_HZ				(8000000U)	// Nucleo: ST-LINK MCO, bypass
+#define SIM_SPIN_PERIOD_US		(50)		// sim_spin(): ns of simulated time per this CPU time
+
+/* the model's view of a register block, no trap: SIM_VIEW(I2C1)->SR1 */
+#define SIM_VIEW(p)				((__typeof__(p))sim_view((const volatile void *)(p)))
+
+/* read hook: after = 0 before the load (refresh the value), 1 after it (clear on read) */
+typedef void (*sim_read_t)(void *ctx, uint32_t off, int after);
+/* write hook: the register held old, the store left val in it */
+typedef void (*sim_write_t)(void *ctx, uint32_t off, uint32_t old, uint32_t val);
+typedef void (*sim_event_fn_t)(void *ctx);
+
+/* an event on the simulated time line */
+typedef struct sim_event {
+	uint64_t at;				// ns
+	sim_event_fn_t fn;
+	void *ctx;
+	int armed;
+	struct sim_event *next;
+} sim_event_t;
+
+typedef struct {
+	uint64_t accesses;			// trapped register loads and stores
+	uint64_t irqs;				// handlers entered
+	uint64_t events;			// model events run
+	uint32_t nest_max;			// deepest preemption
+} sim_stats_t;
+
+extern uint64_t sim_now;		// simulated time, ns
+extern sim_stats_t sim_stats;
+
+/* engine (sim.c) */
+void sim_init(void);
+void *sim_view(const volatile void *p);
+void sim_hook(uintptr_t base, uint32_t len, sim_read_t rd, sim_write_t wr, void *ctx);
+void sim_event_init(sim_event_t *e, sim_event_fn_t fn, void *ctx);
+void sim_event_at(sim_event_t *e, uint64_t at);
+void sim_event_cancel(sim_event_t *e);
+void sim_advance(uint64_t ns);
+void sim_run(uint64_t ns);
+void sim_spin(uint32_t ns);
+void sim_wfi(void);
+int sim_call(void (*fn)(void), uint64_t ns);
+void sim_stop(void);
+uint32_t sim_bus_read(uint32_t addr, uint32_t size);
+void sim_bus_write(uint32_t addr, uint32_t val, uint32_t size);
+
+/* clocks from RCC */
+uint32_t sim_hclk(void);
+uint32_t sim_pclk(int apb);
+uint32_t sim_timclk(int apb);
+uint64_t sim_cycles_ns(uint64_t cycles, uint32_t hz);
+
+/* interrupts */
+void sim_irq_line(IRQn_Type irq, uint32_t source, int level);
+void sim_irq_pend(IRQn_Type irq);
+void sim_irq_attach(IRQn_Type irq, void (*handler)(void));
+void sim_irq_take(void);
+
+/* intrinsics behind sim_cmsis.h */
+uint32_t sim_get_primask(void);
+void sim_set_primask(uint32_t primask);
+uint32_t sim_get_basepri(void);
+void sim_set_basepri(uint32_t basepri);
+uint32_t sim_get_ipsr(void);
+
+/* GPIO and EXTI (sim_gpio.c) */
+typedef void (*sim_gpio_watch_t)(void *ctx, GPIO_TypeDef *port, uint16_t levels, uint16_t changed);
+
+void sim_gpio_init(void);
+void sim_gpio_input(GPIO_TypeDef *port, int pin, int level);
+void sim_gpio_release(GPIO_TypeDef *port, int pin);
+int sim_gpio_level(GPIO_TypeDef *port, int pin);
+void sim_gpio_watch(GPIO_TypeDef *port, sim_gpio_watch_t fn, void *ctx);
+
+/* I2C (sim_i2c.c) */
+typedef struct sim_i2c_dev sim_i2c_dev_t;
+struct sim_i2c_dev {
+	uint8_t addr;					// 7 bit
+	void (*start)(sim_i2c_dev_t *d, int rd);			// addressed, rd: master reads
+	int (*write)(sim_i2c_dev_t *d, uint8_t byte);		// 1: ACK
+	uint8_t (*read)(sim_i2c_dev_t *d);
+	void (*stop)(sim_i2c_dev_t *d);
+	sim_i2c_dev_t *next;
+};
+
+/* a register file slave: the first byte written sets the pointer, the pointer auto-increments */
+typedef struct {
+	sim_i2c_dev_t dev;
+	uint8_t ptr;
+	int first;						// next byte written is the pointer
+	int wrote;
+	uint32_t reads, writes;			// transactions with data
+	void (*on_read)(void *ctx, uint8_t reg);		// before a register is read
+	void (*on_write)(void *ctx, uint8_t reg);		// after a register is written
+	void *ctx;
+	uint8_t regs[256];
+} sim_i2c_regs_t;
+
+typedef struct {
+	uint32_t starts, bytes, nacks, stops;
+} sim_i2c_stats_t;
+
+void sim_i2c_init(void);
+void sim_i2c_attach(I2C_TypeDef *i2c, sim_i2c_dev_t *dev);
+void sim_i2c_regs_init(sim_i2c_regs_t *r, uint8_t addr7);
+const sim_i2c_stats_t *sim_i2c_stats(I2C_TypeDef *i2c);
+
+/* SPI (sim_spi.c) */
+typedef uint8_t (*sim_spi_xfer_t)(void *ctx, uint8_t mosi);
+
+void sim_spi_init(void);
+void sim_spi_attach(SPI_TypeDef *spi, sim_spi_xfer_t fn, void *ctx);
+
+/* USART (sim_usart.c) */
+typedef void (*sim_usart_sink_t)(void *ctx, uint16_t data);
+
+void sim_usart_init(void);
+void sim_usart_sink(USART_TypeDef *usart, sim_usart_sink_t fn, void *ctx);
+int sim_usart_inject(USART_TypeDef *usart, const uint8_t *data, uint32_t n);
+
+/* DMA (sim_dma.c) */
+void sim_dma_init(void);
+void sim_dma_dreq(DMA_TypeDef *dma, uint32_t streams, uint32_t channel, int level);
+void sim_dma_error(DMA_TypeDef *dma, int stream, uint32_t items);
+
+/* timers (sim_tim.c) */
+void sim_tim_init(void);
+
+#endif /* HOST_SIM_SIM_H_ */
@@ -0,0 +1,152 @@
+/**
+ * sim_cmsis.h
+ *	@brief host replacement of cmsis_gcc.h for the simulator, pre-included (-include sim/sim_cmsis.h)
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Takes the include guard of cmsis_gcc.h, so core_cm4.h gets these
+ * definitions instead of the Cortex-M asm. PRIMASK, BASEPRI, IPSR and WFI
+ * go to the simulator core (sim.c): __enable_irq() takes what became
+ * pending while masked, __WFI() moves time to the next event. LDREX/STREX
+ * always succeed: the simulated interrupts only run between two register
+ * accesses, never inside a read-modify-write of RAM. Barriers are compiler
+ * barriers.
+ */
+
+#ifndef HOST_SIM_SIM_CMSIS_H_
+#define HOST_SIM_SIM_CMSIS_H_
+
+#define SIM_HOST				(1)
+#define __CMSIS_GCC_H
+
+/* first include of every file: sim.c needs the ucontext register names and memfd_create */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdint.h>
+
+#ifndef __has_builtin
+#define __has_builtin(x)		(0)
+#endif
+
+#define __ASM					__asm
+#define __INLINE				inline
+#define __STATIC_INLINE			static inline
+#define __STATIC_FORCEINLINE	__attribute__((always_inline)) static inline
+#define __NO_RETURN				__attribute__((__noreturn__))
+#define __USED					__attribute__((used))
+#define __WEAK					__attribute__((weak))
+#define __PACKED				__attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT			struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION			union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)			__attribute__((aligned(x)))
+#define __RESTRICT				__restrict
+#define __UNALIGNED_UINT16_READ(addr)			(*(const uint16_t *)(const void *)(addr))
+#define __UNALIGNED_UINT16_WRITE(addr, val)		(void)(*(uint16_t *)(void *)(addr) = (val))
+#define __UNALIGNED_UINT32_READ(addr)			(*(const uint32_t *)(const void *)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val)		(void)(*(uint32_t *)(void *)(addr) = (val))
+
+uint32_t sim_get_primask(void);
+void sim_set_primask(uint32_t primask);
+uint32_t sim_get_basepri(void);
+void sim_set_basepri(uint32_t basepri);
+uint32_t sim_get_ipsr(void);
+void sim_wfi(void);
+
+#define __COMPILER_BARRIER()	__asm volatile("" ::: "memory")
+
+__STATIC_FORCEINLINE void __enable_irq(void){ sim_set_primask(0U); }
+__STATIC_FORCEINLINE void __disable_irq(void){ sim_set_primask(1U); }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void){ return sim_get_primask(); }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask){ sim_set_primask(priMask); }
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void){ return sim_get_basepri(); }
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basePri){ sim_set_basepri(basePri); }
+__STATIC_FORCEINLINE void __set_BASEPRI_MAX(uint32_t basePri){
+	uint32_t cur = sim_get_basepri();
+
+	if(basePri != 0U && (cur == 0U || basePri < cur)){
+		sim_set_basepri(basePri);
+	}
+}
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void){ return sim_get_ipsr(); }
+__STATIC_FORCEINLINE uint32_t __get_xPSR(void){ return sim_get_ipsr(); }
+__STATIC_FORCEINLINE uint32_t __get_APSR(void){ return 0U; }
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void){ return 0U; }
+__STATIC_FORCEINLINE void __set_CONTROL(uint32_t control){ (void)control; }
+__STATIC_FORCEINLINE uint32_t __get_FAULTMASK(void){ return 0U; }
+__STATIC_FORCEINLINE void __set_FAULTMASK(uint32_t faultMask){ (void)faultMask; }
+__STATIC_FORCEINLINE uint32_t __get_FPSCR(void){ return 0U; }
+__STATIC_FORCEINLINE void __set_FPSCR(uint32_t fpscr){ (void)fpscr; }
+/* the host stack is not in the 32 bit space: the low word only */
+__STATIC_FORCEINLINE uint32_t __get_MSP(void){ return (uint32_t)(uintptr_t)__builtin_frame_address(0); }
+__STATIC_FORCEINLINE uint32_t __get_PSP(void){ return (uint32_t)(uintptr_t)__builtin_frame_address(0); }
+__STATIC_FORCEINLINE void __set_MSP(uint32_t topOfMainStack){ (void)topOfMainStack; }
+__STATIC_FORCEINLINE void __set_PSP(uint32_t topOfProcStack){ (void)topOfProcStack; }
+
+#define __NOP()					__asm volatile("nop")
+#define __WFI()					sim_wfi()
+#define __WFE()					sim_wfi()
+#define __SEV()					__COMPILER_BARRIER()
+#define __BKPT(value)			__builtin_trap()
+
+__STATIC_FORCEINLINE void __ISB(void){ __COMPILER_BARRIER(); }
+__STATIC_FORCEINLINE void __DSB(void){ __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_FORCEINLINE void __DMB(void){ __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value){ return __builtin_bswap32(value); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value){
+	return ((value & 0x00FF00FFU) << 8) | ((value >> 8) & 0x00FF00FFU);
+}
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t value){ return (int16_t)__builtin_bswap16((uint16_t)value); }
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2){
+	op2 %= 32U;
+	return (op2 == 0U) ? op1 : (op1 >> op2) | (op1 << (32U - op2));
+}
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value){
+	uint32_t result = 0U;
+
+	for(int i = 0; i < 32; i++){
+		result = (result << 1) | (value & 1U);
+		value >>= 1;
+	}
+	return result;
+}
+#define __CLZ(x)				(uint8_t)((x) ? __builtin_clz(x) : 32)
+
+__STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t *addr){ return *addr; }
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t *addr){ return *addr; }
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *addr){ return *addr; }
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t value, volatile uint8_t *addr){ *addr = value; return 0U; }
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t *addr){ *addr = value; return 0U; }
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *addr){ *addr = value; return 0U; }
+__STATIC_FORCEINLINE void __CLREX(void){ }
+
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t val, uint32_t sat){
+	if(sat >= 1U && sat <= 32U){
+		const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+		const int32_t min = -1 - max;
+
+		if(val > max){
+			return max;
+		}
+		if(val < min){
+			return min;
+		}
+	}
+	return val;
+}
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t val, uint32_t sat){
+	if(sat <= 31U){
+		const uint32_t max = ((1U << sat) - 1U);
+
+		if(val > (int32_t)max){
+			return max;
+		}
+		if(val < 0){
+			return 0U;
+		}
+	}
+	return (uint32_t)val;
+}
+
+#endif /* HOST_SIM_SIM_CMSIS_H_ */
@@ -0,0 +1,293 @@
+/**
+ * sim_dma.c
+ *	@brief simulator model of DMA1 and DMA2, 8 streams each
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * A peripheral holds a request line per stream and channel (sim_dma_dreq,
+ * RM0383 tables 27 and 28 say which). While the request of the channel a
+ * stream selects (CHSEL) is up and the stream is enabled, the stream moves
+ * one item every SIM_DMA_CYCLES of HCLK, through sim_bus_read/write so the
+ * peripheral sees the access as it would see the CPU's (DR read clears
+ * RXNE, DR write starts the shift register). Memory to memory streams run
+ * without a request. NDTR counts down; HTIF at half, TCIF at the end, then
+ * circular streams reload and the others disable themselves. Direct mode
+ * only: the FIFO, double buffering and bursts are not modelled. A
+ * transfer error happens only where a test asks for one (sim_dma_error):
+ * TEIF, the item not moved, the stream disabled.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "sim.h"
+
+#define SIM_DMA_CYCLES			(4U)		// HCLK cycles per item
+#define SIM_DMA_STREAMS			(8)
+
+typedef struct {
+	DMA_TypeDef *regs;
+	IRQn_Type irq[SIM_DMA_STREAMS];
+	uint32_t ndtr0[SIM_DMA_STREAMS];		// NDTR at enable
+	uint32_t idx[SIM_DMA_STREAMS];			// items moved since the last reload
+	uint32_t error_in[SIM_DMA_STREAMS];		// the item that fails is error_in - 1 from now, 0: none
+	uint8_t req[SIM_DMA_STREAMS];			// request lines up, one bit per channel
+	sim_event_t ev;
+} sim_dma_t;
+
+static sim_dma_t dmas[2] = {
+	{ DMA1, { DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+			  DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn } },
+	{ DMA2, { DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+			  DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn } },
+};
+
+/* flag position of a stream in LISR/HISR */
+static const uint8_t flag_shift[4] = { 0, 6, 16, 22 };
+
+static DMA_Stream_TypeDef *stream_regs(sim_dma_t *d, int s){
+	return SIM_VIEW((DMA_Stream_TypeDef *)((uintptr_t)d->regs + 0x10U + 0x18U * (uint32_t)s));
+}
+
+static volatile uint32_t *isr_of(sim_dma_t *d, int s){
+	DMA_TypeDef *v = SIM_VIEW(d->regs);
+
+	return (s < 4) ? &v->LISR : &v->HISR;
+}
+
+/**
+ * uint32_t stream_flags(sim_dma_t *d, int s)
+ * @brief FEIF, DMEIF, TEIF, HTIF, TCIF of a stream, bits 0..5
+ */
+static uint32_t stream_flags(sim_dma_t *d, int s){
+	return (*isr_of(d, s) >> flag_shift[s & 3]) & 0x3DU;
+}
+
+static void stream_flag(sim_dma_t *d, int s, uint32_t flag){
+	*isr_of(d, s) |= flag << flag_shift[s & 3];
+}
+
+/**
+ * void stream_irq(sim_dma_t *d, int s)
+ * @brief the interrupt line of a stream: a flag up with its enable
+ */
+static void stream_irq(sim_dma_t *d, int s){
+	DMA_Stream_TypeDef *st = stream_regs(d, s);
+	uint32_t f = stream_flags(d, s);
+	int level = ((f & DMA_LISR_TCIF0) && (st->CR & DMA_SxCR_TCIE))
+			|| ((f & DMA_LISR_HTIF0) && (st->CR & DMA_SxCR_HTIE))
+			|| ((f & DMA_LISR_TEIF0) && (st->CR & DMA_SxCR_TEIE))
+			|| ((f & DMA_LISR_DMEIF0) && (st->CR & DMA_SxCR_DMEIE))
+			|| ((f & DMA_LISR_FEIF0) && (st->FCR & DMA_SxFCR_FEIE));
+
+	sim_irq_line(d->irq[s], 0, level);
+}
+
+/**
+ * int stream_ready(sim_dma_t *d, int s)
+ * @brief enabled and requested (memory to memory: always)
+ */
+static int stream_ready(sim_dma_t *d, int s){
+	DMA_Stream_TypeDef *st = stream_regs(d, s);
+	uint32_t chsel = (st->CR & DMA_SxCR_CHSEL) >> DMA_SxCR_CHSEL_Pos;
+
+	if(!(st->CR & DMA_SxCR_EN)){
+		return 0;
+	}
+	return ((st->CR & DMA_SxCR_DIR) == DMA_SxCR_DIR_1) || ((d->req[s] >> chsel) & 1U);
+}
+
+static void dma_schedule(sim_dma_t *d){
+	if(!d->ev.armed){
+		sim_event_at(&d->ev, sim_now + sim_cycles_ns(SIM_DMA_CYCLES, sim_hclk()));
+	}
+}
+
+/**
+ * void stream_item(sim_dma_t *d, int s)
+ * @brief move one item of a stream
+ * @step followed:
+ *
+ * 1. A transfer error asked for: TEIF and disable, nothing moved
+ * 2. Addresses of the item from PAR/M0AR, the sizes and the increments
+ * 3. Read the source, write the destination
+ * 4. NDTR down: HTIF at half, TCIF at 0, then reload (circular) or disable
+ */
+static void stream_item(sim_dma_t *d, int s){
+	DMA_Stream_TypeDef *st = stream_regs(d, s);
+	uint32_t cr = st->CR;
+	uint32_t psize = 1U << ((cr & DMA_SxCR_PSIZE) >> DMA_SxCR_PSIZE_Pos);
+	uint32_t msize = 1U << ((cr & DMA_SxCR_MSIZE) >> DMA_SxCR_MSIZE_Pos);
+	uint32_t pa, ma, v;
+
+	/*1. A transfer error asked for*/
+	if(d->error_in[s] != 0U && --d->error_in[s] == 0U){
+		stream_flag(d, s, DMA_LISR_TEIF0);
+		st->CR &= ~DMA_SxCR_EN;
+		stream_irq(d, s);
+		return;
+	}
+
+	/*2. Addresses of the item*/
+	pa = st->PAR + ((cr & DMA_SxCR_PINC) ? d->idx[s] * psize : 0U);
+	ma = st->M0AR + ((cr & DMA_SxCR_MINC) ? d->idx[s] * msize : 0U);
+
+	/*3. Read the source, write the destination*/
+	if((cr & DMA_SxCR_DIR) == 0U){
+		v = sim_bus_read(pa, psize);
+		sim_bus_write(ma, v, msize);
+	}else{
+		v = sim_bus_read(ma, msize);
+		sim_bus_write(pa, v, psize);
+	}
+
+	/*4. NDTR down*/
+	d->idx[s]++;
+	st->NDTR = (st->NDTR - 1U) & DMA_SxNDT;
+	if(d->idx[s] == d->ndtr0[s] / 2U){
+		stream_flag(d, s, DMA_LISR_HTIF0);
+	}
+	if(st->NDTR == 0U){
+		stream_flag(d, s, DMA_LISR_TCIF0);
+		if(cr & DMA_SxCR_CIRC){
+			st->NDTR = d->ndtr0[s];
+			d->idx[s] = 0;
+		}else{
+			st->CR &= ~DMA_SxCR_EN;
+		}
+	}
+	stream_irq(d, s);
+}
+
+/**
+ * void dma_service(void *ctx)
+ * @brief one item on every stream that is ready, again while any is
+ */
+static void dma_service(void *ctx){
+	sim_dma_t *d = ctx;
+	int again = 0;
+
+	for(int s = 0; s < SIM_DMA_STREAMS; s++){
+		if(stream_ready(d, s)){
+			stream_item(d, s);
+		}
+	}
+	for(int s = 0; s < SIM_DMA_STREAMS; s++){
+		again |= stream_ready(d, s);
+	}
+	if(again){
+		dma_schedule(d);
+	}
+}
+
+/**
+ * void dma_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief ISR read only, IFCR write 1 to clear, stream enable and disable
+ */
+static void dma_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	sim_dma_t *d = ctx;
+	DMA_TypeDef *v = SIM_VIEW(d->regs);
+	int s;
+
+	switch(off){
+	case offsetof(DMA_TypeDef, LISR):
+	case offsetof(DMA_TypeDef, HISR):
+		*(volatile uint32_t *)((uintptr_t)v + off) = old;
+		return;
+	case offsetof(DMA_TypeDef, LIFCR):
+		v->LISR &= ~val;
+		v->LIFCR = 0;
+		for(s = 0; s < 4; s++){
+			stream_irq(d, s);
+		}
+		return;
+	case offsetof(DMA_TypeDef, HIFCR):
+		v->HISR &= ~val;
+		v->HIFCR = 0;
+		for(s = 4; s < SIM_DMA_STREAMS; s++){
+			stream_irq(d, s);
+		}
+		return;
+	default:
+		break;
+	}
+
+	s = (int)((off - 0x10U) / 0x18U);
+	if(s >= SIM_DMA_STREAMS){
+		return;
+	}
+	switch((off - 0x10U) % 0x18U){
+	case offsetof(DMA_Stream_TypeDef, CR):
+		if((val & DMA_SxCR_EN) && !(old & DMA_SxCR_EN)){
+			d->ndtr0[s] = stream_regs(d, s)->NDTR;
+			d->idx[s] = 0;
+			dma_schedule(d);
+		}else if(!(val & DMA_SxCR_EN) && (old & DMA_SxCR_EN) && stream_regs(d, s)->NDTR != 0U){
+			/* disabled by software before the end: TCIF all the same */
+			stream_flag(d, s, DMA_LISR_TCIF0);
+		}else if(old & DMA_SxCR_EN){
+			/* enabled: only EN can change */
+			stream_regs(d, s)->CR = (old & ~DMA_SxCR_EN) | (val & DMA_SxCR_EN);
+		}
+		stream_irq(d, s);
+		break;
+	case offsetof(DMA_Stream_TypeDef, NDTR):
+		if(stream_regs(d, s)->CR & DMA_SxCR_EN){
+			stream_regs(d, s)->NDTR = old;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * void sim_dma_dreq(DMA_TypeDef *dma, uint32_t streams, uint32_t channel, int level)
+ * @brief a peripheral's request line to the streams (bit mask) that can serve it on channel
+ */
+void sim_dma_dreq(DMA_TypeDef *dma, uint32_t streams, uint32_t channel, int level){
+	sim_dma_t *d = (dma == DMA1) ? &dmas[0] : &dmas[1];
+
+	for(int s = 0; s < SIM_DMA_STREAMS; s++){
+		if(!(streams & (1U << s))){
+			continue;
+		}
+		if(level){
+			d->req[s] |= (uint8_t)(1U << channel);
+		}else{
+			d->req[s] &= (uint8_t)~(1U << channel);
+		}
+		if(stream_ready(d, s)){
+			dma_schedule(d);
+		}
+	}
+}
+
+/**
+ * void sim_dma_init(void)
+ * @brief both controllers idle, the hooks
+ */
+void sim_dma_init(void){
+	for(int i = 0; i < 2; i++){
+		sim_dma_t *d = &dmas[i];
+
+		memset(d->ndtr0, 0, sizeof(d->ndtr0));
+		memset(d->idx, 0, sizeof(d->idx));
+		memset(d->req, 0, sizeof(d->req));
+		memset(d->error_in, 0, sizeof(d->error_in));
+		sim_event_init(&d->ev, dma_service, d);
+		for(int s = 0; s < SIM_DMA_STREAMS; s++){
+			stream_regs(d, s)->FCR = DMA_SxFCR_FS_0;		// FIFO empty
+		}
+		sim_hook((uintptr_t)d->regs, 0x400, 0, dma_write, d);
+	}
+}
+
+/**
+ * void sim_dma_error(DMA_TypeDef *dma, int stream, uint32_t items)
+ * @brief a bus error on the stream after it has moved items more items
+ */
+void sim_dma_error(DMA_TypeDef *dma, int stream, uint32_t items){
+	sim_dma_t *d = (dma == DMA1) ? &dmas[0] : &dmas[1];
+
+	d->error_in[stream] = items + 1U;
+}
@@ -0,0 +1,265 @@
+/**
+ * sim_gpio.c
+ *	@brief simulator model of GPIOA..E, H, SYSCFG EXTICR and EXTI lines 0..15
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The level of a pin: an output driving low is low, a push-pull output
+ * driving high is high; otherwise (input, alternate function, open drain
+ * released) what is driven from outside (sim_gpio_input), else the pull,
+ * else high for open drain and alternate function (the board pull-ups of
+ * a bus) and low for an input. IDR reads those levels. Every change of a
+ * level goes to the observers of the port and, through the EXTICR
+ * selection, to the edge detectors of EXTI.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+#define SIM_GPIO_PORTS			(8)			// A..H, F and G not on the F411
+#define SIM_GPIO_WATCHERS		(4)
+#define SIM_EXTI_LINES			(16)
+#define MODE_OUT				(1U)		// MODER
+#define MODE_AF					(2U)
+
+typedef struct {
+	GPIO_TypeDef *regs;
+	uint16_t drive, ext;			// pins driven from outside, their levels
+	uint16_t levels;
+	struct {
+		sim_gpio_watch_t fn;
+		void *ctx;
+	} watch[SIM_GPIO_WATCHERS];
+} sim_gpio_t;
+
+static sim_gpio_t ports[SIM_GPIO_PORTS];
+
+static void exti_update(void);
+
+/**
+ * sim_gpio_t *port_of(GPIO_TypeDef *g)
+ * @brief the model of a port (index = EXTICR code)
+ */
+static sim_gpio_t *port_of(GPIO_TypeDef *g){
+	uint32_t i = ((uintptr_t)g - GPIOA_BASE) / 0x400U;
+
+	return (i < SIM_GPIO_PORTS) ? &ports[i] : 0;
+}
+
+/**
+ * uint16_t pin_levels(sim_gpio_t *p)
+ * @brief the level of every pin of the port
+ */
+static uint16_t pin_levels(sim_gpio_t *p){
+	GPIO_TypeDef *g = SIM_VIEW(p->regs);
+	uint16_t levels = 0;
+
+	for(int pin = 0; pin < 16; pin++){
+		uint32_t mode = (g->MODER >> (2 * pin)) & 3U;
+		uint32_t pull = (g->PUPDR >> (2 * pin)) & 3U;
+		uint32_t out = (g->ODR >> pin) & 1U;
+		uint32_t od = (g->OTYPER >> pin) & 1U;
+		uint32_t level;
+
+		if(mode == MODE_OUT && !out){
+			level = 0;
+		}else if(mode == MODE_OUT && !od){
+			level = 1;
+		}else if(p->drive & (1U << pin)){
+			level = (p->ext >> pin) & 1U;
+		}else if(pull == 1U){
+			level = 1;
+		}else if(pull == 2U){
+			level = 0;
+		}else{
+			level = (mode == MODE_OUT || (mode == MODE_AF && od));
+		}
+		levels |= (uint16_t)(level << pin);
+	}
+	return levels;
+}
+
+/**
+ * void port_update(sim_gpio_t *p)
+ * @brief new pin levels: IDR, the observers, the EXTI edges
+ */
+static void port_update(sim_gpio_t *p){
+	uint16_t levels = pin_levels(p);
+	uint16_t changed = levels ^ p->levels;
+	uint32_t code = (uint32_t)(p - ports);
+
+	SIM_VIEW(p->regs)->IDR = levels;
+	if(changed == 0){
+		return;
+	}
+	p->levels = levels;
+	for(int i = 0; i < SIM_GPIO_WATCHERS; i++){
+		if(p->watch[i].fn){
+			p->watch[i].fn(p->watch[i].ctx, p->regs, levels, changed);
+		}
+	}
+
+	/* edges on the lines that select this port */
+	for(int line = 0; line < SIM_EXTI_LINES; line++){
+		uint32_t bit = 1U << line;
+		uint32_t sel = (SIM_VIEW(SYSCFG)->EXTICR[line / 4] >> (4 * (line % 4))) & 0xFU;
+		EXTI_TypeDef *e = SIM_VIEW(EXTI);
+
+		if(!(changed & bit) || sel != code){
+			continue;
+		}
+		if(((levels & bit) && (e->RTSR & bit)) || (!(levels & bit) && (e->FTSR & bit))){
+			e->PR |= bit;
+		}
+	}
+	exti_update();
+}
+
+/**
+ * void gpio_read(void *ctx, uint32_t off, int after)
+ * @brief IDR holds the levels
+ */
+static void gpio_read(void *ctx, uint32_t off, int after){
+	if(off == offsetof(GPIO_TypeDef, IDR) && !after){
+		port_update(ctx);
+	}
+}
+
+/**
+ * void gpio_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief BSRR into ODR (set wins), IDR read only, then the new levels
+ */
+static void gpio_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	sim_gpio_t *p = ctx;
+	GPIO_TypeDef *g = SIM_VIEW(p->regs);
+
+	switch(off){
+	case offsetof(GPIO_TypeDef, BSRR):
+		g->ODR = (g->ODR & ~(val >> 16)) | (val & 0xFFFFU);
+		g->BSRR = 0;
+		break;
+	case offsetof(GPIO_TypeDef, ODR):
+		g->ODR = val & 0xFFFFU;
+		break;
+	case offsetof(GPIO_TypeDef, IDR):
+		g->IDR = old;
+		break;
+	default:
+		break;
+	}
+	port_update(p);
+}
+
+/**
+ * void sim_gpio_input(GPIO_TypeDef *port, int pin, int level)
+ * @brief drive a pin from outside
+ */
+void sim_gpio_input(GPIO_TypeDef *port, int pin, int level){
+	sim_gpio_t *p = port_of(port);
+
+	p->drive |= (uint16_t)(1U << pin);
+	p->ext = (uint16_t)((p->ext & ~(1U << pin)) | ((level ? 1U : 0U) << pin));
+	port_update(p);
+}
+
+/**
+ * void sim_gpio_release(GPIO_TypeDef *port, int pin)
+ * @brief stop driving a pin from outside
+ */
+void sim_gpio_release(GPIO_TypeDef *port, int pin){
+	sim_gpio_t *p = port_of(port);
+
+	p->drive &= (uint16_t)~(1U << pin);
+	port_update(p);
+}
+
+/**
+ * int sim_gpio_level(GPIO_TypeDef *port, int pin)
+ * @brief the level of a pin now
+ */
+int sim_gpio_level(GPIO_TypeDef *port, int pin){
+	sim_gpio_t *p = port_of(port);
+
+	port_update(p);
+	return (p->levels >> pin) & 1;
+}
+
+/**
+ * void sim_gpio_watch(GPIO_TypeDef *port, sim_gpio_watch_t fn, void *ctx)
+ * @brief call fn at every change of a level of the port (a device on the pins)
+ */
+void sim_gpio_watch(GPIO_TypeDef *port, sim_gpio_watch_t fn, void *ctx){
+	sim_gpio_t *p = port_of(port);
+
+	for(int i = 0; i < SIM_GPIO_WATCHERS; i++){
+		if(p->watch[i].fn == 0){
+			p->watch[i].fn = fn;
+			p->watch[i].ctx = ctx;
+			return;
+		}
+	}
+	fprintf(stderr, "sim: too many observers of a port\n");
+}
+
+/**
+ * void exti_update(void)
+ * @brief the EXTI interrupt lines: pending and not masked
+ */
+static void exti_update(void){
+	EXTI_TypeDef *e = SIM_VIEW(EXTI);
+	uint32_t on = e->PR & e->IMR;
+
+	for(int line = 0; line < SIM_EXTI_LINES; line++){
+		IRQn_Type irq = (line < 5) ? (IRQn_Type)(EXTI0_IRQn + line) : (line < 10) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
+
+		sim_irq_line(irq, (uint32_t)line, (on >> line) & 1U);
+	}
+}
+
+/**
+ * void exti_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief PR is write 1 to clear (and clears SWIER), SWIER sets PR on a 0 -> 1 change
+ */
+static void exti_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	EXTI_TypeDef *e = SIM_VIEW(EXTI);
+
+	if(off == offsetof(EXTI_TypeDef, PR)){
+		e->PR = old & ~val;
+		e->SWIER &= ~val;
+	}else if(off == offsetof(EXTI_TypeDef, SWIER)){
+		e->PR |= val & ~old & e->IMR;
+	}
+	exti_update();
+}
+
+/**
+ * void sim_gpio_init(void)
+ * @brief reset values (PA13/14/15, PB3/4 are the debug port) and the hooks
+ */
+void sim_gpio_init(void){
+	for(int i = 0; i < SIM_GPIO_PORTS; i++){
+		sim_gpio_t *p = &ports[i];
+
+		if(i == 5 || i == 6){
+			continue;
+		}
+		memset(p, 0, sizeof(*p));
+		p->regs = (GPIO_TypeDef *)(GPIOA_BASE + 0x400U * (uint32_t)i);
+		sim_hook((uintptr_t)p->regs, 0x400, gpio_read, gpio_write, p);
+	}
+	SIM_VIEW(GPIOA)->MODER = 0xA8000000U;
+	SIM_VIEW(GPIOA)->PUPDR = 0x64000000U;
+	SIM_VIEW(GPIOA)->OSPEEDR = 0x0C000000U;
+	SIM_VIEW(GPIOB)->MODER = 0x00000280U;
+	SIM_VIEW(GPIOB)->PUPDR = 0x00000100U;
+	SIM_VIEW(GPIOB)->OSPEEDR = 0x000000C0U;
+	for(int i = 0; i < SIM_GPIO_PORTS; i++){
+		if(ports[i].regs){
+			ports[i].levels = pin_levels(&ports[i]);
+			SIM_VIEW(ports[i].regs)->IDR = ports[i].levels;
+		}
+	}
+	sim_hook(EXTI_BASE, 0x400, 0, exti_write, 0);
+}
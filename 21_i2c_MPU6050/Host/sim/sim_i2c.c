@@ -0,0 +1,536 @@
+/**
+ * sim_i2c.c
+ *	@brief simulator model of I2C1..I2C3 in master mode, and a register file slave
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The bus is modelled per phase on the wire: START and STOP take half a
+ * bit, the address and every data byte 9 bits, at the rate CCR gives from
+ * PCLK1 (standard mode 2 * CCR, fast mode 3 or 25 * CCR). Between the
+ * phases the master holds SCL low until the driver does what the flags
+ * ask (HOLD):
+ *
+ *   START       -> SB, MSL, BUSY; cleared by SR1 read + DR write (address)
+ *   address     -> ADDR (ACK) or AF (NACK); ADDR cleared by SR1 + SR2 reads
+ *   TX byte     DR goes to the shift register at once when it is empty
+ *               (TXE stays set), else waits there (TXE clear); at the end
+ *               of a byte with nothing waiting: BTF, SCL held
+ *   RX byte     into DR (RXNE) if it is empty, else kept in the shift
+ *               register (BTF) until DR is read; the ACK bit decides at
+ *               the end of the byte whether the next one follows
+ *   STOP        -> BUSY and MSL clear; CR1.STOP clears when it is out
+ *
+ * START and STOP asked for during a byte go out after it, as in RM0383
+ * 18.3.3. SR1 error flags are write 0 to clear, SR2 is read only. PE = 0
+ * ends everything and clears START, STOP and ACK; SWRST resets the
+ * registers. The event line is ITEVTEN with SB/ADDR/BTF (and ITBUFEN with
+ * TXE/RXNE), the error line ITERREN with any error flag. Arbitration,
+ * bus errors, PEC, SMBus, 10 bit addresses, slave mode and DMA are not
+ * modelled.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "sim.h"
+
+#define SIM_I2C_BUSES			(3)
+#define I2C_SR1_ERR_FLAGS		(I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR | I2C_SR1_PECERR \
+								 | I2C_SR1_TIMEOUT | I2C_SR1_SMBALERT)
+
+typedef enum {
+	PH_IDLE = 0,	// bus free
+	PH_HOLD,		// master owns the bus, SCL held low, waiting for the driver
+	PH_START,
+	PH_ADDR,
+	PH_TX,
+	PH_RX,
+	PH_STOP
+} sim_i2c_phase_t;
+
+typedef struct {
+	I2C_TypeDef *regs;
+	IRQn_Type ev_irq, er_irq;
+	sim_i2c_dev_t *devs;
+	sim_i2c_dev_t *cur;			// addressed slave, 0 after a NACK
+	sim_i2c_phase_t phase;
+	sim_event_t ev;
+	int rd;						// direction of the last address
+	int addressed;				// ADDR cleared: data phase
+	uint8_t shift;				// byte in the shift register
+	uint8_t dr_tx;				// DR written, waiting for the shift register
+	int dr_full;
+	int rx_held;				// a received byte waits in the shift register (BTF)
+	int acked;					// the last received byte was acknowledged
+	int sr1_read;				// first half of the clearing sequences
+	int start_req, stop_req;
+	sim_i2c_stats_t stats;
+} sim_i2c_t;
+
+static sim_i2c_t buses[SIM_I2C_BUSES] = {
+	{ I2C1, I2C1_EV_IRQn, I2C1_ER_IRQn },
+	{ I2C2, I2C2_EV_IRQn, I2C2_ER_IRQn },
+	{ I2C3, I2C3_EV_IRQn, I2C3_ER_IRQn },
+};
+
+static sim_i2c_t *bus_of(I2C_TypeDef *i2c){
+	for(int i = 0; i < SIM_I2C_BUSES; i++){
+		if(buses[i].regs == i2c){
+			return &buses[i];
+		}
+	}
+	return 0;
+}
+
+/**
+ * uint64_t bit_ns(sim_i2c_t *b)
+ * @brief SCL period from CCR and PCLK1
+ */
+static uint64_t bit_ns(sim_i2c_t *b){
+	uint32_t ccr = SIM_VIEW(b->regs)->CCR;
+	uint32_t n = ccr & I2C_CCR_CCR;
+	uint32_t clocks;
+
+	if(n == 0U){
+		return 10000U;
+	}
+	if(!(ccr & I2C_CCR_FS)){
+		clocks = 2U * n;
+	}else{
+		clocks = (ccr & I2C_CCR_DUTY) ? 25U * n : 3U * n;
+	}
+	return sim_cycles_ns(clocks, sim_pclk(1));
+}
+
+/**
+ * void bus_irq(sim_i2c_t *b)
+ * @brief the event and error interrupt lines
+ */
+static void bus_irq(sim_i2c_t *b){
+	I2C_TypeDef *r = SIM_VIEW(b->regs);
+	uint32_t sr1 = r->SR1;
+	uint32_t cr2 = r->CR2;
+	int ev = (cr2 & I2C_CR2_ITEVTEN) && ((sr1 & (I2C_SR1_SB | I2C_SR1_ADDR | I2C_SR1_ADD10 | I2C_SR1_STOPF
+			| I2C_SR1_BTF)) || ((cr2 & I2C_CR2_ITBUFEN) && (sr1 & (I2C_SR1_TXE | I2C_SR1_RXNE))));
+	int er = (cr2 & I2C_CR2_ITERREN) && (sr1 & I2C_SR1_ERR_FLAGS);
+
+	sim_irq_line(b->ev_irq, 0, ev);
+	sim_irq_line(b->er_irq, 0, er);
+}
+
+static void phase(sim_i2c_t *b, sim_i2c_phase_t p, uint64_t ns){
+	b->phase = p;
+	sim_event_at(&b->ev, sim_now + ns);
+}
+
+/**
+ * void bus_reset(sim_i2c_t *b)
+ * @brief off the bus: nothing on the wire, the slave forgets the transfer
+ */
+static void bus_reset(sim_i2c_t *b){
+	sim_event_cancel(&b->ev);
+	if(b->cur && b->cur->stop && b->phase != PH_IDLE){
+		b->cur->stop(b->cur);
+	}
+	b->cur = 0;
+	b->phase = PH_IDLE;
+	b->addressed = 0;
+	b->dr_full = 0;
+	b->rx_held = 0;
+	b->sr1_read = 0;
+	b->start_req = 0;
+	b->stop_req = 0;
+}
+
+/**
+ * void next(sim_i2c_t *b)
+ * @brief a phase is over and SCL is low: STOP or START asked for, else HOLD
+ */
+static void next(sim_i2c_t *b){
+	if(b->stop_req){
+		b->stop_req = 0;
+		phase(b, PH_STOP, bit_ns(b) / 2U);
+	}else if(b->start_req){
+		b->start_req = 0;
+		if(b->cur && b->cur->stop){
+			b->cur->stop(b->cur);
+		}
+		b->cur = 0;
+		phase(b, PH_START, bit_ns(b) / 2U);
+	}else{
+		b->phase = PH_HOLD;
+	}
+}
+
+/**
+ * void tx_load(sim_i2c_t *b, uint8_t byte)
+ * @brief a data byte into the shift register
+ */
+static void tx_load(sim_i2c_t *b, uint8_t byte){
+	b->shift = byte;
+	SIM_VIEW(b->regs)->SR1 |= I2C_SR1_TXE;
+	phase(b, PH_TX, 9U * bit_ns(b));
+}
+
+/**
+ * void rx_begin(sim_i2c_t *b)
+ * @brief the slave puts the next byte on the wire
+ */
+static void rx_begin(sim_i2c_t *b){
+	phase(b, PH_RX, 9U * bit_ns(b));
+}
+
+/**
+ * void phase_end(void *ctx)
+ * @brief a phase on the wire is over
+ * @step followed:
+ *
+ * 1. START: SB, MSL, BUSY, CR1.START cleared
+ * 2. Address: the slave answers, ADDR or AF
+ * 3. TX byte: the slave answers; the next byte, BTF or AF
+ * 4. RX byte: into DR or held (BTF), ACK or NACK, the next byte
+ * 5. STOP: the bus is free
+ */
+static void phase_end(void *ctx){
+	sim_i2c_t *b = ctx;
+	I2C_TypeDef *r = SIM_VIEW(b->regs);
+
+	switch(b->phase){
+
+	/*1. START*/
+	case PH_START:
+		r->CR1 &= ~I2C_CR1_START;
+		r->SR1 = (r->SR1 & ~(I2C_SR1_BTF | I2C_SR1_TXE | I2C_SR1_RXNE)) | I2C_SR1_SB;
+		r->SR2 |= I2C_SR2_MSL | I2C_SR2_BUSY;
+		b->addressed = 0;
+		b->dr_full = 0;
+		b->rx_held = 0;
+		b->stats.starts++;
+		b->phase = PH_HOLD;
+		break;
+
+	/*2. Address*/
+	case PH_ADDR:
+		b->rd = b->shift & 1U;
+		b->cur = 0;
+		for(sim_i2c_dev_t *d = b->devs; d; d = d->next){
+			if(d->addr == (b->shift >> 1)){
+				b->cur = d;
+				break;
+			}
+		}
+		if(b->cur){
+			if(b->cur->start){
+				b->cur->start(b->cur, b->rd);
+			}
+			r->SR1 |= I2C_SR1_ADDR;
+			r->SR2 = (r->SR2 & ~I2C_SR2_TRA) | (b->rd ? 0U : I2C_SR2_TRA);
+			b->phase = PH_HOLD;
+		}else{
+			r->SR1 |= I2C_SR1_AF;
+			b->stats.nacks++;
+			next(b);
+		}
+		break;
+
+	/*3. TX byte*/
+	case PH_TX: {
+		int ack = b->cur && b->cur->write && b->cur->write(b->cur, b->shift);
+
+		b->stats.bytes++;
+		if(!ack){
+			r->SR1 |= I2C_SR1_AF;
+			b->stats.nacks++;
+			next(b);
+		}else if(b->dr_full && !b->stop_req && !b->start_req){
+			b->dr_full = 0;
+			tx_load(b, b->dr_tx);
+		}else{
+			if(!b->dr_full){
+				r->SR1 |= I2C_SR1_BTF;
+			}
+			next(b);
+		}
+		break;
+	}
+
+	/*4. RX byte*/
+	case PH_RX: {
+		uint8_t byte = (b->cur && b->cur->read) ? b->cur->read(b->cur) : 0xFFU;
+
+		b->stats.bytes++;
+		b->acked = (r->CR1 & I2C_CR1_ACK) != 0U;
+		if(!(r->SR1 & I2C_SR1_RXNE)){
+			r->DR = byte;
+			r->SR1 |= I2C_SR1_RXNE;
+		}else{
+			b->shift = byte;
+			b->rx_held = 1;
+			r->SR1 |= I2C_SR1_BTF;
+		}
+		if(b->acked && !b->rx_held && !b->stop_req && !b->start_req){
+			rx_begin(b);
+		}else{
+			next(b);
+		}
+		break;
+	}
+
+	/*5. STOP*/
+	case PH_STOP:
+		r->CR1 &= ~I2C_CR1_STOP;
+		r->SR2 &= ~(I2C_SR2_MSL | I2C_SR2_BUSY | I2C_SR2_TRA);
+		r->SR1 &= ~(I2C_SR1_TXE | I2C_SR1_BTF);
+		if(b->cur && b->cur->stop){
+			b->cur->stop(b->cur);
+		}
+		b->cur = 0;
+		b->addressed = 0;
+		b->stats.stops++;
+		b->phase = PH_IDLE;
+		if(b->start_req){
+			b->start_req = 0;
+			phase(b, PH_START, bit_ns(b) / 2U);
+		}
+		break;
+
+	default:
+		break;
+	}
+	bus_irq(b);
+}
+
+/**
+ * void cr1_write(sim_i2c_t *b, uint32_t old, uint32_t val)
+ * @brief SWRST, PE, START and STOP
+ */
+static void cr1_write(sim_i2c_t *b, uint32_t old, uint32_t val){
+	I2C_TypeDef *r = SIM_VIEW(b->regs);
+
+	if(val & I2C_CR1_SWRST){
+		bus_reset(b);
+		memset((void *)r, 0, sizeof(*r));
+		r->CR1 = I2C_CR1_SWRST;
+		r->TRISE = 0x0002U;
+		return;
+	}
+	if(!(val & I2C_CR1_PE)){
+		bus_reset(b);
+		r->CR1 = val & ~(I2C_CR1_START | I2C_CR1_STOP | I2C_CR1_ACK);
+		r->SR1 &= I2C_SR1_ERR_FLAGS;
+		r->SR2 = 0;
+		return;
+	}
+	if((val & I2C_CR1_STOP) && !(old & I2C_CR1_STOP) && (r->SR2 & I2C_SR2_MSL)){
+		if(b->phase == PH_HOLD){
+			phase(b, PH_STOP, bit_ns(b) / 2U);
+		}else{
+			b->stop_req = 1;
+		}
+	}
+	if((val & I2C_CR1_START) && !(old & I2C_CR1_START)){
+		if(b->phase == PH_IDLE && !(r->SR2 & I2C_SR2_BUSY)){
+			phase(b, PH_START, bit_ns(b) / 2U);
+		}else if(b->phase == PH_HOLD){
+			if(b->cur && b->cur->stop){
+				b->cur->stop(b->cur);
+			}
+			b->cur = 0;
+			phase(b, PH_START, bit_ns(b) / 2U);
+		}else{
+			b->start_req = 1;
+		}
+	}
+}
+
+/**
+ * void dr_write(sim_i2c_t *b, uint8_t byte)
+ * @brief the address after SB, or a data byte
+ */
+static void dr_write(sim_i2c_t *b, uint8_t byte){
+	I2C_TypeDef *r = SIM_VIEW(b->regs);
+
+	if(r->SR1 & I2C_SR1_SB){
+		if(!b->sr1_read){
+			return;
+		}
+		r->SR1 &= ~I2C_SR1_SB;
+		b->sr1_read = 0;
+		b->shift = byte;
+		phase(b, PH_ADDR, 9U * bit_ns(b));
+		return;
+	}
+	if(!b->addressed || b->rd){
+		return;
+	}
+	if(r->SR1 & I2C_SR1_BTF){
+		r->SR1 &= ~I2C_SR1_BTF;
+		b->sr1_read = 0;
+	}
+	if(b->phase == PH_HOLD){
+		tx_load(b, byte);
+	}else{
+		b->dr_tx = byte;
+		b->dr_full = 1;
+		r->SR1 &= ~I2C_SR1_TXE;
+	}
+}
+
+/**
+ * void i2c_read(void *ctx, uint32_t off, int after)
+ * @brief the clearing sequences: SR1 then SR2 (ADDR), DR (RXNE, BTF)
+ */
+static void i2c_read(void *ctx, uint32_t off, int after){
+	sim_i2c_t *b = ctx;
+	I2C_TypeDef *r = SIM_VIEW(b->regs);
+
+	if(!after){
+		return;
+	}
+	switch(off){
+	case offsetof(I2C_TypeDef, SR1):
+		b->sr1_read = 1;
+		break;
+	case offsetof(I2C_TypeDef, SR2):
+		if(b->sr1_read && (r->SR1 & I2C_SR1_ADDR)){
+			r->SR1 &= ~I2C_SR1_ADDR;
+			b->addressed = 1;
+			if(b->rd){
+				rx_begin(b);
+			}else{
+				r->SR1 |= I2C_SR1_TXE;
+			}
+		}
+		b->sr1_read = 0;
+		break;
+	case offsetof(I2C_TypeDef, DR):
+		if(!b->rd || !b->addressed){
+			break;
+		}
+		r->SR1 &= ~I2C_SR1_RXNE;
+		if(b->rx_held){
+			/* the held byte moves in, SCL is released */
+			b->rx_held = 0;
+			r->DR = b->shift;
+			r->SR1 = (r->SR1 & ~I2C_SR1_BTF) | I2C_SR1_RXNE;
+			if(b->phase == PH_HOLD && b->acked){
+				rx_begin(b);
+			}
+		}
+		b->sr1_read = 0;
+		break;
+	default:
+		break;
+	}
+	bus_irq(b);
+}
+
+/**
+ * void i2c_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief CR1, CR2 (interrupt enables), DR, SR1 (rc_w0), SR2 (read only)
+ */
+static void i2c_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	sim_i2c_t *b = ctx;
+	I2C_TypeDef *r = SIM_VIEW(b->regs);
+
+	switch(off){
+	case offsetof(I2C_TypeDef, CR1):
+		cr1_write(b, old, val);
+		break;
+	case offsetof(I2C_TypeDef, DR):
+		dr_write(b, (uint8_t)val);
+		break;
+	case offsetof(I2C_TypeDef, SR1):
+		r->SR1 = old & (val | ~I2C_SR1_ERR_FLAGS);
+		break;
+	case offsetof(I2C_TypeDef, SR2):
+		r->SR2 = old;
+		break;
+	default:
+		break;
+	}
+	bus_irq(b);
+}
+
+/**
+ * void sim_i2c_attach(I2C_TypeDef *i2c, sim_i2c_dev_t *dev)
+ * @brief put a slave on a bus
+ */
+void sim_i2c_attach(I2C_TypeDef *i2c, sim_i2c_dev_t *dev){
+	sim_i2c_t *b = bus_of(i2c);
+
+	dev->next = b->devs;
+	b->devs = dev;
+}
+
+const sim_i2c_stats_t *sim_i2c_stats(I2C_TypeDef *i2c){
+	return &bus_of(i2c)->stats;
+}
+
+/* the register file slave */
+static void regs_start(sim_i2c_dev_t *d, int rd){
+	sim_i2c_regs_t *r = (sim_i2c_regs_t *)d;
+
+	r->first = !rd;
+	r->wrote = 0;
+	if(rd){
+		r->reads++;
+	}
+}
+
+static int regs_write(sim_i2c_dev_t *d, uint8_t byte){
+	sim_i2c_regs_t *r = (sim_i2c_regs_t *)d;
+
+	if(r->first){
+		r->ptr = byte;
+		r->first = 0;
+		return 1;
+	}
+	if(!r->wrote){
+		r->wrote = 1;
+		r->writes++;
+	}
+	r->regs[r->ptr] = byte;
+	if(r->on_write){
+		r->on_write(r->ctx, r->ptr);
+	}
+	r->ptr++;
+	return 1;
+}
+
+static uint8_t regs_read(sim_i2c_dev_t *d){
+	sim_i2c_regs_t *r = (sim_i2c_regs_t *)d;
+
+	if(r->on_read){
+		r->on_read(r->ctx, r->ptr);
+	}
+	return r->regs[r->ptr++];
+}
+
+/**
+ * void sim_i2c_regs_init(sim_i2c_regs_t *r, uint8_t addr7)
+ * @brief a register file slave at addr7: pointer byte first, auto-increment
+ */
+void sim_i2c_regs_init(sim_i2c_regs_t *r, uint8_t addr7){
+	memset(r, 0, sizeof(*r));
+	r->dev.addr = addr7;
+	r->dev.start = regs_start;
+	r->dev.write = regs_write;
+	r->dev.read = regs_read;
+}
+
+/**
+ * void sim_i2c_init(void)
+ * @brief every bus free, no slave, the hooks
+ */
+void sim_i2c_init(void){
+	for(int i = 0; i < SIM_I2C_BUSES; i++){
+		sim_i2c_t *b = &buses[i];
+
+		b->devs = 0;
+		bus_reset(b);
+		memset(&b->stats, 0, sizeof(b->stats));
+		sim_event_init(&b->ev, phase_end, b);
+		SIM_VIEW(b->regs)->TRISE = 0x0002U;
+		sim_hook((uintptr_t)b->regs, 0x400, i2c_read, i2c_write, b);
+	}
+}
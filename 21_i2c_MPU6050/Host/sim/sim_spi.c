@@ -0,0 +1,227 @@
+/**
+ * sim_spi.c
+ *	@brief simulator model of SPI1..SPI5 in master mode
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * A frame takes 8 (DFF: 16) SCK periods of PCLK / 2^(BR+1). DR written
+ * with the shift register empty starts a frame at once and TXE stays set;
+ * written during a frame it waits in the TX buffer (TXE clear) and follows
+ * without a gap. At the end of a frame the slave's byte (sim_spi_attach,
+ * 0xFF with none) goes to DR with RXNE, or is lost with OVR if RXNE is
+ * still set; BSY stays set while frames follow. OVR clears by DR read then
+ * SR read. The interrupt line is TXEIE/RXNEIE/ERRIE with their flags, the
+ * DMA requests TXDMAEN with TXE and RXDMAEN with RXNE (RM0383 tables 27,
+ * 28). Slave mode, CRC, TI mode, I2S and the NSS pin are not modelled;
+ * chip selects are GPIOs, which the slave can look at.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "sim.h"
+
+#define SIM_SPI_BUSES			(5)
+
+/* a request line: the streams that can serve it, on one channel */
+typedef struct {
+	DMA_TypeDef *dma;
+	uint8_t streams;
+	uint8_t channel;
+} sim_spi_dreq_t;
+
+typedef struct {
+	SPI_TypeDef *regs;
+	int apb;
+	IRQn_Type irq;
+	sim_spi_dreq_t dtx[2], drx[2];		// DMA requests
+	sim_spi_xfer_t fn;
+	void *ctx;
+	sim_event_t ev;
+	int shifting;
+	uint16_t shift;				// frame on the wire
+	uint16_t txbuf;
+	int txfull;
+	uint16_t rx;				// what DR reads
+	int dr_read;				// first half of the OVR clearing sequence
+} sim_spi_t;
+
+static sim_spi_t buses[SIM_SPI_BUSES] = {
+	{ SPI1, 2, SPI1_IRQn, { { DMA2, 0x28, 3 } }, { { DMA2, 0x05, 3 } } },
+	{ SPI2, 1, SPI2_IRQn, { { DMA1, 0x10, 0 } }, { { DMA1, 0x08, 0 } } },
+	{ SPI3, 1, SPI3_IRQn, { { DMA1, 0xA0, 0 } }, { { DMA1, 0x05, 0 } } },
+	{ SPI4, 2, SPI4_IRQn, { { DMA2, 0x02, 4 }, { DMA2, 0x10, 5 } }, { { DMA2, 0x01, 4 }, { DMA2, 0x08, 5 } } },
+	{ SPI5, 2, SPI5_IRQn, { { DMA2, 0x10, 2 }, { DMA2, 0x40, 7 } }, { { DMA2, 0x08, 2 }, { DMA2, 0x20, 7 } } },
+};
+
+static sim_spi_t *bus_of(SPI_TypeDef *spi){
+	for(int i = 0; i < SIM_SPI_BUSES; i++){
+		if(buses[i].regs == spi){
+			return &buses[i];
+		}
+	}
+	return 0;
+}
+
+/**
+ * void spi_update(sim_spi_t *b)
+ * @brief the interrupt line and the DMA requests from the flags
+ */
+static void spi_update(sim_spi_t *b){
+	SPI_TypeDef *r = SIM_VIEW(b->regs);
+	uint32_t sr = r->SR;
+	uint32_t cr2 = r->CR2;
+	int on = (r->CR1 & SPI_CR1_SPE) != 0U;
+	int irq = ((cr2 & SPI_CR2_TXEIE) && (sr & SPI_SR_TXE)) || ((cr2 & SPI_CR2_RXNEIE) && (sr & SPI_SR_RXNE))
+			|| ((cr2 & SPI_CR2_ERRIE) && (sr & (SPI_SR_OVR | SPI_SR_MODF | SPI_SR_CRCERR)));
+
+	sim_irq_line(b->irq, 0, irq);
+	for(int i = 0; i < 2; i++){
+		if(b->dtx[i].dma){
+			sim_dma_dreq(b->dtx[i].dma, b->dtx[i].streams, b->dtx[i].channel,
+					on && (cr2 & SPI_CR2_TXDMAEN) && (sr & SPI_SR_TXE));
+		}
+		if(b->drx[i].dma){
+			sim_dma_dreq(b->drx[i].dma, b->drx[i].streams, b->drx[i].channel,
+					on && (cr2 & SPI_CR2_RXDMAEN) && (sr & SPI_SR_RXNE));
+		}
+	}
+}
+
+/**
+ * uint64_t frame_ns(sim_spi_t *b)
+ * @brief one frame: 8 or 16 SCK periods
+ */
+static uint64_t frame_ns(sim_spi_t *b){
+	uint32_t cr1 = SIM_VIEW(b->regs)->CR1;
+	uint32_t div = 2U << ((cr1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos);
+	uint32_t bits = (cr1 & SPI_CR1_DFF) ? 16U : 8U;
+
+	return sim_cycles_ns((uint64_t)bits * div, sim_pclk(b->apb));
+}
+
+static void frame_start(sim_spi_t *b, uint16_t data){
+	b->shift = data;
+	b->shifting = 1;
+	SIM_VIEW(b->regs)->SR |= SPI_SR_TXE | SPI_SR_BSY;
+	sim_event_at(&b->ev, sim_now + frame_ns(b));
+}
+
+/**
+ * void frame_end(void *ctx)
+ * @brief the slave's frame into DR (RXNE) or lost (OVR), the next frame or not busy
+ */
+static void frame_end(void *ctx){
+	sim_spi_t *b = ctx;
+	SPI_TypeDef *r = SIM_VIEW(b->regs);
+	uint16_t miso = b->fn ? b->fn(b->ctx, (uint8_t)b->shift) : 0xFFU;
+
+	if(r->SR & SPI_SR_RXNE){
+		r->SR |= SPI_SR_OVR;
+	}else{
+		b->rx = miso;
+		r->DR = miso;
+		r->SR |= SPI_SR_RXNE;
+	}
+	if(b->txfull){
+		b->txfull = 0;
+		frame_start(b, b->txbuf);
+	}else{
+		b->shifting = 0;
+		r->SR &= ~SPI_SR_BSY;
+	}
+	spi_update(b);
+}
+
+/**
+ * void spi_read(void *ctx, uint32_t off, int after)
+ * @brief DR read clears RXNE, DR then SR read clears OVR
+ */
+static void spi_read(void *ctx, uint32_t off, int after){
+	sim_spi_t *b = ctx;
+	SPI_TypeDef *r = SIM_VIEW(b->regs);
+
+	if(!after){
+		return;
+	}
+	if(off == offsetof(SPI_TypeDef, DR)){
+		r->SR &= ~SPI_SR_RXNE;
+		b->dr_read = (r->SR & SPI_SR_OVR) != 0U;
+	}else if(off == offsetof(SPI_TypeDef, SR)){
+		if(b->dr_read){
+			r->SR &= ~SPI_SR_OVR;
+		}
+		b->dr_read = 0;
+	}
+	spi_update(b);
+}
+
+/**
+ * void spi_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief DR to the shift register or the TX buffer, SR read only but CRCERR, SPE off stops
+ */
+static void spi_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	sim_spi_t *b = ctx;
+	SPI_TypeDef *r = SIM_VIEW(b->regs);
+
+	switch(off){
+	case offsetof(SPI_TypeDef, DR):
+		r->DR = b->rx;
+		if(!(r->CR1 & SPI_CR1_SPE) || !(r->CR1 & SPI_CR1_MSTR)){
+			break;
+		}
+		if(!b->shifting){
+			frame_start(b, (uint16_t)val);
+		}else{
+			b->txbuf = (uint16_t)val;
+			b->txfull = 1;
+			r->SR &= ~SPI_SR_TXE;
+		}
+		break;
+	case offsetof(SPI_TypeDef, SR):
+		r->SR = old & (val | ~SPI_SR_CRCERR);
+		break;
+	case offsetof(SPI_TypeDef, CR1):
+		if(!(val & SPI_CR1_SPE) && (old & SPI_CR1_SPE)){
+			sim_event_cancel(&b->ev);
+			b->shifting = 0;
+			b->txfull = 0;
+			r->SR = (r->SR & ~SPI_SR_BSY) | SPI_SR_TXE;
+		}
+		break;
+	default:
+		break;
+	}
+	spi_update(b);
+}
+
+/**
+ * void sim_spi_attach(SPI_TypeDef *spi, sim_spi_xfer_t fn, void *ctx)
+ * @brief the slave of a bus: fn gets every frame sent and returns the frame received
+ */
+void sim_spi_attach(SPI_TypeDef *spi, sim_spi_xfer_t fn, void *ctx){
+	sim_spi_t *b = bus_of(spi);
+
+	b->fn = fn;
+	b->ctx = ctx;
+}
+
+/**
+ * void sim_spi_init(void)
+ * @brief every bus idle (TXE set), no slave, the hooks
+ */
+void sim_spi_init(void){
+	for(int i = 0; i < SIM_SPI_BUSES; i++){
+		sim_spi_t *b = &buses[i];
+
+		b->fn = 0;
+		b->ctx = 0;
+		b->shifting = 0;
+		b->txfull = 0;
+		b->rx = 0;
+		b->dr_read = 0;
+		sim_event_init(&b->ev, frame_end, b);
+		SIM_VIEW(b->regs)->SR = SPI_SR_TXE;
+		SIM_VIEW(b->regs)->CRCPR = 0x0007U;
+		sim_hook((uintptr_t)b->regs, 0x400, spi_read, spi_write, b);
+	}
+}
@@ -0,0 +1,177 @@
+/**
+ * sim_tim.c
+ *	@brief simulator model of the time base of TIM1..TIM5 and TIM9..TIM11
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Up counting only. CNT is worked out when it is read, from the time the
+ * counter was last set and the prescaler in use (the PSC preload takes
+ * effect at UG and at every update, as on the target). At ARR the counter
+ * wraps: UIF, the update interrupt with UIE, CEN cleared with OPM. UG
+ * restarts the counter and sets UIF unless URS. SR is write 0 to clear.
+ * Capture/compare, the slave controller, down and centre aligned counting,
+ * the repetition counter and ARPE (ARR acts at once) are not modelled.
+ */
+
+#include <stddef.h>
+#include "sim.h"
+
+#define SIM_TIMS				(8)
+
+typedef struct {
+	TIM_TypeDef *regs;
+	int apb;
+	IRQn_Type irq;
+	uint32_t source;			// TIM1 and TIM10 share TIM1_UP_TIM10
+	uint32_t psc;				// prescaler in use
+	uint32_t cnt0;				// CNT at t0
+	uint64_t t0;
+	sim_event_t ev;
+} sim_tim_t;
+
+static sim_tim_t tims[SIM_TIMS] = {
+	{ TIM1, 2, TIM1_UP_TIM10_IRQn, 0 },
+	{ TIM2, 1, TIM2_IRQn, 0 },
+	{ TIM3, 1, TIM3_IRQn, 0 },
+	{ TIM4, 1, TIM4_IRQn, 0 },
+	{ TIM5, 1, TIM5_IRQn, 0 },
+	{ TIM9, 2, TIM1_BRK_TIM9_IRQn, 0 },
+	{ TIM10, 2, TIM1_UP_TIM10_IRQn, 1 },
+	{ TIM11, 2, TIM1_TRG_COM_TIM11_IRQn, 0 },
+};
+
+static uint64_t tick_ns_x1000(sim_tim_t *t){
+	return ((uint64_t)t->psc + 1U) * 1000000000000ULL / sim_timclk(t->apb);
+}
+
+/**
+ * uint32_t tim_count(sim_tim_t *t)
+ * @brief CNT now
+ */
+static uint32_t tim_count(sim_tim_t *t){
+	TIM_TypeDef *r = SIM_VIEW(t->regs);
+
+	if(!(r->CR1 & TIM_CR1_CEN)){
+		return t->cnt0;
+	}
+	return t->cnt0 + (uint32_t)((sim_now - t->t0) * 1000U / tick_ns_x1000(t));
+}
+
+/**
+ * void tim_schedule(sim_tim_t *t)
+ * @brief the next update event, when the counter passes ARR
+ */
+static void tim_schedule(sim_tim_t *t){
+	TIM_TypeDef *r = SIM_VIEW(t->regs);
+	uint64_t ticks;
+
+	if(!(r->CR1 & TIM_CR1_CEN)){
+		sim_event_cancel(&t->ev);
+		return;
+	}
+	ticks = (t->cnt0 <= r->ARR) ? (uint64_t)r->ARR + 1U - t->cnt0 : 1U;
+	sim_event_at(&t->ev, t->t0 + (ticks * tick_ns_x1000(t) + 999U) / 1000U);
+}
+
+static void tim_irq(sim_tim_t *t){
+	TIM_TypeDef *r = SIM_VIEW(t->regs);
+
+	sim_irq_line(t->irq, t->source, (r->SR & TIM_SR_UIF) && (r->DIER & TIM_DIER_UIE));
+}
+
+/**
+ * void tim_restart(sim_tim_t *t, uint32_t cnt)
+ * @brief the counter is set to cnt now
+ */
+static void tim_restart(sim_tim_t *t, uint32_t cnt){
+	t->cnt0 = cnt;
+	t->t0 = sim_now;
+	SIM_VIEW(t->regs)->CNT = cnt;
+	tim_schedule(t);
+}
+
+/**
+ * void tim_update(void *ctx)
+ * @brief the counter wraps: UIF, the new prescaler, one pulse mode stops
+ */
+static void tim_update(void *ctx){
+	sim_tim_t *t = ctx;
+	TIM_TypeDef *r = SIM_VIEW(t->regs);
+
+	r->SR |= TIM_SR_UIF;
+	t->psc = r->PSC & 0xFFFFU;
+	if(r->CR1 & TIM_CR1_OPM){
+		r->CR1 &= ~TIM_CR1_CEN;
+	}
+	tim_restart(t, 0);
+	tim_irq(t);
+}
+
+static void tim_read(void *ctx, uint32_t off, int after){
+	sim_tim_t *t = ctx;
+
+	if(off == offsetof(TIM_TypeDef, CNT) && !after){
+		SIM_VIEW(t->regs)->CNT = tim_count(t);
+	}
+}
+
+/**
+ * void tim_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief CEN, UG, CNT, ARR, SR (rc_w0), DIER
+ */
+static void tim_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	sim_tim_t *t = ctx;
+	TIM_TypeDef *r = SIM_VIEW(t->regs);
+
+	switch(off){
+	case offsetof(TIM_TypeDef, CR1):
+		if((val ^ old) & TIM_CR1_CEN){
+			/* the count freezes (or starts) here */
+			r->CR1 = old;
+			t->cnt0 = tim_count(t);
+			r->CR1 = val;
+			tim_restart(t, t->cnt0);
+		}
+		break;
+	case offsetof(TIM_TypeDef, EGR):
+		r->EGR = 0;
+		if(val & TIM_EGR_UG){
+			t->psc = r->PSC & 0xFFFFU;
+			if(!(r->CR1 & TIM_CR1_URS)){
+				r->SR |= TIM_SR_UIF;
+			}
+			tim_restart(t, 0);
+		}
+		break;
+	case offsetof(TIM_TypeDef, CNT):
+		tim_restart(t, val);
+		break;
+	case offsetof(TIM_TypeDef, ARR):
+		t->cnt0 = tim_count(t);
+		tim_restart(t, t->cnt0);
+		break;
+	case offsetof(TIM_TypeDef, SR):
+		r->SR = old & val;
+		break;
+	default:
+		break;
+	}
+	tim_irq(t);
+}
+
+/**
+ * void sim_tim_init(void)
+ * @brief every timer stopped, ARR at its reset value, the hooks
+ */
+void sim_tim_init(void){
+	for(int i = 0; i < SIM_TIMS; i++){
+		sim_tim_t *t = &tims[i];
+
+		t->psc = 0;
+		t->cnt0 = 0;
+		t->t0 = 0;
+		sim_event_init(&t->ev, tim_update, t);
+		SIM_VIEW(t->regs)->ARR = (t->regs == TIM2 || t->regs == TIM5) ? 0xFFFFFFFFU : 0xFFFFU;
+		sim_hook((uintptr_t)t->regs, 0x400, tim_read, tim_write, t);
+	}
+}
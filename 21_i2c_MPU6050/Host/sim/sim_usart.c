@@ -0,0 +1,302 @@
+/**
+ * sim_usart.c
+ *	@brief simulator model of USART1, USART2 and USART6
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * A frame is start, 8 or 9 (M) data bits and the stop bits (CR2 STOP: 1
+ * or 2), at PCLK / USARTDIV from BRR (OVER8 too). TX: DR written with the
+ * shift register empty starts a frame at once, TXE stays set and TC
+ * clears; written during a frame it waits (TXE clear) and follows without
+ * a gap. The sink gets every frame at its end; TC sets when nothing
+ * follows. RX: bytes given to sim_usart_inject() arrive back to back, one
+ * per frame: into DR with RXNE, or lost with ORE if RXNE is still set.
+ * IDLE sets one frame after the last byte. RXNE clears by a DR read,
+ * IDLE and ORE by an SR read then a DR read, TC (and RXNE) by writing 0.
+ * The interrupt line is TXEIE/TCIE/RXNEIE(RXNE, ORE)/IDLEIE with their
+ * flags, the DMA requests DMAT with TXE and DMAR with RXNE. Parity, LIN,
+ * smartcard, IrDA, hardware flow control and the noise/framing errors are
+ * not modelled.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "sim.h"
+
+#define SIM_USARTS				(3)
+#define SIM_USART_RXQ			(1024U)		// bytes injected, not yet on the wire
+#define USART_SR_RC_W0			(USART_SR_CTS | USART_SR_LBD | USART_SR_TC | USART_SR_RXNE)
+
+/* a request line: the streams that can serve it, on one channel */
+typedef struct {
+	DMA_TypeDef *dma;
+	uint8_t streams;
+	uint8_t channel;
+} sim_usart_dreq_t;
+
+typedef struct {
+	USART_TypeDef *regs;
+	int apb;
+	IRQn_Type irq;
+	sim_usart_dreq_t tx, rx;
+	sim_usart_sink_t sink;
+	void *ctx;
+	sim_event_t tx_ev, rx_ev;
+	int shifting;
+	uint16_t shift;				// TX frame on the wire
+	uint16_t tdr;
+	int tdr_full;
+	uint16_t rdr;				// what DR reads
+	int sr_read;				// first half of the IDLE / ORE clearing sequence
+	int idle_armed;				// rx_ev is the idle line detection
+	uint8_t rxq[SIM_USART_RXQ];
+	uint32_t rxq_head, rxq_tail;
+} sim_usart_t;
+
+static sim_usart_t ports[SIM_USARTS] = {
+	{ USART1, 2, USART1_IRQn, { DMA2, 0x80, 4 }, { DMA2, 0x24, 4 } },
+	{ USART2, 1, USART2_IRQn, { DMA1, 0x40, 4 }, { DMA1, 0x20, 4 } },
+	{ USART6, 2, USART6_IRQn, { DMA2, 0xC0, 5 }, { DMA2, 0x06, 5 } },
+};
+
+static sim_usart_t *port_of(USART_TypeDef *usart){
+	for(int i = 0; i < SIM_USARTS; i++){
+		if(ports[i].regs == usart){
+			return &ports[i];
+		}
+	}
+	return 0;
+}
+
+/**
+ * void usart_update(sim_usart_t *u)
+ * @brief the interrupt line and the DMA requests from the flags
+ */
+static void usart_update(sim_usart_t *u){
+	USART_TypeDef *r = SIM_VIEW(u->regs);
+	uint32_t sr = r->SR;
+	uint32_t cr1 = r->CR1;
+	uint32_t cr3 = r->CR3;
+	int on = (cr1 & USART_CR1_UE) != 0U;
+	int irq = ((cr1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE)) || ((cr1 & USART_CR1_TCIE) && (sr & USART_SR_TC))
+			|| ((cr1 & USART_CR1_RXNEIE) && (sr & (USART_SR_RXNE | USART_SR_ORE)))
+			|| ((cr1 & USART_CR1_IDLEIE) && (sr & USART_SR_IDLE));
+
+	sim_irq_line(u->irq, 0, on && irq);
+	sim_dma_dreq(u->tx.dma, u->tx.streams, u->tx.channel,
+			on && (cr1 & USART_CR1_TE) && (cr3 & USART_CR3_DMAT) && (sr & USART_SR_TXE));
+	sim_dma_dreq(u->rx.dma, u->rx.streams, u->rx.channel, on && (cr3 & USART_CR3_DMAR) && (sr & USART_SR_RXNE));
+}
+
+/**
+ * uint64_t frame_ns(sim_usart_t *u)
+ * @brief one frame: start bit, 8 or 9 data bits, 1 or 2 stop bits
+ */
+static uint64_t frame_ns(sim_usart_t *u){
+	USART_TypeDef *r = SIM_VIEW(u->regs);
+	uint32_t brr = r->BRR;
+	uint32_t bits = 1U + ((r->CR1 & USART_CR1_M) ? 9U : 8U) + ((r->CR2 & USART_CR2_STOP_1) ? 2U : 1U);
+	uint32_t div;
+
+	/* baud = PCLK / div: 16 * USARTDIV, or 8 * USARTDIV with OVER8 (3 fraction bits) */
+	if(r->CR1 & USART_CR1_OVER8){
+		div = ((brr >> 4) << 3) + (brr & 7U);
+	}else{
+		div = brr & 0xFFFFU;
+	}
+	if(div == 0U){
+		div = 16U;
+	}
+	return sim_cycles_ns((uint64_t)bits * div, sim_pclk(u->apb));
+}
+
+static void tx_start(sim_usart_t *u, uint16_t data){
+	USART_TypeDef *r = SIM_VIEW(u->regs);
+
+	u->shift = data;
+	u->shifting = 1;
+	r->SR = (r->SR | USART_SR_TXE) & ~USART_SR_TC;
+	sim_event_at(&u->tx_ev, sim_now + frame_ns(u));
+}
+
+/**
+ * void tx_end(void *ctx)
+ * @brief a frame is out: to the sink, then the next one or TC
+ */
+static void tx_end(void *ctx){
+	sim_usart_t *u = ctx;
+	USART_TypeDef *r = SIM_VIEW(u->regs);
+	uint16_t mask = (r->CR1 & USART_CR1_M) ? 0x1FFU : 0xFFU;
+
+	if(u->sink){
+		u->sink(u->ctx, u->shift & mask);
+	}
+	if(u->tdr_full){
+		u->tdr_full = 0;
+		tx_start(u, u->tdr);
+	}else{
+		u->shifting = 0;
+		r->SR |= USART_SR_TC;
+	}
+	usart_update(u);
+}
+
+static int rx_on(sim_usart_t *u){
+	uint32_t cr1 = SIM_VIEW(u->regs)->CR1;
+
+	return (cr1 & USART_CR1_UE) && (cr1 & USART_CR1_RE);
+}
+
+/**
+ * void rx_end(void *ctx)
+ * @brief a frame is in (RXNE or ORE) and the next starts, or the line went idle
+ */
+static void rx_end(void *ctx){
+	sim_usart_t *u = ctx;
+	USART_TypeDef *r = SIM_VIEW(u->regs);
+
+	if(u->idle_armed){
+		u->idle_armed = 0;
+		r->SR |= USART_SR_IDLE;
+		usart_update(u);
+		return;
+	}
+	if(u->rxq_head != u->rxq_tail){
+		uint8_t byte = u->rxq[u->rxq_tail++ % SIM_USART_RXQ];
+
+		if(r->SR & USART_SR_RXNE){
+			r->SR |= USART_SR_ORE;
+		}else{
+			u->rdr = byte;
+			r->DR = byte;
+			r->SR |= USART_SR_RXNE;
+		}
+	}
+
+	/* back to back while bytes are waiting, else one idle frame */
+	if(u->rxq_head == u->rxq_tail){
+		u->idle_armed = 1;
+	}
+	sim_event_at(&u->rx_ev, sim_now + frame_ns(u));
+	usart_update(u);
+}
+
+/**
+ * void usart_read(void *ctx, uint32_t off, int after)
+ * @brief SR then DR clears IDLE and ORE, DR clears RXNE
+ */
+static void usart_read(void *ctx, uint32_t off, int after){
+	sim_usart_t *u = ctx;
+	USART_TypeDef *r = SIM_VIEW(u->regs);
+
+	if(!after){
+		return;
+	}
+	if(off == offsetof(USART_TypeDef, SR)){
+		u->sr_read = 1;
+	}else if(off == offsetof(USART_TypeDef, DR)){
+		r->SR &= ~USART_SR_RXNE;
+		if(u->sr_read){
+			r->SR &= ~(USART_SR_IDLE | USART_SR_ORE);
+		}
+		u->sr_read = 0;
+	}
+	usart_update(u);
+}
+
+/**
+ * void usart_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+ * @brief DR to the shift register or TDR, SR rc_w0, RE starts the receiver
+ */
+static void usart_write(void *ctx, uint32_t off, uint32_t old, uint32_t val){
+	sim_usart_t *u = ctx;
+	USART_TypeDef *r = SIM_VIEW(u->regs);
+
+	switch(off){
+	case offsetof(USART_TypeDef, DR):
+		r->DR = u->rdr;
+		if(!(r->CR1 & USART_CR1_UE) || !(r->CR1 & USART_CR1_TE)){
+			break;
+		}
+		if(!u->shifting){
+			tx_start(u, (uint16_t)val);
+		}else{
+			u->tdr = (uint16_t)val;
+			u->tdr_full = 1;
+			r->SR &= ~(USART_SR_TXE | USART_SR_TC);
+		}
+		break;
+	case offsetof(USART_TypeDef, SR):
+		r->SR = old & (val | ~USART_SR_RC_W0);
+		break;
+	case offsetof(USART_TypeDef, CR1):
+		if(!(val & USART_CR1_UE)){
+			sim_event_cancel(&u->tx_ev);
+			u->shifting = 0;
+			u->tdr_full = 0;
+			r->SR |= USART_SR_TXE;
+		}
+		if(rx_on(u) && !u->rx_ev.armed && u->rxq_head != u->rxq_tail){
+			sim_event_at(&u->rx_ev, sim_now + frame_ns(u));
+		}
+		break;
+	default:
+		break;
+	}
+	usart_update(u);
+}
+
+/**
+ * void sim_usart_sink(USART_TypeDef *usart, sim_usart_sink_t fn, void *ctx)
+ * @brief where the transmitted frames go
+ */
+void sim_usart_sink(USART_TypeDef *usart, sim_usart_sink_t fn, void *ctx){
+	sim_usart_t *u = port_of(usart);
+
+	u->sink = fn;
+	u->ctx = ctx;
+}
+
+/**
+ * int sim_usart_inject(USART_TypeDef *usart, const uint8_t *data, uint32_t n)
+ * @brief bytes on RX, after those still queued, back to back
+ * @return the bytes queued (fewer when the queue is full)
+ */
+int sim_usart_inject(USART_TypeDef *usart, const uint8_t *data, uint32_t n){
+	sim_usart_t *u = port_of(usart);
+	uint32_t i;
+
+	for(i = 0; i < n && u->rxq_head - u->rxq_tail < SIM_USART_RXQ; i++){
+		u->rxq[u->rxq_head++ % SIM_USART_RXQ] = data[i];
+	}
+	if(i > 0U && rx_on(u) && (!u->rx_ev.armed || u->idle_armed)){
+		/* a line going idle is not: the next start bit comes first */
+		u->idle_armed = 0;
+		sim_event_at(&u->rx_ev, sim_now + frame_ns(u));
+	}
+	return (int)i;
+}
+
+/**
+ * void sim_usart_init(void)
+ * @brief every port idle (TXE and TC set), no sink, nothing to receive, the hooks
+ */
+void sim_usart_init(void){
+	for(int i = 0; i < SIM_USARTS; i++){
+		sim_usart_t *u = &ports[i];
+
+		u->sink = 0;
+		u->ctx = 0;
+		u->shifting = 0;
+		u->tdr_full = 0;
+		u->rdr = 0;
+		u->sr_read = 0;
+		u->idle_armed = 0;
+		u->rxq_head = 0;
+		u->rxq_tail = 0;
+		sim_event_init(&u->tx_ev, tx_end, u);
+		sim_event_init(&u->rx_ev, rx_end, u);
+		SIM_VIEW(u->regs)->SR = USART_SR_TXE | USART_SR_TC;
+		sim_hook((uintptr_t)u->regs, 0x400, usart_read, usart_write, u);
+	}
+}
@@ -0,0 +1,316 @@
+/**
+ * simcheck.c
+ *	@brief Linux CLI: run the drivers on the register level simulator (sim/)
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory, x86-64 Linux):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -no-pie \
+ *     -DSTM32F411xE -include sim/sim_cmsis.h -Isim -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -o simcheck simcheck.c sim/sim*.c ../Core/Src/i2c.c ../Core/Src/MPU6050.c \
+ *     ../Core/Src/uart.c ../Core/Src/fmt.c ../Core/Src/dwt.c
+ *
+ * Usage:
+ *  simcheck
+ *
+ * i2c.c, MPU6050.c, uart.c and dwt.c are compiled as for the target (with
+ * SIM_HOST, critical sections mask the simulated PRIMASK: atomic.h); every
+ * register access they make goes through the models of sim/, the
+ * interrupt handlers below are entered from the simulated NVIC between
+ * two accesses, and the DWT counter follows the simulated time. A
+ * register file slave at 0x68 stands for the MPU6050.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  i2c read       blocking 14 byte burst: the bytes, and the time on the
+ *                 wire of START .. STOP at 100 kHz (about 1.55 ms)
+ *  i2c write      blocking 3 byte burst lands in the registers
+ *  i2c nack       no slave at 0x69: I2C_ERR_NACK, every attempt recovered,
+ *                 within I2C_WORST_US(1)
+ *  i2c it         interrupt driven read: completion event, bytes, the
+ *                 event handler entered from the simulated NVIC
+ *  mpu init       MPU6050_init against the register file
+ *  uart tx        uart2_write through DMA1 Stream6: the bytes on the line,
+ *                 10 bit times each at 115200
+ *  uart rx        bytes on RX: DMA1 Stream5, IDLE interrupt, one burst
+ *  exti           PC13 falling edge: EXTI15_10 once, none on the rising one
+ *  systick        SysTick_Config(1 ms): 10 interrupts in 10 ms
+ *  tim            TIM2 1 kHz update interrupt, CNT between updates
+ *  priority       a higher priority interrupt preempts a running handler,
+ *                 PRIMASK holds one back until it is cleared
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "sim.h"
+#include "i2c.h"
+#include "MPU6050.h"
+#include "uart.h"
+#include "dwt.h"
+#include "sched.h"
+#include "atomic.h"
+
+#define SLAVE_ADDR7				(0x68)
+#define TASK_TEST				(1)
+#define SIG_I2C					(2)
+#define SIG_RX					(3)
+#define BAUD					(115200U)
+
+static sim_i2c_regs_t mpu;
+static int failed;
+
+/* the last event posted by a driver */
+static volatile int posted;
+static volatile uint16_t posted_arg;
+
+/* what the USART2 line carried */
+static char line[128];
+static uint32_t line_len;
+
+static volatile uint32_t exti_irqs, systick_irqs, tim_irqs;
+static volatile uint32_t low_irqs, high_irqs, high_in_low;
+
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	posted = sig;
+	posted_arg = arg;
+	return 0;
+}
+
+/* the vectors of stm32f4xx_it.c that the checks need */
+void I2C1_EV_IRQHandler(void){
+	i2c_ev_handler(&i2c1);
+}
+
+void I2C1_ER_IRQHandler(void){
+	i2c_er_handler(&i2c1);
+}
+
+void DMA1_Stream5_IRQHandler(void){
+	uart2_rx_dma_irq_handler();
+}
+
+void DMA1_Stream6_IRQHandler(void){
+	uart2_tx_dma_irq_handler();
+}
+
+void USART2_IRQHandler(void){
+	uart2_irq_handler();
+}
+
+void EXTI15_10_IRQHandler(void){
+	EXTI->PR = EXTI_PR_PR13;
+	exti_irqs++;
+}
+
+void SysTick_Handler(void){
+	systick_irqs++;
+}
+
+void TIM2_IRQHandler(void){
+	TIM2->SR = ~(uint32_t)TIM_SR_UIF;
+	tim_irqs++;
+}
+
+/* priority: EXTI0 (low) pends EXTI1 (high) from inside */
+void EXTI1_IRQHandler(void){
+	EXTI->PR = EXTI_PR_PR1;
+	high_irqs++;
+}
+
+void EXTI0_IRQHandler(void){
+	uint32_t before;
+
+	EXTI->PR = EXTI_PR_PR0;
+	low_irqs++;
+	before = high_irqs;
+	EXTI->SWIER = EXTI_SWIER_SWIER1;
+	high_in_low = (high_irqs == before + 1U);
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+static void sink(void *ctx, uint16_t data){
+	if(line_len < sizeof(line)){
+		line[line_len++] = (char)data;
+	}
+}
+
+/**
+ * int wait_posted(uint64_t ns)
+ * @brief sleep (__WFI) until a driver posts an event, ns at most
+ */
+static int wait_posted(uint64_t ns){
+	uint64_t end = sim_now + ns;
+
+	while(!posted && sim_now < end){
+		__WFI();
+	}
+	return posted;
+}
+
+int main(void){
+	char buf[16];
+	uint64_t t0;
+	int ok;
+
+	sim_init();
+	dwt_init();
+	sim_i2c_regs_init(&mpu, SLAVE_ADDR7);
+	for(int i = 0; i < 14; i++){
+		mpu.regs[ACCEL_XOUT_H_REG + i] = (uint8_t)(0xA0 + i);
+	}
+	mpu.regs[WHO_AM_I_R] = MPU6050_WHO_AM_I;
+	mpu.regs[PWR_MGMT_1_R] = 0x40;
+	sim_i2c_attach(I2C1, &mpu.dev);
+	i2c_init(&i2c1);
+
+	/*i2c read*/
+	memset(buf, 0, sizeof(buf));
+	t0 = sim_now;
+	ok = i2c_burst_read(&i2c1, MPU6050_ADDR_AD0_LOW, ACCEL_XOUT_H_REG, 14, buf) == I2C_OK;
+	printf("  14 bytes: %.1f us, %lu register accesses, %u starts, %u bytes\n", (sim_now - t0) / 1e3,
+			(unsigned long)sim_stats.accesses, sim_i2c_stats(I2C1)->starts, sim_i2c_stats(I2C1)->bytes);
+	for(int i = 0; i < 14; i++){
+		ok &= (uint8_t)buf[i] == (uint8_t)(0xA0 + i);
+	}
+	sim_run(10000U);
+	check("i2c read", ok && sim_now - t0 > 1500000U && sim_now - t0 < 1700000U
+			&& !(SIM_VIEW(I2C1)->SR2 & I2C_SR2_BUSY));
+
+	/*i2c write*/
+	buf[0] = 1;
+	buf[1] = 2;
+	buf[2] = 3;
+	ok = i2c_burst_write(&i2c1, MPU6050_ADDR_AD0_LOW, 0x19, 3, buf) == I2C_OK;
+	check("i2c write", ok && mpu.regs[0x19] == 1 && mpu.regs[0x1A] == 2 && mpu.regs[0x1B] == 3
+			&& mpu.writes == 1);
+
+	/*i2c nack*/
+	t0 = sim_now;
+	ok = i2c_burst_read(&i2c1, (char)((SLAVE_ADDR7 + 1) << 1), ACCEL_XOUT_H_REG, 1, buf) == I2C_ERR_NACK;
+	printf("  nack: %.1f us, %lu recoveries (bound %u us)\n", (sim_now - t0) / 1e3,
+			(unsigned long)i2c1.stats.recoveries, (unsigned)I2C_WORST_US(1));
+	check("i2c nack", ok && i2c1.stats.recoveries == I2C_RETRIES + 1U
+			&& sim_now - t0 < I2C_WORST_US(1) * 1000ULL
+			&& i2c_burst_read(&i2c1, MPU6050_ADDR_AD0_LOW, WHO_AM_I_R, 1, buf) == I2C_OK
+			&& (uint8_t)buf[0] == MPU6050_WHO_AM_I);
+
+	/*i2c it*/
+	memset(buf, 0, sizeof(buf));
+	posted = 0;
+	t0 = sim_stats.irqs;
+	ok = i2c_burst_read_it(&i2c1, MPU6050_ADDR_AD0_LOW, ACCEL_XOUT_H_REG, 14, buf, TASK_TEST, SIG_I2C) == 0;
+	ok &= wait_posted(10000000U) == SIG_I2C && posted_arg == 14;
+	for(int i = 0; i < 14; i++){
+		ok &= (uint8_t)buf[i] == (uint8_t)(0xA0 + i);
+	}
+	printf("  it: %lu handler entries\n", (unsigned long)(sim_stats.irqs - t0));
+	check("i2c it", ok && sim_stats.irqs - t0 >= 14U && !i2c_busy(&i2c1));
+
+	/*mpu init*/
+	{
+		mpu6050_t dev = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+
+		ok = MPU6050_init(&dev) == 0;
+		check("mpu init", ok && dev.present && mpu.regs[PWR_MGMT_1_R] == 0 && dev.dirty == 0);
+	}
+
+	/*uart tx*/
+	sim_usart_sink(USART2, sink, 0);
+	uart2_init(BAUD);
+	t0 = sim_now;
+	uart2_write("hello, sim\n", 11);
+	while(!uart2_tx_idle()){
+		__WFI();
+	}
+	printf("  tx: %u bytes in %.1f us\n", (unsigned)line_len, (sim_now - t0) / 1e3);
+	check("uart tx", line_len == 11 && memcmp(line, "hello, sim\n", 11) == 0
+			&& sim_now - t0 >= 11U * 10U * 1000000000ULL / BAUD && sim_now - t0 < 12U * 10U * 1000000000ULL / BAUD
+			&& uart_tx_stats.sent == 11 && uart_tx_stats.dma_chunks == 1);
+
+	/*uart rx*/
+	{
+		const uint8_t *p;
+		uint32_t n = 0;
+		int end = 0;
+
+		posted = 0;
+		uart2_rx_notify(TASK_TEST, SIG_RX);
+		sim_usart_inject(USART2, (const uint8_t *)"ping pong", 9);
+		ok = wait_posted(10000000U) == SIG_RX && posted_arg == 9;
+		p = uart2_rx_peek(&n, &end);
+		ok &= p != 0 && n == 9 && end && memcmp(p, "ping pong", 9) == 0;
+		uart2_rx_release();
+		check("uart rx", ok && uart_rx_stats.bytes == 9 && uart_rx_stats.frames == 1
+				&& uart_rx_stats.line_errors == 0);
+	}
+
+	/*exti*/
+	RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+	SYSCFG->EXTICR[3] = (SYSCFG->EXTICR[3] & ~SYSCFG_EXTICR4_EXTI13) | SYSCFG_EXTICR4_EXTI13_PC;
+	EXTI->FTSR |= EXTI_FTSR_TR13;
+	EXTI->IMR |= EXTI_IMR_MR13;
+	NVIC_EnableIRQ(EXTI15_10_IRQn);
+	sim_gpio_input(GPIOC, 13, 1);
+	sim_run(1000);
+	sim_gpio_input(GPIOC, 13, 0);
+	sim_run(1000);
+	ok = exti_irqs == 1;
+	sim_gpio_input(GPIOC, 13, 1);
+	sim_run(1000);
+	check("exti", ok && exti_irqs == 1 && !(SIM_VIEW(EXTI)->PR & EXTI_PR_PR13));
+
+	/*systick*/
+	SysTick_Config(16000U);
+	sim_run(10000000U + 1000U);
+	SysTick->CTRL = 0;
+	printf("  systick: %u interrupts\n", (unsigned)systick_irqs);
+	check("systick", systick_irqs == 10);
+
+	/*tim*/
+	{
+		uint32_t cnt;
+
+		RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+		TIM2->PSC = 15;
+		TIM2->ARR = 999;
+		TIM2->EGR = TIM_EGR_UG;
+		TIM2->SR = 0;
+		TIM2->DIER = TIM_DIER_UIE;
+		NVIC_EnableIRQ(TIM2_IRQn);
+		TIM2->CR1 = TIM_CR1_CEN;
+		sim_run(5000000U + 250000U);
+		cnt = TIM2->CNT;
+		TIM2->CR1 = 0;
+		printf("  tim: %u updates, CNT %u\n", (unsigned)tim_irqs, (unsigned)cnt);
+		check("tim", tim_irqs == 5 && cnt >= 249 && cnt <= 251);
+	}
+
+	/*priority*/
+	{
+		uint32_t pm;
+
+		NVIC_SetPriority(EXTI0_IRQn, 3);
+		NVIC_SetPriority(EXTI1_IRQn, 1);
+		EXTI->IMR |= EXTI_IMR_MR0 | EXTI_IMR_MR1;
+		NVIC_EnableIRQ(EXTI0_IRQn);
+		NVIC_EnableIRQ(EXTI1_IRQn);
+		EXTI->SWIER = EXTI_SWIER_SWIER0;
+		ok = low_irqs == 1 && high_irqs == 1 && high_in_low;
+
+		pm = critical_enter();
+		EXTI->SWIER = EXTI_SWIER_SWIER1;
+		ok &= high_irqs == 1;
+		critical_exit(pm);
+		check("priority", ok && high_irqs == 2 && sim_stats.nest_max >= 2);
+	}
+
+	printf("%.3f ms simulated, %lu register accesses, %lu interrupts\n", sim_now / 1e6,
+			(unsigned long)sim_stats.accesses, (unsigned long)sim_stats.irqs);
+	return failed;
+}
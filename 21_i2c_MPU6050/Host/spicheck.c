@@ -0,0 +1,169 @@
+/**
+ * spicheck.c
+ *	@brief Linux CLI: run the SPI driver of 22_SPI_RFID on the simulator (sim/) with an MFRC522
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory, x86-64 Linux):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -no-pie \
+ *     -DSTM32F411xE -include sim/sim_cmsis.h -Isim -I../../22_SPI_RFID/Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -Wno-unused-but-set-variable -o spicheck spicheck.c sim/sim*.c ../../22_SPI_RFID/Core/Src/spi.c
+ *
+ * Usage:
+ *  spicheck
+ *
+ * The MFRC522 is the SPI side of its register interface (datasheet 8.1.2):
+ * the first byte after chip select (PA9 low) is an address, bit 7 set to
+ * read; a read returns the register named by the previous byte for every
+ * byte that follows, a write puts every byte that follows into the
+ * register. VersionReg (0x37) reads 0x92, version 2.0.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  version        VersionReg through spi1_transmit + spi1_receive
+ *  write          CommandReg through spi1_transmit, BSY waited for
+ *  no cs          chip select high: the MFRC522 does not answer
+ *  it             spi1_transfer_IT: two frames, the SPI1 interrupt per
+ *                 byte, the completion event, 8 SCK at PCLK / 4 per frame
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "sim.h"
+#include "spi.h"
+#include "sched.h"
+
+#define MFRC522_REGS			(64)
+#define COMMAND_REG				(0x01)
+#define VERSION_REG				(0x37)
+#define MFRC522_VERSION_2_0		(0x92)
+#define MFRC522_READ(reg)		((uint8_t)(0x80U | ((reg) << 1)))
+#define MFRC522_WRITE(reg)		((uint8_t)((reg) << 1))
+#define CS_PIN					(9)
+#define TASK_TEST				(1)
+#define SIG_SPI					(2)
+
+typedef struct {
+	uint8_t regs[MFRC522_REGS];
+	int first;						// next byte is an address
+	int rd;
+	uint8_t reg;
+	uint32_t frames;
+} mfrc522_t;
+
+static mfrc522_t card;
+static int failed;
+static volatile int posted;
+static volatile uint16_t posted_arg;
+
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	posted = sig;
+	posted_arg = arg;
+	return 0;
+}
+
+void SPI1_IRQHandler(void){
+	spi1_irq_handler();
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * uint8_t mfrc522_xfer(void *ctx, uint8_t mosi)
+ * @brief one frame on the bus: address byte, then register data
+ */
+static uint8_t mfrc522_xfer(void *ctx, uint8_t mosi){
+	mfrc522_t *c = ctx;
+	uint8_t miso = 0;
+
+	if(sim_gpio_level(GPIOA, CS_PIN)){
+		return 0xFF;
+	}
+	c->frames++;
+	if(c->first){
+		c->first = 0;
+		c->rd = (mosi & 0x80U) != 0U;
+		c->reg = (mosi >> 1) & 0x3FU;
+		return 0;
+	}
+	if(c->rd){
+		/* the register named by the previous byte, the next one named by this byte */
+		miso = c->regs[c->reg];
+		c->reg = (mosi >> 1) & 0x3FU;
+	}else{
+		c->regs[c->reg] = mosi;
+	}
+	return miso;
+}
+
+/* chip select going high ends the transaction */
+static void mfrc522_cs(void *ctx, GPIO_TypeDef *port, uint16_t levels, uint16_t changed){
+	mfrc522_t *c = ctx;
+
+	if(changed & (1U << CS_PIN)){
+		c->first = 1;
+	}
+}
+
+int main(void){
+	uint8_t tx[2], rx[2];
+	uint64_t t0;
+	int ok;
+
+	sim_init();
+	memset(&card, 0, sizeof(card));
+	card.first = 1;
+	card.regs[VERSION_REG] = MFRC522_VERSION_2_0;
+	sim_spi_attach(SPI1, mfrc522_xfer, &card);
+	sim_gpio_watch(GPIOA, mfrc522_cs, &card);
+
+	spi1_gpio_init();
+	spi1_config();
+	cs_disable();
+
+	/*version*/
+	cs_enable();
+	tx[0] = MFRC522_READ(VERSION_REG);
+	spi1_transmit(tx, 1);
+	spi1_receive(rx, 1);
+	cs_disable();
+	printf("  VersionReg 0x%02X\n", rx[0]);
+	check("version", rx[0] == MFRC522_VERSION_2_0 && card.frames == 2);
+
+	/*write*/
+	cs_enable();
+	tx[0] = MFRC522_WRITE(COMMAND_REG);
+	tx[1] = 0x0C;
+	spi1_transmit(tx, 2);
+	ok = !(SIM_VIEW(SPI1)->SR & SPI_SR_BSY);
+	cs_disable();
+	check("write", ok && card.regs[COMMAND_REG] == 0x0C);
+
+	/*no cs*/
+	rx[0] = 0;
+	spi1_receive(rx, 1);
+	check("no cs", rx[0] == 0xFF && card.frames == 4);
+
+	/*it*/
+	memset(rx, 0, sizeof(rx));
+	posted = 0;
+	cs_enable();
+	tx[0] = MFRC522_READ(VERSION_REG);
+	tx[1] = 0;
+	t0 = sim_now;
+	ok = spi1_transfer_IT(tx, rx, 2, TASK_TEST, SIG_SPI) == 0;
+	while(!posted && sim_now - t0 < 1000000U){
+		__WFI();
+	}
+	cs_disable();
+	printf("  it: %.2f us, %lu interrupts\n", (sim_now - t0) / 1e3, (unsigned long)sim_stats.irqs);
+	check("it", ok && posted == SIG_SPI && posted_arg == 2 && rx[1] == MFRC522_VERSION_2_0
+			&& sim_now - t0 >= 2U * sim_cycles_ns(8U * 4U, 16000000U) && sim_stats.irqs == 2);
+
+	return failed;
+}
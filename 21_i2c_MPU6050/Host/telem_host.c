@@ -0,0 +1,91 @@
+/**
+ * telem_host.c
+ *	@brief source file for the host side telemetry stream decoder
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ */
+
+#include <string.h>
+#include "telem_host.h"
+
+/**
+ * void telem_decoder_init(telem_decoder_t *d)
+ * @brief reset the decoder and its statistics
+ */
+void telem_decoder_init(telem_decoder_t *d){
+	memset(d, 0, sizeof(*d));
+}
+
+/**
+ * void telem_decoder_frame(telem_decoder_t *d, telem_msg_cb_t cb, void *ctx)
+ * @brief decode the frame collected in d->buf and account for it
+ * @step followed:
+ *
+ * 1. Skip empty frames (back to back delimiters) and count overlong ones
+ * 2. Decode and check the CRC
+ * 3. Compare seq with the previous frame to count lost frames
+ * 4. Hand the message to the callback
+ */
+static void telem_decoder_frame(telem_decoder_t *d, telem_msg_cb_t cb, void *ctx){
+	telem_msg_t msg;
+	uint16_t missing;
+	int r;
+
+	/*1. Skip empty frames and count overlong ones*/
+	if(d->overlong){
+		d->malformed++;
+		return;
+	}
+	if(d->used == 0){
+		return;
+	}
+
+	/*2. Decode and check the CRC*/
+	r = telem_decode(d->buf, d->used, &msg);
+	if(r == -2){
+		d->crc_errors++;
+		return;
+	}
+	if(r != 0){
+		d->malformed++;
+		return;
+	}
+	d->frames++;
+
+	/*3. Compare seq with the previous frame to count lost frames*/
+	if(d->have_seq){
+		missing = (uint16_t)(msg.seq - d->last_seq - 1U);
+		if(missing){
+			d->gaps++;
+			d->lost += missing;
+		}
+	}
+	d->last_seq = msg.seq;
+	d->have_seq = 1;
+
+	/*4. Hand the message to the callback*/
+	if(cb){
+		cb(&msg, ctx);
+	}
+}
+
+/**
+ * void telem_decoder_feed(telem_decoder_t *d, const uint8_t *data, size_t len, telem_msg_cb_t cb, void *ctx)
+ * @brief feed len stream bytes; cb(msg, ctx) is called for every good frame
+ */
+void telem_decoder_feed(telem_decoder_t *d, const uint8_t *data, size_t len, telem_msg_cb_t cb, void *ctx){
+	d->bytes += len;
+	while(len--){
+		uint8_t b = *data++;
+
+		if(b == COBS_DELIMITER){
+			telem_decoder_frame(d, cb, ctx);
+			d->used = 0;
+			d->overlong = 0;
+		}else if(d->used < sizeof(d->buf)){
+			d->buf[d->used++] = b;
+		}else{
+			d->overlong = 1;
+		}
+	}
+}
@@ -0,0 +1,41 @@
+/**
+ * telem_host.h
+ *	@brief header file for the host side telemetry stream decoder
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Feeds arbitrary pieces of the USART2 byte stream, splits it on the COBS
+ * delimiter, decodes and checks every frame (telemetry.c) and keeps link
+ * statistics. Corrupted or truncated frames are counted and skipped; the
+ * decoder resynchronises at the next 0x00.
+ */
+
+#ifndef HOST_TELEM_HOST_H_
+#define HOST_TELEM_HOST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetry.h"
+
+typedef void (*telem_msg_cb_t)(const telem_msg_t *msg, void *ctx);
+
+typedef struct {
+	uint8_t buf[COBS_MAX_ENCODED(TELEM_FRAME_MAX)];
+	uint32_t used;
+	int overlong;				// current frame overflowed buf, discard it
+
+	uint64_t bytes;				// bytes fed
+	uint64_t frames;			// good frames
+	uint64_t crc_errors;
+	uint64_t malformed;			// bad stuffing, bad length or overlong
+	uint64_t gaps;				// seq discontinuities
+	uint64_t lost;				// frames missing according to seq
+
+	uint16_t last_seq;
+	int have_seq;
+} telem_decoder_t;
+
+void telem_decoder_init(telem_decoder_t *d);
+void telem_decoder_feed(telem_decoder_t *d, const uint8_t *data, size_t len, telem_msg_cb_t cb, void *ctx);
+
+#endif /* HOST_TELEM_HOST_H_ */
@@ -0,0 +1,347 @@
+/**
+ * telemcat.c
+ *	@brief Linux CLI: decode the board's telemetry stream and report link statistics
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -I../Core/Inc -I. -o telemcat telemcat.c telem_host.c \
+ *     ../Core/Src/telemetry.c ../Core/Src/cobs.c ../Core/Src/crc.c ../Core/Src/compress.c
+ *
+ * Usage:
+ *  telemcat [-b baud] [-v] [-i seconds] /dev/ttyACM0	decode a serial port
+ *  telemcat [-v] -								decode stdin (e.g. a capture file)
+ *  telemcat -g frames [-e n] [-d n]			write a synthetic stream to stdout,
+ *												corrupting every n-th frame (-e)
+ *												and leaving out every n-th frame (-d)
+ *
+ * Round trip through the same encoder the firmware uses:
+ *  ./telemcat -g 100000 -e 997 -d 500 | ./telemcat -
+ * leaves out 200 frames and corrupts 100, and reports 99700 good frames,
+ * 100 bad ones (CRC error or malformed, depending on the byte hit) and 299
+ * lost (the very last frame is left out, which no later seq can reveal).
+ *
+ * Every interval it prints frames/s, bytes/s, CRC errors, malformed frames
+ * and lost frames (sequence gaps); a summary follows at end of input.
+ * With -v every sample is printed as "type seq stamp v0 v1 ..."; packed
+ * IMU blocks are decompressed and printed one line per sample (type 2,
+ * the stamp of the block).
+ * Stack reports (TELEM_TYPE_STACK, once a second) are printed on stderr,
+ * and so is the boot stage breakdown (TELEM_TYPE_BOOT, once after reset,
+ * again on the "boot" command): time since reset and time spent in each
+ * stage, microseconds. So is the IMU bus report (TELEM_TYPE_BUS, once a
+ * second): rounds, overruns, load and efficiency, and how long after the
+ * tick each device's read completed at worst. Replies to commands
+ * (TELEM_TYPE_REPLY) are printed on stderr as "reply <text>".
+ * The first frame after attaching mid-stream is usually cut and shows up
+ * as one malformed or CRC error.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "telem_host.h"
+#include "compress.h"
+#include "boot.h"
+
+#define READ_CHUNK				(4096)
+#define GEN_PERIOD_US			(4000)		// matches IMU_PERIOD_MS
+
+static int verbose;
+static comp_decoder_t unpack;
+
+/**
+ * speed_t baud_flag(long baud)
+ * @brief termios constant for baud, 0 if unsupported
+ */
+static speed_t baud_flag(long baud){
+	switch(baud){
+	case 9600:		return B9600;
+	case 19200:		return B19200;
+	case 38400:		return B38400;
+	case 57600:		return B57600;
+	case 115200:	return B115200;
+	case 230400:	return B230400;
+	case 460800:	return B460800;
+	case 921600:	return B921600;
+	case 1000000:	return B1000000;
+	case 2000000:	return B2000000;
+	default:		return 0;
+	}
+}
+
+/**
+ * int open_port(const char *path, long baud)
+ * @brief open a serial port raw 8N1 at baud (stdin for "-")
+ * @return file descriptor, -1 on error
+ */
+static int open_port(const char *path, long baud){
+	struct termios tio;
+	speed_t speed;
+	int fd;
+
+	if(strcmp(path, "-") == 0){
+		return STDIN_FILENO;
+	}
+	fd = open(path, O_RDONLY | O_NOCTTY);
+	if(fd < 0){
+		perror(path);
+		return -1;
+	}
+	if(tcgetattr(fd, &tio) == 0){
+		speed = baud_flag(baud);
+		if(speed == 0){
+			fprintf(stderr, "unsupported baud rate %ld\n", baud);
+			close(fd);
+			return -1;
+		}
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tio);
+		tcflush(fd, TCIFLUSH);
+	}
+	return fd;
+}
+
+/**
+ * double now_s(void)
+ * @brief monotonic time in seconds
+ */
+static double now_s(void){
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * uint32_t payload_u32(const telem_msg_t *msg, uint32_t i)
+ * @brief i-th uint32 of a byte payload, little endian
+ */
+static uint32_t payload_u32(const telem_msg_t *msg, uint32_t i){
+	const uint8_t *p = &msg->payload[4 * i];
+
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * void print_boot(const telem_msg_t *msg)
+ * @brief print a TELEM_TYPE_BOOT report, one line per stage
+ */
+static void print_boot(const telem_msg_t *msg){
+	static const char *const names[BOOT_STAGES] = BOOT_STAGE_NAMES;
+	double mhz = payload_u32(msg, 0) / 1e6;
+	uint32_t prev = 0, t;
+	char clock[24];
+
+	if(mhz <= 0){
+		return;
+	}
+	snprintf(clock, sizeof clock, "@ %.1f MHz", mhz);
+	fprintf(stderr, "boot %-14s %13s %13s\n", clock, "since reset", "in stage");
+	for(uint32_t i = 0; i < BOOT_STAGES; i++){
+		t = payload_u32(msg, i + 1);
+		fprintf(stderr, "boot %-14s %10.1f us %10.1f us\n", names[i], t / mhz, (uint32_t)(t - prev) / mhz);
+		prev = t;
+	}
+}
+
+/**
+ * void print_bus(const telem_msg_t *msg)
+ * @brief print a TELEM_TYPE_BUS report on one line
+ */
+static void print_bus(const telem_msg_t *msg){
+	double mhz = payload_u32(msg, 0) / 1e6;
+	uint32_t n = payload_u32(msg, 7);
+
+	if(mhz <= 0 || msg->len < TELEM_BUS_REPORT_LEN(n)){
+		return;
+	}
+	fprintf(stderr, "bus rounds %u overruns %u errors %u load %.1f%% efficiency %.1f%% round max %.0f us offsets",
+			payload_u32(msg, 1), payload_u32(msg, 2), payload_u32(msg, 3),
+			payload_u32(msg, 4) / 10.0, payload_u32(msg, 5) / 10.0, payload_u32(msg, 6) / mhz);
+	for(uint32_t i = 0; i < n; i++){
+		fprintf(stderr, " %.0f", payload_u32(msg, TELEM_BUS_REPORT_HEAD + i) / mhz);
+	}
+	fprintf(stderr, " us\n");
+}
+
+/**
+ * void print_msg(const telem_msg_t *msg, void *ctx)
+ * @brief decoder callback: print the message when -v is given
+ */
+static void print_msg(const telem_msg_t *msg, void *ctx){
+	int16_t samples[COMP_MAX_SAMPLES * COMP_MAX_CHANNELS];
+	int n;
+
+	(void)ctx;
+	if(msg->type == TELEM_TYPE_IMU_PACKED){
+		n = comp_decode(&unpack, msg->payload, msg->len, samples, COMP_MAX_SAMPLES);
+		for(int i = 0; verbose && i < n; i++){
+			printf("%u %u %u", msg->type, msg->seq, msg->stamp);
+			for(uint8_t c = 0; c < unpack.channels; c++){
+				printf(" %d", samples[i * unpack.channels + c]);
+			}
+			printf("\n");
+		}
+		return;
+	}
+	if(msg->type == TELEM_TYPE_BOOT && msg->len >= BOOT_REPORT_LEN){
+		print_boot(msg);
+		return;
+	}
+	if(msg->type == TELEM_TYPE_BUS && msg->len >= TELEM_BUS_REPORT_LEN(0)){
+		print_bus(msg);
+		return;
+	}
+	if(msg->type == TELEM_TYPE_REPLY){
+		fprintf(stderr, "reply %.*s\n", (int)msg->len, (const char *)msg->payload);
+		return;
+	}
+	if(msg->type == TELEM_TYPE_STACK && msg->len >= 8){
+		fprintf(stderr, "stack msp %d of %d bytes, guard %d bytes, breaches %d\n",
+				telem_value(msg, 0), telem_value(msg, 1), telem_value(msg, 2), telem_value(msg, 3));
+	}
+	if(!verbose){
+		return;
+	}
+	printf("%u %u %u", msg->type, msg->seq, msg->stamp);
+	for(uint32_t i = 0; i < msg->len / 2U; i++){
+		printf(" %d", telem_value(msg, i));
+	}
+	printf("\n");
+}
+
+/**
+ * void report(const telem_decoder_t *d, const telem_decoder_t *prev, double dt, const char *tag)
+ * @brief print rates since prev and the running totals
+ */
+static void report(const telem_decoder_t *d, const telem_decoder_t *prev, double dt, const char *tag){
+	fprintf(stderr, "%s %.0f frames/s %.0f B/s | frames %llu crc %llu malformed %llu gaps %llu lost %llu"
+			" | packed blocks %u skipped %u bad %u\n",
+			tag,
+			dt > 0 ? (d->frames - prev->frames) / dt : 0.0,
+			dt > 0 ? (d->bytes - prev->bytes) / dt : 0.0,
+			(unsigned long long)d->frames, (unsigned long long)d->crc_errors,
+			(unsigned long long)d->malformed, (unsigned long long)d->gaps,
+			(unsigned long long)d->lost,
+			unpack.blocks, unpack.skipped, unpack.errors);
+}
+
+/**
+ * int generate(long frames, long corrupt_every, long drop_every)
+ * @brief write a synthetic IMU stream to stdout with the firmware encoder
+ * @step followed:
+ *
+ * 1. Fill a message like the IMU task does (seq, 4 ms stamps, 7 values)
+ * 2. Skip every drop_every-th frame (its seq is still used)
+ * 3. Flip one stuffed byte of every corrupt_every-th frame, never into a delimiter
+ */
+static int generate(long frames, long corrupt_every, long drop_every){
+	uint8_t wire[TELEM_WIRE_MAX];
+	uint8_t payload[14];
+	int16_t v;
+	uint32_t len;
+
+	for(long i = 0; i < frames; i++){
+
+		/*1. Fill a message like the IMU task does*/
+		for(uint8_t k = 0; k < 7; k++){
+			v = (k == 0) ? 0 : (int16_t)((i * (k + 1) * 37) & 0xFFFF);	// value 0 makes sure stuffing has zeros to remove
+			payload[2 * k] = (uint8_t)v;
+			payload[2 * k + 1] = (uint8_t)((uint16_t)v >> 8);
+		}
+
+		/*2. Skip every drop_every-th frame*/
+		if(drop_every && i % drop_every == drop_every - 1){
+			continue;
+		}
+		len = telem_encode(TELEM_TYPE_IMU_RAW, (uint16_t)i, (uint32_t)(i * GEN_PERIOD_US), payload, sizeof(payload), wire);
+
+		/*3. Flip one stuffed byte of every corrupt_every-th frame*/
+		if(corrupt_every && i % corrupt_every == corrupt_every - 1){
+			uint32_t at = 1 + (uint32_t)(i % (len - 2));
+			wire[at] ^= (wire[at] == 0x01) ? 0x02 : 0x01;
+		}
+		if(fwrite(wire, 1, len, stdout) != len){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char **argv){
+	telem_decoder_t dec;
+	telem_decoder_t prev;
+	uint8_t buf[READ_CHUNK];
+	long baud = 115200;
+	long gen = -1;
+	long corrupt_every = 0;
+	long drop_every = 0;
+	double interval = 1.0;
+	double t0, tlast, t;
+	ssize_t n;
+	int opt;
+	int fd;
+
+	while((opt = getopt(argc, argv, "b:vi:g:e:d:")) != -1){
+		switch(opt){
+		case 'b': baud = strtol(optarg, 0, 10); break;
+		case 'v': verbose = 1; break;
+		case 'i': interval = strtod(optarg, 0); break;
+		case 'g': gen = strtol(optarg, 0, 10); break;
+		case 'e': corrupt_every = strtol(optarg, 0, 10); break;
+		case 'd': drop_every = strtol(optarg, 0, 10); break;
+		default:
+			fprintf(stderr, "usage: %s [-b baud] [-v] [-i s] <device|->\n"
+					"       %s -g frames [-e n] [-d n]\n", argv[0], argv[0]);
+			return 2;
+		}
+	}
+
+	if(gen >= 0){
+		return generate(gen, corrupt_every, drop_every);
+	}
+	if(optind >= argc){
+		fprintf(stderr, "no input, use - for stdin\n");
+		return 2;
+	}
+	fd = open_port(argv[optind], baud);
+	if(fd < 0){
+		return 1;
+	}
+
+	telem_decoder_init(&dec);
+	comp_decoder_init(&unpack);
+	prev = dec;
+	t0 = tlast = now_s();
+	for(;;){
+		n = read(fd, buf, sizeof(buf));
+		if(n < 0 && errno == EINTR){
+			continue;
+		}
+		if(n <= 0){
+			break;
+		}
+		telem_decoder_feed(&dec, buf, (size_t)n, print_msg, 0);
+
+		t = now_s();
+		if(t - tlast >= interval){
+			report(&dec, &prev, t - tlast, "rate");
+			prev = dec;
+			tlast = t;
+		}
+	}
+
+	memset(&prev, 0, sizeof(prev));
+	report(&dec, &prev, now_s() - t0, "total");
+	return 0;
+}
@@ -0,0 +1,257 @@
+/**
+ * telemcheck.c
+ *	@brief Linux CLI: telemetry frames through encoder and stream decoder, command replies included
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -DSTM32F411xE -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -I. -o telemcheck telemcheck.c telem_host.c ../Core/Src/telemetry.c \
+ *     ../Core/Src/telemetry_tx.c ../Core/Src/cobs.c ../Core/Src/crc.c
+ *
+ * Usage:
+ *  telemcheck
+ *
+ * Checks, each printed as ok/FAIL:
+ *  round trip     telem_encode then telem_decode for every type and every
+ *                 payload length up to TELEM_MAX_PAYLOAD, zero bytes
+ *                 included: type, seq, stamp and payload come back
+ *  replies        IMU frames with TELEM_TYPE_REPLY frames between them, fed
+ *                 to the stream decoder in pieces of 1 to 13 bytes: every
+ *                 frame decoded, the reply texts in order, no error
+ *  plain text     why replies are frames: an "ok\n" written as text between
+ *                 two frames runs into the next one, which is lost
+ *  stamps         telem_send_bytes() (the UART TX ring stubbed) with DWT
+ *                 stamps out of order, as main.c sends them: batch stamps
+ *                 and row[0] of a round older than the reports before
+ *                 them, across the 32 bit wrap too; each decodes to its
+ *                 own time, none counts as a wrap
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "telem_host.h"
+#include "uart.h"
+
+#define IMU_VALUES				(7)
+#define CYCLES_PER_US			(16U)
+#define TX_LEN					(4096)
+
+static const char *const replies[] = {
+	"ok",
+	"err",
+	"ok 250.000 Hz, bw 98 Hz, delay 2900 us",
+	"stops 12, duty 85, wake 412 us (max 530)"
+};
+
+static int failed;
+
+uint32_t SystemCoreClock = CYCLES_PER_US * 1000000U;
+
+/* the UART TX ring of uart.c, for telemetry_tx.c */
+static uint8_t tx[TX_LEN];
+static uint32_t tx_len;
+
+uint32_t uart2_tx_space(void){
+	return TX_LEN - tx_len;
+}
+
+uint8_t *uart2_tx_reserve(uint32_t *n){
+	*n = TX_LEN - tx_len;
+	return tx + tx_len;
+}
+
+void uart2_tx_commit(uint32_t n){
+	tx_len += n;
+}
+
+int uart2_write(const char *data, int len){
+	memcpy(tx + tx_len, data, (size_t)len);
+	tx_len += (uint32_t)len;
+	return len;
+}
+
+/* what the decoder callback saw */
+static uint32_t imu_frames, reply_frames, reply_bad;
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+/**
+ * int round_trip(void)
+ * @brief encode and decode one frame of each type and length
+ */
+static int round_trip(void){
+	static uint8_t payload[TELEM_MAX_PAYLOAD], wire[TELEM_WIRE_MAX];
+	telem_msg_t msg;
+	uint32_t n;
+	int ok = 1;
+
+	for(uint32_t i = 0; i < sizeof(payload); i++){
+		payload[i] = (uint8_t)((i % 5U == 0) ? 0 : i * 37U);
+	}
+	for(uint8_t type = TELEM_TYPE_IMU_RAW; type <= TELEM_TYPE_REPLY; type++){
+		for(uint32_t len = 0; len <= TELEM_MAX_PAYLOAD; len++){
+			n = telem_encode(type, (uint16_t)(len * 11U), len * 4000U, payload, len, wire);
+
+			/* the delimiter ends the frame and appears nowhere else */
+			ok &= n <= TELEM_WIRE_LEN(len) && wire[n - 1] == 0 && memchr(wire, 0, n - 1) == 0;
+			ok &= telem_decode(wire, n - 1, &msg) == 0;
+			ok &= msg.type == type && msg.seq == (uint16_t)(len * 11U) && msg.stamp == len * 4000U;
+			ok &= msg.len == len && memcmp(msg.payload, payload, len) == 0;
+		}
+	}
+	return ok;
+}
+
+static void count_msg(const telem_msg_t *msg, void *ctx){
+	uint32_t *next = ctx;
+
+	if(msg->type == TELEM_TYPE_IMU_RAW){
+		imu_frames++;
+		return;
+	}
+	if(msg->type == TELEM_TYPE_REPLY){
+		const char *want = replies[*next % (sizeof(replies) / sizeof(replies[0]))];
+
+		reply_frames++;
+		reply_bad += msg->len != strlen(want) || memcmp(msg->payload, want, msg->len) != 0;
+		(*next)++;
+	}
+}
+
+/**
+ * uint32_t imu_frame(uint16_t seq, uint8_t *wire)
+ * @brief one IMU_RAW frame as the IMU task sends it
+ */
+static uint32_t imu_frame(uint16_t seq, uint8_t *wire){
+	uint8_t payload[2 * IMU_VALUES];
+
+	for(uint32_t k = 0; k < sizeof(payload); k++){
+		payload[k] = (uint8_t)(seq * (k + 1U));
+	}
+	return telem_encode(TELEM_TYPE_IMU_RAW, seq, seq * 4000U, payload, sizeof(payload), wire);
+}
+
+/**
+ * uint32_t reply_frame(uint16_t seq, uint32_t i, uint8_t *wire)
+ * @brief the i-th reply as cmd_reply() in main.c sends it
+ */
+static uint32_t reply_frame(uint16_t seq, uint32_t i, uint8_t *wire){
+	const char *text = replies[i % (sizeof(replies) / sizeof(replies[0]))];
+
+	return telem_encode(TELEM_TYPE_REPLY, seq, seq * 4000U, (const uint8_t *)text, strlen(text), wire);
+}
+
+/**
+ * int reply_stream(void)
+ * @brief 200 IMU frames, a reply after every tenth, fed in uneven pieces
+ */
+static int reply_stream(void){
+	static uint8_t stream[200 * 2 * TELEM_WIRE_LEN(2 * IMU_VALUES) + 20 * TELEM_WIRE_MAX];
+	telem_decoder_t d;
+	uint32_t len = 0, pos = 0, piece = 1, next = 0, sent = 0;
+	uint16_t seq = 0;
+
+	for(uint32_t i = 0; i < 200; i++){
+		len += imu_frame(seq++, stream + len);
+		if(i % 10U == 9U){
+			len += reply_frame(seq++, sent++, stream + len);
+		}
+	}
+	imu_frames = reply_frames = reply_bad = 0;
+	telem_decoder_init(&d);
+	while(pos < len){
+		uint32_t n = (len - pos < piece) ? len - pos : piece;
+
+		telem_decoder_feed(&d, stream + pos, n, count_msg, &next);
+		pos += n;
+		piece = piece % 13U + 1U;
+	}
+	printf("  %u IMU frames, %u replies, %llu malformed, %llu crc, %llu lost\n", (unsigned)imu_frames,
+			(unsigned)reply_frames, (unsigned long long)d.malformed, (unsigned long long)d.crc_errors,
+			(unsigned long long)d.lost);
+	return imu_frames == 200 && reply_frames == sent && reply_bad == 0 && d.malformed == 0
+			&& d.crc_errors == 0 && d.lost == 0;
+}
+
+/**
+ * int plain_text(void)
+ * @brief frame, "ok\n", frame: the text is glued to the start of the second frame
+ */
+static int plain_text(void){
+	uint8_t stream[3 * TELEM_WIRE_MAX];
+	telem_decoder_t d;
+	uint32_t len = 0, next = 0;
+
+	len += imu_frame(0, stream + len);
+	memcpy(stream + len, "ok\n", 3);
+	len += 3;
+	len += imu_frame(1, stream + len);
+	imu_frames = 0;
+	telem_decoder_init(&d);
+	telem_decoder_feed(&d, stream, len, count_msg, &next);
+	return imu_frames == 1 && d.malformed + d.crc_errors == 1;
+}
+
+static void take_stamp(const telem_msg_t *msg, void *ctx){
+	uint32_t *stamps = ctx;
+
+	stamps[msg->seq] = msg->stamp;
+}
+
+/**
+ * int stamps(void)
+ * @brief frames stamped out of order, before and after the DWT wrap
+ * @step followed:
+ *
+ * 1. Times in us since boot: reports at the time they are sent, data
+ *    frames with the stamp of their first row, up to 32 ms older; the
+ *    last ones past the first wrap of the 32 bit counter (268 s), with a
+ *    frame at least every 2^31 cycles on the way
+ * 2. Send each with its DWT stamp (the time mod 2^32 cycles)
+ * 3. Every frame decodes to its own time
+ */
+static int stamps(void){
+	static const uint32_t us[] = {
+		1000000, 1010000, 1000000, 1020000, 988000, 1030000, 1030000, 1025000, 100000000, 200000000,
+		268400000, 268435000, 268400000, 268436000, 268420000, 268500000, 268440000, 269000000
+	};
+	uint32_t got[sizeof(us) / sizeof(us[0])];
+	telem_decoder_t d;
+	uint8_t payload[2] = { 1, 2 };
+	int ok = 1;
+
+	/*1. Times in us since boot*/
+	tx_len = 0;
+	memset(got, 0, sizeof(got));
+
+	/*2. Send each with its DWT stamp*/
+	for(uint32_t i = 0; i < sizeof(us) / sizeof(us[0]); i++){
+		ok &= telem_send_bytes(TELEM_TYPE_IMU_RAW, (uint32_t)((uint64_t)us[i] * CYCLES_PER_US), payload, 2) == 0;
+	}
+
+	/*3. Every frame decodes to its own time*/
+	telem_decoder_init(&d);
+	telem_decoder_feed(&d, tx, tx_len, take_stamp, got);
+	for(uint32_t i = 0; i < sizeof(us) / sizeof(us[0]); i++){
+		if(got[i] != us[i]){
+			printf("  frame %u: %u us, sent at %u us\n", (unsigned)i, (unsigned)got[i], (unsigned)us[i]);
+			ok = 0;
+		}
+	}
+	return ok && d.frames == sizeof(us) / sizeof(us[0]);
+}
+
+int main(void){
+	check("round trip", round_trip());
+	check("replies", reply_stream());
+	check("plain text", plain_text());
+	check("stamps", stamps());
+	return failed;
+}
@@ -0,0 +1,442 @@
+/**
+ * uartcheck.c
+ *	@brief Linux CLI: uart.c on the register level simulator, TX chunking and wrap-around,
+ *	       the full ring policies, ISR writers, RX chunks
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory, x86-64 Linux):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -no-pie \
+ *     -DSTM32F411xE -include sim/sim_cmsis.h -Isim -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -o uartcheck uartcheck.c sim/sim*.c ../Core/Src/uart.c ../Core/Src/fmt.c
+ *
+ * Usage:
+ *  uartcheck [lines]		default 400 thread lines in the isr writer check
+ *
+ * Checks, each printed as ok/FAIL:
+ *  tx wrap        1000 bytes, then 100 that cross the end of the ring: two
+ *                 DMA transfers for the second write, every byte in order
+ *  drop           a full ring keeps what is queued, the rest is counted
+ *  overwrite      bytes not yet handed to DMA give way to the newest ones
+ *  block          a write longer than the ring waits for DMA, nothing lost
+ *  tx error       a DMA transfer error 50 bytes into a 200 byte run: the
+ *                 rest is dropped and counted, the next write goes out
+ *  reserve        an ISR write while thread mode holds uart2_tx_reserve
+ *                 is dropped, not copied into the reserved run
+ *  isr writer     TIM2 writes short lines from its interrupt while thread
+ *                 mode writes long ones as fast as the ring drains. Besides
+ *                 the register accesses and __WFI(), sim_spin() lets an
+ *                 interrupt land between any two instructions of the
+ *                 thread, uart2_write included. Every line arrives whole,
+ *                 each writer's lines in order, every accepted one sent.
+ *  rx wrap        two bursts, the second across the end of the DMA buffer:
+ *                 chunks cut at HT, TC and IDLE, the end flag on the last
+ *  rx overrun     a burst that laps a chunk not yet released is counted
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "sim.h"
+#include "uart.h"
+#include "sched.h"
+
+#define BAUD					(115200U)
+#define TASK_TEST				(1)
+#define SIG_RX					(2)
+#define THREAD_LINE_LEN			(40)		// "T00000 " + padding + "\n"
+#define ISR_LINE_LEN			(7)			// "I00000\n"
+#define ISR_SLACK				(4U * ISR_LINE_LEN)	// room the thread leaves for the ISR
+#define LINE_MAX				(65536)
+
+static int failed;
+static long lines = 400;
+
+/* what the USART2 line carried */
+static char line[LINE_MAX];
+static uint32_t line_len;
+
+static volatile int posted;
+static volatile uint16_t posted_arg;
+
+/* isr writer */
+static volatile int isr_on;
+static volatile uint32_t isr_lines, isr_skips;
+
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	posted = sig;
+	posted_arg = arg;
+	return 0;
+}
+
+void DMA1_Stream5_IRQHandler(void){
+	uart2_rx_dma_irq_handler();
+}
+
+void DMA1_Stream6_IRQHandler(void){
+	uart2_tx_dma_irq_handler();
+}
+
+void USART2_IRQHandler(void){
+	uart2_irq_handler();
+}
+
+/**
+ * void isr_line(void)
+ * @brief one short numbered line from interrupt context, if it fits whole
+ */
+static void isr_line(void){
+	char buf[ISR_LINE_LEN + 1];
+
+	if(uart2_tx_space() < ISR_LINE_LEN){
+		isr_skips++;
+		return;
+	}
+	snprintf(buf, sizeof(buf), "I%05u\n", (unsigned)(isr_lines % 100000U));
+	if(uart2_write(buf, ISR_LINE_LEN) == ISR_LINE_LEN){
+		isr_lines++;
+	}
+}
+
+void TIM2_IRQHandler(void){
+	TIM2->SR = ~(uint32_t)TIM_SR_UIF;
+	if(isr_on){
+		isr_line();
+	}
+}
+
+void EXTI0_IRQHandler(void){
+	EXTI->PR = EXTI_PR_PR0;
+	isr_line();
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+static void sink(void *ctx, uint16_t data){
+	if(line_len < sizeof(line)){
+		line[line_len++] = (char)data;
+	}
+}
+
+/**
+ * void drain(void)
+ * @brief sleep until the last queued byte has left the shift register
+ */
+static void drain(void){
+	while(!uart2_tx_idle()){
+		__WFI();
+	}
+}
+
+/**
+ * void pattern(char *p, uint32_t n, uint32_t seed)
+ * @brief printable bytes that differ from one position to the next
+ */
+static void pattern(char *p, uint32_t n, uint32_t seed){
+	for(uint32_t i = 0; i < n; i++){
+		p[i] = (char)('!' + (seed + i * 7U) % 90U);
+	}
+}
+
+/**
+ * int tx_wrap(void)
+ * @brief right after uart2_init the ring starts at 0: 1000 + 100 bytes wrap at 1024
+ */
+static int tx_wrap(void){
+	static char a[1000], b[100];
+	uint32_t chunks;
+	int ok;
+
+	pattern(a, sizeof(a), 1);
+	pattern(b, sizeof(b), 2);
+	line_len = 0;
+	ok = uart2_write(a, sizeof(a)) == sizeof(a);
+	drain();
+	chunks = uart_tx_stats.dma_chunks;
+	ok &= uart2_write(b, sizeof(b)) == sizeof(b);
+	drain();
+	printf("  %u bytes, %u DMA transfers for the write across the end\n", (unsigned)line_len,
+			(unsigned)(uart_tx_stats.dma_chunks - chunks));
+	return ok && chunks == 1 && uart_tx_stats.dma_chunks - chunks == 2 && line_len == 1100
+			&& memcmp(line, a, sizeof(a)) == 0 && memcmp(line + sizeof(a), b, sizeof(b)) == 0;
+}
+
+/**
+ * int drop(void)
+ * @brief a whole ring in flight, 100 more bytes
+ */
+static int drop(void){
+	static char a[UART_TX_RING_LEN], b[100];
+	uart_tx_stats_t s = uart_tx_stats;
+	int ok;
+
+	pattern(a, sizeof(a), 3);
+	pattern(b, sizeof(b), 4);
+	uart2_set_tx_policy(UART_TX_DROP);
+	line_len = 0;
+	ok = uart2_write(a, sizeof(a)) == sizeof(a);
+	ok &= uart2_write(b, sizeof(b)) == 0;
+	drain();
+	return ok && line_len == sizeof(a) && memcmp(line, a, sizeof(a)) == 0
+			&& uart_tx_stats.dropped - s.dropped == sizeof(b) && uart_tx_stats.overflows - s.overflows == 1;
+}
+
+/**
+ * int overwrite(void)
+ * @brief 500 bytes go to DMA at once, 400 wait in the ring, 300 more replace those 400
+ */
+static int overwrite(void){
+	static char a[500], b[400], c[300];
+	uart_tx_stats_t s = uart_tx_stats;
+	int ok;
+
+	pattern(a, sizeof(a), 5);
+	pattern(b, sizeof(b), 6);
+	pattern(c, sizeof(c), 7);
+	uart2_set_tx_policy(UART_TX_OVERWRITE);
+	line_len = 0;
+	ok = uart2_write(a, sizeof(a)) == sizeof(a);
+	ok &= uart2_write(b, sizeof(b)) == sizeof(b);
+	ok &= uart2_write(c, sizeof(c)) == sizeof(c);
+	drain();
+	return ok && line_len == sizeof(a) + sizeof(c) && memcmp(line, a, sizeof(a)) == 0
+			&& memcmp(line + sizeof(a), c, sizeof(c)) == 0
+			&& uart_tx_stats.overwritten - s.overwritten == sizeof(b);
+}
+
+/**
+ * int block(void)
+ * @brief one write of one and a half rings
+ */
+static int block(void){
+	static char a[UART_TX_RING_LEN * 3 / 2];
+	uart_tx_stats_t s = uart_tx_stats;
+	int ok;
+
+	pattern(a, sizeof(a), 8);
+	uart2_set_tx_policy(UART_TX_BLOCK);
+	line_len = 0;
+	ok = uart2_write(a, sizeof(a)) == sizeof(a);
+	drain();
+	return ok && line_len == sizeof(a) && memcmp(line, a, sizeof(a)) == 0
+			&& uart_tx_stats.dropped == s.dropped && uart_tx_stats.overflows - s.overflows == 1;
+}
+
+/**
+ * int tx_error(void)
+ * @brief the bus fails on byte 51 of a 200 byte run, then 100 bytes more
+ */
+static int tx_error(void){
+	static char a[200], b[100];
+	uart_tx_stats_t s = uart_tx_stats;
+	int ok;
+
+	pattern(a, sizeof(a), 9);
+	pattern(b, sizeof(b), 10);
+	uart2_set_tx_policy(UART_TX_DROP);
+	line_len = 0;
+	sim_dma_error(DMA1, 6, 50);
+	ok = uart2_write(a, sizeof(a)) == sizeof(a);
+	drain();
+	ok &= uart2_write(b, sizeof(b)) == sizeof(b);
+	drain();
+	printf("  %u bytes sent, %u dropped with the failed run\n", (unsigned)(uart_tx_stats.sent - s.sent),
+			(unsigned)(uart_tx_stats.dropped - s.dropped));
+	return ok && uart_tx_stats.dma_errors - s.dma_errors == 1 && line_len == 50 + sizeof(b)
+			&& memcmp(line, a, 50) == 0 && memcmp(line + 50, b, sizeof(b)) == 0
+			&& uart_tx_stats.sent - s.sent == 50 + sizeof(b) && uart_tx_stats.dropped - s.dropped == 150;
+}
+
+/**
+ * int reserve(void)
+ * @brief EXTI0 writes between uart2_tx_reserve and uart2_tx_commit, then after it
+ */
+static int reserve(void){
+	uart_tx_stats_t s = uart_tx_stats;
+	uint8_t *p;
+	uint32_t n;
+	int ok;
+
+	EXTI->IMR |= EXTI_IMR_MR0;
+	NVIC_EnableIRQ(EXTI0_IRQn);
+	isr_lines = 0;
+	line_len = 0;
+	p = uart2_tx_reserve(&n);
+	ok = n >= 5;
+	memcpy(p, "held\n", 5);
+	EXTI->SWIER = EXTI_SWIER_SWIER0;	// the handler runs here, its write is refused
+	ok &= isr_lines == 0 && uart_tx_stats.dropped - s.dropped == ISR_LINE_LEN;
+	uart2_tx_commit(5);
+	EXTI->SWIER = EXTI_SWIER_SWIER0;
+	drain();
+	NVIC_DisableIRQ(EXTI0_IRQn);
+	return ok && isr_lines == 1 && line_len == 5 + ISR_LINE_LEN && memcmp(line, "held\nI00000\n", 12) == 0;
+}
+
+/**
+ * int isr_writer(void)
+ * @brief TIM2 at 1 kHz against a thread that writes as fast as the ring allows
+ * @step followed:
+ *
+ * 1. Start TIM2 and sim_spin(), so CPU time moves simulated time on
+ * 2. Write the thread lines, each when it fits with room for the ISR
+ * 3. Split what the line carried into lines and check each writer's sequence
+ */
+static int isr_writer(void){
+	char buf[THREAD_LINE_LEN + 1];
+	uint32_t next_t = 0, next_i = 0, bad = 0;
+	uint32_t pos = 0;
+
+	/*1. Start TIM2 and sim_spin()*/
+	uart2_set_tx_policy(UART_TX_DROP);
+	line_len = 0;
+	isr_lines = 0;
+	isr_skips = 0;
+	RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+	TIM2->PSC = 15;
+	TIM2->ARR = 999;
+	TIM2->EGR = TIM_EGR_UG;
+	TIM2->SR = 0;
+	TIM2->DIER = TIM_DIER_UIE;
+	NVIC_EnableIRQ(TIM2_IRQn);
+	isr_on = 1;
+	TIM2->CR1 = TIM_CR1_CEN;
+	sim_spin(50000U);
+
+	/*2. Write the thread lines, each when it fits with room for the ISR*/
+	for(long i = 0; i < lines; i++){
+		snprintf(buf, sizeof(buf), "T%05u %-32s\n", (unsigned)i, "the quick brown fox jumps");
+		while(uart2_tx_space() < THREAD_LINE_LEN + ISR_SLACK){
+			__WFI();
+		}
+		if(uart2_write(buf, THREAD_LINE_LEN) != THREAD_LINE_LEN){
+			bad++;
+		}
+	}
+	isr_on = 0;
+	sim_spin(0);
+	TIM2->CR1 = 0;
+	NVIC_DisableIRQ(TIM2_IRQn);
+	drain();
+
+	/*3. Split what the line carried into lines and check each writer's sequence*/
+	while(pos < line_len){
+		if(line[pos] == 'T' && pos + THREAD_LINE_LEN <= line_len && line[pos + THREAD_LINE_LEN - 1] == '\n'
+				&& strtoul(&line[pos + 1], 0, 10) == next_t){
+			next_t++;
+			pos += THREAD_LINE_LEN;
+		}else if(line[pos] == 'I' && pos + ISR_LINE_LEN <= line_len && line[pos + ISR_LINE_LEN - 1] == '\n'
+				&& strtoul(&line[pos + 1], 0, 10) == next_i){
+			next_i++;
+			pos += ISR_LINE_LEN;
+		}else{
+			bad++;
+			break;
+		}
+	}
+	printf("  %u thread lines, %u isr lines (%u skipped, ring full), %.1f ms simulated\n", (unsigned)next_t,
+			(unsigned)next_i, (unsigned)isr_skips, sim_now / 1e6);
+	return bad == 0 && next_t == (uint32_t)lines && next_i == isr_lines && next_i > 0;
+}
+
+/**
+ * int rx_burst(const char *data, uint32_t n, char *out, uint32_t *chunks, int *end_last)
+ * @brief inject a burst, wait for the end of burst event, collect its chunks
+ * @return bytes collected
+ */
+static uint32_t rx_burst(const char *data, uint32_t n, char *out, uint32_t *chunks, int *ends){
+	const uint8_t *p;
+	uint32_t len, got = 0;
+	int end;
+
+	posted = 0;
+	*chunks = 0;
+	*ends = 0;
+	sim_usart_inject(USART2, (const uint8_t *)data, n);
+	while(!posted){
+		__WFI();
+	}
+	while((p = uart2_rx_peek(&len, &end)) != 0){
+		memcpy(out + got, p, len);
+		got += len;
+		(*chunks)++;
+		/* bit k: chunk k carries the end flag */
+		*ends |= end << (*chunks - 1U);
+		uart2_rx_release();
+	}
+	return got;
+}
+
+/**
+ * int rx_wrap(void)
+ * @brief 200 bytes (HT at 128, IDLE), then 100 from offset 200 (TC at 256, IDLE)
+ */
+static int rx_wrap(void){
+	static char a[200], b[100], out[256];
+	uint32_t chunks;
+	int ends, ok;
+
+	pattern(a, sizeof(a), 9);
+	pattern(b, sizeof(b), 10);
+	uart2_rx_notify(TASK_TEST, SIG_RX);
+	ok = rx_burst(a, sizeof(a), out, &chunks, &ends) == sizeof(a) && memcmp(out, a, sizeof(a)) == 0;
+	ok &= chunks == 2 && ends == 2 && posted_arg == sizeof(a);
+	ok &= rx_burst(b, sizeof(b), out, &chunks, &ends) == sizeof(b) && memcmp(out, b, sizeof(b)) == 0;
+	ok &= chunks == 2 && ends == 2 && posted_arg == sizeof(b);
+	return ok && uart_rx_stats.overruns == 0 && uart_rx_stats.line_errors == 0;
+}
+
+/**
+ * int rx_overrun(void)
+ * @brief 200 bytes kept, 100 more lap them
+ */
+static int rx_overrun(void){
+	static char a[200];
+	const uint8_t *p;
+	uint32_t len;
+	int end;
+
+	pattern(a, sizeof(a), 11);
+	posted = 0;
+	sim_usart_inject(USART2, (const uint8_t *)a, sizeof(a));
+	while(!posted){
+		__WFI();
+	}
+	posted = 0;
+	sim_usart_inject(USART2, (const uint8_t *)a, 100);
+	while(!posted){
+		__WFI();
+	}
+	while((p = uart2_rx_peek(&len, &end)) != 0){
+		uart2_rx_release();
+	}
+	return uart_rx_stats.overruns >= 1;
+}
+
+int main(int argc, char **argv){
+	if(argc > 1){
+		lines = strtol(argv[1], 0, 10);
+	}
+	sim_init();
+	sim_usart_sink(USART2, sink, 0);
+	uart2_init(BAUD);
+
+	check("tx wrap", tx_wrap());
+	check("drop", drop());
+	check("overwrite", overwrite());
+	check("block", block());
+	check("tx error", tx_error());
+	check("reserve", reserve());
+	check("isr writer", isr_writer());
+	check("rx wrap", rx_wrap());
+	check("rx overrun", rx_overrun());
+	printf("%.3f ms simulated, %lu register accesses, %lu interrupts\n", sim_now / 1e6,
+			(unsigned long)sim_stats.accesses, (unsigned long)sim_stats.irqs);
+	return failed;
+}
@@ -0,0 +1,233 @@
+/**
+ * womcheck.c
+ *	@brief Linux CLI: MPU6050 wake on motion entry and exit through the shadow, Stop armed around it
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * Build (from this directory, x86-64 Linux):
+ *  cc -O2 -Wall -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -no-pie \
+ *     -DSTM32F411xE -include sim/sim_cmsis.h -Isim -I../Core/Inc \
+ *     -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include \
+ *     -o womcheck womcheck.c sim/sim*.c ../Core/Src/MPU6050.c ../Core/Src/power.c
+ *
+ * MPU6050.c runs on a stub of the blocking i2c.c calls: a register file
+ * with the power-on values of the MPU6050 and a latched INT line that a
+ * read clears (INT_RD_CLEAR). Every transaction is logged. power.c runs
+ * on the simulator (sim/): the stub can raise PA0 (the INT pin) during a
+ * chosen write, and EXTI0 is taken at once, as motion during the set-up.
+ *
+ * Checks, each printed as ok/FAIL:
+ *  enter          4 bursts, then the INT_STATUS read: accel cycling at the
+ *                 wake rate, gyros and temperature off, MOT_EN only, INT
+ *                 active high push-pull latched, MOT_THR in 2 mg, high pass
+ *                 5 Hz, FS_SEL and AFS_SEL kept; a stale latch is cleared
+ *  threshold      0 mg and 1 g clamp to 1 and 255
+ *  exit           3 bursts and a read: every axis on, no cycling, interrupt
+ *                 and high pass off, INT released, the ranges kept
+ *  again          a second cycle writes the same, a busy bus is refused
+ *  wake in entry  the order of imu_quiet_check() and SIG_IMU_WAKE in
+ *                 main.c: Stop armed, motion during the entry, the wake
+ *                 handled: the next idle is no Stop. A failed entry
+ *                 disarms too. Armed after the entry instead (the old
+ *                 order), the same wake is lost and the idle enters Stop.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "MPU6050.h"
+#include "power.h"
+#include "sim.h"
+
+#define WAKE_TASK				(1)
+#define WAKE_SIG				(3)
+
+/* the stub sensor and its transaction log */
+static uint8_t regs[128];
+static uint32_t reads, writes;
+static int int_line, busy;
+static uint32_t wake_at;				// write that raises PA0, 0: none
+static uint32_t posted;					// wake events posted by power.c
+static I2C_TypeDef i2c_regs = { .CR1 = I2C_CR1_PE };
+i2c_handle_t i2c1 = { .regs = &i2c_regs };
+
+static mpu6050_t dev = MPU6050_DEVICE(&i2c1, MPU6050_ADDR_AD0_LOW);
+static int failed;
+
+void i2c_init(i2c_handle_t *h){
+}
+
+int i2c_busy(const i2c_handle_t *h){
+	return busy;
+}
+
+int i2c_burst_read_it(i2c_handle_t *h, char saddr, char maddr, int n, char* data, uint8_t task, uint8_t sig){
+	return -1;
+}
+
+int i2c_burst_read(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	reads++;
+	for(int i = 0; i < n; i++){
+		data[i] = (char)regs[((uint8_t)maddr + i) & 0x7F];
+	}
+	if((regs[INT_PIN_CFG_R] & MPU6050_INT_RD_CLEAR) || (uint8_t)maddr == INT_STATUS_R){
+		int_line = 0;
+	}
+	return 0;
+}
+
+int i2c_byte_read(i2c_handle_t *h, char saddr, char maddr, char* data){
+	return i2c_burst_read(h, saddr, maddr, 1, data);
+}
+
+int i2c_burst_write(i2c_handle_t *h, char saddr, char maddr, int n, char* data){
+	writes++;
+	for(int i = 0; i < n; i++){
+		regs[((uint8_t)maddr + i) & 0x7F] = (uint8_t)data[i];
+	}
+	if(writes == wake_at){
+		/* motion: INT rises, EXTI0 preempts the entry here */
+		sim_gpio_input(GPIOA, 0, 1);
+		sim_irq_take();
+		sim_gpio_input(GPIOA, 0, 0);
+	}
+	return 0;
+}
+
+/* what power.c needs around it */
+int sched_post(uint8_t task, uint8_t sig, uint16_t arg){
+	posted += task == WAKE_TASK && sig == WAKE_SIG;
+	return 0;
+}
+
+int uart2_tx_idle(void){
+	return 1;
+}
+
+void EXTI0_IRQHandler(void){
+	power_exti_irq_handler();
+}
+
+static void check(const char *name, int ok){
+	printf("%-16s %s\n", name, ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+static void log_reset(void){
+	reads = writes = 0;
+}
+
+/**
+ * int wake_in_entry(void)
+ * @brief Stop armed around a wake on motion entry that motion interrupts
+ * @step followed:
+ *
+ * 1. As main.c: arm, enter (PA0 rises at the second write), the posted
+ *    wake disarms and exits; the idle must not Stop
+ * 2. A refused entry disarms; the idle must not Stop
+ * 3. The old order, armed after the entry: the idle enters Stop
+ */
+static int wake_in_entry(void){
+	uint32_t stops = power_stats.stops;
+	int ok = 1;
+
+	/*1. As main.c*/
+	log_reset();
+	posted = 0;
+	wake_at = 2;
+	power_stop_arm();
+	ok &= MPU6050_wom_enter(&dev, 40, MPU6050_WAKE_5HZ) == 0 && posted == 1;
+	if(posted){
+		power_stop_disarm();
+		ok &= MPU6050_wom_exit(&dev) == 0;
+	}
+	power_idle();
+	ok &= power_stats.stops == stops;
+
+	/*2. A refused entry disarms*/
+	wake_at = 0;
+	busy = 1;
+	power_stop_arm();
+	if(MPU6050_wom_enter(&dev, 40, MPU6050_WAKE_5HZ) != 0){
+		power_stop_disarm();
+	}
+	busy = 0;
+	power_idle();
+	ok &= power_stats.stops == stops;
+
+	/*3. The old order*/
+	log_reset();
+	posted = 0;
+	wake_at = 2;
+	ok &= MPU6050_wom_enter(&dev, 40, MPU6050_WAKE_5HZ) == 0 && posted == 1;
+	power_stop_arm();
+	power_idle();
+	printf("  armed after the entry: %u Stop entry after the wake\n",
+			(unsigned)(power_stats.stops - stops));
+	ok &= power_stats.stops == stops + 1U;
+	wake_at = 0;
+	power_stop_disarm();
+	return ok && MPU6050_wom_exit(&dev) == 0 && power_stats.wakes == 2U;
+}
+
+int main(void){
+	int ok;
+
+	sim_init();
+	memset(regs, 0, sizeof(regs));
+	regs[PWR_MGMT_1_R] = 0x40;
+	regs[WHO_AM_I_R] = MPU6050_WHO_AM_I;
+	dev.gyro_range = MPU6050_RANGE_1000_DEG;
+	dev.accel_range = MPU6050_RANGE_4_G;
+	if(MPU6050_init(&dev) != 0){
+		check("init", 0);
+		return failed;
+	}
+
+	/*enter*/
+	log_reset();
+	int_line = 1;
+	ok = MPU6050_wom_enter(&dev, 40, MPU6050_WAKE_5HZ) == 0;
+	printf("  enter: %u writes, %u reads\n", writes, reads);
+	check("enter", ok && writes == 4 && reads == 1 && !int_line && dev.dirty == 0
+			&& regs[PWR_MGMT_1_R] == (MPU6050_CYCLE | MPU6050_TEMP_DIS)
+			&& regs[PWR_MGMT_2_R] == ((MPU6050_WAKE_5HZ << 6) | MPU6050_STBY_G)
+			&& regs[INT_ENABLE_R] == MPU6050_MOT_EN
+			&& regs[INT_PIN_CFG_R] == (MPU6050_INT_LATCH_EN | MPU6050_INT_RD_CLEAR)
+			&& regs[MOT_THR_R] == 20 && regs[MOT_DETECT_CTRL_R] == MPU6050_MOT_DETECT
+			&& regs[ACCEL_CONFIG_R] == ((MPU6050_RANGE_4_G << 3) | MPU6050_ACCEL_HPF_5HZ)
+			&& regs[GYRO_CONFIG_R] == (MPU6050_RANGE_1000_DEG << 3));
+
+	/*threshold*/
+	ok = MPU6050_wom_enter(&dev, 0, MPU6050_WAKE_5HZ) == 0 && regs[MOT_THR_R] == 1;
+	ok &= MPU6050_wom_enter(&dev, 1000, MPU6050_WAKE_5HZ) == 0 && regs[MOT_THR_R] == 255;
+	ok &= MPU6050_wom_enter(&dev, 40, MPU6050_WAKE_1_25HZ) == 0 && regs[MOT_THR_R] == 20
+		&& (regs[PWR_MGMT_2_R] >> 6) == MPU6050_WAKE_1_25HZ;
+	check("threshold", ok);
+
+	/*exit*/
+	log_reset();
+	int_line = 1;
+	ok = MPU6050_wom_exit(&dev) == 0;
+	printf("  exit: %u writes, %u reads\n", writes, reads);
+	check("exit", ok && writes == 3 && reads == 1 && !int_line && dev.dirty == 0
+			&& regs[PWR_MGMT_1_R] == 0 && regs[PWR_MGMT_2_R] == 0 && regs[INT_ENABLE_R] == 0
+			&& regs[ACCEL_CONFIG_R] == (MPU6050_RANGE_4_G << 3)
+			&& regs[GYRO_CONFIG_R] == (MPU6050_RANGE_1000_DEG << 3));
+
+	/*again*/
+	log_reset();
+	ok = MPU6050_wom_enter(&dev, 40, MPU6050_WAKE_1_25HZ) == 0 && writes == 3;	// MOT_THR, MOT_DETECT_CTRL kept
+	ok &= MPU6050_wom_exit(&dev) == 0 && writes == 6;
+	busy = 1;
+	ok &= MPU6050_wom_enter(&dev, 40, MPU6050_WAKE_5HZ) == -1 && MPU6050_wom_exit(&dev) == -1 && writes == 6;
+	busy = 0;
+	check("again", ok && dev.dirty == 0);
+
+	/*wake in entry: the RTC model is memory, its init flag set by hand*/
+	SIM_VIEW(RTC)->ISR = RTC_ISR_INITF;
+	power_init(WAKE_TASK, WAKE_SIG);
+	check("wake in entry", wake_in_entry());
+	return failed;
+}
@@ -0,0 +1,118 @@
+/**
+ * atomic.h
+ *	@brief lock-free helpers shared by the ISR <-> main data paths
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * On the Cortex-M4 the read-modify-write helpers are built on LDREX/STREX,
+ * so they are safe against preemption by any interrupt without masking.
+ * Host builds (no __arm__) fall back to the GCC __atomic builtins so the
+ * queue logic can be compiled and exercised on a PC.
+ */
+
+#ifndef INC_ATOMIC_H_
+#define INC_ATOMIC_H_
+
+#include <stdint.h>
+
+#if defined(__arm__)
+#include "stm32f4xx.h"
+
+/* Order memory accesses before/after (data written before the index). */
+#define ATOMIC_BARRIER()		__DMB()
+
+/**
+ * uint32_t atomic_add_u32(volatile uint32_t *p, uint32_t v)
+ * @brief atomically add v to *p
+ * @return the new value
+ */
+static inline uint32_t atomic_add_u32(volatile uint32_t *p, uint32_t v){
+	uint32_t val;
+	do{
+		val = __LDREXW(p) + v;
+	}while(__STREXW(val, p));
+	return val;
+}
+
+/**
+ * int atomic_cas_u32(volatile uint32_t *p, uint32_t expect, uint32_t desired)
+ * @brief compare-and-swap
+ * @return 1 when *p was equal to expect and has been replaced by desired.
+ */
+static inline int atomic_cas_u32(volatile uint32_t *p, uint32_t expect, uint32_t desired){
+	do{
+		if(__LDREXW(p) != expect){
+			__CLREX();
+			return 0;
+		}
+	}while(__STREXW(desired, p));
+	return 1;
+}
+
+/**
+ * void atomic_or_u32(volatile uint32_t *p, uint32_t mask)
+ * @brief atomically set bits
+ */
+static inline void atomic_or_u32(volatile uint32_t *p, uint32_t mask){
+	do{
+	}while(__STREXW(__LDREXW(p) | mask, p));
+}
+
+/**
+ * void atomic_and_u32(volatile uint32_t *p, uint32_t mask)
+ * @brief atomically keep only the bits in mask
+ */
+static inline void atomic_and_u32(volatile uint32_t *p, uint32_t mask){
+	do{
+	}while(__STREXW(__LDREXW(p) & mask, p));
+}
+
+/**
+ * uint32_t critical_enter(void)
+ * @brief mask interrupts, returning the previous PRIMASK for critical_exit()
+ */
+static inline uint32_t critical_enter(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	return primask;
+}
+
+/**
+ * void critical_exit(uint32_t primask)
+ * @brief restore the interrupt mask saved by critical_enter()
+ */
+static inline void critical_exit(uint32_t primask){
+	__set_PRIMASK(primask);
+}
+
+#else /* host build */
+
+#define ATOMIC_BARRIER()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+static inline uint32_t atomic_add_u32(volatile uint32_t *p, uint32_t v){
+	return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST);
+}
+
+static inline int atomic_cas_u32(volatile uint32_t *p, uint32_t expect, uint32_t desired){
+	return __atomic_compare_exchange_n(p, &expect, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline void atomic_or_u32(volatile uint32_t *p, uint32_t mask){
+	__atomic_or_fetch(p, mask, __ATOMIC_SEQ_CST);
+}
+
+static inline void atomic_and_u32(volatile uint32_t *p, uint32_t mask){
+	__atomic_and_fetch(p, mask, __ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t critical_enter(void){
+	return 0;
+}
+
+static inline void critical_exit(uint32_t primask){
+	(void)primask;
+}
+
+#endif
+
+#endif /* INC_ATOMIC_H_ */
@@ -0,0 +1,66 @@
+/**
+ * bitband.h
+ *	@brief Cortex-M4 bit-band access to single bits of SRAM and peripheral registers
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The first MB of SRAM (0x20000000) and of the peripherals (0x40000000) is
+ * mirrored bit by bit into an alias region (PM0214 2.2.5): every bit has its
+ * own word at
+ *
+ *   alias = region alias base + (byte offset * 32) + (bit * 4)
+ *
+ * Writing 1 or 0 to that word sets or clears the one bit; reading it
+ * returns 0 or 1. So
+ *
+ *   BB_SET(I2C1->CR1, I2C_CR1_START_Pos);		instead of I2C1->CR1 |= I2C_CR1_START;
+ *
+ * is a single store: the read-modify-write is done by the bus in one locked
+ * transfer, so an interrupt can no longer come between the read and the
+ * write and have its own change to the register overwritten.
+ * Give the bit number (CMSIS *_Pos), not the mask. For a register the
+ * alias folds to one constant; for a variable the linker cannot do the
+ * masking, so the alias costs a few instructions (hoisted out of loops).
+ *
+ * The bus still writes the whole register back: do not use it on registers
+ * with bits that hardware sets and software clears by writing 0 or 1
+ * (USART SR, I2C SR1, TIM SR ...), write those directly instead.
+ * The core registers (SysTick, NVIC, SCB, DWT at 0xE0000000) are not
+ * bit-banded. Same header as 21_i2c_MPU6050, whose Host/bitbandcheck.c
+ * checks the address computation.
+ */
+
+#ifndef INC_BITBAND_H_
+#define INC_BITBAND_H_
+
+#include <stdint.h>
+
+#define BB_SRAM_BASE			(0x20000000U)
+#define BB_SRAM_ALIAS			(0x22000000U)	// SRAM1_BB_BASE
+#define BB_PERIPH_BASE			(0x40000000U)
+#define BB_PERIPH_ALIAS			(0x42000000U)	// PERIPH_BB_BASE
+#define BB_REGION_SIZE			(0x00100000U)	// bytes of each region that are bit-banded
+
+/* 1 if addr lies in one of the two bit-band regions */
+#define BB_IN_REGION(addr)		((((uint32_t)(uintptr_t)(addr)) - BB_SRAM_BASE < BB_REGION_SIZE) || \
+								 (((uint32_t)(uintptr_t)(addr)) - BB_PERIPH_BASE < BB_REGION_SIZE))
+
+/* alias word address of bit `bit` counted from the byte at addr */
+#define BB_ALIAS(addr, bit)		((((uint32_t)(uintptr_t)(addr)) & 0xF0000000U) + 0x02000000U + \
+								 ((((uint32_t)(uintptr_t)(addr)) & 0x000FFFFFU) << 5) + ((uint32_t)(bit) << 2))
+
+/* the alias word of a bit of a register or variable, as an lvalue */
+#define BB_BIT(reg, bit)		(*(volatile uint32_t *)BB_ALIAS(&(reg), (bit)))
+
+#if defined(__arm__)
+#define BB_SET(reg, bit)		(BB_BIT(reg, bit) = 1U)
+#define BB_CLR(reg, bit)		(BB_BIT(reg, bit) = 0U)
+#define BB_READ(reg, bit)		(BB_BIT(reg, bit))
+#else
+/* host models of the peripherals are plain memory without an alias region */
+#define BB_SET(reg, bit)		((reg) |= (1UL << (bit)))
+#define BB_CLR(reg, bit)		((reg) &= ~(1UL << (bit)))
+#define BB_READ(reg, bit)		(((reg) >> (bit)) & 1UL)
+#endif
+
+#endif /* INC_BITBAND_H_ */
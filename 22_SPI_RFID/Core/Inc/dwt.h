@@ -0,0 +1,27 @@
+/**
+ * dwt.h
+ *	@brief header file for the DWT cycle counter
+ *  @author Nakseung Choi
+ *  @date 10-19-2026
+ *
+ * The DWT cycle counter runs at the core clock (HCLK) and is used to
+ * timestamp events and to measure latencies in cycles.
+ */
+
+#ifndef INC_DWT_H_
+#define INC_DWT_H_
+
+#include "stm32f4xx.h"
+#include <stdint.h>
+
+void dwt_init(void);
+
+/**
+ * uint32_t dwt_cycles(void)
+ * @brief read the free running cycle counter.
+ */
+static inline uint32_t dwt_cycles(void){
+	return DWT->CYCCNT;
+}
+
+#endif /* INC_DWT_H_ */
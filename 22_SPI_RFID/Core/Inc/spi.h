@@ -18,8 +18,10 @@
 void spi1_gpio_init(void);
 void spi1_config(void);
 void spi1_transmit(uint8_t *data, uint32_t size);
-void spi1_receive(uint8_t *data, uinit32_t size);
+void spi1_receive(uint8_t *data, uint32_t size);
 void cs_enable(void);
 void cs_disable(void);
+int spi1_transfer_IT(const uint8_t *tx, uint8_t *rx, uint32_t size, uint8_t task, uint8_t sig);
+void spi1_irq_handler(void);
 
 #endif /* INC_SPI_H_ */
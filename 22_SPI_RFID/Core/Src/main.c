@@ -3,6 +3,10 @@
  *	@brief running MPU6050 i2c bare-metal
  *  @author Nakseung Choi
  *  @date 07-28-2022
+ *
+ * Both devices are served from the event scheduler: a 4 ms software timer
+ * reads the MPU6050, a 100 ms timer reads the MFRC522 VersionReg with an
+ * interrupt driven SPI transfer whose completion event releases chip select.
  */
 #include <stdio.h>
 #include <stdint.h>
@@ -10,41 +14,102 @@
 #include "MPU6050.h"
 #include "i2c.h"
 #include "spi.h"
+#include "sched.h"
+
+#define TASK_IMU				(0)
+#define TASK_RFID				(1)
+#define IMU_PRIO				(1)
+#define RFID_PRIO				(2)
+#define IMU_PERIOD_MS			(4)
+#define RFID_PERIOD_MS			(100)
+#define MFRC522_VERSION_REG		(0x37)
+#define MFRC522_READ(reg)		((uint8_t)(0x80U | ((reg) << 1)))
+
+/* task signals */
+enum {
+	SIG_TICK = 1,
+	SIG_SPI_DONE
+};
 
 int16_t Accel_X_RAW, Accel_Y_RAW, Accel_Z_RAW, Gyro_X_RAW, Gyro_Y_RAW, Gyro_Z_RAW;
 float Ax, Ay, Az, Gx, Gy, Gz;
+uint8_t rfid_version;		// MFRC522 VersionReg, 0x91/0x92 for version 1.0/2.0
+uint32_t rfid_busy;			// ticks skipped because the previous transfer was still running
 
 extern uint8_t data_rec[6]; //buffer to store data
 
-int main(void){
-	/*1. initializes MPU6050*/
- 	MPU6050_init();
+static const uint8_t rfid_tx[2] = { MFRC522_READ(MFRC522_VERSION_REG), 0 };
+static uint8_t rfid_rx[2];
 
-	while(1){
-		/*2. read accel values.*/
-		MPU6050_read_values(ACCEL_XOUT_H_REG);
+/**
+ * void imu_task(const sched_event_t *e)
+ * @brief read accel and gyro values on every tick
+ */
+static void imu_task(const sched_event_t *e){
+	/*1. read accel values.*/
+	MPU6050_read_values(ACCEL_XOUT_H_REG);
 
-		Accel_X_RAW = (int16_t)(data_rec[0] << 8 | data_rec[1]);
-		Accel_Y_RAW = (int16_t)(data_rec[2] << 8 | data_rec[3]);
-		Accel_Z_RAW = (int16_t)(data_rec[4] << 8 | data_rec[5]);
+	Accel_X_RAW = (int16_t)(data_rec[0] << 8 | data_rec[1]);
+	Accel_Y_RAW = (int16_t)(data_rec[2] << 8 | data_rec[3]);
+	Accel_Z_RAW = (int16_t)(data_rec[4] << 8 | data_rec[5]);
 
-		Ax = (Accel_X_RAW/16384.0);
-		Ay = (Accel_Y_RAW/16384.0);
-		Az = (Accel_Z_RAW/16384.0);
+	Ax = (Accel_X_RAW/16384.0);
+	Ay = (Accel_Y_RAW/16384.0);
+	Az = (Accel_Z_RAW/16384.0);
 
-		/*3. read gyro values.*/
-		MPU6050_read_values(GYRO_XOUT_H_REG);
+	/*2. read gyro values.*/
+	MPU6050_read_values(GYRO_XOUT_H_REG);
 
-		Gyro_X_RAW = (int16_t)(data_rec[0] << 8 | data_rec[1]);
-		Gyro_Y_RAW = (int16_t)(data_rec[2] << 8 | data_rec[3]);
-		Gyro_Z_RAW = (int16_t)(data_rec[4] << 8 | data_rec[5]);
+	Gyro_X_RAW = (int16_t)(data_rec[0] << 8 | data_rec[1]);
+	Gyro_Y_RAW = (int16_t)(data_rec[2] << 8 | data_rec[3]);
+	Gyro_Z_RAW = (int16_t)(data_rec[4] << 8 | data_rec[5]);
 
-		Gx = (Gyro_X_RAW/131.0);
-		Gy = (Gyro_Y_RAW/131.0);
-		Gz = (Gyro_Z_RAW/131.0);
-	}
+	Gx = (Gyro_X_RAW/131.0);
+	Gy = (Gyro_Y_RAW/131.0);
+	Gz = (Gyro_Z_RAW/131.0);
+}
 
+/**
+ * void rfid_task(const sched_event_t *e)
+ * @brief start a VersionReg read on every tick, release chip select when it completes
+ */
+static void rfid_task(const sched_event_t *e){
+	switch(e->sig){
+
+	case SIG_TICK:
+		/*1. address byte, then one dummy byte clocking the register out*/
+		cs_enable();
+		if(spi1_transfer_IT(rfid_tx, rfid_rx, sizeof(rfid_tx), TASK_RFID, SIG_SPI_DONE) != 0){
+			cs_disable();
+			rfid_busy++;
+		}
+		break;
 
+	case SIG_SPI_DONE:
+		/*2. the register came with the second byte*/
+		cs_disable();
+		rfid_version = rfid_rx[1];
+		break;
+
+	default:
+		break;
+	}
 }
 
+int main(void){
+	/*1. initializes MPU6050 and the MFRC522 SPI port*/
+ 	MPU6050_init();
+ 	spi1_gpio_init();
+ 	spi1_config();
+ 	cs_disable();
 
+	/*2. initializes the scheduler and the tasks*/
+	sched_init();
+	sched_task_add(TASK_IMU, IMU_PRIO, imu_task);
+	sched_task_add(TASK_RFID, RFID_PRIO, rfid_task);
+	sched_timer_start(TASK_IMU, SIG_TICK, IMU_PERIOD_MS);
+	sched_timer_start(TASK_RFID, SIG_TICK, RFID_PERIOD_MS);
+
+	/*3. dispatch events forever*/
+	sched_run();
+}
@@ -13,6 +13,21 @@
 
 #include "spi.h"
 #include "stm32f4xx.h"
+#include "sched.h"
+#include "bitband.h"
+
+/* interrupt driven full-duplex transfer in flight */
+typedef struct {
+	const uint8_t *tx;		// NULL: send dummy bytes
+	uint8_t *rx;			// NULL: discard received bytes
+	uint32_t size;
+	volatile uint32_t count;
+	volatile uint8_t busy;
+	uint8_t task;			// scheduler task notified on completion
+	uint8_t sig;
+} spi_it_xfer_t;
+
+static spi_it_xfer_t spi1_xfer;
 
 /**
  * void spi1_gpio_init(void)
@@ -55,6 +70,7 @@ void spi1_gpio_init(void){
  * 7. Set data format to 8 bit
  * 8. Select Software slave management by setting SSM to 1 and SSI to 1
  * 9. Enable SPI
+ * 10. Enable SPI1 interrupt in NVIC
  */
 void spi1_config(void){
 
@@ -68,7 +84,7 @@ void spi1_config(void){
 	SPI1->CR1 |= SPI_CR1_CPHA | SPI_CR1_CPOL;
 
 	/*4. Enable full-duplex. */
-	SPI1->CR1 |= SPI_CR1_RXONLY;
+	SPI1->CR1 &= ~SPI_CR1_RXONLY;
 
 	/*5. Set MSB first*/
 	SPI1->CR1 &= ~(SPI_CR1_LSBFIRST);
@@ -83,7 +99,10 @@ void spi1_config(void){
 	SPI1->CR1 |= SPI_CR1_SSM | SPI_CR1_SSI;
 
 	/*9. Enable SPI*/
-	SPI1->CR1 |= SPI_CR1_SPE;
+	BB_SET(SPI1->CR1, SPI_CR1_SPE_Pos);
+
+	/*10. Enable SPI1 interrupt in NVIC (used by spi1_transfer_IT)*/
+	NVIC_EnableIRQ(SPI1_IRQn);
 
 }
 /**
@@ -116,7 +135,7 @@ void spi1_transmit(uint8_t *data, uint32_t size){
 	while(!(SPI1->SR & SPI_SR_TXE)){}
 
 	/*4. wait for BUSY flag to reset */
-	while(SPI1->SR & SPI_SR_BUSY){}
+	while(SPI1->SR & SPI_SR_BSY){}
 
 	/*5. Clear OVR flag (both DR and SR; refer to reference manual)  */
 	temp = SPI1->DR;
@@ -124,7 +143,7 @@ void spi1_transmit(uint8_t *data, uint32_t size){
 
 }
 /**
- * void spi1_receive(uint8_t *data, uinit32_t size)
+ * void spi1_receive(uint8_t *data, uint32_t size)
  * @brief init receive function
  * @param data pointer to the data buffer
  * @param size size of the data
@@ -135,7 +154,7 @@ void spi1_transmit(uint8_t *data, uint32_t size){
  * 3. Read data from data register
  * 4. Decrement size
  */
-void spi1_receive(uint8_t *data, uinit32_t size){
+void spi1_receive(uint8_t *data, uint32_t size){
 	while(size){
 
 		/*1. Send dummy data */
@@ -160,7 +179,7 @@ void spi1_receive(uint8_t *data, uinit32_t size){
 void cs_enable(void){
 
 	/* 1. set cs to LOW to enable (active low) */
-	GPIOA->ODR &= ~(GPIO_ODR_OD9);
+	BB_CLR(GPIOA->ODR, GPIO_ODR_OD9_Pos);
 
 }
 /**
@@ -171,6 +190,82 @@ void cs_enable(void){
 void cs_disable(void){
 
 	/* 1. set cs to HIGH to disable (active low) */
-	GPIOA->ODR |= GPIO_ODR_OD9;
+	BB_SET(GPIOA->ODR, GPIO_ODR_OD9_Pos);
+}
+/**
+ * int spi1_transfer_IT(const uint8_t *tx, uint8_t *rx, uint32_t size, uint8_t task, uint8_t sig)
+ * @brief start an interrupt driven full-duplex transfer. Returns immediately;
+ *        sig is posted to task with arg = size once the last byte is received.
+ * @param tx bytes to send, NULL to send dummy 0 bytes
+ * @param rx buffer for the received bytes, NULL to discard them
+ * @param size number of bytes (>= 1)
+ * @param task scheduler task to notify
+ * @param sig signal posted to the task
+ * @note chip select is left to the caller (cs_enable before, cs_disable on completion).
+ * @step followed:
+ *
+ * 1. Refuse if a transfer is already running
+ * 2. Save the transfer
+ * 3. Enable RXNE interrupt
+ * 4. Write the first byte; every RXNE then sends the next one
+ *
+ * @return 0 if the transfer was started, -1 if the driver is busy.
+ */
+int spi1_transfer_IT(const uint8_t *tx, uint8_t *rx, uint32_t size, uint8_t task, uint8_t sig){
+
+	/*1. Refuse if a transfer is already running*/
+	if(spi1_xfer.busy || size == 0){
+		return -1;
+	}
+
+	/*2. Save the transfer*/
+	spi1_xfer.tx = tx;
+	spi1_xfer.rx = rx;
+	spi1_xfer.size = size;
+	spi1_xfer.count = 0;
+	spi1_xfer.task = task;
+	spi1_xfer.sig = sig;
+	spi1_xfer.busy = 1;
+
+	/*3. Enable RXNE interrupt*/
+	BB_SET(SPI1->CR2, SPI_CR2_RXNEIE_Pos);
+
+	/*4. Write the first byte*/
+	SPI1->DR = tx ? tx[0] : 0;
+
+	return 0;
 }
+/**
+ * void spi1_irq_handler(void)
+ * @brief SPI1 interrupt, called from SPI1_IRQHandler
+ * @step followed:
+ *
+ * 1. Read the received byte from DR
+ * 2. Send the next byte if there is one left
+ * 3. Otherwise disable RXNE interrupt and post the completion event
+ */
+void spi1_irq_handler(void){
+	uint8_t byte;
+
+	if(!(SPI1->SR & SPI_SR_RXNE)){
+		return;
+	}
+
+	/*1. Read the received byte from DR*/
+	byte = SPI1->DR;
+	if(spi1_xfer.rx){
+		spi1_xfer.rx[spi1_xfer.count] = byte;
+	}
+	spi1_xfer.count++;
 
+	/*2. Send the next byte if there is one left*/
+	if(spi1_xfer.count < spi1_xfer.size){
+		SPI1->DR = spi1_xfer.tx ? spi1_xfer.tx[spi1_xfer.count] : 0;
+
+	/*3. Otherwise disable RXNE interrupt and post the completion event*/
+	}else{
+		BB_CLR(SPI1->CR2, SPI_CR2_RXNEIE_Pos);
+		spi1_xfer.busy = 0;
+		sched_post(spi1_xfer.task, spi1_xfer.sig, (uint16_t)spi1_xfer.size);
+	}
+}
@@ -1,4 +1,5 @@
 #include "stm32f4xx.h"
+#include "gpio.h"
 
 /**
  * main.c
@@ -13,6 +14,24 @@
 #define RW 	0x40
 #define EN 	0x80
 
+/* PC0 - PC7 = D0 - D7, PB5 - PB7 = RS, R/W, EN: outputs, type, speed and pull left at reset */
+#define LCD_DATA_PINS(PIN) \
+	PIN(0, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(1, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(2, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(3, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(4, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(5, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(6, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(7, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0)
+#define LCD_CTRL_PINS(PIN) \
+	PIN(5, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(6, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0) \
+	PIN(7, PIN_MODE_OUT, PIN_KEEP, PIN_KEEP, PIN_KEEP, 0)
+
+GPIO_CFG_DEFINE(lcd_data_pins, LCD_DATA_PINS);
+GPIO_CFG_DEFINE(lcd_ctrl_pins, LCD_CTRL_PINS);
+
 /* Function Prototypes */
 void LCD_Init(void);
 void GPIO_Init(void);
@@ -64,11 +83,10 @@ void GPIO_Init(void){
 	RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN | RCC_AHB1ENR_GPIOCEN;
 	
 	/*2. Set GPIOC mode to output mode. (PC0 - PC7 = D0 - D7)*/
-	GPIOC->MODER |= GPIO_MODER_MODE0_0 | GPIO_MODER_MODE1_0 | GPIO_MODER_MODE2_0 | GPIO_MODER_MODE3_0;
-	GPIOC->MODER |= GPIO_MODER_MODE4_0 | GPIO_MODER_MODE5_0 | GPIO_MODER_MODE6_0 | GPIO_MODER_MODE7_0;
+	gpio_apply(GPIOC, &lcd_data_pins);
 	
 	/*3. Set GPIOB mode to output mode (PB5 = RS, PB6 = R/W, PB7 = EN) */
-	GPIOB->MODER |= GPIO_MODER_MODE5_0 | GPIO_MODER_MODE6_0 | GPIO_MODER_MODE7_0;
+	gpio_apply(GPIOB, &lcd_ctrl_pins);
 	
 	GPIOB->BSRR = 0x00C;
 	